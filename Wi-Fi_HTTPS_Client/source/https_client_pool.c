@@ -0,0 +1,530 @@
+/******************************************************************************
+* File Name: https_client_pool.c
+*
+* Description: This file contains the HTTPS client pool. It keeps one HTTP
+* client per server and its connection open between requests, so that only
+* the first request to a server pays for the TCP and TLS handshakes. The
+* headers of each method and path are built once per client and copied into
+* the request buffer of the next requests.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023-2025, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* FreeRTOS header files */
+#include <FreeRTOS.h>
+#include <task.h>
+
+/* Standard C header file */
+#include <string.h>
+
+/* HTTPS client header files */
+#include "secure_http_client.h"
+#include "https_client_pool.h"
+
+/*******************************************************************************
+* Data structure and enumeration
+********************************************************************************/
+/* Request headers prebuilt for one method and path. */
+typedef struct
+{
+    cy_http_client_method_t method;
+    size_t length;
+    char path[HTTPS_CLIENT_POOL_PATH_MAX_LEN + 1u];
+    uint8_t data[HTTPS_CLIENT_POOL_HEADER_LENGTH];
+} https_client_pool_headers_t;
+
+/* Client of one server. */
+typedef struct
+{
+    bool in_use;
+    volatile bool connected;
+    uint8_t next_headers;
+    TickType_t last_used;
+    cy_http_client_t handle;
+    cy_awsport_server_info_t server_info;
+    char host[HTTPS_CLIENT_POOL_HOST_MAX_LEN + 1u];
+    https_client_pool_headers_t headers[HTTPS_CLIENT_POOL_HEADER_BLOCKS];
+} https_client_pool_entry_t;
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static https_client_pool_entry_t https_client_pool[HTTPS_CLIENT_POOL_SIZE];
+static https_client_pool_stats_t https_client_pool_stats;
+
+/* Credentials of the clients, and callback of the application for closed
+ * connections.
+ */
+static cy_awsport_ssl_credentials_t *https_client_pool_security;
+static cy_http_disconnect_callback_t https_client_pool_disconnect_callback;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static void https_client_pool_disconnected(cy_http_client_t handle,
+                                           cy_http_client_disconn_type_t type, void *args);
+static https_client_pool_entry_t *https_client_pool_find(const char *host, uint16_t port);
+static cy_rslt_t https_client_pool_acquire(const char *host, uint16_t port,
+                                           https_client_pool_entry_t **entry, bool *reused);
+static cy_rslt_t https_client_pool_write_headers(https_client_pool_entry_t *entry,
+                                                 cy_http_client_request_header_t *request,
+                                                 cy_http_client_header_t *headers,
+                                                 uint32_t header_count);
+
+/*******************************************************************************
+ * Function Name: https_client_pool_init
+ *******************************************************************************
+ * Summary:
+ *  Empties the client pool. cy_http_client_init() must be called before.
+ *
+ * Parameters:
+ *  cy_awsport_ssl_credentials_t *security: Credentials of the clients, kept
+ *  by the pool
+ *  cy_http_disconnect_callback_t disconnect_callback: Called when a server
+ *  closes a connection, or NULL
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void https_client_pool_init(cy_awsport_ssl_credentials_t *security,
+                            cy_http_disconnect_callback_t disconnect_callback)
+{
+    memset(https_client_pool, 0, sizeof(https_client_pool));
+    memset(&https_client_pool_stats, 0, sizeof(https_client_pool_stats));
+    https_client_pool_security = security;
+    https_client_pool_disconnect_callback = disconnect_callback;
+}
+
+/*******************************************************************************
+ * Function Name: https_client_pool_disconnected
+ *******************************************************************************
+ * Summary:
+ *  HTTP client callback for a connection closed by the server or the network.
+ *  The next request to the server opens a new connection.
+ *
+ * Parameters:
+ *  cy_http_client_t handle: Client of the connection
+ *  cy_http_client_disconn_type_t type: Reason of the disconnection
+ *  void *args: Entry of the client in the pool
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void https_client_pool_disconnected(cy_http_client_t handle,
+                                           cy_http_client_disconn_type_t type, void *args)
+{
+    ((https_client_pool_entry_t *) args)->connected = false;
+
+    if (NULL != https_client_pool_disconnect_callback)
+    {
+        https_client_pool_disconnect_callback(handle, type, NULL);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: https_client_pool_find
+ *******************************************************************************
+ * Summary:
+ *  Looks up the client of a server.
+ *
+ * Parameters:
+ *  const char *host: Name or IP address of the server
+ *  uint16_t port: Port of the server
+ *
+ * Return:
+ *  https_client_pool_entry_t *: Entry of the client, or NULL if the server
+ *  has none.
+ *
+ *******************************************************************************/
+static https_client_pool_entry_t *https_client_pool_find(const char *host, uint16_t port)
+{
+    for (uint32_t i = 0u; i < HTTPS_CLIENT_POOL_SIZE; i++)
+    {
+        if (https_client_pool[i].in_use && (port == https_client_pool[i].server_info.port) &&
+            (0 == strcmp(host, https_client_pool[i].host)))
+        {
+            return &https_client_pool[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+ * Function Name: https_client_pool_acquire
+ *******************************************************************************
+ * Summary:
+ *  Returns the client of a server with an open connection. A server without
+ *  a client gets a free entry, or the entry used least recently, whose client
+ *  is closed. A connection unused for HTTPS_CLIENT_POOL_IDLE_TIMEOUT_MS is
+ *  opened again, as the server has probably closed it.
+ *
+ * Parameters:
+ *  const char *host: Name or IP address of the server
+ *  uint16_t port: Port of the server
+ *  https_client_pool_entry_t **entry: Holds the entry of the client
+ *  bool *reused: Set to true if the connection was already open
+ *
+ * Return:
+ *  cy_rslt_t: CY_RSLT_SUCCESS if the client is connected, an error code
+ *  otherwise.
+ *
+ *******************************************************************************/
+static cy_rslt_t https_client_pool_acquire(const char *host, uint16_t port,
+                                           https_client_pool_entry_t **entry, bool *reused)
+{
+    https_client_pool_entry_t *client = https_client_pool_find(host, port);
+    TickType_t now = xTaskGetTickCount();
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    if (NULL == client)
+    {
+        if (strlen(host) > HTTPS_CLIENT_POOL_HOST_MAX_LEN)
+        {
+            ERR_INFO(("Server name %s is longer than %u characters.\n", host,
+                      (unsigned int) HTTPS_CLIENT_POOL_HOST_MAX_LEN));
+            return CY_RSLT_TYPE_ERROR;
+        }
+
+        client = &https_client_pool[0];
+        for (uint32_t i = 0u; (i < HTTPS_CLIENT_POOL_SIZE) && client->in_use; i++)
+        {
+            if (!https_client_pool[i].in_use ||
+                ((now - https_client_pool[i].last_used) > (now - client->last_used)))
+            {
+                client = &https_client_pool[i];
+            }
+        }
+
+        if (client->in_use)
+        {
+            if (client->connected)
+            {
+                (void) cy_http_client_disconnect(client->handle);
+            }
+            (void) cy_http_client_delete(client->handle);
+            https_client_pool_stats.evictions++;
+        }
+
+        memset(client, 0, sizeof(*client));
+        strcpy(client->host, host);
+        client->server_info.host_name = client->host;
+        client->server_info.port = port;
+
+        result = cy_http_client_create(https_client_pool_security, &client->server_info,
+                                       https_client_pool_disconnected, client, &client->handle);
+        if (CY_RSLT_SUCCESS != result)
+        {
+            ERR_INFO(("Failed to create http client.\n"));
+            return result;
+        }
+
+        client->in_use = true;
+    }
+    else if (client->connected && ((now - client->last_used) > pdMS_TO_TICKS(HTTPS_CLIENT_POOL_IDLE_TIMEOUT_MS)))
+    {
+        (void) cy_http_client_disconnect(client->handle);
+        client->connected = false;
+    }
+
+    *reused = client->connected;
+    if (!client->connected)
+    {
+        result = cy_http_client_connect(client->handle, TRANSPORT_SEND_RECV_TIMEOUT_MS,
+                                        TRANSPORT_SEND_RECV_TIMEOUT_MS);
+        if (CY_RSLT_SUCCESS != result)
+        {
+            return result;
+        }
+
+        client->connected = true;
+        https_client_pool_stats.connects++;
+    }
+
+    client->last_used = now;
+    *entry = client;
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: https_client_pool_get
+ *******************************************************************************
+ * Summary:
+ *  Returns the connected client of a server, for requests that the pool does
+ *  not send itself. The client stays in the pool.
+ *
+ * Parameters:
+ *  const char *host: Name or IP address of the server
+ *  uint16_t port: Port of the server
+ *  cy_http_client_t *handle: Holds the client
+ *
+ * Return:
+ *  cy_rslt_t: CY_RSLT_SUCCESS if the client is connected, an error code
+ *  otherwise.
+ *
+ *******************************************************************************/
+cy_rslt_t https_client_pool_get(const char *host, uint16_t port, cy_http_client_t *handle)
+{
+    https_client_pool_entry_t *entry = NULL;
+    bool reused;
+    cy_rslt_t result;
+
+    result = https_client_pool_acquire(host, port, &entry, &reused);
+    if (CY_RSLT_SUCCESS == result)
+    {
+        *handle = entry->handle;
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: https_client_pool_reconnect
+ *******************************************************************************
+ * Summary:
+ *  Closes the connection of the client of a server, if open, and opens a new
+ *  one, for a caller whose request failed on a connection from
+ *  https_client_pool_get().
+ *
+ * Parameters:
+ *  const char *host: Name or IP address of the server
+ *  uint16_t port: Port of the server
+ *  cy_http_client_t *handle: Holds the client
+ *
+ * Return:
+ *  cy_rslt_t: CY_RSLT_SUCCESS if the client is connected, an error code
+ *  otherwise.
+ *
+ *******************************************************************************/
+cy_rslt_t https_client_pool_reconnect(const char *host, uint16_t port, cy_http_client_t *handle)
+{
+    https_client_pool_entry_t *entry = https_client_pool_find(host, port);
+
+    if ((NULL != entry) && entry->connected)
+    {
+        (void) cy_http_client_disconnect(entry->handle);
+        entry->connected = false;
+    }
+
+    return https_client_pool_get(host, port, handle);
+}
+
+/*******************************************************************************
+ * Function Name: https_client_pool_write_headers
+ *******************************************************************************
+ * Summary:
+ *  Writes the headers of a request to its buffer. The headers of a method and
+ *  path are built by the HTTP client library on the first request, and copied
+ *  from the header block of the client on the next ones. When all blocks are
+ *  used, the oldest one is built again for the new method and path. The
+ *  headers of a path longer than HTTPS_CLIENT_POOL_PATH_MAX_LEN are built on
+ *  each request.
+ *
+ * Parameters:
+ *  https_client_pool_entry_t *entry: Client of the server
+ *  cy_http_client_request_header_t *request: Request, with its method, path
+ *  and buffer set
+ *  cy_http_client_header_t *headers: Headers besides the ones of the library
+ *  uint32_t header_count: Number of headers
+ *
+ * Return:
+ *  cy_rslt_t: CY_RSLT_SUCCESS if the headers are written, an error code
+ *  otherwise.
+ *
+ *******************************************************************************/
+static cy_rslt_t https_client_pool_write_headers(https_client_pool_entry_t *entry,
+                                                 cy_http_client_request_header_t *request,
+                                                 cy_http_client_header_t *headers,
+                                                 uint32_t header_count)
+{
+    https_client_pool_headers_t *block;
+    cy_http_client_request_header_t build;
+    cy_rslt_t result;
+
+    if (strlen(request->resource_path) > HTTPS_CLIENT_POOL_PATH_MAX_LEN)
+    {
+        return cy_http_client_write_header(entry->handle, request, headers, header_count);
+    }
+
+    for (uint32_t i = 0u; i < HTTPS_CLIENT_POOL_HEADER_BLOCKS; i++)
+    {
+        block = &entry->headers[i];
+
+        if ((0u != block->length) && (request->method == block->method) &&
+            (0 == strcmp(request->resource_path, block->path)))
+        {
+            if (block->length > request->buffer_len)
+            {
+                return CY_RSLT_TYPE_ERROR;
+            }
+
+            memcpy(request->buffer, block->data, block->length);
+            request->headers_len = block->length;
+            return CY_RSLT_SUCCESS;
+        }
+    }
+
+    block = &entry->headers[entry->next_headers];
+    entry->next_headers = (uint8_t)((entry->next_headers + 1u) % HTTPS_CLIENT_POOL_HEADER_BLOCKS);
+
+    build = *request;
+    build.buffer = block->data;
+    build.buffer_len = sizeof(block->data);
+    build.headers_len = 0u;
+
+    block->length = 0u;
+    result = cy_http_client_write_header(entry->handle, &build, headers, header_count);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        return result;
+    }
+
+    block->method = request->method;
+    block->length = build.headers_len;
+    strcpy(block->path, request->resource_path);
+    https_client_pool_stats.header_builds++;
+
+    return https_client_pool_write_headers(entry, request, headers, header_count);
+}
+
+/*******************************************************************************
+ * Function Name: https_client_pool_send
+ *******************************************************************************
+ * Summary:
+ *  Sends a request to a server on the connection of its client, and receives
+ *  the response. A server may close a kept-alive connection at any time. When
+ *  a request other than POST fails on a connection that was already open, it
+ *  is sent once again on a new connection, as repeating it does not change
+ *  the resource twice.
+ *
+ * Parameters:
+ *  const char *host: Name or IP address of the server
+ *  uint16_t port: Port of the server
+ *  cy_http_client_method_t method: Method of the request
+ *  const char *path: Path of the resource
+ *  cy_http_client_header_t *headers: Headers besides the ones of the library.
+ *  They must be the same on each request with this method and path.
+ *  uint32_t header_count: Number of headers
+ *  const uint8_t *body: Body of the request, or NULL
+ *  uint32_t body_len: Length of the body
+ *  uint8_t *buffer: Holds the request headers, then the response
+ *  size_t buffer_len: Size of the buffer
+ *  cy_http_client_response_t *response: Holds the response
+ *
+ * Return:
+ *  cy_rslt_t: CY_RSLT_SUCCESS if a response was received, an error code
+ *  otherwise.
+ *
+ *******************************************************************************/
+cy_rslt_t https_client_pool_send(const char *host, uint16_t port, cy_http_client_method_t method,
+                                 const char *path, cy_http_client_header_t *headers,
+                                 uint32_t header_count, const uint8_t *body, uint32_t body_len,
+                                 uint8_t *buffer, size_t buffer_len,
+                                 cy_http_client_response_t *response)
+{
+    https_client_pool_entry_t *entry = NULL;
+    cy_http_client_request_header_t request;
+    bool reused = false;
+    cy_rslt_t result;
+
+    request.method = method;
+    request.resource_path = path;
+    request.range_start = HTTP_REQUEST_RANGE_START;
+    request.range_end = HTTP_REQUEST_RANGE_END;
+
+    for (uint32_t attempt = 0u; attempt < 2u; attempt++)
+    {
+        result = https_client_pool_acquire(host, port, &entry, &reused);
+        if (CY_RSLT_SUCCESS != result)
+        {
+            break;
+        }
+
+        request.buffer = buffer;
+        request.buffer_len = buffer_len;
+        request.headers_len = 0u;
+
+        result = https_client_pool_write_headers(entry, &request, headers, header_count);
+        if (CY_RSLT_SUCCESS != result)
+        {
+            break;
+        }
+
+        result = cy_http_client_send(entry->handle, &request, (uint8_t *) body, body_len, response);
+        if (CY_RSLT_SUCCESS == result)
+        {
+            if (reused)
+            {
+                https_client_pool_stats.reuses++;
+            }
+            break;
+        }
+
+        entry->connected = false;
+        (void) cy_http_client_disconnect(entry->handle);
+
+        if (!reused || (CY_HTTP_CLIENT_METHOD_POST == method))
+        {
+            break;
+        }
+
+        https_client_pool_stats.retries++;
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: https_client_pool_get_stats
+ *******************************************************************************
+ * Summary:
+ *  Copies the counters of the client pool.
+ *
+ * Parameters:
+ *  https_client_pool_stats_t *stats: Holds the counters
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void https_client_pool_get_stats(https_client_pool_stats_t *stats)
+{
+    *stats = https_client_pool_stats;
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,114 @@
+/******************************************************************************
+* File Name: https_client_pool.h
+*
+* Description: This file contains declarations of the HTTPS client pool, which
+* keeps one connected HTTP client per server so that consecutive requests reuse
+* the TLS session, and prebuilds the request headers of each method and path.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023-2025, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef HTTPS_CLIENT_POOL_H_
+#define HTTPS_CLIENT_POOL_H_
+
+/* Standard C header files */
+#include <stdbool.h>
+#include <stdint.h>
+
+/* HTTP client header file */
+#include "cy_http_client_api.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Number of servers with a client in the pool. When the pool is full, the
+ * client used least recently is closed for a new server.
+ */
+#ifndef HTTPS_CLIENT_POOL_SIZE
+#define HTTPS_CLIENT_POOL_SIZE                   (2u)
+#endif
+
+/* Time after which an unused connection is assumed to be closed by the
+ * server. The next request opens a new connection instead of failing on it.
+ * The HTTPS server code example closes connections idle for 5 seconds.
+ */
+#ifndef HTTPS_CLIENT_POOL_IDLE_TIMEOUT_MS
+#define HTTPS_CLIENT_POOL_IDLE_TIMEOUT_MS        (4000u)
+#endif
+
+/* Request header blocks prebuilt per client, one per method and path. */
+#ifndef HTTPS_CLIENT_POOL_HEADER_BLOCKS
+#define HTTPS_CLIENT_POOL_HEADER_BLOCKS          (4u)
+#endif
+
+/* Room for the headers of one request, request line included. */
+#ifndef HTTPS_CLIENT_POOL_HEADER_LENGTH
+#define HTTPS_CLIENT_POOL_HEADER_LENGTH          (256u)
+#endif
+
+/* Longest server name and resource path kept by the pool. */
+#define HTTPS_CLIENT_POOL_HOST_MAX_LEN           (64u)
+#define HTTPS_CLIENT_POOL_PATH_MAX_LEN           (48u)
+
+/*******************************************************************************
+* Data structure and enumeration
+********************************************************************************/
+/* Counters of the client pool. */
+typedef struct
+{
+    uint32_t connects;                             /* Connections opened, each with a TLS handshake */
+    uint32_t reuses;                               /* Requests sent on an open connection */
+    uint32_t retries;                              /* Requests sent again on a new connection */
+    uint32_t header_builds;                        /* Header blocks built */
+    uint32_t evictions;                            /* Clients closed for another server */
+} https_client_pool_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void https_client_pool_init(cy_awsport_ssl_credentials_t *security,
+                            cy_http_disconnect_callback_t disconnect_callback);
+cy_rslt_t https_client_pool_get(const char *host, uint16_t port, cy_http_client_t *handle);
+cy_rslt_t https_client_pool_reconnect(const char *host, uint16_t port, cy_http_client_t *handle);
+cy_rslt_t https_client_pool_send(const char *host, uint16_t port, cy_http_client_method_t method,
+                                 const char *path, cy_http_client_header_t *headers,
+                                 uint32_t header_count, const uint8_t *body, uint32_t body_len,
+                                 uint8_t *buffer, size_t buffer_len,
+                                 cy_http_client_response_t *response);
+void https_client_pool_get_stats(https_client_pool_stats_t *stats);
+
+#endif /* HTTPS_CLIENT_POOL_H_ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,585 @@
+/******************************************************************************
+* File Name: https_download.c
+*
+* Description: This file contains the streaming HTTPS download. It requests a
+* resource one chunk at a time with HTTP Range requests, writes each chunk to
+* the external QSPI NOR flash, and hashes the bytes as they arrive. After a
+* disconnection, it reconnects and resumes at the first missing byte.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023-2025, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* FreeRTOS header files */
+#include <FreeRTOS.h>
+#include <task.h>
+
+/* Standard C header files */
+#include <ctype.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Serial flash library header file */
+#include "cy_serial_flash_qspi.h"
+
+/* mbedTLS header files */
+#include "mbedtls/version.h"
+#include "mbedtls/sha256.h"
+
+/* HTTPS client header files */
+#include "secure_http_client.h"
+#include "https_client_pool.h"
+#include "https_download.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define HTTP_STATUS_OK                           (200u)
+#define HTTP_STATUS_PARTIAL_CONTENT              (206u)
+
+/* Longest Content-Range value parsed, as in "bytes 0-4095/4294967295". */
+#define HTTPS_DOWNLOAD_RANGE_MAX_LEN             (48u)
+
+/* Bytes downloaded between two progress messages. */
+#define HTTPS_DOWNLOAD_PROGRESS_STEP             (256u * 1024u)
+
+/* The SHA-256 functions return their status from mbedTLS 2.7 on, under
+ * the _ret names until mbedTLS 3.0.
+ */
+#if (MBEDTLS_VERSION_NUMBER >= 0x03000000)
+#define https_download_sha256_starts(ctx)                 mbedtls_sha256_starts((ctx), 0)
+#define https_download_sha256_update(ctx, data, len)      mbedtls_sha256_update((ctx), (data), (len))
+#define https_download_sha256_finish(ctx, digest)         mbedtls_sha256_finish((ctx), (digest))
+#else
+#define https_download_sha256_starts(ctx)                 mbedtls_sha256_starts_ret((ctx), 0)
+#define https_download_sha256_update(ctx, data, len)      mbedtls_sha256_update_ret((ctx), (data), (len))
+#define https_download_sha256_finish(ctx, digest)         mbedtls_sha256_finish_ret((ctx), (digest))
+#endif
+
+/*******************************************************************************
+* Data structure and enumeration
+********************************************************************************/
+/* Verdict on the chunk of a response. */
+typedef enum
+{
+    HTTPS_DOWNLOAD_CHUNK_VALID,
+    HTTPS_DOWNLOAD_CHUNK_CHANGED,
+    HTTPS_DOWNLOAD_CHUNK_INVALID,
+} https_download_chunk_t;
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* Holds the request headers, then the response headers and one chunk. */
+static uint8_t https_download_buffer[HTTPS_DOWNLOAD_HEADER_LENGTH + HTTPS_DOWNLOAD_CHUNK_LENGTH];
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static bool https_download_parse_hex(const char *text, uint8_t *digest);
+static bool https_download_parse_range(const char *value, size_t value_len, uint32_t *first,
+                                       uint32_t *last, uint32_t *total);
+static cy_rslt_t https_download_request(cy_http_client_t handle, const char *resource_path,
+                                        uint32_t offset, uint32_t length,
+                                        cy_http_client_response_t *response);
+static https_download_chunk_t https_download_check(cy_http_client_t handle,
+                                                   cy_http_client_response_t *response,
+                                                   uint32_t offset, uint32_t max_length,
+                                                   char *etag, uint32_t *total);
+static cy_rslt_t https_download_write(uint32_t address, const uint8_t *data, size_t length,
+                                      uint32_t *erased_end);
+
+/*******************************************************************************
+ * Function Name: https_download_parse_hex
+ *******************************************************************************
+ * Summary:
+ *  Converts a SHA-256 digest written as 64 hexadecimal digits to bytes.
+ *
+ * Parameters:
+ *  const char *text: Digest in hexadecimal
+ *  uint8_t *digest: Holds the HTTPS_DOWNLOAD_SHA256_LEN bytes of the digest
+ *
+ * Return:
+ *  bool: true if the text is a valid digest, false otherwise.
+ *
+ *******************************************************************************/
+static bool https_download_parse_hex(const char *text, uint8_t *digest)
+{
+    char byte[3] = { 0 };
+
+    if ((2u * HTTPS_DOWNLOAD_SHA256_LEN) != strlen(text))
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0u; i < HTTPS_DOWNLOAD_SHA256_LEN; i++)
+    {
+        if (!isxdigit((unsigned char)text[2u * i]) || !isxdigit((unsigned char)text[(2u * i) + 1u]))
+        {
+            return false;
+        }
+
+        memcpy(byte, &text[2u * i], 2u);
+        digest[i] = (uint8_t)strtoul(byte, NULL, 16);
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: https_download_parse_range
+ *******************************************************************************
+ * Summary:
+ *  Parses the value of a Content-Range header, as in "bytes 0-4095/1048576".
+ *
+ * Parameters:
+ *  const char *value: Header value, not null-terminated
+ *  size_t value_len: Length of the header value
+ *  uint32_t *first: Position of the first byte sent
+ *  uint32_t *last: Position of the last byte sent
+ *  uint32_t *total: Length of the whole resource
+ *
+ * Return:
+ *  bool: true if the value holds a valid range, false otherwise. An unknown
+ *  length ("*") is not accepted, as the download has to know when to stop.
+ *
+ *******************************************************************************/
+static bool https_download_parse_range(const char *value, size_t value_len, uint32_t *first,
+                                       uint32_t *last, uint32_t *total)
+{
+    char text[HTTPS_DOWNLOAD_RANGE_MAX_LEN];
+    char *cursor;
+    char *end;
+
+    if ((value_len >= sizeof(text)) || (value_len < (sizeof("bytes ") - 1u)) ||
+        (0 != strncmp(value, "bytes ", sizeof("bytes ") - 1u)))
+    {
+        return false;
+    }
+
+    memcpy(text, value, value_len);
+    text[value_len] = '\0';
+    cursor = &text[sizeof("bytes ") - 1u];
+
+    *first = (uint32_t)strtoul(cursor, &end, 10);
+    if ((end == cursor) || ('-' != *end))
+    {
+        return false;
+    }
+
+    cursor = end + 1;
+    *last = (uint32_t)strtoul(cursor, &end, 10);
+    if ((end == cursor) || ('/' != *end))
+    {
+        return false;
+    }
+
+    cursor = end + 1;
+    *total = (uint32_t)strtoul(cursor, &end, 10);
+    if ((end == cursor) || ('\0' != *end))
+    {
+        return false;
+    }
+
+    return (*first <= *last) && (*last < *total);
+}
+
+/*******************************************************************************
+ * Function Name: https_download_request
+ *******************************************************************************
+ * Summary:
+ *  Sends a GET request for one chunk of the resource and receives the
+ *  response in the download buffer.
+ *
+ * Parameters:
+ *  cy_http_client_t handle: Connected HTTP client
+ *  const char *resource_path: Path of the resource
+ *  uint32_t offset: Position of the first byte requested
+ *  uint32_t length: Number of bytes requested
+ *  cy_http_client_response_t *response: Holds the response
+ *
+ * Return:
+ *  cy_rslt_t: CY_RSLT_SUCCESS if a response was received, an HTTP client
+ *  error otherwise.
+ *
+ *******************************************************************************/
+static cy_rslt_t https_download_request(cy_http_client_t handle, const char *resource_path,
+                                        uint32_t offset, uint32_t length,
+                                        cy_http_client_response_t *response)
+{
+    cy_http_client_request_header_t request;
+    cy_http_client_header_t header;
+    cy_rslt_t result;
+
+    request.buffer = https_download_buffer;
+    request.buffer_len = sizeof(https_download_buffer);
+    request.headers_len = 0u;
+    request.method = CY_HTTP_CLIENT_METHOD_GET;
+    request.range_start = (int32_t)offset;
+    request.range_end = (int32_t)(offset + length - 1u);
+    request.resource_path = resource_path;
+
+    /* A range of a compressed encoding would not hold the bytes of the resource. */
+    header.field = "Accept-Encoding";
+    header.field_len = sizeof("Accept-Encoding") - 1u;
+    header.value = "identity";
+    header.value_len = sizeof("identity") - 1u;
+
+    result = cy_http_client_write_header(handle, &request, &header, 1u);
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = cy_http_client_send(handle, &request, NULL, 0u, response);
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: https_download_check
+ *******************************************************************************
+ * Summary:
+ *  Checks that a response carries the chunk that starts at the given offset.
+ *  A partial response (206) must name that range in its Content-Range header.
+ *  A full response (200), from a server that does not support ranges, is only
+ *  usable if the whole resource fits in the first chunk. The length and ETag
+ *  of the resource are kept from the first chunk and compared with the ones of
+ *  the next chunks, so that a resource that changes is not resumed.
+ *
+ * Parameters:
+ *  cy_http_client_t handle: HTTP client that received the response
+ *  cy_http_client_response_t *response: Response to be checked
+ *  uint32_t offset: Position of the first byte requested
+ *  uint32_t max_length: Size of the download area in the flash
+ *  char *etag: ETag of the resource, empty if the server sends none
+ *  uint32_t *total: Length of the resource
+ *
+ * Return:
+ *  https_download_chunk_t: HTTPS_DOWNLOAD_CHUNK_VALID if the body is the
+ *  expected chunk, HTTPS_DOWNLOAD_CHUNK_CHANGED if the resource changed since
+ *  the first chunk, HTTPS_DOWNLOAD_CHUNK_INVALID otherwise.
+ *
+ *******************************************************************************/
+static https_download_chunk_t https_download_check(cy_http_client_t handle,
+                                                   cy_http_client_response_t *response,
+                                                   uint32_t offset, uint32_t max_length,
+                                                   char *etag, uint32_t *total)
+{
+    cy_http_client_header_t header;
+    uint32_t first = 0u;
+    uint32_t last = 0u;
+    uint32_t length = 0u;
+
+    if (HTTP_STATUS_PARTIAL_CONTENT == response->status_code)
+    {
+        header.field = "Content-Range";
+        header.field_len = sizeof("Content-Range") - 1u;
+
+        if ((CY_RSLT_SUCCESS != cy_http_client_read_header(handle, response, &header, 1u)) ||
+            !https_download_parse_range(header.value, header.value_len, &first, &last, &length) ||
+            (first != offset) || ((last - first + 1u) != response->body_len))
+        {
+            ERR_INFO(("Partial response does not hold bytes %"PRIu32" on.\n", offset));
+            return HTTPS_DOWNLOAD_CHUNK_INVALID;
+        }
+    }
+    else if (HTTP_STATUS_OK == response->status_code)
+    {
+        if ((0u != offset) || (response->body_len != response->content_len))
+        {
+            ERR_INFO(("The server does not support range requests, and the resource is larger "
+                      "than a chunk of %u bytes.\n", (unsigned int) HTTPS_DOWNLOAD_CHUNK_LENGTH));
+            return HTTPS_DOWNLOAD_CHUNK_INVALID;
+        }
+
+        length = (uint32_t)response->body_len;
+    }
+    else
+    {
+        ERR_INFO(("Download failed with HTTP status %u.\n", (unsigned int) response->status_code));
+        return HTTPS_DOWNLOAD_CHUNK_INVALID;
+    }
+
+    header.field = "ETag";
+    header.field_len = sizeof("ETag") - 1u;
+    if ((CY_RSLT_SUCCESS != cy_http_client_read_header(handle, response, &header, 1u)) ||
+        (header.value_len > HTTPS_DOWNLOAD_ETAG_MAX_LEN))
+    {
+        header.value = "";
+        header.value_len = 0u;
+    }
+
+    if (0u == offset)
+    {
+        if (length > max_length)
+        {
+            ERR_INFO(("Resource of %"PRIu32" bytes does not fit in the download area of %"PRIu32
+                      " bytes.\n", length, max_length));
+            return HTTPS_DOWNLOAD_CHUNK_INVALID;
+        }
+
+        *total = length;
+        memcpy(etag, header.value, header.value_len);
+        etag[header.value_len] = '\0';
+    }
+    else if ((length != *total) || (strlen(etag) != header.value_len) ||
+             (0 != memcmp(etag, header.value, header.value_len)))
+    {
+        return HTTPS_DOWNLOAD_CHUNK_CHANGED;
+    }
+
+    return HTTPS_DOWNLOAD_CHUNK_VALID;
+}
+
+/*******************************************************************************
+ * Function Name: https_download_write
+ *******************************************************************************
+ * Summary:
+ *  Writes a chunk to the flash. NOR flash is only programmed from the erased
+ *  state, so the sectors that the chunk reaches first are erased before.
+ *
+ * Parameters:
+ *  uint32_t address: Flash address of the chunk
+ *  const uint8_t *data: Chunk
+ *  size_t length: Length of the chunk
+ *  uint32_t *erased_end: End of the sectors erased so far, advanced by the
+ *  sectors erased
+ *
+ * Return:
+ *  cy_rslt_t: CY_RSLT_SUCCESS if the chunk is written, a serial flash error
+ *  otherwise.
+ *
+ *******************************************************************************/
+static cy_rslt_t https_download_write(uint32_t address, const uint8_t *data, size_t length,
+                                      uint32_t *erased_end)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    size_t sector_size;
+
+    while ((CY_RSLT_SUCCESS == result) && (*erased_end < (address + length)))
+    {
+        sector_size = cy_serial_flash_qspi_get_erase_size(*erased_end);
+        result = cy_serial_flash_qspi_erase(*erased_end, sector_size);
+        *erased_end += (uint32_t)sector_size;
+    }
+
+    if ((CY_RSLT_SUCCESS == result) && (0u != length))
+    {
+        result = cy_serial_flash_qspi_write(address, length, data);
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: https_download_to_flash
+ *******************************************************************************
+ * Summary:
+ *  Downloads a resource to the QSPI NOR flash, one chunk of
+ *  HTTPS_DOWNLOAD_CHUNK_LENGTH bytes at a time, and computes the SHA-256 digest
+ *  of the bytes as they are written. The requests are sent on the client of
+ *  the server in the client pool. When a request fails, the pool reconnects
+ *  the client and the first missing byte is asked for again, up to
+ *  HTTPS_DOWNLOAD_MAX_RETRIES times in a row. When the resource changes during
+ *  the download, the download starts over.
+ *
+ * Parameters:
+ *  const char *host: Name or IP address of the server
+ *  uint16_t port: Port of the server
+ *  const char *resource_path: Path of the resource
+ *  uint32_t flash_address: Start of the download area, on a sector boundary
+ *  uint32_t max_length: Size of the download area
+ *  const char *expected_sha256: Expected digest in hexadecimal, or NULL or an
+ *  empty string to skip the check
+ *  https_download_result_t *result: Holds the outcome of the download
+ *
+ * Return:
+ *  cy_rslt_t: CY_RSLT_SUCCESS if the whole resource is written to the flash
+ *  and has the expected digest, an error code otherwise.
+ *
+ *******************************************************************************/
+cy_rslt_t https_download_to_flash(const char *host, uint16_t port, const char *resource_path,
+                                  uint32_t flash_address, uint32_t max_length,
+                                  const char *expected_sha256,
+                                  https_download_result_t *result)
+{
+    cy_http_client_t handle;
+    cy_http_client_response_t response;
+    https_download_chunk_t chunk;
+    mbedtls_sha256_context sha256;
+    uint8_t expected[HTTPS_DOWNLOAD_SHA256_LEN];
+    char etag[HTTPS_DOWNLOAD_ETAG_MAX_LEN + 1u] = "";
+    bool check_digest = (NULL != expected_sha256) && ('\0' != expected_sha256[0]);
+    uint32_t erased_end = flash_address;
+    uint32_t total = 0u;
+    uint32_t length;
+    uint32_t failures = 0u;
+    cy_rslt_t status;
+
+    memset(result, 0, sizeof(*result));
+
+    if (check_digest && !https_download_parse_hex(expected_sha256, expected))
+    {
+        ERR_INFO(("The expected SHA-256 digest must be 64 hexadecimal digits.\n"));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    if ((0u != (flash_address % cy_serial_flash_qspi_get_erase_size(flash_address))) ||
+        (max_length > cy_serial_flash_qspi_get_size()) ||
+        (flash_address > (cy_serial_flash_qspi_get_size() - max_length)))
+    {
+        ERR_INFO(("The download area must start on a sector boundary and end within the "
+                  "flash of %u bytes.\n", (unsigned int) cy_serial_flash_qspi_get_size()));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    mbedtls_sha256_init(&sha256);
+    status = (0 == https_download_sha256_starts(&sha256)) ? CY_RSLT_SUCCESS : CY_RSLT_TYPE_ERROR;
+
+    while (CY_RSLT_SUCCESS == status)
+    {
+        /* The length is known from the first chunk on. */
+        length = HTTPS_DOWNLOAD_CHUNK_LENGTH;
+        if ((0u != result->length) && ((total - result->length) < length))
+        {
+            length = total - result->length;
+        }
+
+        /* Getting the client from the pool for every chunk keeps the connection
+         * marked as in use, and reopens it if the server closed it.
+         */
+        result->requests++;
+        status = https_client_pool_get(host, port, &handle);
+        if (CY_RSLT_SUCCESS == status)
+        {
+            status = https_download_request(handle, resource_path, result->length, length, &response);
+        }
+
+        if (CY_RSLT_SUCCESS != status)
+        {
+            if (failures++ == HTTPS_DOWNLOAD_MAX_RETRIES)
+            {
+                ERR_INFO(("Download failed at byte %"PRIu32" after %u retries.\n",
+                          result->length, (unsigned int) HTTPS_DOWNLOAD_MAX_RETRIES));
+                break;
+            }
+
+            /* Open a new connection and ask for the first missing byte. */
+            APP_INFO(("Download interrupted at byte %"PRIu32", resuming.\n", result->length));
+            vTaskDelay(pdMS_TO_TICKS(HTTPS_DOWNLOAD_RETRY_DELAY_MS));
+            (void) https_client_pool_reconnect(host, port, &handle);
+
+            /* A failed connection fails the next request, which counts as a retry. */
+            status = CY_RSLT_SUCCESS;
+            result->resumes++;
+            continue;
+        }
+
+        chunk = https_download_check(handle, &response, result->length, max_length, etag, &total);
+
+        if (HTTPS_DOWNLOAD_CHUNK_CHANGED == chunk)
+        {
+            if (failures++ == HTTPS_DOWNLOAD_MAX_RETRIES)
+            {
+                ERR_INFO(("The resource keeps changing during the download.\n"));
+                status = CY_RSLT_TYPE_ERROR;
+                break;
+            }
+
+            /* The bytes written belong to another version of the resource. */
+            APP_INFO(("The resource changed at byte %"PRIu32", restarting the download.\n",
+                      result->length));
+            result->length = 0u;
+            result->restarts++;
+            erased_end = flash_address;
+            status = (0 == https_download_sha256_starts(&sha256)) ? CY_RSLT_SUCCESS : CY_RSLT_TYPE_ERROR;
+            continue;
+        }
+
+        if (HTTPS_DOWNLOAD_CHUNK_INVALID == chunk)
+        {
+            status = CY_RSLT_TYPE_ERROR;
+            break;
+        }
+
+        failures = 0u;
+        status = https_download_write(flash_address + result->length, response.body,
+                                      response.body_len, &erased_end);
+        if (CY_RSLT_SUCCESS != status)
+        {
+            ERR_INFO(("Failed to write the flash at address 0x%08"PRIX32".\n",
+                      flash_address + result->length));
+            break;
+        }
+
+        if (0 != https_download_sha256_update(&sha256, response.body, response.body_len))
+        {
+            status = CY_RSLT_TYPE_ERROR;
+            break;
+        }
+
+        if (((result->length + (uint32_t)response.body_len) / HTTPS_DOWNLOAD_PROGRESS_STEP) !=
+            (result->length / HTTPS_DOWNLOAD_PROGRESS_STEP))
+        {
+            APP_INFO(("Downloaded %"PRIu32" of %"PRIu32" bytes\n",
+                      result->length + (uint32_t)response.body_len, total));
+        }
+
+        result->length += (uint32_t)response.body_len;
+        if (result->length == total)
+        {
+            break;
+        }
+    }
+
+    if ((CY_RSLT_SUCCESS == status) &&
+        (0 != https_download_sha256_finish(&sha256, result->sha256)))
+    {
+        status = CY_RSLT_TYPE_ERROR;
+    }
+
+    mbedtls_sha256_free(&sha256);
+
+    if ((CY_RSLT_SUCCESS == status) && check_digest &&
+        (0 != memcmp(expected, result->sha256, HTTPS_DOWNLOAD_SHA256_LEN)))
+    {
+        ERR_INFO(("The SHA-256 digest of the download does not match the expected one.\n"));
+        status = CY_RSLT_TYPE_ERROR;
+    }
+
+    return status;
+}
+
+
+/* [] END OF FILE */
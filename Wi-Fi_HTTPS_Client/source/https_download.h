@@ -0,0 +1,110 @@
+/******************************************************************************
+* File Name: https_download.h
+*
+* Description: This file contains declarations of the streaming HTTPS download,
+* which fetches a resource in HTTP Range requests and writes it to the external
+* QSPI NOR flash as it arrives.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2023-2025, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef HTTPS_DOWNLOAD_H_
+#define HTTPS_DOWNLOAD_H_
+
+/* Standard C header file */
+#include <stdint.h>
+
+/* HTTP client header file */
+#include "cy_http_client_api.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Bytes of the resource requested at a time. The download buffer holds one
+ * chunk, so the RAM used does not depend on the size of the resource.
+ */
+#ifndef HTTPS_DOWNLOAD_CHUNK_LENGTH
+#define HTTPS_DOWNLOAD_CHUNK_LENGTH              (4096u)
+#endif
+
+/* Room in the download buffer for the request headers and, after them, for the
+ * response headers that come before the chunk.
+ */
+#ifndef HTTPS_DOWNLOAD_HEADER_LENGTH
+#define HTTPS_DOWNLOAD_HEADER_LENGTH             (1024u)
+#endif
+
+/* Failed requests in a row after which a download is given up. The client
+ * reconnects after each failure and resumes at the first missing byte.
+ */
+#ifndef HTTPS_DOWNLOAD_MAX_RETRIES
+#define HTTPS_DOWNLOAD_MAX_RETRIES               (5u)
+#endif
+
+/* Delay before reconnecting after a failed request. */
+#ifndef HTTPS_DOWNLOAD_RETRY_DELAY_MS
+#define HTTPS_DOWNLOAD_RETRY_DELAY_MS            (1000u)
+#endif
+
+/* Longest ETag kept to detect a resource that changes during a download. */
+#define HTTPS_DOWNLOAD_ETAG_MAX_LEN              (64u)
+
+/* Length of a SHA-256 digest. */
+#define HTTPS_DOWNLOAD_SHA256_LEN                (32u)
+
+/*******************************************************************************
+* Data structure and enumeration
+********************************************************************************/
+/* Outcome of a download. */
+typedef struct
+{
+    uint32_t length;                               /* Bytes written to the flash */
+    uint32_t requests;                             /* Range requests sent */
+    uint32_t resumes;                              /* Reconnections during the download */
+    uint32_t restarts;                             /* Restarts after the resource changed */
+    uint8_t sha256[HTTPS_DOWNLOAD_SHA256_LEN];     /* Digest of the bytes written */
+} https_download_result_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t https_download_to_flash(const char *host, uint16_t port, const char *resource_path,
+                                  uint32_t flash_address, uint32_t max_length,
+                                  const char *expected_sha256,
+                                  https_download_result_t *result);
+
+#endif /* HTTPS_DOWNLOAD_H_ */
+
+
+/* [] END OF FILE */
@@ -54,9 +54,10 @@
 #include <task.h>
 
 /* Include serial flash library and QSPI memory configurations only for the
- * kits that require the Wi-Fi firmware to be loaded in external QSPI NOR flash.
+ * kits that require the Wi-Fi firmware to be loaded in external QSPI NOR flash,
+ * or to download to it.
  */
-#if defined(CY_ENABLE_XIP_PROGRAM)
+#if defined(CY_ENABLE_XIP_PROGRAM) || (HTTPS_DOWNLOAD_ENABLED)
 #include "cy_serial_flash_qspi.h"
 #include "cycfg_qspi_memslot.h"
 #endif
@@ -108,13 +109,15 @@ int main(void)
     cy_retarget_io_init(CYBSP_DEBUG_UART_TX, CYBSP_DEBUG_UART_RX, CY_RETARGET_IO_BAUDRATE);
 
     /* Init QSPI and enable XIP to get the Wi-Fi firmware from the QSPI NOR flash */
-    #if defined(CY_ENABLE_XIP_PROGRAM)
+    #if defined(CY_ENABLE_XIP_PROGRAM) || (HTTPS_DOWNLOAD_ENABLED)
         const uint32_t bus_frequency = 50000000lu;
 
         cy_serial_flash_qspi_init(smifMemConfigs[0], CYBSP_QSPI_D0, CYBSP_QSPI_D1,
                                       CYBSP_QSPI_D2, CYBSP_QSPI_D3, NC, NC, NC, NC,
                                       CYBSP_QSPI_SCK, CYBSP_QSPI_SS, bus_frequency);
+    #endif
 
+    #if defined(CY_ENABLE_XIP_PROGRAM)
         cy_serial_flash_qspi_enable_xip(true);
     #endif
 
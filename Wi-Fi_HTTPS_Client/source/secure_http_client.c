@@ -63,8 +63,22 @@
 #include "cy_http_client_api.h"
 #include "secure_keys.h"
 
+#if(USE_DER_CREDENTIALS)
+/* DER form of the credentials, generated by scripts/pem_to_der.py. */
+#include "secure_keys_der.h"
+#endif
+
 #include "lwip/ip_addr.h"
 
+/* Pool of HTTPS clients with kept-alive connections. */
+#include "https_client_pool.h"
+
+#if (HTTPS_DOWNLOAD_ENABLED)
+/* Streaming download to the QSPI flash. */
+#include "https_download.h"
+#include <inttypes.h>
+#endif
+
 /*******************************************************************************
 * Global Variables
 ********************************************************************************/
@@ -74,17 +88,18 @@ cy_http_client_method_t http_client_method;
 /* Holds the IP address obtained using Wi-Fi Connection Manager (WCM). */
 static cy_wcm_ip_address_t ip_addr;
 
-/* Secure HTTP client instance. */
-static cy_http_client_t https_client;
+#if(USE_DER_CREDENTIALS)
+/* TLS credentials of the HTTPS client in DER form. */
+static const uint8_t https_client_cert[] = keyCLIENT_CERTIFICATE_DER;
+static const uint8_t https_client_key[] = keyCLIENT_PRIVATE_KEY_DER;
+static const uint8_t https_server_ca_cert[] = keySERVER_ROOTCA_DER;
+#endif
 
 /* Holds the security configuration such as client certificate,
  * client key, and rootCA.
  */
 cy_awsport_ssl_credentials_t security_config;
 
-/* Secure HTTP server information. */
-cy_awsport_server_info_t server_info;
-
 /*Buffer to store get response*/
 uint8_t http_get_buffer[HTTP_GET_BUFFER_LENGTH];
 
@@ -100,8 +115,11 @@ cy_http_client_response_t http_response;
 void http_request(void);
 void fetch_https_client_method(void);
 void disconnect_callback_handler(cy_http_client_t handle, cy_http_client_disconn_type_t type, void *args);
-cy_rslt_t send_http_request(cy_http_client_t handle,cy_http_client_method_t method,const char * pPath);
+cy_rslt_t send_http_request(cy_http_client_method_t method,const char * pPath);
 static cy_rslt_t configure_https_client(void);
+#if (HTTPS_DOWNLOAD_ENABLED)
+void https_download(void);
+#endif
 
 /********************************************************************************
  * Function Name: wifi_connect
@@ -188,58 +206,45 @@ void disconnect_callback_handler(cy_http_client_t handle, cy_http_client_disconn
  * Function Name: send_http_request
  *******************************************************************************
  * Summary:
- *  The function handles an http send operation.
+ *  The function handles an http send operation. The request goes through the
+ *  client pool, which reuses the open connection to the server and the headers
+ *  already built for the method and path.
  *
  * Parameters:
- *  void
+ *  cy_http_client_method_t method: Method of the request
+ *  const char *pPath: Path of the resource
  *
  * Return:
  *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the secure HTTP client is configured
  *  successfully, otherwise, it returns CY_RSLT_TYPE_ERROR.
  *
  *******************************************************************************/
-cy_rslt_t send_http_request( cy_http_client_t handle, cy_http_client_method_t method,
-                               const char * pPath)
+cy_rslt_t send_http_request( cy_http_client_method_t method, const char * pPath)
 {
-    cy_http_client_request_header_t request;
     cy_http_client_header_t header;
 
     cy_http_client_response_t response;
 
-    /* Return value of all methods from the HTTP Client library API. */
-    cy_rslt_t http_status = CY_RSLT_SUCCESS;
+    https_client_pool_stats_t stats;
 
-    /* Initialize the response object. The same buffer used for storing
-     * request headers is reused here. */
-    request.buffer = http_get_buffer;
-    request.buffer_len = HTTP_GET_BUFFER_LENGTH;
+    TickType_t start = xTaskGetTickCount();
 
-    request.headers_len = HTTP_REQUEST_HEADER_LEN;
-    request.method = method;
-    request.range_end = HTTP_REQUEST_RANGE_END;
-    request.range_start = HTTP_REQUEST_RANGE_START;
-    request.resource_path = pPath;
+    /* Return value of all methods from the HTTP Client library API. */
+    cy_rslt_t http_status = CY_RSLT_SUCCESS;
 
     header.field = "Content-Type";
     header.field_len = sizeof("Content-Type")-1;
     header.value = "application/x-www-form-urlencoded";
     header.value_len = sizeof("application/x-www-form-urlencoded")-1;
 
-    http_status = cy_http_client_write_header(handle, &request, &header, NUM_HTTP_HEADERS);
+    /* The same buffer holds the request headers, then the response. */
+    http_status = https_client_pool_send(HTTPS_SERVER_HOST, HTTPS_PORT, method, pPath, &header,
+                                         NUM_HTTP_HEADERS, (const uint8_t *)REQUEST_BODY,
+                                         REQUEST_BODY_LENGTH, http_get_buffer,
+                                         HTTP_GET_BUFFER_LENGTH, &response);
     if( http_status != CY_RSLT_SUCCESS )
     {
-        printf("\nWrite Header ----------- Fail \n");
-        return http_status;
-    }
-    else
-    {
-        printf( "\n Sending Request Headers:\n%.*s\n",( int ) request.headers_len, ( char * ) request.buffer);
-    }
-
-    http_status = cy_http_client_send(handle, &request, (uint8_t *)REQUEST_BODY, REQUEST_BODY_LENGTH, &response);
-    if( http_status != CY_RSLT_SUCCESS )
-    {
-        printf("\nFailed to send HTTP method=%d\n Error=%ld\r\n",request.method,(unsigned long)http_status);
+        printf("\nFailed to send HTTP method=%d\n Error=%ld\r\n",method,(unsigned long)http_status);
         return http_status;
     }
     else
@@ -251,7 +256,7 @@ cy_rslt_t send_http_request( cy_http_client_t handle, cy_http_client_method_t me
                    "Response Status :\n %u \n"
                    "Response Body   :\n %.*s\n",
                    ( int ) sizeof(HTTPS_SERVER_HOST)-1, HTTPS_SERVER_HOST,
-                   ( int ) sizeof(request.resource_path) -1, request.resource_path,
+                   ( int ) strlen(pPath), pPath,
                    ( int ) response.headers_len, response.header,
                    response.status_code,
                    ( int ) response.body_len, response.body ) );
@@ -259,6 +264,11 @@ cy_rslt_t send_http_request( cy_http_client_t handle, cy_http_client_method_t me
         }
         printf("\n buffer_len:[%d] headers_len:[%d] header_count:[%d] body_len:[%d] content_len:[%d]\n",
                  response.buffer_len, response.headers_len, response.header_count, response.body_len, response.content_len);
+
+        https_client_pool_get_stats(&stats);
+        printf(" Response in %lu ms. Connections opened: %lu, requests on an open connection: %lu\n",
+                 (unsigned long)((xTaskGetTickCount() - start) * portTICK_PERIOD_MS),
+                 (unsigned long)stats.connects, (unsigned long)stats.reuses);
     }
 
     return http_status;
@@ -281,21 +291,25 @@ cy_rslt_t send_http_request( cy_http_client_t handle, cy_http_client_method_t me
 static cy_rslt_t configure_https_client(void)
 {
     cy_rslt_t result = CY_RSLT_SUCCESS;
-    cy_http_disconnect_callback_t http_cb;
 
     ( void ) memset( &security_config, 0, sizeof( security_config ) );
-    ( void ) memset( &server_info, 0, sizeof( server_info ) );
 
     /* Set the credential information. */
+#if(USE_DER_CREDENTIALS)
+    security_config.client_cert      = (const char *) https_client_cert;
+    security_config.client_cert_size = keyCLIENT_CERTIFICATE_DER_LEN;
+    security_config.private_key      = (const char *) https_client_key;
+    security_config.private_key_size = keyCLIENT_PRIVATE_KEY_DER_LEN;
+    security_config.root_ca          = (const char *) https_server_ca_cert;
+    security_config.root_ca_size     = keySERVER_ROOTCA_DER_LEN;
+#else
     security_config.client_cert      = (const char *) &keyCLIENT_CERTIFICATE_PEM;
     security_config.client_cert_size = sizeof( keyCLIENT_CERTIFICATE_PEM );
     security_config.private_key      = (const char *) &keyCLIENT_PRIVATE_KEY_PEM;
     security_config.private_key_size = sizeof( keyCLIENT_PRIVATE_KEY_PEM );
     security_config.root_ca          = (const char *) &keySERVER_ROOTCA_PEM;
     security_config.root_ca_size     = sizeof( keySERVER_ROOTCA_PEM );
-
-    server_info.host_name = HTTPS_SERVER_HOST;
-    server_info.port = HTTPS_PORT;
+#endif /* USE_DER_CREDENTIALS */
 
     /* Initialize the HTTP Client Library. */
     result = cy_http_client_init();
@@ -304,16 +318,10 @@ static cy_rslt_t configure_https_client(void)
         /* Failure path. */
         ERR_INFO(("Failed to initialize http client.\n"));
     }
-
-    http_cb = disconnect_callback_handler;
-
-    /* Create an instance of the HTTP client. */
-    result = cy_http_client_create(&security_config, &server_info, http_cb, NULL, &https_client);
-
-    if( result != CY_RSLT_SUCCESS )
+    else
     {
-        /* Failure path */
-        ERR_INFO(("Failed to create http client.\n"));
+        /* The pool creates an HTTP client for each server on its first request. */
+        https_client_pool_init(&security_config, disconnect_callback_handler);
     }
     return result;
 }
@@ -339,6 +347,7 @@ static cy_rslt_t configure_https_client(void)
 void https_client_task(void *arg)
 {
     cy_rslt_t result = CY_RSLT_TYPE_ERROR;
+    cy_http_client_t https_client;
 
     (void)arg;
 
@@ -352,8 +361,10 @@ void https_client_task(void *arg)
     result = configure_https_client();
     PRINT_AND_ASSERT(result, "Failed to configure the HTTPS client.\n");
 
-    /* Connect the HTTP client to server. */
-    result = cy_http_client_connect(https_client, TRANSPORT_SEND_RECV_TIMEOUT_MS, TRANSPORT_SEND_RECV_TIMEOUT_MS);
+    /* Connect the HTTP client to server. The connection stays open for the
+     * next requests.
+     */
+    result = https_client_pool_get(HTTPS_SERVER_HOST, HTTPS_PORT, &https_client);
     if( result != CY_RSLT_SUCCESS )
     {
         ERR_INFO(("Failed to connect to the http server.\n"));
@@ -426,6 +437,14 @@ void fetch_https_client_method(void)
              get_after_put_flag = true;
              break;
          }
+#if (HTTPS_DOWNLOAD_ENABLED)
+         case HTTPS_DOWNLOAD_TO_FLASH:
+         {
+             printf("\n HTTPS Download to Flash..\n");
+             https_download();
+             return;
+         }
+#endif
         default:
         {
             printf("\x1b[2J\x1b[;H");
@@ -458,11 +477,11 @@ void http_request(void)
     if(get_after_put_flag)
     {
         get_after_put_flag = false;
-        result = send_http_request(https_client,http_client_method,HTTP_GET_PATH_AFTER_PUT);
+        result = send_http_request(http_client_method,HTTP_GET_PATH_AFTER_PUT);
     }
     else
     {
-        result = send_http_request(https_client,http_client_method,HTTP_PATH);
+        result = send_http_request(http_client_method,HTTP_PATH);
     }
 
     if( result != CY_RSLT_SUCCESS )
@@ -475,4 +494,51 @@ void http_request(void)
         printf("\r\n The http status code is :: %d\r\n",http_response.status_code);
     }
 }
+
+#if (HTTPS_DOWNLOAD_ENABLED)
+/*******************************************************************************
+ * Function Name: https_download
+ *******************************************************************************
+ * Summary:
+ *  Downloads HTTP_DOWNLOAD_PATH to the download area of the QSPI flash and
+ *  prints the length and SHA-256 digest of the download.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+void https_download(void)
+{
+    https_download_result_t download;
+    TickType_t start = xTaskGetTickCount();
+    uint32_t elapsed_ms;
+    cy_rslt_t result;
+
+    result = https_download_to_flash(HTTPS_SERVER_HOST, HTTPS_PORT, HTTP_DOWNLOAD_PATH,
+                                     HTTPS_DOWNLOAD_FLASH_ADDRESS, HTTPS_DOWNLOAD_FLASH_LENGTH,
+                                     HTTPS_DOWNLOAD_SHA256, &download);
+    elapsed_ms = (uint32_t)((xTaskGetTickCount() - start) * portTICK_PERIOD_MS);
+
+    if (CY_RSLT_SUCCESS != result)
+    {
+        ERR_INFO(("Failed to download %s after %"PRIu32" bytes.\n", HTTP_DOWNLOAD_PATH, download.length));
+        return;
+    }
+
+    printf("\r\n Downloaded %"PRIu32" bytes of %s to flash address 0x%08"PRIX32" in %"PRIu32" ms\r\n",
+           download.length, HTTP_DOWNLOAD_PATH, (uint32_t) HTTPS_DOWNLOAD_FLASH_ADDRESS, elapsed_ms);
+    printf(" Requests: %"PRIu32", resumed: %"PRIu32", restarted: %"PRIu32"\r\n",
+           download.requests, download.resumes, download.restarts);
+    printf(" SHA-256: ");
+    for (uint32_t i = 0u; i < HTTPS_DOWNLOAD_SHA256_LEN; i++)
+    {
+        printf("%02x", download.sha256[i]);
+    }
+    printf("\r\n");
+}
+#endif /* HTTPS_DOWNLOAD_ENABLED */
+
 /* [] END OF FILE */
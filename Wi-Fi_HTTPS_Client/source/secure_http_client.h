@@ -55,6 +55,14 @@
 
 #define TEST_INFO( x )                        printf x
 
+/* Embed the certificates and keys of secure_keys.h in DER form, which mbedTLS
+ * parses without Base64 decoding. CREDENTIALS_DER=1 in the Makefile sets it
+ * and generates secure_keys_der.h with scripts/pem_to_der.py before the build.
+ */
+#ifndef USE_DER_CREDENTIALS
+#define USE_DER_CREDENTIALS                      (0)
+#endif
+
 /* Wi-Fi Credentials: Modify WIFI_SSID and WIFI_PASSWORD to match your Wi-Fi network
  * Credentials.
  */
@@ -106,6 +114,36 @@
 /*Length of the request header.*/
 #define HTTP_REQUEST_HEADER_LEN                  (0)
 
+/* Download a resource to the external QSPI NOR flash with menu option 5. Set
+ * this to 0 for a kit without QSPI flash.
+ */
+#ifndef HTTPS_DOWNLOAD_ENABLED
+#define HTTPS_DOWNLOAD_ENABLED                   (1)
+#endif
+
+/* Resource downloaded to the flash. The server has to support Range requests
+ * for a resource larger than HTTPS_DOWNLOAD_CHUNK_LENGTH bytes.
+ */
+#define HTTP_DOWNLOAD_PATH                       "/download.bin"
+
+/* Area of the QSPI flash that holds the download. It starts on an erase
+ * sector boundary, above the Wi-Fi firmware that XIP builds place at the
+ * start of the flash.
+ */
+#define HTTPS_DOWNLOAD_FLASH_ADDRESS             (0x00800000u)
+#define HTTPS_DOWNLOAD_FLASH_LENGTH              (0x00800000u)
+
+/* SHA-256 digest expected for the download, as 64 hexadecimal digits, such as
+ * the output of 'sha256sum'. Leave it empty to only print the digest.
+ */
+#define HTTPS_DOWNLOAD_SHA256                    ""
+
+#if (HTTPS_DOWNLOAD_ENABLED)
+#define HTTPS_DOWNLOAD_MENU                      "5. HTTPS_DOWNLOAD_TO_FLASH\n"
+#else
+#define HTTPS_DOWNLOAD_MENU                      ""
+#endif
+
 /* HTTPS Menu for options to select the method from keyboard  */
 #define MENU_HTTPS_METHOD                                                           \
         "\n"                                                                        \
@@ -115,6 +153,7 @@
         "2. HTTPS_POST_METHOD\n"                                                    \
         "3. HTTPS_PUT_METHOD\n"                                                     \
         "4. HTTPS_GET_METHOD_AFTER_PUT\n"                                           \
+        HTTPS_DOWNLOAD_MENU                                                         \
 
 /******************************************************
  *                   Enumerations
@@ -126,6 +165,7 @@ typedef enum
     HTTPS_POST_METHOD,
     HTTPS_PUT_METHOD,
     HTTPS_GET_METHOD_AFTER_PUT,
+    HTTPS_DOWNLOAD_TO_FLASH,
 } https_menu_t;
 
 /*******************************************************************************
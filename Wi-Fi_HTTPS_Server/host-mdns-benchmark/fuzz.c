@@ -0,0 +1,825 @@
+/******************************************************************************
+* File Name: fuzz.c
+*
+* Description: This is the host fuzz test and benchmark of the name parser of
+* the mDNS responder of the HTTPS server. It mutates recorded queries and
+* replies, splits them in chains of packet buffers, and checks that the
+* zero-copy parser of ../source/mdns.c reads every name as the copying parser
+* does. It then passes the mutated packets to the responder, to be built with
+* the address and undefined behavior sanitizers, while it browses for the
+* mutated instances of the replies, and measures the matching of received
+* names with the names of the host by both parsers.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2025, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Standard C header files */
+#define _POSIX_C_SOURCE 199309L
+#include <time.h>
+
+/* lwIP shim and application header files */
+#include "lwip_shim.h"
+#include "secure_http_server.h"
+
+/* The responder, to reach its parser functions */
+#include "../source/mdns.c"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Default number of mutated packets, and seed of the mutations. */
+#define FUZZ_ITERATIONS                          (100000u)
+#define FUZZ_SEED                                (0x6D444E53u)
+
+/* Largest packet of the corpus, and number of packets kept. */
+#define FUZZ_MAX_PACKET_LEN                      (1024u)
+#define FUZZ_MAX_CORPUS                          (48u)
+
+/* Largest number of mutations of a packet. */
+#define FUZZ_MAX_MUTATIONS                       (4u)
+
+/* Largest packet buffer of a chain; 0 is one piece. */
+#define FUZZ_MAX_SEGMENT                         (32u)
+
+/* Packet buffer size of the chains of the measurement, as small buffers of
+ * a network driver.
+ */
+#define BENCHMARK_SEGMENT                        (64u)
+
+/* Number of times the names of the corpus are matched for the measurement. */
+#define BENCHMARK_ROUNDS                         (200000u)
+
+/* Port of a legacy querier, which is not the mDNS port. */
+#define FUZZ_LEGACY_PORT                         (49152u)
+
+/*******************************************************************************
+* Data structure and enumeration
+*******************************************************************************/
+typedef struct
+{
+    u8_t data[FUZZ_MAX_PACKET_LEN];
+    u16_t length;
+} fuzz_packet_t;
+
+/* Name of a query of the corpus. Names that start with '@' are completed
+ * with the host name.
+ */
+typedef struct
+{
+    const char *name;
+    u16_t type;
+} fuzz_question_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+/* Queries that the corpus starts with, as in the trace of main.c. The
+ * replies of the responder, with compressed names, are added to them.
+ */
+static const fuzz_question_t questions[] =
+{
+    { "_services._dns-sd._udp.local", DNS_RRTYPE_PTR },
+    { "_googlecast._tcp.local", DNS_RRTYPE_PTR },
+    { "_https._tcp.local", DNS_RRTYPE_PTR },
+    { "@._https._tcp.local", DNS_RRTYPE_SRV },
+    { "@._HTTPS._tcp.local", DNS_RRTYPE_TXT },
+    { "livingroom-tv.local", DNS_RRTYPE_A },
+    { "@.local", DNS_RRTYPE_A },
+    { "@.LOCAL", DNS_RRTYPE_AAAA },
+    { "@.local", DNS_RRTYPE_ANY },
+    { "_spotify-connect._tcp.local", DNS_RRTYPE_PTR },
+    { "100.1.168.192.in-addr.arpa", DNS_RRTYPE_PTR },
+    { "printer.local", DNS_RRTYPE_A },
+};
+
+#define QUESTIONS_LENGTH                         (sizeof(questions) / sizeof(questions[0]))
+
+static fuzz_packet_t corpus[FUZZ_MAX_CORPUS];
+static uint32_t corpus_length;
+
+/* Number of queries at the start of the corpus. */
+static uint32_t corpus_queries;
+
+static struct netif netif;
+static const ip_addr_t querier_v4 = IPADDR4_INIT(PP_HTONL(0xC0A80117UL));
+static const ip_addr_t querier_v6 = IPADDR6_INIT(PP_HTONL(0xFE800000UL), 0, 0, PP_HTONL(0x00000001UL));
+static const ip_addr_t group_v4 = DNS_MQUERY_IPV4_GROUP_INIT;
+static const ip_addr_t group_v6 = DNS_MQUERY_IPV6_GROUP_INIT;
+
+static uint32_t random_state = FUZZ_SEED;
+static uint32_t failures;
+
+/* Names read by both parsers, names accepted only by the copying parser
+ * because they are cut off by the end of the packet, and matches that only
+ * the copying parser finds because a label holds a zero byte.
+ */
+static uint32_t names_read;
+static uint32_t names_cut_off;
+static uint32_t zero_byte_matches;
+
+/* Events reported by the browse of the mutated replies. */
+static uint32_t browse_events;
+
+/*******************************************************************************
+ * Function Name: now_ns
+ *******************************************************************************
+ * Summary:
+ *  Returns a monotonic time stamp.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  double: Time in nanoseconds
+ *
+ *******************************************************************************/
+static double now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((double)ts.tv_sec * 1e9) + (double)ts.tv_nsec;
+}
+
+/*******************************************************************************
+ * Function Name: check
+ *******************************************************************************
+ * Summary:
+ *  Counts and reports a failed check, once per description.
+ *
+ * Parameters:
+ *  int condition: Result of the check
+ *  const char *what: Description of the check
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void check(int condition, const char *what)
+{
+    static const char *reported;
+
+    if (!condition)
+    {
+        if (what != reported)
+        {
+            printf("FAILED: %s\n", what);
+            reported = what;
+        }
+        failures++;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: random_below
+ *******************************************************************************
+ * Summary:
+ *  Returns a pseudo-random number, the same ones at each run.
+ *
+ * Parameters:
+ *  uint32_t limit: Upper bound, excluded
+ *
+ * Return:
+ *  uint32_t: Number between 0 and limit - 1
+ *
+ *******************************************************************************/
+static uint32_t random_below(uint32_t limit)
+{
+    /* xorshift32 */
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state % limit;
+}
+
+/*******************************************************************************
+ * Function Name: record_packet
+ *******************************************************************************
+ * Summary:
+ *  Adds a packet sent by the responder to the corpus.
+ *
+ * Parameters:
+ *  const struct pbuf *p: Packet sent
+ *  const ip_addr_t *dst_ip: Destination address
+ *  u16_t dst_port: Destination port
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void record_packet(const struct pbuf *p, const ip_addr_t *dst_ip, u16_t dst_port)
+{
+    (void)dst_ip;
+    (void)dst_port;
+    if ((corpus_length < FUZZ_MAX_CORPUS) && (p->tot_len <= FUZZ_MAX_PACKET_LEN))
+    {
+        corpus[corpus_length].length = pbuf_copy_partial(p, corpus[corpus_length].data, p->tot_len, 0);
+        corpus_length++;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: browse_callback
+ *******************************************************************************
+ * Summary:
+ *  Checks and counts an instance reported by the browse.
+ *
+ * Parameters:
+ *  struct netif *browse_netif: Network interface of the browse
+ *  u8_t event: MDNS_BROWSE_RESOLVED or MDNS_BROWSE_GONE
+ *  const char *instance: Instance name
+ *  const ip_addr_t *addr: Address of the instance, NULL when gone
+ *  u16_t port: Port of the instance
+ *  void *arg: Unused
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void browse_callback(struct netif *browse_netif, u8_t event, const char *instance, const ip_addr_t *addr,
+                            u16_t port, void *arg)
+{
+    (void)port;
+    (void)arg;
+    check((&netif == browse_netif) && (strlen(instance) <= MDNS_LABEL_MAXLEN) &&
+          ((MDNS_BROWSE_RESOLVED == event) == (NULL != addr)), "report an instance");
+    browse_events++;
+}
+
+/*******************************************************************************
+ * Function Name: add_query
+ *******************************************************************************
+ * Summary:
+ *  Adds a query with one question to the corpus. Every other query lists a
+ *  known answer whose name and target point to the question name.
+ *
+ * Parameters:
+ *  const fuzz_question_t *question: The question
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void add_query(const fuzz_question_t *question)
+{
+    fuzz_packet_t *packet = &corpus[corpus_length++];
+    u8_t *data = packet->data;
+    char expanded[256];
+    const char *label;
+    uint32_t length = SIZEOF_DNS_HDR;
+
+    memset(data, 0, SIZEOF_DNS_HDR);
+    data[5] = 1;
+    (void)snprintf(expanded, sizeof(expanded), "%s%s", ('@' == question->name[0]) ? HTTPS_SERVER_NAME : "",
+                   ('@' == question->name[0]) ? &question->name[1] : question->name);
+
+    label = expanded;
+    while ('\0' != *label)
+    {
+        const char *dot = strchr(label, '.');
+        uint32_t label_length = (NULL != dot) ? (uint32_t)(dot - label) : (uint32_t)strlen(label);
+
+        data[length++] = (u8_t)label_length;
+        memcpy(&data[length], label, label_length);
+        length += label_length;
+        label += label_length + ((NULL != dot) ? 1u : 0u);
+    }
+    data[length++] = 0;
+    data[length++] = (u8_t)(question->type >> 8);
+    data[length++] = (u8_t)question->type;
+    data[length++] = 0;
+    data[length++] = DNS_RRCLASS_IN;
+
+    if (0u != (corpus_length & 1u))
+    {
+        /* PTR answer to the question name, pointing to its second label */
+        const u8_t answer[] =
+        {
+            0xC0, SIZEOF_DNS_HDR, 0, DNS_RRTYPE_PTR, 0, DNS_RRCLASS_IN, 0, 0, 0, MDNS_TTL_SECONDS,
+            0, 2, 0xC0, (u8_t)(SIZEOF_DNS_HDR + 1u + data[SIZEOF_DNS_HDR])
+        };
+
+        memcpy(&data[length], answer, sizeof(answer));
+        length += sizeof(answer);
+        data[7] = 1;
+    }
+
+    packet->length = (u16_t)length;
+}
+
+/*******************************************************************************
+ * Function Name: build_corpus
+ *******************************************************************************
+ * Summary:
+ *  Starts the responder with the HTTPS service, and fills the corpus with
+ *  the queries and the packets that the responder sends: its probes,
+ *  announcements, and replies to the queries.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void build_corpus(void)
+{
+    ip_addr_t address;
+    uint32_t i;
+
+    /* 192.168.1.100, with a preferred IPv6 address */
+    netif.ip_addr = (ip_addr_t)IPADDR4_INIT(PP_HTONL(0xC0A80164UL));
+    netif.ip6_addr[0] = (ip_addr_t)IPADDR6_INIT(PP_HTONL(0xFE800000UL), 0, PP_HTONL(0x021122FFUL), PP_HTONL(0xFE334455UL));
+    netif.ip6_addr_state[0] = IP6_ADDR_PREFERRED;
+
+    for (i = 0; i < QUESTIONS_LENGTH; i++)
+    {
+        add_query(&questions[i]);
+    }
+    corpus_queries = corpus_length;
+
+    netif_list = &netif;
+    lwip_shim_set_send_callback(record_packet);
+    mdns_resp_init();
+    check(ERR_OK == mdns_resp_add_netif(&netif, HTTPS_SERVER_NAME, MDNS_TTL_SECONDS), "add the network interface");
+    check(mdns_resp_add_service(&netif, HTTPS_SERVER_NAME, "_https", DNSSD_PROTO_TCP, HTTPS_PORT,
+                                MDNS_TTL_SECONDS, NULL, NULL) >= 0, "add the HTTPS service");
+    for (i = 0; i < 8u; i++)
+    {
+        lwip_shim_run_timers();
+    }
+
+    for (i = 0; i < corpus_queries; i++)
+    {
+        lwip_shim_advance_time(2000u);
+        lwip_shim_input(&netif, corpus[i].data, corpus[i].length, &querier_v4, LWIP_IANA_PORT_MDNS, &group_v4);
+    }
+    lwip_shim_set_send_callback(NULL);
+
+    /* Browse the HTTPS services of the replies, whose instances become other
+     * hosts once mutated, and ask for the address of the host */
+    check(mdns_browse_start(&netif, "_https", DNSSD_PROTO_TCP, browse_callback, NULL) >= 0, "start a browse");
+    check(ERR_INPROGRESS == mdns_resolve_host(&netif, HTTPS_SERVER_NAME, &address), "ask for an address");
+}
+
+/*******************************************************************************
+ * Function Name: mutate
+ *******************************************************************************
+ * Summary:
+ *  Applies random mutations to a packet: bit flips, random bytes, label
+ *  lengths, compression pointers anywhere in the packet (loops included),
+ *  case changes, and truncation.
+ *
+ * Parameters:
+ *  fuzz_packet_t *packet: The packet
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void mutate(fuzz_packet_t *packet)
+{
+    uint32_t mutations = 1u + random_below(FUZZ_MAX_MUTATIONS);
+    uint32_t i;
+
+    for (i = 0; (i < mutations) && (packet->length > 0u); i++)
+    {
+        uint32_t position = random_below(packet->length);
+        u8_t *byte = &packet->data[position];
+
+        switch (random_below(6u))
+        {
+            case 0:
+                *byte ^= (u8_t)(1u << random_below(8u));
+                break;
+
+            case 1:
+                *byte = (u8_t)random_below(256u);
+                break;
+
+            case 2:
+                *byte = (u8_t)random_below(MDNS_LABEL_MAXLEN + 8u);
+                break;
+
+            case 3:
+                if ((position + 1u) < packet->length)
+                {
+                    uint32_t target = random_below(packet->length + 2u);
+
+                    byte[0] = (u8_t)(0xC0u | (target >> 8));
+                    byte[1] = (u8_t)target;
+                }
+                break;
+
+            case 4:
+                *byte ^= 0x20u;
+                break;
+
+            default:
+                packet->length = (u16_t)position;
+                break;
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: swap_case
+ *******************************************************************************
+ * Summary:
+ *  Swaps the case of the letters of the labels of a domain.
+ *
+ * Parameters:
+ *  struct mdns_domain *domain: The domain
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void swap_case(struct mdns_domain *domain)
+{
+    u16_t pos = 0;
+    u16_t i;
+
+    while ((pos < domain->length) && (0u != domain->name[pos]))
+    {
+        u8_t length = domain->name[pos++];
+
+        for (i = 0; i < length; i++, pos++)
+        {
+            u8_t lower = (u8_t)(domain->name[pos] | 0x20u);
+
+            if ((lower >= 'a') && (lower <= 'z'))
+            {
+                domain->name[pos] ^= 0x20u;
+            }
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: has_zero_byte
+ *******************************************************************************
+ * Summary:
+ *  Checks whether a label of a domain holds a zero byte, which ends the
+ *  comparison of lwip_strnicmp() in mdns_domain_eq().
+ *
+ * Parameters:
+ *  const struct mdns_domain *domain: The domain
+ *
+ * Return:
+ *  int: 1 if a label holds a zero byte
+ *
+ *******************************************************************************/
+static int has_zero_byte(const struct mdns_domain *domain)
+{
+    u16_t pos = 0;
+    u16_t i;
+
+    while ((pos < domain->length) && (0u != domain->name[pos]))
+    {
+        u8_t length = domain->name[pos++];
+
+        for (i = 0; i < length; i++, pos++)
+        {
+            if (0u == domain->name[pos])
+            {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: check_name
+ *******************************************************************************
+ * Summary:
+ *  Reads the name at an offset of a packet with both parsers, and checks
+ *  that they agree on where it ends, on its length, and on which
+ *  names of the host it matches. The copying parser also accepts a name cut
+ *  off by the end of the packet, reading a zero byte past it: the zero-copy
+ *  parser must then read the name of the packet padded with a zero byte.
+ *
+ * Parameters:
+ *  struct pbuf *p: The packet
+ *  struct pbuf *padded: The packet followed by a zero byte
+ *  u16_t offset: Offset of the name
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void check_name(struct pbuf *p, struct pbuf *padded, u16_t offset)
+{
+    struct mdns_host *mdns = NETIF_TO_HOST(&netif);
+    struct mdns_service *service = mdns->services[0];
+    const struct mdns_domain *domains[4];
+    struct mdns_domain domain;
+    struct mdns_domain swapped;
+    struct mdns_name name;
+    u16_t end;
+    u16_t end_ref;
+    uint32_t i;
+
+    domains[0] = &mdns->host_domain;
+    domains[1] = &dnssd_domain;
+    domains[2] = &service->type_domain;
+    domains[3] = &service->instance_domain;
+
+    end = mdns_readname(p, offset, &domain);
+    end_ref = mdns_readname_ref(p, offset, &name);
+
+    if (MDNS_READNAME_ERROR == end_ref)
+    {
+        if (MDNS_READNAME_ERROR != end)
+        {
+            end_ref = mdns_readname_ref(padded, offset, &name);
+            check((end_ref == end) && (name.length == domain.length), "read names cut off by the end");
+            names_cut_off++;
+        }
+        return;
+    }
+
+    names_read++;
+    check(end_ref == end, "end names where the copying parser does");
+    check(name.length == domain.length, "read the length of names");
+    check(mdns_name_eq(&name, &domain), "match names with their copy");
+
+    swapped = domain;
+    swap_case(&swapped);
+    check(mdns_name_eq(&name, &swapped), "match names ignoring case");
+
+    for (i = 0; i < 4u; i++)
+    {
+        int copied = mdns_domain_eq(&domain, (struct mdns_domain *)domains[i]);
+        int referenced = mdns_name_eq(&name, domains[i]);
+
+        if (copied && !referenced && has_zero_byte(&domain))
+        {
+            zero_byte_matches++;
+        }
+        else
+        {
+            check(copied == referenced, "match names of the host as the copying parser");
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: fuzz_packet
+ *******************************************************************************
+ * Summary:
+ *  Checks the names at every offset of a packet split in a random chain of
+ *  packet buffers, then passes the packet to the responder.
+ *
+ * Parameters:
+ *  const fuzz_packet_t *packet: The packet
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void fuzz_packet(const fuzz_packet_t *packet)
+{
+    u8_t data[FUZZ_MAX_PACKET_LEN + 1u];
+    struct pbuf *p;
+    struct pbuf *padded;
+    u16_t offset;
+
+    /* One piece in a quarter of the packets */
+    lwip_shim_set_input_segment((u16_t)((0u == random_below(4u)) ? 0u : 1u + random_below(FUZZ_MAX_SEGMENT)));
+
+    memcpy(data, packet->data, packet->length);
+    data[packet->length] = 0;
+    p = lwip_shim_alloc_chain(data, packet->length);
+    padded = lwip_shim_alloc_chain(data, (u16_t)(packet->length + 1u));
+    for (offset = SIZEOF_DNS_HDR; offset < packet->length; offset++)
+    {
+        check_name(p, padded, offset);
+    }
+    (void)pbuf_free(p);
+    (void)pbuf_free(padded);
+
+    lwip_shim_advance_time(random_below(2000u));
+    if (0u == random_below(2u))
+    {
+        lwip_shim_input(&netif, packet->data, packet->length, &querier_v4,
+                        (0u == random_below(4u)) ? FUZZ_LEGACY_PORT : LWIP_IANA_PORT_MDNS, &group_v4);
+    }
+    else
+    {
+        lwip_shim_input(&netif, packet->data, packet->length, &querier_v6,
+                        (0u == random_below(4u)) ? FUZZ_LEGACY_PORT : LWIP_IANA_PORT_MDNS, &group_v6);
+    }
+    check(0u == lwip_shim_stats.pbufs_in_use, "free every packet buffer");
+
+    /* Queries and expiry of the record cache */
+    if (0u == random_below(8u))
+    {
+        lwip_shim_run_timers();
+        check(0u == lwip_shim_stats.pbufs_in_use, "free every packet buffer");
+    }
+}
+
+/*******************************************************************************
+ * Function Name: match_copied
+ *******************************************************************************
+ * Summary:
+ *  Matches the first name of a query with the names of the host as the
+ *  responder did before, copying it out of the packet.
+ *
+ * Parameters:
+ *  struct pbuf *p: The query
+ *
+ * Return:
+ *  int: Number of names of the host matched
+ *
+ *******************************************************************************/
+static int match_copied(struct pbuf *p)
+{
+    struct mdns_host *mdns = NETIF_TO_HOST(&netif);
+    struct mdns_service *service = mdns->services[0];
+    struct mdns_domain domain;
+
+    if (MDNS_READNAME_ERROR == mdns_readname(p, SIZEOF_DNS_HDR, &domain))
+    {
+        return 0;
+    }
+    return mdns_domain_eq(&domain, &mdns->host_domain) + mdns_domain_eq(&domain, &dnssd_domain) +
+           mdns_domain_eq(&domain, &service->type_domain) + mdns_domain_eq(&domain, &service->instance_domain);
+}
+
+/*******************************************************************************
+ * Function Name: match_referenced
+ *******************************************************************************
+ * Summary:
+ *  Matches the first name of a query with the names of the host as the
+ *  responder does, without copying it.
+ *
+ * Parameters:
+ *  struct pbuf *p: The query
+ *
+ * Return:
+ *  int: Number of names of the host matched
+ *
+ *******************************************************************************/
+static int match_referenced(struct pbuf *p)
+{
+    struct mdns_host *mdns = NETIF_TO_HOST(&netif);
+    struct mdns_service *service = mdns->services[0];
+    struct mdns_name name;
+
+    if (MDNS_READNAME_ERROR == mdns_readname_ref(p, SIZEOF_DNS_HDR, &name))
+    {
+        return 0;
+    }
+    return mdns_name_eq(&name, &mdns->host_domain) + mdns_name_eq(&name, &dnssd_domain) +
+           mdns_name_eq(&name, &service->type_domain) + mdns_name_eq(&name, &service->instance_domain);
+}
+
+/*******************************************************************************
+ * Function Name: measure
+ *******************************************************************************
+ * Summary:
+ *  Measures the matching of the question names of the queries of the corpus
+ *  with the names of the host, by the copying and the zero-copy parsers.
+ *
+ * Parameters:
+ *  u16_t segment: Packet buffer size of the queries, 0 for one piece
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void measure(u16_t segment)
+{
+    struct pbuf *queries[FUZZ_MAX_CORPUS];
+    int matches_copied = 0;
+    int matches_referenced = 0;
+    double start;
+    double copied_ns;
+    double referenced_ns;
+    uint32_t round;
+    uint32_t i;
+
+    lwip_shim_set_input_segment(segment);
+    for (i = 0; i < corpus_queries; i++)
+    {
+        queries[i] = lwip_shim_alloc_chain(corpus[i].data, corpus[i].length);
+    }
+
+    start = now_ns();
+    for (round = 0; round < BENCHMARK_ROUNDS; round++)
+    {
+        for (i = 0; i < corpus_queries; i++)
+        {
+            matches_copied += match_copied(queries[i]);
+        }
+    }
+    copied_ns = (now_ns() - start) / (BENCHMARK_ROUNDS * corpus_queries);
+
+    start = now_ns();
+    for (round = 0; round < BENCHMARK_ROUNDS; round++)
+    {
+        for (i = 0; i < corpus_queries; i++)
+        {
+            matches_referenced += match_referenced(queries[i]);
+        }
+    }
+    referenced_ns = (now_ns() - start) / (BENCHMARK_ROUNDS * corpus_queries);
+
+    for (i = 0; i < corpus_queries; i++)
+    {
+        (void)pbuf_free(queries[i]);
+    }
+
+    check((matches_copied == matches_referenced) && (matches_copied > 0), "match the queries of the corpus");
+    printf("Name matching, %s: %.0f ns copying, %.0f ns zero-copy per question\n",
+           (0u == segment) ? "packets in one piece" : "chains of 64-byte buffers", copied_ns, referenced_ns);
+}
+
+/*******************************************************************************
+ * Function Name: main
+ *******************************************************************************
+ * Summary:
+ *  Builds the corpus, checks the parsers and the responder with mutated
+ *  packets, and measures the name matching.
+ *
+ * Parameters:
+ *  int argc: Number of arguments
+ *  char *argv[]: Optional number of mutated packets
+ *
+ * Return:
+ *  int: Number of failed checks.
+ *
+ *******************************************************************************/
+int main(int argc, char *argv[])
+{
+    uint32_t iterations = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : FUZZ_ITERATIONS;
+    fuzz_packet_t packet;
+    uint32_t i;
+
+    build_corpus();
+    printf("Corpus: %u queries, %u packets of the responder\n", (unsigned)corpus_queries,
+           (unsigned)(corpus_length - corpus_queries));
+
+    for (i = 0; i < corpus_length; i++)
+    {
+        fuzz_packet(&corpus[i]);
+    }
+    for (i = 0; i < iterations; i++)
+    {
+        packet = corpus[random_below(corpus_length)];
+        mutate(&packet);
+        fuzz_packet(&packet);
+    }
+    printf("%u mutated packets: %u names read, %u cut off by the end of the packet, "
+           "%u matches of labels with a zero byte\n",
+           (unsigned)iterations, (unsigned)names_read, (unsigned)names_cut_off, (unsigned)zero_byte_matches);
+    printf("Browse of the mutated replies: %u instances reported\n", (unsigned)browse_events);
+
+    measure(0u);
+    measure(BENCHMARK_SEGMENT);
+    printf("Name of a question: %u bytes referenced instead of %u bytes copied\n",
+           (unsigned)sizeof(struct mdns_name), (unsigned)sizeof(struct mdns_domain));
+
+    if (0u != failures)
+    {
+        printf("%u checks failed\n", (unsigned)failures);
+    }
+
+    return (int)failures;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,1080 @@
+/******************************************************************************
+* File Name: main.c
+*
+* Description: This is the host benchmark of the mDNS responder of the HTTPS
+* server. It replays a trace of the queries seen on a busy LAN to
+* ../source/mdns.c, built with lwIP shims, and measures the time and packet
+* buffer allocations per query. The replies sent while the names and
+* addresses of the host change are written to a file, so that the builds
+* with and without the reply cache can be compared byte for byte. It also
+* checks the known-answer suppression and the multicast rate limit.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2025, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Standard C header files */
+#define _POSIX_C_SOURCE 199309L
+#include <time.h>
+
+/* lwIP shim and application header files */
+#include "lwip_shim.h"
+#include "secure_http_server.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Number of times the trace is replayed for the measurement. */
+#define BENCHMARK_REPLAYS                        (20000u)
+
+/* Largest query of the trace. */
+#define BENCHMARK_QUERY_MAX_LEN                  (512u)
+
+/* Maximum number of questions of a query of the trace. */
+#define BENCHMARK_MAX_QUESTIONS                  (2u)
+
+/* Port of a legacy querier, which is not the mDNS port. */
+#define BENCHMARK_LEGACY_PORT                    (49152u)
+
+/* Number of resolves from the record cache measured. */
+#define BENCHMARK_RESOLVES                       (1000000u)
+
+/* TTLs of the records of the peer that the browse finds, in seconds. */
+#define PEER_PTR_TTL_SECONDS                     (4500u)
+#define PEER_TTL_SECONDS                         (120u)
+
+/* Port of the service of the peer. */
+#define PEER_PORT                                (631u)
+
+/* Time between two queries of the trace, and between two queries of a
+ * burst, in milliseconds.
+ */
+#define BENCHMARK_QUERY_INTERVAL_MS              (100u)
+#define BENCHMARK_BURST_INTERVAL_MS              (10u)
+
+/* Names of the trace that the benchmark replaces with names of the host. */
+#define TRACE_HOST_PREFIX                        '@'
+#define TRACE_REVERSE_V4                         "@v4"
+#define TRACE_REVERSE_V6                         "@v6"
+/* Known answer with the first IPv6 address of the host. */
+#define TRACE_ADDRESS_V6                         "@aaaa"
+
+/*******************************************************************************
+* Data structure and enumeration
+*******************************************************************************/
+/* Question of a query. Names that start with TRACE_HOST_PREFIX are completed
+ * with the current host name, such as "@.local" or "@._https._tcp.local".
+ */
+typedef struct
+{
+    const char *name;
+    u16_t type;
+} trace_question_t;
+
+/* Query of the trace. */
+typedef struct
+{
+    trace_question_t questions[BENCHMARK_MAX_QUESTIONS];
+    /* Set the unicast-response bit of the questions. */
+    u8_t unicast_response;
+    /* Send from BENCHMARK_LEGACY_PORT instead of the mDNS port. */
+    u8_t legacy;
+    /* Send over IPv6 instead of IPv4. */
+    u8_t ipv6;
+    /* Target of a PTR known answer for the first question, TRACE_ADDRESS_V6
+     * for an AAAA known answer, or NULL.
+     */
+    const char *known_answer;
+} trace_query_t;
+
+/* Encoded query of the trace. */
+typedef struct
+{
+    u8_t data[BENCHMARK_QUERY_MAX_LEN];
+    u16_t length;
+    const trace_query_t *query;
+} encoded_query_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+/* Queries of a busy LAN: most of them are for other hosts and services, the
+ * others ask for the HTTPS server as a browser or a service browser would.
+ */
+static const trace_query_t trace[] =
+{
+    { { { "_services._dns-sd._udp.local", DNS_RRTYPE_PTR } }, 0, 0, 0, NULL },
+    { { { "_googlecast._tcp.local", DNS_RRTYPE_PTR } }, 0, 0, 0, NULL },
+    { { { "_https._tcp.local", DNS_RRTYPE_PTR } }, 0, 0, 0, NULL },
+    { { { "_airplay._tcp.local", DNS_RRTYPE_PTR }, { "_raop._tcp.local", DNS_RRTYPE_PTR } }, 0, 0, 1, NULL },
+    { { { "@._https._tcp.local", DNS_RRTYPE_SRV }, { "@._https._tcp.local", DNS_RRTYPE_TXT } }, 1, 0, 0, NULL },
+    { { { "livingroom-tv.local", DNS_RRTYPE_A } }, 0, 0, 0, NULL },
+    { { { "@.local", DNS_RRTYPE_A }, { "@.local", DNS_RRTYPE_AAAA } }, 0, 0, 0, NULL },
+    { { { "_spotify-connect._tcp.local", DNS_RRTYPE_PTR } }, 0, 0, 1, NULL },
+    { { { "@.local", DNS_RRTYPE_A } }, 1, 0, 0, NULL },
+    { { { "macbook.local", DNS_RRTYPE_AAAA } }, 0, 0, 1, NULL },
+    { { { "_https._tcp.local", DNS_RRTYPE_PTR } }, 0, 0, 0, "@._https._tcp.local" },
+    { { { "_ipp._tcp.local", DNS_RRTYPE_PTR } }, 0, 0, 0, NULL },
+    { { { "@.local", DNS_RRTYPE_ANY } }, 0, 0, 1, NULL },
+    { { { "_companion-link._tcp.local", DNS_RRTYPE_PTR } }, 0, 0, 1, NULL },
+    { { { TRACE_REVERSE_V4, DNS_RRTYPE_PTR } }, 0, 0, 0, NULL },
+    { { { "23.1.168.192.in-addr.arpa", DNS_RRTYPE_PTR } }, 0, 0, 0, NULL },
+    { { { TRACE_REVERSE_V6, DNS_RRTYPE_PTR } }, 0, 0, 1, NULL },
+    { { { "_sleep-proxy._udp.local", DNS_RRTYPE_PTR } }, 0, 0, 0, NULL },
+    { { { "@.local", DNS_RRTYPE_A } }, 0, 1, 0, NULL },
+    { { { "@.local", DNS_RRTYPE_AAAA } }, 0, 0, 1, TRACE_ADDRESS_V6 },
+    { { { "printer.local", DNS_RRTYPE_A }, { "printer.local", DNS_RRTYPE_AAAA } }, 0, 0, 0, NULL },
+};
+
+#define TRACE_LENGTH                             (sizeof(trace) / sizeof(trace[0]))
+
+static encoded_query_t encoded_trace[TRACE_LENGTH];
+
+static struct netif netif;
+static char host_name[MDNS_LABEL_MAXLEN + 1] = HTTPS_SERVER_NAME;
+
+/* Querier addresses and the mDNS multicast groups. */
+static const ip_addr_t querier_v4 = IPADDR4_INIT(PP_HTONL(0xC0A80117UL));
+static const ip_addr_t querier_v6 = IPADDR6_INIT(PP_HTONL(0xFE800000UL), 0, 0, PP_HTONL(0x00000001UL));
+static const ip_addr_t group_v4 = DNS_MQUERY_IPV4_GROUP_INIT;
+static const ip_addr_t group_v6 = DNS_MQUERY_IPV6_GROUP_INIT;
+
+/* Revision of the TXT record of the service. */
+static uint32_t txt_revision;
+
+/* File that receives the replies, if any. */
+static FILE *replies_file;
+static uint32_t replies_digest = 2166136261u;
+static uint32_t replies_bytes;
+static uint32_t failures;
+
+/* Simulated time between two queries of a replay. */
+static u32_t query_interval_ms = BENCHMARK_QUERY_INTERVAL_MS;
+
+/* Peer that the browse finds: a printer at 192.168.1.50. */
+static const ip_addr_t peer_v4 = IPADDR4_INIT(PP_HTONL(0xC0A80132UL));
+
+/* Last packet sent by the responder while browsing. */
+static u8_t last_sent[BENCHMARK_QUERY_MAX_LEN];
+static u16_t last_sent_length;
+
+/* Last event of the browse. */
+static uint32_t browse_events;
+static u8_t browse_event;
+static char browse_instance[MDNS_LABEL_MAXLEN + 1];
+static ip_addr_t browse_addr;
+static u16_t browse_port;
+
+/*******************************************************************************
+ * Function Name: now_ns
+ *******************************************************************************
+ * Summary:
+ *  Returns a monotonic time stamp.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  double: Time in nanoseconds
+ *
+ *******************************************************************************/
+static double now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((double)ts.tv_sec * 1e9) + (double)ts.tv_nsec;
+}
+
+/*******************************************************************************
+ * Function Name: check
+ *******************************************************************************
+ * Summary:
+ *  Counts and reports a failed check.
+ *
+ * Parameters:
+ *  int condition: Result of the check
+ *  const char *what: Description of the check
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void check(int condition, const char *what)
+{
+    if (!condition)
+    {
+        printf("FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: record_reply
+ *******************************************************************************
+ * Summary:
+ *  Adds a packet sent by the responder to the digest of the replies and
+ *  writes it, with its destination, to the replies file.
+ *
+ * Parameters:
+ *  const struct pbuf *p: Packet sent
+ *  const ip_addr_t *dst_ip: Destination address
+ *  u16_t dst_port: Destination port
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void record_reply(const struct pbuf *p, const ip_addr_t *dst_ip, u16_t dst_port)
+{
+    u8_t record[4 + sizeof(dst_ip->u_addr.ip6.addr)];
+    const u8_t *data = (const u8_t *)p->payload;
+    uint32_t i;
+
+    record[0] = (u8_t)(p->tot_len >> 8);
+    record[1] = (u8_t)p->tot_len;
+    record[2] = (u8_t)(dst_port >> 8);
+    record[3] = (u8_t)dst_port;
+    memcpy(&record[4], dst_ip->u_addr.ip6.addr, sizeof(dst_ip->u_addr.ip6.addr));
+    if (!IP_IS_V6(dst_ip))
+    {
+        memset(&record[8], 0, sizeof(record) - 8);
+    }
+
+    for (i = 0; i < sizeof(record); i++)
+    {
+        replies_digest = (replies_digest ^ record[i]) * 16777619u;
+    }
+    for (i = 0; i < p->tot_len; i++)
+    {
+        replies_digest = (replies_digest ^ data[i]) * 16777619u;
+    }
+    replies_bytes += p->tot_len;
+
+    if (NULL != replies_file)
+    {
+        (void)fwrite(record, 1, sizeof(record), replies_file);
+        (void)fwrite(data, 1, p->tot_len, replies_file);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: record_query
+ *******************************************************************************
+ * Summary:
+ *  Keeps the last packet sent by the responder, to check the questions of the
+ *  queries sent while browsing.
+ *
+ * Parameters:
+ *  const struct pbuf *p: Packet sent
+ *  const ip_addr_t *dst_ip: Destination address
+ *  u16_t dst_port: Destination port
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void record_query(const struct pbuf *p, const ip_addr_t *dst_ip, u16_t dst_port)
+{
+    (void)dst_ip;
+    (void)dst_port;
+    last_sent_length = pbuf_copy_partial(p, last_sent, sizeof(last_sent), 0);
+}
+
+/*******************************************************************************
+ * Function Name: browse_callback
+ *******************************************************************************
+ * Summary:
+ *  Keeps the last instance reported by the browse.
+ *
+ * Parameters:
+ *  struct netif *netif: Network interface of the browse
+ *  u8_t event: MDNS_BROWSE_RESOLVED or MDNS_BROWSE_GONE
+ *  const char *instance: Instance name
+ *  const ip_addr_t *addr: Address of the instance, NULL when gone
+ *  u16_t port: Port of the instance
+ *  void *arg: Unused
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void browse_callback(struct netif *netif, u8_t event, const char *instance, const ip_addr_t *addr,
+                            u16_t port, void *arg)
+{
+    (void)netif;
+    (void)arg;
+    browse_events++;
+    browse_event = event;
+    (void)snprintf(browse_instance, sizeof(browse_instance), "%s", instance);
+    if (NULL != addr)
+    {
+        browse_addr = *addr;
+    }
+    browse_port = port;
+}
+
+/*******************************************************************************
+ * Function Name: txt_callback
+ *******************************************************************************
+ * Summary:
+ *  Adds the TXT items of the HTTPS service, which carry the revision of the
+ *  record.
+ *
+ * Parameters:
+ *  struct mdns_service *service: The service
+ *  void *txt_userdata: Unused
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void txt_callback(struct mdns_service *service, void *txt_userdata)
+{
+    char item[16];
+    int length = snprintf(item, sizeof(item), "rev=%u", (unsigned)txt_revision);
+
+    (void)txt_userdata;
+    (void)mdns_resp_add_service_txtitem(service, "path=/", 6);
+    (void)mdns_resp_add_service_txtitem(service, item, (u8_t)length);
+}
+
+/*******************************************************************************
+ * Function Name: encode_name
+ *******************************************************************************
+ * Summary:
+ *  Encodes a domain name of the trace as DNS labels, without compression.
+ *
+ * Parameters:
+ *  const char *name: Dotted name, possibly a name of the host
+ *  u8_t *out: Where to write the labels
+ *
+ * Return:
+ *  uint32_t: Number of bytes written
+ *
+ *******************************************************************************/
+static uint32_t encode_name(const char *name, u8_t *out)
+{
+    char expanded[256];
+    const u8_t *address;
+    uint32_t length = 0;
+    const char *label;
+    int i;
+
+    if (0 == strcmp(name, TRACE_REVERSE_V4))
+    {
+        address = (const u8_t *)netif_ip4_addr(&netif);
+        (void)snprintf(expanded, sizeof(expanded), "%u.%u.%u.%u.in-addr.arpa",
+                       address[3], address[2], address[1], address[0]);
+    }
+    else if (0 == strcmp(name, TRACE_REVERSE_V6))
+    {
+        address = (const u8_t *)netif_ip6_addr(&netif, 0)->addr;
+        expanded[0] = '\0';
+        for (i = 15; i >= 0; i--)
+        {
+            (void)snprintf(&expanded[strlen(expanded)], sizeof(expanded) - strlen(expanded), "%x.%x.",
+                           address[i] & 0x0F, address[i] >> 4);
+        }
+        (void)snprintf(&expanded[strlen(expanded)], sizeof(expanded) - strlen(expanded), "ip6.arpa");
+    }
+    else if (TRACE_HOST_PREFIX == name[0])
+    {
+        (void)snprintf(expanded, sizeof(expanded), "%s%s", host_name, &name[1]);
+    }
+    else
+    {
+        (void)snprintf(expanded, sizeof(expanded), "%s", name);
+    }
+
+    label = expanded;
+    while ('\0' != *label)
+    {
+        const char *dot = strchr(label, '.');
+        uint32_t label_length = (NULL != dot) ? (uint32_t)(dot - label) : (uint32_t)strlen(label);
+
+        out[length++] = (u8_t)label_length;
+        memcpy(&out[length], label, label_length);
+        length += label_length;
+        label += label_length + ((NULL != dot) ? 1u : 0u);
+    }
+    out[length++] = 0;
+
+    return length;
+}
+
+/*******************************************************************************
+ * Function Name: decode_sent_name
+ *******************************************************************************
+ * Summary:
+ *  Decodes a possibly compressed domain name of the last packet sent.
+ *
+ * Parameters:
+ *  uint32_t offset: Offset of the name in the packet
+ *  char *out: Where to write the dotted name, 256 bytes
+ *
+ * Return:
+ *  uint32_t: Offset after the name, or 0 if the name is malformed
+ *
+ *******************************************************************************/
+static uint32_t decode_sent_name(uint32_t offset, char *out)
+{
+    uint32_t end = 0;
+    uint32_t length = 0;
+    uint32_t jumps = 0;
+
+    while (offset < last_sent_length)
+    {
+        u8_t c = last_sent[offset];
+
+        if (0 == c)
+        {
+            out[length] = '\0';
+            return (0 != end) ? end : (offset + 1);
+        }
+        if (0xC0 == (c & 0xC0))
+        {
+            if ((offset + 1 >= last_sent_length) || (++jumps > 5))
+            {
+                return 0;
+            }
+            if (0 == end)
+            {
+                end = offset + 2;
+            }
+            offset = ((uint32_t)(c & 0x3F) << 8) | last_sent[offset + 1];
+            continue;
+        }
+        if ((offset + 1 + c > last_sent_length) || (length + c + 2 > 256))
+        {
+            return 0;
+        }
+        if (0 != length)
+        {
+            out[length++] = '.';
+        }
+        memcpy(&out[length], &last_sent[offset + 1], c);
+        length += c;
+        offset += 1 + c;
+    }
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: sent_question
+ *******************************************************************************
+ * Summary:
+ *  Checks whether the last packet sent is a query with the given question.
+ *
+ * Parameters:
+ *  const char *name: Dotted name of the question
+ *  u16_t type: Type of the question
+ *
+ * Return:
+ *  int: 1 if the query asks the question, 0 otherwise
+ *
+ *******************************************************************************/
+static int sent_question(const char *name, u16_t type)
+{
+    char decoded[256];
+    uint32_t offset = SIZEOF_DNS_HDR;
+    uint32_t questions;
+    uint32_t q;
+
+    if ((last_sent_length < SIZEOF_DNS_HDR) || (0 != (last_sent[2] & DNS_FLAG1_RESPONSE)))
+    {
+        return 0;
+    }
+    questions = ((uint32_t)last_sent[4] << 8) | last_sent[5];
+    for (q = 0; q < questions; q++)
+    {
+        offset = decode_sent_name(offset, decoded);
+        if ((0 == offset) || (offset + 4 > last_sent_length))
+        {
+            return 0;
+        }
+        if ((0 == strcmp(decoded, name)) && (type == (((u16_t)last_sent[offset] << 8) | last_sent[offset + 1])))
+        {
+            return 1;
+        }
+        offset += 4;
+    }
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: append_record
+ *******************************************************************************
+ * Summary:
+ *  Appends a resource record with an uncompressed name to a response.
+ *
+ * Parameters:
+ *  u8_t *data: The response
+ *  uint32_t length: Length of the response so far
+ *  const char *name: Dotted owner name
+ *  u16_t type: Record type
+ *  u32_t ttl: TTL in seconds
+ *  const u8_t *rdata: Record data
+ *  uint32_t rdlength: Length of rdata
+ *
+ * Return:
+ *  uint32_t: New length of the response
+ *
+ *******************************************************************************/
+static uint32_t append_record(u8_t *data, uint32_t length, const char *name, u16_t type, u32_t ttl,
+                              const u8_t *rdata, uint32_t rdlength)
+{
+    length += encode_name(name, &data[length]);
+    data[length++] = (u8_t)(type >> 8);
+    data[length++] = (u8_t)type;
+    data[length++] = 0;
+    data[length++] = DNS_RRCLASS_IN;
+    data[length++] = (u8_t)(ttl >> 24);
+    data[length++] = (u8_t)(ttl >> 16);
+    data[length++] = (u8_t)(ttl >> 8);
+    data[length++] = (u8_t)ttl;
+    data[length++] = (u8_t)(rdlength >> 8);
+    data[length++] = (u8_t)rdlength;
+    memcpy(&data[length], rdata, rdlength);
+
+    return length + rdlength;
+}
+
+/*******************************************************************************
+ * Function Name: send_peer_response
+ *******************************************************************************
+ * Summary:
+ *  Passes the response of the printer to the browse query to the responder:
+ *  the PTR record of its instance, with its SRV and A records as additional
+ *  records. A PTR TTL of 0 sends the goodbye of the instance only.
+ *
+ * Parameters:
+ *  u32_t ptr_ttl: TTL of the PTR record in seconds
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void send_peer_response(u32_t ptr_ttl)
+{
+    u8_t data[BENCHMARK_QUERY_MAX_LEN];
+    u8_t rdata[64];
+    uint32_t length = SIZEOF_DNS_HDR;
+    uint32_t rdlength;
+
+    memset(data, 0, SIZEOF_DNS_HDR);
+    data[2] = DNS_FLAG1_RESPONSE | DNS_FLAG1_AUTHORATIVE;
+    data[7] = 1;
+
+    rdlength = encode_name("Office Printer._ipp._tcp.local", rdata);
+    length = append_record(data, length, "_ipp._tcp.local", DNS_RRTYPE_PTR, ptr_ttl, rdata, rdlength);
+    if (0u != ptr_ttl)
+    {
+        memset(rdata, 0, 4);
+        rdata[4] = (u8_t)(PEER_PORT >> 8);
+        rdata[5] = (u8_t)PEER_PORT;
+        rdlength = 6 + encode_name("printer.local", &rdata[6]);
+        length = append_record(data, length, "Office Printer._ipp._tcp.local", DNS_RRTYPE_SRV, PEER_TTL_SECONDS,
+                               rdata, rdlength);
+        length = append_record(data, length, "printer.local", DNS_RRTYPE_A, PEER_TTL_SECONDS,
+                               (const u8_t *)&peer_v4.u_addr.ip4.addr, 4);
+        data[11] = 2;
+    }
+
+    lwip_shim_input(&netif, data, (u16_t)length, &peer_v4, LWIP_IANA_PORT_MDNS, &group_v4);
+}
+
+/*******************************************************************************
+ * Function Name: encode_trace
+ *******************************************************************************
+ * Summary:
+ *  Encodes the queries of the trace with the current names and addresses of
+ *  the host.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void encode_trace(void)
+{
+    uint32_t n;
+    uint32_t q;
+
+    for (n = 0; n < TRACE_LENGTH; n++)
+    {
+        const trace_query_t *query = &trace[n];
+        encoded_query_t *encoded = &encoded_trace[n];
+        u8_t *data = encoded->data;
+        uint32_t length = SIZEOF_DNS_HDR;
+        uint32_t questions = 0;
+
+        memset(data, 0, SIZEOF_DNS_HDR);
+        data[0] = (u8_t)(n >> 8);
+        data[1] = (u8_t)n;
+
+        for (q = 0; (q < BENCHMARK_MAX_QUESTIONS) && (NULL != query->questions[q].name); q++)
+        {
+            length += encode_name(query->questions[q].name, &data[length]);
+            data[length++] = (u8_t)(query->questions[q].type >> 8);
+            data[length++] = (u8_t)query->questions[q].type;
+            data[length++] = query->unicast_response ? 0x80 : 0x00;
+            data[length++] = DNS_RRCLASS_IN;
+            questions++;
+        }
+        data[5] = (u8_t)questions;
+
+        if (NULL != query->known_answer)
+        {
+            /* PTR or AAAA answer with the name of the first question and a full TTL */
+            u8_t ptr = (0 != strcmp(query->known_answer, TRACE_ADDRESS_V6));
+            uint32_t rdlength_offset;
+
+            data[length++] = 0xC0;
+            data[length++] = SIZEOF_DNS_HDR;
+            data[length++] = 0;
+            data[length++] = ptr ? DNS_RRTYPE_PTR : DNS_RRTYPE_AAAA;
+            data[length++] = 0;
+            data[length++] = DNS_RRCLASS_IN;
+            data[length++] = 0;
+            data[length++] = 0;
+            data[length++] = (u8_t)(MDNS_TTL_SECONDS >> 8);
+            data[length++] = (u8_t)MDNS_TTL_SECONDS;
+            rdlength_offset = length;
+            length += 2;
+            if (ptr)
+            {
+                length += encode_name(query->known_answer, &data[length]);
+            }
+            else
+            {
+                memcpy(&data[length], netif_ip6_addr(&netif, 0)->addr, 16);
+                length += 16;
+            }
+            data[rdlength_offset + 1] = (u8_t)(length - rdlength_offset - 2);
+            data[7] = 1;
+        }
+
+        encoded->length = (u16_t)length;
+        encoded->query = query;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: replay_query
+ *******************************************************************************
+ * Summary:
+ *  Passes a query of the trace to the responder, query_interval_ms after the
+ *  previous one.
+ *
+ * Parameters:
+ *  const encoded_query_t *encoded: The query
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void replay_query(const encoded_query_t *encoded)
+{
+    u16_t port = encoded->query->legacy ? BENCHMARK_LEGACY_PORT : LWIP_IANA_PORT_MDNS;
+
+    lwip_shim_advance_time(query_interval_ms);
+    if (encoded->query->ipv6)
+    {
+        lwip_shim_input(&netif, encoded->data, encoded->length, &querier_v6, port, &group_v6);
+    }
+    else
+    {
+        lwip_shim_input(&netif, encoded->data, encoded->length, &querier_v4, port, &group_v4);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: replay_trace
+ *******************************************************************************
+ * Summary:
+ *  Passes the queries of the trace to the responder.
+ *
+ * Parameters:
+ *  uint32_t replays: Number of times to replay the trace
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void replay_trace(uint32_t replays)
+{
+    uint32_t i;
+    uint32_t n;
+
+    for (i = 0; i < replays; i++)
+    {
+        for (n = 0; n < TRACE_LENGTH; n++)
+        {
+            replay_query(&encoded_trace[n]);
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: check_known_aaaa
+ *******************************************************************************
+ * Summary:
+ *  Sends the AAAA query of the trace that lists the first IPv6 address of the
+ *  host as known answer, more than MDNS_MULTICAST_INTERVAL_MS after the
+ *  previous query, and checks whether the responder answered it.
+ *
+ * Parameters:
+ *  int answered: 1 if the host has other IPv6 addresses, which must be sent
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void check_known_aaaa(int answered)
+{
+    uint32_t sent = lwip_shim_stats.packets_sent;
+    u32_t interval = query_interval_ms;
+    uint32_t n;
+
+    for (n = 0; n < TRACE_LENGTH; n++)
+    {
+        if ((NULL != trace[n].known_answer) && (0 == strcmp(trace[n].known_answer, TRACE_ADDRESS_V6)))
+        {
+            query_interval_ms = 2000u;
+            replay_query(&encoded_trace[n]);
+            query_interval_ms = interval;
+        }
+    }
+    check((lwip_shim_stats.packets_sent > sent) == answered,
+          answered ? "answer AAAA for the addresses missing from the known answers"
+                   : "suppress AAAA listed as known answers");
+}
+
+/*******************************************************************************
+ * Function Name: complete_probing
+ *******************************************************************************
+ * Summary:
+ *  Runs the probe timers of the responder until it announces its names.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void complete_probing(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < 8u; i++)
+    {
+        lwip_shim_run_timers();
+    }
+}
+
+/*******************************************************************************
+ * Function Name: check_stage
+ *******************************************************************************
+ * Summary:
+ *  Replays the trace twice with the current names and addresses, so that the
+ *  second replay can be answered from the reply cache, and checks that the
+ *  responder answered and freed its packet buffers.
+ *
+ * Parameters:
+ *  const char *stage: Description of the stage
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void check_stage(const char *stage)
+{
+    uint32_t sent = lwip_shim_stats.packets_sent;
+
+    encode_trace();
+    replay_trace(2u);
+    check(lwip_shim_stats.packets_sent > sent, stage);
+    check(0u == lwip_shim_stats.pbufs_in_use, "free every packet buffer");
+}
+
+/*******************************************************************************
+ * Function Name: run_timers_until_query
+ *******************************************************************************
+ * Summary:
+ *  Runs the timers of the responder until it sends a query with the given
+ *  question, or until the time limit.
+ *
+ * Parameters:
+ *  const char *name: Dotted name of the question
+ *  u16_t type: Type of the question
+ *  u32_t limit_ms: Time limit from now, in milliseconds
+ *
+ * Return:
+ *  u32_t: Time until the query was sent, in milliseconds, or 0 if it was not
+ *
+ *******************************************************************************/
+static u32_t run_timers_until_query(const char *name, u16_t type, u32_t limit_ms)
+{
+    u32_t start = sys_now();
+
+    while (sys_now() - start < limit_ms)
+    {
+        uint32_t sent = lwip_shim_stats.packets_sent;
+        u32_t before = sys_now();
+
+        lwip_shim_run_timers();
+        if ((lwip_shim_stats.packets_sent > sent) && sent_question(name, type))
+        {
+            return sys_now() - start;
+        }
+        if (sys_now() == before)
+        {
+            /* No timer pending */
+            break;
+        }
+    }
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: check_browse
+ *******************************************************************************
+ * Summary:
+ *  Browses the printers of the LAN: checks that the responder asks for them,
+ *  reports the printer that answers, resolves it from the record cache,
+ *  refreshes its records at 80% of their TTL, expires them and reports its
+ *  goodbye. Measures the resolve from the cache.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void check_browse(void)
+{
+    ip_addr_t addr;
+    u16_t port = 0;
+    u32_t response_time;
+    u32_t refresh_ms;
+    double start;
+    uint32_t i;
+    s8_t slot;
+
+    lwip_shim_set_send_callback(record_query);
+    slot = mdns_browse_start(&netif, "_ipp", DNSSD_PROTO_TCP, browse_callback, NULL);
+    check(slot >= 0, "start a browse");
+    check(0u != run_timers_until_query("_ipp._tcp.local", DNS_RRTYPE_PTR, 1000u), "query the browsed type");
+
+    send_peer_response(PEER_PTR_TTL_SECONDS);
+    response_time = sys_now();
+    check((1u == browse_events) && (MDNS_BROWSE_RESOLVED == browse_event) &&
+          (0 == strcmp(browse_instance, "Office Printer")) && ip_addr_cmp(&browse_addr, &peer_v4) &&
+          (PEER_PORT == browse_port), "report the instance found");
+
+    check(ERR_OK == mdns_resolve_service(&netif, "Office Printer", "_ipp", DNSSD_PROTO_TCP, &addr, &port) &&
+          ip_addr_cmp(&addr, &peer_v4) && (PEER_PORT == port), "resolve the instance from the cache");
+    check(ERR_OK == mdns_resolve_host(&netif, "Printer", &addr) && ip_addr_cmp(&addr, &peer_v4),
+          "resolve the host from the cache");
+    check(ERR_INPROGRESS == mdns_resolve_host(&netif, "scanner", &addr), "miss a host not cached");
+    check(0u != run_timers_until_query("scanner.local", DNS_RRTYPE_A, 1000u), "query a host not cached");
+
+    start = now_ns();
+    for (i = 0; i < BENCHMARK_RESOLVES; i++)
+    {
+        (void)mdns_resolve_service(&netif, "Office Printer", "_ipp", DNSSD_PROTO_TCP, &addr, &port);
+    }
+    printf("Resolve from the record cache: %.0f ns per service\n", (now_ns() - start) / BENCHMARK_RESOLVES);
+
+    /* The records resolved are asked for again at 80% of their TTL, then the
+     * printer goes silent */
+    refresh_ms = run_timers_until_query("printer.local", DNS_RRTYPE_A, PEER_TTL_SECONDS * 1000u);
+    if (0u != refresh_ms)
+    {
+        refresh_ms = sys_now() - response_time;
+    }
+    check((refresh_ms >= PEER_TTL_SECONDS * 800u) && (refresh_ms < PEER_TTL_SECONDS * 850u),
+          "refresh the address at 80% of its TTL");
+    (void)run_timers_until_query("none.local", DNS_RRTYPE_A, PEER_TTL_SECONDS * 1000u + response_time - sys_now());
+    check(ERR_INPROGRESS == mdns_resolve_service(&netif, "Office Printer", "_ipp", DNSSD_PROTO_TCP, &addr, &port),
+          "expire the location after its TTL");
+
+    send_peer_response(0u);
+    (void)run_timers_until_query("none.local", DNS_RRTYPE_A, 2000u);
+    check((2u == browse_events) && (MDNS_BROWSE_GONE == browse_event) &&
+          (0 == strcmp(browse_instance, "Office Printer")), "report the goodbye of the instance");
+
+    check(ERR_OK == mdns_browse_stop(slot), "stop the browse");
+    (void)run_timers_until_query("none.local", DNS_RRTYPE_A, 5000u);
+    check(0u == lwip_shim_stats.pbufs_in_use, "free every packet buffer");
+    lwip_shim_set_send_callback(NULL);
+}
+
+/*******************************************************************************
+ * Function Name: main
+ *******************************************************************************
+ * Summary:
+ *  Starts the responder with the HTTPS service, records the replies to the
+ *  trace while the names and addresses change, then measures the replay of
+ *  the trace.
+ *
+ * Parameters:
+ *  int argc: Number of arguments
+ *  char *argv[]: Optional name of the file that receives the replies
+ *
+ * Return:
+ *  int: Number of failed checks.
+ *
+ *******************************************************************************/
+int main(int argc, char *argv[])
+{
+    netif_ext_callback_args_t args;
+    struct mdns_resp_stats stats;
+    struct mdns_resp_stats stats_before;
+    lwip_shim_stats_t before;
+    s8_t slot;
+    double start;
+    double query_ns;
+
+    if (argc > 1)
+    {
+        replies_file = fopen(argv[1], "wb");
+        if (NULL == replies_file)
+        {
+            printf("Cannot write %s\n", argv[1]);
+            return 1;
+        }
+    }
+
+    /* 192.168.1.100, with a preferred and a tentative IPv6 address */
+    netif.ip_addr = (ip_addr_t)IPADDR4_INIT(PP_HTONL(0xC0A80164UL));
+    netif.ip6_addr[0] = (ip_addr_t)IPADDR6_INIT(PP_HTONL(0xFE800000UL), 0, PP_HTONL(0x021122FFUL), PP_HTONL(0xFE334455UL));
+    netif.ip6_addr_state[0] = IP6_ADDR_PREFERRED;
+    netif.ip6_addr[1] = (ip_addr_t)IPADDR6_INIT(PP_HTONL(0x20010DB8UL), 0, PP_HTONL(0x021122FFUL), PP_HTONL(0xFE334455UL));
+    netif.ip6_addr_state[1] = IP6_ADDR_TENTATIVE;
+
+    netif_list = &netif;
+
+    lwip_shim_set_send_callback(record_reply);
+    mdns_resp_init();
+    check(ERR_OK == mdns_resp_add_netif(&netif, host_name, MDNS_TTL_SECONDS), "add the network interface");
+    slot = mdns_resp_add_service(&netif, host_name, "_https", DNSSD_PROTO_TCP, HTTPS_PORT, MDNS_TTL_SECONDS,
+                                 txt_callback, NULL);
+    check(slot >= 0, "add the HTTPS service");
+    complete_probing();
+    check_stage("answer the trace");
+    check_known_aaaa(0);
+
+    strcpy(host_name, "mysecurehttpserver-2");
+    check(ERR_OK == mdns_resp_rename_netif(&netif, host_name), "rename the host");
+    complete_probing();
+    check_stage("answer the trace after a rename");
+
+    netif.ip_addr = (ip_addr_t)IPADDR4_INIT(PP_HTONL(0xC0A80165UL));
+    memset(&args, 0, sizeof(args));
+    netif_invoke_ext_callback(&netif, LWIP_NSC_IPV4_ADDRESS_CHANGED, &args);
+    check_stage("answer the trace after an IPv4 address change");
+
+    /* lwIP does not report this change to the responder without
+     * LWIP_NETIF_EXT_STATUS_CALLBACK.
+     */
+    netif.ip6_addr_state[1] = IP6_ADDR_PREFERRED;
+    check_stage("answer the trace after duplicate address detection");
+    check_known_aaaa(1);
+
+    txt_revision++;
+    check_stage("answer the trace after a TXT change");
+
+    check(ERR_OK == mdns_resp_del_service(&netif, slot), "delete the HTTPS service");
+    check_stage("answer the trace without the service");
+
+    slot = mdns_resp_add_service(&netif, host_name, "_https", DNSSD_PROTO_TCP, HTTPS_PORT, MDNS_TTL_SECONDS,
+                                 txt_callback, NULL);
+    check(slot >= 0, "add the HTTPS service again");
+    complete_probing();
+    check_stage("answer the trace with the service");
+
+    /* Many queriers asking at once: each answer is multicast once a second */
+    (void)mdns_resp_get_stats(&netif, &stats_before);
+    before = lwip_shim_stats;
+    query_interval_ms = BENCHMARK_BURST_INTERVAL_MS;
+    replay_trace(5u);
+    query_interval_ms = BENCHMARK_QUERY_INTERVAL_MS;
+    (void)mdns_resp_get_stats(&netif, &stats);
+    check(stats.answers_rate_limited > stats_before.answers_rate_limited, "rate limit a burst of queries");
+    printf("Burst of %u queries in %u ms: %u replies, %u answers rate limited\n",
+           (unsigned)(5u * TRACE_LENGTH), (unsigned)(5u * TRACE_LENGTH * BENCHMARK_BURST_INTERVAL_MS),
+           (unsigned)(lwip_shim_stats.packets_sent - before.packets_sent),
+           (unsigned)(stats.answers_rate_limited - stats_before.answers_rate_limited));
+
+    check(stats.known_answers_suppressed > 0u, "suppress known answers");
+    printf("Replies: %u bytes, digest %08x\n", (unsigned)replies_bytes, (unsigned)replies_digest);
+    if (NULL != replies_file)
+    {
+        (void)fclose(replies_file);
+    }
+
+    check_browse();
+
+    /* Measurement */
+    before = lwip_shim_stats;
+    start = now_ns();
+    replay_trace(BENCHMARK_REPLAYS);
+    query_ns = (now_ns() - start) / (BENCHMARK_REPLAYS * TRACE_LENGTH);
+    (void)mdns_resp_get_stats(&netif, &stats);
+
+    printf("Reply cache: %u entries\n", (unsigned)MDNS_REPLY_CACHE_ENTRIES);
+    printf("%u queries: %.0f ns per query, %.2f packet buffers and %.0f bytes allocated per query, "
+           "%u replies\n",
+           (unsigned)(BENCHMARK_REPLAYS * TRACE_LENGTH), query_ns,
+           (double)(lwip_shim_stats.pbuf_allocs - before.pbuf_allocs) / (BENCHMARK_REPLAYS * TRACE_LENGTH),
+           (double)(lwip_shim_stats.pbuf_alloc_bytes - before.pbuf_alloc_bytes) / (BENCHMARK_REPLAYS * TRACE_LENGTH),
+           (unsigned)(lwip_shim_stats.packets_sent - before.packets_sent));
+    printf("Responder: %u replies, %u known answers suppressed, %u answers rate limited\n",
+           (unsigned)stats.replies, (unsigned)stats.known_answers_suppressed,
+           (unsigned)stats.answers_rate_limited);
+
+    if (0u != failures)
+    {
+        printf("%u checks failed\n", (unsigned)failures);
+    }
+
+    return (int)failures;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,507 @@
+/******************************************************************************
+* File Name: lwip_shim.c
+*
+* Description: This file contains the host implementation of the lwIP
+* functions that the mDNS responder calls. It counts packet buffer
+* allocations, passes sent packets to the benchmark, and runs the responder
+* timers on request. Received packets can be split in chains of packet
+* buffers, as a network driver with small buffers does.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2025, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include "lwip_shim.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Number of pending timers. The responder runs one per network interface. */
+#define LWIP_SHIM_MAX_TIMERS                     (4u)
+
+/*******************************************************************************
+* Data structure and enumeration
+*******************************************************************************/
+typedef struct
+{
+    sys_timeout_handler handler;
+    void *arg;
+    u32_t msecs;
+} lwip_shim_timer_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+const ip_addr_t ip_addr_any = IPADDR4_INIT(0);
+const ip_addr_t ip6_addr_any = IPADDR6_INIT(0, 0, 0, 0);
+const ip_addr_t ip_addr_any_type = { { .ip6 = { { 0, 0, 0, 0 }, 0 } }, IPADDR_TYPE_ANY };
+
+lwip_shim_stats_t lwip_shim_stats;
+
+static struct udp_pcb shim_pcb;
+static udp_recv_fn shim_recv;
+static void *shim_recv_arg;
+static lwip_shim_send_fn shim_send;
+static netif_ext_callback_fn shim_ext_callback;
+static struct netif *shim_input_netif;
+static const ip_addr_t *shim_dest_addr;
+static lwip_shim_timer_t shim_timers[LWIP_SHIM_MAX_TIMERS];
+static u8_t shim_client_data_ids;
+static u32_t shim_now;
+static u16_t shim_input_segment;
+
+/*******************************************************************************
+* lwIP functions
+* Host stand-ins with the behavior that the responder relies on. Packet
+* buffers are allocated in one piece; only lwip_shim_input() builds chains.
+*******************************************************************************/
+void lwip_itoa(char *result, size_t bufsize, int number)
+{
+    (void)snprintf(result, bufsize, "%d", number);
+}
+
+int ip_addr_cmp(const ip_addr_t *addr1, const ip_addr_t *addr2)
+{
+    if (addr1->type != addr2->type)
+    {
+        return 0;
+    }
+    if (IP_IS_V6_VAL(*addr1))
+    {
+        return 0 == memcmp(addr1->u_addr.ip6.addr, addr2->u_addr.ip6.addr, sizeof(addr1->u_addr.ip6.addr));
+    }
+    return addr1->u_addr.ip4.addr == addr2->u_addr.ip4.addr;
+}
+
+struct pbuf *pbuf_alloc(pbuf_layer layer, u16_t length, pbuf_type type)
+{
+    struct pbuf *p = malloc(sizeof(struct pbuf) + length);
+
+    (void)layer;
+    (void)type;
+    if (NULL != p)
+    {
+        p->next = NULL;
+        p->payload = (u8_t *)(p + 1);
+        p->tot_len = length;
+        p->len = length;
+        lwip_shim_stats.pbuf_allocs++;
+        lwip_shim_stats.pbuf_alloc_bytes += length;
+        lwip_shim_stats.pbufs_in_use++;
+    }
+    return p;
+}
+
+u8_t pbuf_free(struct pbuf *p)
+{
+    u8_t count = 0;
+
+    while (NULL != p)
+    {
+        struct pbuf *next = p->next;
+
+        lwip_shim_stats.pbufs_in_use--;
+        free(p);
+        p = next;
+        count++;
+    }
+    return count;
+}
+
+void pbuf_realloc(struct pbuf *p, u16_t size)
+{
+    if (size < p->tot_len)
+    {
+        p->tot_len = size;
+        p->len = size;
+    }
+}
+
+err_t pbuf_take_at(struct pbuf *buf, const void *dataptr, u16_t len, u16_t offset)
+{
+    if ((u32_t)offset + len > buf->tot_len)
+    {
+        return ERR_MEM;
+    }
+    memcpy((u8_t *)buf->payload + offset, dataptr, len);
+    return ERR_OK;
+}
+
+err_t pbuf_take(struct pbuf *buf, const void *dataptr, u16_t len)
+{
+    return pbuf_take_at(buf, dataptr, len, 0);
+}
+
+u16_t pbuf_copy_partial(const struct pbuf *p, void *dataptr, u16_t len, u16_t offset)
+{
+    u16_t copied = 0;
+
+    for (; (NULL != p) && (copied < len); p = p->next)
+    {
+        u16_t count;
+
+        if (offset >= p->len)
+        {
+            offset = (u16_t)(offset - p->len);
+            continue;
+        }
+        count = LWIP_MIN((u16_t)(len - copied), (u16_t)(p->len - offset));
+        memcpy((u8_t *)dataptr + copied, (const u8_t *)p->payload + offset, count);
+        copied = (u16_t)(copied + count);
+        offset = 0;
+    }
+    return copied;
+}
+
+u8_t pbuf_get_at(const struct pbuf *p, u16_t offset)
+{
+    for (; NULL != p; p = p->next)
+    {
+        if (offset < p->len)
+        {
+            return ((const u8_t *)p->payload)[offset];
+        }
+        offset = (u16_t)(offset - p->len);
+    }
+    return 0;
+}
+
+u16_t pbuf_memcmp(const struct pbuf *p, u16_t offset, const void *s2, u16_t n)
+{
+    u16_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        if (pbuf_get_at(p, (u16_t)(offset + i)) != ((const u8_t *)s2)[i])
+        {
+            return (u16_t)(i + 1);
+        }
+    }
+    return 0;
+}
+
+struct netif *netif_list;
+
+u8_t netif_alloc_client_data_id(void)
+{
+    return shim_client_data_ids++;
+}
+
+void netif_add_ext_callback(netif_ext_callback_t *callback, netif_ext_callback_fn fn)
+{
+    callback->callback_fn = fn;
+    shim_ext_callback = fn;
+}
+
+void netif_invoke_ext_callback(struct netif *netif, netif_nsc_reason_t reason,
+                               const netif_ext_callback_args_t *args)
+{
+    if (NULL != shim_ext_callback)
+    {
+        shim_ext_callback(netif, reason, args);
+    }
+}
+
+struct udp_pcb *udp_new_ip_type(u8_t type)
+{
+    (void)type;
+    return &shim_pcb;
+}
+
+err_t udp_bind(struct udp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port)
+{
+    (void)pcb;
+    (void)ipaddr;
+    (void)port;
+    return ERR_OK;
+}
+
+void udp_recv(struct udp_pcb *pcb, udp_recv_fn recv, void *recv_arg)
+{
+    (void)pcb;
+    shim_recv = recv;
+    shim_recv_arg = recv_arg;
+}
+
+err_t udp_sendto_if(struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *dst_ip, u16_t dst_port,
+                    struct netif *netif)
+{
+    (void)pcb;
+    (void)netif;
+    lwip_shim_stats.packets_sent++;
+    if (NULL != shim_send)
+    {
+        shim_send(p, dst_ip, dst_port);
+    }
+    return ERR_OK;
+}
+
+struct netif *ip_current_input_netif(void)
+{
+    return shim_input_netif;
+}
+
+const ip_addr_t *ip_current_dest_addr(void)
+{
+    return shim_dest_addr;
+}
+
+err_t igmp_joingroup_netif(struct netif *netif, const ip4_addr_t *groupaddr)
+{
+    (void)netif;
+    (void)groupaddr;
+    return ERR_OK;
+}
+
+err_t igmp_leavegroup_netif(struct netif *netif, const ip4_addr_t *groupaddr)
+{
+    (void)netif;
+    (void)groupaddr;
+    return ERR_OK;
+}
+
+err_t mld6_joingroup_netif(struct netif *netif, const ip6_addr_t *groupaddr)
+{
+    (void)netif;
+    (void)groupaddr;
+    return ERR_OK;
+}
+
+err_t mld6_leavegroup_netif(struct netif *netif, const ip6_addr_t *groupaddr)
+{
+    (void)netif;
+    (void)groupaddr;
+    return ERR_OK;
+}
+
+void sys_timeout(u32_t msecs, sys_timeout_handler handler, void *arg)
+{
+    uint32_t i;
+
+    for (i = 0; i < LWIP_SHIM_MAX_TIMERS; i++)
+    {
+        if (NULL == shim_timers[i].handler)
+        {
+            shim_timers[i].handler = handler;
+            shim_timers[i].arg = arg;
+            shim_timers[i].msecs = msecs;
+            return;
+        }
+    }
+    LWIP_ASSERT("sys_timeout: too many timers", 0);
+}
+
+void sys_untimeout(sys_timeout_handler handler, void *arg)
+{
+    uint32_t i;
+
+    for (i = 0; i < LWIP_SHIM_MAX_TIMERS; i++)
+    {
+        if ((shim_timers[i].handler == handler) && (shim_timers[i].arg == arg))
+        {
+            shim_timers[i].handler = NULL;
+        }
+    }
+}
+
+u32_t sys_now(void)
+{
+    return shim_now;
+}
+
+/*******************************************************************************
+ * Function Name: lwip_shim_set_send_callback
+ *******************************************************************************
+ * Summary:
+ *  Sets the function called with each UDP packet sent by the responder.
+ *
+ * Parameters:
+ *  lwip_shim_send_fn fn: Function to call, or NULL
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void lwip_shim_set_send_callback(lwip_shim_send_fn fn)
+{
+    shim_send = fn;
+}
+
+/*******************************************************************************
+ * Function Name: lwip_shim_alloc_chain
+ *******************************************************************************
+ * Summary:
+ *  Copies data to a chain of packet buffers, each holding at most the size
+ *  set by lwip_shim_set_input_segment().
+ *
+ * Parameters:
+ *  const u8_t *data: Data to copy
+ *  u16_t len: Length of the data
+ *
+ * Return:
+ *  struct pbuf *: First packet buffer of the chain
+ *
+ *******************************************************************************/
+struct pbuf *lwip_shim_alloc_chain(const u8_t *data, u16_t len)
+{
+    struct pbuf *p = NULL;
+    struct pbuf **tail = &p;
+    u16_t offset = 0;
+
+    do
+    {
+        u16_t remaining = (u16_t)(len - offset);
+        u16_t segment = ((0 != shim_input_segment) && (remaining > shim_input_segment)) ?
+                        shim_input_segment : remaining;
+
+        *tail = pbuf_alloc(PBUF_TRANSPORT, segment, PBUF_RAM);
+        LWIP_ASSERT("lwip_shim_alloc_chain: out of memory", NULL != *tail);
+        memcpy((*tail)->payload, data + offset, segment);
+        (*tail)->tot_len = remaining;
+        tail = &(*tail)->next;
+        offset = (u16_t)(offset + segment);
+    } while (offset < len);
+
+    return p;
+}
+
+/*******************************************************************************
+ * Function Name: lwip_shim_input
+ *******************************************************************************
+ * Summary:
+ *  Passes a received UDP packet to the responder, in a chain of packet
+ *  buffers allocated like the ones of a network driver.
+ *
+ * Parameters:
+ *  struct netif *netif: Network interface that received the packet
+ *  const u8_t *data: UDP payload
+ *  u16_t len: Length of the payload
+ *  const ip_addr_t *src: Source address
+ *  u16_t src_port: Source port
+ *  const ip_addr_t *dest: Destination address, a multicast group or the
+ *                         address of the interface
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void lwip_shim_input(struct netif *netif, const u8_t *data, u16_t len, const ip_addr_t *src,
+                     u16_t src_port, const ip_addr_t *dest)
+{
+    struct pbuf *p = lwip_shim_alloc_chain(data, len);
+
+    shim_input_netif = netif;
+    shim_dest_addr = dest;
+    /* The receive function frees the packet buffer. */
+    shim_recv(shim_recv_arg, &shim_pcb, p, src, src_port);
+}
+
+/*******************************************************************************
+ * Function Name: lwip_shim_set_input_segment
+ *******************************************************************************
+ * Summary:
+ *  Sets the size of the packet buffers that lwip_shim_input() and
+ *  lwip_shim_alloc_chain() allocate.
+ *  Received packets larger than this size are passed as chains.
+ *
+ * Parameters:
+ *  u16_t size: Payload size of each packet buffer, 0 for one piece
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void lwip_shim_set_input_segment(u16_t size)
+{
+    shim_input_segment = size;
+}
+
+/*******************************************************************************
+ * Function Name: lwip_shim_run_timers
+ *******************************************************************************
+ * Summary:
+ *  Advances the time to the end of the longest pending timer and runs the
+ *  pending timers. Timers set by the handlers run at the next call.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void lwip_shim_run_timers(void)
+{
+    lwip_shim_timer_t timers[LWIP_SHIM_MAX_TIMERS];
+    u32_t msecs = 0;
+    uint32_t i;
+
+    memcpy(timers, shim_timers, sizeof(timers));
+    memset(shim_timers, 0, sizeof(shim_timers));
+    for (i = 0; i < LWIP_SHIM_MAX_TIMERS; i++)
+    {
+        if ((NULL != timers[i].handler) && (timers[i].msecs > msecs))
+        {
+            msecs = timers[i].msecs;
+        }
+    }
+    shim_now += msecs;
+
+    for (i = 0; i < LWIP_SHIM_MAX_TIMERS; i++)
+    {
+        if (NULL != timers[i].handler)
+        {
+            timers[i].handler(timers[i].arg);
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: lwip_shim_advance_time
+ *******************************************************************************
+ * Summary:
+ *  Advances the time returned by sys_now(), without running the timers.
+ *
+ * Parameters:
+ *  u32_t msecs: Time to add, in milliseconds
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void lwip_shim_advance_time(u32_t msecs)
+{
+    shim_now += msecs;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,366 @@
+/******************************************************************************
+* File Name: lwip_shim.h
+*
+* Description: This file contains the subset of the lwIP and platform
+* declarations that ../source/mdns.c and ../source/secure_http_server.h use,
+* so that the mDNS responder builds on the host computer. Packet buffers are
+* contiguous, and UDP packets, timers, and multicast groups are recorded by
+* lwip_shim.c instead of reaching a network.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2025, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef LWIP_SHIM_H_
+#define LWIP_SHIM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+/*******************************************************************************
+* lwIP options, as set in ../configs/lwipopts.h
+*******************************************************************************/
+#define LWIP_IPV4                                1
+#define LWIP_IPV6                                1
+#define LWIP_IGMP                                1
+#define LWIP_IPV6_MLD                            1
+#define LWIP_UDP                                 1
+#define LWIP_IPV6_NUM_ADDRESSES                  3
+#define LWIP_NUM_NETIF_CLIENT_DATA               1
+#define LWIP_MULTICAST_TX_OPTIONS                0
+#define LWIP_NETIF_EXT_STATUS_CALLBACK           1
+
+#define LWIP_MDNS_RESPONDER                      1
+#define MDNS_RESP_USENETIF_EXTCALLBACK           1
+#ifndef MDNS_MAX_SERVICES
+#define MDNS_MAX_SERVICES                        1
+#endif
+#define MDNS_DEBUG                               0
+#define LWIP_DBG_ON                              0x80U
+
+/*******************************************************************************
+* Types and helpers of lwip/arch.h, lwip/def.h and lwip/err.h
+*******************************************************************************/
+typedef uint8_t  u8_t;
+typedef int8_t   s8_t;
+typedef uint16_t u16_t;
+typedef int16_t  s16_t;
+typedef uint32_t u32_t;
+typedef int32_t  s32_t;
+typedef s8_t     err_t;
+
+#define ERR_OK                                   0
+#define ERR_MEM                                  -1
+#define ERR_BUF                                  -2
+#define ERR_INPROGRESS                           -5
+#define ERR_VAL                                  -6
+#define ERR_ARG                                  -16
+
+#define LWIP_UNUSED_ARG(x)                       (void)(x)
+#define LWIP_ASSERT(message, assertion)          do { if (!(assertion)) { printf("Assertion \"%s\" failed\n", message); abort(); } } while (0)
+#define LWIP_ASSERT_CORE_LOCKED()
+#define LWIP_DEBUGF(debug, message)              do { if (debug) { printf message; } } while (0)
+#define LWIP_MIN(x, y)                           (((x) < (y)) ? (x) : (y))
+#define MEMCPY(dst, src, len)                    memcpy(dst, src, len)
+#define SMEMCPY(dst, src, len)                   memcpy(dst, src, len)
+
+#define PP_HTONS(x)                              ((u16_t)((((x) & 0x00ffUL) << 8) | (((x) & 0xff00UL) >> 8)))
+#define PP_HTONL(x)                              ((((x) & 0x000000ffUL) << 24) | (((x) & 0x0000ff00UL) << 8) | \
+                                                  (((x) & 0x00ff0000UL) >> 8) | (((x) & 0xff000000UL) >> 24))
+#define lwip_htons(x)                            PP_HTONS(x)
+#define lwip_ntohs(x)                            PP_HTONS(x)
+#define lwip_htonl(x)                            ((u32_t)PP_HTONL((u32_t)(x)))
+#define lwip_ntohl(x)                            ((u32_t)PP_HTONL((u32_t)(x)))
+#define lwip_strnicmp(str1, str2, len)           strncasecmp(str1, str2, len)
+
+void lwip_itoa(char *result, size_t bufsize, int number);
+
+/*******************************************************************************
+* Addresses of lwip/ip_addr.h
+*******************************************************************************/
+typedef struct ip4_addr { u32_t addr; } ip4_addr_t;
+typedef struct ip6_addr { u32_t addr[4]; u8_t zone; } ip6_addr_t;
+typedef struct ip6_addr_packed { u32_t addr[4]; } ip6_addr_p_t;
+
+#define IPADDR_TYPE_V4                           0U
+#define IPADDR_TYPE_V6                           6U
+#define IPADDR_TYPE_ANY                          46U
+
+typedef struct ip_addr
+{
+    union
+    {
+        ip6_addr_t ip6;
+        ip4_addr_t ip4;
+    } u_addr;
+    u8_t type;
+} ip_addr_t;
+
+#define IPADDR4_INIT(u32val)                     { { .ip4 = { u32val } }, IPADDR_TYPE_V4 }
+#define IPADDR6_INIT(a, b, c, d)                 { { .ip6 = { { a, b, c, d }, 0 } }, IPADDR_TYPE_V6 }
+
+#define IP_IS_V6_VAL(ipaddr)                     ((ipaddr).type == IPADDR_TYPE_V6)
+#define IP_IS_V6(ipaddr)                         (((ipaddr) != NULL) && IP_IS_V6_VAL(*(ipaddr)))
+#define ip_2_ip4(ipaddr)                         (&((ipaddr)->u_addr.ip4))
+#define ip_2_ip6(ipaddr)                         (&((ipaddr)->u_addr.ip6))
+
+#define ip4_addr_isany_val(ipaddr)               ((ipaddr).addr == 0)
+#define ip4_addr_cmp(addr1, addr2)               ((addr1)->addr == (addr2)->addr)
+#define ip4_addr_copy(dest, src)                 ((dest).addr = (src).addr)
+#define ip6_addr_cmp(addr1, addr2)               ((0 == memcmp((addr1)->addr, (addr2)->addr, sizeof((addr1)->addr))) && \
+                                                  ((addr1)->zone == (addr2)->zone))
+#define ip6_addr_copy(dest, src)                 memcpy(&(dest), &(src), sizeof(ip6_addr_t))
+#define IP6_UNICAST                              1
+#define ip6_addr_assign_zone(ip6addr, type, netif) ((void)(type), (void)(netif), (ip6addr)->zone = 0)
+#define IP_ADDR6(ipaddr, i0, i1, i2, i3)         do { *(ipaddr) = (ip_addr_t)IPADDR6_INIT(i0, i1, i2, i3); } while (0)
+#define ip_addr_copy(dest, src)                  ((dest) = (src))
+#define ip_addr_copy_from_ip4(dest, src)         do { (dest).u_addr.ip4 = (src); (dest).type = IPADDR_TYPE_V4; } while (0)
+
+int ip_addr_cmp(const ip_addr_t *addr1, const ip_addr_t *addr2);
+#define ip_addr_cmp_zoneless(addr1, addr2)       ip_addr_cmp(addr1, addr2)
+
+extern const ip_addr_t ip_addr_any;
+extern const ip_addr_t ip6_addr_any;
+extern const ip_addr_t ip_addr_any_type;
+#define IP4_ADDR_ANY                             (&ip_addr_any)
+#define IP6_ADDR_ANY                             (&ip6_addr_any)
+#define IP_ANY_TYPE                              (&ip_addr_any_type)
+
+/*******************************************************************************
+* Packet buffers of lwip/pbuf.h
+*******************************************************************************/
+typedef enum { PBUF_TRANSPORT } pbuf_layer;
+typedef enum { PBUF_RAM } pbuf_type;
+
+struct pbuf
+{
+    struct pbuf *next;
+    void *payload;
+    u16_t tot_len;
+    u16_t len;
+};
+
+struct pbuf *pbuf_alloc(pbuf_layer layer, u16_t length, pbuf_type type);
+u8_t pbuf_free(struct pbuf *p);
+void pbuf_realloc(struct pbuf *p, u16_t size);
+err_t pbuf_take(struct pbuf *buf, const void *dataptr, u16_t len);
+err_t pbuf_take_at(struct pbuf *buf, const void *dataptr, u16_t len, u16_t offset);
+u16_t pbuf_copy_partial(const struct pbuf *p, void *dataptr, u16_t len, u16_t offset);
+u8_t pbuf_get_at(const struct pbuf *p, u16_t offset);
+u16_t pbuf_memcmp(const struct pbuf *p, u16_t offset, const void *s2, u16_t n);
+
+/*******************************************************************************
+* Network interface of lwip/netif.h
+*******************************************************************************/
+#define IP6_ADDR_INVALID                         0x00
+#define IP6_ADDR_TENTATIVE                       0x08
+#define IP6_ADDR_VALID                           0x10
+#define IP6_ADDR_PREFERRED                       0x30
+#define ip6_addr_isvalid(addr_state)             ((addr_state) & IP6_ADDR_VALID)
+
+struct netif
+{
+    struct netif *next;
+    ip_addr_t ip_addr;
+    ip_addr_t ip6_addr[LWIP_IPV6_NUM_ADDRESSES];
+    u8_t ip6_addr_state[LWIP_IPV6_NUM_ADDRESSES];
+    void *client_data[LWIP_NUM_NETIF_CLIENT_DATA];
+};
+
+#define netif_ip4_addr(netif)                    ((const ip4_addr_t *)ip_2_ip4(&((netif)->ip_addr)))
+#define netif_ip6_addr(netif, i)                 ((const ip6_addr_t *)ip_2_ip6(&((netif)->ip6_addr[i])))
+#define netif_ip6_addr_state(netif, i)           ((netif)->ip6_addr_state[i])
+#define netif_get_client_data(netif, id)         ((netif)->client_data[(id)])
+#define netif_set_client_data(netif, id, data)   netif_get_client_data(netif, id) = (data)
+
+u8_t netif_alloc_client_data_id(void);
+
+extern struct netif *netif_list;
+#define NETIF_FOREACH(netif)                     for ((netif) = netif_list; (netif) != NULL; (netif) = (netif)->next)
+
+typedef u16_t netif_nsc_reason_t;
+#define LWIP_NSC_LINK_CHANGED                    0x0004
+#define LWIP_NSC_STATUS_CHANGED                  0x0008
+#define LWIP_NSC_IPV4_ADDRESS_CHANGED            0x0010
+#define LWIP_NSC_IPV4_GATEWAY_CHANGED            0x0020
+#define LWIP_NSC_IPV4_NETMASK_CHANGED            0x0040
+#define LWIP_NSC_IPV4_SETTINGS_CHANGED           0x0080
+#define LWIP_NSC_IPV6_SET                        0x0100
+#define LWIP_NSC_IPV6_ADDR_STATE_CHANGED         0x0200
+
+typedef union
+{
+    struct link_changed_s { u8_t state; } link_changed;
+    struct status_changed_s { u8_t state; } status_changed;
+} netif_ext_callback_args_t;
+
+typedef void (*netif_ext_callback_fn)(struct netif *netif, netif_nsc_reason_t reason,
+                                      const netif_ext_callback_args_t *args);
+
+typedef struct netif_ext_callback
+{
+    netif_ext_callback_fn callback_fn;
+} netif_ext_callback_t;
+
+#define NETIF_DECLARE_EXT_CALLBACK(name)         static netif_ext_callback_t name;
+
+void netif_add_ext_callback(netif_ext_callback_t *callback, netif_ext_callback_fn fn);
+void netif_invoke_ext_callback(struct netif *netif, netif_nsc_reason_t reason,
+                               const netif_ext_callback_args_t *args);
+
+/*******************************************************************************
+* UDP, IP, multicast groups, memory and timers
+*******************************************************************************/
+struct udp_pcb
+{
+    u8_t ttl;
+};
+
+typedef void (*udp_recv_fn)(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr, u16_t port);
+
+struct udp_pcb *udp_new_ip_type(u8_t type);
+err_t udp_bind(struct udp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port);
+void udp_recv(struct udp_pcb *pcb, udp_recv_fn recv, void *recv_arg);
+err_t udp_sendto_if(struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *dst_ip, u16_t dst_port,
+                    struct netif *netif);
+
+struct netif *ip_current_input_netif(void);
+const ip_addr_t *ip_current_dest_addr(void);
+
+err_t igmp_joingroup_netif(struct netif *netif, const ip4_addr_t *groupaddr);
+err_t igmp_leavegroup_netif(struct netif *netif, const ip4_addr_t *groupaddr);
+err_t mld6_joingroup_netif(struct netif *netif, const ip6_addr_t *groupaddr);
+err_t mld6_leavegroup_netif(struct netif *netif, const ip6_addr_t *groupaddr);
+
+#define mem_calloc(count, size)                  calloc(count, size)
+#define mem_free(mem)                            free(mem)
+
+typedef void (*sys_timeout_handler)(void *arg);
+void sys_timeout(u32_t msecs, sys_timeout_handler handler, void *arg);
+void sys_untimeout(sys_timeout_handler handler, void *arg);
+u32_t sys_now(void);
+
+/*******************************************************************************
+* DNS protocol of lwip/prot/dns.h and lwip/prot/iana.h
+*******************************************************************************/
+#define LWIP_IANA_PORT_MDNS                      5353
+
+#define SIZEOF_DNS_HDR                           12
+#define DNS_FLAG1_RESPONSE                       0x80
+#define DNS_FLAG1_AUTHORATIVE                    0x04
+#define DNS_HDR_GET_OPCODE(hdr)                  ((((hdr)->flags1) >> 3) & 0xF)
+
+#define DNS_RRTYPE_A                             1
+#define DNS_RRTYPE_PTR                           12
+#define DNS_RRTYPE_TXT                           16
+#define DNS_RRTYPE_AAAA                          28
+#define DNS_RRTYPE_SRV                           33
+#define DNS_RRTYPE_ANY                           255
+#define DNS_RRCLASS_IN                           1
+#define DNS_RRCLASS_ANY                          255
+
+#define DNS_MQUERY_IPV4_GROUP_INIT               IPADDR4_INIT(PP_HTONL(0xE00000FBUL))
+#define DNS_MQUERY_IPV6_GROUP_INIT               IPADDR6_INIT(PP_HTONL(0xFF020000UL), 0, 0, PP_HTONL(0x000000FBUL))
+
+struct dns_hdr
+{
+    u16_t id;
+    u8_t flags1;
+    u8_t flags2;
+    u16_t numquestions;
+    u16_t numanswers;
+    u16_t numauthrr;
+    u16_t numextrarr;
+};
+
+/*******************************************************************************
+* Domain names of lwip/apps/mdns_priv.h
+*******************************************************************************/
+#define MDNS_READNAME_ERROR                      0xFFFF
+#define MDNS_DOMAIN_MAXLEN                       256
+
+struct mdns_domain
+{
+    /* Encoded domain name */
+    u8_t name[MDNS_DOMAIN_MAXLEN];
+    /* Total length of domain name, including zero */
+    u16_t length;
+    /* Set if compression of this domain is not allowed */
+    u8_t skip_compression;
+};
+
+err_t mdns_domain_add_label(struct mdns_domain *domain, const char *label, u8_t len);
+u16_t mdns_readname(struct pbuf *p, u16_t offset, struct mdns_domain *domain);
+int mdns_domain_eq(struct mdns_domain *a, struct mdns_domain *b);
+u16_t mdns_compress_domain(struct pbuf *pbuf, u16_t *offset, struct mdns_domain *domain);
+
+/*******************************************************************************
+* Platform declarations of secure_http_server.h
+*******************************************************************************/
+typedef uint32_t cy_rslt_t;
+#define tskIDLE_PRIORITY                         (0)
+
+/*******************************************************************************
+* Recording of the shim, used by the benchmark
+*******************************************************************************/
+/* Called with each UDP packet sent by the responder. */
+typedef void (*lwip_shim_send_fn)(const struct pbuf *p, const ip_addr_t *dst_ip, u16_t dst_port);
+
+typedef struct
+{
+    u32_t pbuf_allocs;
+    u32_t pbuf_alloc_bytes;
+    u32_t pbufs_in_use;
+    u32_t packets_sent;
+} lwip_shim_stats_t;
+
+extern lwip_shim_stats_t lwip_shim_stats;
+
+void lwip_shim_set_send_callback(lwip_shim_send_fn fn);
+void lwip_shim_input(struct netif *netif, const u8_t *data, u16_t len, const ip_addr_t *src,
+                     u16_t src_port, const ip_addr_t *dest);
+void lwip_shim_set_input_segment(u16_t size);
+struct pbuf *lwip_shim_alloc_chain(const u8_t *data, u16_t len);
+void lwip_shim_run_timers(void);
+void lwip_shim_advance_time(u32_t msecs);
+
+/* The responder API, as lwip/apps/mdns.h */
+#include "mdns.h"
+
+#endif /* LWIP_SHIM_H_ */
+
+/* [] END OF FILE */
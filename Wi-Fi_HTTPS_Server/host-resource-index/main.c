@@ -0,0 +1,445 @@
+/******************************************************************************
+* File Name: main.c
+*
+* Description: This is the host benchmark of the URL resource index of the
+* HTTPS server. It measures lookups and updates of the index against the
+* linear resource table with heap-allocated names and values that the index
+* replaced, and checks the result of every operation.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2025, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Standard C header files */
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Resource index header file */
+#include "https_resource_index.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Number of lookups and updates measured. */
+#define BENCHMARK_LOOKUPS                        (2000000u)
+#define BENCHMARK_UPDATES                        (500000u)
+
+/* Longest resource name and value accepted by the HTTPS server: the body of a
+ * PUT request holds up to 30 characters, "<name>=<value>".
+ */
+#define BENCHMARK_ENTRY_MAX_LEN                  (29u)
+#define BENCHMARK_NAME_MAX_LEN                   (16u)
+
+/*******************************************************************************
+* Data structure and enumeration
+*******************************************************************************/
+/* Entry of the linear resource table that the index replaced. */
+typedef struct
+{
+    char *resource_name;
+    char *value;
+    uint32_t length;
+} linear_resource_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static https_resource_index_t resource_index;
+static linear_resource_t linear_resources[HTTPS_RESOURCE_INDEX_CAPACITY];
+
+/* Expected names and values of the resources. */
+static char names[HTTPS_RESOURCE_INDEX_CAPACITY][BENCHMARK_NAME_MAX_LEN];
+static char values[HTTPS_RESOURCE_INDEX_CAPACITY][BENCHMARK_ENTRY_MAX_LEN + 1];
+static const char *stored_names[HTTPS_RESOURCE_INDEX_CAPACITY];
+
+static uint32_t random_state = 0x12345678u;
+static uint32_t failures;
+
+/* Keeps the compiler from removing the measured lookups. */
+static volatile uint32_t sink;
+
+/*******************************************************************************
+ * Function Name: next_random
+ *******************************************************************************
+ * Summary:
+ *  Returns the next number of a xorshift generator, so that every run
+ *  performs the same operations.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  uint32_t: Pseudo-random number
+ *
+ *******************************************************************************/
+static uint32_t next_random(void)
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+/*******************************************************************************
+ * Function Name: now_ns
+ *******************************************************************************
+ * Summary:
+ *  Returns a monotonic time stamp.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  double: Time in nanoseconds
+ *
+ *******************************************************************************/
+static double now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((double)ts.tv_sec * 1e9) + (double)ts.tv_nsec;
+}
+
+/*******************************************************************************
+ * Function Name: check
+ *******************************************************************************
+ * Summary:
+ *  Counts and reports a failed check.
+ *
+ * Parameters:
+ *  int condition: Result of the check
+ *  const char *what: Description of the check
+ *  uint32_t n: Resource or operation number
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void check(int condition, const char *what, uint32_t n)
+{
+    if (!condition)
+    {
+        if (failures < 10u)
+        {
+            printf("FAILED: %s (%u)\n", what, (unsigned)n);
+        }
+        failures++;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: random_value
+ *******************************************************************************
+ * Summary:
+ *  Sets the expected value of a resource to a random string that fits in a
+ *  PUT request with the name of the resource.
+ *
+ * Parameters:
+ *  uint32_t n: Resource number
+ *
+ * Return:
+ *  uint32_t: Length of the value
+ *
+ *******************************************************************************/
+static uint32_t random_value(uint32_t n)
+{
+    uint32_t max_length = BENCHMARK_ENTRY_MAX_LEN - (uint32_t)strlen(names[n]);
+    uint32_t length = 1u + (next_random() % max_length);
+    uint32_t i;
+
+    for (i = 0; i < length; i++)
+    {
+        values[n][i] = (char)('a' + (next_random() % 26u));
+    }
+    values[n][length] = '\0';
+
+    return length;
+}
+
+/*******************************************************************************
+ * Function Name: linear_put
+ *******************************************************************************
+ * Summary:
+ *  Adds or updates a resource of the linear table, as the HTTPS server did
+ *  before the index: strcmp() through the table, realloc() on update and
+ *  calloc() on creation.
+ *
+ * Parameters:
+ *  const char *name: Name of the resource
+ *  const char *value: Value of the resource
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void linear_put(const char *name, const char *value)
+{
+    uint32_t index;
+
+    for (index = 0; index < HTTPS_RESOURCE_INDEX_CAPACITY; index++)
+    {
+        if ((NULL != linear_resources[index].resource_name) &&
+            (0 == strcmp(linear_resources[index].resource_name, name)))
+        {
+            linear_resources[index].length = (uint32_t)strlen(value);
+            linear_resources[index].value = realloc(linear_resources[index].value,
+                                                    linear_resources[index].length + 1u);
+            memcpy(linear_resources[index].value, value, linear_resources[index].length + 1u);
+            return;
+        }
+        else if (NULL == linear_resources[index].resource_name)
+        {
+            linear_resources[index].length = (uint32_t)strlen(value);
+            linear_resources[index].value = calloc(linear_resources[index].length + 1u, 1u);
+            linear_resources[index].resource_name = calloc(strlen(name) + 1u, 1u);
+            memcpy(linear_resources[index].value, value, linear_resources[index].length);
+            memcpy(linear_resources[index].resource_name, name, strlen(name));
+            return;
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: linear_get
+ *******************************************************************************
+ * Summary:
+ *  Looks up a resource of the linear table.
+ *
+ * Parameters:
+ *  const char *name: Name of the resource
+ *
+ * Return:
+ *  const linear_resource_t *: Resource, or NULL if not found
+ *
+ *******************************************************************************/
+static const linear_resource_t *linear_get(const char *name)
+{
+    uint32_t index;
+
+    for (index = 0; index < HTTPS_RESOURCE_INDEX_CAPACITY; index++)
+    {
+        if ((NULL != linear_resources[index].resource_name) &&
+            (0 == strcmp(linear_resources[index].resource_name, name)))
+        {
+            return &linear_resources[index];
+        }
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+ * Function Name: check_value_hash
+ *******************************************************************************
+ * Summary:
+ *  Checks that the value hash of a resource, which the HTTPS server sends as
+ *  its entity tag, changes with the value only.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  int: 1 if the check passed, 0 otherwise.
+ *
+ *******************************************************************************/
+static int check_value_hash(void)
+{
+    char buffer[BENCHMARK_ENTRY_MAX_LEN + 1];
+    uint32_t length = 0;
+    uint32_t hash[3] = {0};
+    uint32_t i;
+
+    for (i = 0; i < 3u; i++)
+    {
+        /* Write the same value twice, then another value. */
+        (void)https_resource_index_put(&resource_index, names[0], (i < 2u) ? "same" : "other", 4u + (i / 2u), NULL);
+        (void)https_resource_index_get(&resource_index, names[0], buffer, sizeof(buffer), &length, &hash[i]);
+    }
+
+    /* Restore the expected value. */
+    (void)https_resource_index_put(&resource_index, names[0], values[0], (uint32_t)strlen(values[0]), NULL);
+
+    return (hash[0] == hash[1]) && (hash[1] != hash[2]);
+}
+
+/*******************************************************************************
+ * Function Name: check_all
+ *******************************************************************************
+ * Summary:
+ *  Checks the value of every resource of the index and that the names
+ *  registered with the HTTP server did not move.
+ *
+ * Parameters:
+ *  const char *stage: Description of the stage checked
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void check_all(const char *stage)
+{
+    char buffer[BENCHMARK_ENTRY_MAX_LEN + 1];
+    uint32_t length = 0;
+    uint32_t n;
+    bool found;
+
+    for (n = 0; n < HTTPS_RESOURCE_INDEX_CAPACITY; n++)
+    {
+        found = https_resource_index_get(&resource_index, names[n], buffer, sizeof(buffer), &length, NULL);
+        check(found, stage, n);
+        check(found && (length == strlen(values[n])) && (0 == memcmp(buffer, values[n], length)),
+              stage, n);
+        check(0 == strcmp(stored_names[n], names[n]), "stored name moved", n);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: main
+ *******************************************************************************
+ * Summary:
+ *  Fills the index and the linear table to capacity, then measures lookups
+ *  and updates of random resources.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  int: Number of failed checks.
+ *
+ *******************************************************************************/
+int main(void)
+{
+    https_resource_index_result_t result;
+    const char *stored_name = NULL;
+    char buffer[BENCHMARK_ENTRY_MAX_LEN + 1];
+    uint32_t length = 0;
+    uint32_t n;
+    uint32_t i;
+    double start;
+    double index_ns;
+    double linear_ns;
+
+    printf("URL resource index: %u resources, %u slots, %u-byte arena, %u bytes in total\n",
+           (unsigned)HTTPS_RESOURCE_INDEX_CAPACITY, (unsigned)HTTPS_RESOURCE_INDEX_SLOTS,
+           (unsigned)HTTPS_RESOURCE_INDEX_ARENA_SIZE, (unsigned)sizeof(resource_index));
+
+    https_resource_index_init(&resource_index);
+
+    /* Fill both tables. */
+    for (n = 0; n < HTTPS_RESOURCE_INDEX_CAPACITY; n++)
+    {
+        snprintf(names[n], sizeof(names[n]), "/resource%u", (unsigned)n);
+        length = random_value(n);
+
+        result = https_resource_index_put(&resource_index, names[n], values[n], length,
+                                          &stored_names[n]);
+        check(HTTPS_RESOURCE_INDEX_CREATED == result, "create", n);
+        linear_put(names[n], values[n]);
+    }
+
+    result = https_resource_index_put(&resource_index, "/one-too-many", "x", 1u, NULL);
+    check(HTTPS_RESOURCE_INDEX_FULL == result, "reject a resource beyond the capacity", 0);
+    check(!https_resource_index_get(&resource_index, "/missing", buffer, sizeof(buffer), &length, NULL),
+          "miss an unknown resource", 0);
+    check(HTTPS_RESOURCE_INDEX_BAD_ARG == https_resource_index_put(&resource_index, "", "x", 1u, NULL),
+          "reject an empty name", 0);
+    check(check_value_hash(), "change the value hash with the value", 0);
+    check_all("lookup after creation");
+
+    /* Lookups. */
+    start = now_ns();
+    for (i = 0; i < BENCHMARK_LOOKUPS; i++)
+    {
+        n = next_random() % HTTPS_RESOURCE_INDEX_CAPACITY;
+        (void)https_resource_index_get(&resource_index, names[n], buffer, sizeof(buffer), &length, NULL);
+        sink += length;
+    }
+    index_ns = (now_ns() - start) / BENCHMARK_LOOKUPS;
+
+    start = now_ns();
+    for (i = 0; i < BENCHMARK_LOOKUPS; i++)
+    {
+        n = next_random() % HTTPS_RESOURCE_INDEX_CAPACITY;
+        sink += linear_get(names[n])->length;
+    }
+    linear_ns = (now_ns() - start) / BENCHMARK_LOOKUPS;
+
+    printf("Lookup: index %.1f ns, linear table %.1f ns\n", index_ns, linear_ns);
+
+    /* Updates with values of random length, which fill the arena with
+     * released values until it is compacted.
+     */
+    start = now_ns();
+    for (i = 0; i < BENCHMARK_UPDATES; i++)
+    {
+        n = next_random() % HTTPS_RESOURCE_INDEX_CAPACITY;
+        length = random_value(n);
+        result = https_resource_index_put(&resource_index, names[n], values[n], length, &stored_name);
+        check((HTTPS_RESOURCE_INDEX_UPDATED == result) && (stored_name == stored_names[n]), "update", i);
+    }
+    index_ns = (now_ns() - start) / BENCHMARK_UPDATES;
+
+    start = now_ns();
+    for (i = 0; i < BENCHMARK_UPDATES; i++)
+    {
+        n = next_random() % HTTPS_RESOURCE_INDEX_CAPACITY;
+        (void)random_value(n);
+        linear_put(names[n], values[n]);
+    }
+    linear_ns = (now_ns() - start) / BENCHMARK_UPDATES;
+
+    /* The linear table was updated last; bring the index up to date. */
+    for (n = 0; n < HTTPS_RESOURCE_INDEX_CAPACITY; n++)
+    {
+        result = https_resource_index_put(&resource_index, names[n], values[n],
+                                          (uint32_t)strlen(values[n]), NULL);
+        check(HTTPS_RESOURCE_INDEX_UPDATED == result, "update", n);
+        check(0 == strcmp(linear_get(names[n])->value, values[n]), "linear table", n);
+    }
+
+    printf("Update: index %.1f ns (%u compactions), linear table %.1f ns\n",
+           index_ns, (unsigned)resource_index.compactions, linear_ns);
+    check(resource_index.compactions > 0u, "compact the arena", 0);
+    check_all("lookup after updates");
+
+    printf("%s: %u failed checks\n", (0u == failures) ? "PASSED" : "FAILED", (unsigned)failures);
+
+    return (int)failures;
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,199 @@
+#******************************************************************************
+# File Name:   pem_to_der.py
+#
+# Description: Converts the PEM certificates and keys that a C header defines
+#              as string macros to DER byte arrays in a generated header, so
+#              that the firmware embeds the credentials in binary form. The
+#              Makefile runs this script before each build when
+#              CREDENTIALS_DER=1.
+#
+# Usage:
+#   python pem_to_der.py <input header> <output header>
+#
+# Example:
+#   python pem_to_der.py source/network_credentials.h source/network_credentials_der.h
+#
+# For each macro NAME_PEM (or NAME) that holds one PEM block, the generated
+# header defines:
+#   NAME_DER      the DER data as an initializer list, followed by one zero byte
+#   NAME_DER_LEN  the length of the DER data, without the zero byte
+#
+# The zero byte lets the secure socket library, which parses the given length
+# plus a null terminator, read past the DER data safely. mbedTLS ignores it.
+# RSA keys in PKCS#1 form are wrapped in PKCS#8, as some mbedTLS versions
+# reject a PKCS#1 key followed by another byte.
+#
+#******************************************************************************
+# Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+# an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+#
+# This software, including source code, documentation and related
+# materials ("Software") is owned by Cypress Semiconductor Corporation
+# or one of its affiliates ("Cypress") and is protected by and subject to
+# worldwide patent protection (United States and foreign),
+# United States copyright laws and international treaty provisions.
+# Therefore, you may use this Software only as provided in the license
+# agreement accompanying the software package from which you
+# obtained this Software ("EULA").
+# If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+# non-transferable license to copy, modify, and compile the Software
+# source code solely for use in connection with Cypress's
+# integrated circuit products.  Any reproduction, modification, translation,
+# compilation, or representation of this Software except as specified
+# above is prohibited without the express written permission of Cypress.
+#
+# Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+# EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+# reserves the right to make changes to the Software without notice. Cypress
+# does not assume any liability arising out of the application or use of the
+# Software or any product or circuit described in the Software. Cypress does
+# not authorize its products for use in any products where a malfunction or
+# failure of the Cypress product may reasonably be expected to result in
+# significant property damage, injury or death ("High Risk Product"). By
+# including Cypress's product in a High Risk Product, the manufacturer
+# of such system or application assumes all risk of such use and in doing
+# so agrees to indemnify Cypress against all liability.
+#******************************************************************************/
+
+import base64
+import binascii
+import os
+import re
+import sys
+
+# A macro defined as a sequence of string literals, one per line.
+MACRO_PATTERN = re.compile(r'^[ \t]*#define[ \t]+(\w+)[ \t]*\\?[ \t]*\n?((?:[ \t]*"(?:[^"\\\n]|\\.)*"[ \t]*\\?[ \t]*\n?)+)',
+                           re.MULTILINE)
+LITERAL_PATTERN = re.compile(r'"((?:[^"\\\n]|\\.)*)"')
+PEM_PATTERN = re.compile(r'-----BEGIN ([A-Z0-9 ]+)-----(.*?)-----END \1-----', re.DOTALL)
+
+# PEM blocks that carry no credential of their own.
+SKIPPED_BLOCKS = ("EC PARAMETERS",)
+
+# DER encoding of the rsaEncryption algorithm identifier, with NULL parameters.
+RSA_ALGORITHM_ID = bytes.fromhex("300d06092a864886f70d0101010500")
+
+BYTES_PER_LINE = 8
+
+
+def der_length(length):
+    """Encodes the length of a DER element."""
+    if length < 0x80:
+        return bytes([length])
+    encoded = length.to_bytes((length.bit_length() + 7) // 8, "big")
+    return bytes([0x80 | len(encoded)]) + encoded
+
+
+def der_element(tag, content):
+    """Encodes a DER element with the given tag and content."""
+    return bytes([tag]) + der_length(len(content)) + content
+
+
+def der_total_length(der):
+    """Returns the length of the DER element at the start of der, or 0 if the
+    header is malformed."""
+    if len(der) < 2:
+        return 0
+    if der[1] < 0x80:
+        return 2 + der[1]
+    count = der[1] & 0x7F
+    if (count == 0) or (count > 4) or (len(der) < 2 + count):
+        return 0
+    return 2 + count + int.from_bytes(der[2:2 + count], "big")
+
+
+def unescape(literal):
+    """Returns the text of a C string literal with simple escapes."""
+    return literal.replace("\\n", "\n").replace("\\r", "").replace("\\\"", "\"").replace("\\\\", "\\")
+
+
+def pem_to_der(name, text):
+    """Returns the PEM type and DER data of the single PEM block in text."""
+    blocks = [block for block in PEM_PATTERN.findall(text) if block[0] not in SKIPPED_BLOCKS]
+    if len(blocks) != 1:
+        raise ValueError("%s holds %d PEM blocks; one is supported, keep certificate chains in PEM"
+                         % (name, len(blocks)))
+
+    pem_type, body = blocks[0]
+    if ("Proc-Type:" in body) or ("ENCRYPTED" in pem_type):
+        raise ValueError("%s is an encrypted key, which is not supported" % name)
+
+    try:
+        der = base64.b64decode("".join(body.split()), validate=True)
+    except binascii.Error:
+        der = b""
+
+    if (len(der) == 0) or (der[0] != 0x30) or (der_total_length(der) != len(der)):
+        raise ValueError("%s does not hold a PEM %s; paste the credential generated by OpenSSL"
+                         % (name, pem_type.lower()))
+
+    if pem_type == "RSA PRIVATE KEY":
+        der = der_element(0x30, bytes.fromhex("020100") + RSA_ALGORITHM_ID + der_element(0x04, der))
+
+    return pem_type, der
+
+
+def format_macro(name, der):
+    """Returns the DER data of a credential as an initializer list macro."""
+    data = list(der) + [0]
+    lines = []
+    for i in range(0, len(data), BYTES_PER_LINE):
+        lines.append(", ".join("0x%02X" % byte for byte in data[i:i + BYTES_PER_LINE]))
+
+    indent = " " * 4
+    text = "#define %s \\\n{ \\\n" % name
+    text += ", \\\n".join(indent + line for line in lines)
+    text += " \\\n}\n"
+    return text
+
+
+def convert(input_path, output_path):
+    with open(input_path, "r") as fd:
+        source = fd.read()
+
+    guard = re.sub(r"\W", "_", os.path.basename(output_path)).upper() + "_"
+    output = ("/* Generated by scripts/pem_to_der.py from %s.\n"
+              " * Do not edit: change the PEM credentials in that file instead. */\n\n"
+              "#ifndef %s\n#define %s\n\n" % (os.path.basename(input_path), guard, guard))
+
+    count = 0
+    for match in MACRO_PATTERN.finditer(source):
+        name = match.group(1)
+        text = "".join(unescape(literal) for literal in LITERAL_PATTERN.findall(match.group(2)))
+        if "-----BEGIN " not in text:
+            continue
+
+        pem_type, der = pem_to_der(name, text)
+        der_name = (name[:-4] if name.endswith("_PEM") else name) + "_DER"
+
+        output += "/* %s (%s): %d bytes as PEM, %d bytes as DER. */\n" % (name, pem_type, len(text), len(der))
+        output += "#define %-46s (%du)\n" % (der_name + "_LEN", len(der))
+        output += format_macro(der_name, der) + "\n"
+        print("%s: %s, %d bytes as PEM, %d bytes as DER" % (name, pem_type, len(text), len(der)))
+        count += 1
+
+    if count == 0:
+        raise ValueError("no PEM credential found in %s" % input_path)
+
+    output += "#endif /* %s */\n" % guard
+
+    # Only write a changed file, so that the sources are not rebuilt needlessly.
+    if os.path.exists(output_path):
+        with open(output_path, "r") as fd:
+            if fd.read() == output:
+                return
+    with open(output_path, "w") as fd:
+        fd.write(output)
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 3:
+        print("Usage: python pem_to_der.py <input header> <output header>")
+        sys.exit(1)
+
+    try:
+        convert(sys.argv[1], sys.argv[2])
+    except (OSError, ValueError) as error:
+        print("pem_to_der.py: error: %s" % error)
+        sys.exit(1)
@@ -0,0 +1,525 @@
+/******************************************************************************
+* File Name: https_resource_index.c
+*
+* Description: This file contains the URL resource index of the HTTPS server.
+* Resources are found by an open-addressing hash table with linear probing.
+* Their names and values are stored in a single fixed-size arena, which is
+* compacted instead of allocating from the heap.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2025, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Standard C header file */
+#include <string.h>
+
+/* Resource index header file */
+#include "https_resource_index.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Each value is preceded by the number of its entry and its capacity. */
+#define HTTPS_RESOURCE_VALUE_HEADER_LEN          (4u)
+
+/* Entry number in the header of a released value. */
+#define HTTPS_RESOURCE_NO_ENTRY                  (0xFFFFu)
+
+/* Parameters of the 32-bit FNV-1a hash. */
+#define HTTPS_RESOURCE_FNV_OFFSET_BASIS          (2166136261u)
+#define HTTPS_RESOURCE_FNV_PRIME                 (16777619u)
+
+/* Offsets into the arena and entry numbers are 16 bits wide. */
+#if (HTTPS_RESOURCE_INDEX_CAPACITY < 1) || (HTTPS_RESOURCE_INDEX_CAPACITY >= 0xFFFF)
+#error "HTTPS_RESOURCE_INDEX_CAPACITY must be between 1 and 65534."
+#endif
+
+#if (HTTPS_RESOURCE_INDEX_ARENA_SIZE > 0xFFFF)
+#error "The resource arena must not exceed 65535 bytes. Reduce HTTPS_RESOURCE_INDEX_CAPACITY or HTTPS_RESOURCE_INDEX_ENTRY_SIZE."
+#endif
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static uint32_t https_resource_index_hash(const char *name, size_t *length);
+static uint32_t https_resource_index_hash_value(const char *value, uint32_t value_length);
+static uint32_t https_resource_index_find(const https_resource_index_t *index, const char *name,
+                                          size_t length, uint32_t hash);
+static void https_resource_index_store_value(https_resource_index_t *index, uint32_t entry_number,
+                                             const char *value, uint32_t value_length);
+static void https_resource_index_release_value(https_resource_index_t *index,
+                                               const https_resource_entry_t *entry);
+static void https_resource_index_compact(https_resource_index_t *index);
+
+/*******************************************************************************
+ * Function Name: https_resource_index_init
+ *******************************************************************************
+ * Summary:
+ *  Empties the resource index.
+ *
+ * Parameters:
+ *  https_resource_index_t *index: Resource index
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void https_resource_index_init(https_resource_index_t *index)
+{
+    memset(index->slots, 0, sizeof(index->slots));
+    index->count = 0;
+    index->value_top = 0;
+    index->name_bottom = HTTPS_RESOURCE_INDEX_ARENA_SIZE;
+    index->garbage = 0;
+    index->compactions = 0;
+}
+
+/*******************************************************************************
+ * Function Name: https_resource_index_put
+ *******************************************************************************
+ * Summary:
+ *  Adds a resource or replaces the value of an existing one. A value that
+ *  does not fit in the space of the previous one is stored anew, compacting
+ *  the arena first if needed. Values may move when the arena is compacted,
+ *  but names never move.
+ *
+ * Parameters:
+ *  https_resource_index_t *index: Resource index
+ *  const char *name: Name of the resource, null-terminated
+ *  const char *value: Value of the resource
+ *  uint32_t value_length: Length of the value
+ *  const char **stored_name: Set to the copy of the name in the arena, which
+ *   stays valid while the index exists. Can be NULL.
+ *
+ * Return:
+ *  https_resource_index_result_t: HTTPS_RESOURCE_INDEX_CREATED or
+ *  HTTPS_RESOURCE_INDEX_UPDATED on success. HTTPS_RESOURCE_INDEX_FULL if the
+ *  index holds HTTPS_RESOURCE_INDEX_CAPACITY resources, and
+ *  HTTPS_RESOURCE_INDEX_NO_SPACE if the arena cannot hold the resource. The
+ *  index is unchanged on failure.
+ *
+ *******************************************************************************/
+https_resource_index_result_t https_resource_index_put(https_resource_index_t *index,
+                                                       const char *name,
+                                                       const char *value,
+                                                       uint32_t value_length,
+                                                       const char **stored_name)
+{
+    https_resource_entry_t *entry;
+    uint32_t entry_number;
+    uint32_t needed;
+    uint32_t slot;
+    uint32_t hash;
+    size_t name_length;
+
+    if ((NULL == name) || ((NULL == value) && (value_length > 0u)) ||
+        (value_length > HTTPS_RESOURCE_INDEX_ARENA_SIZE))
+    {
+        return HTTPS_RESOURCE_INDEX_BAD_ARG;
+    }
+
+    hash = https_resource_index_hash(name, &name_length);
+    if ((0u == name_length) || (name_length > HTTPS_RESOURCE_NAME_MAX_LEN))
+    {
+        return HTTPS_RESOURCE_INDEX_BAD_ARG;
+    }
+
+    slot = https_resource_index_find(index, name, name_length, hash);
+
+    if (0u != index->slots[slot])
+    {
+        /* Existing resource: update the value in place if it fits. */
+        entry_number = index->slots[slot] - 1u;
+        entry = &index->entries[entry_number];
+
+        if (value_length <= entry->value_capacity)
+        {
+            memcpy(&index->arena[entry->value_offset], value, value_length);
+            index->garbage = index->garbage + entry->value_length - value_length;
+            entry->value_length = (uint16_t)value_length;
+        }
+        else
+        {
+            needed = HTTPS_RESOURCE_VALUE_HEADER_LEN + value_length;
+            if (https_resource_index_free_space(index) + HTTPS_RESOURCE_VALUE_HEADER_LEN +
+                entry->value_capacity < needed)
+            {
+                return HTTPS_RESOURCE_INDEX_NO_SPACE;
+            }
+
+            https_resource_index_release_value(index, entry);
+            if ((index->name_bottom - index->value_top) < needed)
+            {
+                https_resource_index_compact(index);
+            }
+            https_resource_index_store_value(index, entry_number, value, value_length);
+        }
+
+        entry->value_hash = https_resource_index_hash_value(value, value_length);
+
+        if (NULL != stored_name)
+        {
+            *stored_name = (const char *)&index->arena[entry->name_offset];
+        }
+
+        return HTTPS_RESOURCE_INDEX_UPDATED;
+    }
+
+    /* New resource. */
+    if (index->count >= HTTPS_RESOURCE_INDEX_CAPACITY)
+    {
+        return HTTPS_RESOURCE_INDEX_FULL;
+    }
+
+    needed = (uint32_t)name_length + 1u + HTTPS_RESOURCE_VALUE_HEADER_LEN + value_length;
+    if (https_resource_index_free_space(index) < needed)
+    {
+        return HTTPS_RESOURCE_INDEX_NO_SPACE;
+    }
+
+    if ((index->name_bottom - index->value_top) < needed)
+    {
+        https_resource_index_compact(index);
+    }
+
+    entry_number = index->count;
+    entry = &index->entries[entry_number];
+
+    /* Names are stored from the top of the arena down. */
+    index->name_bottom -= (uint32_t)name_length + 1u;
+    memcpy(&index->arena[index->name_bottom], name, name_length + 1u);
+
+    entry->hash = hash;
+    entry->name_offset = (uint16_t)index->name_bottom;
+    entry->name_length = (uint8_t)name_length;
+    https_resource_index_store_value(index, entry_number, value, value_length);
+    entry->value_hash = https_resource_index_hash_value(value, value_length);
+
+    index->slots[slot] = (uint16_t)(entry_number + 1u);
+    index->count++;
+
+    if (NULL != stored_name)
+    {
+        *stored_name = (const char *)&index->arena[entry->name_offset];
+    }
+
+    return HTTPS_RESOURCE_INDEX_CREATED;
+}
+
+/*******************************************************************************
+ * Function Name: https_resource_index_get
+ *******************************************************************************
+ * Summary:
+ *  Looks up a resource and copies its value, as values may move when the
+ *  index is updated.
+ *
+ * Parameters:
+ *  const https_resource_index_t *index: Resource index
+ *  const char *name: Name of the resource, null-terminated
+ *  char *buffer: Buffer for the value
+ *  uint32_t buffer_size: Size of the buffer. A longer value is truncated.
+ *  uint32_t *value_length: Set to the length of the value
+ *  uint32_t *value_hash: Set to the hash of the value. Can be NULL.
+ *
+ * Return:
+ *  bool: true if the resource exists, false otherwise.
+ *
+ *******************************************************************************/
+bool https_resource_index_get(const https_resource_index_t *index, const char *name,
+                              char *buffer, uint32_t buffer_size, uint32_t *value_length,
+                              uint32_t *value_hash)
+{
+    const https_resource_entry_t *entry;
+    uint32_t slot;
+    uint32_t hash;
+    size_t name_length;
+
+    if (NULL == name)
+    {
+        return false;
+    }
+
+    hash = https_resource_index_hash(name, &name_length);
+    slot = https_resource_index_find(index, name, name_length, hash);
+
+    if (0u == index->slots[slot])
+    {
+        return false;
+    }
+
+    entry = &index->entries[index->slots[slot] - 1u];
+    memcpy(buffer, &index->arena[entry->value_offset],
+           (entry->value_length < buffer_size) ? entry->value_length : buffer_size);
+    *value_length = entry->value_length;
+
+    if (NULL != value_hash)
+    {
+        *value_hash = entry->value_hash;
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: https_resource_index_free_space
+ *******************************************************************************
+ * Summary:
+ *  Returns the space of the arena that is free or can be reclaimed by a
+ *  compaction.
+ *
+ * Parameters:
+ *  const https_resource_index_t *index: Resource index
+ *
+ * Return:
+ *  uint32_t: Number of bytes
+ *
+ *******************************************************************************/
+uint32_t https_resource_index_free_space(const https_resource_index_t *index)
+{
+    return (index->name_bottom - index->value_top) + index->garbage;
+}
+
+/*******************************************************************************
+ * Function Name: https_resource_index_hash
+ *******************************************************************************
+ * Summary:
+ *  Computes the FNV-1a hash of a resource name.
+ *
+ * Parameters:
+ *  const char *name: Name of the resource, null-terminated
+ *  size_t *length: Set to the length of the name
+ *
+ * Return:
+ *  uint32_t: Hash of the name
+ *
+ *******************************************************************************/
+static uint32_t https_resource_index_hash(const char *name, size_t *length)
+{
+    uint32_t hash = HTTPS_RESOURCE_FNV_OFFSET_BASIS;
+    size_t i = 0;
+
+    while ('\0' != name[i])
+    {
+        hash ^= (uint8_t)name[i];
+        hash *= HTTPS_RESOURCE_FNV_PRIME;
+        i++;
+    }
+
+    *length = i;
+    return hash;
+}
+
+/*******************************************************************************
+ * Function Name: https_resource_index_hash_value
+ *******************************************************************************
+ * Summary:
+ *  Computes the FNV-1a hash of a resource value.
+ *
+ * Parameters:
+ *  const char *value: Value of the resource
+ *  uint32_t value_length: Length of the value
+ *
+ * Return:
+ *  uint32_t: Hash of the value
+ *
+ *******************************************************************************/
+static uint32_t https_resource_index_hash_value(const char *value, uint32_t value_length)
+{
+    uint32_t hash = HTTPS_RESOURCE_FNV_OFFSET_BASIS;
+    uint32_t i;
+
+    for (i = 0; i < value_length; i++)
+    {
+        hash ^= (uint8_t)value[i];
+        hash *= HTTPS_RESOURCE_FNV_PRIME;
+    }
+
+    return hash;
+}
+
+/*******************************************************************************
+ * Function Name: https_resource_index_find
+ *******************************************************************************
+ * Summary:
+ *  Probes the hash table for a resource. The table always has a free slot,
+ *  as it has twice as many slots as resources.
+ *
+ * Parameters:
+ *  const https_resource_index_t *index: Resource index
+ *  const char *name: Name of the resource
+ *  size_t length: Length of the name
+ *  uint32_t hash: Hash of the name
+ *
+ * Return:
+ *  uint32_t: Slot of the resource, or the free slot where it is to be added.
+ *
+ *******************************************************************************/
+static uint32_t https_resource_index_find(const https_resource_index_t *index, const char *name,
+                                          size_t length, uint32_t hash)
+{
+    const https_resource_entry_t *entry;
+    uint32_t slot = hash % HTTPS_RESOURCE_INDEX_SLOTS;
+
+    while (0u != index->slots[slot])
+    {
+        entry = &index->entries[index->slots[slot] - 1u];
+
+        if ((entry->hash == hash) && (entry->name_length == length) &&
+            (0 == memcmp(&index->arena[entry->name_offset], name, length)))
+        {
+            break;
+        }
+
+        slot = (slot + 1u < HTTPS_RESOURCE_INDEX_SLOTS) ? (slot + 1u) : 0u;
+    }
+
+    return slot;
+}
+
+/*******************************************************************************
+ * Function Name: https_resource_index_store_value
+ *******************************************************************************
+ * Summary:
+ *  Stores the value of an entry at the top of the value area. The caller
+ *  makes sure that it fits.
+ *
+ * Parameters:
+ *  https_resource_index_t *index: Resource index
+ *  uint32_t entry_number: Entry of the resource
+ *  const char *value: Value of the resource
+ *  uint32_t value_length: Length of the value
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void https_resource_index_store_value(https_resource_index_t *index, uint32_t entry_number,
+                                             const char *value, uint32_t value_length)
+{
+    https_resource_entry_t *entry = &index->entries[entry_number];
+    uint16_t header[2];
+
+    header[0] = (uint16_t)entry_number;
+    header[1] = (uint16_t)value_length;
+    memcpy(&index->arena[index->value_top], header, HTTPS_RESOURCE_VALUE_HEADER_LEN);
+
+    entry->value_offset = (uint16_t)(index->value_top + HTTPS_RESOURCE_VALUE_HEADER_LEN);
+    entry->value_length = (uint16_t)value_length;
+    entry->value_capacity = (uint16_t)value_length;
+    memcpy(&index->arena[entry->value_offset], value, value_length);
+
+    index->value_top = entry->value_offset + value_length;
+}
+
+/*******************************************************************************
+ * Function Name: https_resource_index_release_value
+ *******************************************************************************
+ * Summary:
+ *  Marks the value of an entry as released, to be reclaimed by the next
+ *  compaction.
+ *
+ * Parameters:
+ *  https_resource_index_t *index: Resource index
+ *  const https_resource_entry_t *entry: Entry of the resource
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void https_resource_index_release_value(https_resource_index_t *index,
+                                               const https_resource_entry_t *entry)
+{
+    const uint16_t no_entry = HTTPS_RESOURCE_NO_ENTRY;
+
+    memcpy(&index->arena[entry->value_offset - HTTPS_RESOURCE_VALUE_HEADER_LEN], &no_entry,
+           sizeof(no_entry));
+
+    /* The unused part of the value was already counted. */
+    index->garbage += HTTPS_RESOURCE_VALUE_HEADER_LEN + entry->value_length;
+}
+
+/*******************************************************************************
+ * Function Name: https_resource_index_compact
+ *******************************************************************************
+ * Summary:
+ *  Moves the values in use to the bottom of the arena, in their order,
+ *  dropping released values and the unused part of values that were replaced
+ *  by shorter ones.
+ *
+ * Parameters:
+ *  https_resource_index_t *index: Resource index
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void https_resource_index_compact(https_resource_index_t *index)
+{
+    https_resource_entry_t *entry;
+    uint32_t block_length;
+    uint32_t read = 0;
+    uint32_t write = 0;
+    uint16_t header[2];
+
+    while (read < index->value_top)
+    {
+        memcpy(header, &index->arena[read], HTTPS_RESOURCE_VALUE_HEADER_LEN);
+        block_length = HTTPS_RESOURCE_VALUE_HEADER_LEN + header[1];
+
+        if (HTTPS_RESOURCE_NO_ENTRY != header[0])
+        {
+            entry = &index->entries[header[0]];
+
+            /* Keep only the used part of the value. As write never passes
+             * read, the header can be written before the value is moved.
+             */
+            header[1] = entry->value_length;
+            memcpy(&index->arena[write], header, HTTPS_RESOURCE_VALUE_HEADER_LEN);
+            memmove(&index->arena[write + HTTPS_RESOURCE_VALUE_HEADER_LEN],
+                    &index->arena[read + HTTPS_RESOURCE_VALUE_HEADER_LEN], entry->value_length);
+
+            entry->value_offset = (uint16_t)(write + HTTPS_RESOURCE_VALUE_HEADER_LEN);
+            entry->value_capacity = entry->value_length;
+            write += HTTPS_RESOURCE_VALUE_HEADER_LEN + entry->value_length;
+        }
+
+        read += block_length;
+    }
+
+    index->value_top = write;
+    index->garbage = 0;
+    index->compactions++;
+}
+
+
+/* [] END OF FILE */
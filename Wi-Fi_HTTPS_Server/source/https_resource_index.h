@@ -0,0 +1,150 @@
+/******************************************************************************
+* File Name: https_resource_index.h
+*
+* Description: This file contains declarations of the URL resource index of
+* the HTTPS server: a hash table of the resources created by HTTPS PUT
+* requests, whose names and values are stored in a single arena.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2025, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef HTTPS_RESOURCE_INDEX_H_
+#define HTTPS_RESOURCE_INDEX_H_
+
+/* Standard C header files */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Maximum number of resources in the index. The HTTP server library keeps
+ * MAX_NUMBER_OF_HTTP_SERVER_RESOURCES resources, one of which is the root URL
+ * registered by the application; the default matches the library default of
+ * 10 resources.
+ */
+#ifndef HTTPS_RESOURCE_INDEX_CAPACITY
+#if defined(MAX_NUMBER_OF_HTTP_SERVER_RESOURCES)
+#define HTTPS_RESOURCE_INDEX_CAPACITY            (MAX_NUMBER_OF_HTTP_SERVER_RESOURCES - 1)
+#else
+#define HTTPS_RESOURCE_INDEX_CAPACITY            (9)
+#endif
+#endif
+
+/* Arena bytes reserved per resource. A resource takes the length of its name
+ * and value plus 5 bytes: the null character of the name and a 4-byte value
+ * header. With the default, every resource of the index can hold a name and
+ * value of up to 31 characters together.
+ */
+#ifndef HTTPS_RESOURCE_INDEX_ENTRY_SIZE
+#define HTTPS_RESOURCE_INDEX_ENTRY_SIZE          (36)
+#endif
+
+/* Number of hash table slots, twice the capacity to keep probe sequences
+ * short.
+ */
+#define HTTPS_RESOURCE_INDEX_SLOTS               (2 * HTTPS_RESOURCE_INDEX_CAPACITY)
+
+/* Size of the arena that holds the names and values. */
+#define HTTPS_RESOURCE_INDEX_ARENA_SIZE          (HTTPS_RESOURCE_INDEX_CAPACITY * HTTPS_RESOURCE_INDEX_ENTRY_SIZE)
+
+/* Maximum length of a resource name. */
+#define HTTPS_RESOURCE_NAME_MAX_LEN              (255u)
+
+/*******************************************************************************
+* Data structure and enumeration
+*******************************************************************************/
+/* Result of adding or updating a resource. */
+typedef enum
+{
+    HTTPS_RESOURCE_INDEX_CREATED,
+    HTTPS_RESOURCE_INDEX_UPDATED,
+    HTTPS_RESOURCE_INDEX_FULL,
+    HTTPS_RESOURCE_INDEX_NO_SPACE,
+    HTTPS_RESOURCE_INDEX_BAD_ARG
+} https_resource_index_result_t;
+
+/* One resource. The name is stored at the top of the arena and never moves,
+ * so that it can be registered with the HTTP server library. The value is
+ * stored at the bottom and moves when the arena is compacted. value_hash
+ * identifies the value, for example as an entity tag.
+ */
+typedef struct
+{
+    uint32_t hash;
+    uint32_t value_hash;
+    uint16_t name_offset;
+    uint16_t value_offset;
+    uint16_t value_length;
+    uint16_t value_capacity;
+    uint8_t name_length;
+} https_resource_entry_t;
+
+/* Resource index. slots[] holds the entry number of each resource plus one,
+ * or 0 for a free slot.
+ */
+typedef struct
+{
+    uint16_t slots[HTTPS_RESOURCE_INDEX_SLOTS];
+    https_resource_entry_t entries[HTTPS_RESOURCE_INDEX_CAPACITY];
+    uint8_t arena[HTTPS_RESOURCE_INDEX_ARENA_SIZE];
+    uint32_t count;
+    uint32_t value_top;
+    uint32_t name_bottom;
+    uint32_t garbage;
+    uint32_t compactions;
+} https_resource_index_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+void https_resource_index_init(https_resource_index_t *index);
+https_resource_index_result_t https_resource_index_put(https_resource_index_t *index,
+                                                       const char *name,
+                                                       const char *value,
+                                                       uint32_t value_length,
+                                                       const char **stored_name);
+bool https_resource_index_get(const https_resource_index_t *index, const char *name,
+                              char *buffer, uint32_t buffer_size, uint32_t *value_length,
+                              uint32_t *value_hash);
+uint32_t https_resource_index_free_space(const https_resource_index_t *index);
+
+#endif /* HTTPS_RESOURCE_INDEX_H_ */
+
+
+/* [] END OF FILE */
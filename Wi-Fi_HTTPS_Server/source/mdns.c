@@ -55,7 +55,7 @@
  *
  */
 
-#include "lwip/apps/mdns.h"
+#include "mdns.h"
 #include "lwip/apps/mdns_priv.h"
 #include "lwip/netif.h"
 #include "lwip/udp.h"
@@ -107,6 +107,8 @@ static struct udp_pcb *mdns_pcb;
 NETIF_DECLARE_EXT_CALLBACK(netif_callback)
 #endif
 static mdns_name_result_cb_t mdns_name_result_cb;
+/* _services._dns-sd._udp.local., built by mdns_resp_init() */
+static struct mdns_domain dnssd_domain;
 
 #define NETIF_TO_HOST(netif) (struct mdns_host*)(netif_get_client_data(netif, mdns_netif_client_id))
 
@@ -122,6 +124,65 @@ static mdns_name_result_cb_t mdns_name_result_cb;
 /* Payload size allocated for each outgoing UDP packet */
 #define OUTPACKET_SIZE 500
 
+/* Number of encoded replies cached per netif. A question that selects the
+ * same answers as a cached reply is answered with a copy of it, without
+ * encoding and compressing the records again. 0 disables the cache.
+ */
+#ifndef MDNS_REPLY_CACHE_ENTRIES
+#define MDNS_REPLY_CACHE_ENTRIES 8
+#endif
+
+/* Largest cached reply, without the DNS header */
+#ifndef MDNS_REPLY_CACHE_ENTRY_SIZE
+#define MDNS_REPLY_CACHE_ENTRY_SIZE 256
+#endif
+
+/* Minimum time between two multicasts of an answer on a netif, except in
+ * replies to probes (RFC 6762, section 6). 0 disables the rate limit.
+ */
+#ifndef MDNS_MULTICAST_INTERVAL_MS
+#define MDNS_MULTICAST_INTERVAL_MS 1000
+#endif
+
+/* Longest encoded name of a cached record, like "My printer._ipp._tcp.local"
+ * (28 bytes). Longer records are not cached.
+ */
+#ifndef MDNS_RECORD_NAME_MAXLEN
+#define MDNS_RECORD_NAME_MAXLEN 64
+#endif
+
+/* Number of service types that can be browsed at the same time */
+#ifndef MDNS_MAX_BROWSES
+#define MDNS_MAX_BROWSES 2
+#endif
+
+#if MDNS_RECORD_CACHE_ENTRIES
+/* Period of the record timer, which sends the queries and expires records */
+#define RECORD_TMR_INTERVAL_MS    1000
+/* Delay of the first query for a record asked for, so that the records
+ * asked for at the same time are sent in one query */
+#define RECORD_QUERY_DELAY_MS     100
+/* Queries sent for a record asked for, one per timer period, before giving up */
+#define RECORD_PENDING_QUERIES    3
+/* Records in use are asked for again at 80%, 85%, 90% and 95% of their
+ * TTL (RFC 6762, section 5.2) */
+#define RECORD_REFRESH_PERCENT    80
+#define RECORD_REFRESH_STEP       5
+#define RECORD_REFRESH_QUERIES    4
+/* Longest TTL kept, in seconds, so that the lifetime fits in milliseconds */
+#define RECORD_MAX_TTL            86400
+/* Lifetime of a record after a goodbye, a TTL of 0 (RFC 6762, section 10.1) */
+#define RECORD_GOODBYE_MS         1000
+/* Browse queries are sent after 1, 2, 4... seconds, up to once an hour
+ * (RFC 6762, section 5.2) */
+#define BROWSE_FIRST_INTERVAL_MS  1000
+#define BROWSE_MAX_INTERVAL_MS    3600000
+
+#define RECORD_FREE               0
+#define RECORD_PENDING            1
+#define RECORD_VALID              2
+#endif
+
 /* Lookup from hostname -> IPv4 */
 #define REPLY_HOST_A            0x01
 /* Lookup from IPv4/v6 -> hostname */
@@ -140,6 +201,21 @@ static mdns_name_result_cb_t mdns_name_result_cb;
 /* Lookup for text info on service instance */
 #define REPLY_SERVICE_TXT       0x80
 
+/* Multicast times are kept per IP version */
+#define MULTICAST_V4            0
+#define MULTICAST_V6            1
+#define MULTICAST_IP_VERSIONS   2
+/* Host answers with a multicast time: A, v4 PTR and AAAA by reply bit,
+ * then the v6 PTR of each address */
+#define MULTICAST_HOST_PTR_V6   3
+#if LWIP_IPV6
+#define MULTICAST_HOST_ANSWERS  (MULTICAST_HOST_PTR_V6 + LWIP_IPV6_NUM_ADDRESSES)
+#else
+#define MULTICAST_HOST_ANSWERS  MULTICAST_HOST_PTR_V6
+#endif
+/* Service answers with a multicast time, by reply bit */
+#define MULTICAST_SERVICE_ANSWERS 4
+
 #define MDNS_PROBE_DELAY_MS       250
 #define MDNS_PROBE_COUNT          3
 #ifdef LWIP_RAND
@@ -176,7 +252,34 @@ struct mdns_service {
   u16_t proto;
   /** Port of the service */
   u16_t port;
+  /** Cached <type>.<proto>.local. domain */
+  struct mdns_domain type_domain;
+  /** Cached <name>.<type>.<proto>.local. domain */
+  struct mdns_domain instance_domain;
+  /** Set when txt_fn wrote other TXT data than the time before */
+  u8_t txt_changed;
+#if MDNS_MULTICAST_INTERVAL_MS
+  /** sys_now() when the answers were last multicast */
+  u32_t multicast_time[MULTICAST_IP_VERSIONS][MULTICAST_SERVICE_ANSWERS];
+#endif
+};
+
+#if MDNS_REPLY_CACHE_ENTRIES
+/** Answers of a reply, encoded and compressed as sent after the DNS header */
+struct mdns_reply_cache_entry {
+  /** Reply bitmasks the answers were selected with */
+  u8_t host_replies;
+  u8_t host_reverse_v6_replies;
+  u8_t serv_replies[MDNS_MAX_SERVICES];
+  u8_t cache_flush;
+  /** Number of normal and additional answers */
+  u16_t answers;
+  u16_t additional;
+  /** Length of data, 0 if the entry is unused */
+  u16_t length;
+  u8_t data[MDNS_REPLY_CACHE_ENTRY_SIZE];
 };
+#endif
 
 /** Description of a host/netif */
 struct mdns_host {
@@ -190,6 +293,33 @@ struct mdns_host {
   u8_t probes_sent;
   /** State in probing sequence */
   u8_t probing_state;
+  /** Set while the cached domains and replies match the names of the
+   *  host and its services, see mdns_update_cache() */
+  u8_t cache_valid;
+  /** Cached <hostname>.local. domain */
+  struct mdns_domain host_domain;
+#if LWIP_IPV4
+  /** IPv4 address of the cache and its reverse lookup domain */
+  ip4_addr_t cache_v4_addr;
+  struct mdns_domain reverse_v4_domain;
+#endif
+#if LWIP_IPV6
+  /** Valid IPv6 addresses of the cache and their reverse lookup domains */
+  u8_t cache_v6_valid;
+  ip6_addr_t cache_v6_addr[LWIP_IPV6_NUM_ADDRESSES];
+  struct mdns_domain reverse_v6_domain[LWIP_IPV6_NUM_ADDRESSES];
+#endif
+#if MDNS_REPLY_CACHE_ENTRIES
+  /** Recently sent replies, and the entry to replace next */
+  struct mdns_reply_cache_entry replies[MDNS_REPLY_CACHE_ENTRIES];
+  u8_t next_reply;
+#endif
+#if MDNS_MULTICAST_INTERVAL_MS
+  /** sys_now() when the answers were last multicast */
+  u32_t multicast_time[MULTICAST_IP_VERSIONS][MULTICAST_HOST_ANSWERS];
+#endif
+  /** Counters returned by mdns_resp_get_stats() */
+  struct mdns_resp_stats stats;
 };
 
 /** Information about received packet */
@@ -218,6 +348,12 @@ struct mdns_packet {
   u16_t answers;
   /** Number of unparsed answers */
   u16_t answers_left;
+  /** Number of answers in the answer section,
+   *  the known answers of a query */
+  u16_t known_answers;
+  /** Number of authoritative answers,
+   *  the proposed records of a probe */
+  u16_t authoritative;
 };
 
 /** Information about outgoing packet */
@@ -257,12 +393,36 @@ struct mdns_outpacket {
   u8_t host_reverse_v6_replies;
   /* Reply bitmask per service */
   u8_t serv_replies[MDNS_MAX_SERVICES];
+  /* If the answers may be taken from or stored in the reply cache */
+  u8_t cache_reply;
+};
+
+/** Domain name in a received packet, read without copying it,
+ *  see mdns_readname_ref() */
+struct mdns_name {
+  /** Packet holding the name */
+  struct pbuf *pbuf;
+  /** Offset of the name in the packet */
+  u16_t offset;
+  /** Length of the decompressed name, including zero */
+  u16_t length;
+};
+
+/** Position in a packet buffer chain, to read bytes
+ *  without walking the chain from its start each time */
+struct mdns_pbuf_reader {
+  /** First packet buffer of the chain */
+  const struct pbuf *head;
+  /** Packet buffer holding the last byte read */
+  const struct pbuf *q;
+  /** Offset of the payload of q in the chain */
+  u16_t q_offset;
 };
 
 /** Domain, type and class.
  *  Shared between questions and answers */
 struct mdns_rr_info {
-  struct mdns_domain domain;
+  struct mdns_name name;
   u16_t type;
   u16_t klass;
 };
@@ -285,6 +445,65 @@ struct mdns_answer {
   u16_t rd_offset;
 };
 
+#if MDNS_RECORD_CACHE_ENTRIES
+/** A record of another host, cached for a browse or a resolve,
+ *  see mdns_record_answer() */
+struct mdns_record {
+  /** Netif the record was received on, or is asked for on */
+  struct netif *netif;
+  /** When the record was received, or first asked for */
+  u32_t time;
+  /** Validity time in milliseconds, from time */
+  u32_t ttl_ms;
+  /** Record type: PTR, SRV, A or AAAA */
+  u16_t type;
+  /** SRV: port of the service instance */
+  u16_t port;
+  /** RECORD_FREE, RECORD_PENDING or RECORD_VALID */
+  u8_t state;
+  /** Queries sent for the record since it was asked for or received */
+  u8_t queries;
+  /** If a resolve returned the record since it was received */
+  u8_t used;
+  /** PTR: if the browse was told about the instance */
+  u8_t reported;
+  /** Length of name, including zero */
+  u8_t name_length;
+  /** PTR and SRV: length of target, including zero */
+  u8_t target_length;
+  /** Encoded owner name */
+  u8_t name[MDNS_RECORD_NAME_MAXLEN];
+  union {
+    /** PTR: encoded instance name, SRV: encoded host name */
+    u8_t target[MDNS_RECORD_NAME_MAXLEN];
+    /** A and AAAA: address of the host */
+    ip_addr_t addr;
+  } data;
+};
+
+/** A browsed service type, see mdns_browse_start() */
+struct mdns_browse {
+  /** Netif to browse on, NULL if the slot is free */
+  struct netif *netif;
+  mdns_browse_fn_t browse_fn;
+  void *arg;
+  /** When to send the next query */
+  u32_t next_query;
+  /** Time between queries, doubled after each one */
+  u32_t interval;
+  /** Length of type, including zero */
+  u8_t type_length;
+  /** Encoded service type, like _http._tcp.local */
+  u8_t type[MDNS_RECORD_NAME_MAXLEN];
+};
+
+static struct mdns_record mdns_records[MDNS_RECORD_CACHE_ENTRIES];
+static struct mdns_browse mdns_browses[MDNS_MAX_BROWSES];
+static u8_t mdns_record_tmr_active;
+
+static void mdns_record_tmr(void *arg);
+#endif
+
 static err_t mdns_send_outpacket(struct mdns_outpacket *outpkt, u8_t flags);
 static void mdns_probe(void* arg);
 
@@ -485,6 +704,224 @@ mdns_domain_eq(struct mdns_domain *a, struct mdns_domain *b)
   return 1;
 }
 
+/**
+ * Start reading a packet buffer chain
+ * @param reader The reader
+ * @param p The packet buffer chain
+ */
+static void
+mdns_pbuf_reader_init(struct mdns_pbuf_reader *reader, const struct pbuf *p)
+{
+  reader->head = p;
+  reader->q = p;
+  reader->q_offset = 0;
+}
+
+/**
+ * Find a byte of a packet buffer chain. Reading forward from the last byte
+ * found continues in the same packet buffer; reading backward, such as
+ * following a name compression jump, starts again from the head.
+ * @param reader The reader
+ * @param offset Offset of the byte in the chain
+ * @param avail Set to the number of bytes from there to the end of the
+ *              packet buffer holding it
+ * @return Pointer to the byte, or NULL if offset is beyond the chain
+ */
+static const u8_t *
+mdns_pbuf_find(struct mdns_pbuf_reader *reader, u16_t offset, u16_t *avail)
+{
+  if (offset < reader->q_offset) {
+    reader->q = reader->head;
+    reader->q_offset = 0;
+  }
+  while (reader->q != NULL && (u32_t)offset >= (u32_t)reader->q_offset + reader->q->len) {
+    reader->q_offset = (u16_t)(reader->q_offset + reader->q->len);
+    reader->q = reader->q->next;
+  }
+  if (reader->q == NULL) {
+    return NULL;
+  }
+  *avail = (u16_t)(reader->q_offset + reader->q->len - offset);
+  return (const u8_t *)reader->q->payload + (offset - reader->q_offset);
+}
+
+/**
+ * Read a byte of a packet buffer chain, see mdns_pbuf_find()
+ * @param reader The reader
+ * @param offset Offset of the byte in the chain
+ * @return The byte, or -1 if offset is beyond the chain
+ */
+static int
+mdns_pbuf_read(struct mdns_pbuf_reader *reader, u16_t offset)
+{
+  u16_t avail;
+  const u8_t *byte = mdns_pbuf_find(reader, offset, &avail);
+
+  return (byte != NULL) ? *byte : -1;
+}
+
+/**
+ * Read possibly compressed domain name from packet buffer without copying it.
+ * Only the label lengths are read: the name is checked as by mdns_readname(),
+ * and its offset and decompressed length are noted to compare it with
+ * domains by mdns_name_eq().
+ * Unlike mdns_readname(), a name cut off by the end of the packet is an error.
+ * @param p The packet
+ * @param offset start position of domain name in packet
+ * @param name The name to fill in
+ * @return The new offset after the domain, or MDNS_READNAME_ERROR
+ *         if reading failed
+ */
+static u16_t
+mdns_readname_ref(struct pbuf *p, u16_t offset, struct mdns_name *name)
+{
+  struct mdns_pbuf_reader reader;
+  u16_t end = 0;
+  u16_t length = 0;
+  unsigned jumps = 0;
+  int c;
+
+  name->pbuf = p;
+  name->offset = offset;
+  mdns_pbuf_reader_init(&reader, p);
+
+  do {
+    c = mdns_pbuf_read(&reader, offset);
+    if (c < 0) {
+      return MDNS_READNAME_ERROR;
+    }
+    offset++;
+
+    /* is this a compressed label? */
+    if ((c & 0xc0) == 0xc0) {
+      int low = mdns_pbuf_read(&reader, offset);
+      u16_t jumpaddr;
+      /* Same limit of 5 jumps as mdns_readname() */
+      if (low < 0 || ++jumps > 5) {
+        return MDNS_READNAME_ERROR;
+      }
+      offset++;
+      if (end == 0) {
+        /* The name ends with its first jump */
+        end = offset;
+      }
+      jumpaddr = (u16_t)(((c & 0x3f) << 8) | low);
+      if (jumpaddr < SIZEOF_DNS_HDR || jumpaddr >= p->tot_len) {
+        return MDNS_READNAME_ERROR;
+      }
+      offset = jumpaddr;
+      continue;
+    }
+
+    /* normal label, which must fit in the packet */
+    if (c > MDNS_LABEL_MAXLEN || (c > 0 && length + 1 + c >= MDNS_DOMAIN_MAXLEN) ||
+        (u32_t)offset + c > p->tot_len) {
+      return MDNS_READNAME_ERROR;
+    }
+    length = (u16_t)(length + 1 + c);
+    offset = (u16_t)(offset + c);
+  } while (c != 0);
+
+  name->length = length;
+  return end ? end : offset;
+}
+
+/**
+ * Compare a domain name read by mdns_readname_ref() with an encoded domain
+ * name, ignoring case, without copying the name out of its packet. Names of
+ * another length are told apart without reading the packet again.
+ * @param name The domain name in a received packet
+ * @param encoded The encoded domain name to compare with
+ * @param length The length of encoded, including zero
+ * @return 1 if the names are equal ignoring case, 0 otherwise
+ */
+static int
+mdns_name_eq_encoded(const struct mdns_name *name, const u8_t *encoded, u16_t length)
+{
+  struct mdns_pbuf_reader reader;
+  u16_t offset = name->offset;
+  u16_t pos = 0;
+  int c;
+
+  if (name->length != length) {
+    return 0;
+  }
+
+  mdns_pbuf_reader_init(&reader, name->pbuf);
+  /* The name was checked when it was read, so it fits in the packet and
+   * has the same length as the encoded name */
+  do {
+    u16_t left;
+
+    c = mdns_pbuf_read(&reader, offset);
+    if (c < 0) {
+      return 0;
+    }
+    if ((c & 0xc0) == 0xc0) {
+      offset = (u16_t)(((c & 0x3f) << 8) | mdns_pbuf_read(&reader, (u16_t)(offset + 1)));
+      continue;
+    }
+    if (c != encoded[pos]) {
+      return 0;
+    }
+    offset++;
+    pos++;
+
+    /* Compare the label a packet buffer at a time */
+    left = (u16_t)c;
+    while (left > 0) {
+      u16_t avail, count, i;
+      const u8_t *bytes = mdns_pbuf_find(&reader, offset, &avail);
+      if (bytes == NULL) {
+        return 0;
+      }
+      count = LWIP_MIN(left, avail);
+      for (i = 0; i < count; i++) {
+        u8_t a = bytes[i];
+        u8_t b = encoded[pos + i];
+        /* Letters may differ in case only */
+        if (a != b && ((a | 0x20) != (b | 0x20) || (a | 0x20) < 'a' || (a | 0x20) > 'z')) {
+          return 0;
+        }
+      }
+      offset = (u16_t)(offset + count);
+      pos = (u16_t)(pos + count);
+      left = (u16_t)(left - count);
+    }
+  } while (c != 0);
+
+  return 1;
+}
+
+/**
+ * Compare a domain name read by mdns_readname_ref() with a domain, ignoring
+ * case, see mdns_name_eq_encoded()
+ * @param name The domain name in a received packet
+ * @param domain The domain to compare with
+ * @return 1 if the names are equal ignoring case, 0 otherwise
+ */
+static int
+mdns_name_eq(const struct mdns_name *name, const struct mdns_domain *domain)
+{
+  return mdns_name_eq_encoded(name, domain->name, domain->length);
+}
+
+/**
+ * Print domain name of a received packet to debug output
+ * @param name The domain name
+ */
+static void
+mdns_name_debug_print(const struct mdns_name *name)
+{
+  /* Only copy the name if debug output is enabled */
+  if (MDNS_DEBUG & LWIP_DBG_ON) {
+    struct mdns_domain domain;
+    if (mdns_readname(name->pbuf, name->offset, &domain) != MDNS_READNAME_ERROR) {
+      mdns_domain_debug_print(&domain);
+    }
+  }
+}
+
 /**
  * Call user supplied function to setup TXT data
  * @param service The service to build TXT record for
@@ -492,10 +929,21 @@ mdns_domain_eq(struct mdns_domain *a, struct mdns_domain *b)
 static void
 mdns_prepare_txtdata(struct mdns_service *service)
 {
+#if MDNS_REPLY_CACHE_ENTRIES
+  struct mdns_domain previous;
+  SMEMCPY(&previous, &service->txtdata, sizeof(previous));
+#endif
   memset(&service->txtdata, 0, sizeof(struct mdns_domain));
   if (service->txt_fn) {
     service->txt_fn(service, service->txt_userdata);
   }
+#if MDNS_REPLY_CACHE_ENTRIES
+  /* Replies cached with the previous TXT data must not be sent again */
+  if (previous.length != service->txtdata.length ||
+      memcmp(previous.name, service->txtdata.name, previous.length) != 0) {
+    service->txt_changed = 1;
+  }
+#endif
 }
 
 #if LWIP_IPV4
@@ -658,8 +1106,81 @@ mdns_build_service_domain(struct mdns_domain *domain, struct mdns_service *servi
   return mdns_add_dotlocal(domain);
 }
 
+#if MDNS_REPLY_CACHE_ENTRIES
+/**
+ * Drop all cached replies of a host
+ * @param mdns The host
+ */
+static void
+mdns_reply_cache_clear(struct mdns_host *mdns)
+{
+  int i;
+  for (i = 0; i < MDNS_REPLY_CACHE_ENTRIES; i++) {
+    mdns->replies[i].length = 0;
+  }
+  mdns->next_reply = 0;
+}
+#endif
+
+/**
+ * Build the cached domains of a host and its services, and drop the cached
+ * replies, if a name changed since they were built (cache_valid cleared) or
+ * an address of the netif changed. The addresses are compared on every call,
+ * so that the cache also follows changes that lwIP does not report.
+ * @param netif The network interface of the host
+ */
+static void
+mdns_update_cache(struct netif *netif)
+{
+  struct mdns_host *mdns = NETIF_TO_HOST(netif);
+  u8_t changed = !mdns->cache_valid;
+  int i;
+
+#if LWIP_IPV4
+  if (!ip4_addr_cmp(&mdns->cache_v4_addr, netif_ip4_addr(netif))) {
+    ip4_addr_copy(mdns->cache_v4_addr, *netif_ip4_addr(netif));
+    mdns_build_reverse_v4_domain(&mdns->reverse_v4_domain, &mdns->cache_v4_addr);
+    changed = 1;
+  }
+#endif
+#if LWIP_IPV6
+  for (i = 0; i < LWIP_IPV6_NUM_ADDRESSES; i++) {
+    u8_t valid = ip6_addr_isvalid(netif_ip6_addr_state(netif, i)) ? (u8_t)(1 << i) : 0;
+    if (valid != (mdns->cache_v6_valid & (1 << i)) ||
+        (valid && !ip6_addr_cmp(&mdns->cache_v6_addr[i], netif_ip6_addr(netif, i)))) {
+      mdns->cache_v6_valid = (u8_t)((mdns->cache_v6_valid & ~(1 << i)) | valid);
+      if (valid) {
+        ip6_addr_copy(mdns->cache_v6_addr[i], *netif_ip6_addr(netif, i));
+        mdns_build_reverse_v6_domain(&mdns->reverse_v6_domain[i], &mdns->cache_v6_addr[i]);
+      }
+      changed = 1;
+    }
+  }
+#endif
+
+  if (!changed) {
+    return;
+  }
+
+  if (!mdns->cache_valid) {
+    mdns_build_host_domain(&mdns->host_domain, mdns);
+    for (i = 0; i < MDNS_MAX_SERVICES; i++) {
+      struct mdns_service *service = mdns->services[i];
+      if (service) {
+        mdns_build_service_domain(&service->type_domain, service, 0);
+        mdns_build_service_domain(&service->instance_domain, service, 1);
+      }
+    }
+    mdns->cache_valid = 1;
+  }
+#if MDNS_REPLY_CACHE_ENTRIES
+  mdns_reply_cache_clear(mdns);
+#endif
+}
+
 /**
  * Check which replies we should send for a host/netif based on question
+ * Compares against the cached domains, see mdns_update_cache().
  * @param netif The network interface that received the question
  * @param rr Domain/type/class from a question
  * @param reverse_v6_reply Bitmask of which IPv6 addresses to send reverse PTRs for
@@ -669,9 +1190,8 @@ mdns_build_service_domain(struct mdns_domain *domain, struct mdns_service *servi
 static int
 check_host(struct netif *netif, struct mdns_rr_info *rr, u8_t *reverse_v6_reply)
 {
-  err_t res;
   int replies = 0;
-  struct mdns_domain mydomain;
+  struct mdns_host *mdns = NETIF_TO_HOST(netif);
 
   LWIP_UNUSED_ARG(reverse_v6_reply); /* if ipv6 is disabled */
 
@@ -686,8 +1206,7 @@ check_host(struct netif *netif, struct mdns_rr_info *rr, u8_t *reverse_v6_reply)
     int i;
     for (i = 0; i < LWIP_IPV6_NUM_ADDRESSES; i++) {
       if (ip6_addr_isvalid(netif_ip6_addr_state(netif, i))) {
-        res = mdns_build_reverse_v6_domain(&mydomain, netif_ip6_addr(netif, i));
-        if (res == ERR_OK && mdns_domain_eq(&rr->domain, &mydomain)) {
+        if (mdns_name_eq(&rr->name, &mdns->reverse_v6_domain[i])) {
           replies |= REPLY_HOST_PTR_V6;
           /* Mark which addresses where requested */
           if (reverse_v6_reply) {
@@ -698,18 +1217,15 @@ check_host(struct netif *netif, struct mdns_rr_info *rr, u8_t *reverse_v6_reply)
     }
 #endif
 #if LWIP_IPV4
-    if (!ip4_addr_isany_val(*netif_ip4_addr(netif))) {
-      res = mdns_build_reverse_v4_domain(&mydomain, netif_ip4_addr(netif));
-      if (res == ERR_OK && mdns_domain_eq(&rr->domain, &mydomain)) {
-        replies |= REPLY_HOST_PTR_V4;
-      }
+    if (!ip4_addr_isany_val(*netif_ip4_addr(netif)) &&
+        mdns_name_eq(&rr->name, &mdns->reverse_v4_domain)) {
+      replies |= REPLY_HOST_PTR_V4;
     }
 #endif
   }
 
-  res = mdns_build_host_domain(&mydomain, NETIF_TO_HOST(netif));
   /* Handle requests for our hostname */
-  if (res == ERR_OK && mdns_domain_eq(&rr->domain, &mydomain)) {
+  if (mdns_name_eq(&rr->name, &mdns->host_domain)) {
     /* TODO return NSEC if unsupported protocol requested */
 #if LWIP_IPV4
     if (!ip4_addr_isany_val(*netif_ip4_addr(netif))
@@ -729,6 +1245,7 @@ check_host(struct netif *netif, struct mdns_rr_info *rr, u8_t *reverse_v6_reply)
 
 /**
  * Check which replies we should send for a service based on question
+ * Compares against the cached domains, see mdns_update_cache().
  * @param service A registered MDNS service
  * @param rr Domain/type/class from a question
  * @return Bitmask of which replies to send
@@ -736,31 +1253,26 @@ check_host(struct netif *netif, struct mdns_rr_info *rr, u8_t *reverse_v6_reply)
 static int
 check_service(struct mdns_service *service, struct mdns_rr_info *rr)
 {
-  err_t res;
   int replies = 0;
-  struct mdns_domain mydomain;
 
   if (rr->klass != DNS_RRCLASS_IN && rr->klass != DNS_RRCLASS_ANY) {
     /* Invalid class */
     return 0;
   }
 
-  res = mdns_build_dnssd_domain(&mydomain);
-  if (res == ERR_OK && mdns_domain_eq(&rr->domain, &mydomain) &&
+  if (mdns_name_eq(&rr->name, &dnssd_domain) &&
       (rr->type == DNS_RRTYPE_PTR || rr->type == DNS_RRTYPE_ANY)) {
     /* Request for all service types */
     replies |= REPLY_SERVICE_TYPE_PTR;
   }
 
-  res = mdns_build_service_domain(&mydomain, service, 0);
-  if (res == ERR_OK && mdns_domain_eq(&rr->domain, &mydomain) &&
+  if (mdns_name_eq(&rr->name, &service->type_domain) &&
       (rr->type == DNS_RRTYPE_PTR || rr->type == DNS_RRTYPE_ANY)) {
     /* Request for the instance of my service */
     replies |= REPLY_SERVICE_NAME_PTR;
   }
 
-  res = mdns_build_service_domain(&mydomain, service, 1);
-  if (res == ERR_OK && mdns_domain_eq(&rr->domain, &mydomain)) {
+  if (mdns_name_eq(&rr->name, &service->instance_domain)) {
     /* Request for info about my service */
     if (rr->type == DNS_RRTYPE_SRV || rr->type == DNS_RRTYPE_ANY) {
       replies |= REPLY_SERVICE_SRV;
@@ -1050,7 +1562,7 @@ static err_t
 mdns_read_rr_info(struct mdns_packet *pkt, struct mdns_rr_info *info)
 {
   u16_t field16, copied;
-  pkt->parse_offset = mdns_readname(pkt->pbuf, pkt->parse_offset, &info->domain);
+  pkt->parse_offset = mdns_readname_ref(pkt->pbuf, pkt->parse_offset, &info->name);
   if (pkt->parse_offset == MDNS_READNAME_ERROR) {
     return ERR_VAL;
   }
@@ -1171,21 +1683,18 @@ mdns_read_answer(struct mdns_packet *pkt, struct mdns_answer *answer)
 static err_t
 mdns_add_a_answer(struct mdns_outpacket *reply, u16_t cache_flush, struct netif *netif)
 {
-  struct mdns_domain host;
-  mdns_build_host_domain(&host, NETIF_TO_HOST(netif));
+  struct mdns_host *mdns = NETIF_TO_HOST(netif);
   LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Responding with A record\n"));
-  return mdns_add_answer(reply, &host, DNS_RRTYPE_A, DNS_RRCLASS_IN, cache_flush, (NETIF_TO_HOST(netif))->dns_ttl, (const u8_t *) netif_ip4_addr(netif), sizeof(ip4_addr_t), NULL);
+  return mdns_add_answer(reply, &mdns->host_domain, DNS_RRTYPE_A, DNS_RRCLASS_IN, cache_flush, (NETIF_TO_HOST(netif))->dns_ttl, (const u8_t *) netif_ip4_addr(netif), sizeof(ip4_addr_t), NULL);
 }
 
 /** Write a 4.3.2.1.in-addr.arpa -> hostname.local PTR RR to outpacket */
 static err_t
 mdns_add_hostv4_ptr_answer(struct mdns_outpacket *reply, u16_t cache_flush, struct netif *netif)
 {
-  struct mdns_domain host, revhost;
-  mdns_build_host_domain(&host, NETIF_TO_HOST(netif));
-  mdns_build_reverse_v4_domain(&revhost, netif_ip4_addr(netif));
+  struct mdns_host *mdns = NETIF_TO_HOST(netif);
   LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Responding with v4 PTR record\n"));
-  return mdns_add_answer(reply, &revhost, DNS_RRTYPE_PTR, DNS_RRCLASS_IN, cache_flush, (NETIF_TO_HOST(netif))->dns_ttl, NULL, 0, &host);
+  return mdns_add_answer(reply, &mdns->reverse_v4_domain, DNS_RRTYPE_PTR, DNS_RRCLASS_IN, cache_flush, mdns->dns_ttl, NULL, 0, &mdns->host_domain);
 }
 #endif
 
@@ -1194,21 +1703,18 @@ mdns_add_hostv4_ptr_answer(struct mdns_outpacket *reply, u16_t cache_flush, stru
 static err_t
 mdns_add_aaaa_answer(struct mdns_outpacket *reply, u16_t cache_flush, struct netif *netif, int addrindex)
 {
-  struct mdns_domain host;
-  mdns_build_host_domain(&host, NETIF_TO_HOST(netif));
+  struct mdns_host *mdns = NETIF_TO_HOST(netif);
   LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Responding with AAAA record\n"));
-  return mdns_add_answer(reply, &host, DNS_RRTYPE_AAAA, DNS_RRCLASS_IN, cache_flush, (NETIF_TO_HOST(netif))->dns_ttl, (const u8_t *) netif_ip6_addr(netif, addrindex), sizeof(ip6_addr_p_t), NULL);
+  return mdns_add_answer(reply, &mdns->host_domain, DNS_RRTYPE_AAAA, DNS_RRCLASS_IN, cache_flush, (NETIF_TO_HOST(netif))->dns_ttl, (const u8_t *) netif_ip6_addr(netif, addrindex), sizeof(ip6_addr_p_t), NULL);
 }
 
 /** Write a x.y.z.ip6.arpa -> hostname.local PTR RR to outpacket */
 static err_t
 mdns_add_hostv6_ptr_answer(struct mdns_outpacket *reply, u16_t cache_flush, struct netif *netif, int addrindex)
 {
-  struct mdns_domain host, revhost;
-  mdns_build_host_domain(&host, NETIF_TO_HOST(netif));
-  mdns_build_reverse_v6_domain(&revhost, netif_ip6_addr(netif, addrindex));
+  struct mdns_host *mdns = NETIF_TO_HOST(netif);
   LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Responding with v6 PTR record\n"));
-  return mdns_add_answer(reply, &revhost, DNS_RRTYPE_PTR, DNS_RRCLASS_IN, cache_flush, (NETIF_TO_HOST(netif))->dns_ttl, NULL, 0, &host);
+  return mdns_add_answer(reply, &mdns->reverse_v6_domain[addrindex], DNS_RRTYPE_PTR, DNS_RRCLASS_IN, cache_flush, mdns->dns_ttl, NULL, 0, &mdns->host_domain);
 }
 #endif
 
@@ -1216,56 +1722,49 @@ mdns_add_hostv6_ptr_answer(struct mdns_outpacket *reply, u16_t cache_flush, stru
 static err_t
 mdns_add_servicetype_ptr_answer(struct mdns_outpacket *reply, struct mdns_service *service)
 {
-  struct mdns_domain service_type, service_dnssd;
-  mdns_build_service_domain(&service_type, service, 0);
-  mdns_build_dnssd_domain(&service_dnssd);
   LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Responding with service type PTR record\n"));
-  return mdns_add_answer(reply, &service_dnssd, DNS_RRTYPE_PTR, DNS_RRCLASS_IN, 0, service->dns_ttl, NULL, 0, &service_type);
+  return mdns_add_answer(reply, &dnssd_domain, DNS_RRTYPE_PTR, DNS_RRCLASS_IN, 0, service->dns_ttl, NULL, 0, &service->type_domain);
 }
 
 /** Write a servicetype -> servicename PTR RR to outpacket */
 static err_t
 mdns_add_servicename_ptr_answer(struct mdns_outpacket *reply, struct mdns_service *service)
 {
-  struct mdns_domain service_type, service_instance;
-  mdns_build_service_domain(&service_type, service, 0);
-  mdns_build_service_domain(&service_instance, service, 1);
   LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Responding with service name PTR record\n"));
-  return mdns_add_answer(reply, &service_type, DNS_RRTYPE_PTR, DNS_RRCLASS_IN, 0, service->dns_ttl, NULL, 0, &service_instance);
+  return mdns_add_answer(reply, &service->type_domain, DNS_RRTYPE_PTR, DNS_RRCLASS_IN, 0, service->dns_ttl, NULL, 0, &service->instance_domain);
 }
 
 /** Write a SRV RR to outpacket */
 static err_t
 mdns_add_srv_answer(struct mdns_outpacket *reply, u16_t cache_flush, struct mdns_host *mdns, struct mdns_service *service)
 {
-  struct mdns_domain service_instance, srvhost;
+  struct mdns_domain legacy_srvhost;
+  struct mdns_domain *srvhost = &mdns->host_domain;
   u16_t srvdata[3];
-  mdns_build_service_domain(&service_instance, service, 1);
-  mdns_build_host_domain(&srvhost, mdns);
   if (reply->legacy_query) {
     /* RFC 6762 section 18.14:
      * In legacy unicast responses generated to answer legacy queries,
      * name compression MUST NOT be performed on SRV records.
      */
-    srvhost.skip_compression = 1;
+    SMEMCPY(&legacy_srvhost, srvhost, sizeof(legacy_srvhost));
+    legacy_srvhost.skip_compression = 1;
+    srvhost = &legacy_srvhost;
   }
   srvdata[0] = lwip_htons(SRV_PRIORITY);
   srvdata[1] = lwip_htons(SRV_WEIGHT);
   srvdata[2] = lwip_htons(service->port);
   LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Responding with SRV record\n"));
-  return mdns_add_answer(reply, &service_instance, DNS_RRTYPE_SRV, DNS_RRCLASS_IN, cache_flush, service->dns_ttl,
-                         (const u8_t *) &srvdata, sizeof(srvdata), &srvhost);
+  return mdns_add_answer(reply, &service->instance_domain, DNS_RRTYPE_SRV, DNS_RRCLASS_IN, cache_flush, service->dns_ttl,
+                         (const u8_t *) &srvdata, sizeof(srvdata), srvhost);
 }
 
 /** Write a TXT RR to outpacket */
 static err_t
 mdns_add_txt_answer(struct mdns_outpacket *reply, u16_t cache_flush, struct mdns_service *service)
 {
-  struct mdns_domain service_instance;
-  mdns_build_service_domain(&service_instance, service, 1);
   mdns_prepare_txtdata(service);
   LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Responding with TXT record\n"));
-  return mdns_add_answer(reply, &service_instance, DNS_RRTYPE_TXT, DNS_RRCLASS_IN, cache_flush, service->dns_ttl,
+  return mdns_add_answer(reply, &service->instance_domain, DNS_RRTYPE_TXT, DNS_RRCLASS_IN, cache_flush, service->dns_ttl,
                          (u8_t *) &service->txtdata.name, service->txtdata.length, NULL);
 }
 
@@ -1299,68 +1798,278 @@ mdns_init_outpacket(struct mdns_outpacket *out, struct mdns_packet *in)
   }
 }
 
+#if MDNS_REPLY_CACHE_ENTRIES
 /**
- * Send chosen answers as a reply
- *
- * Add all selected answers (first write will allocate pbuf)
- * Add additional answers based on the selected answers
- * Send the packet
+ * Find the cached reply with the answers selected in an outpacket.
+ * The TXT data of the services is fetched again first; if any changed,
+ * all cached replies are dropped.
+ * @param outpkt The outpacket with the selected answers
+ * @return The cached reply, or NULL if the answers must be written
  */
-static err_t
-mdns_send_outpacket(struct mdns_outpacket *outpkt, u8_t flags)
+static const struct mdns_reply_cache_entry *
+mdns_reply_cache_find(struct mdns_outpacket *outpkt)
 {
-  struct mdns_service *service;
-  err_t res = ERR_ARG;
-  int i;
   struct mdns_host *mdns = NETIF_TO_HOST(outpkt->netif);
-  u16_t answers = 0;
+  u8_t txt_changed = 0;
+  int i;
 
-  /* Write answers to host questions */
-#if LWIP_IPV4
-  if (outpkt->host_replies & REPLY_HOST_A) {
-    res = mdns_add_a_answer(outpkt, outpkt->cache_flush, outpkt->netif);
-    if (res != ERR_OK) {
-      goto cleanup;
+  for (i = 0; i < MDNS_MAX_SERVICES; i++) {
+    struct mdns_service *service = mdns->services[i];
+    if (!service) {
+      continue;
     }
-    answers++;
-  }
-  if (outpkt->host_replies & REPLY_HOST_PTR_V4) {
-    res = mdns_add_hostv4_ptr_answer(outpkt, outpkt->cache_flush, outpkt->netif);
-    if (res != ERR_OK) {
-      goto cleanup;
+    /* A service instance PTR reply adds the TXT record */
+    if (service->txt_fn && (outpkt->serv_replies[i] & (REPLY_SERVICE_NAME_PTR | REPLY_SERVICE_TXT))) {
+      mdns_prepare_txtdata(service);
     }
-    answers++;
-  }
-#endif
-#if LWIP_IPV6
-  if (outpkt->host_replies & REPLY_HOST_AAAA) {
-    int addrindex;
-    for (addrindex = 0; addrindex < LWIP_IPV6_NUM_ADDRESSES; addrindex++) {
-      if (ip6_addr_isvalid(netif_ip6_addr_state(outpkt->netif, addrindex))) {
-        res = mdns_add_aaaa_answer(outpkt, outpkt->cache_flush, outpkt->netif, addrindex);
-        if (res != ERR_OK) {
-          goto cleanup;
-        }
-        answers++;
-      }
+    if (service->txt_changed) {
+      service->txt_changed = 0;
+      txt_changed = 1;
     }
   }
-  if (outpkt->host_replies & REPLY_HOST_PTR_V6) {
-    u8_t rev_addrs = outpkt->host_reverse_v6_replies;
-    int addrindex = 0;
-    while (rev_addrs) {
-      if (rev_addrs & 1) {
-        res = mdns_add_hostv6_ptr_answer(outpkt, outpkt->cache_flush, outpkt->netif, addrindex);
-        if (res != ERR_OK) {
-          goto cleanup;
-        }
-        answers++;
-      }
-      addrindex++;
-      rev_addrs >>= 1;
+  if (txt_changed) {
+    mdns_reply_cache_clear(mdns);
+    return NULL;
+  }
+
+  for (i = 0; i < MDNS_REPLY_CACHE_ENTRIES; i++) {
+    const struct mdns_reply_cache_entry *entry = &mdns->replies[i];
+    if (entry->length &&
+        entry->host_replies == outpkt->host_replies &&
+        entry->host_reverse_v6_replies == outpkt->host_reverse_v6_replies &&
+        entry->cache_flush == outpkt->cache_flush &&
+        memcmp(entry->serv_replies, outpkt->serv_replies, sizeof(entry->serv_replies)) == 0) {
+      return entry;
     }
   }
-#endif
+  return NULL;
+}
+
+/**
+ * Copy a cached reply into a new outpacket pbuf of the exact size
+ * @param outpkt The outpacket to fill
+ * @param entry The cached reply
+ * @return ERR_OK on success, an err_t otherwise
+ */
+static err_t
+mdns_reply_cache_load(struct mdns_outpacket *outpkt, const struct mdns_reply_cache_entry *entry)
+{
+  outpkt->pbuf = pbuf_alloc(PBUF_TRANSPORT, SIZEOF_DNS_HDR + entry->length, PBUF_RAM);
+  if (!outpkt->pbuf) {
+    return ERR_MEM;
+  }
+  outpkt->write_offset = SIZEOF_DNS_HDR + entry->length;
+  outpkt->answers = entry->answers;
+  outpkt->additional = entry->additional;
+  LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Responding with cached reply\n"));
+  return pbuf_take_at(outpkt->pbuf, entry->data, entry->length, SIZEOF_DNS_HDR);
+}
+
+/**
+ * Store the answers written to an outpacket in the reply cache, replacing
+ * the oldest entry. Compression jumps point into the answers only, as cached
+ * replies hold no questions, so the answers stay valid after the header.
+ * @param outpkt The outpacket with all answers written
+ */
+static void
+mdns_reply_cache_store(struct mdns_outpacket *outpkt)
+{
+  struct mdns_host *mdns = NETIF_TO_HOST(outpkt->netif);
+  struct mdns_reply_cache_entry *entry;
+  u16_t length = outpkt->write_offset - SIZEOF_DNS_HDR;
+
+  if (length == 0 || length > MDNS_REPLY_CACHE_ENTRY_SIZE) {
+    return;
+  }
+
+  entry = &mdns->replies[mdns->next_reply];
+  mdns->next_reply = (u8_t)((mdns->next_reply + 1) % MDNS_REPLY_CACHE_ENTRIES);
+  if (pbuf_copy_partial(outpkt->pbuf, entry->data, length, SIZEOF_DNS_HDR) != length) {
+    entry->length = 0;
+    return;
+  }
+  entry->host_replies = outpkt->host_replies;
+  entry->host_reverse_v6_replies = outpkt->host_reverse_v6_replies;
+  SMEMCPY(entry->serv_replies, outpkt->serv_replies, sizeof(entry->serv_replies));
+  entry->cache_flush = outpkt->cache_flush;
+  entry->answers = outpkt->answers;
+  entry->additional = outpkt->additional;
+  entry->length = length;
+}
+#endif
+
+#if MDNS_MULTICAST_INTERVAL_MS
+/**
+ * Set the multicast times of answers as if they were multicast
+ * MDNS_MULTICAST_INTERVAL_MS ago, so that they may be multicast now.
+ * @param times The multicast times
+ * @param count Number of multicast times
+ */
+static void
+mdns_multicast_reset(u32_t *times, int count)
+{
+  u32_t past = sys_now() - MDNS_MULTICAST_INTERVAL_MS;
+  int i;
+
+  for (i = 0; i < count; i++) {
+    times[i] = past;
+  }
+}
+
+/**
+ * Drop a selected answer that was multicast less than
+ * MDNS_MULTICAST_INTERVAL_MS ago, or record that it is multicast now.
+ * @param time The multicast time of the answer
+ * @param replies The reply bitmask that selects the answer
+ * @param bit The bit of the answer in the bitmask
+ * @param now The current time
+ * @param sent 1 to record the multicast, 0 to drop the answer if too recent
+ * @return 1 if the answer was dropped, 0 otherwise
+ */
+static int
+mdns_multicast_answer(u32_t *time, u8_t *replies, u8_t bit, u32_t now, u8_t sent)
+{
+  if (!(*replies & bit)) {
+    return 0;
+  }
+  if (sent) {
+    *time = now;
+    return 0;
+  }
+  if ((u32_t)(now - *time) < MDNS_MULTICAST_INTERVAL_MS) {
+    *replies &= ~bit;
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * Apply the multicast rate limit of RFC 6762 section 6 to the answers
+ * selected in an outpacket: drop the answers multicast on the netif less than
+ * MDNS_MULTICAST_INTERVAL_MS ago, or record that the answers are multicast now.
+ * Each IP version has its own multicast times, as a querier may only listen
+ * to one of the multicast groups.
+ * @param outpkt The outpacket with the selected answers
+ * @param sent 1 if the answers were multicast, 0 to drop recent answers
+ * @return Number of answers dropped
+ */
+static int
+mdns_multicast_limit(struct mdns_outpacket *outpkt, u8_t sent)
+{
+  struct mdns_host *mdns = NETIF_TO_HOST(outpkt->netif);
+  int version = IP_IS_V6_VAL(outpkt->dest_addr) ? MULTICAST_V6 : MULTICAST_V4;
+  u32_t now = sys_now();
+  int dropped = 0;
+  int i, j;
+
+  for (i = 0; i < MULTICAST_HOST_PTR_V6; i++) {
+    dropped += mdns_multicast_answer(&mdns->multicast_time[version][i], &outpkt->host_replies, (u8_t)(1 << i), now, sent);
+  }
+#if LWIP_IPV6
+  if (outpkt->host_replies & REPLY_HOST_PTR_V6) {
+    for (i = 0; i < LWIP_IPV6_NUM_ADDRESSES; i++) {
+      dropped += mdns_multicast_answer(&mdns->multicast_time[version][MULTICAST_HOST_PTR_V6 + i],
+                                       &outpkt->host_reverse_v6_replies, (u8_t)(1 << i), now, sent);
+    }
+    if (outpkt->host_reverse_v6_replies == 0) {
+      outpkt->host_replies &= ~REPLY_HOST_PTR_V6;
+    }
+  }
+#endif
+
+  for (i = 0; i < MDNS_MAX_SERVICES; i++) {
+    struct mdns_service *service = mdns->services[i];
+    if (!service) {
+      continue;
+    }
+    for (j = 0; j < MULTICAST_SERVICE_ANSWERS; j++) {
+      dropped += mdns_multicast_answer(&service->multicast_time[version][j], &outpkt->serv_replies[i],
+                                       (u8_t)(REPLY_SERVICE_TYPE_PTR << j), now, sent);
+    }
+  }
+
+  return dropped;
+}
+#endif
+
+/**
+ * Send chosen answers as a reply
+ *
+ * Add all selected answers (first write will allocate pbuf)
+ * Add additional answers based on the selected answers
+ * Send the packet
+ *
+ * If outpkt->cache_reply is set, a cached reply with the same answers is
+ * sent instead, and the written answers are cached.
+ */
+static err_t
+mdns_send_outpacket(struct mdns_outpacket *outpkt, u8_t flags)
+{
+  struct mdns_service *service;
+  err_t res = ERR_ARG;
+  int i;
+  struct mdns_host *mdns = NETIF_TO_HOST(outpkt->netif);
+  u16_t answers = 0;
+
+#if MDNS_REPLY_CACHE_ENTRIES
+  if (outpkt->cache_reply) {
+    const struct mdns_reply_cache_entry *entry = mdns_reply_cache_find(outpkt);
+    if (entry) {
+      res = mdns_reply_cache_load(outpkt, entry);
+      if (res != ERR_OK) {
+        goto cleanup;
+      }
+      goto send;
+    }
+  }
+#endif
+
+  /* Write answers to host questions */
+#if LWIP_IPV4
+  if (outpkt->host_replies & REPLY_HOST_A) {
+    res = mdns_add_a_answer(outpkt, outpkt->cache_flush, outpkt->netif);
+    if (res != ERR_OK) {
+      goto cleanup;
+    }
+    answers++;
+  }
+  if (outpkt->host_replies & REPLY_HOST_PTR_V4) {
+    res = mdns_add_hostv4_ptr_answer(outpkt, outpkt->cache_flush, outpkt->netif);
+    if (res != ERR_OK) {
+      goto cleanup;
+    }
+    answers++;
+  }
+#endif
+#if LWIP_IPV6
+  if (outpkt->host_replies & REPLY_HOST_AAAA) {
+    int addrindex;
+    for (addrindex = 0; addrindex < LWIP_IPV6_NUM_ADDRESSES; addrindex++) {
+      if (ip6_addr_isvalid(netif_ip6_addr_state(outpkt->netif, addrindex))) {
+        res = mdns_add_aaaa_answer(outpkt, outpkt->cache_flush, outpkt->netif, addrindex);
+        if (res != ERR_OK) {
+          goto cleanup;
+        }
+        answers++;
+      }
+    }
+  }
+  if (outpkt->host_replies & REPLY_HOST_PTR_V6) {
+    u8_t rev_addrs = outpkt->host_reverse_v6_replies;
+    int addrindex = 0;
+    while (rev_addrs) {
+      if (rev_addrs & 1) {
+        res = mdns_add_hostv6_ptr_answer(outpkt, outpkt->cache_flush, outpkt->netif, addrindex);
+        if (res != ERR_OK) {
+          goto cleanup;
+        }
+        answers++;
+      }
+      addrindex++;
+      rev_addrs >>= 1;
+    }
+  }
+#endif
 
   /* Write answers to service questions */
   for (i = 0; i < MDNS_MAX_SERVICES; i++) {
@@ -1468,6 +2177,13 @@ mdns_send_outpacket(struct mdns_outpacket *outpkt, u8_t flags)
     }
   }
 
+#if MDNS_REPLY_CACHE_ENTRIES
+  if (outpkt->cache_reply && outpkt->pbuf) {
+    mdns_reply_cache_store(outpkt);
+  }
+
+send:
+#endif
   if (outpkt->pbuf) {
     const ip_addr_t *mcast_destaddr;
     struct dns_hdr hdr;
@@ -1500,6 +2216,11 @@ mdns_send_outpacket(struct mdns_outpacket *outpkt, u8_t flags)
       res = udp_sendto_if(mdns_pcb, outpkt->pbuf, &outpkt->dest_addr, outpkt->dest_port, outpkt->netif);
     } else {
       res = udp_sendto_if(mdns_pcb, outpkt->pbuf, mcast_destaddr, LWIP_IANA_PORT_MDNS, outpkt->netif);
+#if MDNS_MULTICAST_INTERVAL_MS
+      if (res == ERR_OK && (flags & DNS_FLAG1_RESPONSE)) {
+        mdns_multicast_limit(outpkt, 1);
+      }
+#endif
     }
   }
 
@@ -1523,6 +2244,7 @@ mdns_announce(struct netif *netif, const ip_addr_t *destination)
   int i;
   struct mdns_host *mdns = NETIF_TO_HOST(netif);
 
+  mdns_update_cache(netif);
   memset(&announce, 0, sizeof(announce));
   announce.netif = netif;
   announce.cache_flush = 1;
@@ -1557,7 +2279,8 @@ mdns_announce(struct netif *netif, const ip_addr_t *destination)
  * Handle question MDNS packet
  * 1. Parse all questions and set bits what answers to send
  * 2. Clear pending answers if known answers are supplied
- * 3. Put chosen answers in new packet and send as reply
+ * 3. Clear pending multicast answers sent less than MDNS_MULTICAST_INTERVAL_MS ago
+ * 4. Put chosen answers in new packet and send as reply
  */
 static void
 mdns_handle_question(struct mdns_packet *pkt)
@@ -1566,8 +2289,14 @@ mdns_handle_question(struct mdns_packet *pkt)
   struct mdns_outpacket reply;
   int replies = 0;
   int i;
+  u16_t known;
   err_t res;
   struct mdns_host *mdns = NETIF_TO_HOST(pkt->netif);
+#if LWIP_IPV6
+  /* Valid IPv6 addresses, and those listed in AAAA known answers */
+  u8_t valid_v6_addrs = 0;
+  u8_t known_v6_addrs = 0;
+#endif
 
   if (mdns->probing_state != MDNS_PROBING_COMPLETE) {
     /* Don't answer questions until we've verified our domains via probing */
@@ -1575,7 +2304,12 @@ mdns_handle_question(struct mdns_packet *pkt)
     return;
   }
 
+  mdns_update_cache(pkt->netif);
   mdns_init_outpacket(&reply, pkt);
+#if MDNS_REPLY_CACHE_ENTRIES
+  /* Legacy replies repeat the question, so their answers are not cached */
+  reply.cache_reply = !reply.legacy_query;
+#endif
 
   while (pkt->questions_left) {
     struct mdns_question q;
@@ -1587,7 +2321,7 @@ mdns_handle_question(struct mdns_packet *pkt)
     }
 
     LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Query for domain "));
-    mdns_domain_debug_print(&q.info.domain);
+    mdns_name_debug_print(&q.info.name);
     LWIP_DEBUGF(MDNS_DEBUG, (" type %d class %d\n", q.info.type, q.info.klass));
 
     if (q.unicast) {
@@ -1609,7 +2343,11 @@ mdns_handle_question(struct mdns_packet *pkt)
 
     if (replies && reply.legacy_query) {
       /* Add question to reply packet (legacy packet only has 1 question) */
-      res = mdns_add_question(&reply, &q.info.domain, q.info.type, q.info.klass, 0);
+      struct mdns_domain domain;
+      if (mdns_readname(pkt->pbuf, q.info.name.offset, &domain) == MDNS_READNAME_ERROR) {
+        goto cleanup;
+      }
+      res = mdns_add_question(&reply, &domain, q.info.type, q.info.klass, 0);
       reply.questions = 1;
       if (res != ERR_OK) {
         goto cleanup;
@@ -1617,173 +2355,847 @@ mdns_handle_question(struct mdns_packet *pkt)
     }
   }
 
-  /* Handle known answers */
-  while (pkt->answers_left) {
-    struct mdns_answer ans;
-    u8_t rev_v6;
-    int match;
+  if (!replies) {
+    /* Nothing to answer, skip the known answers */
+    return;
+  }
+
+  /* Handle known answers, which are in the answer section only (RFC 6762, section 7.1) */
+  for (known = 0; known < pkt->known_answers; known++) {
+    struct mdns_answer ans;
+    u8_t rev_v6;
+    int match;
+
+    res = mdns_read_answer(pkt, &ans);
+    if (res != ERR_OK) {
+      LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Failed to parse answer, skipping query packet\n"));
+      goto cleanup;
+    }
+
+    LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Known answer for domain "));
+    mdns_name_debug_print(&ans.info.name);
+    LWIP_DEBUGF(MDNS_DEBUG, (" type %d class %d\n", ans.info.type, ans.info.klass));
+
+
+    if (ans.info.type == DNS_RRTYPE_ANY || ans.info.klass == DNS_RRCLASS_ANY) {
+      /* Skip known answers for ANY type & class */
+      continue;
+    }
+
+    rev_v6 = 0;
+    match = reply.host_replies & check_host(pkt->netif, &ans.info, &rev_v6);
+    if (match && (ans.ttl > (mdns->dns_ttl / 2))) {
+      /* The RR in the known answer matches an RR we are planning to send,
+       * and the TTL is less than half gone.
+       * If the payload matches we should not send that answer.
+       */
+      if (ans.info.type == DNS_RRTYPE_PTR) {
+        /* Read domain and compare */
+        struct mdns_name known_ans;
+        u16_t len;
+        len = mdns_readname_ref(pkt->pbuf, ans.rd_offset, &known_ans);
+        if (len != MDNS_READNAME_ERROR && mdns_name_eq(&known_ans, &mdns->host_domain)) {
+#if LWIP_IPV4
+          if (match & REPLY_HOST_PTR_V4) {
+            LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Skipping known answer: v4 PTR\n"));
+            reply.host_replies &= ~REPLY_HOST_PTR_V4;
+            mdns->stats.known_answers_suppressed++;
+          }
+#endif
+#if LWIP_IPV6
+          if ((match & REPLY_HOST_PTR_V6) && (reply.host_reverse_v6_replies & rev_v6)) {
+            LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Skipping known answer: v6 PTR\n"));
+            reply.host_reverse_v6_replies &= ~rev_v6;
+            if (reply.host_reverse_v6_replies == 0) {
+              reply.host_replies &= ~REPLY_HOST_PTR_V6;
+            }
+            mdns->stats.known_answers_suppressed++;
+          }
+#endif
+        }
+      } else if (match & REPLY_HOST_A) {
+#if LWIP_IPV4
+        if (ans.rd_length == sizeof(ip4_addr_t) &&
+            pbuf_memcmp(pkt->pbuf, ans.rd_offset, netif_ip4_addr(pkt->netif), ans.rd_length) == 0) {
+          LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Skipping known answer: A\n"));
+          reply.host_replies &= ~REPLY_HOST_A;
+          mdns->stats.known_answers_suppressed++;
+        }
+#endif
+      } else if (match & REPLY_HOST_AAAA) {
+#if LWIP_IPV6
+        /* All AAAA records are answered together, note which addresses are known */
+        if (ans.rd_length == sizeof(ip6_addr_p_t)) {
+          int addrindex;
+          for (addrindex = 0; addrindex < LWIP_IPV6_NUM_ADDRESSES; addrindex++) {
+            if (ip6_addr_isvalid(netif_ip6_addr_state(pkt->netif, addrindex)) &&
+                pbuf_memcmp(pkt->pbuf, ans.rd_offset, netif_ip6_addr(pkt->netif, addrindex), ans.rd_length) == 0) {
+              known_v6_addrs |= (u8_t)(1 << addrindex);
+            }
+          }
+        }
+#endif
+      }
+    }
+
+    for (i = 0; i < MDNS_MAX_SERVICES; i++) {
+      service = mdns->services[i];
+      if (!service) {
+        continue;
+      }
+      match = reply.serv_replies[i] & check_service(service, &ans.info);
+      if (match && (ans.ttl > (service->dns_ttl / 2))) {
+        /* The RR in the known answer matches an RR we are planning to send,
+         * and the TTL is less than half gone.
+         * If the payload matches we should not send that answer.
+         */
+        if (ans.info.type == DNS_RRTYPE_PTR) {
+          /* Read domain and compare */
+          struct mdns_name known_ans;
+          u16_t len;
+          len = mdns_readname_ref(pkt->pbuf, ans.rd_offset, &known_ans);
+          if (len != MDNS_READNAME_ERROR) {
+            if (match & REPLY_SERVICE_TYPE_PTR) {
+              if (mdns_name_eq(&known_ans, &service->type_domain)) {
+                LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Skipping known answer: service type PTR\n"));
+                reply.serv_replies[i] &= ~REPLY_SERVICE_TYPE_PTR;
+                mdns->stats.known_answers_suppressed++;
+              }
+            }
+            if (match & REPLY_SERVICE_NAME_PTR) {
+              if (mdns_name_eq(&known_ans, &service->instance_domain)) {
+                LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Skipping known answer: service name PTR\n"));
+                reply.serv_replies[i] &= ~REPLY_SERVICE_NAME_PTR;
+                mdns->stats.known_answers_suppressed++;
+              }
+            }
+          }
+        } else if (match & REPLY_SERVICE_SRV) {
+          /* Read and compare to my SRV record */
+          u16_t field16, len, read_pos;
+          struct mdns_name known_ans;
+          read_pos = ans.rd_offset;
+          do {
+            /* Check priority field */
+            len = pbuf_copy_partial(pkt->pbuf, &field16, sizeof(field16), read_pos);
+            if (len != sizeof(field16) || lwip_ntohs(field16) != SRV_PRIORITY) {
+              break;
+            }
+            read_pos += len;
+            /* Check weight field */
+            len = pbuf_copy_partial(pkt->pbuf, &field16, sizeof(field16), read_pos);
+            if (len != sizeof(field16) || lwip_ntohs(field16) != SRV_WEIGHT) {
+              break;
+            }
+            read_pos += len;
+            /* Check port field */
+            len = pbuf_copy_partial(pkt->pbuf, &field16, sizeof(field16), read_pos);
+            if (len != sizeof(field16) || lwip_ntohs(field16) != service->port) {
+              break;
+            }
+            read_pos += len;
+            /* Check host field */
+            len = mdns_readname_ref(pkt->pbuf, read_pos, &known_ans);
+            if (len == MDNS_READNAME_ERROR || !mdns_name_eq(&known_ans, &mdns->host_domain)) {
+              break;
+            }
+            LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Skipping known answer: SRV\n"));
+            reply.serv_replies[i] &= ~REPLY_SERVICE_SRV;
+            mdns->stats.known_answers_suppressed++;
+          } while (0);
+        } else if (match & REPLY_SERVICE_TXT) {
+          mdns_prepare_txtdata(service);
+          if (service->txtdata.length == ans.rd_length &&
+              pbuf_memcmp(pkt->pbuf, ans.rd_offset, service->txtdata.name, ans.rd_length) == 0) {
+            LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Skipping known answer: TXT\n"));
+            reply.serv_replies[i] &= ~REPLY_SERVICE_TXT;
+            mdns->stats.known_answers_suppressed++;
+          }
+        }
+      }
+    }
+  }
+
+#if LWIP_IPV6
+  if (reply.host_replies & REPLY_HOST_AAAA) {
+    for (i = 0; i < LWIP_IPV6_NUM_ADDRESSES; i++) {
+      if (ip6_addr_isvalid(netif_ip6_addr_state(pkt->netif, i))) {
+        valid_v6_addrs |= (u8_t)(1 << i);
+      }
+    }
+    if (known_v6_addrs && (known_v6_addrs & valid_v6_addrs) == valid_v6_addrs) {
+      LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Skipping known answer: AAAA\n"));
+      reply.host_replies &= ~REPLY_HOST_AAAA;
+      mdns->stats.known_answers_suppressed++;
+    }
+  }
+#endif
+
+#if MDNS_MULTICAST_INTERVAL_MS
+  if (!reply.unicast_reply && !pkt->authoritative) {
+    /* Probes are answered at once, to defend our names */
+    mdns->stats.answers_rate_limited += (u32_t)mdns_multicast_limit(&reply, 0);
+  }
+#endif
+
+  if (mdns_send_outpacket(&reply, DNS_FLAG1_RESPONSE | DNS_FLAG1_AUTHORATIVE) == ERR_OK) {
+    mdns->stats.replies++;
+  }
+
+cleanup:
+  if (reply.pbuf) {
+    /* This should only happen if we fail to alloc/write question for legacy query */
+    pbuf_free(reply.pbuf);
+    reply.pbuf = NULL;
+  }
+}
+
+#if MDNS_RECORD_CACHE_ENTRIES
+/**
+ * Compare two encoded domain names of the same length, ignoring case.
+ * Label lengths are below 64 and never taken for letters.
+ */
+static int
+mdns_record_name_eq(const u8_t *a, const u8_t *b, u16_t length)
+{
+  u16_t i;
+
+  for (i = 0; i < length; i++) {
+    u8_t x = a[i];
+    u8_t y = b[i];
+    if (x != y && ((x | 0x20) != (y | 0x20) || (x | 0x20) < 'a' || (x | 0x20) > 'z')) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+ * Find a cached or pending record
+ * @param netif The network interface of the record
+ * @param type The record type
+ * @param name The encoded owner name
+ * @param length The length of name
+ * @param target PTR: the encoded instance name, NULL to match any instance
+ * @param target_length The length of target
+ * @return The record, NULL if not found
+ */
+static struct mdns_record *
+mdns_record_find(struct netif *netif, u16_t type, const u8_t *name, u8_t length,
+                 const u8_t *target, u8_t target_length)
+{
+  int i;
+
+  for (i = 0; i < MDNS_RECORD_CACHE_ENTRIES; i++) {
+    struct mdns_record *record = &mdns_records[i];
+    if (record->state != RECORD_FREE && record->netif == netif && record->type == type &&
+        record->name_length == length && mdns_record_name_eq(record->name, name, length) &&
+        (target == NULL || (record->target_length == target_length &&
+                            mdns_record_name_eq(record->data.target, target, target_length)))) {
+      return record;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Find the browse of a service type
+ * @return The browse, NULL if the type is not browsed on the netif
+ */
+static struct mdns_browse *
+mdns_browse_find(struct netif *netif, const u8_t *type, u8_t length)
+{
+  int i;
+
+  for (i = 0; i < MDNS_MAX_BROWSES; i++) {
+    struct mdns_browse *browse = &mdns_browses[i];
+    if (browse->netif == netif && browse->type_length == length &&
+        mdns_record_name_eq(browse->type, type, length)) {
+      return browse;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Time left before a record expires. A pending record expires when the
+ * queries for it went unanswered.
+ * @return The time left in milliseconds, 0 or less once expired
+ */
+static s32_t
+mdns_record_left(const struct mdns_record *record, u32_t now)
+{
+  u32_t lifetime = record->ttl_ms;
+
+  if (record->state == RECORD_PENDING) {
+    lifetime = RECORD_PENDING_QUERIES * RECORD_TMR_INTERVAL_MS;
+  }
+  return (s32_t)(lifetime - (now - record->time));
+}
+
+/**
+ * Copy the instance name of a PTR record, its first label, to a string
+ */
+static void
+mdns_record_instance(char *instance, const struct mdns_record *record)
+{
+  u8_t len = record->data.target[0];
+
+  MEMCPY(instance, &record->data.target[1], len);
+  instance[len] = '\0';
+}
+
+/**
+ * Build a domain from an encoded name, to write it to a packet
+ */
+static void
+mdns_record_domain(struct mdns_domain *domain, const u8_t *name, u8_t length)
+{
+  memset(domain, 0, sizeof(struct mdns_domain));
+  MEMCPY(domain->name, name, length);
+  domain->length = length;
+}
+
+/**
+ * (Re)start the record timer
+ * @param delay Time to the next run of the timer in milliseconds
+ */
+static void
+mdns_record_schedule(u32_t delay)
+{
+  if (mdns_record_tmr_active) {
+    sys_untimeout(mdns_record_tmr, NULL);
+  }
+  mdns_record_tmr_active = 1;
+  sys_timeout(delay, mdns_record_tmr, NULL);
+}
+
+/**
+ * Get a free record. When the cache is full, the record closest to expiry is
+ * dropped, except instances already reported to a browse: they are kept
+ * until they expire, so that the browse is told when they are gone.
+ * @return The cleared record, NULL if no record can be dropped
+ */
+static struct mdns_record *
+mdns_record_alloc(u32_t now)
+{
+  struct mdns_record *oldest = NULL;
+  s32_t oldest_left = 0;
+  int i;
+
+  for (i = 0; i < MDNS_RECORD_CACHE_ENTRIES; i++) {
+    struct mdns_record *record = &mdns_records[i];
+    s32_t left;
+
+    if (record->state == RECORD_FREE) {
+      oldest = record;
+      break;
+    }
+    if (record->type == DNS_RRTYPE_PTR && record->reported) {
+      continue;
+    }
+    left = mdns_record_left(record, now);
+    if (oldest == NULL || left < oldest_left) {
+      oldest = record;
+      oldest_left = left;
+    }
+  }
+
+  if (oldest) {
+    memset(oldest, 0, sizeof(struct mdns_record));
+    oldest->time = now;
+    if (!mdns_record_tmr_active) {
+      mdns_record_schedule(RECORD_TMR_INTERVAL_MS);
+    }
+  }
+  return oldest;
+}
+
+/**
+ * Find a record, or ask for it: a pending record is added, which the
+ * following runs of mdns_record_tmr() send queries for.
+ * @return The record, NULL if the cache is full
+ */
+static struct mdns_record *
+mdns_record_want(struct netif *netif, u16_t type, const u8_t *name, u8_t length, u32_t now)
+{
+  struct mdns_record *record = mdns_record_find(netif, type, name, length, NULL, 0);
+
+  if (record == NULL) {
+    record = mdns_record_alloc(now);
+    if (record == NULL) {
+      return NULL;
+    }
+    record->netif = netif;
+    record->type = type;
+    record->state = RECORD_PENDING;
+    MEMCPY(record->name, name, length);
+    record->name_length = length;
+    mdns_record_schedule(RECORD_QUERY_DELAY_MS);
+  }
+  return record;
+}
+
+/**
+ * Address record type to ask for a host on a netif: A if the netif has an
+ * IPv4 address, AAAA otherwise
+ */
+static u16_t
+mdns_record_addr_type(struct netif *netif)
+{
+#if LWIP_IPV4
+  if (!ip4_addr_isany_val(*netif_ip4_addr(netif))) {
+    return DNS_RRTYPE_A;
+  }
+#endif
+#if LWIP_IPV6
+  return DNS_RRTYPE_AAAA;
+#else
+  return DNS_RRTYPE_A;
+#endif
+}
+
+/**
+ * Look up the address of a host in the cache
+ * @param name The encoded host name
+ * @param length The length of name
+ * @param addr Set to the address of the host
+ * @return ERR_OK if found, ERR_INPROGRESS otherwise
+ */
+static err_t
+mdns_record_lookup_host(struct netif *netif, const u8_t *name, u8_t length, ip_addr_t *addr)
+{
+  struct mdns_record *record = NULL;
+
+#if LWIP_IPV4
+  record = mdns_record_find(netif, DNS_RRTYPE_A, name, length, NULL, 0);
+  if (record && record->state != RECORD_VALID) {
+    record = NULL;
+  }
+#endif
+#if LWIP_IPV6
+  if (record == NULL) {
+    record = mdns_record_find(netif, DNS_RRTYPE_AAAA, name, length, NULL, 0);
+    if (record && record->state != RECORD_VALID) {
+      record = NULL;
+    }
+  }
+#endif
+  if (record == NULL) {
+    return ERR_INPROGRESS;
+  }
+  record->used = 1;
+  ip_addr_copy(*addr, record->data.addr);
+  return ERR_OK;
+}
+
+/**
+ * Look up the address and port of a service instance in the cache
+ * @param name The encoded instance name
+ * @param length The length of name
+ * @param addr Set to the address of the instance
+ * @param port Set to the port of the instance
+ * @return ERR_OK if found, ERR_INPROGRESS otherwise
+ */
+static err_t
+mdns_record_lookup_service(struct netif *netif, const u8_t *name, u8_t length, ip_addr_t *addr, u16_t *port)
+{
+  struct mdns_record *srv = mdns_record_find(netif, DNS_RRTYPE_SRV, name, length, NULL, 0);
+  err_t res;
+
+  if (srv == NULL || srv->state != RECORD_VALID) {
+    return ERR_INPROGRESS;
+  }
+  res = mdns_record_lookup_host(netif, srv->data.target, srv->target_length, addr);
+  if (res == ERR_OK) {
+    srv->used = 1;
+    *port = srv->port;
+  }
+  return res;
+}
+
+/**
+ * Drop an expired record. The browse is told that an instance it was told
+ * about is gone.
+ */
+static void
+mdns_record_expire(struct mdns_record *record)
+{
+  struct mdns_browse *browse = NULL;
+  struct netif *netif = record->netif;
+  char instance[MDNS_LABEL_MAXLEN + 1];
+
+  if (record->type == DNS_RRTYPE_PTR && record->reported) {
+    browse = mdns_browse_find(netif, record->name, record->name_length);
+    mdns_record_instance(instance, record);
+  }
+  record->state = RECORD_FREE;
+  if (browse) {
+    browse->browse_fn(netif, MDNS_BROWSE_GONE, instance, NULL, 0, browse->arg);
+  }
+}
+
+/**
+ * Send the due queries on a netif in one packet: the browsed service types,
+ * the records asked for, and the records in use close to expiry. The
+ * instances known of a browsed type are added as known answers.
+ */
+static void
+mdns_record_query(struct netif *netif, u32_t now)
+{
+  struct mdns_outpacket pkt;
+  struct mdns_domain domain;
+  struct mdns_domain instance;
+  u8_t asked[MDNS_MAX_BROWSES];
+  int i;
+
+  memset(&pkt, 0, sizeof(pkt));
+  memset(asked, 0, sizeof(asked));
+  pkt.netif = netif;
+
+  for (i = 0; i < MDNS_RECORD_CACHE_ENTRIES; i++) {
+    struct mdns_record *record = &mdns_records[i];
+    u32_t elapsed = now - record->time;
+
+    if (record->state == RECORD_FREE || record->netif != netif) {
+      continue;
+    }
+    if (record->state == RECORD_PENDING) {
+      if (record->queries >= RECORD_PENDING_QUERIES || elapsed < record->queries * RECORD_TMR_INTERVAL_MS) {
+        continue;
+      }
+    } else {
+      if (record->queries >= RECORD_REFRESH_QUERIES ||
+          elapsed < (record->ttl_ms / 100) * (RECORD_REFRESH_PERCENT + RECORD_REFRESH_STEP * record->queries)) {
+        continue;
+      }
+      if (record->type == DNS_RRTYPE_PTR) {
+        /* Instances are asked for by the query of their browse */
+        struct mdns_browse *browse = mdns_browse_find(netif, record->name, record->name_length);
+        if (browse) {
+          browse->next_query = now;
+          record->queries++;
+        }
+        continue;
+      }
+      if (!record->used) {
+        continue;
+      }
+    }
+
+    mdns_record_domain(&domain, record->name, record->name_length);
+    if (mdns_add_question(&pkt, &domain, record->type, DNS_RRCLASS_IN, 0) != ERR_OK) {
+      /* Packet full, the rest is sent by the next run */
+      break;
+    }
+    pkt.questions++;
+    record->queries++;
+  }
+
+  for (i = 0; i < MDNS_MAX_BROWSES; i++) {
+    struct mdns_browse *browse = &mdns_browses[i];
+
+    if (browse->netif != netif || (s32_t)(now - browse->next_query) < 0) {
+      continue;
+    }
+    mdns_record_domain(&domain, browse->type, browse->type_length);
+    if (mdns_add_question(&pkt, &domain, DNS_RRTYPE_PTR, DNS_RRCLASS_IN, 0) != ERR_OK) {
+      break;
+    }
+    pkt.questions++;
+    asked[i] = 1;
+    browse->next_query = now + browse->interval;
+    browse->interval = LWIP_MIN(browse->interval * 2, BROWSE_MAX_INTERVAL_MS);
+  }
+
+  /* Known answers: the instances with more than half of their TTL left
+   * (RFC 6762, section 7.1) */
+  for (i = 0; i < MDNS_RECORD_CACHE_ENTRIES && pkt.questions; i++) {
+    struct mdns_record *record = &mdns_records[i];
+    struct mdns_browse *browse;
+    s32_t left;
+
+    if (record->state != RECORD_VALID || record->netif != netif || record->type != DNS_RRTYPE_PTR) {
+      continue;
+    }
+    left = mdns_record_left(record, now);
+    browse = mdns_browse_find(netif, record->name, record->name_length);
+    if (browse == NULL || !asked[browse - mdns_browses] || left <= (s32_t)(record->ttl_ms / 2)) {
+      continue;
+    }
+    mdns_record_domain(&domain, record->name, record->name_length);
+    mdns_record_domain(&instance, record->data.target, record->target_length);
+    if (mdns_add_answer(&pkt, &domain, DNS_RRTYPE_PTR, DNS_RRCLASS_IN, 0, (u32_t)left / 1000,
+                        NULL, 0, &instance) != ERR_OK) {
+      break;
+    }
+    pkt.answers++;
+  }
+
+  if (pkt.questions == 0) {
+    if (pkt.pbuf) {
+      pbuf_free(pkt.pbuf);
+    }
+    return;
+  }
+
+  /* Multicast the query over IPv4 if the netif has an address */
+  pkt.dest_port = LWIP_IANA_PORT_MDNS;
+#if LWIP_IPV6
+  SMEMCPY(&pkt.dest_addr, IP6_ADDR_ANY, sizeof(pkt.dest_addr));
+#endif
+#if LWIP_IPV4
+  if (mdns_record_addr_type(netif) == DNS_RRTYPE_A) {
+    SMEMCPY(&pkt.dest_addr, IP4_ADDR_ANY, sizeof(pkt.dest_addr));
+  }
+#endif
+  LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Sending query, %d questions, %d known answers\n", pkt.questions, pkt.answers));
+  mdns_send_outpacket(&pkt, 0);
+}
+
+/**
+ * Timer callback of the record cache: expires records and sends the due
+ * queries. Runs while records are cached or types browsed.
+ */
+static void
+mdns_record_tmr(void *arg)
+{
+  struct netif *netif;
+  u32_t now = sys_now();
+  int active = 0;
+  int i;
+
+  LWIP_UNUSED_ARG(arg);
+  mdns_record_tmr_active = 0;
+
+  for (i = 0; i < MDNS_RECORD_CACHE_ENTRIES; i++) {
+    struct mdns_record *record = &mdns_records[i];
+    if (record->state != RECORD_FREE && mdns_record_left(record, now) <= 0) {
+      mdns_record_expire(record);
+    }
+  }
+
+  NETIF_FOREACH(netif) {
+    if (NETIF_TO_HOST(netif) != NULL) {
+      mdns_record_query(netif, now);
+    }
+  }
+
+  for (i = 0; i < MDNS_RECORD_CACHE_ENTRIES; i++) {
+    if (mdns_records[i].state != RECORD_FREE) {
+      active = 1;
+    }
+  }
+  for (i = 0; i < MDNS_MAX_BROWSES; i++) {
+    if (mdns_browses[i].netif != NULL) {
+      active = 1;
+    }
+  }
+  /* A callback may have restarted the timer */
+  if (active && !mdns_record_tmr_active) {
+    mdns_record_schedule(RECORD_TMR_INTERVAL_MS);
+  }
+}
+
+/**
+ * Cache an answer of a response from another host (RFC 6762, section 10),
+ * if it is wanted: instances of a browsed service type, and the records
+ * asked for or cached before. The location of a new instance, and the
+ * address of the host of a service, are asked for in turn.
+ * @param pkt The received response
+ * @param ans The answer read from it
+ * @param now The current time
+ */
+static void
+mdns_record_answer(struct mdns_packet *pkt, struct mdns_answer *ans, u32_t now)
+{
+  struct mdns_record *record = NULL;
+  struct mdns_domain target;
+  u16_t field16;
+  int i;
+
+  if (ans->info.klass != DNS_RRCLASS_IN || ans->info.name.length > MDNS_RECORD_NAME_MAXLEN) {
+    return;
+  }
+
+  target.length = 0;
+  if (ans->info.type == DNS_RRTYPE_PTR) {
+    struct mdns_host *mdns = NETIF_TO_HOST(pkt->netif);
+    struct mdns_browse *browse = NULL;
+
+    for (i = 0; i < MDNS_MAX_BROWSES; i++) {
+      if (mdns_browses[i].netif == pkt->netif &&
+          mdns_name_eq_encoded(&ans->info.name, mdns_browses[i].type, mdns_browses[i].type_length)) {
+        browse = &mdns_browses[i];
+        break;
+      }
+    }
+    if (browse == NULL) {
+      return;
+    }
+    if (mdns_readname(pkt->pbuf, ans->rd_offset, &target) == MDNS_READNAME_ERROR ||
+        target.length > MDNS_RECORD_NAME_MAXLEN) {
+      return;
+    }
+    /* Skip our own instances */
+    mdns_update_cache(pkt->netif);
+    for (i = 0; i < MDNS_MAX_SERVICES; i++) {
+      if (mdns->services[i] && mdns_domain_eq(&target, &mdns->services[i]->instance_domain)) {
+        return;
+      }
+    }
+    record = mdns_record_find(pkt->netif, DNS_RRTYPE_PTR, browse->type, browse->type_length,
+                              target.name, (u8_t)target.length);
+    if (record == NULL) {
+      if (ans->ttl == 0) {
+        return;
+      }
+      record = mdns_record_alloc(now);
+      if (record == NULL) {
+        return;
+      }
+      record->netif = pkt->netif;
+      record->type = DNS_RRTYPE_PTR;
+      MEMCPY(record->name, browse->type, browse->type_length);
+      record->name_length = browse->type_length;
+      MEMCPY(record->data.target, target.name, target.length);
+      record->target_length = (u8_t)target.length;
+    }
+  } else {
+    if (ans->info.type != DNS_RRTYPE_SRV && ans->info.type != DNS_RRTYPE_A && ans->info.type != DNS_RRTYPE_AAAA) {
+      return;
+    }
+    for (i = 0; i < MDNS_RECORD_CACHE_ENTRIES; i++) {
+      if (mdns_records[i].state != RECORD_FREE && mdns_records[i].netif == pkt->netif &&
+          mdns_records[i].type == ans->info.type &&
+          mdns_name_eq_encoded(&ans->info.name, mdns_records[i].name, mdns_records[i].name_length)) {
+        record = &mdns_records[i];
+        break;
+      }
+    }
+    if (record == NULL) {
+      return;
+    }
+
+    if (ans->info.type == DNS_RRTYPE_SRV) {
+      /* Priority, weight and port, then the host name */
+      if (ans->rd_length < 7 ||
+          pbuf_copy_partial(pkt->pbuf, &field16, sizeof(field16), (u16_t)(ans->rd_offset + 4)) != sizeof(field16) ||
+          mdns_readname(pkt->pbuf, (u16_t)(ans->rd_offset + 6), &target) == MDNS_READNAME_ERROR ||
+          target.length > MDNS_RECORD_NAME_MAXLEN) {
+        return;
+      }
+      record->port = lwip_ntohs(field16);
+      MEMCPY(record->data.target, target.name, target.length);
+      record->target_length = (u8_t)target.length;
+#if LWIP_IPV4
+    } else if (ans->info.type == DNS_RRTYPE_A) {
+      ip4_addr_t addr4;
+      if (ans->rd_length != sizeof(addr4) ||
+          pbuf_copy_partial(pkt->pbuf, &addr4, sizeof(addr4), ans->rd_offset) != sizeof(addr4)) {
+        return;
+      }
+      ip_addr_copy_from_ip4(record->data.addr, addr4);
+#endif
+#if LWIP_IPV6
+    } else if (ans->info.type == DNS_RRTYPE_AAAA) {
+      u32_t words[4];
+      if (ans->rd_length != sizeof(words) ||
+          pbuf_copy_partial(pkt->pbuf, words, sizeof(words), ans->rd_offset) != sizeof(words)) {
+        return;
+      }
+      IP_ADDR6(&record->data.addr, words[0], words[1], words[2], words[3]);
+      ip6_addr_assign_zone(ip_2_ip6(&record->data.addr), IP6_UNICAST, pkt->netif);
+#endif
+    } else {
+      return;
+    }
+  }
+
+  LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Caching answer, type %d\n", ans->info.type));
+  record->state = RECORD_VALID;
+  record->time = now;
+  record->used = 0;
+  if (ans->ttl == 0) {
+    record->ttl_ms = RECORD_GOODBYE_MS;
+    record->queries = RECORD_REFRESH_QUERIES;
+    return;
+  }
+  record->ttl_ms = LWIP_MIN(ans->ttl, RECORD_MAX_TTL) * 1000;
+  record->queries = 0;
 
-    res = mdns_read_answer(pkt, &ans);
-    if (res != ERR_OK) {
-      LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Failed to parse answer, skipping query packet\n"));
-      goto cleanup;
-    }
+  /* Ask for the location of an instance, and the address of its host.
+   * The record may be dropped for them when the cache is full. */
+  if (record->type == DNS_RRTYPE_PTR) {
+    mdns_record_want(pkt->netif, DNS_RRTYPE_SRV, target.name, (u8_t)target.length, now);
+  } else if (record->type == DNS_RRTYPE_SRV) {
+    mdns_record_want(pkt->netif, mdns_record_addr_type(pkt->netif), target.name, (u8_t)target.length, now);
+  }
+}
 
-    LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Known answer for domain "));
-    mdns_domain_debug_print(&ans.info.domain);
-    LWIP_DEBUGF(MDNS_DEBUG, (" type %d class %d\n", ans.info.type, ans.info.klass));
+/**
+ * Tell the browses of a netif about the instances resolved so far
+ */
+static void
+mdns_browse_report(struct netif *netif)
+{
+  int i;
 
+  for (i = 0; i < MDNS_RECORD_CACHE_ENTRIES; i++) {
+    struct mdns_record *record = &mdns_records[i];
+    struct mdns_browse *browse;
+    char instance[MDNS_LABEL_MAXLEN + 1];
+    ip_addr_t addr;
+    u16_t port;
 
-    if (ans.info.type == DNS_RRTYPE_ANY || ans.info.klass == DNS_RRCLASS_ANY) {
-      /* Skip known answers for ANY type & class */
+    if (record->state != RECORD_VALID || record->netif != netif || record->type != DNS_RRTYPE_PTR ||
+        record->reported || record->ttl_ms == RECORD_GOODBYE_MS) {
       continue;
     }
-
-    rev_v6 = 0;
-    match = reply.host_replies & check_host(pkt->netif, &ans.info, &rev_v6);
-    if (match && (ans.ttl > (mdns->dns_ttl / 2))) {
-      /* The RR in the known answer matches an RR we are planning to send,
-       * and the TTL is less than half gone.
-       * If the payload matches we should not send that answer.
-       */
-      if (ans.info.type == DNS_RRTYPE_PTR) {
-        /* Read domain and compare */
-        struct mdns_domain known_ans, my_ans;
-        u16_t len;
-        len = mdns_readname(pkt->pbuf, ans.rd_offset, &known_ans);
-        res = mdns_build_host_domain(&my_ans, mdns);
-        if (len != MDNS_READNAME_ERROR && res == ERR_OK && mdns_domain_eq(&known_ans, &my_ans)) {
-#if LWIP_IPV4
-          if (match & REPLY_HOST_PTR_V4) {
-            LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Skipping known answer: v4 PTR\n"));
-            reply.host_replies &= ~REPLY_HOST_PTR_V4;
-          }
-#endif
-#if LWIP_IPV6
-          if (match & REPLY_HOST_PTR_V6) {
-            LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Skipping known answer: v6 PTR\n"));
-            reply.host_reverse_v6_replies &= ~rev_v6;
-            if (reply.host_reverse_v6_replies == 0) {
-              reply.host_replies &= ~REPLY_HOST_PTR_V6;
-            }
-          }
-#endif
-        }
-      } else if (match & REPLY_HOST_A) {
-#if LWIP_IPV4
-        if (ans.rd_length == sizeof(ip4_addr_t) &&
-            pbuf_memcmp(pkt->pbuf, ans.rd_offset, netif_ip4_addr(pkt->netif), ans.rd_length) == 0) {
-          LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Skipping known answer: A\n"));
-          reply.host_replies &= ~REPLY_HOST_A;
-        }
-#endif
-      } else if (match & REPLY_HOST_AAAA) {
-#if LWIP_IPV6
-        if (ans.rd_length == sizeof(ip6_addr_p_t) &&
-            /* TODO this clears all AAAA responses if first addr is set as known */
-            pbuf_memcmp(pkt->pbuf, ans.rd_offset, netif_ip6_addr(pkt->netif, 0), ans.rd_length) == 0) {
-          LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Skipping known answer: AAAA\n"));
-          reply.host_replies &= ~REPLY_HOST_AAAA;
-        }
-#endif
-      }
-    }
-
-    for (i = 0; i < MDNS_MAX_SERVICES; i++) {
-      service = mdns->services[i];
-      if (!service) {
-        continue;
-      }
-      match = reply.serv_replies[i] & check_service(service, &ans.info);
-      if (match && (ans.ttl > (service->dns_ttl / 2))) {
-        /* The RR in the known answer matches an RR we are planning to send,
-         * and the TTL is less than half gone.
-         * If the payload matches we should not send that answer.
-         */
-        if (ans.info.type == DNS_RRTYPE_PTR) {
-          /* Read domain and compare */
-          struct mdns_domain known_ans, my_ans;
-          u16_t len;
-          len = mdns_readname(pkt->pbuf, ans.rd_offset, &known_ans);
-          if (len != MDNS_READNAME_ERROR) {
-            if (match & REPLY_SERVICE_TYPE_PTR) {
-              res = mdns_build_service_domain(&my_ans, service, 0);
-              if (res == ERR_OK && mdns_domain_eq(&known_ans, &my_ans)) {
-                LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Skipping known answer: service type PTR\n"));
-                reply.serv_replies[i] &= ~REPLY_SERVICE_TYPE_PTR;
-              }
-            }
-            if (match & REPLY_SERVICE_NAME_PTR) {
-              res = mdns_build_service_domain(&my_ans, service, 1);
-              if (res == ERR_OK && mdns_domain_eq(&known_ans, &my_ans)) {
-                LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Skipping known answer: service name PTR\n"));
-                reply.serv_replies[i] &= ~REPLY_SERVICE_NAME_PTR;
-              }
-            }
-          }
-        } else if (match & REPLY_SERVICE_SRV) {
-          /* Read and compare to my SRV record */
-          u16_t field16, len, read_pos;
-          struct mdns_domain known_ans, my_ans;
-          read_pos = ans.rd_offset;
-          do {
-            /* Check priority field */
-            len = pbuf_copy_partial(pkt->pbuf, &field16, sizeof(field16), read_pos);
-            if (len != sizeof(field16) || lwip_ntohs(field16) != SRV_PRIORITY) {
-              break;
-            }
-            read_pos += len;
-            /* Check weight field */
-            len = pbuf_copy_partial(pkt->pbuf, &field16, sizeof(field16), read_pos);
-            if (len != sizeof(field16) || lwip_ntohs(field16) != SRV_WEIGHT) {
-              break;
-            }
-            read_pos += len;
-            /* Check port field */
-            len = pbuf_copy_partial(pkt->pbuf, &field16, sizeof(field16), read_pos);
-            if (len != sizeof(field16) || lwip_ntohs(field16) != service->port) {
-              break;
-            }
-            read_pos += len;
-            /* Check host field */
-            len = mdns_readname(pkt->pbuf, read_pos, &known_ans);
-            mdns_build_host_domain(&my_ans, mdns);
-            if (len == MDNS_READNAME_ERROR || !mdns_domain_eq(&known_ans, &my_ans)) {
-              break;
-            }
-            LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Skipping known answer: SRV\n"));
-            reply.serv_replies[i] &= ~REPLY_SERVICE_SRV;
-          } while (0);
-        } else if (match & REPLY_SERVICE_TXT) {
-          mdns_prepare_txtdata(service);
-          if (service->txtdata.length == ans.rd_length &&
-              pbuf_memcmp(pkt->pbuf, ans.rd_offset, service->txtdata.name, ans.rd_length) == 0) {
-            LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Skipping known answer: TXT\n"));
-            reply.serv_replies[i] &= ~REPLY_SERVICE_TXT;
-          }
-        }
-      }
+    browse = mdns_browse_find(netif, record->name, record->name_length);
+    if (browse == NULL ||
+        mdns_record_lookup_service(netif, record->data.target, record->target_length, &addr, &port) != ERR_OK) {
+      continue;
     }
+    record->reported = 1;
+    mdns_record_instance(instance, record);
+    browse->browse_fn(netif, MDNS_BROWSE_RESOLVED, instance, &addr, port, browse->arg);
   }
+}
 
-  mdns_send_outpacket(&reply, DNS_FLAG1_RESPONSE | DNS_FLAG1_AUTHORATIVE);
+/**
+ * Drop the records and browses of a netif
+ */
+static void
+mdns_record_remove_netif(struct netif *netif)
+{
+  int i;
 
-cleanup:
-  if (reply.pbuf) {
-    /* This should only happen if we fail to alloc/write question for legacy query */
-    pbuf_free(reply.pbuf);
-    reply.pbuf = NULL;
+  for (i = 0; i < MDNS_RECORD_CACHE_ENTRIES; i++) {
+    if (mdns_records[i].netif == netif) {
+      mdns_records[i].state = RECORD_FREE;
+    }
+  }
+  for (i = 0; i < MDNS_MAX_BROWSES; i++) {
+    if (mdns_browses[i].netif == netif) {
+      mdns_browses[i].netif = NULL;
+    }
   }
 }
+#endif /* MDNS_RECORD_CACHE_ENTRIES */
 
 /**
  * Handle response MDNS packet
- * Only prints debug for now. Will need more code to do conflict resolution.
+ * Detects conflicts with the names being probed, and caches the answers
+ * wanted by browses and resolves.
  */
 static void
 mdns_handle_response(struct mdns_packet *pkt)
 {
   struct mdns_host* mdns = NETIF_TO_HOST(pkt->netif);
+#if MDNS_RECORD_CACHE_ENTRIES
+  u32_t now = sys_now();
+#endif
 
   /* Ignore all questions */
   while (pkt->questions_left) {
@@ -1808,18 +3220,17 @@ mdns_handle_response(struct mdns_packet *pkt)
     }
 
     LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Answer for domain "));
-    mdns_domain_debug_print(&ans.info.domain);
+    mdns_name_debug_print(&ans.info.name);
     LWIP_DEBUGF(MDNS_DEBUG, (" type %d class %d\n", ans.info.type, ans.info.klass));
 
     /*"Apparently conflicting Multicast DNS responses received *before* the first probe packet is sent MUST
       be silently ignored" so drop answer if we haven't started probing yet*/
     if ((mdns->probing_state == MDNS_PROBING_ONGOING) && (mdns->probes_sent > 0)) {
-      struct mdns_domain domain;
       u8_t i;
       u8_t conflict = 0;
 
-      res = mdns_build_host_domain(&domain, mdns);
-      if (res == ERR_OK && mdns_domain_eq(&ans.info.domain, &domain)) {
+      mdns_update_cache(pkt->netif);
+      if (mdns_name_eq(&ans.info.name, &mdns->host_domain)) {
         LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Probe response matches host domain!"));
         conflict = 1;
       }
@@ -1829,8 +3240,7 @@ mdns_handle_response(struct mdns_packet *pkt)
         if (!service) {
           continue;
         }
-        res = mdns_build_service_domain(&domain, service, 1);
-        if ((res == ERR_OK) && mdns_domain_eq(&ans.info.domain, &domain)) {
+        if (mdns_name_eq(&ans.info.name, &service->instance_domain)) {
           LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Probe response matches service domain!"));
           conflict = 1;
         }
@@ -1843,7 +3253,19 @@ mdns_handle_response(struct mdns_packet *pkt)
         }
       }
     }
+
+#if MDNS_RECORD_CACHE_ENTRIES
+    /* Cache the answers of responders, not of legacy unicast resolvers
+     * (RFC 6762, section 6.7) */
+    if (pkt->source_port == LWIP_IANA_PORT_MDNS) {
+      mdns_record_answer(pkt, &ans, now);
+    }
+#endif
   }
+
+#if MDNS_RECORD_CACHE_ENTRIES
+  mdns_browse_report(pkt->netif);
+#endif
 }
 
 /**
@@ -1888,6 +3310,8 @@ mdns_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr,
   packet.tx_id = lwip_ntohs(hdr.id);
   packet.questions = packet.questions_left = lwip_ntohs(hdr.numquestions);
   packet.answers = packet.answers_left = lwip_ntohs(hdr.numanswers) + lwip_ntohs(hdr.numauthrr) + lwip_ntohs(hdr.numextrarr);
+  packet.known_answers = lwip_ntohs(hdr.numanswers);
+  packet.authoritative = lwip_ntohs(hdr.numauthrr);
 
 #if LWIP_IPV6
   if (IP_IS_V6(ip_current_dest_addr())) {
@@ -1950,18 +3374,17 @@ mdns_send_probe(struct netif* netif, const ip_addr_t *destination)
 {
   struct mdns_host* mdns;
   struct mdns_outpacket pkt;
-  struct mdns_domain domain;
   u8_t i;
   err_t res;
 
   mdns = NETIF_TO_HOST(netif);
+  mdns_update_cache(netif);
 
   memset(&pkt, 0, sizeof(pkt));
   pkt.netif = netif;
 
   /* Add unicast questions with rtype ANY for all our desired records */
-  mdns_build_host_domain(&domain, mdns);
-  res = mdns_add_question(&pkt, &domain, DNS_RRTYPE_ANY, DNS_RRCLASS_IN, 1);
+  res = mdns_add_question(&pkt, &mdns->host_domain, DNS_RRTYPE_ANY, DNS_RRCLASS_IN, 1);
   if (res != ERR_OK) {
     goto cleanup;
   }
@@ -1971,8 +3394,7 @@ mdns_send_probe(struct netif* netif, const ip_addr_t *destination)
     if (!service) {
       continue;
     }
-    mdns_build_service_domain(&domain, service, 1);
-    res = mdns_add_question(&pkt, &domain, DNS_RRTYPE_ANY, DNS_RRCLASS_IN, 1);
+    res = mdns_add_question(&pkt, &service->instance_domain, DNS_RRTYPE_ANY, DNS_RRCLASS_IN, 1);
     if (res != ERR_OK) {
       goto cleanup;
     }
@@ -2073,6 +3495,9 @@ mdns_resp_add_netif(struct netif *netif, const char *hostname, u32_t dns_ttl)
   mdns->dns_ttl = dns_ttl;
   mdns->probes_sent = 0;
   mdns->probing_state = MDNS_PROBING_NOT_STARTED;
+#if MDNS_MULTICAST_INTERVAL_MS
+  mdns_multicast_reset(&mdns->multicast_time[0][0], MULTICAST_IP_VERSIONS * MULTICAST_HOST_ANSWERS);
+#endif
 
   /* Join multicast groups */
 #if LWIP_IPV4
@@ -2135,6 +3560,10 @@ mdns_resp_remove_netif(struct netif *netif)
     mld6_leavegroup_netif(netif, ip_2_ip6(&v6group));
 #endif
 
+#if MDNS_RECORD_CACHE_ENTRIES
+  mdns_record_remove_netif(netif);
+#endif
+
   mem_free(mdns);
   netif_set_client_data(netif, mdns_netif_client_id, NULL);
   return ERR_OK;
@@ -2220,6 +3649,9 @@ mdns_resp_add_service(struct netif *netif, const char *name, const char *service
   srv->proto = (u16_t)proto;
   srv->port = port;
   srv->dns_ttl = dns_ttl;
+#if MDNS_MULTICAST_INTERVAL_MS
+  mdns_multicast_reset(&srv->multicast_time[0][0], MULTICAST_IP_VERSIONS * MULTICAST_SERVICE_ANSWERS);
+#endif
 
   mdns->services[slot] = srv;
 
@@ -2250,6 +3682,8 @@ mdns_resp_del_service(struct netif *netif, s8_t slot)
   srv = mdns->services[slot];
   mdns->services[slot] = NULL;
   mem_free(srv);
+  /* Drop the cached replies that hold the service */
+  mdns->cache_valid = 0;
   return ERR_OK;
 }
 
@@ -2328,6 +3762,9 @@ mdns_resp_announce(struct netif *netif)
     return;
   }
 
+  /* Called when the netif settings changed: build the cache again */
+  mdns->cache_valid = 0;
+
   if (mdns->probing_state == MDNS_PROBING_COMPLETE) {
     /* Announce on IPv6 and IPv4 */
 #if LWIP_IPV6
@@ -2341,6 +3778,218 @@ mdns_resp_announce(struct netif *netif)
   } /* else: ip address changed while probing was ongoing? @todo reset counter to restart? */
 }
 
+/**
+ * @ingroup mdns
+ * Get the counters of the responder on a network interface: the replies sent
+ * to queries, and the answers left out of them because the querier listed
+ * them as known answers or because they were multicast less than
+ * MDNS_MULTICAST_INTERVAL_MS before.
+ * @param netif The network interface
+ * @param stats Where to copy the counters
+ * @return ERR_OK if the counters were copied, an err_t otherwise
+ */
+err_t
+mdns_resp_get_stats(struct netif *netif, struct mdns_resp_stats *stats)
+{
+  struct mdns_host *mdns;
+
+  ERR_INFO_MDNS((NULL == netif), "mdns_resp_get_stats: netif != NULL\n", ERR_VAL);
+  ERR_INFO_MDNS((NULL == stats), "mdns_resp_get_stats: stats != NULL\n", ERR_VAL);
+  mdns = NETIF_TO_HOST(netif);
+  ERR_INFO_MDNS((NULL == mdns), "mdns_resp_get_stats: Not an mdns netif\n", ERR_VAL);
+
+  SMEMCPY(stats, &mdns->stats, sizeof(struct mdns_resp_stats));
+  return ERR_OK;
+}
+
+#if MDNS_RECORD_CACHE_ENTRIES
+/**
+ * Build the encoded name of a service type or instance: [name.]service.proto.local
+ * @return ERR_OK, or ERR_VAL if a label or the name is too long to cache
+ */
+static err_t
+mdns_record_build_service(struct mdns_domain *domain, const char *name, const char *service, enum mdns_sd_proto proto)
+{
+  err_t res;
+
+  memset(domain, 0, sizeof(struct mdns_domain));
+  if (name) {
+    ERR_INFO_MDNS((strlen(name) > MDNS_LABEL_MAXLEN), "mdns_record_build_service: Name too long\n", ERR_VAL);
+    res = mdns_domain_add_label(domain, name, (u8_t)strlen(name));
+    ERR_INFO_MDNS((ERR_OK != res), "mdns_record_build_service: Failed to add label\n", res);
+  }
+  ERR_INFO_MDNS((strlen(service) > MDNS_LABEL_MAXLEN), "mdns_record_build_service: Service too long\n", ERR_VAL);
+  res = mdns_domain_add_label(domain, service, (u8_t)strlen(service));
+  ERR_INFO_MDNS((ERR_OK != res), "mdns_record_build_service: Failed to add label\n", res);
+  res = mdns_domain_add_label(domain, dnssd_protos[proto], (u8_t)strlen(dnssd_protos[proto]));
+  ERR_INFO_MDNS((ERR_OK != res), "mdns_record_build_service: Failed to add label\n", res);
+  res = mdns_add_dotlocal(domain);
+  ERR_INFO_MDNS((ERR_OK != res), "mdns_record_build_service: Failed to add label\n", res);
+  ERR_INFO_MDNS((domain->length > MDNS_RECORD_NAME_MAXLEN), "mdns_record_build_service: Name too long (increase MDNS_RECORD_NAME_MAXLEN)\n", ERR_VAL);
+  return ERR_OK;
+}
+
+/**
+ * @ingroup mdns
+ * Browse a service type on a network interface: queries are sent after 1, 2,
+ * 4... seconds, up to once an hour, and the instances found are resolved
+ * and reported to browse_fn, see mdns_browse_fn_t. Their address and port
+ * stay in the cache for mdns_resolve_service().
+ * @param netif The network interface to browse on, where mdns_resp_add_netif() was called
+ * @param service The service type, like "_http"
+ * @param proto The service protocol, DNSSD_PROTO_TCP for TCP ("_tcp") and DNSSD_PROTO_UDP
+ *              for others ("_udp")
+ * @param browse_fn Callback function for the instances found and gone
+ * @param arg Argument of browse_fn
+ * @return browse slot number to pass to mdns_browse_stop(), or negative err_t on failure
+ */
+s8_t
+mdns_browse_start(struct netif *netif, const char *service, enum mdns_sd_proto proto, mdns_browse_fn_t browse_fn, void *arg)
+{
+  struct mdns_browse *browse;
+  struct mdns_domain domain;
+  s8_t slot = -1;
+  s8_t i;
+  err_t res;
+
+  LWIP_ASSERT_CORE_LOCKED();
+  ERR_INFO_MDNS((NULL == netif), "mdns_browse_start: netif != NULL\n", ERR_VAL);
+  ERR_INFO_MDNS((NULL == NETIF_TO_HOST(netif)), "mdns_browse_start: Not an mdns netif\n", ERR_VAL);
+  ERR_INFO_MDNS((NULL == service), "mdns_browse_start: service != NULL\n", ERR_VAL);
+  ERR_INFO_MDNS((NULL == browse_fn), "mdns_browse_start: browse_fn != NULL\n", ERR_VAL);
+  ERR_INFO_MDNS(((proto != DNSSD_PROTO_TCP) && (proto != DNSSD_PROTO_UDP)), "mdns_browse_start: Proto not supported\n", ERR_VAL);
+
+  res = mdns_record_build_service(&domain, NULL, service, proto);
+  ERR_INFO_MDNS((ERR_OK != res), "mdns_browse_start: Invalid service type\n", res);
+
+  for (i = 0; i < MDNS_MAX_BROWSES; i++) {
+    if (mdns_browses[i].netif == NULL) {
+      slot = i;
+      break;
+    }
+  }
+  ERR_INFO_MDNS((0 > slot), "mdns_browse_start: Browse list full (increase MDNS_MAX_BROWSES)\n", ERR_MEM);
+
+  browse = &mdns_browses[slot];
+  browse->netif = netif;
+  browse->browse_fn = browse_fn;
+  browse->arg = arg;
+  browse->next_query = sys_now();
+  browse->interval = BROWSE_FIRST_INTERVAL_MS;
+  MEMCPY(browse->type, domain.name, domain.length);
+  browse->type_length = (u8_t)domain.length;
+
+  mdns_record_schedule(RECORD_QUERY_DELAY_MS);
+  return slot;
+}
+
+/**
+ * @ingroup mdns
+ * Stop a browse. The instances found stay cached until they expire.
+ * @param slot The browse slot number returned by mdns_browse_start()
+ * @return ERR_OK if the browse was stopped, an err_t otherwise
+ */
+err_t
+mdns_browse_stop(s8_t slot)
+{
+  LWIP_ASSERT_CORE_LOCKED();
+  ERR_INFO_MDNS((!((slot >= 0) && (slot < MDNS_MAX_BROWSES))), "mdns_browse_stop: Invalid browse ID\n", ERR_VAL);
+  ERR_INFO_MDNS((NULL == mdns_browses[slot].netif), "mdns_browse_stop: Invalid browse ID\n", ERR_VAL);
+
+  mdns_browses[slot].netif = NULL;
+  return ERR_OK;
+}
+
+/**
+ * @ingroup mdns
+ * Resolve &lt;hostname&gt;.local from the record cache. On a miss the address
+ * is asked for, and a later call finds it once a host answered.
+ * @param netif The network interface to resolve on, where mdns_resp_add_netif() was called
+ * @param hostname The host name, without .local
+ * @param addr Set to the address of the host on ERR_OK
+ * @return ERR_OK if the address was cached, ERR_INPROGRESS if it was asked for,
+ *         an err_t otherwise
+ */
+err_t
+mdns_resolve_host(struct netif *netif, const char *hostname, ip_addr_t *addr)
+{
+  struct mdns_domain domain;
+  err_t res;
+
+  LWIP_ASSERT_CORE_LOCKED();
+  ERR_INFO_MDNS((NULL == netif), "mdns_resolve_host: netif != NULL\n", ERR_VAL);
+  ERR_INFO_MDNS((NULL == NETIF_TO_HOST(netif)), "mdns_resolve_host: Not an mdns netif\n", ERR_VAL);
+  ERR_INFO_MDNS((NULL == hostname) || (NULL == addr), "mdns_resolve_host: hostname and addr != NULL\n", ERR_VAL);
+  ERR_INFO_MDNS((strlen(hostname) > MDNS_LABEL_MAXLEN), "mdns_resolve_host: Hostname too long\n", ERR_VAL);
+
+  memset(&domain, 0, sizeof(domain));
+  res = mdns_domain_add_label(&domain, hostname, (u8_t)strlen(hostname));
+  ERR_INFO_MDNS((ERR_OK != res), "mdns_resolve_host: Failed to add label\n", res);
+  res = mdns_add_dotlocal(&domain);
+  ERR_INFO_MDNS((ERR_OK != res), "mdns_resolve_host: Failed to add label\n", res);
+  ERR_INFO_MDNS((domain.length > MDNS_RECORD_NAME_MAXLEN), "mdns_resolve_host: Hostname too long (increase MDNS_RECORD_NAME_MAXLEN)\n", ERR_VAL);
+
+  res = mdns_record_lookup_host(netif, domain.name, (u8_t)domain.length, addr);
+  if (res == ERR_INPROGRESS &&
+      mdns_record_want(netif, mdns_record_addr_type(netif), domain.name, (u8_t)domain.length, sys_now()) == NULL) {
+    res = ERR_MEM;
+  }
+  return res;
+}
+
+/**
+ * @ingroup mdns
+ * Resolve the service instance &lt;name&gt;.&lt;service&gt;.&lt;proto&gt;.local from
+ * the record cache, like an instance reported by mdns_browse_start(). On a
+ * miss its location and address are asked for, and a later call finds them
+ * once the instance answered.
+ * @param netif The network interface to resolve on, where mdns_resp_add_netif() was called
+ * @param name The instance name, like "My printer"
+ * @param service The service type, like "_ipp"
+ * @param proto The service protocol, DNSSD_PROTO_TCP or DNSSD_PROTO_UDP
+ * @param addr Set to the address of the instance on ERR_OK
+ * @param port Set to the port of the instance on ERR_OK
+ * @return ERR_OK if the instance was cached, ERR_INPROGRESS if it was asked for,
+ *         an err_t otherwise
+ */
+err_t
+mdns_resolve_service(struct netif *netif, const char *name, const char *service, enum mdns_sd_proto proto, ip_addr_t *addr, u16_t *port)
+{
+  struct mdns_domain domain;
+  struct mdns_record *srv;
+  u8_t host[MDNS_RECORD_NAME_MAXLEN];
+  u8_t host_length;
+  err_t res;
+
+  LWIP_ASSERT_CORE_LOCKED();
+  ERR_INFO_MDNS((NULL == netif), "mdns_resolve_service: netif != NULL\n", ERR_VAL);
+  ERR_INFO_MDNS((NULL == NETIF_TO_HOST(netif)), "mdns_resolve_service: Not an mdns netif\n", ERR_VAL);
+  ERR_INFO_MDNS((NULL == name) || (NULL == service), "mdns_resolve_service: name and service != NULL\n", ERR_VAL);
+  ERR_INFO_MDNS((NULL == addr) || (NULL == port), "mdns_resolve_service: addr and port != NULL\n", ERR_VAL);
+  ERR_INFO_MDNS(((proto != DNSSD_PROTO_TCP) && (proto != DNSSD_PROTO_UDP)), "mdns_resolve_service: Proto not supported\n", ERR_VAL);
+
+  res = mdns_record_build_service(&domain, name, service, proto);
+  ERR_INFO_MDNS((ERR_OK != res), "mdns_resolve_service: Invalid instance name\n", res);
+
+  res = mdns_record_lookup_service(netif, domain.name, (u8_t)domain.length, addr, port);
+  if (res != ERR_INPROGRESS) {
+    return res;
+  }
+
+  /* Ask for the location, or for the address of the host once it is known */
+  srv = mdns_record_find(netif, DNS_RRTYPE_SRV, domain.name, (u8_t)domain.length, NULL, 0);
+  if (srv == NULL || srv->state != RECORD_VALID) {
+    srv = mdns_record_want(netif, DNS_RRTYPE_SRV, domain.name, (u8_t)domain.length, sys_now());
+  } else {
+    /* The host name is copied, the record may be dropped for the new one */
+    host_length = srv->target_length;
+    MEMCPY(host, srv->data.target, host_length);
+    srv = mdns_record_want(netif, mdns_record_addr_type(netif), host, host_length, sys_now());
+  }
+  return (srv == NULL) ? ERR_MEM : ERR_INPROGRESS;
+}
+#endif /* MDNS_RECORD_CACHE_ENTRIES */
+
 /** Register a callback function that is called if probing is completed successfully
  * or with a conflict. */
 void
@@ -2374,6 +4023,8 @@ mdns_resp_restart(struct netif *netif)
   if (mdns->probing_state == MDNS_PROBING_ONGOING) {
     sys_untimeout(mdns_probe, netif);
   }
+  /* Names of the host or its services may have changed: build the cache again */
+  mdns->cache_valid = 0;
   /* @todo if we've failed 15 times within a 10 second period we MUST wait 5 seconds (or wait 5 seconds every time except first)*/
   mdns->probes_sent = 0;
   mdns->probing_state = MDNS_PROBING_ONGOING;
@@ -2403,6 +4054,9 @@ mdns_resp_init(void)
   LWIP_ASSERT("Failed to bind pcb", res == ERR_OK);
   udp_recv(mdns_pcb, mdns_recv, NULL);
 
+  res = mdns_build_dnssd_domain(&dnssd_domain);
+  LWIP_ASSERT("Failed to build DNS-SD domain", res == ERR_OK);
+
   mdns_netif_client_id = netif_alloc_client_data_id();
 
 #if MDNS_RESP_USENETIF_EXTCALLBACK
@@ -57,6 +57,18 @@ enum mdns_sd_proto {
 
 #define MDNS_LABEL_MAXLEN  63
 
+/* Number of records of other hosts cached for browses and resolves, see
+ * mdns_browse_start() and mdns_resolve_service(). 0 leaves out the cache and
+ * its API, the responder then only answers.
+ */
+#ifndef MDNS_RECORD_CACHE_ENTRIES
+#define MDNS_RECORD_CACHE_ENTRIES 16
+#endif
+
+/** Events passed to a mdns_browse_fn_t */
+#define MDNS_BROWSE_RESOLVED    0
+#define MDNS_BROWSE_GONE        1
+
 struct mdns_host;
 struct mdns_service;
 
@@ -69,6 +81,27 @@ typedef void (*service_get_txt_fn_t)(struct mdns_service *service, void *txt_use
  * if another node is already using it and mdns is disabled on this interface */
 typedef void (*mdns_name_result_cb_t)(struct netif* netif, u8_t result);
 
+#if MDNS_RECORD_CACHE_ENTRIES
+/** Callback function to let application know about the instances of a browsed
+ * service type, see mdns_browse_start(). Called with event MDNS_BROWSE_RESOLVED
+ * once the address and port of a new instance are known, and MDNS_BROWSE_GONE
+ * when an instance reported before expired or said goodbye (addr is then NULL).
+ * instance is the instance name, like "My printer" */
+typedef void (*mdns_browse_fn_t)(struct netif *netif, u8_t event, const char *instance,
+                                 const ip_addr_t *addr, u16_t port, void *arg);
+#endif
+
+/** Counters of the responder on a network interface, see mdns_resp_get_stats() */
+struct mdns_resp_stats {
+  /** Replies sent to queries */
+  u32_t replies;
+  /** Answers left out because the query listed them as known answers */
+  u32_t known_answers_suppressed;
+  /** Multicast answers left out because they were multicast less than
+   *  MDNS_MULTICAST_INTERVAL_MS before */
+  u32_t answers_rate_limited;
+};
+
 void mdns_resp_init(void);
 
 void mdns_resp_register_name_result_cb(mdns_name_result_cb_t cb);
@@ -86,6 +119,16 @@ err_t mdns_resp_add_service_txtitem(struct mdns_service *service, const char *tx
 void mdns_resp_restart(struct netif *netif);
 void mdns_resp_announce(struct netif *netif);
 
+err_t mdns_resp_get_stats(struct netif *netif, struct mdns_resp_stats *stats);
+
+#if MDNS_RECORD_CACHE_ENTRIES
+s8_t  mdns_browse_start(struct netif *netif, const char *service, enum mdns_sd_proto proto, mdns_browse_fn_t browse_fn, void *arg);
+err_t mdns_browse_stop(s8_t slot);
+
+err_t mdns_resolve_host(struct netif *netif, const char *hostname, ip_addr_t *addr);
+err_t mdns_resolve_service(struct netif *netif, const char *name, const char *service, enum mdns_sd_proto proto, ip_addr_t *addr, u16_t *port);
+#endif
+
 /**
  * @ingroup mdns
  * Announce IP settings have changed on netif.
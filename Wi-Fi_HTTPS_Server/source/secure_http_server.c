@@ -46,6 +46,7 @@
 /* FreeRTOS header file */
 #include <FreeRTOS.h>
 #include <task.h>
+#include <semphr.h>
 
 /* Cypress Secure Sockets header file */
 #include "cy_secure_sockets.h"
@@ -57,12 +58,20 @@
 
 /* Standard C header file */
 #include <string.h>
+#include <inttypes.h>
+#include <stdlib.h>
 
 /* HTTPS server task header file. */
 #include "secure_http_server.h"
 #include "cy_http_server.h"
+#include "https_resource_index.h"
 #include "secure_keys.h"
 
+#if(USE_DER_CREDENTIALS)
+/* DER form of the credentials, generated by scripts/pem_to_der.py. */
+#include "secure_keys_der.h"
+#endif
+
 /* MDNS responder header file */
 #include "mdns.h"
 
@@ -72,6 +81,13 @@
 /* Holds the IP address obtained using Wi-Fi Connection Manager (WCM). */
 static cy_wcm_ip_address_t ip_addr;
 
+#if(USE_DER_CREDENTIALS)
+/* TLS credentials of the HTTPS server in DER form. */
+static const uint8_t https_server_cert[] = keySERVER_CERTIFICATE_DER;
+static const uint8_t https_server_key[] = keySERVER_PRIVATE_KEY_DER;
+static const uint8_t https_client_ca_cert[] = keyCLIENT_ROOTCA_DER;
+#endif
+
 /* Secure HTTP server instance. */
 static cy_http_server_t https_server;
 
@@ -92,38 +108,317 @@ static cy_resource_dynamic_data_t https_get_post_resource;
 /* Holds the user data which adds/updates the URL data resources. */
 static cy_resource_dynamic_data_t https_put_resource;
 
+/* Holds the body of an HTTPS PUT request until its resource is registered. */
+typedef struct
+{
+    char body[NEW_RESOURCE_NAME_LENGTH + 1];
+} https_put_request_t;
+
+/* HTTPS PUT request slots. A slot is owned by the thread that took it from a
+ * queue: the HTTPS server thread fills a free slot, and the register task
+ * returns it to the free queue once the resource is registered.
+ */
+static https_put_request_t put_requests[REGISTER_RESOURCE_QUEUE_LENGTH];
+
+/* Queues the free HTTPS PUT request slots. */
+static QueueHandle_t put_request_free_queue_handle;
+
 /* Queues the HTTPS PUT request to register new page resource in the server. */
 static QueueHandle_t register_resource_queue_handle;
 
+/* Counters of the HTTPS PUT requests and of the resources they registered. */
+static uint32_t put_requests_accepted = 0;
+static uint32_t put_requests_rejected = 0;
+static uint32_t resources_created = 0;
+static uint32_t resources_updated = 0;
+static uint32_t resources_failed = 0;
+
 /* Holds the current LED status. */
 static char *led_status = LED_STATUS_OFF;
 
 /* Global variable to track number of resources registered. */
 static uint32_t number_of_resources_registered = 0;
 
-/* Holds all the URL resources along with its data. */
+/* Holds the names and values of the resources added through HTTPS PUT
+ * requests; the root URL is registered separately. The number of resources
+ * follows MAX_NUMBER_OF_HTTP_SERVER_RESOURCES, which is set in the application
+ * Makefile. Refer to README.md for details.
+ */
+static https_resource_index_t resource_index;
+
+/* Serializes the access of the register task and the HTTPS server thread to
+ * the resource index.
+ */
+static SemaphoreHandle_t resource_index_mutex;
+
+/* Holds a client connection of the HTTPS server, identified by its socket. */
 typedef struct
 {
-    char *resource_name;
-    char *value;
-    uint32_t length;
-} https_url_database_t;
-
-/* Initializes the URL database with first entry reserved for HTTPS root URL.
- * The default value of MAX_NUMBER_OF_HTTP_SERVER_RESOURCES is 10 as defined
- * by the HTTPS server middleware. This can be overriden by setting its value
- * in the application Makefile. Refer to README.md for details.
+    cy_socket_t socket;
+    uint32_t requests;
+    TickType_t last_request;
+    bool keep_alive;
+} https_connection_t;
+
+/* Connections of the HTTPS server, one per socket slot. Only the HTTPS server
+ * thread accesses them.
  */
-static https_url_database_t url_resources_db[MAX_NUMBER_OF_HTTP_SERVER_RESOURCES] =
-{
-    /* First entry in the URL database is reserved for HTTPS Root URL. */
-    { (char *)"/", NULL, 0 }
-};
+static https_connection_t https_connections[MAX_SOCKETS];
+
+/* Number of requests and of new connections, each of which needs a TLS
+ * handshake.
+ */
+static uint32_t https_requests_total = 0;
+static uint32_t https_handshakes_total = 0;
 
 /******************************************************************************
 * Function Prototypes
 *******************************************************************************/
 static cy_rslt_t configure_https_server(void);
+static bool https_connection_begin_request(cy_http_response_stream_t *stream);
+static bool https_etag_matches(const char *url_parameters, uint32_t etag);
+static cy_rslt_t write_https_template(cy_http_response_stream_t *stream, const char *template,
+                                      const char *const *fields, uint32_t number_of_fields);
+#if LWIP_MDNS_RESPONDER
+static void mdns_print_stats(void);
+#if MDNS_RECORD_CACHE_ENTRIES
+static void mdns_browse_callback(struct netif *netif, u8_t event, const char *instance,
+                                 const ip_addr_t *addr, u16_t port, void *arg);
+#endif
+#endif
+
+/*******************************************************************************
+ * Function Name: https_connection_begin_request
+ *******************************************************************************
+ * Summary:
+ *  Accounts a request to the connection of its socket and decides whether the
+ *  connection is kept open after the response.
+ *
+ *  A request on a socket without a live connection starts a new connection,
+ *  which needs a TLS handshake. It takes a free socket slot, or the slot of
+ *  the least recently used connection. A connection is live while it is kept
+ *  open and has had a request within HTTPS_KEEP_ALIVE_IDLE_TIMEOUT_MS. The
+ *  connection is kept open until it reaches HTTPS_KEEP_ALIVE_MAX_REQUESTS
+ *  requests, or HTTPS_KEEP_ALIVE_SHARED_MAX_REQUESTS when every slot holds a
+ *  live connection.
+ *
+ *  The HTTPS server library does not report connections to the application;
+ *  a client that reconnects on the same socket within the idle timeout is
+ *  counted as the same connection.
+ *
+ * Parameters:
+ *  stream - Pointer to the HTTPS response stream of the request.
+ *
+ * Return:
+ *  bool: true if the connection is kept open after the response, false if
+ *  it is closed.
+ *
+ *******************************************************************************/
+static bool https_connection_begin_request(cy_http_response_stream_t *stream)
+{
+    https_connection_t *connection = NULL;
+    https_connection_t *least_recent = NULL;
+    TickType_t now = xTaskGetTickCount();
+    uint32_t live_connections = 0;
+    uint32_t max_requests = HTTPS_KEEP_ALIVE_MAX_REQUESTS;
+    uint32_t handshakes_per_100_requests = 0;
+    uint32_t index = 0;
+
+    for (index = 0; index < MAX_SOCKETS; index++)
+    {
+        /* Free the slots of the connections that are closed. */
+        if ((!https_connections[index].keep_alive) ||
+            ((now - https_connections[index].last_request) > pdMS_TO_TICKS(HTTPS_KEEP_ALIVE_IDLE_TIMEOUT_MS)))
+        {
+            https_connections[index].socket = CY_SOCKET_INVALID_HANDLE;
+        }
+
+        if (CY_SOCKET_INVALID_HANDLE == https_connections[index].socket)
+        {
+            least_recent = &https_connections[index];
+        }
+        else if (stream->tcp_stream.socket == https_connections[index].socket)
+        {
+            connection = &https_connections[index];
+        }
+        else if ((NULL == least_recent) ||
+                 ((CY_SOCKET_INVALID_HANDLE != least_recent->socket) &&
+                  ((now - https_connections[index].last_request) > (now - least_recent->last_request))))
+        {
+            least_recent = &https_connections[index];
+        }
+    }
+
+    if (NULL == connection)
+    {
+        connection = least_recent;
+        connection->socket = stream->tcp_stream.socket;
+        connection->requests = 0;
+        https_handshakes_total++;
+    }
+
+    connection->requests++;
+    connection->last_request = now;
+    https_requests_total++;
+
+    for (index = 0; index < MAX_SOCKETS; index++)
+    {
+        if (CY_SOCKET_INVALID_HANDLE != https_connections[index].socket)
+        {
+            live_connections++;
+        }
+    }
+
+    if (live_connections >= MAX_SOCKETS)
+    {
+        max_requests = HTTPS_KEEP_ALIVE_SHARED_MAX_REQUESTS;
+    }
+
+    connection->keep_alive = (HTTPS_KEEP_ALIVE && (connection->requests < max_requests));
+
+    if (connection->keep_alive)
+    {
+        if (CY_RSLT_SUCCESS != cy_http_server_response_stream_enable_keep_alive(stream))
+        {
+            connection->keep_alive = false;
+        }
+    }
+
+    handshakes_per_100_requests = (https_handshakes_total * 100u) / https_requests_total;
+    APP_INFO(("Connection %"PRIu32", request %"PRIu32"%s. TLS handshakes per request: "
+              "%"PRIu32".%02"PRIu32" (%"PRIu32" handshakes, %"PRIu32" requests)\n",
+              (uint32_t)(connection - https_connections), connection->requests,
+              connection->keep_alive ? "" : ", closing after the response",
+              handshakes_per_100_requests / 100u, handshakes_per_100_requests % 100u,
+              https_handshakes_total, https_requests_total));
+
+    return connection->keep_alive;
+}
+
+/*******************************************************************************
+ * Function Name: https_etag_matches
+ *******************************************************************************
+ * Summary:
+ *  Checks whether the query string of a request holds the entity tag of the
+ *  current value of a resource, as in "etag=1a2b3c4d". The HTTPS server
+ *  library does not pass the request headers to the resource handler, so the
+ *  client sends the tag of its copy as a query parameter instead of an
+ *  If-None-Match header.
+ *
+ * Parameters:
+ *  url_parameters - Pointer to the HTTPS URL query string. Can be NULL.
+ *  etag - Entity tag of the current value.
+ *
+ * Return:
+ *  bool: true if the client holds the current value, false otherwise.
+ *
+ *******************************************************************************/
+static bool https_etag_matches(const char *url_parameters, uint32_t etag)
+{
+    const char *parameter = url_parameters;
+    char *end = NULL;
+    size_t key_length = strlen(HTTPS_RESOURCE_ETAG_PARAMETER);
+
+    while ((NULL != parameter) && ('\0' != parameter[0]))
+    {
+        if ((0 == strncmp(parameter, HTTPS_RESOURCE_ETAG_PARAMETER, key_length)) &&
+            ('=' == parameter[key_length]))
+        {
+            parameter += key_length + 1;
+
+            /* Accept the tag with or without the quotes of the ETag header. */
+            if ('"' == parameter[0])
+            {
+                parameter++;
+            }
+
+            return ((uint32_t)strtoul(parameter, &end, 16) == etag) && (end != parameter);
+        }
+
+        parameter = strchr(parameter, '&');
+        if (NULL != parameter)
+        {
+            parameter++;
+        }
+    }
+
+    return false;
+}
+
+/*******************************************************************************
+ * Function Name: write_https_template
+ *******************************************************************************
+ * Summary:
+ *  Sends a page that is stored in flash as a template, in which each "%s"
+ *  marker is replaced with the next field. The static fragments of the
+ *  template are written directly from flash, without copying the page to a
+ *  buffer. The response header carries the exact content length, so that
+ *  only the bytes of the page are sent.
+ *
+ * Parameters:
+ *  stream - Pointer to the HTTPS response stream.
+ *  template - Pointer to the null-terminated page template.
+ *  fields - Pointer to the null-terminated fields, in template order.
+ *  number_of_fields - Number of fields. Markers beyond it are sent empty.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the page was sent, otherwise, it
+ *  returns the error of the HTTPS server library.
+ *
+ *******************************************************************************/
+static cy_rslt_t write_https_template(cy_http_response_stream_t *stream, const char *template,
+                                      const char *const *fields, uint32_t number_of_fields)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    const char *fragment = NULL;
+    const char *marker = NULL;
+    uint32_t content_length = 0;
+    uint32_t field = 0;
+
+    /* Compute the length of the page with the fields filled in. */
+    for (fragment = template; NULL != (marker = strstr(fragment, "%s")); fragment = marker + 2)
+    {
+        content_length += (uint32_t)(marker - fragment);
+
+        if (field < number_of_fields)
+        {
+            content_length += strlen(fields[field]);
+        }
+        field++;
+    }
+    content_length += strlen(fragment);
+
+    result = cy_http_server_response_stream_disable_chunked_transfer(stream);
+
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = cy_http_server_response_stream_write_header(stream, CY_HTTP_200_TYPE, content_length,
+                                                             CY_HTTP_CACHE_DISABLED, CY_HTTP_MIME_TYPE_HTML);
+    }
+
+    /* Send the static fragments and the fields in turn. */
+    field = 0;
+    for (fragment = template; (CY_RSLT_SUCCESS == result) && (NULL != (marker = strstr(fragment, "%s"))); fragment = marker + 2)
+    {
+        if (marker > fragment)
+        {
+            result = cy_http_server_response_stream_write_payload(stream, fragment, (uint32_t)(marker - fragment));
+        }
+
+        if ((CY_RSLT_SUCCESS == result) && (field < number_of_fields) && ('\0' != fields[field][0]))
+        {
+            result = cy_http_server_response_stream_write_payload(stream, fields[field], strlen(fields[field]));
+        }
+        field++;
+    }
+
+    if ((CY_RSLT_SUCCESS == result) && ('\0' != fragment[0]))
+    {
+        result = cy_http_server_response_stream_write_payload(stream, fragment, strlen(fragment));
+    }
+
+    return result;
+}
 
 /*******************************************************************************
  * Function Name: dynamic_resource_handler
@@ -157,13 +452,19 @@ int32_t dynamic_resource_handler(const char* url_path,
     cy_rslt_t result = CY_RSLT_SUCCESS;
     int32_t status = HTTPS_REQUEST_HANDLE_SUCCESS;
     char https_response[MAX_HTTP_RESPONSE_LENGTH] = {0};
-    char *register_new_resource = NULL;
-    static char page_resource_name[NEW_RESOURCE_NAME_LENGTH] = {0};
+    int response_length = 0;
+    https_put_request_t *put_request = NULL;
+    const char *connection = NULL;
+
+    connection = https_connection_begin_request(stream) ? "keep-alive" : "close";
 
     switch (https_message_body->request_type)
     {
         case CY_HTTP_REQUEST_GET:
             APP_INFO(("Received HTTPS GET request.\n"));
+#if LWIP_MDNS_RESPONDER
+            mdns_print_stats();
+#endif
 
             /* Update the current LED status. This status will be sent
              * in response to the POST request.
@@ -177,10 +478,8 @@ int32_t dynamic_resource_handler(const char* url_path,
                 led_status = LED_STATUS_OFF;
             }
 
-            sprintf(https_response, HTTPS_STARTUP_WEBPAGE, led_status);
-
             /* Send the HTTPS response. */
-            result = cy_http_server_response_stream_write_payload(stream, https_response, sizeof(https_response));
+            result = write_https_template(stream, HTTPS_STARTUP_WEBPAGE, (const char *const *)&led_status, 1);
 
             if (CY_RSLT_SUCCESS != result)
             {
@@ -195,14 +494,11 @@ int32_t dynamic_resource_handler(const char* url_path,
              * The user can then send a GET request to get the latest LED status
              * on the webpage.
              */
-            sprintf(https_response, HTTPS_STARTUP_WEBPAGE, led_status);
+            result = write_https_template(stream, HTTPS_STARTUP_WEBPAGE, (const char *const *)&led_status, 1);
 
             /* Toggle the user LED. */
             cyhal_gpio_toggle(CYBSP_USER_LED);
 
-            /* Send the HTTPS response. */
-            result = cy_http_server_response_stream_write_payload(stream, https_response, sizeof(https_response));
-
             if (CY_RSLT_SUCCESS != result)
             {
                 ERR_INFO(("Failed to send the HTTPS POST response.\n"));
@@ -210,37 +506,64 @@ int32_t dynamic_resource_handler(const char* url_path,
             break;
 
         case CY_HTTP_REQUEST_PUT:
-            if (https_message_body->data_length > sizeof(page_resource_name))
+            if (https_message_body->data_length > NEW_RESOURCE_NAME_LENGTH)
             {
                 /* Report the error response to the client. */
-                ERR_INFO(("Resource name length exceeded the limit. Maximum: %d, Received: %d", sizeof(page_resource_name), (https_message_body->data_length)));
-                sprintf(https_response, HTTPS_RESOURCE_PUT_ERROR, sizeof(page_resource_name));
+                ERR_INFO(("Resource name length exceeded the limit. Maximum: %d, Received: %d", NEW_RESOURCE_NAME_LENGTH, (https_message_body->data_length)));
+                response_length = snprintf(https_response, sizeof(https_response), HTTPS_RESOURCE_PUT_ERROR, NEW_RESOURCE_NAME_LENGTH);
 
                 /* Send the HTTPS error response. */
-                result = cy_http_server_response_stream_write_payload(stream, https_response, sizeof(https_response));
+                result = cy_http_server_response_stream_write_payload(stream, https_response, (uint32_t)response_length);
 
                 if (CY_RSLT_SUCCESS != result)
                 {
                     ERR_INFO(("Failed to send the HTTPS PUT error response.\n"));
                 }
             }
-            else
+            else if (0 == https_message_body->data_length)
             {
-                if(https_message_body->data_length == 0)
+                break;
+            }
+            else if (pdTRUE != xQueueReceive(put_request_free_queue_handle, &put_request, 0))
+            {
+                /* Every slot holds a pending request. Ask the client to
+                 * retry rather than dropping the request. The library has no
+                 * status code for 503 and writes no Retry-After header, so
+                 * the header is written here, as for the PUT resources.
+                 */
+                put_requests_rejected++;
+                ERR_INFO(("Too many pending resource registrations. Rejected the HTTPS PUT request.\n"));
+                response_length = snprintf(https_response, sizeof(https_response), HTTPS_RESOURCE_PUT_503_HEADER,
+                                           REGISTER_RESOURCE_RETRY_AFTER_SECONDS,
+                                           (unsigned int)(sizeof(HTTPS_RESOURCE_PUT_BUSY) - 1), connection);
+                memcpy(&https_response[response_length], HTTPS_RESOURCE_PUT_BUSY, sizeof(HTTPS_RESOURCE_PUT_BUSY) - 1);
+                response_length += sizeof(HTTPS_RESOURCE_PUT_BUSY) - 1;
+
+                /* Send the header and the message in one write. */
+                result = cy_http_server_response_stream_disable_chunked_transfer(stream);
+
+                if (CY_RSLT_SUCCESS == result)
                 {
-                    break;
+                    result = cy_http_server_response_stream_write_payload(stream, https_response, (uint32_t)response_length);
                 }
-                register_new_resource = (char *)&page_resource_name[0];
-                memcpy(register_new_resource, (char *)https_message_body->data, https_message_body->data_length);
 
-                /* Received HTTPS PUT request. Put the message into queue
-                 * to register a new resource with the HTTPS server.
-                 */
-                if (pdTRUE != xQueueSend(register_resource_queue_handle, (void *)&register_new_resource, 0))
+                if (CY_RSLT_SUCCESS != result)
                 {
-                    ERR_INFO(("Failed to send queue message.\n"));
+                    ERR_INFO(("Failed to send the HTTPS PUT busy response.\n"));
                 }
             }
+            else
+            {
+                memcpy(put_request->body, (char *)https_message_body->data, https_message_body->data_length);
+                put_request->body[https_message_body->data_length] = '\0';
+
+                /* Received HTTPS PUT request. Pass the slot to the register
+                 * task, which registers the new resource with the HTTPS
+                 * server. The queue has room for every slot.
+                 */
+                (void)xQueueSend(register_resource_queue_handle, &put_request, 0);
+                put_requests_accepted++;
+            }
             break;
 
         default:
@@ -262,7 +585,10 @@ int32_t dynamic_resource_handler(const char* url_path,
  * Summary:
  *  Handles HTTPS GET request for the newly created resource by the client
  *  through HTTPS PUT request. It returns the value registered with the requested
- *  resource.
+ *  resource, with the hash of the value as its entity tag. If the query string
+ *  carries the same tag, it returns 304 (Not Modified) without the value.
+ *  The resource is registered as raw dynamic content, so the response header
+ *  is written here.
  *
  * Parameters:
  *  url_path - Pointer to the HTTPS URL path.
@@ -284,25 +610,65 @@ int32_t https_put_resource_handler(const char *url_path,
 {
     cy_rslt_t result = CY_RSLT_SUCCESS;
     int32_t status = HTTPS_REQUEST_HANDLE_SUCCESS;
-    uint32_t index = 0;
+    char https_response[MAX_HTTPS_RESOURCE_RESPONSE_LENGTH] = {0};
+    char value[NEW_RESOURCE_NAME_LENGTH] = {0};
+    const char *connection = NULL;
+    uint32_t value_length = 0;
+    uint32_t value_hash = 0;
+    int header_length = 0;
+    bool found = false;
 
-    if (CY_HTTP_REQUEST_GET == https_message_body->request_type)
+    connection = https_connection_begin_request(stream) ? "keep-alive" : "close";
+
+    if (CY_HTTP_REQUEST_GET != https_message_body->request_type)
+    {
+        header_length = snprintf(https_response, sizeof(https_response), HTTPS_RESOURCE_405_HEADER, connection);
+    }
+    else
     {
         APP_INFO(("Received HTTPS GET request.\n"));
 
-        while (index < MAX_NUMBER_OF_HTTP_SERVER_RESOURCES)
+        /* Copy the value under the mutex, as the register task may update
+         * or move it while the response is sent.
+         */
+        xSemaphoreTake(resource_index_mutex, portMAX_DELAY);
+        found = https_resource_index_get(&resource_index, (const char *)arg,
+                                         value, sizeof(value), &value_length, &value_hash);
+        xSemaphoreGive(resource_index_mutex);
+
+        if (value_length > sizeof(value))
         {
-            if (strcmp(url_resources_db[index].resource_name, (char *)arg) == 0)
-            {
-                result = cy_http_server_response_stream_write_payload(stream,
-                                               url_resources_db[index].value,
-                                             url_resources_db[index].length);
-                break;
-            }
+            value_length = sizeof(value);
+        }
 
-            /* Get next entry. */
-            index++;
+        if (!found)
+        {
+            value_length = 0;
+            header_length = snprintf(https_response, sizeof(https_response), HTTPS_RESOURCE_404_HEADER, connection);
         }
+        else if (https_etag_matches(url_parameters, value_hash))
+        {
+            /* The client holds the current value; send the header only. */
+            APP_INFO(("Resource not modified: %s\n", (const char *)arg));
+            value_length = 0;
+            header_length = snprintf(https_response, sizeof(https_response), HTTPS_RESOURCE_304_HEADER,
+                                     value_hash, connection);
+        }
+        else
+        {
+            header_length = snprintf(https_response, sizeof(https_response), HTTPS_RESOURCE_200_HEADER,
+                                     value_length, value_hash, connection);
+            memcpy(&https_response[header_length], value, value_length);
+        }
+    }
+
+    /* Send the header and the value in one write. */
+    result = cy_http_server_response_stream_disable_chunked_transfer(stream);
+
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = cy_http_server_response_stream_write_payload(stream, https_response,
+                                                              (uint32_t)header_length + value_length);
     }
 
     if (CY_RSLT_SUCCESS != result)
@@ -315,99 +681,120 @@ int32_t https_put_resource_handler(const char *url_path,
 }
 
 /*******************************************************************************
- * Function Name: register_https_resource
+ * Function Name: register_https_resources
  *******************************************************************************
  * Summary:
- *  Registers/Updates the new resource with the HTTPS server when HTTPS PUT
- *  request is received from the client.
+ *  Registers/Updates a batch of new resources with the HTTPS server when HTTPS
+ *  PUT requests are received from the client. The resource index is locked
+ *  once for the whole batch.
  *
  * Parameters:
- *  register_resource_name: Pointer to the resource name to be registered
- *   with the HTTPS server.
+ *  put_requests: Pointers to the HTTPS PUT requests, each holding
+ *   "<resource name>=<value>".
+ *  number_of_requests: Number of requests, up to REGISTER_RESOURCE_BATCH_SIZE.
  *
  * Return:
  *  None
  *
  *******************************************************************************/
-void register_https_resource(char *register_resource_name)
+void register_https_resources(https_put_request_t *put_requests[], uint32_t number_of_requests)
 {
     cy_rslt_t result = CY_RSLT_SUCCESS;
+    https_resource_index_result_t index_results[REGISTER_RESOURCE_BATCH_SIZE];
+    const char *stored_names[REGISTER_RESOURCE_BATCH_SIZE];
+    char *register_resource_name = NULL;
     char *url_resource_data = NULL;
     uint32_t index = 0;
 
-    APP_INFO(("New resource to create: %s\n", register_resource_name));
-
     /* Configure dynamic resource handler. */
     https_put_resource.resource_handler = https_put_resource_handler;
     https_put_resource.arg = NULL;
 
-    /* Split the URL resource name and data from the HTTPS PUT request. */
-    url_resource_data = strtok(register_resource_name, "=");
-    url_resource_data = strtok(NULL, "=");
-    APP_INFO(("New URL: %s, Response text: %s\n", register_resource_name, url_resource_data));
-
-    /* Register the resource if it does not exist in the URL database or
-     * update the resource data if the requested resource already
-     * exists in the URL database.
+    /* Add each resource to the index if it does not exist or update the
+     * resource data if the requested resource already exists.
      */
-    while (index < MAX_NUMBER_OF_HTTP_SERVER_RESOURCES)
-    {
-        if ((NULL != url_resources_db[index].resource_name) &&
-             strcmp(url_resources_db[index].resource_name, register_resource_name) == 0)
-        {
-            APP_INFO(("Updating the existing resource: %s\n\n", register_resource_name));
-            url_resources_db[index].length = strlen(url_resource_data);
-            url_resources_db[index].value = (char *)realloc(url_resources_db[index].value, (url_resources_db[index].length + 1));
-            memset(url_resources_db[index].value, 0, (url_resources_db[index].length + 1));
-            memcpy(url_resources_db[index].value, url_resource_data, url_resources_db[index].length);
-            https_put_resource.arg = url_resources_db[index].resource_name;
-            break;
-        }
-        else if (NULL == url_resources_db[index].resource_name)
-        {
-            APP_INFO(("Registering the new resource: %s\n\n", register_resource_name));
-            url_resources_db[index].value = (char *)calloc(strlen(url_resource_data), sizeof(char));
-            url_resources_db[index].resource_name = (char *)calloc(strlen(register_resource_name), sizeof(char));
+    xSemaphoreTake(resource_index_mutex, portMAX_DELAY);
 
-            if ((NULL == url_resources_db[index].resource_name) ||
-                (NULL == url_resources_db[index].value))
-            {
-                ERR_INFO(("Failed to allocate memory for URL resources.\n"));
-                CY_ASSERT(0);
-            }
+    for (index = 0; index < number_of_requests; index++)
+    {
+        /* Split the URL resource name and data from the HTTPS PUT request. */
+        register_resource_name = strtok(put_requests[index]->body, "=");
+        url_resource_data = strtok(NULL, "=");
+        stored_names[index] = NULL;
 
-            /* Add the resource name, data, and data length into URL database. */
-            url_resources_db[index].length = strlen(url_resource_data);
-            memcpy(url_resources_db[index].resource_name, register_resource_name,
-                                                 strlen(register_resource_name));
-            memcpy(url_resources_db[index].value, url_resource_data,
-                                                 url_resources_db[index].length);
-            https_put_resource.arg = url_resources_db[index].resource_name;
-
-            /* Register the new/updated resource with HTTPS server. */
-            result = cy_http_server_register_resource(https_server,
-                                                      (uint8_t*)url_resources_db[index].resource_name,
-                                                      (uint8_t*)"text/html",
-                                                      CY_DYNAMIC_URL_CONTENT,
-                                                      &https_put_resource);
-            PRINT_AND_ASSERT(result, "Failed to register a new resource.\n");
-
-            /* Update the resource count. */
-            number_of_resources_registered++;
-            break;
+        if ((NULL == register_resource_name) || (NULL == url_resource_data))
+        {
+            index_results[index] = HTTPS_RESOURCE_INDEX_BAD_ARG;
         }
         else
         {
-            /* Get next resource. */
-            index++;
+            index_results[index] = https_resource_index_put(&resource_index, register_resource_name,
+                                                            url_resource_data, strlen(url_resource_data),
+                                                            &stored_names[index]);
         }
     }
 
-    if (index >= MAX_NUMBER_OF_HTTP_SERVER_RESOURCES)
+    xSemaphoreGive(resource_index_mutex);
+
+    for (index = 0; index < number_of_requests; index++)
     {
-        ERR_INFO(("Requested resource not registered/updated. Reached Maximum "
-                  "allowed number of resource registration: %d\n", MAX_NUMBER_OF_HTTP_SERVER_RESOURCES));
+        register_resource_name = put_requests[index]->body;
+
+        switch (index_results[index])
+        {
+            case HTTPS_RESOURCE_INDEX_UPDATED:
+                APP_INFO(("Updated the existing resource: %s\n", register_resource_name));
+                resources_updated++;
+                break;
+
+            case HTTPS_RESOURCE_INDEX_CREATED:
+                APP_INFO(("Registering the new resource: %s\n", register_resource_name));
+
+                /* The HTTP server library keeps the name, which is stored by
+                 * the index and never moves.
+                 */
+                https_put_resource.arg = (void *)stored_names[index];
+
+                /* Register the new resource with HTTPS server. */
+                result = cy_http_server_register_resource(https_server,
+                                                          (uint8_t*)stored_names[index],
+                                                          (uint8_t*)"text/html",
+                                                          CY_RAW_DYNAMIC_URL_CONTENT,
+                                                          &https_put_resource);
+                PRINT_AND_ASSERT(result, "Failed to register a new resource.\n");
+
+                /* Update the resource count. */
+                number_of_resources_registered++;
+                resources_created++;
+                break;
+
+            case HTTPS_RESOURCE_INDEX_FULL:
+                ERR_INFO(("Requested resource %s not registered. Reached Maximum "
+                          "allowed number of resource registration: %d\n",
+                          register_resource_name, MAX_NUMBER_OF_HTTP_SERVER_RESOURCES));
+                resources_failed++;
+                break;
+
+            case HTTPS_RESOURCE_INDEX_NO_SPACE:
+                ERR_INFO(("Requested resource %s not registered/updated. Not enough "
+                          "space left for the resource data.\n", register_resource_name));
+                resources_failed++;
+                break;
+
+            default:
+                ERR_INFO(("Invalid resource: %s. Expected <resource name>=<value>.\n", register_resource_name));
+                resources_failed++;
+                break;
+        }
     }
+
+    APP_INFO(("Registered a batch of %"PRIu32" resources. PUT requests accepted: %"PRIu32", "
+              "rejected: %"PRIu32". Resources created: %"PRIu32", updated: %"PRIu32", "
+              "failed: %"PRIu32"\n", number_of_requests, put_requests_accepted,
+              put_requests_rejected, resources_created, resources_updated, resources_failed));
+    APP_INFO(("Resources registered: %"PRIu32", free resource space: %"PRIu32" bytes, "
+              "compactions: %"PRIu32"\n\n", number_of_resources_registered,
+              https_resource_index_free_space(&resource_index), resource_index.compactions));
 }
 
 /*******************************************************************************
@@ -439,12 +826,21 @@ static cy_rslt_t configure_https_server(void)
      * To make the browser trust the connection with this HTTP server, user
      * needs to load the server certificate into the browser.
      */
+#if(USE_DER_CREDENTIALS)
+    security_config.certificate                = (uint8_t *)https_server_cert;
+    security_config.certificate_length         = keySERVER_CERTIFICATE_DER_LEN;
+    security_config.private_key                = (uint8_t *)https_server_key;
+    security_config.key_length                 = keySERVER_PRIVATE_KEY_DER_LEN;
+    security_config.root_ca_certificate        = (uint8_t *)https_client_ca_cert;
+    security_config.root_ca_certificate_length = keyCLIENT_ROOTCA_DER_LEN;
+#else
     security_config.certificate                = (uint8_t *)keySERVER_CERTIFICATE_PEM;
     security_config.certificate_length         = strlen(keySERVER_CERTIFICATE_PEM);
     security_config.private_key                = (uint8_t *)keySERVER_PRIVATE_KEY_PEM;
     security_config.key_length                 = strlen(keySERVER_PRIVATE_KEY_PEM);
     security_config.root_ca_certificate        = (uint8_t *)keyCLIENT_ROOTCA_PEM;
     security_config.root_ca_certificate_length = strlen(keyCLIENT_ROOTCA_PEM);
+#endif /* USE_DER_CREDENTIALS */
 
     /* IP address of server. */
     https_ip_address.ip_address.ip.v4 = ip_addr.ip.v4;
@@ -457,6 +853,16 @@ static cy_rslt_t configure_https_server(void)
     /* Initialize secure socket library. */
     result = cy_http_server_network_init();
 
+    /* Initialize the index of the resources added through HTTPS PUT requests. */
+    https_resource_index_init(&resource_index);
+    resource_index_mutex = xSemaphoreCreateMutex();
+
+    if (NULL == resource_index_mutex)
+    {
+        ERR_INFO(("Failed to create the resource index mutex.\n"));
+        CY_ASSERT(0);
+    }
+
     /* Allocate memory needed for secure HTTP server. */
     result = cy_http_server_create(&nw_interface, HTTPS_PORT, MAX_SOCKETS, &security_config, &https_server);
     PRINT_AND_ASSERT(result, "Failed to allocate memory for the HTTPS server.\n");
@@ -498,7 +904,10 @@ static cy_rslt_t configure_https_server(void)
 void https_server_task(void *arg)
 {
     cy_rslt_t result = CY_RSLT_SUCCESS;
-    char *register_new_resource_name = NULL;
+    https_put_request_t *batch[REGISTER_RESOURCE_BATCH_SIZE];
+    https_put_request_t *put_request = NULL;
+    uint32_t batch_size = 0;
+    uint32_t index = 0;
 
     (void)arg;
 
@@ -512,6 +921,26 @@ void https_server_task(void *arg)
     PRINT_AND_ASSERT(result, "Failed to start MDNS responder.\n");
 #endif
 
+    /* These queues pass the HTTPS PUT request slots between the HTTPS server,
+     * which receives the PUT requests sent by the client, and this task,
+     * which registers the new HTTPS page resources. They are created before
+     * the server starts, and the free queue holds every slot at first.
+     */
+    put_request_free_queue_handle = xQueueCreate(REGISTER_RESOURCE_QUEUE_LENGTH, sizeof(https_put_request_t *));
+    register_resource_queue_handle = xQueueCreate(REGISTER_RESOURCE_QUEUE_LENGTH, sizeof(https_put_request_t *));
+
+    if ((NULL == put_request_free_queue_handle) || (NULL == register_resource_queue_handle))
+    {
+        ERR_INFO(("Failed to create the queue.\n"));
+        CY_ASSERT(0);
+    }
+
+    for (index = 0; index < REGISTER_RESOURCE_QUEUE_LENGTH; index++)
+    {
+        put_request = &put_requests[index];
+        (void)xQueueSend(put_request_free_queue_handle, &put_request, 0);
+    }
+
     /* Configure the HTTPS server with all the security parameters and
      * register a default dynamic URL handler.
      */
@@ -522,30 +951,34 @@ void https_server_task(void *arg)
     result = cy_http_server_start(https_server);
     PRINT_AND_ASSERT(result, "Failed to start the HTTPS server.\n");
 
-    /* This queue is used to register a new HTTPS page resource when the HTTPS
-     * server receives a PUT request sent by the client.
-     */
-    register_resource_queue_handle = xQueueCreate(REGISTER_RESOURCE_QUEUE_LENGTH,
-                                                          sizeof(NEW_RESOURCE_NAME_LENGTH));
-
-    if (NULL == register_resource_queue_handle)
-    {
-        ERR_INFO(("Failed to create the queue.\n"));
-        CY_ASSERT(0);
-    }
-
     APP_INFO(("HTTPS server has successfully started. The server is running at "
               "URL https://%s.local:%d\n\n", HTTPS_SERVER_NAME, HTTPS_PORT));
 
-    /* Waits for a HTTPS PUT request from the client to register a new HTTPS page resource.*/
+    /* Waits for a HTTPS PUT request from the client to register a new HTTPS page resource.
+     * The requests that are already queued are registered in the same batch.
+     */
     while(true)
     {
         if (pdTRUE == xQueueReceive(register_resource_queue_handle,
-                                    &register_new_resource_name,
+                                    &put_request,
                                     portMAX_DELAY))
         {
-            APP_INFO(("New resource name register request: %s\n", register_new_resource_name));
-            register_https_resource(register_new_resource_name);
+            batch_size = 0;
+
+            do
+            {
+                APP_INFO(("New resource name register request: %s\n", put_request->body));
+                batch[batch_size++] = put_request;
+            } while ((batch_size < REGISTER_RESOURCE_BATCH_SIZE) &&
+                     (pdTRUE == xQueueReceive(register_resource_queue_handle, &put_request, 0)));
+
+            register_https_resources(batch, batch_size);
+
+            /* Return the slots for the next HTTPS PUT requests. */
+            for (index = 0; index < batch_size; index++)
+            {
+                (void)xQueueSend(put_request_free_queue_handle, &batch[index], 0);
+            }
         }
     }
 }
@@ -581,9 +1014,83 @@ cy_rslt_t mdns_responder_start(void)
         ERR_INFO(("Failed to start the MDNS responder.\n"));
         result = CY_RSLT_TYPE_ERROR;
     }
+#if MDNS_RECORD_CACHE_ENTRIES
+    /* Look for the other HTTPS servers on the LAN. Their addresses stay in
+     * the record cache of the responder, for mdns_resolve_service().
+     */
+    else if (0 > mdns_browse_start(net, MDNS_BROWSE_SERVICE, DNSSD_PROTO_TCP, mdns_browse_callback, NULL))
+    {
+        ERR_INFO(("Failed to browse the %s services.\n", MDNS_BROWSE_SERVICE));
+    }
+#endif
 
     return result;
 }
+
+#if MDNS_RECORD_CACHE_ENTRIES
+/********************************************************************************
+ * Function Name: mdns_browse_callback
+ ********************************************************************************
+ * Summary:
+ *  Prints the HTTPS servers found on the LAN by the mDNS browse, and the ones
+ *  that are gone.
+ *
+ * Parameters:
+ *  struct netif *netif: Network interface of the browse
+ *  u8_t event: MDNS_BROWSE_RESOLVED or MDNS_BROWSE_GONE
+ *  const char *instance: Instance name of the server
+ *  const ip_addr_t *addr: Address of the server, NULL when it is gone
+ *  u16_t port: Port of the server
+ *  void *arg: Unused
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void mdns_browse_callback(struct netif *netif, u8_t event, const char *instance,
+                                 const ip_addr_t *addr, u16_t port, void *arg)
+{
+    (void)netif;
+    (void)arg;
+
+    if (MDNS_BROWSE_RESOLVED == event)
+    {
+        APP_INFO(("Found HTTPS server \"%s\" at %s:%u\n", instance, ipaddr_ntoa(addr), (unsigned int)port));
+    }
+    else
+    {
+        APP_INFO(("HTTPS server \"%s\" is gone\n", instance));
+    }
+}
+#endif
+
+/********************************************************************************
+ * Function Name: mdns_print_stats
+ ********************************************************************************
+ * Summary:
+ *  Prints the counters of the mDNS responder: the replies sent, and the
+ *  answers left out of them because the querier listed them as known answers
+ *  or because they were multicast less than a second before.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void mdns_print_stats(void)
+{
+    struct mdns_resp_stats stats;
+    struct netif *net = cy_network_get_nw_interface(CY_NETWORK_WIFI_STA_INTERFACE, 0);
+
+    if (ERR_OK == mdns_resp_get_stats(net, &stats))
+    {
+        APP_INFO(("mDNS replies: %"PRIu32", known answers suppressed: %"PRIu32", "
+                  "answers rate limited: %"PRIu32"\n",
+                  stats.replies, stats.known_answers_suppressed, stats.answers_rate_limited));
+    }
+}
 #endif /* #if LWIP_MDNS_RESPONDER */
 
 /********************************************************************************
@@ -48,11 +48,48 @@
 /* FreeRTOS header file */
 #include <FreeRTOS.h>
 #include <task.h>
+#include <inttypes.h>
 #include "cy_wcm.h"
 #include "cybsp.h"
 #include "cy_network_mw_core.h"
 #include "cyhal_gpio.h"
 
+/* Embed the certificates and keys of secure_keys.h in DER form, which mbedTLS
+ * parses without Base64 decoding. CREDENTIALS_DER=1 in the Makefile sets it
+ * and generates secure_keys_der.h with scripts/pem_to_der.py before the build.
+ */
+#ifndef USE_DER_CREDENTIALS
+#define USE_DER_CREDENTIALS                      (0)
+#endif
+
+/* Keep the connection open after a response, so that the next requests of
+ * the client skip the TLS handshake. Set to 0 to close the connection after
+ * every response.
+ */
+#ifndef HTTPS_KEEP_ALIVE
+#define HTTPS_KEEP_ALIVE                         (1)
+#endif
+
+/* A connection without a request for this long is counted as closed, and its
+ * socket slot as free. Matches HTTP_SERVER_SOCKET_RECEIVE_TIMEOUT of the
+ * Makefile.
+ */
+#ifndef HTTPS_KEEP_ALIVE_IDLE_TIMEOUT_MS
+#define HTTPS_KEEP_ALIVE_IDLE_TIMEOUT_MS         (5000)
+#endif
+
+/* Requests served on one connection before it is closed. When every socket
+ * holds a live connection, the lower limit applies, so that the sockets
+ * rotate between the clients instead of staying with the first ones.
+ */
+#ifndef HTTPS_KEEP_ALIVE_MAX_REQUESTS
+#define HTTPS_KEEP_ALIVE_MAX_REQUESTS            (100)
+#endif
+
+#ifndef HTTPS_KEEP_ALIVE_SHARED_MAX_REQUESTS
+#define HTTPS_KEEP_ALIVE_SHARED_MAX_REQUESTS     (10)
+#endif
+
 /* Wi-Fi Credentials: Modify WIFI_SSID and WIFI_PASSWORD to match your Wi-Fi network
  * Credentials.
  */
@@ -87,6 +124,10 @@
 
 #define HTTPS_SERVER_NAME                        "mysecurehttpserver"
 #define MDNS_TTL_SECONDS                         (255)
+
+/* Service type browsed with mDNS, to find the other HTTPS servers on the LAN */
+#define MDNS_BROWSE_SERVICE                      "_https"
+
 #define LED_STATUS_ON                            "ON"
 #define LED_STATUS_OFF                           "OFF"
 #define MAX_LED_STATUS_LENGTH                    (3)
@@ -95,9 +136,12 @@
 #define HTTPS_GET_RESPONSE                       "Hello - Message from HTTPS server!"
 #define REGISTER_RESOURCE_TASK_STACK_SIZE        (1024)
 #define REGISTER_RESOURCE_TASK_PRIORITY          (tskIDLE_PRIORITY)
-#define REGISTER_RESOURCE_QUEUE_LENGTH           (1)
+#define REGISTER_RESOURCE_QUEUE_LENGTH           (16)
+#define REGISTER_RESOURCE_BATCH_SIZE             (8)
+#define REGISTER_RESOURCE_RETRY_AFTER_SECONDS    (1)
 #define NEW_RESOURCE_NAME_LENGTH                 (30)
 #define HTTPS_RESOURCE_PUT_ERROR                 "Maximum resource name length is %d characters."
+#define HTTPS_RESOURCE_PUT_BUSY                  "Too many pending resource registrations."
 #define HTTPS_REQUEST_HANDLE_SUCCESS             (0)
 #define HTTPS_REQUEST_HANDLE_ERROR               (-1)
 
@@ -127,7 +171,44 @@
               "</body>" \
               "</html>"
 
-#define MAX_HTTP_RESPONSE_LENGTH                 (sizeof(HTTPS_STARTUP_WEBPAGE) + sizeof(MAX_LED_STATUS_LENGTH) + 1)
+/* Responses of the resources added through HTTPS PUT requests. They are
+ * registered as raw dynamic resources, whose handler writes the response
+ * header, so that the response carries the hash of the value as its entity
+ * tag. A client that sends the tag back as the query parameter
+ * HTTPS_RESOURCE_ETAG_PARAMETER gets 304 (Not Modified) while the value is
+ * unchanged.
+ */
+#define HTTPS_RESOURCE_ETAG_PARAMETER            "etag"
+#define HTTPS_RESOURCE_200_HEADER                "HTTP/1.1 200 OK\r\n" \
+                                                 "Content-Type: text/html\r\n" \
+                                                 "Content-Length: %" PRIu32 "\r\n" \
+                                                 "ETag: \"%08" PRIx32 "\"\r\n" \
+                                                 "Cache-Control: no-cache\r\n" \
+                                                 "Connection: %s\r\n\r\n"
+#define HTTPS_RESOURCE_304_HEADER                "HTTP/1.1 304 Not Modified\r\n" \
+                                                 "ETag: \"%08" PRIx32 "\"\r\n" \
+                                                 "Cache-Control: no-cache\r\n" \
+                                                 "Connection: %s\r\n\r\n"
+#define HTTPS_RESOURCE_404_HEADER                "HTTP/1.1 404 Not Found\r\n" \
+                                                 "Content-Length: 0\r\n" \
+                                                 "Connection: %s\r\n\r\n"
+#define HTTPS_RESOURCE_405_HEADER                "HTTP/1.1 405 Method Not Allowed\r\n" \
+                                                 "Allow: GET\r\n" \
+                                                 "Content-Length: 0\r\n" \
+                                                 "Connection: %s\r\n\r\n"
+#define HTTPS_RESOURCE_PUT_503_HEADER            "HTTP/1.1 503 Service Unavailable\r\n" \
+                                                 "Retry-After: %d\r\n" \
+                                                 "Content-Type: text/plain\r\n" \
+                                                 "Content-Length: %u\r\n" \
+                                                 "Cache-Control: no-cache\r\n" \
+                                                 "Connection: %s\r\n\r\n"
+#define MAX_HTTPS_RESOURCE_RESPONSE_LENGTH       (sizeof(HTTPS_RESOURCE_200_HEADER) + NEW_RESOURCE_NAME_LENGTH + 32)
+
+/* HTTPS_STARTUP_WEBPAGE is sent by write_https_template() straight from flash;
+ * only the PUT error and busy responses are formatted in a buffer.
+ */
+#define MAX_HTTP_RESPONSE_LENGTH                 (sizeof(HTTPS_RESOURCE_PUT_503_HEADER) + \
+                                                  sizeof(HTTPS_RESOURCE_PUT_BUSY) + 32)
 
 /*******************************************************************************
 * Function Prototypes
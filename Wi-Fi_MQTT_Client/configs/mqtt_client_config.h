@@ -59,6 +59,15 @@
  */
 #define MQTT_SECURE_CONNECTION            ( 0 )
 
+/* Embed the certificates and keys below in DER form, which mbedTLS parses
+ * without Base64 decoding. CREDENTIALS_DER=1 in the Makefile sets it and
+ * generates mqtt_client_config_der.h with scripts/pem_to_der.py before the
+ * build.
+ */
+#ifndef USE_DER_CREDENTIALS
+#define USE_DER_CREDENTIALS               ( 0 )
+#endif
+
 /* Configure the user credentials to be sent as part of MQTT CONNECT packet */
 #define MQTT_USERNAME                     ""
 #define MQTT_PASSWORD                     ""
@@ -165,7 +174,10 @@
 
 /**************** MQTT CLIENT CERTIFICATE CONFIGURATION MACROS ****************/
 
-/* Configure the below credentials in case of a secure MQTT connection. */
+/* Configure the below credentials in case of a secure MQTT connection.
+ * Credentials that are not used can be removed. With CREDENTIALS_DER=1, each
+ * must hold one PEM block as generated by OpenSSL.
+ */
 /* PEM-encoded client certificate */
 #define CLIENT_CERTIFICATE      \
 "-----BEGIN CERTIFICATE-----\n"\
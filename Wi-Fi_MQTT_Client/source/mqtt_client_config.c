@@ -44,6 +44,11 @@
 #include "mqtt_client_config.h"
 #include "cy_mqtt_api.h"
 
+#if (MQTT_SECURE_CONNECTION) && (USE_DER_CREDENTIALS)
+/* DER form of the credentials, generated by scripts/pem_to_der.py. */
+#include "mqtt_client_config_der.h"
+#endif
+
 /******************************************************************************
 * Global Variables
 *******************************************************************************/
@@ -56,11 +61,27 @@ cy_mqtt_broker_info_t broker_info =
 };
 
 #if (MQTT_SECURE_CONNECTION)
+/* Credentials in DER form. Each array ends in a zero byte that is not part of
+ * the DER data.
+ */
+#ifdef CLIENT_CERTIFICATE_DER
+static const uint8_t client_certificate_der[] = CLIENT_CERTIFICATE_DER;
+#endif
+#ifdef CLIENT_PRIVATE_KEY_DER
+static const uint8_t client_private_key_der[] = CLIENT_PRIVATE_KEY_DER;
+#endif
+#ifdef ROOT_CA_CERTIFICATE_DER
+static const uint8_t root_ca_certificate_der[] = ROOT_CA_CERTIFICATE_DER;
+#endif
+
 /* MQTT client credentials to be used in case of a secure connection. */
 static cy_awsport_ssl_credentials_t credentials =
 {
     /* Configure the client certificate. */
-#ifdef CLIENT_CERTIFICATE
+#if defined(CLIENT_CERTIFICATE_DER)
+    .client_cert = (const char *)client_certificate_der,
+    .client_cert_size = CLIENT_CERTIFICATE_DER_LEN,
+#elif defined(CLIENT_CERTIFICATE)
     .client_cert = (const char *)CLIENT_CERTIFICATE,
     .client_cert_size = sizeof(CLIENT_CERTIFICATE),
 #else
@@ -69,7 +90,10 @@ static cy_awsport_ssl_credentials_t credentials =
 #endif
 
     /* Configure the client private key. */
-#ifdef CLIENT_PRIVATE_KEY
+#if defined(CLIENT_PRIVATE_KEY_DER)
+    .private_key = (const char *)client_private_key_der,
+    .private_key_size = CLIENT_PRIVATE_KEY_DER_LEN,
+#elif defined(CLIENT_PRIVATE_KEY)
     .private_key = (const char *)CLIENT_PRIVATE_KEY,
     .private_key_size = sizeof(CLIENT_PRIVATE_KEY),
 #else
@@ -78,7 +102,10 @@ static cy_awsport_ssl_credentials_t credentials =
 #endif
 
     /* Configure the Root CA certificate of the MQTT Broker/Server. */
-#ifdef ROOT_CA_CERTIFICATE
+#if defined(ROOT_CA_CERTIFICATE_DER)
+    .root_ca = (const char *)root_ca_certificate_der,
+    .root_ca_size = ROOT_CA_CERTIFICATE_DER_LEN,
+#elif defined(ROOT_CA_CERTIFICATE)
     .root_ca = (const char *)ROOT_CA_CERTIFICATE,
     .root_ca_size = sizeof(ROOT_CA_CERTIFICATE),
 #else
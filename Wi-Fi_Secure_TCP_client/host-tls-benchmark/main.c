@@ -0,0 +1,108 @@
+/******************************************************************************
+* File Name:   main.c
+*
+* Description: This is the entry point of the host build of the TLS benchmark.
+*              It also provides the entropy source that the mbedTLS user
+*              configurations of the examples expect from the hardware.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Standard C header files */
+#include <stdio.h>
+#include <stddef.h>
+
+/* TLS benchmark header file */
+#include "tls_benchmark.h"
+
+/******************************************************************************
+* Function Prototypes
+******************************************************************************/
+int mbedtls_hardware_poll(void *data, unsigned char *output, size_t len, size_t *olen);
+
+/******************************************************************************
+ * Function Name: mbedtls_hardware_poll
+ ******************************************************************************
+ * Summary:
+ *  Entropy source of mbedTLS, used when the configuration defines
+ *  MBEDTLS_ENTROPY_HARDWARE_ALT. Reads the random device of the host.
+ *
+ * Parameters:
+ *  void *data: Not used
+ *  unsigned char *output: Buffer for the entropy
+ *  size_t len: Size of the buffer
+ *  size_t *olen: Number of bytes written
+ *
+ * Return:
+ *  int: 0 on success, -1 otherwise.
+ *
+ ******************************************************************************/
+int mbedtls_hardware_poll(void *data, unsigned char *output, size_t len, size_t *olen)
+{
+    FILE *random = fopen("/dev/urandom", "rb");
+
+    (void)data;
+    *olen = 0;
+
+    if (random == NULL)
+    {
+        return -1;
+    }
+
+    *olen = fread(output, 1, len, random);
+    fclose(random);
+
+    return (*olen == len) ? 0 : -1;
+}
+
+/******************************************************************************
+ * Function Name: main
+ ******************************************************************************
+ * Summary:
+ *  Runs the TLS benchmark.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  int: Number of measurements that failed.
+ *
+ ******************************************************************************/
+int main(void)
+{
+    return tls_benchmark_run();
+}
+/* [] END OF FILE */
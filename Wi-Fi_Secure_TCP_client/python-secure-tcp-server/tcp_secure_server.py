@@ -45,6 +45,16 @@ import sys
 host = ''       # Symbolic name meaning the local host
 port = 50007    # Arbitrary non-privileged port
 
+# Pre-shared keys of the known clients by PSK identity, see
+# TLS_PSK_CLIENT_IDENTITY and TLS_PSK_CLIENT_KEY in network_credentials.h.
+PSK_KEYS = {
+    "psoc6-tcp-client": bytes.fromhex("d74d1176e2bb3d96e7ad8bff8872939f5015b299e62e46475b5f6ca2b8e3db67"),
+}
+
+# If the argument 'psk' is passed, authenticate clients with their pre-shared
+# key instead of certificates, for a client built with TLS_PSK=1.
+use_psk = "psk" in sys.argv[1:]
+
 # If argument passed is ipv6, use IPv6 addressing mode.
 if ( len(sys.argv) > 1 and sys.argv[1] == "ipv6" ):
     print("=============================================================================")
@@ -61,6 +71,22 @@ else :
     s = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
     s.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
 
+# Use one TLS context for all connections; its session cache and session
+# ticket keys let a reconnecting client resume its session.
+context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+if use_psk:
+    if not hasattr(context, "set_psk_server_callback"):
+        print("The 'psk' option needs Python 3.13 or later.")
+        sys.exit(1)
+    # The TLS 1.2 PSK cipher suites authenticate both peers with the key alone.
+    # An unknown identity gets no key, which fails the handshake.
+    context.maximum_version = ssl.TLSVersion.TLSv1_2
+    context.set_ciphers("ECDHEPSK:PSK")
+    context.set_psk_server_callback(lambda identity: PSK_KEYS.get(identity, b""))
+else:
+    context.load_cert_chain(certfile="server.crt", keyfile="server.key")
+    context.load_verify_locations(cafile="root_ca.crt")
+
 try:
     s.bind((host, port))
     s.listen(1)
@@ -74,9 +100,6 @@ while True:
     data_len = 0
     try:
         conn, addr = s.accept()
-        context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
-        context.load_cert_chain(certfile="server.crt", keyfile="server.key")
-        context.load_verify_locations(cafile="root_ca.crt")
         connstream = context.wrap_socket(conn, server_side=True)
     except KeyboardInterrupt:
         print("Closing Connection")
@@ -84,6 +107,8 @@ while True:
         sys.exit(1)
 
     print('Incoming connection accepted: ', addr)
+    print('TLS session reused: ', connstream.session_reused)
+    print('TLS cipher suite: ', connstream.cipher()[0])
 
     try:
         while True:
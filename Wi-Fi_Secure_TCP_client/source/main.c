@@ -51,6 +51,11 @@
 /* Secure TCP client task header file. */
 #include "secure_tcp_client.h"
 
+#if (USE_TLS_BENCHMARK)
+/* TLS benchmark header file. */
+#include "tls_benchmark.h"
+#endif
+
 /* Include serial flash library and QSPI memory configurations only for the
  * kits that require the Wi-Fi firmware to be loaded in external QSPI NOR flash.
  */
@@ -65,6 +70,15 @@
 /* RTOS related macros. */
 #define TCP_SECURE_CLIENT_TASK_STACK_SIZE  (5 * 1024)
 #define TCP_SECURE_CLIENT_TASK_PRIORITY    (1)
+#define TLS_BENCHMARK_TASK_STACK_SIZE      (8 * 1024)
+#define TLS_BENCHMARK_TASK_PRIORITY        (1)
+
+/******************************************************************************
+* Function Prototypes
+******************************************************************************/
+#if (USE_TLS_BENCHMARK)
+static void tls_benchmark_task(void *arg);
+#endif
 
 /******************************************************************************
 * Global Variables
@@ -124,8 +138,13 @@ int main()
     printf("===============================================================\n\n");
 
     /* Create the tasks */
+#if (USE_TLS_BENCHMARK)
+    xTaskCreate(tls_benchmark_task, "TLS benchmark task", TLS_BENCHMARK_TASK_STACK_SIZE,
+                NULL, TLS_BENCHMARK_TASK_PRIORITY, NULL);
+#else
     xTaskCreate(tcp_secure_client_task, "Network task", TCP_SECURE_CLIENT_TASK_STACK_SIZE,
                 NULL, TCP_SECURE_CLIENT_TASK_PRIORITY, NULL);
+#endif
 
     /* Start the FreeRTOS scheduler */
     vTaskStartScheduler();
@@ -133,4 +152,28 @@ int main()
     /* Should never get here */
     CY_ASSERT(0);
 }
+
+#if (USE_TLS_BENCHMARK)
+/******************************************************************************
+ * Function Name: tls_benchmark_task
+ ******************************************************************************
+ * Summary:
+ *  Runs the TLS benchmark once and deletes itself.
+ *
+ * Parameters:
+ *  void *arg: Not used
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void tls_benchmark_task(void *arg)
+{
+    (void)arg;
+
+    tls_benchmark_run();
+
+    vTaskDelete(NULL);
+}
+#endif
 /* [] END OF FILE */
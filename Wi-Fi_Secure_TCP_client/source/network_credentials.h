@@ -168,5 +168,17 @@
 "wojOQQd/7c2v4mSi7wbmRLEJXi5mGzC7OdvXPcUC\n"\
 "-----END CERTIFICATE-----\n"
 
+/* Pre-shared key of the TCP client, used instead of the certificates above
+ * when USE_TLS_PSK is enabled. The server looks the key up by the PSK
+ * identity, so give each client its own identity and random key. Generate a
+ * key with:
+ * openssl rand -hex 32
+ */
+#define TLS_PSK_CLIENT_IDENTITY                        "psoc6-tcp-client"
+#define TLS_PSK_CLIENT_KEY                             { 0xD7, 0x4D, 0x11, 0x76, 0xE2, 0xBB, 0x3D, 0x96, \
+                                                         0xE7, 0xAD, 0x8B, 0xFF, 0x88, 0x72, 0x93, 0x9F, \
+                                                         0x50, 0x15, 0xB2, 0x99, 0xE6, 0x2E, 0x46, 0x47, \
+                                                         0x5B, 0x5F, 0x6C, 0xA2, 0xB8, 0xE3, 0xDB, 0x67 }
+
 
 #endif /* NETWORK_CREDENTIALS_H_ */
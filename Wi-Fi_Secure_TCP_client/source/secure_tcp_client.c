@@ -66,6 +66,21 @@
 /* Wi-Fi credentials and TCP port settings header file. */
 #include "network_credentials.h"
 
+#if(USE_DER_CREDENTIALS)
+/* DER form of the credentials, generated by scripts/pem_to_der.py. */
+#include "network_credentials_der.h"
+#endif
+
+#if(USE_TLS_SESSION_RESUMPTION)
+/* TLS layer with session resumption. */
+#include "tls_client.h"
+#endif
+
+#if(USE_TLS_PSK) && !defined(MBEDTLS_KEY_EXCHANGE_PSK_ENABLED) && \
+    !defined(MBEDTLS_KEY_EXCHANGE_ECDHE_PSK_ENABLED)
+#error "USE_TLS_PSK needs the PSK key exchanges of mbedTLS. Set TLS_PSK=1 in the Makefile."
+#endif
+
 /* to use the portable formatting macros */
 #include <inttypes.h>
 
@@ -85,7 +100,11 @@
 cy_rslt_t connect_to_secure_tcp_server(cy_socket_sockaddr_t address);
 cy_rslt_t create_secure_tcp_client_socket();
 cy_rslt_t tcp_client_recv_handler(cy_socket_t socket_handle, void *arg);
+static cy_rslt_t tcp_client_recv_cmd(cy_socket_t socket_handle);
 cy_rslt_t tcp_disconnection_handler(cy_socket_t socket_handle, void *arg);
+#if(USE_TLS_SESSION_RESUMPTION)
+static cy_rslt_t secure_tcp_client_tls_connect(const cy_socket_sockaddr_t *address);
+#endif
 void read_uart_input(uint8_t* input_buffer_ptr);
 void print_heap_usage(char *msg);
 
@@ -99,15 +118,33 @@ void print_heap_usage(char *msg);
 /******************************************************************************
 * Global Variables
 ******************************************************************************/
+#if(USE_TLS_PSK)
+/* Pre-shared key of the TCP client. */
+static const uint8_t tls_psk_key[] = TLS_PSK_CLIENT_KEY;
+#elif(USE_DER_CREDENTIALS)
+/* TLS credentials of the TCP client in DER form. Each array ends in a zero
+ * byte that is not part of the DER data. */
+static const uint8_t tcp_client_cert[] = keyCLIENT_CERTIFICATE_DER;
+static const uint8_t client_private_key[] = keyCLIENT_PRIVATE_KEY_DER;
+
+/* Root CA certificate for TCP server identity verification. */
+static const uint8_t tcp_server_ca_cert[] = keySERVER_ROOTCA_DER;
+#else
 /* TLS credentials of the TCP client. */
 static const char tcp_client_cert[] = keyCLIENT_CERTIFICATE_PEM;
 static const char client_private_key[] = keyCLIENT_PRIVATE_KEY_PEM;
 
 /* Root CA certificate for TCP server identity verification. */
 static const char tcp_server_ca_cert[] = keySERVER_ROOTCA_PEM;
+#endif /* USE_TLS_PSK */
 
+#if(USE_TLS_SESSION_RESUMPTION)
+/* TLS connection to the TCP server. */
+static tls_client_conn_t tls_conn;
+#else
 /* Variable to store the TLS identity (certificate and private key). */
 void *tls_identity;
+#endif
 
 /* TCP client socket handle */
 cy_socket_t client_handle;
@@ -186,9 +223,17 @@ void tcp_secure_client_task(void *arg)
     /* Give the semaphore so as to connect to TCP server. */
     xSemaphoreGive(connect_to_server); 
 
-    /* TCP client certificate length and private key length. */
-    const size_t tcp_client_cert_len = strlen( tcp_client_cert );
-    const size_t pkey_len = strlen( client_private_key );
+#if(!USE_TLS_SESSION_RESUMPTION)
+    /* TCP client certificate length and private key length, without the
+     * terminating null character of PEM or the zero byte after DER. */
+    const size_t tcp_client_cert_len = sizeof( tcp_client_cert ) - 1u;
+    const size_t pkey_len = sizeof( client_private_key ) - 1u;
+#endif
+
+#if(USE_TLS_SETUP_TIMING)
+    /* CPU cycle count at the start of the TLS setup. */
+    uint32_t tls_setup_start;
+#endif
 
     /* Initialize secure socket library. */
     result = cy_socket_init();
@@ -199,11 +244,41 @@ void tcp_secure_client_task(void *arg)
     }
     printf("Secure Socket initialized\n");
 
+#if(USE_TLS_SETUP_TIMING)
+    /* Count the CPU cycles taken to set up TLS, which is mostly the parsing
+     * of the credentials. */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    tls_setup_start = DWT->CYCCNT;
+#endif
+
+#if(USE_TLS_PSK)
+    /* Set up the TLS layer to authenticate with the pre-shared key. */
+    result = tls_client_init_psk(TLS_PSK_CLIENT_IDENTITY, tls_psk_key, sizeof(tls_psk_key));
+    if(result != CY_RSLT_SUCCESS)
+    {
+        printf("Failed to set up the TLS layer! Error code: %"PRIu32"\n", result);
+        CY_ASSERT(0);
+    }
+#elif(USE_TLS_SESSION_RESUMPTION)
+    /* Set up the TLS layer. mbedTLS expects the length of a PEM buffer to
+     * include the terminating null character; DER arrays end in a zero byte
+     * as well. */
+    result = tls_client_init((const uint8_t *)tcp_client_cert, sizeof(tcp_client_cert),
+                             (const uint8_t *)client_private_key, sizeof(client_private_key),
+                             (const uint8_t *)tcp_server_ca_cert, sizeof(tcp_server_ca_cert));
+    if(result != CY_RSLT_SUCCESS)
+    {
+        printf("Failed to set up the TLS layer! Error code: %"PRIu32"\n", result);
+        CY_ASSERT(0);
+    }
+#else
     /* Initializes the global trusted RootCA certificate. This examples uses a self signed
      * certificate which implies that the RootCA certificate is same as the certificate of
      * TCP secure server to which client is connecting to.
      */
-    result = cy_tls_load_global_root_ca_certificates(tcp_server_ca_cert, strlen(tcp_server_ca_cert));
+    result = cy_tls_load_global_root_ca_certificates((const char *)tcp_server_ca_cert,
+                                                     sizeof(tcp_server_ca_cert) - 1u);
     if( result != CY_RSLT_SUCCESS)
     {
         printf("cy_tls_load_global_root_ca_certificates failed! Error code: %"PRIu32"\n", result);
@@ -214,13 +289,21 @@ void tcp_secure_client_task(void *arg)
     }
 
     /* Create TCP client identity using the SSL certificate and private key. */
-    result = cy_tls_create_identity(tcp_client_cert, tcp_client_cert_len,
-                                    client_private_key, pkey_len, &tls_identity);
+    result = cy_tls_create_identity((const char *)tcp_client_cert, tcp_client_cert_len,
+                                    (const char *)client_private_key, pkey_len, &tls_identity);
     if(result != CY_RSLT_SUCCESS)
     {
         printf("Failed cy_tls_create_identity! Error code: %"PRIu32"\n", result);
         CY_ASSERT(0);
     }   
+#endif /* USE_TLS_SESSION_RESUMPTION */
+
+#if(USE_TLS_SETUP_TIMING)
+    printf("TLS setup (%s credentials) took %"PRIu32" us\n",
+           (USE_TLS_PSK) ? "PSK" : ((USE_DER_CREDENTIALS) ? "DER" : "PEM"),
+           (DWT->CYCCNT - tls_setup_start) / (SystemCoreClock / 1000000u));
+#endif
+    print_heap_usage("After setting up TLS");
 
     for(;;)
     {
@@ -435,9 +518,21 @@ cy_rslt_t create_secure_tcp_client_socket()
     cy_rslt_t result;
 
     /* Variables used to set socket options. */
+#if(!USE_TLS_SESSION_RESUMPTION)
     cy_socket_opt_callback_t tcp_recv_option;
+#endif
     cy_socket_opt_callback_t tcp_disconnection_option;
 
+#if(USE_TLS_SESSION_RESUMPTION)
+    /* Create a plain TCP socket; TLS runs on top of it in tls_client.c. */
+    #if(USE_IPV6_ADDRESS)
+        result = cy_socket_create(CY_SOCKET_DOMAIN_AF_INET6, CY_SOCKET_TYPE_STREAM,
+                                  CY_SOCKET_IPPROTO_TCP, &client_handle);
+    #else
+        result = cy_socket_create(CY_SOCKET_DOMAIN_AF_INET, CY_SOCKET_TYPE_STREAM,
+                                  CY_SOCKET_IPPROTO_TCP, &client_handle);
+    #endif
+#else
     /* TLS authentication mode. */
     cy_socket_tls_auth_mode_t tls_auth_mode = CY_SOCKET_TLS_VERIFY_REQUIRED;
 
@@ -449,6 +544,7 @@ cy_rslt_t create_secure_tcp_client_socket()
         result = cy_socket_create(CY_SOCKET_DOMAIN_AF_INET, CY_SOCKET_TYPE_STREAM,
                                       CY_SOCKET_IPPROTO_TLS, &client_handle);
     #endif
+#endif /* USE_TLS_SESSION_RESUMPTION */
 
     if (result != CY_RSLT_SUCCESS)
     {
@@ -456,6 +552,10 @@ cy_rslt_t create_secure_tcp_client_socket()
         return result;
     }
 
+#if(!USE_TLS_SESSION_RESUMPTION)
+    /* With USE_TLS_SESSION_RESUMPTION, the receive callback is registered
+     * after the TLS handshake (see connect_to_secure_tcp_server). */
+
     /* Register the callback function to handle messages received from TCP server. */
     tcp_recv_option.callback = tcp_client_recv_handler;
     tcp_recv_option.arg = NULL;
@@ -468,6 +568,7 @@ cy_rslt_t create_secure_tcp_client_socket()
                 "Error Code: %"PRIu32"\n", result);
         return result;
     }
+#endif /* !USE_TLS_SESSION_RESUMPTION */
 
     /* Register the callback function to handle disconnection. */
     tcp_disconnection_option.callback = tcp_disconnection_handler;
@@ -483,6 +584,7 @@ cy_rslt_t create_secure_tcp_client_socket()
         return result;
     }
 
+#if(!USE_TLS_SESSION_RESUMPTION)
     /* Set the TCP socket to use the TLS identity. */
     result = cy_socket_setsockopt(client_handle, CY_SOCKET_SOL_TLS, CY_SOCKET_SO_TLS_IDENTITY,
                                   tls_identity, sizeof((uint32_t)tls_identity));
@@ -500,6 +602,7 @@ cy_rslt_t create_secure_tcp_client_socket()
         printf("Set socket option: CY_SOCKET_SO_TLS_AUTH_MODE failed! "
                "Error Code: %"PRIu32"\n", result);
     }
+#endif /* !USE_TLS_SESSION_RESUMPTION */
 
     return result;
 }
@@ -533,6 +636,16 @@ cy_rslt_t connect_to_secure_tcp_server(cy_socket_sockaddr_t address)
         }
         
         conn_result = cy_socket_connect(client_handle, &address, sizeof(cy_socket_sockaddr_t));
+    #if(USE_TLS_SESSION_RESUMPTION)
+        if (conn_result == CY_RSLT_SUCCESS)
+        {
+            conn_result = secure_tcp_client_tls_connect(&address);
+            if (conn_result != CY_RSLT_SUCCESS)
+            {
+                cy_socket_disconnect(client_handle, 0);
+            }
+        }
+    #endif
         if (conn_result == CY_RSLT_SUCCESS)
         {
             printf("============================================================\n");
@@ -555,6 +668,62 @@ cy_rslt_t connect_to_secure_tcp_server(cy_socket_sockaddr_t address)
      return result;
 }
 
+#if(USE_TLS_SESSION_RESUMPTION)
+/*******************************************************************************
+ * Function Name: secure_tcp_client_tls_connect
+ *******************************************************************************
+ * Summary:
+ *  Performs the TLS handshake on the connected TCP socket and then registers
+ *  the receive callback, so that the callback never runs during the handshake.
+ *
+ * Parameters:
+ *  const cy_socket_sockaddr_t *address: Address of TCP server socket
+ *
+ * Return:
+ *  cy_result result: Result of the operation
+ *
+ *******************************************************************************/
+static cy_rslt_t secure_tcp_client_tls_connect(const cy_socket_sockaddr_t *address)
+{
+    cy_rslt_t result;
+    cy_socket_opt_callback_t tcp_recv_option;
+
+    /* The handshake polls the socket, so use a short receive timeout. */
+    uint32_t tls_recv_timeout = TLS_CLIENT_SOCKET_RECV_TIMEOUT_MS;
+
+    result = cy_socket_setsockopt(client_handle, CY_SOCKET_SOL_SOCKET,
+                                  CY_SOCKET_SO_RCVTIMEO, &tls_recv_timeout,
+                                  sizeof(tls_recv_timeout));
+    if (result != CY_RSLT_SUCCESS)
+    {
+        printf("Set socket option: CY_SOCKET_SO_RCVTIMEO failed! "
+               "Error Code: %"PRIu32"\n", result);
+        return result;
+    }
+
+    result = tls_client_handshake(&tls_conn, client_handle, address);
+    if (result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+
+    /* Register the callback function to handle messages received from TCP server. */
+    tcp_recv_option.callback = tcp_client_recv_handler;
+    tcp_recv_option.arg = NULL;
+    result = cy_socket_setsockopt(client_handle, CY_SOCKET_SOL_SOCKET,
+                                  CY_SOCKET_SO_RECEIVE_CALLBACK,
+                                  &tcp_recv_option, sizeof(cy_socket_opt_callback_t));
+    if (result != CY_RSLT_SUCCESS)
+    {
+        printf("Set socket option: CY_SOCKET_SO_RECEIVE_CALLBACK failed! "
+                "Error Code: %"PRIu32"\n", result);
+        tls_client_close(&tls_conn);
+    }
+
+    return result;
+}
+#endif /* USE_TLS_SESSION_RESUMPTION */
+
 /*******************************************************************************
  * Function Name: tcp_client_recv_handler
  *******************************************************************************
@@ -570,6 +739,48 @@ cy_rslt_t connect_to_secure_tcp_server(cy_socket_sockaddr_t address)
  *
  *******************************************************************************/
 cy_rslt_t tcp_client_recv_handler(cy_socket_t socket_handle, void *arg)
+{
+    cy_rslt_t result;
+
+#if(USE_TLS_SESSION_RESUMPTION)
+    /* mbedTLS reads the socket in larger blocks than a record, so commands
+     * sent by the server in quick succession may already be buffered in the
+     * TLS context. The socket raises no receive event for them; handle them
+     * all here.
+     */
+    do
+    {
+        result = tcp_client_recv_cmd(socket_handle);
+    } while((result == CY_RSLT_SUCCESS) && tls_client_pending(&tls_conn));
+
+    /* A record may be split across several receive events; wait for the rest. */
+    if(result == CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT)
+    {
+        result = CY_RSLT_SUCCESS;
+    }
+#else
+    result = tcp_client_recv_cmd(socket_handle);
+#endif
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: tcp_client_recv_cmd
+ *******************************************************************************
+ * Summary:
+ *  Receives one LED ON/OFF command from the secure TCP server, sets the LED and
+ *  sends the acknowledgement.
+ *
+ * Parameters:
+ *  cy_socket_t socket_handle: Connection handle for the TCP client socket
+ *
+ * Return:
+ *  cy_result result: Result of the operation. With USE_TLS_SESSION_RESUMPTION,
+ *  CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT if no complete record was received.
+ *
+ *******************************************************************************/
+static cy_rslt_t tcp_client_recv_cmd(cy_socket_t socket_handle)
 {
     /* Variable to store number of bytes send to the TCP server. */
     uint32_t bytes_sent = 0;
@@ -580,8 +791,16 @@ cy_rslt_t tcp_client_recv_handler(cy_socket_t socket_handle, void *arg)
     char message_buffer[MAX_TCP_DATA_PACKET_LENGTH] = {0};
     cy_rslt_t result = 0;
 
+#if(USE_TLS_SESSION_RESUMPTION)
+    result = tls_client_recv(&tls_conn, message_buffer, TCP_LED_CMD_LEN, &bytes_received);
+    if(result == CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT)
+    {
+        return result;
+    }
+#else
     result = cy_socket_recv(socket_handle, message_buffer, TCP_LED_CMD_LEN,
                             CY_SOCKET_FLAGS_NONE, &bytes_received);
+#endif
     if(result == CY_RSLT_SUCCESS)
     {
         printf("============================================================\n");
@@ -607,8 +826,12 @@ cy_rslt_t tcp_client_recv_handler(cy_socket_t socket_handle, void *arg)
     }
 
     /* Send acknowledgement to the secure TCP server in receipt of the message received. */
+#if(USE_TLS_SESSION_RESUMPTION)
+    result = tls_client_send(&tls_conn, message_buffer, strlen(message_buffer), &bytes_sent);
+#else
     result = cy_socket_send(socket_handle, message_buffer, strlen(message_buffer),
                             CY_SOCKET_FLAGS_NONE, &bytes_sent);
+#endif
     if(result == CY_RSLT_SUCCESS)
     {
         printf("Acknowledgement sent to TCP server\n");
@@ -637,6 +860,13 @@ cy_rslt_t tcp_disconnection_handler(cy_socket_t socket_handle, void *arg)
 {
     cy_rslt_t result;
 
+#if(USE_TLS_SESSION_RESUMPTION)
+    /* Only the TLS context is released; the session is kept for the next
+     * connection. */
+    tls_client_close(&tls_conn);
+    tls_client_print_stats();
+#endif
+
     /* Disconnect the TCP client. */
     result = cy_socket_disconnect(socket_handle, 0);
     
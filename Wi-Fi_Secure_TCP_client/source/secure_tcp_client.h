@@ -56,6 +56,53 @@
  * IPv4 protocol.
  */
 #define USE_IPV6_ADDRESS                      (0)
+
+/* Set this macro to '1' to run TLS directly on mbedTLS (see tls_client.c)
+ * instead of the secure socket library, so that reconnects resume the TLS
+ * session of the previous connection with an abbreviated handshake.
+ */
+#ifndef USE_TLS_SESSION_RESUMPTION
+#define USE_TLS_SESSION_RESUMPTION            (0)
+#endif
+
+/* Authenticate with a pre-shared key (see network_credentials.h) instead of
+ * certificates. It needs the PSK key exchanges of mbedTLS, so it is set by
+ * TLS_PSK=1 in the Makefile, which also selects
+ * configs/mbedtls_user_config_psk.h. PSK runs on the same mbedTLS layer as
+ * USE_TLS_SESSION_RESUMPTION, which it enables.
+ */
+#ifndef USE_TLS_PSK
+#define USE_TLS_PSK                           (0)
+#endif
+
+/* Embed the certificates and keys of network_credentials.h in DER form, which
+ * mbedTLS parses without Base64 decoding. CREDENTIALS_DER=1 in the Makefile
+ * sets it and generates network_credentials_der.h with scripts/pem_to_der.py
+ * before the build.
+ */
+#ifndef USE_DER_CREDENTIALS
+#define USE_DER_CREDENTIALS                       (0)
+#endif
+
+/* Print the time taken to set up TLS, which is mostly the parsing of the
+ * credentials, measured with the DWT cycle counter. TLS_SETUP_TIMING=1 in the
+ * Makefile sets it.
+ */
+#ifndef USE_TLS_SETUP_TIMING
+#define USE_TLS_SETUP_TIMING                      (0)
+#endif
+
+#if (USE_TLS_PSK)
+#undef USE_TLS_SESSION_RESUMPTION
+#define USE_TLS_SESSION_RESUMPTION            (1)
+#endif
+
+/* Set this macro to '1' to run the TLS benchmark (see tls_benchmark.c) at
+ * startup instead of the secure TCP client. It needs no network connection.
+ */
+#ifndef USE_TLS_BENCHMARK
+#define USE_TLS_BENCHMARK                     (0)
+#endif
 #define TCP_SERVER_PORT                       (50007)
 #define RTOS_TICK_TO_WAIT                     (50u)
 #define UART_INPUT_TIMEOUT_MS                 (1u)
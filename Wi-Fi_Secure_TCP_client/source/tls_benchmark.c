@@ -0,0 +1,1024 @@
+/******************************************************************************
+* File Name:   tls_benchmark.c
+*
+* Description: This file contains the TLS benchmark. A TLS client and a TLS
+*              server run in the same task and exchange their records through
+*              memory, so that the measurement contains the cryptography and
+*              the record processing of mbedTLS, but no network latency.
+*              - Each full handshake is driven one state at a time and the
+*                cycles spent in each state are reported per side, for RSA and
+*                ECDSA server certificates and several ECDHE curves.
+*              - The record layer is measured by encrypting and decrypting
+*                application data at several record sizes, for the AES-GCM,
+*                AES-CCM and ChaCha20-Poly1305 cipher suites.
+*              Define TLS_BENCHMARK_HOST to build the benchmark for the host
+*              (see host-tls-benchmark).
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Standard C header files */
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#if defined(TLS_BENCHMARK_HOST)
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#else
+/* Device header files for the DWT cycle counter and the core clock */
+#include "cyhal.h"
+#endif
+
+/* mbedTLS header files */
+#include "mbedtls/version.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/x509_crt.h"
+#include "mbedtls/pk.h"
+#include "mbedtls/ecp.h"
+#include "mbedtls/ssl.h"
+#include "mbedtls/ssl_ciphersuites.h"
+#if (MBEDTLS_VERSION_NUMBER >= 0x03000000) && defined(MBEDTLS_PSA_CRYPTO_C)
+#include "psa/crypto.h"
+#endif
+
+/* TLS benchmark header files */
+#include "tls_benchmark.h"
+#include "tls_benchmark_credentials.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Personalization string of the random number generator. */
+#define TLS_BENCHMARK_DRBG_PERSONALIZATION        "tls_benchmark"
+
+/* The context fields are private from mbedTLS 3.0 on. */
+#if (MBEDTLS_VERSION_NUMBER >= 0x03000000)
+#define TLS_BENCHMARK_FIELD(field)                MBEDTLS_PRIVATE(field)
+#else
+#define TLS_BENCHMARK_FIELD(field)                field
+#endif
+
+/* Unit of the counter returned by tls_benchmark_cycles(). The host has no
+ * portable cycle counter; x86 hosts use the time stamp counter instead.
+ */
+#if defined(TLS_BENCHMARK_HOST) && !defined(__x86_64__) && !defined(__i386__)
+#define TLS_BENCHMARK_UNIT                        "ns"
+#else
+#define TLS_BENCHMARK_UNIT                        "cycles"
+#endif
+
+/* Size of each direction of the memory transport. It holds a full handshake
+ * flight or the largest record including its header, IV and tag.
+ */
+#define TLS_BENCHMARK_PIPE_LEN                    (MBEDTLS_SSL_OUT_CONTENT_LEN + 1024u)
+
+/* Handshake steps after which a handshake that does not complete is failed. */
+#define TLS_BENCHMARK_MAX_STEPS                   (256u)
+
+/* Pre-shared keys can only be used if mbedTLS has a PSK key exchange. */
+#if defined(MBEDTLS_KEY_EXCHANGE_PSK_ENABLED) || defined(MBEDTLS_KEY_EXCHANGE_ECDHE_PSK_ENABLED)
+#define TLS_BENCHMARK_PSK_SUPPORTED               (1)
+#else
+#define TLS_BENCHMARK_PSK_SUPPORTED               (0)
+#endif
+
+/* Number of entries of an array. */
+#define TLS_BENCHMARK_COUNT(array)                (sizeof(array) / sizeof((array)[0]))
+
+/*******************************************************************************
+* Data structure and enumeration
+********************************************************************************/
+/* Server certificate types, and the pre-shared key used instead of one. */
+typedef enum
+{
+    TLS_BENCHMARK_CERT_RSA,
+    TLS_BENCHMARK_CERT_ECDSA,
+    TLS_BENCHMARK_CERT_PSK,
+    TLS_BENCHMARK_CERT_COUNT
+} tls_benchmark_cert_t;
+
+/* Handshake measurement. */
+typedef struct
+{
+    tls_benchmark_cert_t cert;
+    int ciphersuite;
+    mbedtls_ecp_group_id curve;
+} tls_benchmark_handshake_t;
+
+/* Handshake state reported as a phase of its own. */
+typedef struct
+{
+    int state;
+    const char *name;
+} tls_benchmark_phase_t;
+
+/* One direction of the memory transport. */
+typedef struct
+{
+    uint8_t data[TLS_BENCHMARK_PIPE_LEN];
+    size_t head;
+    size_t len;
+} tls_benchmark_pipe_t;
+
+/* Pipes of one side of the memory transport. */
+typedef struct
+{
+    tls_benchmark_pipe_t *tx;
+    tls_benchmark_pipe_t *rx;
+} tls_benchmark_link_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static void tls_benchmark_cycles_init(void);
+static uint32_t tls_benchmark_cycles(void);
+static int tls_benchmark_pipe_send(void *ctx, const unsigned char *buf, size_t len);
+static int tls_benchmark_pipe_recv(void *ctx, unsigned char *buf, size_t len);
+static int tls_benchmark_load_credentials(void);
+static int tls_benchmark_setup(tls_benchmark_cert_t cert, int ciphersuite,
+                               mbedtls_ecp_group_id curve);
+static void tls_benchmark_teardown(void);
+static int tls_benchmark_handshake(uint64_t *client_phases, uint64_t *server_phases);
+static int tls_benchmark_run_handshake(const tls_benchmark_handshake_t *test);
+static int tls_benchmark_run_records(int ciphersuite);
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* Server certificates measured by the handshake benchmark. The pre-shared
+ * key has no certificate.
+ */
+static const char *const tls_benchmark_cert_names[TLS_BENCHMARK_CERT_COUNT] =
+{
+    "RSA-2048", "ECDSA P-256", "PSK"
+};
+
+static const char *const tls_benchmark_ca_pem[TLS_BENCHMARK_CERT_COUNT] =
+{
+    keyBENCHMARK_RSA_CA_CERTIFICATE_PEM, keyBENCHMARK_ECDSA_CA_CERTIFICATE_PEM, NULL
+};
+
+static const char *const tls_benchmark_cert_pem[TLS_BENCHMARK_CERT_COUNT] =
+{
+    keyBENCHMARK_RSA_SERVER_CERTIFICATE_PEM, keyBENCHMARK_ECDSA_SERVER_CERTIFICATE_PEM, NULL
+};
+
+static const char *const tls_benchmark_key_pem[TLS_BENCHMARK_CERT_COUNT] =
+{
+    keyBENCHMARK_RSA_SERVER_PRIVATE_KEY_PEM, keyBENCHMARK_ECDSA_SERVER_PRIVATE_KEY_PEM, NULL
+};
+
+#if (TLS_BENCHMARK_PSK_SUPPORTED)
+/* Pre-shared key of both sides. */
+static const uint8_t tls_benchmark_psk[] = keyBENCHMARK_PSK;
+#endif
+
+/* Full handshakes, each with one server certificate or the pre-shared key, and
+ * one ECDHE curve. Plain PSK has no key exchange and so no curve.
+ */
+static const tls_benchmark_handshake_t tls_benchmark_handshakes[] =
+{
+    { TLS_BENCHMARK_CERT_RSA, MBEDTLS_TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256, MBEDTLS_ECP_DP_SECP256R1 },
+    { TLS_BENCHMARK_CERT_RSA, MBEDTLS_TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256, MBEDTLS_ECP_DP_CURVE25519 },
+    { TLS_BENCHMARK_CERT_RSA, MBEDTLS_TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256, MBEDTLS_ECP_DP_SECP384R1 },
+    { TLS_BENCHMARK_CERT_ECDSA, MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256, MBEDTLS_ECP_DP_SECP256R1 },
+    { TLS_BENCHMARK_CERT_ECDSA, MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256, MBEDTLS_ECP_DP_CURVE25519 },
+    { TLS_BENCHMARK_CERT_ECDSA, MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256, MBEDTLS_ECP_DP_SECP384R1 },
+    { TLS_BENCHMARK_CERT_PSK, MBEDTLS_TLS_PSK_WITH_AES_128_GCM_SHA256, MBEDTLS_ECP_DP_NONE },
+    { TLS_BENCHMARK_CERT_PSK, MBEDTLS_TLS_ECDHE_PSK_WITH_AES_128_CBC_SHA256, MBEDTLS_ECP_DP_SECP256R1 },
+    { TLS_BENCHMARK_CERT_PSK, MBEDTLS_TLS_ECDHE_PSK_WITH_AES_128_CBC_SHA256, MBEDTLS_ECP_DP_CURVE25519 },
+};
+
+/* Cipher suites measured by the record layer benchmark. */
+static const int tls_benchmark_record_suites[] =
+{
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256,
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_256_GCM_SHA384,
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_CCM,
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_CHACHA20_POLY1305_SHA256,
+};
+
+/* Application data sizes of the record layer benchmark. */
+static const uint32_t tls_benchmark_record_sizes[] =
+{
+    64u, 256u, 1024u, 4096u, 16384u
+};
+
+/* TLS 1.2 handshake states in the order they are processed. The cycles of any
+ * other state are reported as "Other".
+ */
+static const tls_benchmark_phase_t tls_benchmark_phases[] =
+{
+    { MBEDTLS_SSL_HELLO_REQUEST,             "HelloRequest" },
+    { MBEDTLS_SSL_CLIENT_HELLO,              "ClientHello" },
+    { MBEDTLS_SSL_SERVER_HELLO,              "ServerHello" },
+    { MBEDTLS_SSL_SERVER_CERTIFICATE,        "Certificate (server)" },
+    { MBEDTLS_SSL_SERVER_KEY_EXCHANGE,       "ServerKeyExchange" },
+    { MBEDTLS_SSL_CERTIFICATE_REQUEST,       "CertificateRequest" },
+    { MBEDTLS_SSL_SERVER_HELLO_DONE,         "ServerHelloDone" },
+    { MBEDTLS_SSL_CLIENT_CERTIFICATE,        "Certificate (client)" },
+    { MBEDTLS_SSL_CLIENT_KEY_EXCHANGE,       "ClientKeyExchange" },
+    { MBEDTLS_SSL_CERTIFICATE_VERIFY,        "CertificateVerify" },
+    { MBEDTLS_SSL_CLIENT_CHANGE_CIPHER_SPEC, "ChangeCipherSpec (client)" },
+    { MBEDTLS_SSL_CLIENT_FINISHED,           "Finished (client)" },
+    { MBEDTLS_SSL_SERVER_CHANGE_CIPHER_SPEC, "ChangeCipherSpec (server)" },
+    { MBEDTLS_SSL_SERVER_FINISHED,           "Finished (server)" },
+    { MBEDTLS_SSL_FLUSH_BUFFERS,             "Flush buffers" },
+    { MBEDTLS_SSL_HANDSHAKE_WRAPUP,          "Wrap-up" },
+};
+
+/* Credentials of both server certificate types. */
+static mbedtls_entropy_context tls_benchmark_entropy;
+static mbedtls_ctr_drbg_context tls_benchmark_drbg;
+static mbedtls_x509_crt tls_benchmark_ca_cert[TLS_BENCHMARK_CERT_COUNT];
+static mbedtls_x509_crt tls_benchmark_cert[TLS_BENCHMARK_CERT_COUNT];
+static mbedtls_pk_context tls_benchmark_key[TLS_BENCHMARK_CERT_COUNT];
+static bool tls_benchmark_cert_ready[TLS_BENCHMARK_CERT_COUNT];
+
+/* Client and server of the measurement in progress. */
+static mbedtls_ssl_config tls_benchmark_client_conf;
+static mbedtls_ssl_config tls_benchmark_server_conf;
+static mbedtls_ssl_context tls_benchmark_client;
+static mbedtls_ssl_context tls_benchmark_server;
+static int tls_benchmark_suite_list[2];
+#if (MBEDTLS_VERSION_NUMBER >= 0x03000000)
+static uint16_t tls_benchmark_group_list[3];
+#else
+static mbedtls_ecp_group_id tls_benchmark_curve_list[3];
+#endif
+
+/* Memory transport between the client and the server. */
+static tls_benchmark_pipe_t tls_benchmark_to_server;
+static tls_benchmark_pipe_t tls_benchmark_to_client;
+static tls_benchmark_link_t tls_benchmark_client_link =
+{
+    &tls_benchmark_to_server, &tls_benchmark_to_client
+};
+static tls_benchmark_link_t tls_benchmark_server_link =
+{
+    &tls_benchmark_to_client, &tls_benchmark_to_server
+};
+
+/* Application data of the record layer benchmark. */
+static uint8_t tls_benchmark_data[MBEDTLS_SSL_OUT_CONTENT_LEN];
+
+/* Cycles spent in each phase, summed over all handshakes of a measurement. */
+static uint64_t tls_benchmark_client_phases[TLS_BENCHMARK_COUNT(tls_benchmark_phases) + 1u];
+static uint64_t tls_benchmark_server_phases[TLS_BENCHMARK_COUNT(tls_benchmark_phases) + 1u];
+
+/*******************************************************************************
+ * Function Name: tls_benchmark_run
+ *******************************************************************************
+ * Summary:
+ *  Runs all handshake and record layer measurements and prints the results.
+ *  Measurements that need a feature disabled in the mbedTLS configuration are
+ *  skipped. The caller needs a stack of several kilobytes for the public key
+ *  operations, and about 100 KB of heap for the two TLS contexts.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  int: Number of measurements that failed.
+ *
+ *******************************************************************************/
+int tls_benchmark_run(void)
+{
+    int failed = 0;
+    size_t i;
+
+    tls_benchmark_cycles_init();
+
+    printf("TLS benchmark, %s, results in %s\n", MBEDTLS_VERSION_STRING_FULL,
+           TLS_BENCHMARK_UNIT);
+#if !defined(TLS_BENCHMARK_HOST)
+    printf("CPU clock: %"PRIu32" Hz\n", (uint32_t)SystemCoreClock);
+#endif
+
+    if (tls_benchmark_load_credentials() != 0)
+    {
+        return 1;
+    }
+
+    printf("\nHandshake: average of %u full handshakes, per state of each side\n",
+           (unsigned int)TLS_BENCHMARK_HANDSHAKES);
+    for (i = 0; i < TLS_BENCHMARK_COUNT(tls_benchmark_handshakes); i++)
+    {
+        failed += tls_benchmark_run_handshake(&tls_benchmark_handshakes[i]);
+    }
+
+    printf("\nRecord layer: average per record of at least %"PRIu32" bytes of data\n",
+           (uint32_t)TLS_BENCHMARK_RECORD_BYTES);
+    for (i = 0; i < TLS_BENCHMARK_COUNT(tls_benchmark_record_suites); i++)
+    {
+        failed += tls_benchmark_run_records(tls_benchmark_record_suites[i]);
+    }
+
+    for (i = 0; i < TLS_BENCHMARK_CERT_COUNT; i++)
+    {
+        mbedtls_x509_crt_free(&tls_benchmark_ca_cert[i]);
+        mbedtls_x509_crt_free(&tls_benchmark_cert[i]);
+        mbedtls_pk_free(&tls_benchmark_key[i]);
+    }
+    mbedtls_ctr_drbg_free(&tls_benchmark_drbg);
+    mbedtls_entropy_free(&tls_benchmark_entropy);
+
+    printf("\nTLS benchmark completed, %d measurement(s) failed\n", failed);
+
+    return failed;
+}
+
+/*******************************************************************************
+ * Function Name: tls_benchmark_cycles_init
+ *******************************************************************************
+ * Summary:
+ *  Starts the cycle counter of the DWT unit. Nothing is done on the host.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void tls_benchmark_cycles_init(void)
+{
+#if !defined(TLS_BENCHMARK_HOST)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0u;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: tls_benchmark_cycles
+ *******************************************************************************
+ * Summary:
+ *  Returns the free-running cycle counter. The difference of two readings is
+ *  correct across a wrap as long as it is below 2^32 counts.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  uint32_t: Counter value in TLS_BENCHMARK_UNIT.
+ *
+ *******************************************************************************/
+static uint32_t tls_benchmark_cycles(void)
+{
+#if !defined(TLS_BENCHMARK_HOST)
+    return DWT->CYCCNT;
+#elif defined(__x86_64__) || defined(__i386__)
+    return (uint32_t)__rdtsc();
+#else
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)(((uint64_t)now.tv_sec * 1000000000u) + (uint64_t)now.tv_nsec);
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: tls_benchmark_pipe_send
+ *******************************************************************************
+ * Summary:
+ *  mbedTLS send callback. Appends the data to the pipe towards the peer.
+ *
+ * Parameters:
+ *  void *ctx: Link of the sending side
+ *  const unsigned char *buf: Data to be sent
+ *  size_t len: Length of the data
+ *
+ * Return:
+ *  int: Number of bytes written, or MBEDTLS_ERR_SSL_WANT_WRITE if the pipe is
+ *       full.
+ *
+ *******************************************************************************/
+static int tls_benchmark_pipe_send(void *ctx, const unsigned char *buf, size_t len)
+{
+    tls_benchmark_pipe_t *pipe = ((tls_benchmark_link_t *)ctx)->tx;
+    size_t space;
+
+    /* Move the unread data to the start of the buffer. */
+    if ((pipe->head != 0u) && ((pipe->len + len) > sizeof(pipe->data)))
+    {
+        memmove(pipe->data, &pipe->data[pipe->head], pipe->len - pipe->head);
+        pipe->len -= pipe->head;
+        pipe->head = 0u;
+    }
+
+    space = sizeof(pipe->data) - pipe->len;
+    if (space == 0u)
+    {
+        return MBEDTLS_ERR_SSL_WANT_WRITE;
+    }
+
+    if (len > space)
+    {
+        len = space;
+    }
+    memcpy(&pipe->data[pipe->len], buf, len);
+    pipe->len += len;
+
+    return (int)len;
+}
+
+/*******************************************************************************
+ * Function Name: tls_benchmark_pipe_recv
+ *******************************************************************************
+ * Summary:
+ *  mbedTLS receive callback. Reads data from the pipe from the peer.
+ *
+ * Parameters:
+ *  void *ctx: Link of the receiving side
+ *  unsigned char *buf: Buffer for the data
+ *  size_t len: Size of the buffer
+ *
+ * Return:
+ *  int: Number of bytes read, or MBEDTLS_ERR_SSL_WANT_READ if the pipe is
+ *       empty.
+ *
+ *******************************************************************************/
+static int tls_benchmark_pipe_recv(void *ctx, unsigned char *buf, size_t len)
+{
+    tls_benchmark_pipe_t *pipe = ((tls_benchmark_link_t *)ctx)->rx;
+    size_t available = pipe->len - pipe->head;
+
+    if (available == 0u)
+    {
+        return MBEDTLS_ERR_SSL_WANT_READ;
+    }
+
+    if (len > available)
+    {
+        len = available;
+    }
+    memcpy(buf, &pipe->data[pipe->head], len);
+    pipe->head += len;
+
+    if (pipe->head == pipe->len)
+    {
+        pipe->head = 0u;
+        pipe->len = 0u;
+    }
+
+    return (int)len;
+}
+
+/*******************************************************************************
+ * Function Name: tls_benchmark_load_credentials
+ *******************************************************************************
+ * Summary:
+ *  Seeds the random number generator and parses the CA certificate, server
+ *  certificate and private key of each certificate type. A type that fails to
+ *  parse, for example because RSA is disabled, is skipped by the measurements,
+ *  as is the pre-shared key if no PSK key exchange is enabled.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  int: 0 on success, an mbedTLS error code otherwise.
+ *
+ *******************************************************************************/
+static int tls_benchmark_load_credentials(void)
+{
+    int ret;
+    size_t i;
+
+#if (MBEDTLS_VERSION_NUMBER >= 0x03000000) && defined(MBEDTLS_PSA_CRYPTO_C)
+    if (psa_crypto_init() != PSA_SUCCESS)
+    {
+        printf("psa_crypto_init failed!\n");
+        return -1;
+    }
+#endif
+
+    mbedtls_entropy_init(&tls_benchmark_entropy);
+    mbedtls_ctr_drbg_init(&tls_benchmark_drbg);
+
+    ret = mbedtls_ctr_drbg_seed(&tls_benchmark_drbg, mbedtls_entropy_func, &tls_benchmark_entropy,
+                                (const unsigned char *)TLS_BENCHMARK_DRBG_PERSONALIZATION,
+                                strlen(TLS_BENCHMARK_DRBG_PERSONALIZATION));
+    if (ret != 0)
+    {
+        printf("mbedtls_ctr_drbg_seed failed! Error: -0x%04"PRIx32"\n", (uint32_t)-ret);
+        return ret;
+    }
+
+    for (i = 0; i < TLS_BENCHMARK_CERT_COUNT; i++)
+    {
+        mbedtls_x509_crt_init(&tls_benchmark_ca_cert[i]);
+        mbedtls_x509_crt_init(&tls_benchmark_cert[i]);
+        mbedtls_pk_init(&tls_benchmark_key[i]);
+
+        if (i == TLS_BENCHMARK_CERT_PSK)
+        {
+            tls_benchmark_cert_ready[i] = (TLS_BENCHMARK_PSK_SUPPORTED != 0);
+            continue;
+        }
+
+        /* PEM buffers are parsed including the terminating null character. */
+        ret = mbedtls_x509_crt_parse(&tls_benchmark_ca_cert[i],
+                                     (const unsigned char *)tls_benchmark_ca_pem[i],
+                                     strlen(tls_benchmark_ca_pem[i]) + 1u);
+        if (ret == 0)
+        {
+            ret = mbedtls_x509_crt_parse(&tls_benchmark_cert[i],
+                                         (const unsigned char *)tls_benchmark_cert_pem[i],
+                                         strlen(tls_benchmark_cert_pem[i]) + 1u);
+        }
+        if (ret == 0)
+        {
+#if (MBEDTLS_VERSION_NUMBER >= 0x03000000)
+            ret = mbedtls_pk_parse_key(&tls_benchmark_key[i],
+                                       (const unsigned char *)tls_benchmark_key_pem[i],
+                                       strlen(tls_benchmark_key_pem[i]) + 1u, NULL, 0,
+                                       mbedtls_ctr_drbg_random, &tls_benchmark_drbg);
+#else
+            ret = mbedtls_pk_parse_key(&tls_benchmark_key[i],
+                                       (const unsigned char *)tls_benchmark_key_pem[i],
+                                       strlen(tls_benchmark_key_pem[i]) + 1u, NULL, 0);
+#endif
+        }
+
+        tls_benchmark_cert_ready[i] = (ret == 0);
+        if (ret != 0)
+        {
+            printf("%s credentials not supported by this configuration. Error: -0x%04"PRIx32"\n",
+                   tls_benchmark_cert_names[i], (uint32_t)-ret);
+        }
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: tls_benchmark_setup
+ *******************************************************************************
+ * Summary:
+ *  Sets up a TLS 1.2 client and server that offer only the given cipher suite
+ *  and prefer the given ECDHE curve, connected through the memory transport.
+ *  The client verifies the server certificate, including its host name, or
+ *  both sides use the pre-shared key.
+ *
+ * Parameters:
+ *  tls_benchmark_cert_t cert: Server certificate type, or TLS_BENCHMARK_CERT_PSK
+ *  int ciphersuite: Cipher suite to be negotiated
+ *  mbedtls_ecp_group_id curve: ECDHE curve to be negotiated, or
+ *                              MBEDTLS_ECP_DP_NONE for none
+ *
+ * Return:
+ *  int: 0 on success, an mbedTLS error code otherwise.
+ *
+ *******************************************************************************/
+static int tls_benchmark_setup(tls_benchmark_cert_t cert, int ciphersuite,
+                               mbedtls_ecp_group_id curve)
+{
+    const mbedtls_ecp_curve_info *p256 = mbedtls_ecp_curve_info_from_grp_id(MBEDTLS_ECP_DP_SECP256R1);
+    const mbedtls_ecp_curve_info *info = mbedtls_ecp_curve_info_from_grp_id(curve);
+    size_t n = 0;
+    int ret;
+
+    mbedtls_ssl_config_init(&tls_benchmark_client_conf);
+    mbedtls_ssl_config_init(&tls_benchmark_server_conf);
+    mbedtls_ssl_init(&tls_benchmark_client);
+    mbedtls_ssl_init(&tls_benchmark_server);
+    memset(&tls_benchmark_to_server, 0, sizeof(tls_benchmark_to_server));
+    memset(&tls_benchmark_to_client, 0, sizeof(tls_benchmark_to_client));
+
+    tls_benchmark_suite_list[0] = ciphersuite;
+    tls_benchmark_suite_list[1] = 0;
+
+    /* The server only selects an ECDSA certificate on a curve the client
+     * supports, so P-256 is offered after the measured curve if enabled.
+     */
+#if (MBEDTLS_VERSION_NUMBER >= 0x03000000)
+    if (info != NULL)
+    {
+        tls_benchmark_group_list[n++] = info->tls_id;
+    }
+    if (p256 != NULL)
+    {
+        tls_benchmark_group_list[n++] = p256->tls_id;
+    }
+    tls_benchmark_group_list[n] = 0u;
+#else
+    if (info != NULL)
+    {
+        tls_benchmark_curve_list[n++] = curve;
+    }
+    if (p256 != NULL)
+    {
+        tls_benchmark_curve_list[n++] = MBEDTLS_ECP_DP_SECP256R1;
+    }
+    tls_benchmark_curve_list[n] = MBEDTLS_ECP_DP_NONE;
+#endif
+
+    ret = mbedtls_ssl_config_defaults(&tls_benchmark_client_conf, MBEDTLS_SSL_IS_CLIENT,
+                                      MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT);
+    if (ret == 0)
+    {
+        ret = mbedtls_ssl_config_defaults(&tls_benchmark_server_conf, MBEDTLS_SSL_IS_SERVER,
+                                          MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT);
+    }
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    mbedtls_ssl_conf_rng(&tls_benchmark_client_conf, mbedtls_ctr_drbg_random, &tls_benchmark_drbg);
+    mbedtls_ssl_conf_rng(&tls_benchmark_server_conf, mbedtls_ctr_drbg_random, &tls_benchmark_drbg);
+#if (MBEDTLS_VERSION_NUMBER >= 0x03000000)
+    mbedtls_ssl_conf_max_tls_version(&tls_benchmark_client_conf, MBEDTLS_SSL_VERSION_TLS1_2);
+    mbedtls_ssl_conf_max_tls_version(&tls_benchmark_server_conf, MBEDTLS_SSL_VERSION_TLS1_2);
+    mbedtls_ssl_conf_groups(&tls_benchmark_client_conf, tls_benchmark_group_list);
+    mbedtls_ssl_conf_groups(&tls_benchmark_server_conf, tls_benchmark_group_list);
+#else
+    mbedtls_ssl_conf_max_version(&tls_benchmark_client_conf, MBEDTLS_SSL_MAJOR_VERSION_3,
+                                 MBEDTLS_SSL_MINOR_VERSION_3);
+    mbedtls_ssl_conf_max_version(&tls_benchmark_server_conf, MBEDTLS_SSL_MAJOR_VERSION_3,
+                                 MBEDTLS_SSL_MINOR_VERSION_3);
+    mbedtls_ssl_conf_curves(&tls_benchmark_client_conf, tls_benchmark_curve_list);
+    mbedtls_ssl_conf_curves(&tls_benchmark_server_conf, tls_benchmark_curve_list);
+#endif
+    mbedtls_ssl_conf_ciphersuites(&tls_benchmark_client_conf, tls_benchmark_suite_list);
+    mbedtls_ssl_conf_ciphersuites(&tls_benchmark_server_conf, tls_benchmark_suite_list);
+
+    mbedtls_ssl_conf_authmode(&tls_benchmark_server_conf, MBEDTLS_SSL_VERIFY_NONE);
+    if (cert == TLS_BENCHMARK_CERT_PSK)
+    {
+#if (TLS_BENCHMARK_PSK_SUPPORTED)
+        ret = mbedtls_ssl_conf_psk(&tls_benchmark_client_conf, tls_benchmark_psk,
+                                   sizeof(tls_benchmark_psk),
+                                   (const unsigned char *)BENCHMARK_PSK_IDENTITY,
+                                   strlen(BENCHMARK_PSK_IDENTITY));
+        if (ret == 0)
+        {
+            ret = mbedtls_ssl_conf_psk(&tls_benchmark_server_conf, tls_benchmark_psk,
+                                       sizeof(tls_benchmark_psk),
+                                       (const unsigned char *)BENCHMARK_PSK_IDENTITY,
+                                       strlen(BENCHMARK_PSK_IDENTITY));
+        }
+#else
+        ret = MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+#endif
+    }
+    else
+    {
+        mbedtls_ssl_conf_authmode(&tls_benchmark_client_conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+        mbedtls_ssl_conf_ca_chain(&tls_benchmark_client_conf, &tls_benchmark_ca_cert[cert], NULL);
+        ret = mbedtls_ssl_conf_own_cert(&tls_benchmark_server_conf, &tls_benchmark_cert[cert],
+                                        &tls_benchmark_key[cert]);
+    }
+    if (ret == 0)
+    {
+        ret = mbedtls_ssl_setup(&tls_benchmark_client, &tls_benchmark_client_conf);
+    }
+    if (ret == 0)
+    {
+        ret = mbedtls_ssl_setup(&tls_benchmark_server, &tls_benchmark_server_conf);
+    }
+    if (ret == 0)
+    {
+        ret = mbedtls_ssl_set_hostname(&tls_benchmark_client, BENCHMARK_SERVER_HOSTNAME);
+    }
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    mbedtls_ssl_set_bio(&tls_benchmark_client, &tls_benchmark_client_link,
+                        tls_benchmark_pipe_send, tls_benchmark_pipe_recv, NULL);
+    mbedtls_ssl_set_bio(&tls_benchmark_server, &tls_benchmark_server_link,
+                        tls_benchmark_pipe_send, tls_benchmark_pipe_recv, NULL);
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: tls_benchmark_teardown
+ *******************************************************************************
+ * Summary:
+ *  Frees the client and server set up by tls_benchmark_setup().
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void tls_benchmark_teardown(void)
+{
+    mbedtls_ssl_free(&tls_benchmark_client);
+    mbedtls_ssl_free(&tls_benchmark_server);
+    mbedtls_ssl_config_free(&tls_benchmark_client_conf);
+    mbedtls_ssl_config_free(&tls_benchmark_server_conf);
+}
+
+/*******************************************************************************
+ * Function Name: tls_benchmark_handshake
+ *******************************************************************************
+ * Summary:
+ *  Performs the handshake between the client and the server, stepping each
+ *  side in turn. The cycles of each step are added to the phase of the state
+ *  the side was in before the step, which is the message it writes or parses.
+ *
+ * Parameters:
+ *  uint64_t *client_phases: Cycles per phase of the client, or NULL
+ *  uint64_t *server_phases: Cycles per phase of the server, or NULL
+ *
+ * Return:
+ *  int: 0 on success, an mbedTLS error code otherwise.
+ *
+ *******************************************************************************/
+static int tls_benchmark_handshake(uint64_t *client_phases, uint64_t *server_phases)
+{
+    mbedtls_ssl_context *side[2] = { &tls_benchmark_client, &tls_benchmark_server };
+    uint64_t *phases[2] = { client_phases, server_phases };
+    uint32_t steps = 0;
+    uint32_t start;
+    size_t phase;
+    size_t i;
+    int ret;
+
+    while ((tls_benchmark_client.TLS_BENCHMARK_FIELD(state) != MBEDTLS_SSL_HANDSHAKE_OVER) ||
+           (tls_benchmark_server.TLS_BENCHMARK_FIELD(state) != MBEDTLS_SSL_HANDSHAKE_OVER))
+    {
+        if (++steps > TLS_BENCHMARK_MAX_STEPS)
+        {
+            return MBEDTLS_ERR_SSL_INTERNAL_ERROR;
+        }
+
+        for (i = 0; i < 2u; i++)
+        {
+            if (side[i]->TLS_BENCHMARK_FIELD(state) == MBEDTLS_SSL_HANDSHAKE_OVER)
+            {
+                continue;
+            }
+
+            for (phase = 0; phase < TLS_BENCHMARK_COUNT(tls_benchmark_phases); phase++)
+            {
+                if (tls_benchmark_phases[phase].state == side[i]->TLS_BENCHMARK_FIELD(state))
+                {
+                    break;
+                }
+            }
+
+            start = tls_benchmark_cycles();
+            ret = mbedtls_ssl_handshake_step(side[i]);
+            if (phases[i] != NULL)
+            {
+                phases[i][phase] += (uint32_t)(tls_benchmark_cycles() - start);
+            }
+
+            if ((ret != 0) && (ret != MBEDTLS_ERR_SSL_WANT_READ) &&
+                (ret != MBEDTLS_ERR_SSL_WANT_WRITE))
+            {
+                return ret;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: tls_benchmark_run_handshake
+ *******************************************************************************
+ * Summary:
+ *  Measures TLS_BENCHMARK_HANDSHAKES full handshakes with the given server
+ *  certificate, cipher suite and ECDHE curve and prints the average cycles of
+ *  each phase. Setting up the contexts is not included.
+ *
+ * Parameters:
+ *  const tls_benchmark_handshake_t *test: Handshake to be measured
+ *
+ * Return:
+ *  int: 1 if the measurement failed, 0 otherwise.
+ *
+ *******************************************************************************/
+static int tls_benchmark_run_handshake(const tls_benchmark_handshake_t *test)
+{
+    const mbedtls_ecp_curve_info *curve = mbedtls_ecp_curve_info_from_grp_id(test->curve);
+    uint64_t client_total = 0;
+    uint64_t server_total = 0;
+    size_t phase;
+    uint32_t i;
+    int ret = 0;
+
+    printf("\n%s, %s, %s\n", tls_benchmark_cert_names[test->cert],
+           (curve != NULL) ? curve->name :
+           ((test->curve == MBEDTLS_ECP_DP_NONE) ? "no ECDHE" : "curve disabled"),
+           mbedtls_ssl_get_ciphersuite_name(test->ciphersuite));
+
+    if ((!tls_benchmark_cert_ready[test->cert]) ||
+        ((curve == NULL) && (test->curve != MBEDTLS_ECP_DP_NONE)) ||
+        (mbedtls_ssl_ciphersuite_from_id(test->ciphersuite) == NULL))
+    {
+        printf("  Skipped, not enabled in the mbedTLS configuration\n");
+        return 0;
+    }
+
+    memset(tls_benchmark_client_phases, 0, sizeof(tls_benchmark_client_phases));
+    memset(tls_benchmark_server_phases, 0, sizeof(tls_benchmark_server_phases));
+
+    for (i = 0; (i < TLS_BENCHMARK_HANDSHAKES) && (ret == 0); i++)
+    {
+        ret = tls_benchmark_setup(test->cert, test->ciphersuite, test->curve);
+        if (ret == 0)
+        {
+            ret = tls_benchmark_handshake(tls_benchmark_client_phases,
+                                          tls_benchmark_server_phases);
+        }
+        tls_benchmark_teardown();
+    }
+
+    if (ret != 0)
+    {
+        printf("  Handshake failed! Error: -0x%04"PRIx32"\n", (uint32_t)-ret);
+        return 1;
+    }
+
+    printf("  %-28s %14s %14s\n", "Phase", "Client", "Server");
+    for (phase = 0; phase <= TLS_BENCHMARK_COUNT(tls_benchmark_phases); phase++)
+    {
+        client_total += tls_benchmark_client_phases[phase];
+        server_total += tls_benchmark_server_phases[phase];
+
+        if ((tls_benchmark_client_phases[phase] == 0u) && (tls_benchmark_server_phases[phase] == 0u))
+        {
+            continue;
+        }
+
+        printf("  %-28s %14"PRIu32" %14"PRIu32"\n",
+               (phase < TLS_BENCHMARK_COUNT(tls_benchmark_phases)) ?
+               tls_benchmark_phases[phase].name : "Other",
+               (uint32_t)(tls_benchmark_client_phases[phase] / TLS_BENCHMARK_HANDSHAKES),
+               (uint32_t)(tls_benchmark_server_phases[phase] / TLS_BENCHMARK_HANDSHAKES));
+    }
+    printf("  %-28s %14"PRIu32" %14"PRIu32"\n", "Total",
+           (uint32_t)(client_total / TLS_BENCHMARK_HANDSHAKES),
+           (uint32_t)(server_total / TLS_BENCHMARK_HANDSHAKES));
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: tls_benchmark_run_records
+ *******************************************************************************
+ * Summary:
+ *  Establishes a connection with the given cipher suite, then measures the
+ *  client encrypting and the server decrypting records of each size in
+ *  tls_benchmark_record_sizes. Sizes above the maximum record payload of the
+ *  configuration are skipped.
+ *
+ * Parameters:
+ *  int ciphersuite: Cipher suite to be measured
+ *
+ * Return:
+ *  int: 1 if the measurement failed, 0 otherwise.
+ *
+ *******************************************************************************/
+static int tls_benchmark_run_records(int ciphersuite)
+{
+    uint64_t encrypt;
+    uint64_t decrypt;
+    uint32_t records;
+    uint32_t size;
+    uint32_t start;
+    uint32_t i;
+    size_t n;
+    int max_payload;
+    int ret;
+
+    printf("\n%s\n", mbedtls_ssl_get_ciphersuite_name(ciphersuite));
+
+    if ((!tls_benchmark_cert_ready[TLS_BENCHMARK_CERT_ECDSA]) ||
+        (mbedtls_ssl_ciphersuite_from_id(ciphersuite) == NULL))
+    {
+        printf("  Skipped, not enabled in the mbedTLS configuration\n");
+        return 0;
+    }
+
+    ret = tls_benchmark_setup(TLS_BENCHMARK_CERT_ECDSA, ciphersuite, MBEDTLS_ECP_DP_SECP256R1);
+    if (ret == 0)
+    {
+        ret = tls_benchmark_handshake(NULL, NULL);
+    }
+    if (ret != 0)
+    {
+        printf("  Handshake failed! Error: -0x%04"PRIx32"\n", (uint32_t)-ret);
+        tls_benchmark_teardown();
+        return 1;
+    }
+
+    max_payload = mbedtls_ssl_get_max_out_record_payload(&tls_benchmark_client);
+    if (max_payload > MBEDTLS_SSL_IN_CONTENT_LEN)
+    {
+        max_payload = MBEDTLS_SSL_IN_CONTENT_LEN;
+    }
+
+    printf("  %8s %16s %12s %16s %12s\n", "Bytes", "Encrypt/record", "Encrypt/byte",
+           "Decrypt/record", "Decrypt/byte");
+    for (n = 0; n < TLS_BENCHMARK_COUNT(tls_benchmark_record_sizes); n++)
+    {
+        size = tls_benchmark_record_sizes[n];
+        if ((max_payload < 0) || (size > (uint32_t)max_payload))
+        {
+            printf("  %8"PRIu32" skipped, above the maximum record payload\n", size);
+            continue;
+        }
+
+        records = TLS_BENCHMARK_RECORD_BYTES / size;
+        if (records < TLS_BENCHMARK_MIN_RECORDS)
+        {
+            records = TLS_BENCHMARK_MIN_RECORDS;
+        }
+
+        encrypt = 0u;
+        decrypt = 0u;
+        for (i = 0; i < records; i++)
+        {
+            start = tls_benchmark_cycles();
+            ret = mbedtls_ssl_write(&tls_benchmark_client, tls_benchmark_data, size);
+            encrypt += (uint32_t)(tls_benchmark_cycles() - start);
+            if (ret != (int)size)
+            {
+                break;
+            }
+
+            start = tls_benchmark_cycles();
+            ret = mbedtls_ssl_read(&tls_benchmark_server, tls_benchmark_data, size);
+            decrypt += (uint32_t)(tls_benchmark_cycles() - start);
+            if (ret != (int)size)
+            {
+                break;
+            }
+        }
+
+        if (i < records)
+        {
+            printf("  %8"PRIu32" failed! Error: -0x%04"PRIx32"\n", size,
+                   (ret < 0) ? (uint32_t)-ret : 0u);
+            tls_benchmark_teardown();
+            return 1;
+        }
+
+        /* Cycles per byte are printed with two decimals. */
+        printf("  %8"PRIu32" %16"PRIu32" %9"PRIu32".%02"PRIu32" %16"PRIu32" %9"PRIu32".%02"PRIu32"\n",
+               size,
+               (uint32_t)(encrypt / records),
+               (uint32_t)((encrypt * 100u) / ((uint64_t)records * size) / 100u),
+               (uint32_t)((encrypt * 100u) / ((uint64_t)records * size) % 100u),
+               (uint32_t)(decrypt / records),
+               (uint32_t)((decrypt * 100u) / ((uint64_t)records * size) / 100u),
+               (uint32_t)((decrypt * 100u) / ((uint64_t)records * size) % 100u));
+    }
+
+    tls_benchmark_teardown();
+
+    return 0;
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,74 @@
+/******************************************************************************
+* File Name:   tls_benchmark.h
+*
+* Description: This file contains declarations of the TLS benchmark, which
+*              measures the cost of each handshake phase and the throughput of
+*              the record layer. The same source builds for the target and for
+*              the host (see host-tls-benchmark).
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef TLS_BENCHMARK_H_
+#define TLS_BENCHMARK_H_
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Number of full handshakes measured for each combination of certificate and
+ * key exchange curve. The reported cycles are the average over all of them.
+ */
+#ifndef TLS_BENCHMARK_HANDSHAKES
+#define TLS_BENCHMARK_HANDSHAKES                  (3u)
+#endif
+
+/* Amount of application data encrypted and decrypted at each record size. */
+#ifndef TLS_BENCHMARK_RECORD_BYTES
+#define TLS_BENCHMARK_RECORD_BYTES                (64u * 1024u)
+#endif
+
+/* Minimum number of records measured at each record size. */
+#define TLS_BENCHMARK_MIN_RECORDS                 (8u)
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+int tls_benchmark_run(void);
+
+#endif /* TLS_BENCHMARK_H_ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,753 @@
+/******************************************************************************
+* File Name:   tls_client.c
+*
+* Description: This file contains the TLS layer the secure TCP client runs
+*              directly on mbedTLS over a plain TCP socket. The secure socket
+*              library negotiates a new session on every connection; running
+*              the TLS layer here lets the client offer the session of its
+*              previous connection (see tls_session_store.c), so that a
+*              reconnect costs an abbreviated handshake without certificate
+*              verification and key exchange.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* FreeRTOS header files */
+#include <FreeRTOS.h>
+#include <task.h>
+
+/* Standard C header files */
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+/* mbedTLS header files */
+#include "mbedtls/version.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/x509_crt.h"
+#include "mbedtls/pk.h"
+#include "mbedtls/ssl_ciphersuites.h"
+
+/* TLS layer and session store header files */
+#include "tls_client.h"
+#include "tls_session_store.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Personalization string of the random number generator. */
+#define TLS_CLIENT_DRBG_PERSONALIZATION                "secure_tcp_client"
+
+/* The context fields are private from mbedTLS 3.0 on. */
+#if (MBEDTLS_VERSION_NUMBER >= 0x03000000)
+#define TLS_CLIENT_FIELD(field)                        MBEDTLS_PRIVATE(field)
+#else
+#define TLS_CLIENT_FIELD(field)                        field
+#endif
+
+/* mbedTLS 2.16 and later can parse a DER certificate without copying it. */
+#if (MBEDTLS_VERSION_NUMBER >= 0x02100000)
+#define TLS_CLIENT_CRT_PARSE_DER_NOCOPY                (1)
+#else
+#define TLS_CLIENT_CRT_PARSE_DER_NOCOPY                (0)
+#endif
+
+/* Pre-shared keys can only be used if mbedTLS has a PSK key exchange. */
+#if defined(MBEDTLS_KEY_EXCHANGE_PSK_ENABLED) || defined(MBEDTLS_KEY_EXCHANGE_ECDHE_PSK_ENABLED)
+#define TLS_CLIENT_PSK_SUPPORTED                       (1)
+#else
+#define TLS_CLIENT_PSK_SUPPORTED                       (0)
+#endif
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static int tls_client_bio_send(void *ctx, const unsigned char *buf, size_t len);
+static int tls_client_bio_recv(void *ctx, unsigned char *buf, size_t len);
+static cy_rslt_t tls_client_to_rslt(int ret);
+static cy_rslt_t tls_client_setup(void);
+static int tls_client_parse_cert(mbedtls_x509_crt *crt, const uint8_t *buf, size_t len);
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* TLS configuration shared by all connections. */
+static mbedtls_ssl_config tls_client_conf;
+static mbedtls_entropy_context tls_client_entropy;
+static mbedtls_ctr_drbg_context tls_client_drbg;
+static mbedtls_x509_crt tls_client_cert;
+static mbedtls_x509_crt tls_client_ca_cert;
+static mbedtls_pk_context tls_client_key;
+
+/* Handshake counters and timing. */
+static tls_client_stats_t tls_client_stats;
+
+#if (TLS_CLIENT_PSK_SUPPORTED)
+/* PSK cipher suites in order of preference. ECDHE-PSK gives forward secrecy
+ * at the cost of an ECDH key exchange; plain PSK needs no public-key
+ * operation at all.
+ */
+static const int tls_client_psk_candidates[] =
+{
+#if (TLS_CLIENT_PSK_USE_ECDHE)
+    MBEDTLS_TLS_ECDHE_PSK_WITH_CHACHA20_POLY1305_SHA256,
+    MBEDTLS_TLS_ECDHE_PSK_WITH_AES_128_CBC_SHA256,
+#else
+    MBEDTLS_TLS_PSK_WITH_AES_128_GCM_SHA256,
+    MBEDTLS_TLS_PSK_WITH_AES_128_CCM,
+    MBEDTLS_TLS_PSK_WITH_AES_128_CBC_SHA256,
+#endif
+};
+
+/* Enabled PSK cipher suites, terminated by 0. */
+static int tls_client_psk_suites[(sizeof(tls_client_psk_candidates) / sizeof(tls_client_psk_candidates[0])) + 1];
+#endif /* TLS_CLIENT_PSK_SUPPORTED */
+
+/*******************************************************************************
+ * Function Name: tls_client_init
+ *******************************************************************************
+ * Summary:
+ *  Parses the client credentials, sets up the TLS configuration shared by all
+ *  connections and restores the session kept across reset, if any. PEM buffers
+ *  must include the terminating null character in their length. DER
+ *  certificates are parsed in place, so their buffers must stay valid while
+ *  the client runs, as arrays in flash do.
+ *
+ * Parameters:
+ *  const uint8_t *cert: Client certificate (PEM or DER)
+ *  size_t cert_len: Length of the client certificate
+ *  const uint8_t *key: Client private key (PEM or DER)
+ *  size_t key_len: Length of the client private key
+ *  const uint8_t *ca_cert: Root CA certificate of the server (PEM or DER)
+ *  size_t ca_cert_len: Length of the root CA certificate
+ *
+ * Return:
+ *  cy_rslt_t: CY_RSLT_SUCCESS on success, CY_RSLT_TYPE_ERROR otherwise.
+ *
+ *******************************************************************************/
+cy_rslt_t tls_client_init(const uint8_t *cert, size_t cert_len,
+                          const uint8_t *key, size_t key_len,
+                          const uint8_t *ca_cert, size_t ca_cert_len)
+{
+    int ret;
+
+    if (tls_client_setup() != CY_RSLT_SUCCESS)
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    mbedtls_x509_crt_init(&tls_client_cert);
+    mbedtls_x509_crt_init(&tls_client_ca_cert);
+    mbedtls_pk_init(&tls_client_key);
+
+    ret = tls_client_parse_cert(&tls_client_cert, cert, cert_len);
+    if (ret != 0)
+    {
+        printf("Failed to parse the client certificate! Error: -0x%04"PRIx32"\n", (uint32_t)-ret);
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    ret = tls_client_parse_cert(&tls_client_ca_cert, ca_cert, ca_cert_len);
+    if (ret != 0)
+    {
+        printf("Failed to parse the root CA certificate! Error: -0x%04"PRIx32"\n", (uint32_t)-ret);
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+#if (MBEDTLS_VERSION_NUMBER >= 0x03000000)
+    ret = mbedtls_pk_parse_key(&tls_client_key, key, key_len, NULL, 0,
+                               mbedtls_ctr_drbg_random, &tls_client_drbg);
+#else
+    ret = mbedtls_pk_parse_key(&tls_client_key, key, key_len, NULL, 0);
+#endif
+    if (ret != 0)
+    {
+        printf("Failed to parse the client private key! Error: -0x%04"PRIx32"\n", (uint32_t)-ret);
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    mbedtls_ssl_conf_authmode(&tls_client_conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+    mbedtls_ssl_conf_ca_chain(&tls_client_conf, &tls_client_ca_cert, NULL);
+
+    ret = mbedtls_ssl_conf_own_cert(&tls_client_conf, &tls_client_cert, &tls_client_key);
+    if (ret != 0)
+    {
+        printf("mbedtls_ssl_conf_own_cert failed! Error: -0x%04"PRIx32"\n", (uint32_t)-ret);
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: tls_client_init_psk
+ *******************************************************************************
+ * Summary:
+ *  Sets up the TLS configuration shared by all connections to authenticate
+ *  with a pre-shared key instead of certificates, and restores the session
+ *  kept across reset, if any. The server looks the key up by the identity.
+ *  TLS_CLIENT_PSK_USE_ECDHE selects the ECDHE-PSK or the plain PSK cipher
+ *  suites; only those enabled in the mbedTLS configuration are offered.
+ *
+ * Parameters:
+ *  const char *identity: PSK identity of the client
+ *  const uint8_t *key: Pre-shared key
+ *  size_t key_len: Length of the pre-shared key
+ *
+ * Return:
+ *  cy_rslt_t: CY_RSLT_SUCCESS on success, CY_RSLT_TYPE_ERROR otherwise.
+ *
+ *******************************************************************************/
+cy_rslt_t tls_client_init_psk(const char *identity, const uint8_t *key, size_t key_len)
+{
+#if (TLS_CLIENT_PSK_SUPPORTED)
+    size_t n = 0;
+    size_t i;
+    int ret;
+
+    if (tls_client_setup() != CY_RSLT_SUCCESS)
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    /* Offer only the cipher suites that are compiled in. */
+    for (i = 0; i < (sizeof(tls_client_psk_candidates) / sizeof(tls_client_psk_candidates[0])); i++)
+    {
+        if (mbedtls_ssl_ciphersuite_from_id(tls_client_psk_candidates[i]) != NULL)
+        {
+            tls_client_psk_suites[n++] = tls_client_psk_candidates[i];
+        }
+    }
+    tls_client_psk_suites[n] = 0;
+
+    if (n == 0)
+    {
+        printf("No %s cipher suite is enabled in the mbedTLS configuration!\n",
+               (TLS_CLIENT_PSK_USE_ECDHE) ? "ECDHE-PSK" : "PSK");
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    mbedtls_ssl_conf_ciphersuites(&tls_client_conf, tls_client_psk_suites);
+
+    ret = mbedtls_ssl_conf_psk(&tls_client_conf, key, key_len,
+                               (const unsigned char *)identity, strlen(identity));
+    if (ret != 0)
+    {
+        printf("mbedtls_ssl_conf_psk failed! Error: -0x%04"PRIx32"\n", (uint32_t)-ret);
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    return CY_RSLT_SUCCESS;
+#else
+    (void)identity;
+    (void)key;
+    (void)key_len;
+
+    printf("The PSK key exchanges are disabled in the mbedTLS configuration!\n");
+    return CY_RSLT_TYPE_ERROR;
+#endif /* TLS_CLIENT_PSK_SUPPORTED */
+}
+
+/*******************************************************************************
+ * Function Name: tls_client_setup
+ *******************************************************************************
+ * Summary:
+ *  Sets up the part of the TLS configuration that does not depend on how the
+ *  peers authenticate: the random number generator and session tickets. Also
+ *  restores the session kept across reset, if any.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  cy_rslt_t: CY_RSLT_SUCCESS on success, CY_RSLT_TYPE_ERROR otherwise.
+ *
+ *******************************************************************************/
+static cy_rslt_t tls_client_setup(void)
+{
+    int ret;
+
+    mbedtls_ssl_config_init(&tls_client_conf);
+    mbedtls_entropy_init(&tls_client_entropy);
+    mbedtls_ctr_drbg_init(&tls_client_drbg);
+
+    ret = mbedtls_ctr_drbg_seed(&tls_client_drbg, mbedtls_entropy_func, &tls_client_entropy,
+                                (const unsigned char *)TLS_CLIENT_DRBG_PERSONALIZATION,
+                                strlen(TLS_CLIENT_DRBG_PERSONALIZATION));
+    if (ret != 0)
+    {
+        printf("mbedtls_ctr_drbg_seed failed! Error: -0x%04"PRIx32"\n", (uint32_t)-ret);
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    ret = mbedtls_ssl_config_defaults(&tls_client_conf, MBEDTLS_SSL_IS_CLIENT,
+                                      MBEDTLS_SSL_TRANSPORT_STREAM,
+                                      MBEDTLS_SSL_PRESET_DEFAULT);
+    if (ret != 0)
+    {
+        printf("mbedtls_ssl_config_defaults failed! Error: -0x%04"PRIx32"\n", (uint32_t)-ret);
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    mbedtls_ssl_conf_rng(&tls_client_conf, mbedtls_ctr_drbg_random, &tls_client_drbg);
+
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+    /* Accept a session ticket, so that the server need not keep the session. */
+    mbedtls_ssl_conf_session_tickets(&tls_client_conf, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
+
+    tls_session_store_init();
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: tls_client_handshake
+ *******************************************************************************
+ * Summary:
+ *  Performs the TLS handshake on a connected socket, offering the stored
+ *  session of the same server. The handshake is full if it passes the server
+ *  certificate step, which the PSK suites pass without a certificate, and
+ *  resumed otherwise. The new session is stored and the handshake time is
+ *  printed. The socket receive timeout must be short, as the handshake is
+ *  driven by polling the socket until TLS_CLIENT_HANDSHAKE_TIMEOUT_MS expires.
+ *
+ * Parameters:
+ *  tls_client_conn_t *conn: Connection to be set up
+ *  cy_socket_t socket: Connected TCP socket
+ *  const cy_socket_sockaddr_t *server: Address of the TCP server
+ *
+ * Return:
+ *  cy_rslt_t: Result of the operation.
+ *
+ *******************************************************************************/
+cy_rslt_t tls_client_handshake(tls_client_conn_t *conn, cy_socket_t socket,
+                               const cy_socket_sockaddr_t *server)
+{
+    TickType_t start = xTaskGetTickCount();
+    mbedtls_ssl_session session;
+    bool offered = false;
+    bool full = false;
+    uint32_t elapsed_ms;
+    int ret = 0;
+
+    conn->socket = socket;
+    conn->established = false;
+
+    mbedtls_ssl_init(&conn->ssl);
+    ret = mbedtls_ssl_setup(&conn->ssl, &tls_client_conf);
+    if (ret != 0)
+    {
+        printf("mbedtls_ssl_setup failed! Error: -0x%04"PRIx32"\n", (uint32_t)-ret);
+        mbedtls_ssl_free(&conn->ssl);
+        tls_client_stats.failed++;
+        return tls_client_to_rslt(ret);
+    }
+    mbedtls_ssl_set_bio(&conn->ssl, socket, tls_client_bio_send, tls_client_bio_recv, NULL);
+
+    /* Offer the session of the previous connection to this server. */
+    mbedtls_ssl_session_init(&session);
+    if (tls_session_store_load(server, &session))
+    {
+        offered = (mbedtls_ssl_set_session(&conn->ssl, &session) == 0);
+    }
+    mbedtls_ssl_session_free(&session);
+
+    while (conn->ssl.TLS_CLIENT_FIELD(state) != MBEDTLS_SSL_HANDSHAKE_OVER)
+    {
+        ret = mbedtls_ssl_handshake_step(&conn->ssl);
+
+        /* A resumed handshake goes from the server hello straight to the
+         * change cipher spec message. */
+        if (conn->ssl.TLS_CLIENT_FIELD(state) == MBEDTLS_SSL_SERVER_CERTIFICATE)
+        {
+            full = true;
+        }
+
+        if (ret == 0)
+        {
+            continue;
+        }
+
+        if ((ret != MBEDTLS_ERR_SSL_WANT_READ) && (ret != MBEDTLS_ERR_SSL_WANT_WRITE))
+        {
+            break;
+        }
+
+        if ((xTaskGetTickCount() - start) >= pdMS_TO_TICKS(TLS_CLIENT_HANDSHAKE_TIMEOUT_MS))
+        {
+            ret = MBEDTLS_ERR_SSL_TIMEOUT;
+            break;
+        }
+    }
+
+    elapsed_ms = (uint32_t)((xTaskGetTickCount() - start) * portTICK_PERIOD_MS);
+
+    if (ret != 0)
+    {
+        printf("TLS handshake failed after %"PRIu32" ms! Error: -0x%04"PRIx32"\n",
+               elapsed_ms, (uint32_t)-ret);
+        mbedtls_ssl_free(&conn->ssl);
+        tls_client_stats.failed++;
+
+        /* Do not offer a session again that may have caused the failure. */
+        if (offered)
+        {
+            tls_session_store_clear();
+        }
+        return tls_client_to_rslt(ret);
+    }
+
+    conn->established = true;
+
+    if (full)
+    {
+        tls_client_stats.full++;
+        tls_client_stats.full_time_ms += elapsed_ms;
+    }
+    else
+    {
+        tls_client_stats.resumed++;
+        tls_client_stats.resumed_time_ms += elapsed_ms;
+    }
+    printf("TLS handshake (%s) completed in %"PRIu32" ms\n",
+           full ? "full" : "resumed", elapsed_ms);
+
+    /* Store the session, which may carry a new ticket even if resumed. */
+    mbedtls_ssl_session_init(&session);
+    if (mbedtls_ssl_get_session(&conn->ssl, &session) == 0)
+    {
+        tls_session_store_save(server, &session);
+    }
+    mbedtls_ssl_session_free(&session);
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: tls_client_send
+ *******************************************************************************
+ * Summary:
+ *  Sends data over an established connection.
+ *
+ * Parameters:
+ *  tls_client_conn_t *conn: Connection
+ *  const void *data: Data to be sent
+ *  uint32_t length: Length of the data
+ *  uint32_t *bytes_sent: Number of bytes sent
+ *
+ * Return:
+ *  cy_rslt_t: Result of the operation.
+ *
+ *******************************************************************************/
+cy_rslt_t tls_client_send(tls_client_conn_t *conn, const void *data, uint32_t length,
+                          uint32_t *bytes_sent)
+{
+    const unsigned char *buf = (const unsigned char *)data;
+    int ret = 0;
+
+    *bytes_sent = 0;
+
+    if (!conn->established)
+    {
+        return CY_RSLT_MODULE_SECURE_SOCKETS_CLOSED;
+    }
+
+    while (*bytes_sent < length)
+    {
+        ret = mbedtls_ssl_write(&conn->ssl, &buf[*bytes_sent], length - *bytes_sent);
+        if (ret > 0)
+        {
+            *bytes_sent += (uint32_t)ret;
+        }
+        else if ((ret != MBEDTLS_ERR_SSL_WANT_READ) && (ret != MBEDTLS_ERR_SSL_WANT_WRITE))
+        {
+            break;
+        }
+    }
+
+    return (*bytes_sent == length) ? CY_RSLT_SUCCESS : tls_client_to_rslt(ret);
+}
+
+/*******************************************************************************
+ * Function Name: tls_client_recv
+ *******************************************************************************
+ * Summary:
+ *  Reads the data of one TLS record from an established connection.
+ *
+ * Parameters:
+ *  tls_client_conn_t *conn: Connection
+ *  void *buffer: Buffer for the received data
+ *  uint32_t length: Size of the buffer
+ *  uint32_t *bytes_received: Number of bytes received
+ *
+ * Return:
+ *  cy_rslt_t: CY_RSLT_SUCCESS if data was read,
+ *  CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT if no complete record is available yet,
+ *  CY_RSLT_MODULE_SECURE_SOCKETS_CLOSED if the server closed the connection.
+ *
+ *******************************************************************************/
+cy_rslt_t tls_client_recv(tls_client_conn_t *conn, void *buffer, uint32_t length,
+                          uint32_t *bytes_received)
+{
+    int ret;
+
+    *bytes_received = 0;
+
+    if (!conn->established)
+    {
+        return CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT;
+    }
+
+    ret = mbedtls_ssl_read(&conn->ssl, (unsigned char *)buffer, length);
+    if (ret > 0)
+    {
+        *bytes_received = (uint32_t)ret;
+        return CY_RSLT_SUCCESS;
+    }
+
+    return (ret == 0) ? CY_RSLT_MODULE_SECURE_SOCKETS_CLOSED : tls_client_to_rslt(ret);
+}
+
+/*******************************************************************************
+ * Function Name: tls_client_pending
+ *******************************************************************************
+ * Summary:
+ *  Checks whether received data is still buffered by the TLS layer, so that it
+ *  can be read without waiting for the next socket receive event.
+ *
+ * Parameters:
+ *  tls_client_conn_t *conn: Connection
+ *
+ * Return:
+ *  bool: true if data can be read, false otherwise.
+ *
+ *******************************************************************************/
+bool tls_client_pending(tls_client_conn_t *conn)
+{
+    return conn->established &&
+           ((mbedtls_ssl_get_bytes_avail(&conn->ssl) > 0) ||
+            (mbedtls_ssl_check_pending(&conn->ssl) != 0));
+}
+
+/*******************************************************************************
+ * Function Name: tls_client_close
+ *******************************************************************************
+ * Summary:
+ *  Sends a close notification if the connection is established and frees the
+ *  TLS context. The stored session stays valid for the next connection. The
+ *  socket itself is left to the caller.
+ *
+ * Parameters:
+ *  tls_client_conn_t *conn: Connection
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void tls_client_close(tls_client_conn_t *conn)
+{
+    if (!conn->established)
+    {
+        return;
+    }
+
+    conn->established = false;
+    (void)mbedtls_ssl_close_notify(&conn->ssl);
+    mbedtls_ssl_free(&conn->ssl);
+}
+
+/*******************************************************************************
+ * Function Name: tls_client_print_stats
+ *******************************************************************************
+ * Summary:
+ *  Prints the handshake counters and average handshake times.
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void tls_client_print_stats(void)
+{
+    printf("TLS handshakes: full %"PRIu32" (avg %"PRIu32" ms), resumed %"PRIu32
+           " (avg %"PRIu32" ms), failed %"PRIu32"\n",
+           tls_client_stats.full,
+           (tls_client_stats.full != 0) ?
+               (tls_client_stats.full_time_ms / tls_client_stats.full) : 0,
+           tls_client_stats.resumed,
+           (tls_client_stats.resumed != 0) ?
+               (tls_client_stats.resumed_time_ms / tls_client_stats.resumed) : 0,
+           tls_client_stats.failed);
+}
+
+/*******************************************************************************
+ * Function Name: tls_client_bio_send
+ *******************************************************************************
+ * Summary:
+ *  mbedTLS send callback writing to the TCP socket.
+ *
+ * Parameters:
+ *  void *ctx: TCP socket
+ *  const unsigned char *buf: Data to be sent
+ *  size_t len: Length of the data
+ *
+ * Return:
+ *  int: Number of bytes sent or an mbedTLS error code.
+ *
+ *******************************************************************************/
+static int tls_client_bio_send(void *ctx, const unsigned char *buf, size_t len)
+{
+    uint32_t bytes_sent = 0;
+    cy_rslt_t result;
+
+    result = cy_socket_send((cy_socket_t)ctx, buf, (uint32_t)len, CY_SOCKET_FLAGS_NONE,
+                            &bytes_sent);
+    if ((result == CY_RSLT_SUCCESS) && (bytes_sent > 0))
+    {
+        return (int)bytes_sent;
+    }
+
+    if ((result == CY_RSLT_SUCCESS) || (result == CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT))
+    {
+        return MBEDTLS_ERR_SSL_WANT_WRITE;
+    }
+
+    return MBEDTLS_ERR_SSL_CONN_EOF;
+}
+
+/*******************************************************************************
+ * Function Name: tls_client_bio_recv
+ *******************************************************************************
+ * Summary:
+ *  mbedTLS receive callback reading from the TCP socket. A socket receive
+ *  timeout is reported as MBEDTLS_ERR_SSL_WANT_READ.
+ *
+ * Parameters:
+ *  void *ctx: TCP socket
+ *  unsigned char *buf: Buffer for the received data
+ *  size_t len: Size of the buffer
+ *
+ * Return:
+ *  int: Number of bytes received, 0 if the peer closed the connection or an
+ *  mbedTLS error code.
+ *
+ *******************************************************************************/
+static int tls_client_bio_recv(void *ctx, unsigned char *buf, size_t len)
+{
+    uint32_t bytes_received = 0;
+    cy_rslt_t result;
+
+    result = cy_socket_recv((cy_socket_t)ctx, buf, (uint32_t)len, CY_SOCKET_FLAGS_NONE,
+                            &bytes_received);
+    if ((result == CY_RSLT_SUCCESS) && (bytes_received > 0))
+    {
+        return (int)bytes_received;
+    }
+
+    if ((result == CY_RSLT_SUCCESS) || (result == CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT))
+    {
+        return MBEDTLS_ERR_SSL_WANT_READ;
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: tls_client_to_rslt
+ *******************************************************************************
+ * Summary:
+ *  Maps an mbedTLS error code to the secure socket result codes the client
+ *  already handles.
+ *
+ * Parameters:
+ *  int ret: mbedTLS error code
+ *
+ * Return:
+ *  cy_rslt_t: Result code
+ *
+ *******************************************************************************/
+static cy_rslt_t tls_client_to_rslt(int ret)
+{
+    switch (ret)
+    {
+        case MBEDTLS_ERR_SSL_WANT_READ:
+        case MBEDTLS_ERR_SSL_WANT_WRITE:
+        case MBEDTLS_ERR_SSL_TIMEOUT:
+            return CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT;
+
+        case MBEDTLS_ERR_SSL_CONN_EOF:
+        case MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY:
+            return CY_RSLT_MODULE_SECURE_SOCKETS_CLOSED;
+
+        default:
+            return CY_RSLT_TYPE_ERROR;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: tls_client_parse_cert
+ *******************************************************************************
+ * Summary:
+ *  Parses a PEM or DER certificate. A DER certificate is referenced in place
+ *  instead of being copied to the heap; bytes after the DER data, such as a
+ *  terminating zero byte, are ignored.
+ *
+ * Parameters:
+ *  mbedtls_x509_crt *crt: Certificate to add the parsed certificate to
+ *  const uint8_t *buf: Certificate (PEM or DER)
+ *  size_t len: Length of the certificate
+ *
+ * Return:
+ *  int: 0 on success, an mbedTLS error code otherwise.
+ *
+ *******************************************************************************/
+static int tls_client_parse_cert(mbedtls_x509_crt *crt, const uint8_t *buf, size_t len)
+{
+    if ((len > 0u) && (buf[len - 1u] == '\0') && (strstr((const char *)buf, "-----BEGIN ") != NULL))
+    {
+        return mbedtls_x509_crt_parse(crt, buf, len);
+    }
+
+#if (TLS_CLIENT_CRT_PARSE_DER_NOCOPY)
+    return mbedtls_x509_crt_parse_der_nocopy(crt, buf, len);
+#else
+    return mbedtls_x509_crt_parse_der(crt, buf, len);
+#endif
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,119 @@
+/******************************************************************************
+* File Name:   tls_client.h
+*
+* Description: This file contains declarations of the TLS layer the secure TCP
+*              client runs directly on mbedTLS over a plain TCP socket, so that
+*              it can resume the session of a previous connection.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef TLS_CLIENT_H_
+#define TLS_CLIENT_H_
+
+/* Standard C header files */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Cypress secure socket header file */
+#include "cy_secure_sockets.h"
+
+/* mbedTLS header file */
+#include "mbedtls/ssl.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Time allowed for the server to complete the TLS handshake. */
+#define TLS_CLIENT_HANDSHAKE_TIMEOUT_MS           (10000u)
+
+/* Receive timeout of the socket. It bounds how long a partly received TLS
+ * record blocks the socket callback thread.
+ */
+#define TLS_CLIENT_SOCKET_RECV_TIMEOUT_MS         (100u)
+
+/* With a pre-shared key, offer the ECDHE-PSK cipher suites, which give
+ * forward secrecy at the cost of an ECDH key exchange per full handshake. Set
+ * this macro to '0' to offer the plain PSK suites, which need no public-key
+ * operation at all.
+ */
+#ifndef TLS_CLIENT_PSK_USE_ECDHE
+#define TLS_CLIENT_PSK_USE_ECDHE                  (1)
+#endif
+
+/*******************************************************************************
+* Data structure and enumeration
+********************************************************************************/
+/* Handshake counters and timing. */
+typedef struct
+{
+    uint32_t full;
+    uint32_t resumed;
+    uint32_t failed;
+    uint32_t full_time_ms;
+    uint32_t resumed_time_ms;
+} tls_client_stats_t;
+
+/* TLS connection on a connected TCP socket. */
+typedef struct
+{
+    mbedtls_ssl_context ssl;
+    cy_socket_t socket;
+    bool established;
+} tls_client_conn_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t tls_client_init(const uint8_t *cert, size_t cert_len,
+                          const uint8_t *key, size_t key_len,
+                          const uint8_t *ca_cert, size_t ca_cert_len);
+cy_rslt_t tls_client_init_psk(const char *identity, const uint8_t *key, size_t key_len);
+cy_rslt_t tls_client_handshake(tls_client_conn_t *conn, cy_socket_t socket,
+                               const cy_socket_sockaddr_t *server);
+cy_rslt_t tls_client_send(tls_client_conn_t *conn, const void *data, uint32_t length,
+                          uint32_t *bytes_sent);
+cy_rslt_t tls_client_recv(tls_client_conn_t *conn, void *buffer, uint32_t length,
+                          uint32_t *bytes_received);
+bool tls_client_pending(tls_client_conn_t *conn);
+void tls_client_close(tls_client_conn_t *conn);
+void tls_client_print_stats(void);
+
+#endif /* TLS_CLIENT_H_ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,376 @@
+/******************************************************************************
+* File Name:   tls_session_store.c
+*
+* Description: This file contains the store that keeps the TLS session
+*              negotiated with the TCP server. The session is serialized into
+*              a record in RAM that is not initialized at startup, and
+*              optionally mirrored to a row-aligned region of internal flash.
+*              A record is only used if its checksum is valid and it was
+*              negotiated with the same server.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes */
+#include "cyhal.h"
+#include "cybsp.h"
+
+/* Standard C header files */
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+/* Session store header file */
+#include "tls_session_store.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Marks a valid record. */
+#define TLS_SESSION_STORE_MAGIC                        (0x54535331u)
+
+/* FNV-1a parameters of the record checksum. */
+#define TLS_SESSION_STORE_FNV_OFFSET                   (2166136261u)
+#define TLS_SESSION_STORE_FNV_PRIME                    (16777619u)
+
+/* Space left for the serialized session after the record header. */
+#define TLS_SESSION_STORE_DATA_LEN                     (TLS_SESSION_STORE_RECORD_LEN - \
+                                                        sizeof(tls_session_record_t))
+
+/* The session fields are private from mbedTLS 3.0 on. */
+#if (MBEDTLS_VERSION_NUMBER >= 0x03000000)
+#define TLS_SESSION_FIELD(field)                       MBEDTLS_PRIVATE(field)
+#else
+#define TLS_SESSION_FIELD(field)                       field
+#endif
+
+#if (TLS_SESSION_STORE_PERSIST) && ((TLS_SESSION_STORE_RECORD_LEN % CY_FLASH_SIZEOF_ROW) != 0)
+#error "TLS_SESSION_STORE_RECORD_LEN must be a multiple of the flash row size"
+#endif
+
+/*******************************************************************************
+* Data structure and enumeration
+********************************************************************************/
+/* Header of a record; the serialized session follows it. */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t checksum;
+    uint32_t length;
+    cy_socket_sockaddr_t server;
+} tls_session_record_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static uint32_t tls_session_store_checksum(const tls_session_record_t *record);
+static bool tls_session_store_valid(const tls_session_record_t *record);
+static bool tls_session_store_same_server(const cy_socket_sockaddr_t *a,
+                                          const cy_socket_sockaddr_t *b);
+#if (TLS_SESSION_STORE_PERSIST)
+static void tls_session_store_write_flash(void);
+#endif
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* Record in RAM. It is not initialized at startup, so it survives a warm
+ * reset; the checksum tells whether it holds a session.
+ */
+CY_NOINIT static uint32_t tls_session_ram[TLS_SESSION_STORE_RECORD_LEN / sizeof(uint32_t)];
+
+#if (TLS_SESSION_STORE_PERSIST)
+/* Record in the emulated EEPROM region of internal flash. */
+CY_SECTION(".cy_em_eeprom") CY_ALIGN(CY_FLASH_SIZEOF_ROW)
+static const uint8_t tls_session_flash[TLS_SESSION_STORE_RECORD_LEN] = {0};
+
+static cyhal_flash_t tls_session_flash_obj;
+#endif
+
+/*******************************************************************************
+ * Function Name: tls_session_store_init
+ *******************************************************************************
+ * Summary:
+ *  Keeps the session that survived a warm reset. Otherwise, if persistence is
+ *  enabled, restores the session from flash.
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void tls_session_store_init(void)
+{
+    tls_session_record_t *record = (tls_session_record_t *)tls_session_ram;
+
+#if (TLS_SESSION_STORE_PERSIST)
+    if (cyhal_flash_init(&tls_session_flash_obj) != CY_RSLT_SUCCESS)
+    {
+        printf("Failed to initialize the flash. The TLS session is not persisted.\n");
+    }
+#endif
+
+    if (tls_session_store_valid(record))
+    {
+        printf("TLS session kept across reset\n");
+        return;
+    }
+
+    record->magic = 0;
+
+#if (TLS_SESSION_STORE_PERSIST)
+    if (tls_session_store_valid((const tls_session_record_t *)tls_session_flash))
+    {
+        memcpy(tls_session_ram, tls_session_flash, TLS_SESSION_STORE_RECORD_LEN);
+        printf("TLS session restored from flash\n");
+    }
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: tls_session_store_load
+ *******************************************************************************
+ * Summary:
+ *  Restores the stored session if it was negotiated with the given server.
+ *
+ * Parameters:
+ *  const cy_socket_sockaddr_t *server: Address of the TCP server
+ *  mbedtls_ssl_session *session: Initialized session to be populated
+ *
+ * Return:
+ *  bool: true if the session was restored, false otherwise.
+ *
+ *******************************************************************************/
+bool tls_session_store_load(const cy_socket_sockaddr_t *server, mbedtls_ssl_session *session)
+{
+    const tls_session_record_t *record = (const tls_session_record_t *)tls_session_ram;
+
+    if (!tls_session_store_valid(record) ||
+        !tls_session_store_same_server(&record->server, server))
+    {
+        return false;
+    }
+
+    return (mbedtls_ssl_session_load(session, (const unsigned char *)(record + 1),
+                                     record->length) == 0);
+}
+
+/*******************************************************************************
+ * Function Name: tls_session_store_save
+ *******************************************************************************
+ * Summary:
+ *  Stores a session negotiated with the given server, without the server
+ *  certificate, which is only needed during a full handshake. Flash is only
+ *  written when the record differs from the one already persisted.
+ *
+ * Parameters:
+ *  const cy_socket_sockaddr_t *server: Address of the TCP server
+ *  const mbedtls_ssl_session *session: Session to be stored
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void tls_session_store_save(const cy_socket_sockaddr_t *server, const mbedtls_ssl_session *session)
+{
+    tls_session_record_t *record = (tls_session_record_t *)tls_session_ram;
+    mbedtls_ssl_session stripped;
+    size_t length = 0;
+    int ret;
+
+    /* Serialize a shallow copy without the peer certificate. The copy is not
+     * freed, as it shares all its allocations with the original session.
+     */
+    stripped = *session;
+#if defined(MBEDTLS_X509_CRT_PARSE_C) && defined(MBEDTLS_SSL_KEEP_PEER_CERTIFICATE)
+    stripped.TLS_SESSION_FIELD(peer_cert) = NULL;
+#endif
+
+    record->magic = 0;
+    ret = mbedtls_ssl_session_save(&stripped, (unsigned char *)(record + 1),
+                                   TLS_SESSION_STORE_DATA_LEN, &length);
+    if (ret != 0)
+    {
+        printf("Failed to store the TLS session! Error: -0x%04"PRIx32"\n", (uint32_t)-ret);
+        return;
+    }
+
+    record->server = *server;
+    record->length = (uint32_t)length;
+    record->checksum = tls_session_store_checksum(record);
+    record->magic = TLS_SESSION_STORE_MAGIC;
+
+#if (TLS_SESSION_STORE_PERSIST)
+    if (memcmp(tls_session_ram, tls_session_flash, sizeof(tls_session_record_t) + length) != 0)
+    {
+        tls_session_store_write_flash();
+    }
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: tls_session_store_clear
+ *******************************************************************************
+ * Summary:
+ *  Drops the stored session, for example after the server rejected it.
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void tls_session_store_clear(void)
+{
+    ((tls_session_record_t *)tls_session_ram)->magic = 0;
+
+#if (TLS_SESSION_STORE_PERSIST)
+    if (tls_session_store_valid((const tls_session_record_t *)tls_session_flash))
+    {
+        /* The header is in the first row; erasing it invalidates the record. */
+        cyhal_flash_erase(&tls_session_flash_obj, (uint32_t)tls_session_flash);
+    }
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: tls_session_store_checksum
+ *******************************************************************************
+ * Summary:
+ *  Computes the FNV-1a checksum of a record, excluding its magic and checksum
+ *  fields.
+ *
+ * Parameters:
+ *  const tls_session_record_t *record: Record
+ *
+ * Return:
+ *  uint32_t: Checksum
+ *
+ *******************************************************************************/
+static uint32_t tls_session_store_checksum(const tls_session_record_t *record)
+{
+    const uint8_t *bytes = (const uint8_t *)&record->length;
+    uint32_t length = (uint32_t)(sizeof(tls_session_record_t) -
+                                 offsetof(tls_session_record_t, length)) + record->length;
+    uint32_t hash = TLS_SESSION_STORE_FNV_OFFSET;
+
+    for (uint32_t i = 0; i < length; i++)
+    {
+        hash = (hash ^ bytes[i]) * TLS_SESSION_STORE_FNV_PRIME;
+    }
+
+    return hash;
+}
+
+/*******************************************************************************
+ * Function Name: tls_session_store_valid
+ *******************************************************************************
+ * Summary:
+ *  Checks that a record holds a complete, uncorrupted session.
+ *
+ * Parameters:
+ *  const tls_session_record_t *record: Record
+ *
+ * Return:
+ *  bool: true if the record is valid, false otherwise.
+ *
+ *******************************************************************************/
+static bool tls_session_store_valid(const tls_session_record_t *record)
+{
+    return (record->magic == TLS_SESSION_STORE_MAGIC) &&
+           (record->length <= TLS_SESSION_STORE_DATA_LEN) &&
+           (record->checksum == tls_session_store_checksum(record));
+}
+
+/*******************************************************************************
+ * Function Name: tls_session_store_same_server
+ *******************************************************************************
+ * Summary:
+ *  Compares two server addresses.
+ *
+ * Parameters:
+ *  const cy_socket_sockaddr_t *a: First address
+ *  const cy_socket_sockaddr_t *b: Second address
+ *
+ * Return:
+ *  bool: true if both addresses are equal, false otherwise.
+ *
+ *******************************************************************************/
+static bool tls_session_store_same_server(const cy_socket_sockaddr_t *a,
+                                          const cy_socket_sockaddr_t *b)
+{
+    if ((a->port != b->port) || (a->ip_address.version != b->ip_address.version))
+    {
+        return false;
+    }
+
+    if (a->ip_address.version == CY_SOCKET_IP_VER_V6)
+    {
+        return (memcmp(a->ip_address.ip.v6, b->ip_address.ip.v6,
+                       sizeof(a->ip_address.ip.v6)) == 0);
+    }
+
+    return (a->ip_address.ip.v4 == b->ip_address.ip.v4);
+}
+
+#if (TLS_SESSION_STORE_PERSIST)
+/*******************************************************************************
+ * Function Name: tls_session_store_write_flash
+ *******************************************************************************
+ * Summary:
+ *  Writes the RAM record to flash, one row at a time.
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void tls_session_store_write_flash(void)
+{
+    for (uint32_t offset = 0; offset < TLS_SESSION_STORE_RECORD_LEN; offset += CY_FLASH_SIZEOF_ROW)
+    {
+        cy_rslt_t result = cyhal_flash_write(&tls_session_flash_obj,
+                                             (uint32_t)&tls_session_flash[offset],
+                                             &tls_session_ram[offset / sizeof(uint32_t)]);
+        if (result != CY_RSLT_SUCCESS)
+        {
+            printf("Failed to write the TLS session to flash! Error: 0x%08"PRIx32"\n",
+                   (uint32_t)result);
+            return;
+        }
+    }
+}
+#endif /* TLS_SESSION_STORE_PERSIST */
+
+
+/* [] END OF FILE */
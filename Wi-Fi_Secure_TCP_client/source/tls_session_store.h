@@ -0,0 +1,86 @@
+/******************************************************************************
+* File Name:   tls_session_store.h
+*
+* Description: This file contains declarations of the store that keeps the TLS
+*              session negotiated with the TCP server, so that the next
+*              connection can resume it with an abbreviated handshake.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef TLS_SESSION_STORE_H_
+#define TLS_SESSION_STORE_H_
+
+/* Standard C header files */
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Cypress secure socket header file */
+#include "cy_secure_sockets.h"
+
+/* mbedTLS header file */
+#include "mbedtls/ssl.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* The session is kept in RAM that is not initialized at startup, so it
+ * survives a warm reset. Set this macro to '1' to also write it to internal
+ * flash, so that it survives a power cycle. The session holds the master
+ * secret of the connection and is stored unencrypted.
+ */
+#ifndef TLS_SESSION_STORE_PERSIST
+#define TLS_SESSION_STORE_PERSIST                 (0)
+#endif
+
+/* Size of the stored record, a multiple of the internal flash row size. It
+ * has to hold the serialized session including a session ticket, which can be
+ * several hundred bytes long.
+ */
+#define TLS_SESSION_STORE_RECORD_LEN              (2048u)
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void tls_session_store_init(void);
+bool tls_session_store_load(const cy_socket_sockaddr_t *server, mbedtls_ssl_session *session);
+void tls_session_store_save(const cy_socket_sockaddr_t *server, const mbedtls_ssl_session *session);
+void tls_session_store_clear(void);
+
+#endif /* TLS_SESSION_STORE_H_ */
+
+
+/* [] END OF FILE */
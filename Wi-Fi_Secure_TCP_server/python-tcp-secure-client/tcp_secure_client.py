@@ -48,6 +48,26 @@ import sys
 DEFAULT_PORT = 50007                         # Port of the TCP server
 arguments = len(sys.argv) - 1
 
+# Pre-shared key of this client, see TLS_PSK_CLIENT_IDENTITY and
+# TLS_PSK_CLIENT_KEY in network_credentials.h.
+PSK_IDENTITY = "psoc6-tcp-client"
+PSK_KEY = bytes.fromhex("d74d1176e2bb3d96e7ad8bff8872939f5015b299e62e46475b5f6ca2b8e3db67")
+
+# Optional trailing "psk" argument: authenticate with the pre-shared key
+# instead of certificates, for a server built with TLS_PSK=1.
+use_psk = False
+if ((arguments >= 3) and sys.argv[-1] == "psk"):
+    use_psk = True
+    arguments -= 1
+
+# Optional "reconnect <count>" arguments: reconnect the given number of times
+# before exchanging commands, offering the previous TLS session each time, to
+# check that the server resumes sessions with an abbreviated handshake.
+reconnect_count = 0
+if ((arguments == 4) and sys.argv[3] == "reconnect"):
+    reconnect_count = int(sys.argv[4])
+    arguments = 2
+
 if ((arguments == 2) and sys.argv[1] == "ipv4"):
     print("================================================================================")
     print("TCP Secure Client (IPv4 addressing mode)")
@@ -65,17 +85,39 @@ else:
     print("python tcp_secure_client ipv4 <IPv4 Address>")
     print("If you are using IPv6 addressing mode, enter the command as:")
     print("python tcp_secure_client ipv6 <IPv6 Address>")
+    print("Append 'reconnect <count>' to test TLS session resumption.")
+    print("Append 'psk' to connect to a server built with TLS_PSK=1.")
     sys.exit(1)
 
 DEFAULT_IP = sys.argv[2]
 
 context = ssl.SSLContext(ssl.PROTOCOL_TLS_CLIENT)
-context.load_cert_chain(certfile="client.crt", keyfile="client.key")
-context.load_verify_locations(cafile="root_ca.crt")
+if use_psk:
+    if not hasattr(context, "set_psk_client_callback"):
+        print("The 'psk' option needs Python 3.13 or later.")
+        sys.exit(1)
+    # The TLS 1.2 PSK cipher suites authenticate both peers with the key alone.
+    context.check_hostname = False
+    context.verify_mode = ssl.CERT_NONE
+    context.maximum_version = ssl.TLSVersion.TLSv1_2
+    context.set_ciphers("ECDHEPSK:PSK")
+    context.set_psk_client_callback(lambda hint: (PSK_IDENTITY, PSK_KEY))
+else:
+    context.load_cert_chain(certfile="client.crt", keyfile="client.key")
+    context.load_verify_locations(cafile="root_ca.crt")
 ssl_sock = context.wrap_socket(s, server_hostname="myServer")
 
 ssl_sock.connect((DEFAULT_IP, DEFAULT_PORT))
 print("Connected to TCP Server (IP Address: ", DEFAULT_IP, "Port: ", DEFAULT_PORT, " )")
+print("Cipher suite:", ssl_sock.cipher()[0])
+
+for attempt in range(reconnect_count):
+    session = ssl_sock.session
+    ssl_sock.close()
+    s = socket.socket(s.family, socket.SOCK_STREAM)
+    ssl_sock = context.wrap_socket(s, server_hostname="myServer", session=session)
+    ssl_sock.connect((DEFAULT_IP, DEFAULT_PORT))
+    print("Reconnect", attempt + 1, "session_reused:", ssl_sock.session_reused)
 
 try:
     while True:
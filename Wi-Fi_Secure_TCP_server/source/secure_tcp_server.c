@@ -59,12 +59,27 @@
 
 #include "network_credentials.h"
 
+#if(USE_DER_CREDENTIALS)
+/* DER form of the credentials, generated by scripts/pem_to_der.py. */
+#include "network_credentials_der.h"
+#endif
+
 /* TCP server task header file. */
 #include "secure_tcp_server.h"
 
 /* IP address related header files (part of the lwIP TCP/IP stack). */
 #include "ip_addr.h"
 
+#if(USE_TLS_SESSION_RESUMPTION)
+/* TLS layer with session resumption. */
+#include "tls_server.h"
+#endif
+
+#if(USE_TLS_PSK) && !defined(MBEDTLS_KEY_EXCHANGE_PSK_ENABLED) && \
+    !defined(MBEDTLS_KEY_EXCHANGE_ECDHE_PSK_ENABLED)
+#error "USE_TLS_PSK needs the PSK key exchanges of mbedTLS. Set TLS_PSK=1 in the Makefile."
+#endif
+
 /* to use the portable formatting macros */
 #include <inttypes.h>
 
@@ -82,6 +97,14 @@
 /* Interrupt priority of the user button. */
 #define USER_BTN_INTR_PRIORITY                         (5)
 
+/* Notification bits of the secure TCP server task. The button ISR and, with
+ * USE_TLS_SESSION_RESUMPTION, the socket callbacks only set these bits; the
+ * TLS handshake and the release of the client socket run in the task.
+ */
+#define TCP_SERVER_NOTIFY_BUTTON                       (1u << 0)
+#define TCP_SERVER_NOTIFY_CONNECT                      (1u << 1)
+#define TCP_SERVER_NOTIFY_DISCONNECT                   (1u << 2)
+
 /*******************************************************************************
 * Function Prototypes
 ********************************************************************************/
@@ -91,6 +114,12 @@ cy_rslt_t tcp_receive_msg_handler(cy_socket_t socket_handle, void *arg);
 cy_rslt_t tcp_disconnection_handler(cy_socket_t socket_handle, void *arg);
 void isr_button_press( void *callback_arg, cyhal_gpio_event_t event);
 void print_heap_usage(char *msg);
+static cy_rslt_t tcp_receive_msg(cy_socket_t socket_handle);
+
+#if(USE_TLS_SESSION_RESUMPTION)
+static void tls_client_handshake(void);
+static void tls_client_release(void);
+#endif
 
 #if(USE_AP_INTERFACE)
     static cy_rslt_t softap_start(void);
@@ -106,15 +135,38 @@ cy_socket_sockaddr_t tcp_server_addr, peer_addr;
 cy_socket_t server_handle, client_handle;
 cy_wcm_ip_address_t ip_address;
 
+#if(USE_TLS_PSK)
+/* Pre-shared keys of the TCP clients, by PSK identity. */
+static const uint8_t tls_psk_client_key[] = TLS_PSK_CLIENT_KEY;
+
+static const tls_server_psk_t tls_psk_clients[] =
+{
+    { TLS_PSK_CLIENT_IDENTITY, tls_psk_client_key, sizeof(tls_psk_client_key) },
+};
+#elif(USE_DER_CREDENTIALS)
+/* TLS credentials of the TCP server in DER form. Each array ends in a zero
+ * byte that is not part of the DER data. */
+static const uint8_t tcp_server_cert[] = keySERVER_CERTIFICATE_DER;
+static const uint8_t server_private_key[] = keySERVER_PRIVATE_KEY_DER;
+
+/* Root CA certificate for TCP client identity verification. */
+static const uint8_t tcp_client_ca_cert[] = keyCLIENT_ROOTCA_DER;
+#else
 /* TLS credentials of the TCP server. */
 static const char tcp_server_cert[] = keySERVER_CERTIFICATE_PEM;
 static const char server_private_key[] = keySERVER_PRIVATE_KEY_PEM;
 
 /* Root CA certificate for TCP client identity verification. */
 static const char tcp_client_ca_cert[] = keyCLIENT_ROOTCA_PEM;
+#endif /* USE_TLS_PSK */
 
+#if(USE_TLS_SESSION_RESUMPTION)
+/* TLS connection of the connected TCP client. */
+static tls_server_conn_t tls_conn;
+#else
 /* Variable to store the TLS identity (certificate and private key). */
 void *tls_identity;
+#endif
 
 /* Size of the peer socket address. */
 uint32_t peer_addr_len;
@@ -128,6 +180,9 @@ extern TaskHandle_t server_task_handle;
 /* Flag variable to check if TCP client is connected. */
 bool client_connected;
 
+/* LED ON/OFF command of the last button press, for TCP_SERVER_NOTIFY_BUTTON. */
+static volatile uint32_t button_led_cmd = LED_OFF_CMD;
+
 cyhal_gpio_callback_data_t cb_data =
 {
 .callback = isr_button_press,
@@ -157,17 +212,28 @@ void tcp_secure_server_task(void *arg)
     /* Variable to store number of bytes sent over TCP socket. */
     uint32_t bytes_sent = 0;
 
-    /* Variable to receive LED ON/OFF command from the user button ISR. */
+    /* Variable to receive the notification bits of the task. */
+    uint32_t notify_bits = 0;
+
+    /* LED ON/OFF command to send to the TCP client. */
     uint32_t led_state_cmd = LED_OFF_CMD;
 
+#if(USE_TLS_SETUP_TIMING)
+    /* CPU cycle count at the start of the TLS setup. */
+    uint32_t tls_setup_start;
+#endif
+
     /* Initialize the user button (CYBSP_USER_BTN) and register interrupt on falling edge. */
     cyhal_gpio_init(CYBSP_USER_BTN, CYHAL_GPIO_DIR_INPUT, CYHAL_GPIO_DRIVE_PULLUP, CYBSP_BTN_OFF);
     cyhal_gpio_register_callback(CYBSP_USER_BTN, &cb_data);
     cyhal_gpio_enable_event(CYBSP_USER_BTN, CYHAL_GPIO_IRQ_FALL, USER_BTN_INTR_PRIORITY, true);
 
-    /* TCP server certificate length and private key length. */
-    const size_t tcp_server_cert_len = strlen( tcp_server_cert );
-    const size_t pkey_len = strlen( server_private_key );
+#if(!USE_TLS_SESSION_RESUMPTION)
+    /* TCP server certificate length and private key length, without the
+     * terminating null character of PEM or the zero byte after DER. */
+    const size_t tcp_server_cert_len = sizeof( tcp_server_cert ) - 1u;
+    const size_t pkey_len = sizeof( server_private_key ) - 1u;
+#endif
 
     /* Initialize Wi-Fi connection manager. */
     result = cy_wcm_init(&wifi_config);
@@ -205,9 +271,39 @@ void tcp_secure_server_task(void *arg)
     }
     printf("Secure Socket initialized\n");
 
+#if(USE_TLS_SETUP_TIMING)
+    /* Count the CPU cycles taken to set up TLS, which is mostly the parsing
+     * of the credentials. */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    tls_setup_start = DWT->CYCCNT;
+#endif
+
+#if(USE_TLS_PSK)
+    /* Set up the TLS layer to authenticate the clients by pre-shared keys. */
+    result = tls_server_init_psk(tls_psk_clients,
+                                 sizeof(tls_psk_clients) / sizeof(tls_psk_clients[0]));
+    if(result != CY_RSLT_SUCCESS)
+    {
+        printf("Failed to set up the TLS layer! Error code: %"PRIu32"\n", result);
+        CY_ASSERT(0);
+    }
+#elif(USE_TLS_SESSION_RESUMPTION)
+    /* Set up the TLS layer. mbedTLS expects the length of a PEM buffer to
+     * include the terminating null character; DER arrays end in a zero byte
+     * as well. */
+    result = tls_server_init((const uint8_t *)tcp_server_cert, sizeof(tcp_server_cert),
+                             (const uint8_t *)server_private_key, sizeof(server_private_key),
+                             (const uint8_t *)tcp_client_ca_cert, sizeof(tcp_client_ca_cert));
+    if(result != CY_RSLT_SUCCESS)
+    {
+        printf("Failed to set up the TLS layer! Error code: %"PRIu32"\n", result);
+        CY_ASSERT(0);
+    }
+#else
     /* Create TCP server identity using the SSL certificate and private key. */
-    result = cy_tls_create_identity(tcp_server_cert, tcp_server_cert_len,
-                                    server_private_key, pkey_len, &tls_identity);
+    result = cy_tls_create_identity((const char *)tcp_server_cert, tcp_server_cert_len,
+                                    (const char *)server_private_key, pkey_len, &tls_identity);
     if(result != CY_RSLT_SUCCESS)
     {
         printf("Failed cy_tls_create_identity! Error code: %"PRIu32"\n", result);
@@ -217,7 +313,8 @@ void tcp_secure_server_task(void *arg)
     /* Initializes the global trusted RootCA certificate. This examples uses a self signed
      * certificate which implies that the RootCA certificate is same as the TCP client
      * certificate. */
-    result = cy_tls_load_global_root_ca_certificates(tcp_client_ca_cert, strlen(tcp_client_ca_cert));
+    result = cy_tls_load_global_root_ca_certificates((const char *)tcp_client_ca_cert,
+                                                     sizeof(tcp_client_ca_cert) - 1u);
 
     if( result != CY_RSLT_SUCCESS)
     {
@@ -228,6 +325,14 @@ void tcp_secure_server_task(void *arg)
     {
         printf("Global trusted RootCA certificate loaded\n");
     }
+#endif /* USE_TLS_SESSION_RESUMPTION */
+
+#if(USE_TLS_SETUP_TIMING)
+    printf("TLS setup (%s credentials) took %"PRIu32" us\n",
+           (USE_TLS_PSK) ? "PSK" : ((USE_DER_CREDENTIALS) ? "DER" : "PEM"),
+           (DWT->CYCCNT - tls_setup_start) / (SystemCoreClock / 1000000u));
+#endif
+    print_heap_usage("After setting up TLS");
 
     /* Create secure TCP server socket. */
     result = create_secure_tcp_server_socket();
@@ -254,16 +359,39 @@ void tcp_secure_server_task(void *arg)
 
     while(true)
     {
-        /* Wait till user button is pressed to send LED ON/OFF command to TCP client. */
-        xTaskNotifyWait(0, 0, &led_state_cmd, portMAX_DELAY);
+        /* Wait till user button is pressed to send LED ON/OFF command to TCP
+         * client, or for a TCP client to connect or disconnect. */
+        xTaskNotifyWait(0, UINT32_MAX, &notify_bits, portMAX_DELAY);
+
+    #if(USE_TLS_SESSION_RESUMPTION)
+        if(notify_bits & TCP_SERVER_NOTIFY_CONNECT)
+        {
+            tls_client_handshake();
+        }
+
+        if(notify_bits & TCP_SERVER_NOTIFY_DISCONNECT)
+        {
+            tls_client_release();
+        }
+    #endif
+
+        if(!(notify_bits & TCP_SERVER_NOTIFY_BUTTON))
+        {
+            continue;
+        }
+        led_state_cmd = button_led_cmd;
 
         /* Send LED ON/OFF command to TCP client if there is an active
          *  TCP client connection. */
         if(client_connected)
         {
             /* Send the command to TCP client. */
+        #if(USE_TLS_SESSION_RESUMPTION)
+            result = tls_server_send(&tls_conn, &led_state_cmd, TCP_LED_CMD_LEN, &bytes_sent);
+        #else
             result = cy_socket_send(client_handle, &led_state_cmd, TCP_LED_CMD_LEN,
                            CY_SOCKET_FLAGS_NONE, &bytes_sent);
+        #endif
             if(result == CY_RSLT_SUCCESS )
             {
                 if(led_state_cmd == LED_ON_CMD)
@@ -281,10 +409,14 @@ void tcp_secure_server_task(void *arg)
                 printf("Failed to send command to client. Error: %"PRIu32"\n", result);
                 if(result == CY_RSLT_MODULE_SECURE_SOCKETS_CLOSED)
                 {
+                #if(USE_TLS_SESSION_RESUMPTION)
+                    tls_client_release();
+                #else
                     /* Disconnect the socket. */
                     cy_socket_disconnect(client_handle, 0);
                     /* Delete the socket. */
                     cy_socket_delete(client_handle);
+                #endif
                 }
             }
         }
@@ -293,6 +425,84 @@ void tcp_secure_server_task(void *arg)
     }
  }
 
+#if(USE_TLS_SESSION_RESUMPTION)
+/*******************************************************************************
+ * Function Name: tls_client_handshake
+ *******************************************************************************
+ * Summary:
+ *  Performs the TLS handshake with the TCP client accepted by the connection
+ *  callback. The handshake polls the socket for up to
+ *  TLS_SERVER_HANDSHAKE_TIMEOUT_MS, so it runs in the server task and not in
+ *  the callback thread of the secure sockets library.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void tls_client_handshake(void)
+{
+    cy_rslt_t result;
+
+    result = tls_server_handshake(&tls_conn, client_handle);
+    tls_server_print_stats();
+
+    if(result == CY_RSLT_SUCCESS)
+    {
+        printf("TLS Handshake successful and communication secured!\n");
+        printf("Press the user button to send LED ON/OFF command to the TCP client\n");
+
+        /* Set the client connection flag as true. */
+        client_connected = true;
+    }
+    else
+    {
+        printf("TLS handshake with the TCP client failed. Error: %"PRIu32"\n", result);
+        tls_client_release();
+    }
+}
+
+/*******************************************************************************
+ * Function Name: tls_client_release
+ *******************************************************************************
+ * Summary:
+ *  Frees the TLS context of the TCP client and closes its socket. The session
+ *  stays in the cache for the next connection of the client.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void tls_client_release(void)
+{
+    tls_server_close(&tls_conn);
+
+    if(client_handle == CY_SOCKET_INVALID_HANDLE)
+    {
+        /* Already released, for example after a failed handshake. */
+        return;
+    }
+
+    /* Disconnect the socket. */
+    cy_socket_disconnect(client_handle, 0);
+    /* Delete the socket. */
+    cy_socket_delete(client_handle);
+    client_handle = CY_SOCKET_INVALID_HANDLE;
+
+    /* Set the client connection flag as false. */
+    client_connected = false;
+    printf("TCP Client disconnected! Please reconnect the TCP Client\n");
+    printf("===============================================================\n");
+    printf("Listening for incoming TCP client connection on Port:%d\n",
+            tcp_server_addr.port);
+}
+#endif /* USE_TLS_SESSION_RESUMPTION */
+
 #if(!USE_AP_INTERFACE)
 /*******************************************************************************
  * Function Name: connect_to_wifi_ap()
@@ -383,6 +593,16 @@ cy_rslt_t create_secure_tcp_server_socket(void)
     cy_socket_opt_callback_t tcp_connection_option;
     cy_socket_opt_callback_t tcp_disconnect_option;
 
+#if(USE_TLS_SESSION_RESUMPTION)
+    /* Create a plain TCP socket; TLS runs on top of it in tls_server.c. */
+    #if(USE_IPV6_ADDRESS)
+    result = cy_socket_create(CY_SOCKET_DOMAIN_AF_INET6, CY_SOCKET_TYPE_STREAM,
+                              CY_SOCKET_IPPROTO_TCP, &server_handle);
+    #else
+    result = cy_socket_create(CY_SOCKET_DOMAIN_AF_INET, CY_SOCKET_TYPE_STREAM,
+                              CY_SOCKET_IPPROTO_TCP, &server_handle);
+    #endif
+#else
     /* TLS authentication mode.*/
     cy_socket_tls_auth_mode_t tls_auth_mode = CY_SOCKET_TLS_VERIFY_REQUIRED;
 
@@ -394,6 +614,7 @@ cy_rslt_t create_secure_tcp_server_socket(void)
     result = cy_socket_create(CY_SOCKET_DOMAIN_AF_INET, CY_SOCKET_TYPE_STREAM,
                                   CY_SOCKET_IPPROTO_TLS, &server_handle);
     #endif
+#endif /* USE_TLS_SESSION_RESUMPTION */
     if(result != CY_RSLT_SUCCESS)
     {
         printf("Failed to create socket! Error code: %"PRIu32"\n", result);
@@ -449,6 +670,7 @@ cy_rslt_t create_secure_tcp_server_socket(void)
         return result;
     }
 
+#if(!USE_TLS_SESSION_RESUMPTION)
     /* Set the TCP socket to use the TLS identity. */
     result = cy_socket_setsockopt(server_handle, CY_SOCKET_SOL_TLS, CY_SOCKET_SO_TLS_IDENTITY,
                                   tls_identity, sizeof((uint32_t)tls_identity));
@@ -461,6 +683,7 @@ cy_rslt_t create_secure_tcp_server_socket(void)
     /* Set the TLS authentication mode. */
     cy_socket_setsockopt(server_handle, CY_SOCKET_SOL_TLS, CY_SOCKET_SO_TLS_AUTH_MODE,
                         &tls_auth_mode, sizeof(cy_socket_tls_auth_mode_t));
+#endif /* !USE_TLS_SESSION_RESUMPTION */
 
      /* Bind the TCP socket created to Server IP address and to TCP port. */
     result = cy_socket_bind(server_handle, &tcp_server_addr, sizeof(tcp_server_addr));
@@ -493,6 +716,30 @@ cy_rslt_t tcp_connection_handler(cy_socket_t socket_handle, void *arg)
      * perform TLS handshake. */
     result = cy_socket_accept(socket_handle, &peer_addr, &peer_addr_len,
                               &client_handle);
+#if(USE_TLS_SESSION_RESUMPTION)
+    if(result == CY_RSLT_SUCCESS)
+    {
+        /* The handshake polls the socket, so use a short receive timeout. */
+        uint32_t tls_recv_timeout = TLS_SERVER_SOCKET_RECV_TIMEOUT_MS;
+
+        result = cy_socket_setsockopt(client_handle, CY_SOCKET_SOL_SOCKET,
+                                      CY_SOCKET_SO_RCVTIMEO, &tls_recv_timeout,
+                                      sizeof(tls_recv_timeout));
+        if(result != CY_RSLT_SUCCESS)
+        {
+            cy_socket_disconnect(client_handle, 0);
+            cy_socket_delete(client_handle);
+            client_handle = CY_SOCKET_INVALID_HANDLE;
+        }
+    }
+
+    if(result == CY_RSLT_SUCCESS)
+    {
+        /* The server task performs the TLS handshake. */
+        printf("Incoming TCP connection accepted\n");
+        xTaskNotify(server_task_handle, TCP_SERVER_NOTIFY_CONNECT, eSetBits);
+    }
+#else
     if(result == CY_RSLT_SUCCESS)
     {
         printf("Incoming TCP connection accepted\n");
@@ -502,6 +749,7 @@ cy_rslt_t tcp_connection_handler(cy_socket_t socket_handle, void *arg)
         /* Set the client connection flag as true. */
         client_connected = true;
     }
+#endif /* USE_TLS_SESSION_RESUMPTION */
     else
     {
         printf("Failed to accept incoming client connection. Error: %"PRIu32"\n", result);
@@ -528,14 +776,62 @@ cy_rslt_t tcp_connection_handler(cy_socket_t socket_handle, void *arg)
  *
  *******************************************************************************/
 cy_rslt_t tcp_receive_msg_handler(cy_socket_t socket_handle, void *arg)
+{
+    cy_rslt_t result;
+
+#if(USE_TLS_SESSION_RESUMPTION)
+    /* Several records may arrive with one receive event, and mbedTLS may have
+     * already read them from the socket, so drain all of them here. */
+    do
+    {
+        result = tcp_receive_msg(socket_handle);
+    } while((result == CY_RSLT_SUCCESS) && tls_server_pending(&tls_conn));
+
+    /* A record may be split across several receive events; wait for the rest. */
+    if(result == CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT)
+    {
+        result = CY_RSLT_SUCCESS;
+    }
+#else
+    result = tcp_receive_msg(socket_handle);
+#endif
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: tcp_receive_msg
+ *******************************************************************************
+ * Summary:
+ *  Receives one acknowledgement from the TCP client and sets the LED state
+ *  from it.
+ *
+ * Parameters:
+ *  cy_socket_t socket_handle: Connection handle for the TCP client socket
+ *
+ * Return:
+ *  cy_result result: Result of the operation. With USE_TLS_SESSION_RESUMPTION,
+ *  CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT if no complete record was received.
+ *
+ *******************************************************************************/
+static cy_rslt_t tcp_receive_msg(cy_socket_t socket_handle)
 {
     char message_buffer[MAX_TCP_RECV_BUFFER_SIZE];
     cy_rslt_t result;
 
     /* Variable to store number of bytes received from TCP client. */
     uint32_t bytes_received = 0;
+#if(USE_TLS_SESSION_RESUMPTION)
+    result = tls_server_recv(&tls_conn, message_buffer, MAX_TCP_RECV_BUFFER_SIZE - 1,
+                             &bytes_received);
+    if(result == CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT)
+    {
+        return result;
+    }
+#else
     result = cy_socket_recv(socket_handle, message_buffer, MAX_TCP_RECV_BUFFER_SIZE,
                             CY_SOCKET_FLAGS_NONE, &bytes_received);
+#endif
 
     if(result == CY_RSLT_SUCCESS)
     {
@@ -559,10 +855,15 @@ cy_rslt_t tcp_receive_msg_handler(cy_socket_t socket_handle, void *arg)
         result);
         if(result == CY_RSLT_MODULE_SECURE_SOCKETS_CLOSED)
         {
+        #if(USE_TLS_SESSION_RESUMPTION)
+            /* The server task releases the connection. */
+            xTaskNotify(server_task_handle, TCP_SERVER_NOTIFY_DISCONNECT, eSetBits);
+        #else
             /* Disconnect the socket. */
             cy_socket_disconnect(socket_handle, 0);
             /* Delete the socket. */
             cy_socket_delete(socket_handle);
+        #endif
         }
     }
 
@@ -590,8 +891,13 @@ cy_rslt_t tcp_receive_msg_handler(cy_socket_t socket_handle, void *arg)
  *******************************************************************************/
 cy_rslt_t tcp_disconnection_handler(cy_socket_t socket_handle, void *arg)
 {
-    cy_rslt_t result;
+    cy_rslt_t result = CY_RSLT_SUCCESS;
 
+#if(USE_TLS_SESSION_RESUMPTION)
+    /* The server task may be in the TLS handshake with this client, so it
+     * releases the connection. The session stays in the cache. */
+    xTaskNotify(server_task_handle, TCP_SERVER_NOTIFY_DISCONNECT, eSetBits);
+#else
     /* Disconnect the TCP client. */
     result = cy_socket_disconnect(socket_handle, 0);
     /* Delete the socket. */
@@ -603,6 +909,7 @@ cy_rslt_t tcp_disconnection_handler(cy_socket_t socket_handle, void *arg)
     printf("===============================================================\n");
     printf("Listening for incoming TCP client connection on Port:%d\n",
             tcp_server_addr.port);
+#endif
 
     return result;
 }
@@ -641,8 +948,9 @@ void isr_button_press( void *callback_arg, cyhal_gpio_event_t event)
     }
     
     /* Set the flag to send command to TCP client. */
-    xTaskNotifyFromISR(server_task_handle, led_state_cmd,
-                      eSetValueWithoutOverwrite, &xHigherPriorityTaskWoken);
+    button_led_cmd = led_state_cmd;
+    xTaskNotifyFromISR(server_task_handle, TCP_SERVER_NOTIFY_BUTTON,
+                      eSetBits, &xHigherPriorityTaskWoken);
 
     /* Force a context switch if xHigherPriorityTaskWoken is now set to pdTRUE. */
     portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
@@ -45,6 +45,46 @@
  */
 #define USE_IPV6_ADDRESS                          (0)
 
+/* Set this macro to '1' to run TLS directly on mbedTLS (see tls_server.c)
+ * instead of the secure socket library, so that clients which reconnect can
+ * resume their TLS session with an abbreviated handshake.
+ */
+#ifndef USE_TLS_SESSION_RESUMPTION
+#define USE_TLS_SESSION_RESUMPTION                (0)
+#endif
+
+/* Authenticate the clients with pre-shared keys (see network_credentials.h)
+ * instead of certificates. It needs the PSK key exchanges of mbedTLS, so it is
+ * set by TLS_PSK=1 in the Makefile, which also selects
+ * configs/mbedtls_user_config_psk.h. PSK runs on the same mbedTLS layer as
+ * USE_TLS_SESSION_RESUMPTION, which it enables.
+ */
+#ifndef USE_TLS_PSK
+#define USE_TLS_PSK                               (0)
+#endif
+
+/* Embed the certificates and keys of network_credentials.h in DER form, which
+ * mbedTLS parses without Base64 decoding. CREDENTIALS_DER=1 in the Makefile
+ * sets it and generates network_credentials_der.h with scripts/pem_to_der.py
+ * before the build.
+ */
+#ifndef USE_DER_CREDENTIALS
+#define USE_DER_CREDENTIALS                       (0)
+#endif
+
+/* Print the time taken to set up TLS, which is mostly the parsing of the
+ * credentials, measured with the DWT cycle counter. TLS_SETUP_TIMING=1 in the
+ * Makefile sets it.
+ */
+#ifndef USE_TLS_SETUP_TIMING
+#define USE_TLS_SETUP_TIMING                      (0)
+#endif
+
+#if (USE_TLS_PSK)
+#undef USE_TLS_SESSION_RESUMPTION
+#define USE_TLS_SESSION_RESUMPTION                (1)
+#endif
+
 /* TCP server related macros. */
 #define TCP_SERVER_PORT                           (50007)
 #define TCP_SERVER_MAX_PENDING_CONNECTIONS        (3)
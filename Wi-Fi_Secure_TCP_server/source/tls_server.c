@@ -0,0 +1,838 @@
+/******************************************************************************
+* File Name:   tls_server.c
+*
+* Description: This file contains the TLS layer the secure TCP server runs
+*              directly on mbedTLS over a plain TCP socket. The secure socket
+*              library does not expose a server session cache, so running the
+*              TLS layer here is what allows a client that reconnects, for
+*              example after roaming to another AP, to resume its session with
+*              an abbreviated handshake instead of a full handshake with client
+*              certificate verification.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* FreeRTOS header files */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+
+/* Standard C header files */
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+/* mbedTLS header files */
+#include "mbedtls/version.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/x509_crt.h"
+#include "mbedtls/pk.h"
+#include "mbedtls/ssl_ciphersuites.h"
+
+/* TLS layer header file */
+#include "tls_server.h"
+
+#if (TLS_SERVER_USE_SESSION_TICKETS)
+#include "mbedtls/ssl_ticket.h"
+#endif
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Personalization string of the random number generator. */
+#define TLS_SERVER_DRBG_PERSONALIZATION                "secure_tcp_server"
+
+/* mbedTLS 2.16 and later can parse a DER certificate without copying it. */
+#if (MBEDTLS_VERSION_NUMBER >= 0x02100000)
+#define TLS_SERVER_CRT_PARSE_DER_NOCOPY                (1)
+#else
+#define TLS_SERVER_CRT_PARSE_DER_NOCOPY                (0)
+#endif
+
+/* Pre-shared keys can only be used if mbedTLS has a PSK key exchange. */
+#if defined(MBEDTLS_KEY_EXCHANGE_PSK_ENABLED) || defined(MBEDTLS_KEY_EXCHANGE_ECDHE_PSK_ENABLED)
+#define TLS_SERVER_PSK_SUPPORTED                       (1)
+#else
+#define TLS_SERVER_PSK_SUPPORTED                       (0)
+#endif
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static int tls_server_bio_send(void *ctx, const unsigned char *buf, size_t len);
+static int tls_server_bio_recv(void *ctx, unsigned char *buf, size_t len);
+static cy_rslt_t tls_server_to_rslt(int ret);
+static cy_rslt_t tls_server_setup(void);
+static int tls_server_parse_cert(mbedtls_x509_crt *crt, const uint8_t *buf, size_t len);
+#if (TLS_SERVER_PSK_SUPPORTED)
+static int tls_server_psk_lookup(void *arg, mbedtls_ssl_context *ssl,
+                                 const unsigned char *identity, size_t identity_len);
+#endif
+#if (TLS_SERVER_USE_SESSION_TICKETS)
+static int tls_server_ticket_parse(void *p_ticket, mbedtls_ssl_session *session,
+                                   unsigned char *buf, size_t len);
+#endif
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* TLS configuration shared by all connections. */
+static mbedtls_ssl_config tls_server_conf;
+static mbedtls_entropy_context tls_server_entropy;
+static mbedtls_ctr_drbg_context tls_server_drbg;
+static mbedtls_x509_crt tls_server_cert;
+static mbedtls_x509_crt tls_server_ca_cert;
+static mbedtls_pk_context tls_server_key;
+
+/* Session-ID cache. */
+static tls_session_cache_t tls_server_session_cache;
+
+#if (TLS_SERVER_PSK_SUPPORTED)
+/* PSK cipher suites in order of preference. The ECDHE-PSK suites come first,
+ * as they give forward secrecy; the client decides by the suites it offers.
+ */
+static const int tls_server_psk_candidates[] =
+{
+    MBEDTLS_TLS_ECDHE_PSK_WITH_CHACHA20_POLY1305_SHA256,
+    MBEDTLS_TLS_ECDHE_PSK_WITH_AES_128_CBC_SHA256,
+    MBEDTLS_TLS_PSK_WITH_AES_128_GCM_SHA256,
+    MBEDTLS_TLS_PSK_WITH_AES_128_CCM,
+    MBEDTLS_TLS_PSK_WITH_AES_128_CBC_SHA256,
+};
+
+/* Enabled PSK cipher suites, terminated by 0. */
+static int tls_server_psk_suites[(sizeof(tls_server_psk_candidates) / sizeof(tls_server_psk_candidates[0])) + 1];
+
+/* Identities and keys of the clients. */
+static const tls_server_psk_t *tls_server_psk_clients;
+static size_t tls_server_psk_count;
+#endif /* TLS_SERVER_PSK_SUPPORTED */
+
+#if (TLS_SERVER_USE_SESSION_TICKETS)
+/* Session ticket keys and number of sessions resumed from a ticket. */
+static mbedtls_ssl_ticket_context tls_server_ticket_ctx;
+static uint32_t tls_server_ticket_hits;
+#endif
+
+/* Handshake counters. */
+static tls_server_stats_t tls_server_stats;
+
+/* Serializes the record operations of the socket callback thread and the
+ * server task on a connection.
+ */
+static SemaphoreHandle_t tls_server_mutex;
+
+/*******************************************************************************
+ * Function Name: tls_server_init
+ *******************************************************************************
+ * Summary:
+ *  Parses the server credentials and sets up the TLS configuration shared by
+ *  all connections: client certificate verification, the session cache and,
+ *  if enabled, session tickets. PEM buffers must include the terminating null
+ *  character in their length. DER certificates are parsed in place, so their
+ *  buffers must stay valid while the server runs, as arrays in flash do.
+ *
+ * Parameters:
+ *  const uint8_t *cert: Server certificate (PEM or DER)
+ *  size_t cert_len: Length of the server certificate
+ *  const uint8_t *key: Server private key (PEM or DER)
+ *  size_t key_len: Length of the server private key
+ *  const uint8_t *ca_cert: Root CA certificate of the clients (PEM or DER)
+ *  size_t ca_cert_len: Length of the root CA certificate
+ *
+ * Return:
+ *  cy_rslt_t: CY_RSLT_SUCCESS on success, CY_RSLT_TYPE_ERROR otherwise.
+ *
+ *******************************************************************************/
+cy_rslt_t tls_server_init(const uint8_t *cert, size_t cert_len,
+                          const uint8_t *key, size_t key_len,
+                          const uint8_t *ca_cert, size_t ca_cert_len)
+{
+    int ret;
+
+    if (tls_server_setup() != CY_RSLT_SUCCESS)
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    mbedtls_x509_crt_init(&tls_server_cert);
+    mbedtls_x509_crt_init(&tls_server_ca_cert);
+    mbedtls_pk_init(&tls_server_key);
+
+    ret = tls_server_parse_cert(&tls_server_cert, cert, cert_len);
+    if (ret != 0)
+    {
+        printf("Failed to parse the server certificate! Error: -0x%04"PRIx32"\n", (uint32_t)-ret);
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    ret = tls_server_parse_cert(&tls_server_ca_cert, ca_cert, ca_cert_len);
+    if (ret != 0)
+    {
+        printf("Failed to parse the root CA certificate! Error: -0x%04"PRIx32"\n", (uint32_t)-ret);
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+#if (MBEDTLS_VERSION_NUMBER >= 0x03000000)
+    ret = mbedtls_pk_parse_key(&tls_server_key, key, key_len, NULL, 0,
+                               mbedtls_ctr_drbg_random, &tls_server_drbg);
+#else
+    ret = mbedtls_pk_parse_key(&tls_server_key, key, key_len, NULL, 0);
+#endif
+    if (ret != 0)
+    {
+        printf("Failed to parse the server private key! Error: -0x%04"PRIx32"\n", (uint32_t)-ret);
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    mbedtls_ssl_conf_authmode(&tls_server_conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+    mbedtls_ssl_conf_ca_chain(&tls_server_conf, &tls_server_ca_cert, NULL);
+
+    ret = mbedtls_ssl_conf_own_cert(&tls_server_conf, &tls_server_cert, &tls_server_key);
+    if (ret != 0)
+    {
+        printf("mbedtls_ssl_conf_own_cert failed! Error: -0x%04"PRIx32"\n", (uint32_t)-ret);
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: tls_server_init_psk
+ *******************************************************************************
+ * Summary:
+ *  Sets up the TLS configuration shared by all connections to authenticate
+ *  clients with pre-shared keys instead of certificates. The client names its
+ *  key by the identity it sends in the handshake; clients with an unknown
+ *  identity are rejected. Only the PSK and ECDHE-PSK cipher suites enabled in
+ *  the mbedTLS configuration are offered. The table must stay valid while the
+ *  server runs.
+ *
+ * Parameters:
+ *  const tls_server_psk_t *clients: Identities and keys of the clients
+ *  size_t count: Number of entries of the table
+ *
+ * Return:
+ *  cy_rslt_t: CY_RSLT_SUCCESS on success, CY_RSLT_TYPE_ERROR otherwise.
+ *
+ *******************************************************************************/
+cy_rslt_t tls_server_init_psk(const tls_server_psk_t *clients, size_t count)
+{
+#if (TLS_SERVER_PSK_SUPPORTED)
+    size_t n = 0;
+    size_t i;
+
+    if (tls_server_setup() != CY_RSLT_SUCCESS)
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    /* Offer only the cipher suites that are compiled in. */
+    for (i = 0; i < (sizeof(tls_server_psk_candidates) / sizeof(tls_server_psk_candidates[0])); i++)
+    {
+        if (mbedtls_ssl_ciphersuite_from_id(tls_server_psk_candidates[i]) != NULL)
+        {
+            tls_server_psk_suites[n++] = tls_server_psk_candidates[i];
+        }
+    }
+    tls_server_psk_suites[n] = 0;
+
+    if (n == 0)
+    {
+        printf("No PSK cipher suite is enabled in the mbedTLS configuration!\n");
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    tls_server_psk_clients = clients;
+    tls_server_psk_count = count;
+
+    mbedtls_ssl_conf_ciphersuites(&tls_server_conf, tls_server_psk_suites);
+    mbedtls_ssl_conf_psk_cb(&tls_server_conf, tls_server_psk_lookup, NULL);
+
+    return CY_RSLT_SUCCESS;
+#else
+    (void)clients;
+    (void)count;
+
+    printf("The PSK key exchanges are disabled in the mbedTLS configuration!\n");
+    return CY_RSLT_TYPE_ERROR;
+#endif /* TLS_SERVER_PSK_SUPPORTED */
+}
+
+/*******************************************************************************
+ * Function Name: tls_server_setup
+ *******************************************************************************
+ * Summary:
+ *  Sets up the part of the TLS configuration that does not depend on how the
+ *  peers authenticate: the random number generator, the session cache and, if
+ *  enabled, session tickets.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  cy_rslt_t: CY_RSLT_SUCCESS on success, CY_RSLT_TYPE_ERROR otherwise.
+ *
+ *******************************************************************************/
+static cy_rslt_t tls_server_setup(void)
+{
+    int ret;
+
+    tls_server_mutex = xSemaphoreCreateMutex();
+    if (tls_server_mutex == NULL)
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    mbedtls_ssl_config_init(&tls_server_conf);
+    mbedtls_entropy_init(&tls_server_entropy);
+    mbedtls_ctr_drbg_init(&tls_server_drbg);
+
+    ret = mbedtls_ctr_drbg_seed(&tls_server_drbg, mbedtls_entropy_func, &tls_server_entropy,
+                                (const unsigned char *)TLS_SERVER_DRBG_PERSONALIZATION,
+                                strlen(TLS_SERVER_DRBG_PERSONALIZATION));
+    if (ret != 0)
+    {
+        printf("mbedtls_ctr_drbg_seed failed! Error: -0x%04"PRIx32"\n", (uint32_t)-ret);
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    ret = mbedtls_ssl_config_defaults(&tls_server_conf, MBEDTLS_SSL_IS_SERVER,
+                                      MBEDTLS_SSL_TRANSPORT_STREAM,
+                                      MBEDTLS_SSL_PRESET_DEFAULT);
+    if (ret != 0)
+    {
+        printf("mbedtls_ssl_config_defaults failed! Error: -0x%04"PRIx32"\n", (uint32_t)-ret);
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    mbedtls_ssl_conf_rng(&tls_server_conf, mbedtls_ctr_drbg_random, &tls_server_drbg);
+
+    /* Resume sessions by session ID. */
+    tls_session_cache_init(&tls_server_session_cache, TLS_SESSION_CACHE_TIMEOUT_S);
+    mbedtls_ssl_conf_session_cache(&tls_server_conf, &tls_server_session_cache,
+                                   tls_session_cache_get, tls_session_cache_set);
+
+#if (TLS_SERVER_USE_SESSION_TICKETS)
+    /* Resume sessions from session tickets. */
+    mbedtls_ssl_ticket_init(&tls_server_ticket_ctx);
+    ret = mbedtls_ssl_ticket_setup(&tls_server_ticket_ctx, mbedtls_ctr_drbg_random,
+                                   &tls_server_drbg, MBEDTLS_CIPHER_AES_128_GCM,
+                                   TLS_SERVER_TICKET_LIFETIME_S);
+    if (ret != 0)
+    {
+        printf("mbedtls_ssl_ticket_setup failed! Error: -0x%04"PRIx32"\n", (uint32_t)-ret);
+        return CY_RSLT_TYPE_ERROR;
+    }
+    mbedtls_ssl_conf_session_tickets_cb(&tls_server_conf, mbedtls_ssl_ticket_write,
+                                        tls_server_ticket_parse, &tls_server_ticket_ctx);
+#endif /* TLS_SERVER_USE_SESSION_TICKETS */
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: tls_server_handshake
+ *******************************************************************************
+ * Summary:
+ *  Performs the TLS handshake on an accepted socket and counts it as a full
+ *  or an abbreviated handshake. The socket receive timeout must be short, as
+ *  the handshake is driven by polling the socket until
+ *  TLS_SERVER_HANDSHAKE_TIMEOUT_MS expires.
+ *
+ * Parameters:
+ *  tls_server_conn_t *conn: Connection to be set up
+ *  cy_socket_t socket: Accepted TCP socket
+ *
+ * Return:
+ *  cy_rslt_t: Result of the operation.
+ *
+ *******************************************************************************/
+cy_rslt_t tls_server_handshake(tls_server_conn_t *conn, cy_socket_t socket)
+{
+    uint32_t cache_hits = tls_server_session_cache.stats.hits;
+#if (TLS_SERVER_USE_SESSION_TICKETS)
+    uint32_t ticket_hits = tls_server_ticket_hits;
+#endif
+    TickType_t start = xTaskGetTickCount();
+    int ret;
+
+    conn->socket = socket;
+    conn->established = false;
+
+    mbedtls_ssl_init(&conn->ssl);
+    ret = mbedtls_ssl_setup(&conn->ssl, &tls_server_conf);
+    if (ret != 0)
+    {
+        printf("mbedtls_ssl_setup failed! Error: -0x%04"PRIx32"\n", (uint32_t)-ret);
+        mbedtls_ssl_free(&conn->ssl);
+        tls_server_stats.failed++;
+        return tls_server_to_rslt(ret);
+    }
+    mbedtls_ssl_set_bio(&conn->ssl, socket, tls_server_bio_send, tls_server_bio_recv, NULL);
+
+    while ((ret = mbedtls_ssl_handshake(&conn->ssl)) != 0)
+    {
+        if ((ret != MBEDTLS_ERR_SSL_WANT_READ) && (ret != MBEDTLS_ERR_SSL_WANT_WRITE))
+        {
+            break;
+        }
+
+        if ((xTaskGetTickCount() - start) >= pdMS_TO_TICKS(TLS_SERVER_HANDSHAKE_TIMEOUT_MS))
+        {
+            ret = MBEDTLS_ERR_SSL_TIMEOUT;
+            break;
+        }
+    }
+
+    if (ret != 0)
+    {
+        printf("TLS handshake failed! Error: -0x%04"PRIx32"\n", (uint32_t)-ret);
+        mbedtls_ssl_free(&conn->ssl);
+        tls_server_stats.failed++;
+        return tls_server_to_rslt(ret);
+    }
+
+    xSemaphoreTake(tls_server_mutex, portMAX_DELAY);
+    conn->established = true;
+    xSemaphoreGive(tls_server_mutex);
+
+    if (tls_server_session_cache.stats.hits != cache_hits)
+    {
+        tls_server_stats.resumed_cache++;
+        printf("TLS session resumed from the session cache\n");
+    }
+#if (TLS_SERVER_USE_SESSION_TICKETS)
+    else if (tls_server_ticket_hits != ticket_hits)
+    {
+        tls_server_stats.resumed_ticket++;
+        printf("TLS session resumed from a session ticket\n");
+    }
+#endif
+    else
+    {
+        tls_server_stats.full++;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: tls_server_send
+ *******************************************************************************
+ * Summary:
+ *  Sends data over an established connection.
+ *
+ * Parameters:
+ *  tls_server_conn_t *conn: Connection
+ *  const void *data: Data to be sent
+ *  uint32_t length: Length of the data
+ *  uint32_t *bytes_sent: Number of bytes sent
+ *
+ * Return:
+ *  cy_rslt_t: Result of the operation.
+ *
+ *******************************************************************************/
+cy_rslt_t tls_server_send(tls_server_conn_t *conn, const void *data, uint32_t length,
+                          uint32_t *bytes_sent)
+{
+    const unsigned char *buf = (const unsigned char *)data;
+    int ret = 0;
+
+    *bytes_sent = 0;
+
+    /* The connection may be closed by the disconnect callback, so it is only
+     * checked with the mutex held. */
+    xSemaphoreTake(tls_server_mutex, portMAX_DELAY);
+    if (!conn->established)
+    {
+        xSemaphoreGive(tls_server_mutex);
+        return CY_RSLT_MODULE_SECURE_SOCKETS_CLOSED;
+    }
+
+    while (*bytes_sent < length)
+    {
+        ret = mbedtls_ssl_write(&conn->ssl, &buf[*bytes_sent], length - *bytes_sent);
+        if (ret > 0)
+        {
+            *bytes_sent += (uint32_t)ret;
+        }
+        else if ((ret != MBEDTLS_ERR_SSL_WANT_READ) && (ret != MBEDTLS_ERR_SSL_WANT_WRITE))
+        {
+            break;
+        }
+    }
+    xSemaphoreGive(tls_server_mutex);
+
+    return (*bytes_sent == length) ? CY_RSLT_SUCCESS : tls_server_to_rslt(ret);
+}
+
+/*******************************************************************************
+ * Function Name: tls_server_recv
+ *******************************************************************************
+ * Summary:
+ *  Reads the data of one TLS record from an established connection.
+ *
+ * Parameters:
+ *  tls_server_conn_t *conn: Connection
+ *  void *buffer: Buffer for the received data
+ *  uint32_t length: Size of the buffer
+ *  uint32_t *bytes_received: Number of bytes received
+ *
+ * Return:
+ *  cy_rslt_t: CY_RSLT_SUCCESS if data was read,
+ *  CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT if no complete record is available yet,
+ *  CY_RSLT_MODULE_SECURE_SOCKETS_CLOSED if the client closed the connection.
+ *
+ *******************************************************************************/
+cy_rslt_t tls_server_recv(tls_server_conn_t *conn, void *buffer, uint32_t length,
+                          uint32_t *bytes_received)
+{
+    int ret;
+
+    *bytes_received = 0;
+
+    xSemaphoreTake(tls_server_mutex, portMAX_DELAY);
+    if (!conn->established)
+    {
+        xSemaphoreGive(tls_server_mutex);
+        return CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT;
+    }
+
+    ret = mbedtls_ssl_read(&conn->ssl, (unsigned char *)buffer, length);
+    xSemaphoreGive(tls_server_mutex);
+
+    if (ret > 0)
+    {
+        *bytes_received = (uint32_t)ret;
+        return CY_RSLT_SUCCESS;
+    }
+
+    return (ret == 0) ? CY_RSLT_MODULE_SECURE_SOCKETS_CLOSED : tls_server_to_rslt(ret);
+}
+
+/*******************************************************************************
+ * Function Name: tls_server_pending
+ *******************************************************************************
+ * Summary:
+ *  Checks whether received data is still buffered by the TLS layer, so that it
+ *  can be read without waiting for the next socket receive event.
+ *
+ * Parameters:
+ *  tls_server_conn_t *conn: Connection
+ *
+ * Return:
+ *  bool: true if data can be read, false otherwise.
+ *
+ *******************************************************************************/
+bool tls_server_pending(tls_server_conn_t *conn)
+{
+    bool pending;
+
+    xSemaphoreTake(tls_server_mutex, portMAX_DELAY);
+    pending = conn->established &&
+              ((mbedtls_ssl_get_bytes_avail(&conn->ssl) > 0) ||
+               (mbedtls_ssl_check_pending(&conn->ssl) != 0));
+    xSemaphoreGive(tls_server_mutex);
+
+    return pending;
+}
+
+/*******************************************************************************
+ * Function Name: tls_server_close
+ *******************************************************************************
+ * Summary:
+ *  Sends a close notification if the connection is established and frees the
+ *  TLS context. The socket itself is left to the caller.
+ *
+ * Parameters:
+ *  tls_server_conn_t *conn: Connection
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void tls_server_close(tls_server_conn_t *conn)
+{
+    xSemaphoreTake(tls_server_mutex, portMAX_DELAY);
+    if (conn->established)
+    {
+        conn->established = false;
+        (void)mbedtls_ssl_close_notify(&conn->ssl);
+        mbedtls_ssl_free(&conn->ssl);
+    }
+    xSemaphoreGive(tls_server_mutex);
+}
+
+/*******************************************************************************
+ * Function Name: tls_server_print_stats
+ *******************************************************************************
+ * Summary:
+ *  Prints the handshake and session cache counters.
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void tls_server_print_stats(void)
+{
+    const tls_session_cache_stats_t *cache = &tls_server_session_cache.stats;
+
+    printf("TLS handshakes: full %"PRIu32", resumed from cache %"PRIu32
+           ", resumed from ticket %"PRIu32", failed %"PRIu32
+           ", unknown PSK identity %"PRIu32"\n",
+           tls_server_stats.full, tls_server_stats.resumed_cache,
+           tls_server_stats.resumed_ticket, tls_server_stats.failed,
+           tls_server_stats.unknown_identity);
+    printf("TLS session cache: hits %"PRIu32", misses %"PRIu32", expired %"PRIu32
+           ", stored %"PRIu32", evicted %"PRIu32"\n",
+           cache->hits, cache->misses, cache->expired, cache->stored, cache->evicted);
+}
+
+/*******************************************************************************
+ * Function Name: tls_server_bio_send
+ *******************************************************************************
+ * Summary:
+ *  mbedTLS send callback writing to the TCP socket.
+ *
+ * Parameters:
+ *  void *ctx: TCP socket
+ *  const unsigned char *buf: Data to be sent
+ *  size_t len: Length of the data
+ *
+ * Return:
+ *  int: Number of bytes sent or an mbedTLS error code.
+ *
+ *******************************************************************************/
+static int tls_server_bio_send(void *ctx, const unsigned char *buf, size_t len)
+{
+    uint32_t bytes_sent = 0;
+    cy_rslt_t result;
+
+    result = cy_socket_send((cy_socket_t)ctx, buf, (uint32_t)len, CY_SOCKET_FLAGS_NONE,
+                            &bytes_sent);
+    if ((result == CY_RSLT_SUCCESS) && (bytes_sent > 0))
+    {
+        return (int)bytes_sent;
+    }
+
+    if ((result == CY_RSLT_SUCCESS) || (result == CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT))
+    {
+        return MBEDTLS_ERR_SSL_WANT_WRITE;
+    }
+
+    return MBEDTLS_ERR_SSL_CONN_EOF;
+}
+
+/*******************************************************************************
+ * Function Name: tls_server_bio_recv
+ *******************************************************************************
+ * Summary:
+ *  mbedTLS receive callback reading from the TCP socket. A socket receive
+ *  timeout is reported as MBEDTLS_ERR_SSL_WANT_READ.
+ *
+ * Parameters:
+ *  void *ctx: TCP socket
+ *  unsigned char *buf: Buffer for the received data
+ *  size_t len: Size of the buffer
+ *
+ * Return:
+ *  int: Number of bytes received, 0 if the peer closed the connection or an
+ *  mbedTLS error code.
+ *
+ *******************************************************************************/
+static int tls_server_bio_recv(void *ctx, unsigned char *buf, size_t len)
+{
+    uint32_t bytes_received = 0;
+    cy_rslt_t result;
+
+    result = cy_socket_recv((cy_socket_t)ctx, buf, (uint32_t)len, CY_SOCKET_FLAGS_NONE,
+                            &bytes_received);
+    if ((result == CY_RSLT_SUCCESS) && (bytes_received > 0))
+    {
+        return (int)bytes_received;
+    }
+
+    if ((result == CY_RSLT_SUCCESS) || (result == CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT))
+    {
+        return MBEDTLS_ERR_SSL_WANT_READ;
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: tls_server_to_rslt
+ *******************************************************************************
+ * Summary:
+ *  Maps an mbedTLS error code to the secure socket result codes the server
+ *  already handles.
+ *
+ * Parameters:
+ *  int ret: mbedTLS error code
+ *
+ * Return:
+ *  cy_rslt_t: Result code
+ *
+ *******************************************************************************/
+static cy_rslt_t tls_server_to_rslt(int ret)
+{
+    switch (ret)
+    {
+        case MBEDTLS_ERR_SSL_WANT_READ:
+        case MBEDTLS_ERR_SSL_WANT_WRITE:
+        case MBEDTLS_ERR_SSL_TIMEOUT:
+            return CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT;
+
+        case MBEDTLS_ERR_SSL_CONN_EOF:
+        case MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY:
+            return CY_RSLT_MODULE_SECURE_SOCKETS_CLOSED;
+
+        default:
+            return CY_RSLT_TYPE_ERROR;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: tls_server_parse_cert
+ *******************************************************************************
+ * Summary:
+ *  Parses a PEM or DER certificate. A DER certificate is referenced in place
+ *  instead of being copied to the heap, which saves its size in RAM; bytes
+ *  after the DER data, such as a terminating zero byte, are ignored.
+ *
+ * Parameters:
+ *  mbedtls_x509_crt *crt: Certificate to add the parsed certificate to
+ *  const uint8_t *buf: Certificate (PEM or DER)
+ *  size_t len: Length of the certificate
+ *
+ * Return:
+ *  int: 0 on success, an mbedTLS error code otherwise.
+ *
+ *******************************************************************************/
+static int tls_server_parse_cert(mbedtls_x509_crt *crt, const uint8_t *buf, size_t len)
+{
+    if ((len > 0u) && (buf[len - 1u] == '\0') && (strstr((const char *)buf, "-----BEGIN ") != NULL))
+    {
+        return mbedtls_x509_crt_parse(crt, buf, len);
+    }
+
+#if (TLS_SERVER_CRT_PARSE_DER_NOCOPY)
+    return mbedtls_x509_crt_parse_der_nocopy(crt, buf, len);
+#else
+    return mbedtls_x509_crt_parse_der(crt, buf, len);
+#endif
+}
+
+#if (TLS_SERVER_USE_SESSION_TICKETS)
+/*******************************************************************************
+ * Function Name: tls_server_ticket_parse
+ *******************************************************************************
+ * Summary:
+ *  Wraps mbedtls_ssl_ticket_parse() to count the sessions resumed from a
+ *  session ticket.
+ *
+ * Parameters:
+ *  void *p_ticket: Ticket context
+ *  mbedtls_ssl_session *session: Session to be restored
+ *  unsigned char *buf: Ticket received from the client
+ *  size_t len: Length of the ticket
+ *
+ * Return:
+ *  int: 0 if the session was restored, an mbedTLS error code otherwise.
+ *
+ *******************************************************************************/
+static int tls_server_ticket_parse(void *p_ticket, mbedtls_ssl_session *session,
+                                   unsigned char *buf, size_t len)
+{
+    int ret = mbedtls_ssl_ticket_parse(p_ticket, session, buf, len);
+
+    if (ret == 0)
+    {
+        tls_server_ticket_hits++;
+    }
+
+    return ret;
+}
+#endif /* TLS_SERVER_USE_SESSION_TICKETS */
+
+#if (TLS_SERVER_PSK_SUPPORTED)
+/*******************************************************************************
+ * Function Name: tls_server_psk_lookup
+ *******************************************************************************
+ * Summary:
+ *  mbedTLS PSK callback. Selects the key of the identity sent by the client.
+ *
+ * Parameters:
+ *  void *arg: Not used
+ *  mbedtls_ssl_context *ssl: Connection in the handshake
+ *  const unsigned char *identity: PSK identity sent by the client
+ *  size_t identity_len: Length of the identity
+ *
+ * Return:
+ *  int: 0 if the identity is known, -1 otherwise.
+ *
+ *******************************************************************************/
+static int tls_server_psk_lookup(void *arg, mbedtls_ssl_context *ssl,
+                                 const unsigned char *identity, size_t identity_len)
+{
+    const tls_server_psk_t *client;
+    size_t i;
+
+    (void)arg;
+
+    for (i = 0; i < tls_server_psk_count; i++)
+    {
+        client = &tls_server_psk_clients[i];
+        if ((strlen(client->identity) == identity_len) &&
+            (memcmp(client->identity, identity, identity_len) == 0))
+        {
+            printf("TLS client PSK identity: %s\n", client->identity);
+            return mbedtls_ssl_set_hs_psk(ssl, client->key, client->key_len);
+        }
+    }
+
+    tls_server_stats.unknown_identity++;
+    printf("TLS client with an unknown PSK identity rejected\n");
+
+    return -1;
+}
+#endif /* TLS_SERVER_PSK_SUPPORTED */
+
+
+/* [] END OF FILE */
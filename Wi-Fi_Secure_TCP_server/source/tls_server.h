@@ -0,0 +1,132 @@
+/******************************************************************************
+* File Name:   tls_server.h
+*
+* Description: This file contains declarations of the TLS layer the secure TCP
+*              server runs directly on mbedTLS over a plain TCP socket, so that
+*              sessions can be resumed from a session cache or a session
+*              ticket.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef TLS_SERVER_H_
+#define TLS_SERVER_H_
+
+/* Standard C header files */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Cypress secure socket header file */
+#include "cy_secure_sockets.h"
+
+/* mbedTLS header file */
+#include "mbedtls/ssl.h"
+
+/* Session cache header file */
+#include "tls_session_cache.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Set this macro to '1' to also resume sessions from RFC 5077 session tickets.
+ * Tickets keep the session state on the client, so they resume sessions beyond
+ * the TLS_SESSION_CACHE_SIZE most recent ones.
+ */
+#ifndef TLS_SERVER_USE_SESSION_TICKETS
+#define TLS_SERVER_USE_SESSION_TICKETS            (1)
+#endif
+
+/* Lifetime of the key that encrypts the session tickets. */
+#define TLS_SERVER_TICKET_LIFETIME_S              (TLS_SESSION_CACHE_TIMEOUT_S)
+
+/* Time allowed for a client to complete the TLS handshake. */
+#define TLS_SERVER_HANDSHAKE_TIMEOUT_MS           (10000u)
+
+/* Receive timeout of an accepted socket. It bounds how long a partly received
+ * TLS record blocks the socket callback thread.
+ */
+#define TLS_SERVER_SOCKET_RECV_TIMEOUT_MS         (100u)
+
+/*******************************************************************************
+* Data structure and enumeration
+********************************************************************************/
+/* Handshake counters. */
+typedef struct
+{
+    uint32_t full;
+    uint32_t resumed_cache;
+    uint32_t resumed_ticket;
+    uint32_t failed;
+    uint32_t unknown_identity;
+} tls_server_stats_t;
+
+/* Pre-shared key of one client, named by its PSK identity. */
+typedef struct
+{
+    const char *identity;
+    const uint8_t *key;
+    size_t key_len;
+} tls_server_psk_t;
+
+/* TLS connection on an accepted TCP socket. */
+typedef struct
+{
+    mbedtls_ssl_context ssl;
+    cy_socket_t socket;
+    bool established;
+} tls_server_conn_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t tls_server_init(const uint8_t *cert, size_t cert_len,
+                          const uint8_t *key, size_t key_len,
+                          const uint8_t *ca_cert, size_t ca_cert_len);
+cy_rslt_t tls_server_init_psk(const tls_server_psk_t *clients, size_t count);
+cy_rslt_t tls_server_handshake(tls_server_conn_t *conn, cy_socket_t socket);
+cy_rslt_t tls_server_send(tls_server_conn_t *conn, const void *data, uint32_t length,
+                          uint32_t *bytes_sent);
+cy_rslt_t tls_server_recv(tls_server_conn_t *conn, void *buffer, uint32_t length,
+                          uint32_t *bytes_received);
+bool tls_server_pending(tls_server_conn_t *conn);
+void tls_server_close(tls_server_conn_t *conn);
+void tls_server_print_stats(void);
+
+#endif /* TLS_SERVER_H_ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,384 @@
+/******************************************************************************
+* File Name:   tls_session_cache.c
+*
+* Description: This file contains the bounded, time-expiring TLS session-ID
+*              cache used by the secure TCP server. Sessions are stored in
+*              their serialized form in a fixed table, so the cache does not
+*              allocate memory and its size is known at build time.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* FreeRTOS header files */
+#include <FreeRTOS.h>
+#include <task.h>
+
+/* Standard C header file */
+#include <string.h>
+
+/* Session cache header file */
+#include "tls_session_cache.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* The session fields are private from mbedTLS 3.0 on. */
+#if (MBEDTLS_VERSION_NUMBER >= 0x03000000)
+#define TLS_SESSION_FIELD(field)                       MBEDTLS_PRIVATE(field)
+#else
+#define TLS_SESSION_FIELD(field)                       field
+#endif
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static uint32_t tls_session_cache_now_s(void);
+static tls_session_cache_entry_t *tls_session_cache_find(tls_session_cache_t *cache,
+                                                         const unsigned char *id, size_t id_len);
+static int tls_session_cache_lookup(tls_session_cache_t *cache, const unsigned char *id,
+                                    size_t id_len, mbedtls_ssl_session *session);
+static int tls_session_cache_store(tls_session_cache_t *cache, const unsigned char *id,
+                                   size_t id_len, const mbedtls_ssl_session *session);
+
+/*******************************************************************************
+ * Function Name: tls_session_cache_init
+ *******************************************************************************
+ * Summary:
+ *  Empties the session cache and resets its counters.
+ *
+ * Parameters:
+ *  tls_session_cache_t *cache: Session cache
+ *  uint32_t timeout_s: Lifetime of a cached session in seconds
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void tls_session_cache_init(tls_session_cache_t *cache, uint32_t timeout_s)
+{
+    memset(cache, 0, sizeof(*cache));
+    cache->timeout_s = timeout_s;
+}
+
+#if (MBEDTLS_VERSION_NUMBER >= 0x03000000)
+/*******************************************************************************
+ * Function Name: tls_session_cache_get
+ *******************************************************************************
+ * Summary:
+ *  mbedTLS callback that looks up the session a client offers to resume.
+ *
+ * Parameters:
+ *  void *data: Session cache
+ *  unsigned char const *session_id: Session ID offered by the client
+ *  size_t session_id_len: Length of the session ID
+ *  mbedtls_ssl_session *session: Session to be populated on a hit
+ *
+ * Return:
+ *  int: 0 on a hit, non-zero otherwise.
+ *
+ *******************************************************************************/
+int tls_session_cache_get(void *data, unsigned char const *session_id,
+                          size_t session_id_len, mbedtls_ssl_session *session)
+{
+    return tls_session_cache_lookup((tls_session_cache_t *)data, session_id,
+                                    session_id_len, session);
+}
+
+/*******************************************************************************
+ * Function Name: tls_session_cache_set
+ *******************************************************************************
+ * Summary:
+ *  mbedTLS callback that stores the session of a completed full handshake.
+ *
+ * Parameters:
+ *  void *data: Session cache
+ *  unsigned char const *session_id: Session ID assigned by the server
+ *  size_t session_id_len: Length of the session ID
+ *  const mbedtls_ssl_session *session: Session to be stored
+ *
+ * Return:
+ *  int: 0 on success, non-zero otherwise.
+ *
+ *******************************************************************************/
+int tls_session_cache_set(void *data, unsigned char const *session_id,
+                          size_t session_id_len, const mbedtls_ssl_session *session)
+{
+    return tls_session_cache_store((tls_session_cache_t *)data, session_id,
+                                   session_id_len, session);
+}
+#else
+/*******************************************************************************
+ * Function Name: tls_session_cache_get
+ *******************************************************************************
+ * Summary:
+ *  mbedTLS callback that looks up the session a client offers to resume. The
+ *  session ID offered by the client is passed in the session itself.
+ *
+ * Parameters:
+ *  void *data: Session cache
+ *  mbedtls_ssl_session *session: Session to be populated on a hit
+ *
+ * Return:
+ *  int: 0 on a hit, non-zero otherwise.
+ *
+ *******************************************************************************/
+int tls_session_cache_get(void *data, mbedtls_ssl_session *session)
+{
+    unsigned char id[TLS_SESSION_ID_MAX_LEN];
+    size_t id_len = session->id_len;
+
+    if (id_len > sizeof(id))
+    {
+        return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+    }
+
+    /* Loading the cached session overwrites the ID, so look it up from a copy. */
+    memcpy(id, session->id, id_len);
+
+    return tls_session_cache_lookup((tls_session_cache_t *)data, id, id_len, session);
+}
+
+/*******************************************************************************
+ * Function Name: tls_session_cache_set
+ *******************************************************************************
+ * Summary:
+ *  mbedTLS callback that stores the session of a completed full handshake.
+ *
+ * Parameters:
+ *  void *data: Session cache
+ *  const mbedtls_ssl_session *session: Session to be stored
+ *
+ * Return:
+ *  int: 0 on success, non-zero otherwise.
+ *
+ *******************************************************************************/
+int tls_session_cache_set(void *data, const mbedtls_ssl_session *session)
+{
+    return tls_session_cache_store((tls_session_cache_t *)data, session->id,
+                                   session->id_len, session);
+}
+#endif /* MBEDTLS_VERSION_NUMBER >= 0x03000000 */
+
+/*******************************************************************************
+ * Function Name: tls_session_cache_now_s
+ *******************************************************************************
+ * Summary:
+ *  Returns the time since boot in seconds. The RTC is not set in this example,
+ *  so the cache ages its entries using the scheduler tick count.
+ *
+ * Return:
+ *  uint32_t: Time since boot in seconds
+ *
+ *******************************************************************************/
+static uint32_t tls_session_cache_now_s(void)
+{
+    return (uint32_t)(xTaskGetTickCount() / configTICK_RATE_HZ);
+}
+
+/*******************************************************************************
+ * Function Name: tls_session_cache_find
+ *******************************************************************************
+ * Summary:
+ *  Finds the entry holding the given session ID.
+ *
+ * Parameters:
+ *  tls_session_cache_t *cache: Session cache
+ *  const unsigned char *id: Session ID
+ *  size_t id_len: Length of the session ID
+ *
+ * Return:
+ *  tls_session_cache_entry_t *: Matching entry, NULL if there is none.
+ *
+ *******************************************************************************/
+static tls_session_cache_entry_t *tls_session_cache_find(tls_session_cache_t *cache,
+                                                         const unsigned char *id, size_t id_len)
+{
+    for (uint32_t i = 0; i < TLS_SESSION_CACHE_SIZE; i++)
+    {
+        tls_session_cache_entry_t *entry = &cache->entries[i];
+
+        if (entry->in_use && (entry->id_len == id_len) &&
+            (memcmp(entry->id, id, id_len) == 0))
+        {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+ * Function Name: tls_session_cache_lookup
+ *******************************************************************************
+ * Summary:
+ *  Restores the session with the given ID unless it is missing or expired.
+ *  Expired entries are released on lookup.
+ *
+ * Parameters:
+ *  tls_session_cache_t *cache: Session cache
+ *  const unsigned char *id: Session ID
+ *  size_t id_len: Length of the session ID
+ *  mbedtls_ssl_session *session: Session to be populated on a hit
+ *
+ * Return:
+ *  int: 0 on a hit, non-zero otherwise.
+ *
+ *******************************************************************************/
+static int tls_session_cache_lookup(tls_session_cache_t *cache, const unsigned char *id,
+                                    size_t id_len, mbedtls_ssl_session *session)
+{
+    tls_session_cache_entry_t *entry;
+    int ret;
+
+    if ((id_len == 0) || (id_len > TLS_SESSION_ID_MAX_LEN))
+    {
+        cache->stats.misses++;
+        return 1;
+    }
+
+    entry = tls_session_cache_find(cache, id, id_len);
+    if (entry == NULL)
+    {
+        cache->stats.misses++;
+        return 1;
+    }
+
+    if ((tls_session_cache_now_s() - entry->stored_s) > cache->timeout_s)
+    {
+        entry->in_use = false;
+        cache->stats.expired++;
+        cache->stats.misses++;
+        return 1;
+    }
+
+    ret = mbedtls_ssl_session_load(session, entry->data, entry->length);
+    if (ret != 0)
+    {
+        entry->in_use = false;
+        cache->stats.misses++;
+        return ret;
+    }
+
+    cache->stats.hits++;
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: tls_session_cache_store
+ *******************************************************************************
+ * Summary:
+ *  Serializes a session into the cache. The entry is chosen in this order: the
+ *  entry already holding the same ID, a free or expired entry, the oldest
+ *  entry. The peer certificate is not stored; the client was verified during
+ *  the full handshake and the certificate is not needed to resume.
+ *
+ * Parameters:
+ *  tls_session_cache_t *cache: Session cache
+ *  const unsigned char *id: Session ID
+ *  size_t id_len: Length of the session ID
+ *  const mbedtls_ssl_session *session: Session to be stored
+ *
+ * Return:
+ *  int: 0 on success, non-zero otherwise.
+ *
+ *******************************************************************************/
+static int tls_session_cache_store(tls_session_cache_t *cache, const unsigned char *id,
+                                   size_t id_len, const mbedtls_ssl_session *session)
+{
+    uint32_t now_s = tls_session_cache_now_s();
+    tls_session_cache_entry_t *entry;
+    mbedtls_ssl_session stripped;
+    size_t length = 0;
+    int ret;
+
+    if ((id_len == 0) || (id_len > TLS_SESSION_ID_MAX_LEN))
+    {
+        return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+    }
+
+    entry = tls_session_cache_find(cache, id, id_len);
+
+    for (uint32_t i = 0; (entry == NULL) && (i < TLS_SESSION_CACHE_SIZE); i++)
+    {
+        if (!cache->entries[i].in_use ||
+            ((now_s - cache->entries[i].stored_s) > cache->timeout_s))
+        {
+            entry = &cache->entries[i];
+        }
+    }
+
+    if (entry == NULL)
+    {
+        entry = &cache->entries[0];
+        for (uint32_t i = 1; i < TLS_SESSION_CACHE_SIZE; i++)
+        {
+            if ((now_s - cache->entries[i].stored_s) > (now_s - entry->stored_s))
+            {
+                entry = &cache->entries[i];
+            }
+        }
+        cache->stats.evicted++;
+    }
+
+    /* Serialize a shallow copy without the peer certificate. The copy is not
+     * freed, as it shares all its allocations with the original session.
+     */
+    stripped = *session;
+#if defined(MBEDTLS_X509_CRT_PARSE_C) && defined(MBEDTLS_SSL_KEEP_PEER_CERTIFICATE)
+    stripped.TLS_SESSION_FIELD(peer_cert) = NULL;
+#endif
+
+    ret = mbedtls_ssl_session_save(&stripped, entry->data, sizeof(entry->data), &length);
+    if (ret != 0)
+    {
+        entry->in_use = false;
+        cache->stats.store_errors++;
+        return ret;
+    }
+
+    entry->in_use = true;
+    entry->id_len = (uint8_t)id_len;
+    entry->length = (uint16_t)length;
+    entry->stored_s = now_s;
+    memcpy(entry->id, id, id_len);
+    cache->stats.stored++;
+
+    return 0;
+}
+
+
+/* [] END OF FILE */
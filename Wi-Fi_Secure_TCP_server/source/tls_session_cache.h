@@ -0,0 +1,134 @@
+/******************************************************************************
+* File Name:   tls_session_cache.h
+*
+* Description: This file contains declarations of the bounded, time-expiring
+*              TLS session-ID cache used by the secure TCP server to resume
+*              sessions with an abbreviated handshake.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef TLS_SESSION_CACHE_H_
+#define TLS_SESSION_CACHE_H_
+
+/* Standard C header files */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* mbedTLS header files */
+#include "mbedtls/version.h"
+#include "mbedtls/ssl.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Number of sessions kept by the cache. When the cache is full, the oldest
+ * session is evicted.
+ */
+#ifndef TLS_SESSION_CACHE_SIZE
+#define TLS_SESSION_CACHE_SIZE                    (8u)
+#endif
+
+/* Time after which a cached session can no longer be resumed. */
+#ifndef TLS_SESSION_CACHE_TIMEOUT_S
+#define TLS_SESSION_CACHE_TIMEOUT_S               (3600u)
+#endif
+
+/* Size of the serialized session stored per entry. The peer certificate is
+ * not stored, so this only has to hold the master secret, the session ID and a
+ * few parameters.
+ */
+#ifndef TLS_SESSION_CACHE_ENTRY_LEN
+#define TLS_SESSION_CACHE_ENTRY_LEN               (192u)
+#endif
+
+/* Maximum length of a TLS session ID. */
+#define TLS_SESSION_ID_MAX_LEN                    (32u)
+
+/*******************************************************************************
+* Data structure and enumeration
+********************************************************************************/
+/* Counters of the session cache. */
+typedef struct
+{
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t expired;
+    uint32_t stored;
+    uint32_t evicted;
+    uint32_t store_errors;
+} tls_session_cache_stats_t;
+
+/* One cached session. */
+typedef struct
+{
+    bool in_use;
+    uint8_t id_len;
+    uint16_t length;
+    uint32_t stored_s;
+    uint8_t id[TLS_SESSION_ID_MAX_LEN];
+    uint8_t data[TLS_SESSION_CACHE_ENTRY_LEN];
+} tls_session_cache_entry_t;
+
+/* Session cache, passed as the context of the mbedTLS cache callbacks. */
+typedef struct
+{
+    uint32_t timeout_s;
+    tls_session_cache_stats_t stats;
+    tls_session_cache_entry_t entries[TLS_SESSION_CACHE_SIZE];
+} tls_session_cache_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void tls_session_cache_init(tls_session_cache_t *cache, uint32_t timeout_s);
+
+/* Callbacks for mbedtls_ssl_conf_session_cache(). */
+#if (MBEDTLS_VERSION_NUMBER >= 0x03000000)
+int tls_session_cache_get(void *data, unsigned char const *session_id,
+                          size_t session_id_len, mbedtls_ssl_session *session);
+int tls_session_cache_set(void *data, unsigned char const *session_id,
+                          size_t session_id_len, const mbedtls_ssl_session *session);
+#else
+int tls_session_cache_get(void *data, mbedtls_ssl_session *session);
+int tls_session_cache_set(void *data, const mbedtls_ssl_session *session);
+#endif
+
+#endif /* TLS_SESSION_CACHE_H_ */
+
+
+/* [] END OF FILE */
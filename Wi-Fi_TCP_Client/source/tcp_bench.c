@@ -0,0 +1,451 @@
+/******************************************************************************
+* File Name:   tcp_bench.c
+*
+* Description: This file contains the TCP throughput and latency benchmark.
+*              For every configured payload size, the benchmark measures the
+*              round trip time of PING/PONG frames with the DWT cycle counter
+*              and the goodput of a DATA frame stream with the RTOS tick, then
+*              prints a summary table. The peer is tcp_bench.py.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes */
+#include "cyhal.h"
+#include "cybsp.h"
+
+/* RTOS header file */
+#include "cyabs_rtos.h"
+
+/* Cypress secure socket header file */
+#include "cy_secure_sockets.h"
+
+/* Standard C header files */
+#include <inttypes.h>
+#include <stdio.h>
+
+/* TCP frame and benchmark header files. */
+#include "tcp_frame.h"
+#include "tcp_bench.h"
+
+#if(TCP_BENCHMARK_MODE)
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#if defined (COMPONENT_LWIP)
+#define TCP_BENCH_STACK_NAME                      "FreeRTOS + lwIP"
+#elif defined (COMPONENT_NETXDUO)
+#define TCP_BENCH_STACK_NAME                      "ThreadX + NetX Duo"
+#else
+#define TCP_BENCH_STACK_NAME                      "Unknown stack"
+#endif
+
+#define NUM_BENCH_PAYLOAD_SIZES                   (sizeof(bench_payload_sizes) / \
+                                                   sizeof(bench_payload_sizes[0]))
+
+/*******************************************************************************
+* Data structure and enumeration
+********************************************************************************/
+/* Measurements for one payload size. */
+typedef struct
+{
+    uint32_t payload_size;
+    uint32_t bytes_sent;
+    uint32_t elapsed_ms;
+    uint32_t goodput_kbps;
+    uint32_t rtt_min_us;
+    uint32_t rtt_avg_us;
+    uint32_t rtt_max_us;
+    uint32_t timeouts;
+} tcp_bench_result_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static cy_rslt_t tcp_bench_send(cy_socket_t socket_handle, uint32_t length);
+static bool tcp_bench_wait_reply(uint8_t type, uint16_t sequence);
+static void tcp_bench_frame_handler(const tcp_frame_t *frame, void *arg);
+static cy_rslt_t tcp_bench_measure(cy_socket_t socket_handle, uint32_t payload_size,
+                                   tcp_bench_result_t *bench_result);
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+static const uint32_t bench_payload_sizes[] = { TCP_BENCH_PAYLOAD_SIZES };
+
+/* Frame header followed by the payload pattern, reused for every frame. */
+static uint8_t bench_tx_buffer[TCP_FRAME_HEADER_LEN + TCP_BENCH_MAX_PAYLOAD_SIZE];
+
+/* Parser for the PONG and DONE frames received from the peer. */
+static tcp_frame_parser_t bench_rx_parser;
+
+/* Given by the receive handler for every PONG or DONE frame. */
+static cy_semaphore_t bench_reply_sema;
+static volatile uint8_t bench_reply_type;
+static volatile uint16_t bench_reply_sequence;
+
+/* Sequence number of the next frame sent by the benchmark. */
+static uint16_t bench_sequence;
+
+/*******************************************************************************
+ * Function Name: tcp_bench_init
+ *******************************************************************************
+ * Summary:
+ *  Enables the DWT cycle counter and creates the semaphore used to wait for
+ *  the replies of the peer.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  cy_rslt_t: Result of the operation
+ *
+ *******************************************************************************/
+cy_rslt_t tcp_bench_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    for(uint32_t i = 0; i < TCP_BENCH_MAX_PAYLOAD_SIZE; i++)
+    {
+        bench_tx_buffer[TCP_FRAME_HEADER_LEN + i] = (uint8_t)i;
+    }
+
+    return cy_rtos_semaphore_init(&bench_reply_sema, 1, 0);
+}
+
+/*******************************************************************************
+ * Function Name: tcp_bench_run
+ *******************************************************************************
+ * Summary:
+ *  Runs the benchmark for every payload size in TCP_BENCH_PAYLOAD_SIZES on a
+ *  connected socket and prints the summary table. The socket must use
+ *  tcp_bench_recv_handler as its receive callback.
+ *
+ * Parameters:
+ *  cy_socket_t socket_handle: Connected TCP socket
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void tcp_bench_run(cy_socket_t socket_handle)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    tcp_bench_result_t bench_results[NUM_BENCH_PAYLOAD_SIZES];
+    uint32_t num_results = 0;
+
+    tcp_frame_parser_init(&bench_rx_parser);
+
+    printf("===============================================================\n");
+    printf("Running TCP benchmark (%s), %u bytes per payload size\n",
+           TCP_BENCH_STACK_NAME, TCP_BENCH_STREAM_BYTES);
+
+    for(uint32_t i = 0; i < NUM_BENCH_PAYLOAD_SIZES; i++)
+    {
+        if(bench_payload_sizes[i] > TCP_BENCH_MAX_PAYLOAD_SIZE)
+        {
+            printf("Skipping payload size %"PRIu32": larger than TCP_BENCH_MAX_PAYLOAD_SIZE\n",
+                   bench_payload_sizes[i]);
+            continue;
+        }
+
+        result = tcp_bench_measure(socket_handle, bench_payload_sizes[i],
+                                   &bench_results[num_results]);
+        if(result != CY_RSLT_SUCCESS)
+        {
+            printf("Benchmark aborted. Error code: 0x%08"PRIx32"\n", (uint32_t)result);
+            break;
+        }
+        num_results++;
+    }
+
+    printf("===============================================================\n");
+    printf("TCP benchmark summary (%s, CPU clock %"PRIu32" Hz)\n",
+           TCP_BENCH_STACK_NAME, SystemCoreClock);
+    printf(" Payload | Bytes sent | Time (ms) | Goodput (kbps) | RTT min/avg/max (us)   | Timeouts\n");
+    for(uint32_t i = 0; i < num_results; i++)
+    {
+        printf(" %7"PRIu32" | %10"PRIu32" | %9"PRIu32" | %14"PRIu32" | %6"PRIu32" /%6"PRIu32" /%6"PRIu32" | %8"PRIu32"\n",
+               bench_results[i].payload_size, bench_results[i].bytes_sent,
+               bench_results[i].elapsed_ms, bench_results[i].goodput_kbps,
+               bench_results[i].rtt_min_us, bench_results[i].rtt_avg_us,
+               bench_results[i].rtt_max_us, bench_results[i].timeouts);
+    }
+    printf("===============================================================\n");
+}
+
+/*******************************************************************************
+ * Function Name: tcp_bench_recv_handler
+ *******************************************************************************
+ * Summary:
+ *  Receive callback used in benchmark mode. Decodes the frames sent by the
+ *  peer and wakes up the benchmark for every PONG or DONE frame.
+ *
+ * Parameters:
+ *  cy_socket_t socket_handle: Connection handle for the TCP socket
+ *  void *args : Parameter passed on to the function (unused)
+ *
+ * Return:
+ *  cy_result result: Result of the operation
+ *
+ *******************************************************************************/
+cy_rslt_t tcp_bench_recv_handler(cy_socket_t socket_handle, void *arg)
+{
+    cy_rslt_t result;
+    uint8_t *rx_space;
+    uint32_t rx_space_len;
+    uint32_t bytes_received = 0;
+
+    rx_space = tcp_frame_parser_space(&bench_rx_parser, &rx_space_len);
+    result = cy_socket_recv(socket_handle, rx_space, rx_space_len,
+                            CY_SOCKET_FLAGS_NONE, &bytes_received);
+    if(result == CY_RSLT_SUCCESS)
+    {
+        tcp_frame_parser_commit(&bench_rx_parser, bytes_received,
+                                tcp_bench_frame_handler, NULL);
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: tcp_bench_frame_handler
+ *******************************************************************************
+ * Summary:
+ *  Called by the frame parser for every frame received from the peer.
+ *
+ * Parameters:
+ *  const tcp_frame_t *frame: Decoded frame
+ *  void *arg: Parameter passed on to the function (unused)
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void tcp_bench_frame_handler(const tcp_frame_t *frame, void *arg)
+{
+    if((frame->type == TCP_FRAME_TYPE_BENCH_PONG) || (frame->type == TCP_FRAME_TYPE_BENCH_DONE))
+    {
+        bench_reply_type = frame->type;
+        bench_reply_sequence = frame->sequence;
+        cy_rtos_semaphore_set(&bench_reply_sema);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: tcp_bench_measure
+ *******************************************************************************
+ * Summary:
+ *  Measures the round trip time and the goodput for one payload size.
+ *
+ * Parameters:
+ *  cy_socket_t socket_handle: Connected TCP socket
+ *  uint32_t payload_size: Payload size of the PING and DATA frames
+ *  tcp_bench_result_t *bench_result: Receives the measurements
+ *
+ * Return:
+ *  cy_rslt_t: Result of the operation
+ *
+ *******************************************************************************/
+static cy_rslt_t tcp_bench_measure(cy_socket_t socket_handle, uint32_t payload_size,
+                                   tcp_bench_result_t *bench_result)
+{
+    cy_rslt_t result;
+    uint32_t cycles_per_us = SystemCoreClock / 1000000u;
+    uint32_t start_cycles;
+    uint32_t rtt_us;
+    uint64_t rtt_sum_us = 0;
+    uint32_t rtt_samples = 0;
+    cy_time_t start_ms;
+    cy_time_t end_ms;
+
+    bench_result->payload_size = payload_size;
+    bench_result->bytes_sent = 0;
+    bench_result->rtt_min_us = UINT32_MAX;
+    bench_result->rtt_max_us = 0;
+    bench_result->timeouts = 0;
+
+    /* Round trip time: one PING with the payload, one empty PONG back. */
+    for(uint32_t i = 0; i < TCP_BENCH_RTT_ITERATIONS; i++)
+    {
+        tcp_frame_encode_header(bench_tx_buffer, TCP_FRAME_TYPE_BENCH_PING,
+                                bench_sequence, (uint16_t)payload_size);
+        start_cycles = DWT->CYCCNT;
+
+        result = tcp_bench_send(socket_handle, TCP_FRAME_HEADER_LEN + payload_size);
+        if(result != CY_RSLT_SUCCESS)
+        {
+            return result;
+        }
+
+        if(tcp_bench_wait_reply(TCP_FRAME_TYPE_BENCH_PONG, bench_sequence))
+        {
+            rtt_us = (DWT->CYCCNT - start_cycles) / cycles_per_us;
+            rtt_sum_us += rtt_us;
+            rtt_samples++;
+            if(rtt_us < bench_result->rtt_min_us)
+            {
+                bench_result->rtt_min_us = rtt_us;
+            }
+            if(rtt_us > bench_result->rtt_max_us)
+            {
+                bench_result->rtt_max_us = rtt_us;
+            }
+        }
+        else
+        {
+            bench_result->timeouts++;
+        }
+        bench_sequence++;
+    }
+
+    bench_result->rtt_avg_us = (rtt_samples > 0) ? (uint32_t)(rtt_sum_us / rtt_samples) : 0;
+    if(rtt_samples == 0)
+    {
+        bench_result->rtt_min_us = 0;
+    }
+
+    /* Goodput: stream DATA frames, then wait for the peer to echo DONE. */
+    cy_rtos_time_get(&start_ms);
+
+    while(bench_result->bytes_sent < TCP_BENCH_STREAM_BYTES)
+    {
+        tcp_frame_encode_header(bench_tx_buffer, TCP_FRAME_TYPE_BENCH_DATA,
+                                bench_sequence++, (uint16_t)payload_size);
+        result = tcp_bench_send(socket_handle, TCP_FRAME_HEADER_LEN + payload_size);
+        if(result != CY_RSLT_SUCCESS)
+        {
+            return result;
+        }
+        bench_result->bytes_sent += payload_size;
+    }
+
+    tcp_frame_encode_header(bench_tx_buffer, TCP_FRAME_TYPE_BENCH_DONE, bench_sequence, 0);
+    result = tcp_bench_send(socket_handle, TCP_FRAME_HEADER_LEN);
+    if(result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+
+    if(!tcp_bench_wait_reply(TCP_FRAME_TYPE_BENCH_DONE, bench_sequence))
+    {
+        bench_result->timeouts++;
+    }
+    bench_sequence++;
+
+    cy_rtos_time_get(&end_ms);
+    bench_result->elapsed_ms = (uint32_t)(end_ms - start_ms);
+
+    /* bits per millisecond is kbit/s. */
+    bench_result->goodput_kbps = (bench_result->elapsed_ms > 0) ?
+        (uint32_t)(((uint64_t)bench_result->bytes_sent * 8u) / bench_result->elapsed_ms) : 0;
+
+    printf("Payload %4"PRIu32" bytes: %"PRIu32" kbps, RTT avg %"PRIu32" us\n", payload_size,
+           bench_result->goodput_kbps, bench_result->rtt_avg_us);
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: tcp_bench_send
+ *******************************************************************************
+ * Summary:
+ *  Sends the first 'length' bytes of the transmit buffer, retrying until the
+ *  socket accepted all of them.
+ *
+ * Parameters:
+ *  cy_socket_t socket_handle: Connected TCP socket
+ *  uint32_t length: Number of bytes to send
+ *
+ * Return:
+ *  cy_rslt_t: Result of the operation
+ *
+ *******************************************************************************/
+static cy_rslt_t tcp_bench_send(cy_socket_t socket_handle, uint32_t length)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    uint32_t offset = 0;
+    uint32_t bytes_sent = 0;
+
+    while(offset < length)
+    {
+        result = cy_socket_send(socket_handle, &bench_tx_buffer[offset], length - offset,
+                                CY_SOCKET_FLAGS_NONE, &bytes_sent);
+        if(result != CY_RSLT_SUCCESS)
+        {
+            break;
+        }
+        offset += bytes_sent;
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: tcp_bench_wait_reply
+ *******************************************************************************
+ * Summary:
+ *  Waits for the reply of the given type and sequence number. Late replies to
+ *  earlier requests that timed out are skipped.
+ *
+ * Parameters:
+ *  uint8_t type: Expected frame type
+ *  uint16_t sequence: Expected sequence number
+ *
+ * Return:
+ *  bool: true if the reply arrived before TCP_BENCH_REPLY_TIMEOUT_MS
+ *
+ *******************************************************************************/
+static bool tcp_bench_wait_reply(uint8_t type, uint16_t sequence)
+{
+    while(cy_rtos_semaphore_get(&bench_reply_sema, TCP_BENCH_REPLY_TIMEOUT_MS) == CY_RSLT_SUCCESS)
+    {
+        if((bench_reply_type == type) && (bench_reply_sequence == sequence))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+#endif /* TCP_BENCHMARK_MODE */
+
+
+/* [] END OF FILE */
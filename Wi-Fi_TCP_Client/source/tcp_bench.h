@@ -0,0 +1,93 @@
+/******************************************************************************
+* File Name:   tcp_bench.h
+*
+* Description: This file contains declarations of the TCP throughput and
+*              latency benchmark.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef TCP_BENCH_H_
+#define TCP_BENCH_H_
+
+/* Cypress secure socket header file */
+#include "cy_secure_sockets.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* To run the throughput and latency benchmark instead of the LED demo, set this
+ * macro as '1', for example by adding TCP_BENCHMARK_MODE=1 to DEFINES in the
+ * Makefile. The peer must run tcp_bench.py.
+ */
+#ifndef TCP_BENCHMARK_MODE
+#define TCP_BENCHMARK_MODE                        (0)
+#endif
+
+/* Payload sizes measured by the benchmark, one summary table row each. */
+#ifndef TCP_BENCH_PAYLOAD_SIZES
+#define TCP_BENCH_PAYLOAD_SIZES                   64u, 256u, 1024u, 1460u
+#endif
+
+/* Largest entry of TCP_BENCH_PAYLOAD_SIZES. Sizes the transmit buffer. */
+#ifndef TCP_BENCH_MAX_PAYLOAD_SIZE
+#define TCP_BENCH_MAX_PAYLOAD_SIZE                (1460u)
+#endif
+
+/* Number of bytes streamed per payload size for the goodput measurement. */
+#ifndef TCP_BENCH_STREAM_BYTES
+#define TCP_BENCH_STREAM_BYTES                    (256u * 1024u)
+#endif
+
+/* Number of PING/PONG round trips per payload size for the RTT measurement. */
+#ifndef TCP_BENCH_RTT_ITERATIONS
+#define TCP_BENCH_RTT_ITERATIONS                  (50u)
+#endif
+
+/* Time to wait for a PONG or for the DONE echo from the peer. */
+#define TCP_BENCH_REPLY_TIMEOUT_MS                (5000u)
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t tcp_bench_init(void);
+void tcp_bench_run(cy_socket_t socket_handle);
+cy_rslt_t tcp_bench_recv_handler(cy_socket_t socket_handle, void *arg);
+
+#endif /* TCP_BENCH_H_ */
+
+
+/* [] END OF FILE */
@@ -61,6 +61,13 @@
 /* TCP client task header file. */
 #include "tcp_client.h"
 
+/* TCP frame and benchmark header files. */
+#include "tcp_frame.h"
+#include "tcp_bench.h"
+
+/* Receive ring header file. */
+#include "rx_ring.h"
+
 /* IP address related header files. */
 #include "cy_nw_helper.h"
 
@@ -73,6 +80,12 @@
 /* To use the Wi-Fi device in AP interface mode, set this macro as '1' */
 #define USE_AP_INTERFACE                         (0)
 
+/* To exchange length-prefixed binary frames (see tcp_frame.h) instead of
+ * single ASCII bytes and ASCII acknowledgements, set this macro as '1'. The
+ * TCP server must be configured for the same protocol.
+ */
+#define USE_FRAMED_PROTOCOL                      (0)
+
 #define MAKE_IP_PARAMETERS(a, b, c, d)           ((((uint32_t) d) << 24) | \
                                                  (((uint32_t) c) << 16) | \
                                                  (((uint32_t) b) << 8) |\
@@ -145,6 +158,34 @@
 
 #define SEMAPHORE_LIMIT                           (1u)
 
+/* The receive callback hands the received data to the TCP receive task in
+ * chunks of up to TCP_RX_CHUNK_LEN bytes. When all TCP_RX_RING_LEN chunks are
+ * in use, further data stays in the socket, so TCP flow control throttles the
+ * server. TCP_RX_RING_LEN must be a power of two.
+ */
+#define TCP_RX_RING_LEN                           (8u)
+#define TCP_RX_CHUNK_LEN                          (64u)
+
+/* Receive timeout of the client socket. The socket is read until it is empty,
+ * and the read that finds it empty returns after this timeout.
+ */
+#define TCP_RX_RECV_TIMEOUT_MS                    (1u)
+
+/* RTOS related macros for the TCP receive task. */
+#define TCP_RX_TASK_STACK_SIZE                    (4 * 1024)
+#define TCP_RX_TASK_PRIORITY                      CY_RTOS_PRIORITY_NORMAL
+
+/*******************************************************************************
+* Data structure and enumeration
+********************************************************************************/
+/* Data received by the receive callback, processed by the TCP receive task. */
+typedef struct
+{
+    cy_socket_t socket;
+    uint32_t length;
+    uint8_t data[TCP_RX_CHUNK_LEN];
+} tcp_rx_chunk_t;
+
 
 /*******************************************************************************
 * Function Prototypes
@@ -152,8 +193,14 @@
 cy_rslt_t create_tcp_client_socket();
 cy_rslt_t tcp_client_recv_handler(cy_socket_t socket_handle, void *arg);
 cy_rslt_t tcp_disconnection_handler(cy_socket_t socket_handle, void *arg);
+static cy_rslt_t tcp_rx_drain(cy_socket_t socket_handle);
+static void tcp_rx_task(cy_thread_arg_t arg);
+static void tcp_client_process_chunk(const tcp_rx_chunk_t *chunk);
 cy_rslt_t connect_to_tcp_server(cy_socket_sockaddr_t address);
 void read_uart_input(uint8_t* input_buffer_ptr);
+#if(USE_FRAMED_PROTOCOL)
+static void tcp_frame_handler(const tcp_frame_t *frame, void *arg);
+#endif /* USE_FRAMED_PROTOCOL */
 
 #if(USE_AP_INTERFACE)
     static cy_rslt_t softap_start(void);
@@ -173,6 +220,38 @@ cy_semaphore_t connect_to_server;
 /* Holds the IP address obtained for SoftAP using Wi-Fi Connection Manager (WCM). */
 cy_wcm_ip_address_t softap_ip_address;
 
+/* Data received by the receive callback. The TCP receive task is the only
+ * consumer, so that the callback never waits for the processing of the data.
+ */
+tcp_rx_chunk_t tcp_rx_chunks[TCP_RX_RING_LEN];
+rx_ring_t tcp_rx_ring;
+cy_semaphore_t tcp_rx_semaphore;
+cy_thread_t tcp_rx_thread;
+
+/* Serializes the producers of the receive ring: the receive callback and, when
+ * data was left in the socket because the ring was full, the TCP receive task.
+ */
+cy_mutex_t tcp_rx_mutex;
+
+/* Socket with data left in it because the receive ring was full. It raises no
+ * further receive event for that data, so the TCP receive task reads it once
+ * the ring has room. Written with tcp_rx_mutex held.
+ */
+volatile cy_socket_t tcp_rx_backlog_socket;
+
+/* Socket closed by the TCP server, released by the TCP receive task after the
+ * data received before the disconnection.
+ */
+volatile cy_socket_t tcp_rx_closed_socket;
+
+#if(USE_FRAMED_PROTOCOL)
+/* Parser for the frames received from the TCP server. */
+tcp_frame_parser_t rx_parser;
+
+/* Acknowledgement frames coalesced while parsing one received segment. */
+tcp_frame_batch_t tx_batch;
+#endif /* USE_FRAMED_PROTOCOL */
+
 /*******************************************************************************
  * Function Name: tcp_client_task
  *******************************************************************************
@@ -254,6 +333,30 @@ void tcp_client_task(void *arg)
     }
     printf("Secure Socket initialized\n");
 
+#if(TCP_BENCHMARK_MODE)
+    /* Initialize the cycle counter and the reply semaphore of the benchmark. */
+    result = tcp_bench_init();
+    if (result != CY_RSLT_SUCCESS)
+    {
+        printf("TCP benchmark initialization failed!\n");
+        CY_ASSERT(0);
+    }
+#endif /* TCP_BENCHMARK_MODE */
+
+    /* Start the task that processes the data received from the TCP server and
+     * the disconnections.
+     */
+    rx_ring_init(&tcp_rx_ring, tcp_rx_chunks, sizeof(tcp_rx_chunk_t), TCP_RX_RING_LEN);
+    cy_rtos_semaphore_init(&tcp_rx_semaphore, TCP_RX_RING_LEN + 1u, 0);
+    cy_rtos_mutex_init(&tcp_rx_mutex, false);
+    result = cy_rtos_thread_create(&tcp_rx_thread, tcp_rx_task, "TCP rx task", NULL,
+                                   TCP_RX_TASK_STACK_SIZE, TCP_RX_TASK_PRIORITY, NULL);
+    if (result != CY_RSLT_SUCCESS)
+    {
+        printf("TCP receive task creation failed!\n");
+        CY_ASSERT(0);
+    }
+
     for(;;)
     {
         /* Wait till semaphore is acquired so as to connect to a TCP server. */
@@ -297,6 +400,13 @@ void tcp_client_task(void *arg)
             /* Give the semaphore so as to connect to TCP server.  */
             cy_rtos_semaphore_set(&connect_to_server);
         }
+#if(TCP_BENCHMARK_MODE)
+        else
+        {
+            /* Measure the connection to tcp_bench.py. */
+            tcp_bench_run(client_handle);
+        }
+#endif /* TCP_BENCHMARK_MODE */
     }
  }
 
@@ -433,6 +543,9 @@ cy_rslt_t create_tcp_client_socket()
 
     /* TCP keep alive parameters. */
     int keep_alive = 1;
+
+    /* TCP socket receive timeout period. */
+    uint32_t tcp_recv_timeout = TCP_RX_RECV_TIMEOUT_MS;
 #if defined (COMPONENT_LWIP)
     uint32_t keep_alive_interval = TCP_KEEP_ALIVE_INTERVAL_MS;
     uint32_t keep_alive_count    = TCP_KEEP_ALIVE_RETRY_COUNT;
@@ -454,7 +567,11 @@ cy_rslt_t create_tcp_client_socket()
     }
 
     /* Register the callback function to handle messages received from TCP server. */
+#if(TCP_BENCHMARK_MODE)
+    tcp_recv_option.callback = tcp_bench_recv_handler;
+#else
     tcp_recv_option.callback = tcp_client_recv_handler;
+#endif /* TCP_BENCHMARK_MODE */
     tcp_recv_option.arg = NULL;
     result = cy_socket_setsockopt(client_handle, CY_SOCKET_SOL_SOCKET,
                                   CY_SOCKET_SO_RECEIVE_CALLBACK,
@@ -465,6 +582,17 @@ cy_rslt_t create_tcp_client_socket()
         return result;
     }
 
+    /* Set the receive timeout, so that reading the socket until it is empty
+     * does not block the network stack. */
+    result = cy_socket_setsockopt(client_handle, CY_SOCKET_SOL_SOCKET,
+                                  CY_SOCKET_SO_RCVTIMEO, &tcp_recv_timeout,
+                                  sizeof(tcp_recv_timeout));
+    if (result != CY_RSLT_SUCCESS)
+    {
+        printf("Set socket option: CY_SOCKET_SO_RCVTIMEO failed\n");
+        return result;
+    }
+
     /* Register the callback function to handle disconnection. */
     tcp_disconnect_option.callback = tcp_disconnection_handler;
     tcp_disconnect_option.arg = NULL;
@@ -580,7 +708,9 @@ cy_rslt_t connect_to_tcp_server(cy_socket_sockaddr_t address)
  * Function Name: tcp_client_recv_handler
  *******************************************************************************
  * Summary:
- *  Callback function to handle incoming TCP server messages.
+ *  Callback function to handle incoming TCP server messages. Runs in the
+ *  network stack thread: it only receives the data into the receive ring and
+ *  wakes the TCP receive task, which processes it.
  *
  * Parameters:
  *  cy_socket_t socket_handle: Connection handle for the TCP client socket
@@ -592,55 +722,296 @@ cy_rslt_t connect_to_tcp_server(cy_socket_sockaddr_t address)
  *******************************************************************************/
 cy_rslt_t tcp_client_recv_handler(cy_socket_t socket_handle, void *arg)
 {
-    /* Variable to store number of bytes send to the TCP server. */
-    uint32_t bytes_sent = 0;
+    return tcp_rx_drain(socket_handle);
+}
 
+/*******************************************************************************
+ * Function Name: tcp_rx_drain
+ *******************************************************************************
+ * Summary:
+ *  Reads the socket into the receive ring until the socket is empty or the
+ *  ring is full, and wakes the TCP receive task. One receive event may stand
+ *  for several segments, so a single read could leave data in the socket with
+ *  no further event. When the ring is full, the rest of the data stays in the
+ *  socket and the socket is recorded for the TCP receive task.
+ *
+ * Parameters:
+ *  cy_socket_t socket_handle: Connection handle for the TCP client socket
+ *
+ * Return:
+ *  cy_result result: Result of the operation
+ *
+ *******************************************************************************/
+static cy_rslt_t tcp_rx_drain(cy_socket_t socket_handle)
+{
     /* Variable to store number of bytes received. */
-    uint32_t bytes_received = 0;
+    uint32_t bytes_received;
+    uint32_t num_chunks = 0;
+    bool socket_empty = false;
+    tcp_rx_chunk_t *chunk;
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    cy_rtos_mutex_get(&tcp_rx_mutex, CY_RTOS_NEVER_TIMEOUT);
+
+    while(rx_ring_count(&tcp_rx_ring) < TCP_RX_RING_LEN)
+    {
+        chunk = rx_ring_reserve(&tcp_rx_ring);
+        bytes_received = 0;
+        result = cy_socket_recv(socket_handle, chunk->data, TCP_RX_CHUNK_LEN,
+                                CY_SOCKET_FLAGS_NONE, &bytes_received);
+        if((result != CY_RSLT_SUCCESS) || (bytes_received == 0))
+        {
+            socket_empty = true;
+            break;
+        }
+
+        chunk->socket = socket_handle;
+        chunk->length = bytes_received;
+        rx_ring_commit(&tcp_rx_ring);
+        num_chunks++;
+    }
+
+    /* The ring filled up before the socket was empty. */
+    tcp_rx_backlog_socket = socket_empty ? NULL : socket_handle;
+
+    cy_rtos_mutex_set(&tcp_rx_mutex);
+
+    if((num_chunks > 0) || !socket_empty)
+    {
+        cy_rtos_semaphore_set(&tcp_rx_semaphore);
+    }
+
+    /* The read that finds the socket empty times out. */
+    if(result == CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT)
+    {
+        result = CY_RSLT_SUCCESS;
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: tcp_rx_task
+ *******************************************************************************
+ * Summary:
+ *  Task that processes the data queued by the receive callback and the
+ *  disconnections recorded by the disconnection callback, and reads the data
+ *  left in the socket because the receive ring was full.
+ *
+ * Parameters:
+ *  cy_thread_arg_t arg: Task parameter defined during task creation (unused)
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void tcp_rx_task(cy_thread_arg_t arg)
+{
+    const tcp_rx_chunk_t *chunk;
+    cy_socket_t closed_socket;
+    cy_socket_t backlog_socket;
+
+    for(;;)
+    {
+        cy_rtos_semaphore_get(&tcp_rx_semaphore, CY_RTOS_NEVER_TIMEOUT);
+
+        while((chunk = rx_ring_peek(&tcp_rx_ring)) != NULL)
+        {
+            tcp_client_process_chunk(chunk);
+            rx_ring_release(&tcp_rx_ring);
+        }
+
+        /* The ring has room again: read the data left in the socket. It was
+         * received before a disconnection, so process it first.
+         */
+        backlog_socket = tcp_rx_backlog_socket;
+        if(backlog_socket != NULL)
+        {
+            tcp_rx_drain(backlog_socket);
+            if(rx_ring_count(&tcp_rx_ring) > 0)
+            {
+                continue;
+            }
+        }
+
+        closed_socket = tcp_rx_closed_socket;
+        if(closed_socket != NULL)
+        {
+            tcp_rx_closed_socket = NULL;
+
+            cy_rtos_mutex_get(&tcp_rx_mutex, CY_RTOS_NEVER_TIMEOUT);
+            if(tcp_rx_backlog_socket == closed_socket)
+            {
+                tcp_rx_backlog_socket = NULL;
+            }
+            cy_rtos_mutex_set(&tcp_rx_mutex);
+
+            /* Disconnect the TCP client. */
+            cy_socket_disconnect(closed_socket, 0);
+
+            /* Free the resources allocated to the socket. */
+            cy_socket_delete(closed_socket);
+
+#if(USE_FRAMED_PROTOCOL)
+            /* The next connection starts with a new frame. */
+            tcp_frame_parser_init(&rx_parser);
+#endif /* USE_FRAMED_PROTOCOL */
+
+            printf("Disconnected from the TCP server! \n");
+
+            /* Give the semaphore so as to connect to TCP server. */
+            cy_rtos_semaphore_set(&connect_to_server);
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: tcp_client_process_chunk
+ *******************************************************************************
+ * Summary:
+ *  Applies the LED commands received from the TCP server and sends the
+ *  acknowledgements.
+ *
+ * Parameters:
+ *  const tcp_rx_chunk_t *chunk: Data received and the socket it was received on
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void tcp_client_process_chunk(const tcp_rx_chunk_t *chunk)
+{
+    /* Variable to store number of bytes send to the TCP server. */
+    uint32_t bytes_sent = 0;
 
-    char message_buffer[MAX_TCP_DATA_PACKET_LENGTH];
     cy_rslt_t result ;
 
-    printf("============================================================\n");
-    result = cy_socket_recv(socket_handle, message_buffer, TCP_LED_CMD_LEN,
-                            CY_SOCKET_FLAGS_NONE, &bytes_received);
+#if(USE_FRAMED_PROTOCOL)
+    uint8_t *rx_space;
+    uint32_t rx_space_len;
+    uint32_t copy_len;
+    uint32_t offset = 0;
+    uint32_t num_frames = 0;
 
-    if(message_buffer[0] == LED_ON_CMD)
+    /* Decode every complete frame of the chunk. The frame handler queues one
+     * acknowledgement per command into tx_batch.
+     */
+    tcp_frame_batch_init(&tx_batch);
+    while(offset < chunk->length)
     {
-        /* Turn the LED ON. */
-        cyhal_gpio_write(CYBSP_USER_LED, CYBSP_LED_STATE_ON);
-        printf("LED turned ON\n");
-        sprintf(message_buffer, ACK_LED_ON);
+        rx_space = tcp_frame_parser_space(&rx_parser, &rx_space_len);
+        copy_len = chunk->length - offset;
+        if(copy_len > rx_space_len)
+        {
+            copy_len = rx_space_len;
+        }
+        memcpy(rx_space, &chunk->data[offset], copy_len);
+        offset += copy_len;
+        num_frames += tcp_frame_parser_commit(&rx_parser, copy_len,
+                                              tcp_frame_handler, (void *)chunk->socket);
     }
-    else if(message_buffer[0] == LED_OFF_CMD)
+
+    /* Send the acknowledgements of the whole chunk in one send. */
+    if(tx_batch.length > 0)
     {
-        /* Turn the LED OFF. */
-        cyhal_gpio_write(CYBSP_USER_LED, CYBSP_LED_STATE_OFF);
-        printf("LED turned OFF\n");
-        sprintf(message_buffer, ACK_LED_OFF);
+        result = cy_socket_send(chunk->socket, tx_batch.buffer, tx_batch.length,
+                                CY_SOCKET_FLAGS_NONE, &bytes_sent);
+        if(result != CY_RSLT_SUCCESS)
+        {
+            printf("Failed to send acknowledgments to TCP server. Error code: 0x%08"PRIx32"\n", (uint32_t)result);
+        }
     }
-    else
+
+    printf("Command frames received: %"PRIu32" (total: %"PRIu32", errors: %"PRIu32")\n",
+           num_frames, rx_parser.frames, rx_parser.errors);
+#else
+    char message_buffer[MAX_TCP_DATA_PACKET_LENGTH];
+
+    for(uint32_t i = 0; i < chunk->length; i++)
     {
-        printf("Invalid command\n");
-        sprintf(message_buffer, MSG_INVALID_CMD);
+        printf("============================================================\n");
+
+        if(chunk->data[i] == LED_ON_CMD)
+        {
+            /* Turn the LED ON. */
+            cyhal_gpio_write(CYBSP_USER_LED, CYBSP_LED_STATE_ON);
+            printf("LED turned ON\n");
+            sprintf(message_buffer, ACK_LED_ON);
+        }
+        else if(chunk->data[i] == LED_OFF_CMD)
+        {
+            /* Turn the LED OFF. */
+            cyhal_gpio_write(CYBSP_USER_LED, CYBSP_LED_STATE_OFF);
+            printf("LED turned OFF\n");
+            sprintf(message_buffer, ACK_LED_OFF);
+        }
+        else
+        {
+            printf("Invalid command\n");
+            sprintf(message_buffer, MSG_INVALID_CMD);
+        }
+
+        /* Send acknowledgment to the TCP server in receipt of the message received. */
+        result = cy_socket_send(chunk->socket, message_buffer, strlen(message_buffer),
+                                CY_SOCKET_FLAGS_NONE, &bytes_sent);
+        if(result == CY_RSLT_SUCCESS)
+        {
+            printf("Acknowledgment sent to TCP server\n");
+        }
     }
+#endif /* USE_FRAMED_PROTOCOL */
+}
 
-    /* Send acknowledgment to the TCP server in receipt of the message received. */
-    result = cy_socket_send(socket_handle, message_buffer, strlen(message_buffer),
-                            CY_SOCKET_FLAGS_NONE, &bytes_sent);
-    if(result == CY_RSLT_SUCCESS)
+#if(USE_FRAMED_PROTOCOL)
+/*******************************************************************************
+ * Function Name: tcp_frame_handler
+ *******************************************************************************
+ * Summary:
+ *  Called by the frame parser for every complete frame received from the TCP
+ *  server. Applies LED commands and queues the matching acknowledgement. When
+ *  the acknowledgement batch is full it is sent before queuing more.
+ *
+ * Parameters:
+ *  const tcp_frame_t *frame: Decoded frame
+ *  void *arg: Socket handle of the TCP client
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void tcp_frame_handler(const tcp_frame_t *frame, void *arg)
+{
+    uint32_t bytes_sent = 0;
+    uint8_t led_payload;
+
+    if((frame->type != TCP_FRAME_TYPE_LED_CMD) || (frame->length != TCP_FRAME_LED_PAYLOAD_LEN))
     {
-        printf("Acknowledgment sent to TCP server\n");
+        return;
     }
 
-    return result;
+    led_payload = (frame->payload[0] == TCP_FRAME_LED_ON) ? TCP_FRAME_LED_ON : TCP_FRAME_LED_OFF;
+    cyhal_gpio_write(CYBSP_USER_LED, (led_payload == TCP_FRAME_LED_ON) ?
+                     CYBSP_LED_STATE_ON : CYBSP_LED_STATE_OFF);
+
+    if(!tcp_frame_batch_add(&tx_batch, TCP_FRAME_TYPE_LED_ACK, frame->sequence,
+                            &led_payload, TCP_FRAME_LED_PAYLOAD_LEN))
+    {
+        cy_socket_send((cy_socket_t)arg, tx_batch.buffer, tx_batch.length,
+                       CY_SOCKET_FLAGS_NONE, &bytes_sent);
+        tcp_frame_batch_init(&tx_batch);
+        tcp_frame_batch_add(&tx_batch, TCP_FRAME_TYPE_LED_ACK, frame->sequence,
+                            &led_payload, TCP_FRAME_LED_PAYLOAD_LEN);
+    }
 }
+#endif /* USE_FRAMED_PROTOCOL */
 
 /*******************************************************************************
  * Function Name: tcp_disconnection_handler
  *******************************************************************************
  * Summary:
- *  Callback function to handle TCP socket disconnection event.
+ *  Callback function to handle TCP socket disconnection event. Records the
+ *  socket for the TCP receive task, which closes it once the data received
+ *  before the disconnection is processed.
  *
  * Parameters:
  *  cy_socket_t socket_handle: Connection handle for the TCP client socket
@@ -652,20 +1023,10 @@ cy_rslt_t tcp_client_recv_handler(cy_socket_t socket_handle, void *arg)
  *******************************************************************************/
 cy_rslt_t tcp_disconnection_handler(cy_socket_t socket_handle, void *arg)
 {
-    cy_rslt_t result;
-
-    /* Disconnect the TCP client. */
-    result = cy_socket_disconnect(socket_handle, 0);
+    tcp_rx_closed_socket = socket_handle;
+    cy_rtos_semaphore_set(&tcp_rx_semaphore);
 
-    /* Free the resources allocated to the socket. */
-    cy_socket_delete(socket_handle);
-
-    printf("Disconnected from the TCP server! \n");
-
-    /* Give the semaphore so as to connect to TCP server. */
-    cy_rtos_semaphore_set(&connect_to_server);
-
-    return result;
+    return CY_RSLT_SUCCESS;
 }
 
 /*******************************************************************************
@@ -0,0 +1,285 @@
+/******************************************************************************
+* File Name:   tcp_frame.c
+*
+* Description: This file contains the encoder, the stream parser and the
+*              transmit batching of the length-prefixed binary framing used by
+*              the TCP LED protocol in framed mode. The file has no platform
+*              dependencies and builds on the host as well.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Standard C header file */
+#include <string.h>
+
+/* TCP frame header file. */
+#include "tcp_frame.h"
+
+/*******************************************************************************
+ * Function Name: tcp_frame_encode_header
+ *******************************************************************************
+ * Summary:
+ *  Writes a frame header into the given buffer, which must hold at least
+ *  TCP_FRAME_HEADER_LEN bytes. The payload is placed after the header by the
+ *  caller, so large payloads can be sent without copying them.
+ *
+ * Parameters:
+ *  uint8_t *buffer: Destination buffer
+ *  uint8_t type: Frame type
+ *  uint16_t sequence: Sequence number of the frame
+ *  uint16_t payload_len: Length of the payload that follows the header
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void tcp_frame_encode_header(uint8_t *buffer, uint8_t type, uint16_t sequence,
+                             uint16_t payload_len)
+{
+    buffer[0] = TCP_FRAME_MAGIC;
+    buffer[1] = type;
+    buffer[2] = (uint8_t)(sequence >> 8);
+    buffer[3] = (uint8_t)(sequence);
+    buffer[4] = (uint8_t)(payload_len >> 8);
+    buffer[5] = (uint8_t)(payload_len);
+}
+
+/*******************************************************************************
+ * Function Name: tcp_frame_encode
+ *******************************************************************************
+ * Summary:
+ *  Writes one frame (header followed by payload) into the given buffer.
+ *
+ * Parameters:
+ *  uint8_t *buffer: Destination buffer
+ *  uint32_t buffer_len: Size of the destination buffer
+ *  uint8_t type: Frame type
+ *  uint16_t sequence: Sequence number of the frame
+ *  const uint8_t *payload: Payload of the frame (may be NULL if payload_len is 0)
+ *  uint16_t payload_len: Length of the payload
+ *
+ * Return:
+ *  uint32_t: Number of bytes written, 0 if the frame does not fit
+ *
+ *******************************************************************************/
+uint32_t tcp_frame_encode(uint8_t *buffer, uint32_t buffer_len, uint8_t type,
+                          uint16_t sequence, const uint8_t *payload,
+                          uint16_t payload_len)
+{
+    uint32_t frame_len = TCP_FRAME_HEADER_LEN + payload_len;
+
+    if((payload_len > TCP_FRAME_MAX_PAYLOAD_LEN) || (frame_len > buffer_len))
+    {
+        return 0;
+    }
+
+    tcp_frame_encode_header(buffer, type, sequence, payload_len);
+
+    if(payload_len > 0)
+    {
+        memcpy(&buffer[TCP_FRAME_HEADER_LEN], payload, payload_len);
+    }
+
+    return frame_len;
+}
+
+/*******************************************************************************
+ * Function Name: tcp_frame_parser_init
+ *******************************************************************************
+ * Summary:
+ *  Resets a stream parser. Must be called for every new connection.
+ *
+ * Parameters:
+ *  tcp_frame_parser_t *parser: Parser to reset
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void tcp_frame_parser_init(tcp_frame_parser_t *parser)
+{
+    parser->length = 0;
+    parser->frames = 0;
+    parser->errors = 0;
+}
+
+/*******************************************************************************
+ * Function Name: tcp_frame_parser_space
+ *******************************************************************************
+ * Summary:
+ *  Returns the free part of the parser buffer so that the socket can receive
+ *  directly into it without an intermediate copy.
+ *
+ * Parameters:
+ *  tcp_frame_parser_t *parser: Parser
+ *  uint32_t *space_len: Receives the number of free bytes
+ *
+ * Return:
+ *  uint8_t *: Start of the free part of the parser buffer
+ *
+ *******************************************************************************/
+uint8_t *tcp_frame_parser_space(tcp_frame_parser_t *parser, uint32_t *space_len)
+{
+    *space_len = TCP_FRAME_RX_BUFFER_SIZE - parser->length;
+
+    return &parser->buffer[parser->length];
+}
+
+/*******************************************************************************
+ * Function Name: tcp_frame_parser_commit
+ *******************************************************************************
+ * Summary:
+ *  Accounts for the bytes received into the parser buffer and calls the
+ *  callback for every complete frame. A partial frame at the end is kept for
+ *  the next call. Bytes that do not start with the frame magic or announce an
+ *  oversized payload are dropped one at a time until the stream resynchronizes.
+ *
+ * Parameters:
+ *  tcp_frame_parser_t *parser: Parser
+ *  uint32_t bytes_received: Number of bytes written at tcp_frame_parser_space()
+ *  tcp_frame_callback_t callback: Function called for each complete frame
+ *  void *arg: Argument passed on to the callback
+ *
+ * Return:
+ *  uint32_t: Number of frames delivered to the callback
+ *
+ *******************************************************************************/
+uint32_t tcp_frame_parser_commit(tcp_frame_parser_t *parser, uint32_t bytes_received,
+                                 tcp_frame_callback_t callback, void *arg)
+{
+    tcp_frame_t frame;
+    uint32_t offset = 0;
+    uint32_t num_frames = 0;
+
+    parser->length += bytes_received;
+
+    while((parser->length - offset) >= TCP_FRAME_HEADER_LEN)
+    {
+        const uint8_t *header = &parser->buffer[offset];
+
+        frame.length = (uint16_t)(((uint16_t)header[4] << 8) | header[5]);
+
+        if((header[0] != TCP_FRAME_MAGIC) || (frame.length > TCP_FRAME_MAX_PAYLOAD_LEN))
+        {
+            parser->errors++;
+            offset++;
+            continue;
+        }
+
+        if((parser->length - offset) < (TCP_FRAME_HEADER_LEN + frame.length))
+        {
+            /* Wait for the rest of the frame. */
+            break;
+        }
+
+        frame.type = header[1];
+        frame.sequence = (uint16_t)(((uint16_t)header[2] << 8) | header[3]);
+        frame.payload = &header[TCP_FRAME_HEADER_LEN];
+
+        callback(&frame, arg);
+
+        offset += TCP_FRAME_HEADER_LEN + frame.length;
+        num_frames++;
+    }
+
+    /* Move the partial frame, if any, to the start of the buffer. */
+    if(offset > 0)
+    {
+        parser->length -= offset;
+        memmove(parser->buffer, &parser->buffer[offset], parser->length);
+    }
+
+    parser->frames += num_frames;
+
+    return num_frames;
+}
+
+/*******************************************************************************
+ * Function Name: tcp_frame_batch_init
+ *******************************************************************************
+ * Summary:
+ *  Empties a transmit batch.
+ *
+ * Parameters:
+ *  tcp_frame_batch_t *batch: Batch to empty
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void tcp_frame_batch_init(tcp_frame_batch_t *batch)
+{
+    batch->length = 0;
+    batch->frames = 0;
+}
+
+/*******************************************************************************
+ * Function Name: tcp_frame_batch_add
+ *******************************************************************************
+ * Summary:
+ *  Appends one frame to a transmit batch. The caller sends the batch with a
+ *  single socket send once it is full or there is nothing more to add.
+ *
+ * Parameters:
+ *  tcp_frame_batch_t *batch: Batch to append to
+ *  uint8_t type: Frame type
+ *  uint16_t sequence: Sequence number of the frame
+ *  const uint8_t *payload: Payload of the frame
+ *  uint16_t payload_len: Length of the payload
+ *
+ * Return:
+ *  bool: true if the frame was added, false if the batch is full
+ *
+ *******************************************************************************/
+bool tcp_frame_batch_add(tcp_frame_batch_t *batch, uint8_t type, uint16_t sequence,
+                         const uint8_t *payload, uint16_t payload_len)
+{
+    uint32_t frame_len = tcp_frame_encode(&batch->buffer[batch->length],
+                                          TCP_FRAME_TX_BUFFER_SIZE - batch->length,
+                                          type, sequence, payload, payload_len);
+    if(frame_len == 0)
+    {
+        return false;
+    }
+
+    batch->length += frame_len;
+    batch->frames++;
+
+    return true;
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,126 @@
+#******************************************************************************
+# File Name:   tcp_bench.py
+#
+# Description: Host peer of the TCP throughput and latency benchmark
+#              (TCP_BENCHMARK_MODE, see source/tcp_bench.h). Answers PING
+#              frames with PONG, counts DATA frames, and echoes DONE. Use
+#              --server for Wi-Fi_TCP_Client and --client <kit IP> for
+#              Wi-Fi_TCP_Server, with the same harness for FreeRTOS + lwIP
+#              and ThreadX + NetX Duo builds.
+#
+#******************************************************************************
+# Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+# an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+#
+# This software, including source code, documentation and related
+# materials ("Software") is owned by Cypress Semiconductor Corporation
+# or one of its affiliates ("Cypress") and is protected by and subject to
+# worldwide patent protection (United States and foreign),
+# United States copyright laws and international treaty provisions.
+# Therefore, you may use this Software only as provided in the license
+# agreement accompanying the software package from which you
+# obtained this Software ("EULA").
+# If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+# non-transferable license to copy, modify, and compile the Software
+# source code solely for use in connection with Cypress's
+# integrated circuit products.  Any reproduction, modification, translation,
+# compilation, or representation of this Software except as specified
+# above is prohibited without the express written permission of Cypress.
+#
+# Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+# EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+# reserves the right to make changes to the Software without notice. Cypress
+# does not assume any liability arising out of the application or use of the
+# Software or any product or circuit described in the Software. Cypress does
+# not authorize its products for use in any products where a malfunction or
+# failure of the Cypress product may reasonably be expected to result in
+# significant property damage, injury or death ("High Risk Product"). By
+# including Cypress's product in a High Risk Product, the manufacturer
+# of such system or application assumes all risk of such use and in doing
+# so agrees to indemnify Cypress against all liability.
+#******************************************************************************
+
+#!/usr/bin/env python
+import socket
+import optparse
+import time
+import sys
+import tcp_frame
+
+DEFAULT_PORT     = 50007         # Port of the TCP server
+RECV_BUFF_SIZE   = 8192          # Receive buffer size
+MAX_PAYLOAD      = 65535         # Benchmark payloads may exceed the LED frame limit
+
+def serve_benchmark(conn):
+    conn.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+    parser = tcp_frame.FrameParser(max_payload=MAX_PAYLOAD)
+    rows = []
+    stream_bytes = 0
+    stream_start = None
+    payload_size = 0
+
+    while True:
+        data = conn.recv(RECV_BUFF_SIZE)
+        if not data:
+            break
+        replies = []
+        for (frame_type, seq, payload) in parser.feed(data):
+            if frame_type == tcp_frame.FRAME_TYPE_BENCH_PING:
+                replies.append(tcp_frame.encode(tcp_frame.FRAME_TYPE_BENCH_PONG, seq))
+            elif frame_type == tcp_frame.FRAME_TYPE_BENCH_DATA:
+                if stream_start is None:
+                    stream_start = time.perf_counter()
+                stream_bytes += len(payload)
+                payload_size = len(payload)
+            elif frame_type == tcp_frame.FRAME_TYPE_BENCH_DONE:
+                replies.append(tcp_frame.encode(tcp_frame.FRAME_TYPE_BENCH_DONE, seq))
+                elapsed = time.perf_counter() - stream_start if stream_start else 0.0
+                kbps = (stream_bytes * 8 / 1000.0) / elapsed if elapsed > 0 else 0.0
+                rows.append((payload_size, stream_bytes, elapsed * 1000.0, kbps))
+                print("Payload %4d bytes: received %d bytes, %.0f kbps" % (payload_size, stream_bytes, kbps))
+                stream_bytes = 0
+                stream_start = None
+        if replies:
+            conn.send(b''.join(replies))
+
+    print("==========================")
+    print("Host-side benchmark summary")
+    print(" Payload | Bytes received | Time (ms) | Goodput (kbps)")
+    for (size, received, elapsed_ms, kbps) in rows:
+        print(" %7d | %14d | %9.1f | %14.0f" % (size, received, elapsed_ms, kbps))
+    print("Frame errors: %d" % parser.errors)
+
+parser = optparse.OptionParser()
+parser.add_option("-s", "--server", dest="server", action="store_true", default=False,
+                  help="Listen for the kit (Wi-Fi_TCP_Client)")
+parser.add_option("-c", "--client", dest="client", default=None,
+                  help="Connect to the kit at this IP address (Wi-Fi_TCP_Server)")
+parser.add_option("-p", "--port", dest="port", type="int", default=DEFAULT_PORT,
+                  help="TCP port")
+(options, args) = parser.parse_args()
+
+print("==========================")
+print("TCP Benchmark Peer")
+print("==========================")
+
+if options.client:
+    conn = socket.create_connection((options.client, options.port))
+    print("Connected to TCP Server (IP Address: %s Port: %d)" % (options.client, options.port))
+    print("Press the user button on the kit to start the benchmark")
+    serve_benchmark(conn)
+elif options.server:
+    s = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    s.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    s.bind(('', options.port))
+    s.listen(1)
+    print("Listening on port %d" % options.port)
+    conn, addr = s.accept()
+    print('Incoming connection accepted: ', addr)
+    serve_benchmark(conn)
+    s.close()
+else:
+    parser.print_help()
+    sys.exit(1)
+
+# [] END OF FILE
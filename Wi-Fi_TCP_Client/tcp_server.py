@@ -46,11 +46,27 @@ import optparse
 import time
 import sys
 import threading
+import tcp_frame
 
 host = socket.gethostbyname(socket.gethostname())  # IP address of the TCP server
 port = 50007                                       # Arbitrary non-privileged port
 RECV_BUFF_SIZE = 4096                              # Receive buffer size
 DEFAULT_KEEP_ALIVE = 1                             # TCP Keep Alive: 1 - Enable, 0 - Disable
+DEFAULT_BATCH_SIZE = 64                            # Command frames per send in benchmark mode
+
+parser = optparse.OptionParser()
+parser.add_option("-f", "--framed", dest="framed", action="store_true", default=False,
+                  help="Use the length-prefixed binary framing (USE_FRAMED_PROTOCOL)")
+parser.add_option("-b", "--bench", dest="bench", type="int", default=0,
+                  help="Pipeline this many LED commands to the client and report the rate (framed mode)")
+parser.add_option("-s", "--batch", dest="batch", type="int", default=DEFAULT_BATCH_SIZE,
+                  help="Command frames coalesced into one send in benchmark mode")
+(options, args) = parser.parse_args()
+if options.bench:
+    options.framed = True
+
+# sequence number of the next command frame
+tx_sequence = 0
 
 print("==========================")
 print("TCP Server")
@@ -78,19 +94,49 @@ class KeyboardThread(threading.Thread):
             self.input_cbk(input()) #waits to get input + Return
 
 def read_user_data(inp):
+    global tx_sequence
     #evaluate the keyboard input
     if(is_client_connected == True):
         if(inp == ""):
             print("No option entered!")
             print("Enter your option: '1' to turn ON LED, 0 to turn"\
                             " OFF LED and Press the 'Enter' key: ")
+        elif options.framed:
+            led = tcp_frame.FRAME_LED_ON if inp == '1' else tcp_frame.FRAME_LED_OFF
+            conn.send(tcp_frame.encode(tcp_frame.FRAME_TYPE_LED_CMD, tx_sequence, bytes([led])))
+            tx_sequence += 1
         else:
             conn.send(inp.encode())
     else:
         print("No active client connection. Command not send")
 
+def run_benchmark(conn, num_cmds, batch_size):
+    # Keep up to a few batches in flight and count the acknowledgement frames.
+    ack_parser = tcp_frame.FrameParser()
+    sent = 0
+    acked = 0
+    start = time.perf_counter()
+    while acked < num_cmds:
+        while sent < num_cmds and sent - acked < 4 * batch_size:
+            count = min(batch_size, num_cmds - sent)
+            conn.send(b''.join(tcp_frame.encode(tcp_frame.FRAME_TYPE_LED_CMD, seq, bytes([seq & 1]))
+                               for seq in range(sent, sent + count)))
+            sent += count
+        data = conn.recv(RECV_BUFF_SIZE)
+        if not data:
+            print("TCP Client closed the connection after", acked, "acknowledgements")
+            break
+        acked += sum(1 for (frame_type, seq, payload) in ack_parser.feed(data)
+                     if frame_type == tcp_frame.FRAME_TYPE_LED_ACK)
+    elapsed = time.perf_counter() - start
+    print("==========================")
+    print("Commands acknowledged: %d/%d in %.3f s" % (acked, num_cmds, elapsed))
+    print("Command rate: %.0f commands/s (%d frames per send)" % (acked / elapsed, batch_size))
+    print("Frame errors: %d" % ack_parser.errors)
+
 #start the Keyboard thread
-kthread = KeyboardThread(read_user_data)
+if not options.bench:
+    kthread = KeyboardThread(read_user_data)
 
 # Bind the socket to host IP address and port
 try:
@@ -119,6 +165,15 @@ while True:
 
     print('Incoming connection accepted: ', addr)
 
+    if options.bench:
+        conn.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        run_benchmark(conn, options.bench, options.batch)
+        conn.close()
+        s.close()
+        sys.exit(0)
+
+    ack_parser = tcp_frame.FrameParser()
+
     while True:
         try:
             print("Enter your option: '1' to turn ON LED, 0 to turn"\
@@ -126,7 +181,12 @@ while True:
             
             data = conn.recv(RECV_BUFF_SIZE)
             if not data: break
-            print("Acknowledgement from TCP Client:", data.decode('utf-8'))
+            if options.framed:
+                for (frame_type, seq, payload) in ack_parser.feed(data):
+                    print("Acknowledgement from TCP Client: seq %d LED %s"
+                          % (seq, "ON" if payload == bytes([tcp_frame.FRAME_LED_ON]) else "OFF"))
+            else:
+                print("Acknowledgement from TCP Client:", data.decode('utf-8'))
             print("")
             
         except socket.error:
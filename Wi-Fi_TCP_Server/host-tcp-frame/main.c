@@ -0,0 +1,529 @@
+/******************************************************************************
+* File Name: main.c
+*
+* Description: This is the host test and benchmark of the length-prefixed
+* binary framing of the TCP LED protocol (../source/tcp_frame.c). It encodes a
+* stream of frames and parses it split at random points, coalesced into full
+* receive buffers, and preceded by garbage, and checks every decoded frame.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+*******************************************************************************/
+
+/* Standard C header files */
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* TCP frame header file. */
+#include "tcp_frame.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Frames in the test stream. */
+#define TEST_FRAMES                              (20000u)
+
+/* Room for the test stream, with the garbage between the frames. */
+#define TEST_STREAM_SIZE                         (TEST_FRAMES * (TCP_FRAME_HEADER_LEN + \
+                                                  TCP_FRAME_MAX_PAYLOAD_LEN + 8u))
+
+/* Passes over the test stream timed by the benchmark. */
+#define BENCHMARK_PASSES                         (50u)
+
+/*******************************************************************************
+* Data structure and enumeration
+*******************************************************************************/
+/* Frame expected from the parser. */
+typedef struct
+{
+    uint8_t type;
+    uint16_t sequence;
+    uint16_t length;
+    uint32_t offset;
+} expected_frame_t;
+
+/* Ways the stream is handed to the parser. */
+typedef enum
+{
+    FEED_SPLIT,                                    /* Random segments of 1 to 64 bytes */
+    FEED_BYTE,                                     /* One byte at a time */
+    FEED_COALESCED                                 /* As much as the parser buffer holds */
+} feed_mode_t;
+
+/* State checked by the frame callback. */
+typedef struct
+{
+    const expected_frame_t *expected;
+    uint32_t num_expected;
+    uint32_t next;
+} check_state_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static uint8_t stream[TEST_STREAM_SIZE];
+static uint32_t stream_length;
+static expected_frame_t expected[TEST_FRAMES];
+
+static tcp_frame_parser_t parser;
+static tcp_frame_batch_t batch;
+
+static uint32_t random_state = 0x12345678u;
+static uint32_t failures;
+
+/*******************************************************************************
+ * Function Name: next_random
+ *******************************************************************************
+ * Summary:
+ *  Returns the next number of a xorshift generator, so that every run
+ *  performs the same operations.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  uint32_t: Pseudo-random number
+ *
+ *******************************************************************************/
+static uint32_t next_random(void)
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+/*******************************************************************************
+ * Function Name: now_ns
+ *******************************************************************************
+ * Summary:
+ *  Returns a monotonic time stamp.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  double: Time in nanoseconds
+ *
+ *******************************************************************************/
+static double now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((double)ts.tv_sec * 1e9) + (double)ts.tv_nsec;
+}
+
+/*******************************************************************************
+ * Function Name: check
+ *******************************************************************************
+ * Summary:
+ *  Counts and reports a failed check.
+ *
+ * Parameters:
+ *  int condition: Result of the check
+ *  const char *what: Description of the check
+ *  uint32_t n: Frame or operation number
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void check(int condition, const char *what, uint32_t n)
+{
+    if (!condition)
+    {
+        if (failures < 10u)
+        {
+            printf("FAILED: %s (%u)\n", what, (unsigned)n);
+        }
+        failures++;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: build_stream
+ *******************************************************************************
+ * Summary:
+ *  Encodes the test stream: LED commands and acknowledgements and benchmark
+ *  frames with payloads of random length and content. With garbage set, up to
+ *  8 bytes that never start a frame precede every frame.
+ *
+ * Parameters:
+ *  int garbage: Non-zero to add garbage before the frames
+ *
+ * Return:
+ *  uint32_t: Number of garbage bytes in the stream
+ *
+ *******************************************************************************/
+static uint32_t build_stream(int garbage)
+{
+    static const uint8_t types[] = { TCP_FRAME_TYPE_LED_CMD, TCP_FRAME_TYPE_LED_ACK,
+                                     TCP_FRAME_TYPE_BENCH_PING, TCP_FRAME_TYPE_BENCH_DATA };
+    uint8_t payload[TCP_FRAME_MAX_PAYLOAD_LEN];
+    uint32_t garbage_bytes = 0;
+    uint32_t frame_len;
+    uint32_t count;
+    uint32_t n;
+    uint32_t i;
+
+    stream_length = 0;
+
+    for (n = 0; n < TEST_FRAMES; n++)
+    {
+        if (garbage)
+        {
+            for (count = next_random() % 9u; count > 0u; count--)
+            {
+                /* Any byte but the magic, so that no frame starts in it. */
+                stream[stream_length++] = (uint8_t)(next_random() % TCP_FRAME_MAGIC);
+                garbage_bytes++;
+            }
+        }
+
+        expected[n].type = types[next_random() % sizeof(types)];
+        expected[n].sequence = (uint16_t)n;
+        expected[n].length = (expected[n].type == TCP_FRAME_TYPE_BENCH_DATA) ?
+                             (uint16_t)(next_random() % (TCP_FRAME_MAX_PAYLOAD_LEN + 1u)) :
+                             (uint16_t)TCP_FRAME_LED_PAYLOAD_LEN;
+
+        for (i = 0; i < expected[n].length; i++)
+        {
+            payload[i] = (uint8_t)next_random();
+        }
+
+        frame_len = tcp_frame_encode(&stream[stream_length], TEST_STREAM_SIZE - stream_length,
+                                     expected[n].type, expected[n].sequence, payload,
+                                     expected[n].length);
+        check(frame_len == (TCP_FRAME_HEADER_LEN + expected[n].length), "encode", n);
+
+        expected[n].offset = stream_length + TCP_FRAME_HEADER_LEN;
+        stream_length += frame_len;
+    }
+
+    return garbage_bytes;
+}
+
+/*******************************************************************************
+ * Function Name: check_frame
+ *******************************************************************************
+ * Summary:
+ *  Frame callback of the parser. Compares the frame with the next expected
+ *  frame of the stream.
+ *
+ * Parameters:
+ *  const tcp_frame_t *frame: Decoded frame
+ *  void *arg: check_state_t of the stream
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void check_frame(const tcp_frame_t *frame, void *arg)
+{
+    check_state_t *state = (check_state_t *)arg;
+    const expected_frame_t *e;
+
+    if (state->next >= state->num_expected)
+    {
+        check(0, "frame beyond the stream", state->next++);
+        return;
+    }
+
+    e = &state->expected[state->next];
+    check((frame->type == e->type) && (frame->sequence == e->sequence) &&
+          (frame->length == e->length) &&
+          (0 == memcmp(frame->payload, &stream[e->offset], e->length)),
+          "decoded frame", state->next);
+    state->next++;
+}
+
+/*******************************************************************************
+ * Function Name: feed_stream
+ *******************************************************************************
+ * Summary:
+ *  Receives the test stream into the parser as a socket would and commits
+ *  every segment.
+ *
+ * Parameters:
+ *  feed_mode_t mode: How the stream is split into segments
+ *  tcp_frame_callback_t callback: Function called for each complete frame
+ *  void *arg: Argument passed on to the callback
+ *
+ * Return:
+ *  uint32_t: Number of frames delivered to the callback
+ *
+ *******************************************************************************/
+static uint32_t feed_stream(feed_mode_t mode, tcp_frame_callback_t callback, void *arg)
+{
+    uint32_t offset = 0;
+    uint32_t num_frames = 0;
+    uint32_t space_len;
+    uint32_t segment_len;
+    uint8_t *space;
+
+    tcp_frame_parser_init(&parser);
+
+    while (offset < stream_length)
+    {
+        space = tcp_frame_parser_space(&parser, &space_len);
+
+        switch (mode)
+        {
+            case FEED_SPLIT:
+                segment_len = 1u + (next_random() % 64u);
+                break;
+            case FEED_BYTE:
+                segment_len = 1u;
+                break;
+            default:
+                segment_len = space_len;
+                break;
+        }
+
+        if (segment_len > space_len)
+        {
+            segment_len = space_len;
+        }
+        if (segment_len > (stream_length - offset))
+        {
+            segment_len = stream_length - offset;
+        }
+
+        memcpy(space, &stream[offset], segment_len);
+        offset += segment_len;
+        num_frames += tcp_frame_parser_commit(&parser, segment_len, callback, arg);
+    }
+
+    return num_frames;
+}
+
+/*******************************************************************************
+ * Function Name: check_feed
+ *******************************************************************************
+ * Summary:
+ *  Parses the test stream in one feed mode and checks the frames, the bytes
+ *  dropped as garbage and that nothing is left in the parser.
+ *
+ * Parameters:
+ *  feed_mode_t mode: How the stream is split into segments
+ *  uint32_t garbage_bytes: Number of garbage bytes in the stream
+ *  const char *what: Description of the check
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void check_feed(feed_mode_t mode, uint32_t garbage_bytes, const char *what)
+{
+    check_state_t state = { expected, TEST_FRAMES, 0 };
+    uint32_t num_frames = feed_stream(mode, check_frame, &state);
+
+    check((num_frames == TEST_FRAMES) && (state.next == TEST_FRAMES), what, num_frames);
+    check(parser.errors == garbage_bytes, what, parser.errors);
+    check(parser.length == 0u, what, parser.length);
+}
+
+/*******************************************************************************
+ * Function Name: count_frame
+ *******************************************************************************
+ * Summary:
+ *  Frame callback of the benchmark. Only reads the frame.
+ *
+ * Parameters:
+ *  const tcp_frame_t *frame: Decoded frame
+ *  void *arg: Sum of the frame sequence numbers
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void count_frame(const tcp_frame_t *frame, void *arg)
+{
+    *(uint32_t *)arg += frame->sequence;
+}
+
+/*******************************************************************************
+ * Function Name: check_batch
+ *******************************************************************************
+ * Summary:
+ *  Fills a transmit batch with LED acknowledgements, as the TCP client does
+ *  for all the commands of a segment, and parses it back.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void check_batch(void)
+{
+    expected_frame_t batch_expected[TCP_FRAME_TX_BUFFER_SIZE / TCP_FRAME_HEADER_LEN];
+    check_state_t state = { batch_expected, 0, 0 };
+    uint8_t payload = TCP_FRAME_LED_ON;
+    uint32_t space_len;
+    uint8_t *space;
+
+    tcp_frame_batch_init(&batch);
+    while (tcp_frame_batch_add(&batch, TCP_FRAME_TYPE_LED_ACK, (uint16_t)batch.frames,
+                               &payload, TCP_FRAME_LED_PAYLOAD_LEN))
+    {
+        batch_expected[state.num_expected].type = TCP_FRAME_TYPE_LED_ACK;
+        batch_expected[state.num_expected].sequence = (uint16_t)state.num_expected;
+        batch_expected[state.num_expected].length = TCP_FRAME_LED_PAYLOAD_LEN;
+        state.num_expected++;
+    }
+
+    check(batch.frames == (TCP_FRAME_TX_BUFFER_SIZE /
+                           (TCP_FRAME_HEADER_LEN + TCP_FRAME_LED_PAYLOAD_LEN)),
+          "fill the transmit batch", batch.frames);
+
+    /* The payloads are compared with the test stream, so place the batch there. */
+    memcpy(stream, batch.buffer, batch.length);
+    for (uint32_t n = 0; n < state.num_expected; n++)
+    {
+        batch_expected[n].offset = (n * (TCP_FRAME_HEADER_LEN + TCP_FRAME_LED_PAYLOAD_LEN)) +
+                                   TCP_FRAME_HEADER_LEN;
+    }
+
+    tcp_frame_parser_init(&parser);
+    space = tcp_frame_parser_space(&parser, &space_len);
+    memcpy(space, batch.buffer, batch.length);
+    check(tcp_frame_parser_commit(&parser, batch.length, check_frame, &state) == batch.frames,
+          "parse the transmit batch", state.next);
+}
+
+/*******************************************************************************
+ * Function Name: check_oversized
+ *******************************************************************************
+ * Summary:
+ *  Checks that a header announcing a payload beyond TCP_FRAME_MAX_PAYLOAD_LEN
+ *  is dropped and the parser resynchronizes on the next frame.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void check_oversized(void)
+{
+    expected_frame_t oversized_expected = { TCP_FRAME_TYPE_LED_CMD, 7u, TCP_FRAME_LED_PAYLOAD_LEN, 0 };
+    check_state_t state = { &oversized_expected, 1u, 0 };
+    uint8_t payload = TCP_FRAME_LED_OFF;
+    uint32_t space_len;
+    uint32_t length;
+
+    tcp_frame_encode_header(stream, TCP_FRAME_TYPE_BENCH_DATA, 0u, TCP_FRAME_MAX_PAYLOAD_LEN + 1u);
+    length = TCP_FRAME_HEADER_LEN;
+    length += tcp_frame_encode(&stream[length], TEST_STREAM_SIZE - length, TCP_FRAME_TYPE_LED_CMD,
+                               7u, &payload, TCP_FRAME_LED_PAYLOAD_LEN);
+    oversized_expected.offset = length - TCP_FRAME_LED_PAYLOAD_LEN;
+
+    check(0u == tcp_frame_encode(&stream[length], TEST_STREAM_SIZE - length, TCP_FRAME_TYPE_BENCH_DATA,
+                                 0u, stream, TCP_FRAME_MAX_PAYLOAD_LEN + 1u),
+          "refuse to encode an oversized payload", 0);
+
+    tcp_frame_parser_init(&parser);
+    memcpy(tcp_frame_parser_space(&parser, &space_len), stream, length);
+    check(1u == tcp_frame_parser_commit(&parser, length, check_frame, &state),
+          "resynchronize after an oversized header", state.next);
+    check(TCP_FRAME_HEADER_LEN == parser.errors, "drop an oversized header", parser.errors);
+}
+
+/*******************************************************************************
+ * Function Name: main
+ *******************************************************************************
+ * Summary:
+ *  Checks the codec on split, coalesced and garbage-prefixed streams, then
+ *  measures the parser on coalesced and split streams.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  int: Number of failed checks.
+ *
+ *******************************************************************************/
+int main(void)
+{
+    static const char *mode_names[] = { "split", "byte", "coalesced" };
+    uint32_t garbage_bytes;
+    uint32_t sum = 0;
+    uint32_t pass;
+    uint32_t mode;
+    double start;
+    double elapsed_ns;
+
+    (void)build_stream(0);
+    printf("TCP frame codec: %u frames, %u bytes, %u-byte parser buffer\n",
+           (unsigned)TEST_FRAMES, (unsigned)stream_length, (unsigned)TCP_FRAME_RX_BUFFER_SIZE);
+
+    check_feed(FEED_SPLIT, 0u, "split stream");
+    check_feed(FEED_BYTE, 0u, "stream one byte at a time");
+    check_feed(FEED_COALESCED, 0u, "coalesced stream");
+
+    garbage_bytes = build_stream(1);
+    check_feed(FEED_SPLIT, garbage_bytes, "split stream with garbage");
+    check_feed(FEED_COALESCED, garbage_bytes, "coalesced stream with garbage");
+
+    (void)build_stream(0);
+    for (mode = FEED_SPLIT; mode <= FEED_COALESCED; mode++)
+    {
+        start = now_ns();
+        for (pass = 0; pass < BENCHMARK_PASSES; pass++)
+        {
+            (void)feed_stream((feed_mode_t)mode, count_frame, &sum);
+        }
+        elapsed_ns = now_ns() - start;
+
+        printf("Parse %-9s: %.1f ns per frame, %.0f MB/s\n", mode_names[mode],
+               elapsed_ns / (BENCHMARK_PASSES * TEST_FRAMES),
+               ((double)stream_length * BENCHMARK_PASSES * 1e3) / elapsed_ns);
+    }
+    check(sum == (BENCHMARK_PASSES * 3u * ((TEST_FRAMES * (TEST_FRAMES - 1u)) / 2u)),
+          "frames of the benchmark", sum);
+
+    check_batch();
+    check_oversized();
+
+    printf("%s: %u failed checks\n", (0u == failures) ? "PASSED" : "FAILED", (unsigned)failures);
+
+    return (int)failures;
+}
+
+
+/* [] END OF FILE */
@@ -804,5 +804,27 @@ UINT cy_rand( void );
 #define NX_RAND                         cy_rand
 #endif
 
+/*
+ * Defines for the zero-copy TCP server of the application (nx_tcp_server.c).
+ */
+
+/* Set to 1 to run the TCP server directly on NetX Duo instead of the secure
+   sockets API. Received NX_PACKET chains are handed to the application without
+   being copied and commands are built in packets of the application pool. */
+#define APP_NX_ZERO_COPY_ENABLE         0
+
+/* Number of packets in the application transmit pool. Must cover
+   APP_NX_MAX_PACKETS_IN_FLIGHT for every connected client. */
+#define APP_NX_PACKET_POOL_SIZE         16
+
+/* Payload size of a packet of the application transmit pool. Includes the
+   NX_PHYSICAL_HEADER and the TCP/IP headers, which leaves 44 bytes of data
+   per packet with the default of 128. */
+#define APP_NX_PACKET_PAYLOAD_SIZE      128
+
+/* Maximum number of unacknowledged packets queued on one client socket.
+   Sends beyond this depth fail immediately instead of draining the pool. */
+#define APP_NX_MAX_PACKETS_IN_FLIGHT    2
+
 #endif
 
@@ -0,0 +1,706 @@
+/******************************************************************************
+* File Name:   nx_tcp_server.c
+*
+* Description: This file contains the zero-copy TCP server that runs directly
+*              on NetX Duo. Received NX_PACKET chains are handed to the
+*              application without being copied into a receive buffer and can
+*              be reused for the reply. Commands are built in packets of a
+*              dedicated application pool sized in nx_user.h.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes */
+#include "cyabs_rtos.h"
+
+/* Zero-copy TCP server header file. */
+#include "nx_tcp_server.h"
+
+/* Standard C header files */
+#include <inttypes.h>
+#include <stdio.h>
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#if(APP_NX_ZERO_COPY_ENABLE)
+
+/* Server thread that accepts connections and dispatches received packets. */
+#define NX_TCP_SERVER_THREAD_STACK_SIZE           (1024 * 4)
+#define NX_TCP_SERVER_THREAD_PRIORITY             (CY_RTOS_PRIORITY_ABOVENORMAL)
+
+/* Number of connection requests NetX Duo queues while no socket listens. */
+#define NX_TCP_SERVER_LISTEN_QUEUE_SIZE           (3u)
+
+/* Timeouts of the connection handshake and of the graceful close, in ticks. */
+#define NX_TCP_SERVER_ACCEPT_WAIT                 (5 * NX_IP_PERIODIC_RATE)
+#define NX_TCP_SERVER_DISCONNECT_WAIT             (NX_IP_PERIODIC_RATE)
+
+/* Retransmission settings of the client sockets (NetX Duo defaults). */
+#define NX_TCP_SERVER_TX_TIMEOUT                  (NX_TCP_TRANSMIT_TIMER_RATE)
+#define NX_TCP_SERVER_TX_MAX_RETRIES              (NX_TCP_MAXIMUM_RETRIES)
+#define NX_TCP_SERVER_TX_TIMEOUT_SHIFT            (NX_TCP_RETRY_SHIFT)
+
+/* Event flags set from the NetX Duo callbacks. Bit 0 signals a connection
+ * request, then one receive and one disconnect bit per client socket.
+ */
+#define NX_TCP_SERVER_EVENT_CONNECT               (1uL << 0)
+#define NX_TCP_SERVER_EVENT_RECEIVE(i)            (1uL << (1u + (i)))
+#define NX_TCP_SERVER_EVENT_DISCONNECT(i)         (1uL << (1u + NX_TCP_SERVER_MAX_CLIENTS + (i)))
+
+#if((1u + (2u * NX_TCP_SERVER_MAX_CLIENTS)) > 32u)
+#error "NX_TCP_SERVER_MAX_CLIENTS exceeds the number of event flags"
+#endif
+
+/* Index of the listening socket when every socket is connected. */
+#define NX_TCP_SERVER_NO_LISTENER                 (NX_TCP_SERVER_MAX_CLIENTS)
+
+/* Memory of the application packet pool. NetX Duo aligns the header and the
+ * payload of every packet to NX_PACKET_ALIGNMENT.
+ */
+#define NX_TCP_SERVER_POOL_PACKET_SIZE            (sizeof(NX_PACKET) + APP_NX_PACKET_PAYLOAD_SIZE + \
+                                                   (2u * NX_PACKET_ALIGNMENT))
+#define NX_TCP_SERVER_POOL_MEMORY_SIZE            (APP_NX_PACKET_POOL_SIZE * NX_TCP_SERVER_POOL_PACKET_SIZE)
+
+/*******************************************************************************
+* Data structure and enumeration
+********************************************************************************/
+/* Usage statistics of a packet pool. */
+typedef struct
+{
+    NX_PACKET_POOL *pool;
+    ULONG total_packets;
+    ULONG min_free_packets;
+    ULONG empty_requests;
+} nx_tcp_server_pool_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static void nx_tcp_server_thread(ULONG arg);
+static void nx_tcp_server_listen_callback(NX_TCP_SOCKET *socket_ptr, UINT port);
+static void nx_tcp_server_receive_callback(NX_TCP_SOCKET *socket_ptr);
+static void nx_tcp_server_disconnect_callback(NX_TCP_SOCKET *socket_ptr);
+static void nx_tcp_server_accept(void);
+static void nx_tcp_server_relisten(uint32_t index);
+static void nx_tcp_server_receive(uint32_t index);
+static void nx_tcp_server_close(uint32_t index);
+static void nx_tcp_server_pool_update(nx_tcp_server_pool_stats_t *stats);
+static void nx_tcp_server_pool_print(const char *name, nx_tcp_server_pool_stats_t *stats);
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* IP instance and port the server listens on. */
+static NX_IP *server_ip;
+static UINT server_port;
+
+/* Client sockets. The one at listen_index listens, the others are either
+ * connected or free.
+ */
+static NX_TCP_SOCKET client_sockets[NX_TCP_SERVER_MAX_CLIENTS];
+static bool client_connected[NX_TCP_SERVER_MAX_CLIENTS];
+static uint32_t listen_index;
+static uint32_t num_clients;
+
+/* Mutex protecting the socket state. The server thread and the caller of
+ * nx_tcp_server_broadcast() access it from different threads.
+ */
+static TX_MUTEX client_mutex;
+
+/* Events from the NetX Duo callbacks, which run in the IP thread and must not
+ * block.
+ */
+static TX_EVENT_FLAGS_GROUP server_events;
+
+static TX_THREAD server_thread;
+static ULONG server_thread_stack[NX_TCP_SERVER_THREAD_STACK_SIZE / sizeof(ULONG)];
+
+/* Application packet pool for the commands sent to the clients. */
+static NX_PACKET_POOL tx_pool;
+static ULONG tx_pool_memory[(NX_TCP_SERVER_POOL_MEMORY_SIZE + sizeof(ULONG) - 1u) / sizeof(ULONG)];
+
+/* Pool statistics. The receive pool is the pool of the Wi-Fi driver and is
+ * learnt from the first received packet.
+ */
+static nx_tcp_server_pool_stats_t tx_pool_stats;
+static nx_tcp_server_pool_stats_t rx_pool_stats;
+
+/* Sends dropped because the pool was empty or APP_NX_MAX_PACKETS_IN_FLIGHT
+ * packets were already queued on the socket.
+ */
+static uint32_t tx_send_failures;
+
+/* Application handlers. */
+static nx_tcp_server_recv_handler_t server_recv_handler;
+static nx_tcp_server_conn_handler_t server_conn_handler;
+
+
+/*******************************************************************************
+ * Function Name: nx_tcp_server_start
+ *******************************************************************************
+ * Summary:
+ *  Creates the application packet pool and the client sockets, starts
+ *  listening on the given port and starts the server thread.
+ *
+ * Parameters:
+ *  NX_IP *ip_ptr: IP instance of the Wi-Fi interface
+ *  UINT port: TCP port to listen on
+ *  nx_tcp_server_recv_handler_t recv_handler: Called for every received packet
+ *  nx_tcp_server_conn_handler_t conn_handler: Called on connect and disconnect
+ *
+ * Return:
+ *  cy_rslt_t: CY_RSLT_SUCCESS on success, CY_RSLT_TYPE_ERROR otherwise
+ *
+ *******************************************************************************/
+cy_rslt_t nx_tcp_server_start(NX_IP *ip_ptr, UINT port,
+                              nx_tcp_server_recv_handler_t recv_handler,
+                              nx_tcp_server_conn_handler_t conn_handler)
+{
+    UINT status;
+
+    server_ip = ip_ptr;
+    server_port = port;
+    server_recv_handler = recv_handler;
+    server_conn_handler = conn_handler;
+
+    status = nx_packet_pool_create(&tx_pool, "app tx pool", APP_NX_PACKET_PAYLOAD_SIZE,
+                                   tx_pool_memory, sizeof(tx_pool_memory));
+    if(status != NX_SUCCESS)
+    {
+        printf("nx_packet_pool_create failed! Status: 0x%02x\n", status);
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    tx_pool_stats.pool = &tx_pool;
+    nx_packet_pool_info_get(&tx_pool, &tx_pool_stats.total_packets,
+                            &tx_pool_stats.min_free_packets, NX_NULL, NX_NULL, NX_NULL);
+
+    /* TCP is usually enabled already by the network stack initialization. */
+    status = nx_tcp_enable(server_ip);
+    if((status != NX_SUCCESS) && (status != NX_ALREADY_ENABLED))
+    {
+        printf("nx_tcp_enable failed! Status: 0x%02x\n", status);
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    tx_mutex_create(&client_mutex, "nx tcp server", TX_INHERIT);
+    tx_event_flags_create(&server_events, "nx tcp server");
+
+    for(uint32_t i = 0; i < NX_TCP_SERVER_MAX_CLIENTS; i++)
+    {
+        status = nx_tcp_socket_create(server_ip, &client_sockets[i], "nx tcp client",
+                                      NX_IP_NORMAL, NX_FRAGMENT_OKAY, NX_IP_TIME_TO_LIVE,
+                                      NX_TCP_SERVER_WINDOW_SIZE, NX_NULL,
+                                      nx_tcp_server_disconnect_callback);
+        if(status == NX_SUCCESS)
+        {
+            /* Bound the number of unacknowledged packets per client so that one
+             * slow client cannot drain the pool.
+             */
+            status = nx_tcp_socket_transmit_configure(&client_sockets[i], APP_NX_MAX_PACKETS_IN_FLIGHT,
+                                                      NX_TCP_SERVER_TX_TIMEOUT,
+                                                      NX_TCP_SERVER_TX_MAX_RETRIES,
+                                                      NX_TCP_SERVER_TX_TIMEOUT_SHIFT);
+        }
+        if(status == NX_SUCCESS)
+        {
+            status = nx_tcp_socket_receive_notify(&client_sockets[i], nx_tcp_server_receive_callback);
+        }
+        if(status != NX_SUCCESS)
+        {
+            printf("Failed to create client socket %"PRIu32"! Status: 0x%02x\n", i, status);
+            return CY_RSLT_TYPE_ERROR;
+        }
+    }
+
+    listen_index = 0;
+    status = nx_tcp_server_socket_listen(server_ip, server_port, &client_sockets[listen_index],
+                                         NX_TCP_SERVER_LISTEN_QUEUE_SIZE,
+                                         nx_tcp_server_listen_callback);
+    if(status != NX_SUCCESS)
+    {
+        printf("nx_tcp_server_socket_listen failed! Status: 0x%02x\n", status);
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    status = tx_thread_create(&server_thread, "nx tcp server", nx_tcp_server_thread, 0,
+                              server_thread_stack, sizeof(server_thread_stack),
+                              NX_TCP_SERVER_THREAD_PRIORITY, NX_TCP_SERVER_THREAD_PRIORITY,
+                              TX_NO_TIME_SLICE, TX_AUTO_START);
+    if(status != TX_SUCCESS)
+    {
+        printf("Failed to create the server thread! Status: 0x%02x\n", status);
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: nx_tcp_server_broadcast
+ *******************************************************************************
+ * Summary:
+ *  Sends the given data to every connected client. Every client gets its own
+ *  packet from the application pool, since NetX Duo owns a packet until it is
+ *  acknowledged. A client that already has APP_NX_MAX_PACKETS_IN_FLIGHT
+ *  packets queued is skipped instead of blocking the other clients.
+ *
+ * Parameters:
+ *  const uint8_t *data: Data to send
+ *  uint32_t length: Length of the data
+ *
+ * Return:
+ *  uint32_t: Number of clients the data was queued for
+ *
+ *******************************************************************************/
+uint32_t nx_tcp_server_broadcast(const uint8_t *data, uint32_t length)
+{
+    UINT status;
+    NX_PACKET *packet;
+    uint32_t num_clients_sent = 0;
+
+    tx_mutex_get(&client_mutex, TX_WAIT_FOREVER);
+
+    for(uint32_t i = 0; i < NX_TCP_SERVER_MAX_CLIENTS; i++)
+    {
+        if(!client_connected[i])
+        {
+            continue;
+        }
+
+        status = nx_packet_allocate(&tx_pool, &packet, NX_TCP_PACKET, NX_NO_WAIT);
+        if(status != NX_SUCCESS)
+        {
+            tx_send_failures++;
+            continue;
+        }
+
+        nx_tcp_server_pool_update(&tx_pool_stats);
+
+        status = nx_packet_data_append(packet, (VOID *)data, length, &tx_pool, NX_NO_WAIT);
+        if(status == NX_SUCCESS)
+        {
+            status = nx_tcp_socket_send(&client_sockets[i], packet, NX_NO_WAIT);
+        }
+
+        if(status == NX_SUCCESS)
+        {
+            num_clients_sent++;
+        }
+        else
+        {
+            /* The packet is still owned by the application after a failed send. */
+            nx_packet_release(packet);
+            tx_send_failures++;
+        }
+    }
+
+    tx_mutex_put(&client_mutex);
+
+    return num_clients_sent;
+}
+
+/*******************************************************************************
+ * Function Name: nx_tcp_server_print_pool_stats
+ *******************************************************************************
+ * Summary:
+ *  Prints the current usage and the high-water mark of the application
+ *  transmit pool and of the driver receive pool.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void nx_tcp_server_print_pool_stats(void)
+{
+    nx_tcp_server_pool_print("TX", &tx_pool_stats);
+    nx_tcp_server_pool_print("RX", &rx_pool_stats);
+    printf("Sends dropped (pool empty or %u packets in flight): %"PRIu32"\n",
+           APP_NX_MAX_PACKETS_IN_FLIGHT, tx_send_failures);
+}
+
+/*******************************************************************************
+ * Function Name: nx_tcp_server_thread
+ *******************************************************************************
+ * Summary:
+ *  Server thread. Waits for the events of the NetX Duo callbacks and accepts
+ *  connections, dispatches received packets and closes connections.
+ *
+ * Parameters:
+ *  ULONG arg: Thread parameter (unused)
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void nx_tcp_server_thread(ULONG arg)
+{
+    ULONG events;
+
+    while(true)
+    {
+        tx_event_flags_get(&server_events, ~0uL, TX_OR_CLEAR, &events, TX_WAIT_FOREVER);
+
+        if(events & NX_TCP_SERVER_EVENT_CONNECT)
+        {
+            nx_tcp_server_accept();
+        }
+
+        for(uint32_t i = 0; i < NX_TCP_SERVER_MAX_CLIENTS; i++)
+        {
+            if(events & NX_TCP_SERVER_EVENT_RECEIVE(i))
+            {
+                nx_tcp_server_receive(i);
+            }
+
+            if(events & NX_TCP_SERVER_EVENT_DISCONNECT(i))
+            {
+                nx_tcp_server_close(i);
+            }
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: nx_tcp_server_listen_callback
+ *******************************************************************************
+ * Summary:
+ *  NetX Duo callback for a connection request on the listening socket. Runs
+ *  in the IP thread.
+ *
+ * Parameters:
+ *  NX_TCP_SOCKET *socket_ptr: Listening socket
+ *  UINT port: Port of the connection request
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void nx_tcp_server_listen_callback(NX_TCP_SOCKET *socket_ptr, UINT port)
+{
+    tx_event_flags_set(&server_events, NX_TCP_SERVER_EVENT_CONNECT, TX_OR);
+}
+
+/*******************************************************************************
+ * Function Name: nx_tcp_server_receive_callback
+ *******************************************************************************
+ * Summary:
+ *  NetX Duo callback for data queued on a client socket. Runs in the IP
+ *  thread.
+ *
+ * Parameters:
+ *  NX_TCP_SOCKET *socket_ptr: Client socket
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void nx_tcp_server_receive_callback(NX_TCP_SOCKET *socket_ptr)
+{
+    uint32_t index = (uint32_t)(socket_ptr - client_sockets);
+
+    tx_event_flags_set(&server_events, NX_TCP_SERVER_EVENT_RECEIVE(index), TX_OR);
+}
+
+/*******************************************************************************
+ * Function Name: nx_tcp_server_disconnect_callback
+ *******************************************************************************
+ * Summary:
+ *  NetX Duo callback for a disconnect request from a client. Runs in the IP
+ *  thread.
+ *
+ * Parameters:
+ *  NX_TCP_SOCKET *socket_ptr: Client socket
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void nx_tcp_server_disconnect_callback(NX_TCP_SOCKET *socket_ptr)
+{
+    uint32_t index = (uint32_t)(socket_ptr - client_sockets);
+
+    tx_event_flags_set(&server_events, NX_TCP_SERVER_EVENT_DISCONNECT(index), TX_OR);
+}
+
+/*******************************************************************************
+ * Function Name: nx_tcp_server_accept
+ *******************************************************************************
+ * Summary:
+ *  Completes the connection on the listening socket and hands the listen
+ *  request over to the next free socket.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void nx_tcp_server_accept(void)
+{
+    UINT status;
+    ULONG peer_ip = 0;
+    ULONG peer_port = 0;
+    uint32_t index = listen_index;
+    uint32_t connected_clients;
+
+    if(index == NX_TCP_SERVER_NO_LISTENER)
+    {
+        /* The request stays queued until a socket is free again. */
+        return;
+    }
+
+    status = nx_tcp_server_socket_accept(&client_sockets[index], NX_TCP_SERVER_ACCEPT_WAIT);
+    if(status != NX_SUCCESS)
+    {
+        printf("Failed to accept incoming client connection. Status: 0x%02x\n", status);
+        nx_tcp_server_socket_unaccept(&client_sockets[index]);
+        nx_tcp_server_relisten(index);
+        return;
+    }
+
+    nx_tcp_socket_peer_info_get(&client_sockets[index], &peer_ip, &peer_port);
+
+    tx_mutex_get(&client_mutex, TX_WAIT_FOREVER);
+    client_connected[index] = true;
+    num_clients++;
+    connected_clients = num_clients;
+    tx_mutex_put(&client_mutex);
+
+    server_conn_handler(index, true, peer_ip, connected_clients);
+
+    /* Listen on the next free socket, if any. */
+    listen_index = NX_TCP_SERVER_NO_LISTENER;
+    for(uint32_t i = 0; i < NX_TCP_SERVER_MAX_CLIENTS; i++)
+    {
+        if(!client_connected[i])
+        {
+            nx_tcp_server_relisten(i);
+            break;
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: nx_tcp_server_relisten
+ *******************************************************************************
+ * Summary:
+ *  Makes the given free socket the listening socket of the server port.
+ *
+ * Parameters:
+ *  uint32_t index: Index of the free socket
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void nx_tcp_server_relisten(uint32_t index)
+{
+    UINT status;
+
+    status = nx_tcp_server_socket_relisten(server_ip, server_port, &client_sockets[index]);
+    if(status == NX_CONNECTION_PENDING)
+    {
+        /* A connection request was queued while no socket was listening. */
+        tx_event_flags_set(&server_events, NX_TCP_SERVER_EVENT_CONNECT, TX_OR);
+    }
+    else if(status != NX_SUCCESS)
+    {
+        printf("nx_tcp_server_socket_relisten failed! Status: 0x%02x\n", status);
+        return;
+    }
+
+    listen_index = index;
+}
+
+/*******************************************************************************
+ * Function Name: nx_tcp_server_receive
+ *******************************************************************************
+ * Summary:
+ *  Hands every packet queued on a client socket to the receive handler. The
+ *  packet is either sent back as the reply or released.
+ *
+ * Parameters:
+ *  uint32_t index: Index of the client socket
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void nx_tcp_server_receive(uint32_t index)
+{
+    NX_PACKET *packet;
+
+    if(!client_connected[index])
+    {
+        return;
+    }
+
+    while(nx_tcp_socket_receive(&client_sockets[index], &packet, NX_NO_WAIT) == NX_SUCCESS)
+    {
+        if(rx_pool_stats.pool == NX_NULL)
+        {
+            rx_pool_stats.pool = packet->nx_packet_pool_owner;
+            rx_pool_stats.min_free_packets = ~0uL;
+        }
+        nx_tcp_server_pool_update(&rx_pool_stats);
+
+        if(server_recv_handler(index, packet))
+        {
+            if(nx_tcp_socket_send(&client_sockets[index], packet, NX_NO_WAIT) != NX_SUCCESS)
+            {
+                nx_packet_release(packet);
+                tx_send_failures++;
+            }
+        }
+        else
+        {
+            nx_packet_release(packet);
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: nx_tcp_server_close
+ *******************************************************************************
+ * Summary:
+ *  Closes a client connection and makes the socket available for the next
+ *  client.
+ *
+ * Parameters:
+ *  uint32_t index: Index of the client socket
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void nx_tcp_server_close(uint32_t index)
+{
+    uint32_t connected_clients;
+
+    if(!client_connected[index])
+    {
+        return;
+    }
+
+    /* Take the socket out of the broadcast first. */
+    tx_mutex_get(&client_mutex, TX_WAIT_FOREVER);
+    client_connected[index] = false;
+    num_clients--;
+    connected_clients = num_clients;
+    tx_mutex_put(&client_mutex);
+
+    nx_tcp_socket_disconnect(&client_sockets[index], NX_TCP_SERVER_DISCONNECT_WAIT);
+    nx_tcp_server_socket_unaccept(&client_sockets[index]);
+
+    server_conn_handler(index, false, 0, connected_clients);
+
+    if(listen_index == NX_TCP_SERVER_NO_LISTENER)
+    {
+        nx_tcp_server_relisten(index);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: nx_tcp_server_pool_update
+ *******************************************************************************
+ * Summary:
+ *  Samples the number of free packets of a pool and updates its low-water mark
+ *  of free packets, that is the high-water mark of packets in use.
+ *
+ * Parameters:
+ *  nx_tcp_server_pool_stats_t *stats: Statistics of the pool
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void nx_tcp_server_pool_update(nx_tcp_server_pool_stats_t *stats)
+{
+    ULONG free_packets;
+
+    nx_packet_pool_info_get(stats->pool, &stats->total_packets, &free_packets,
+                            &stats->empty_requests, NX_NULL, NX_NULL);
+
+    if(free_packets < stats->min_free_packets)
+    {
+        stats->min_free_packets = free_packets;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: nx_tcp_server_pool_print
+ *******************************************************************************
+ * Summary:
+ *  Prints the usage of a pool.
+ *
+ * Parameters:
+ *  const char *name: Name of the pool
+ *  nx_tcp_server_pool_stats_t *stats: Statistics of the pool
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void nx_tcp_server_pool_print(const char *name, nx_tcp_server_pool_stats_t *stats)
+{
+    ULONG free_packets;
+
+    if(stats->pool == NX_NULL)
+    {
+        printf("%s pool: no packets seen yet\n", name);
+        return;
+    }
+
+    nx_packet_pool_info_get(stats->pool, &stats->total_packets, &free_packets,
+                            &stats->empty_requests, NX_NULL, NX_NULL);
+
+    printf("%s pool: %"PRIu32"/%"PRIu32" packets in use, high-water mark %"PRIu32", "
+           "empty pool requests %"PRIu32"\n", name,
+           (uint32_t)(stats->total_packets - free_packets), (uint32_t)stats->total_packets,
+           (uint32_t)(stats->total_packets - stats->min_free_packets),
+           (uint32_t)stats->empty_requests);
+}
+
+#endif /* APP_NX_ZERO_COPY_ENABLE */
+
+
+/* [] END OF FILE */
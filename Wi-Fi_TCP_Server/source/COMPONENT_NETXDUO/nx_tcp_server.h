@@ -0,0 +1,107 @@
+/******************************************************************************
+* File Name:   nx_tcp_server.h
+*
+* Description: This file contains declarations of the zero-copy TCP server that
+*              runs directly on NetX Duo.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef NX_TCP_SERVER_H_
+#define NX_TCP_SERVER_H_
+
+/* NetX Duo header file. Pulls in nx_user.h. */
+#include "nx_api.h"
+
+/* Cypress result header file. */
+#include "cy_result.h"
+
+/* Standard C header files */
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#ifndef APP_NX_ZERO_COPY_ENABLE
+#define APP_NX_ZERO_COPY_ENABLE                   (0)
+#endif
+
+#ifndef APP_NX_PACKET_POOL_SIZE
+#define APP_NX_PACKET_POOL_SIZE                   (16)
+#endif
+
+#ifndef APP_NX_PACKET_PAYLOAD_SIZE
+#define APP_NX_PACKET_PAYLOAD_SIZE                (128)
+#endif
+
+#ifndef APP_NX_MAX_PACKETS_IN_FLIGHT
+#define APP_NX_MAX_PACKETS_IN_FLIGHT              (2)
+#endif
+
+/* Number of client sockets. One of them listens at any time. */
+#define NX_TCP_SERVER_MAX_CLIENTS                 (8u)
+
+/* Receive window advertised by every client socket. */
+#define NX_TCP_SERVER_WINDOW_SIZE                 (4096u)
+
+/*******************************************************************************
+* Data structure and enumeration
+********************************************************************************/
+/* Called from the server thread with every packet chain received from a client.
+ * The packet is owned by the handler for the duration of the call. If the
+ * handler rewrites the packet into a reply and returns true, the packet is sent
+ * back on the same connection; otherwise it is released.
+ */
+typedef bool (*nx_tcp_server_recv_handler_t)(uint32_t client, NX_PACKET *packet);
+
+/* Called from the server thread after a client connected or disconnected. */
+typedef void (*nx_tcp_server_conn_handler_t)(uint32_t client, bool connected,
+                                             ULONG peer_ip, uint32_t num_clients);
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t nx_tcp_server_start(NX_IP *ip_ptr, UINT port,
+                              nx_tcp_server_recv_handler_t recv_handler,
+                              nx_tcp_server_conn_handler_t conn_handler);
+uint32_t nx_tcp_server_broadcast(const uint8_t *data, uint32_t length);
+void nx_tcp_server_print_pool_stats(void);
+
+#endif /* NX_TCP_SERVER_H_ */
+
+
+/* [] END OF FILE */
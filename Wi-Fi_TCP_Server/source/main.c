@@ -80,14 +80,11 @@
 #define TCP_SERVER_TASK_PRIORITY                  (1)
 #endif
 
-/* Queue lengths of message queues used in this project */
-#define SINGLE_ELEMENT_QUEUE                      (1u)
-
 /********************************************************************************
 * Global Variables
 ********************************************************************************/
-/* Queue handler */
-cy_queue_t led_command_q;
+/* Event group of the TCP server task */
+cy_event_t server_event;
 
 /* This enables RTOS aware debugging. */
 volatile int uxTopUsedPriority;
@@ -142,8 +139,8 @@ int main()
     printf("CE229153 - Connectivity Example: TCP Server\n");
     printf("===============================================================\n\n");
 
-    /* Initialize a queue to receive command. */
-    cy_rtos_queue_init(&led_command_q, SINGLE_ELEMENT_QUEUE, sizeof(uint8_t));
+    /* Initialize the event group that drives the TCP server task. */
+    cy_rtos_event_init(&server_event);
 
 #if defined (COMPONENT_FREERTOS)
     /* Create the tasks. */
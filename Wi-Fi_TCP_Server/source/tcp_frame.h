@@ -0,0 +1,146 @@
+/******************************************************************************
+* File Name:   tcp_frame.h
+*
+* Description: This file contains declarations of the length-prefixed binary
+*              framing used by the TCP LED protocol in framed mode.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef TCP_FRAME_H_
+#define TCP_FRAME_H_
+
+/* Standard C header files */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Frame layout (multi-byte fields in network byte order):
+ *
+ *  +-------+------+----------+--------+-----------------+
+ *  | magic | type | sequence | length | payload         |
+ *  | 1     | 1    | 2        | 2      | 'length' bytes  |
+ *  +-------+------+----------+--------+-----------------+
+ */
+#define TCP_FRAME_MAGIC                           (0xA5u)
+#define TCP_FRAME_HEADER_LEN                      (6u)
+#define TCP_FRAME_MAX_PAYLOAD_LEN                 (256u)
+
+/* Frame types. */
+#define TCP_FRAME_TYPE_LED_CMD                    (0x01u)
+#define TCP_FRAME_TYPE_LED_ACK                    (0x02u)
+
+/* Frame types of the throughput/latency benchmark (see tcp_bench.h). The
+ * benchmark peer answers PING with an empty PONG and echoes DONE once all the
+ * DATA frames before it were received.
+ */
+#define TCP_FRAME_TYPE_BENCH_PING                 (0x10u)
+#define TCP_FRAME_TYPE_BENCH_PONG                 (0x11u)
+#define TCP_FRAME_TYPE_BENCH_DATA                 (0x12u)
+#define TCP_FRAME_TYPE_BENCH_DONE                 (0x13u)
+
+/* Payload of the LED command and acknowledgement frames. */
+#define TCP_FRAME_LED_OFF                         (0x00u)
+#define TCP_FRAME_LED_ON                          (0x01u)
+#define TCP_FRAME_LED_PAYLOAD_LEN                 (1u)
+
+/* Size of the receive reassembly buffer of a frame parser. Must hold at least
+ * one maximum-size frame.
+ */
+#define TCP_FRAME_RX_BUFFER_SIZE                  (512u)
+
+/* Size of the transmit buffer used to coalesce frames into one segment. */
+#define TCP_FRAME_TX_BUFFER_SIZE                  (512u)
+
+/*******************************************************************************
+* Data structure and enumeration
+********************************************************************************/
+/* Decoded frame. The payload points into the parser buffer and is only valid
+ * during the frame callback.
+ */
+typedef struct
+{
+    uint8_t type;
+    uint16_t sequence;
+    uint16_t length;
+    const uint8_t *payload;
+} tcp_frame_t;
+
+/* Function called once for every complete frame found by the parser. */
+typedef void (*tcp_frame_callback_t)(const tcp_frame_t *frame, void *arg);
+
+/* Stream parser state. Bytes are received straight into 'buffer'. */
+typedef struct
+{
+    uint8_t buffer[TCP_FRAME_RX_BUFFER_SIZE];
+    uint32_t length;
+    uint32_t frames;
+    uint32_t errors;
+} tcp_frame_parser_t;
+
+/* Transmit batch used to coalesce several frames into a single send. */
+typedef struct
+{
+    uint8_t buffer[TCP_FRAME_TX_BUFFER_SIZE];
+    uint32_t length;
+    uint32_t frames;
+} tcp_frame_batch_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void tcp_frame_encode_header(uint8_t *buffer, uint8_t type, uint16_t sequence,
+                             uint16_t payload_len);
+uint32_t tcp_frame_encode(uint8_t *buffer, uint32_t buffer_len, uint8_t type,
+                          uint16_t sequence, const uint8_t *payload,
+                          uint16_t payload_len);
+
+void tcp_frame_parser_init(tcp_frame_parser_t *parser);
+uint8_t *tcp_frame_parser_space(tcp_frame_parser_t *parser, uint32_t *space_len);
+uint32_t tcp_frame_parser_commit(tcp_frame_parser_t *parser, uint32_t bytes_received,
+                                 tcp_frame_callback_t callback, void *arg);
+
+void tcp_frame_batch_init(tcp_frame_batch_t *batch);
+bool tcp_frame_batch_add(tcp_frame_batch_t *batch, uint8_t type, uint16_t sequence,
+                         const uint8_t *payload, uint16_t payload_len);
+
+#endif /* TCP_FRAME_H_ */
+
+
+/* [] END OF FILE */
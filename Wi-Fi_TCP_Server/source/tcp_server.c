@@ -64,9 +64,19 @@
 /* TCP server task header file. */
 #include "tcp_server.h"
 
+/* TCP frame and benchmark header files. */
+#include "tcp_frame.h"
+#include "tcp_bench.h"
+
 /* IP address related header files. */
 #include "cy_nw_helper.h"
 
+#if defined (COMPONENT_NETXDUO)
+/* Zero-copy NetX Duo TCP server header files. */
+#include "cy_network_mw_core.h"
+#include "nx_tcp_server.h"
+#endif
+
 /* Standard C header files */
 #include <inttypes.h>
 
@@ -76,6 +86,25 @@
 /* To use the Wi-Fi device in AP interface mode, set this macro as '1' */
 #define USE_AP_INTERFACE                         (0)
 
+/* To exchange length-prefixed binary frames (see tcp_frame.h) instead of
+ * single ASCII bytes and ASCII acknowledgements, set this macro as '1'. The
+ * TCP client must be configured for the same protocol.
+ */
+#define USE_FRAMED_PROTOCOL                      (0)
+
+/* ThreadX builds run the TCP server directly on NetX Duo, without the secure
+ * sockets copy API, when APP_NX_ZERO_COPY_ENABLE is set in nx_user.h.
+ */
+#if defined (COMPONENT_NETXDUO) && (APP_NX_ZERO_COPY_ENABLE)
+#define USE_NX_ZERO_COPY                         (1)
+#else
+#define USE_NX_ZERO_COPY                         (0)
+#endif
+
+#if(USE_NX_ZERO_COPY && (USE_FRAMED_PROTOCOL || TCP_BENCHMARK_MODE))
+#error "The zero-copy NetX Duo path supports the ASCII LED protocol only"
+#endif
+
 #define MAKE_IP_PARAMETERS(a, b, c, d)           ((((uint32_t) d) << 24) | \
                                                  (((uint32_t) c) << 16) | \
                                                  (((uint32_t) b) << 8) |\
@@ -85,6 +114,7 @@
 
 #if(USE_AP_INTERFACE)
     #define WIFI_INTERFACE_TYPE                  CY_WCM_INTERFACE_TYPE_AP
+    #define NETWORK_INTERFACE_TYPE               CY_NETWORK_WIFI_AP_INTERFACE
 
     /* SoftAP Credentials: Modify SOFTAP_SSID and SOFTAP_PASSWORD as required */
     #define SOFTAP_SSID                          "MY_SOFT_AP"
@@ -103,6 +133,7 @@
     #define SOFTAP_RADIO_CHANNEL                  (1u)
 #else
     #define WIFI_INTERFACE_TYPE                   CY_WCM_INTERFACE_TYPE_STA
+    #define NETWORK_INTERFACE_TYPE                CY_NETWORK_WIFI_STA_INTERFACE
 
     /* Wi-Fi Credentials: Modify WIFI_SSID, WIFI_PASSWORD, and WIFI_SECURITY_TYPE
      * to match your Wi-Fi network credentials.
@@ -126,9 +157,27 @@
 /* TCP server related macros. */
 #define TCP_SERVER_PORT                           (50007)
 #define TCP_SERVER_MAX_PENDING_CONNECTIONS        (3u)
+#define TCP_SERVER_MAX_CLIENTS                    (8u)
 #define TCP_SERVER_RECV_TIMEOUT_MS                (500u)
 #define MAX_TCP_RECV_BUFFER_SIZE                  (20u)
 
+/* Reads from one signalled client before the task serves the others. The
+ * client is read again on the next pass of the task.
+ */
+#define TCP_SERVER_MAX_RECV_PER_EVENT             (8u)
+
+/* A signalled client is read until its socket is empty. The reads do not
+ * wait when the secure sockets library supports it; otherwise the accepted
+ * sockets get a short receive timeout, so that the read that finds the socket
+ * empty returns at once instead of after TCP_SERVER_RECV_TIMEOUT_MS.
+ */
+#if defined(CY_SOCKET_FLAGS_DONTWAIT)
+#define TCP_SERVER_RECV_FLAGS                     CY_SOCKET_FLAGS_DONTWAIT
+#else
+#define TCP_SERVER_RECV_FLAGS                     CY_SOCKET_FLAGS_NONE
+#define TCP_SERVER_CLIENT_RECV_TIMEOUT_MS         (1u)
+#endif
+
 /* TCP keep alive related macros. */
 #define TCP_KEEP_ALIVE_IDLE_TIME_MS               (10000u)
 #define TCP_KEEP_ALIVE_INTERVAL_MS                (1000u)
@@ -141,21 +190,74 @@
 #define LED_ON_CMD                                '1'
 #define LED_OFF_CMD                               '0'
 
+/* Acknowledgement of the LED ON command. */
+#define LED_ON_ACK                                "LED ON ACK"
+
 /* Interrupt priority of the user button. */
 #define USER_BTN_INTR_PRIORITY                    (5)
 
 /* Debounce delay for user button. */
 #define DEBOUNCE_DELAY_MS                         (50)
 
+/* Events of the TCP server task. The button ISR, the debounce timer and the
+ * socket callbacks only set these bits; all the work is done by the task.
+ */
+#define TCP_SERVER_EVENT_BUTTON                   (1u << 0)
+#define TCP_SERVER_EVENT_DEBOUNCE                 (1u << 1)
+#define TCP_SERVER_EVENT_SOCKET                   (1u << 2)
+#define TCP_SERVER_EVENT_ALL                      (TCP_SERVER_EVENT_BUTTON | \
+                                                   TCP_SERVER_EVENT_DEBOUNCE | \
+                                                   TCP_SERVER_EVENT_SOCKET)
+
+/*******************************************************************************
+* Data structure and enumeration
+********************************************************************************/
+/* State of a slot in the TCP client connection table. */
+typedef enum
+{
+    TCP_CLIENT_SLOT_FREE = 0,
+    TCP_CLIENT_SLOT_CONNECTED
+} tcp_client_slot_state_t;
+
+/* Per-connection state of a TCP client. */
+typedef struct
+{
+    cy_socket_t handle;
+    cy_socket_sockaddr_t peer_addr;
+    tcp_client_slot_state_t state;
+    /* Socket events recorded by the callbacks for the TCP server task. */
+    uint32_t rx_pending;
+    bool disconnect_pending;
+#if(USE_FRAMED_PROTOCOL)
+    tcp_frame_parser_t parser;
+#endif /* USE_FRAMED_PROTOCOL */
+} tcp_client_slot_t;
 
 /*******************************************************************************
 * Function Prototypes
 ********************************************************************************/
+#if(USE_NX_ZERO_COPY)
+static bool tcp_nx_receive_handler(uint32_t client, NX_PACKET *packet);
+static void tcp_nx_connection_handler(uint32_t client, bool connected,
+                                      ULONG peer_ip, uint32_t num_clients);
+#else
 static cy_rslt_t create_tcp_server_socket(void);
 static cy_rslt_t tcp_connection_handler(cy_socket_t socket_handle, void *arg);
 static cy_rslt_t tcp_receive_msg_handler(cy_socket_t socket_handle, void *arg);
 static cy_rslt_t tcp_disconnection_handler(cy_socket_t socket_handle, void *arg);
+static void tcp_server_process_socket_events(void);
+static void tcp_client_accept(void);
+static bool tcp_client_receive(tcp_client_slot_t *slot);
+static tcp_client_slot_t *tcp_client_slot_find(cy_socket_t socket_handle);
+static void tcp_client_slot_release(tcp_client_slot_t *slot);
+#endif /* USE_NX_ZERO_COPY */
+static void tcp_server_button_handler(void);
+static void debounce_timer_callback(cy_timer_callback_arg_t arg);
 static void isr_button_press( void *callback_arg, cyhal_gpio_event_t event);
+static uint32_t tcp_broadcast_led_cmd(uint8_t led_state_cmd);
+#if(USE_FRAMED_PROTOCOL)
+static void tcp_frame_handler(const tcp_frame_t *frame, void *arg);
+#endif /* USE_FRAMED_PROTOCOL */
 
 #if(USE_AP_INTERFACE)
     static cy_rslt_t softap_start(void);
@@ -167,17 +269,34 @@ static void isr_button_press( void *callback_arg, cyhal_gpio_event_t event);
 * Global Variables
 ********************************************************************************/
 /* Secure socket variables. */
-cy_socket_sockaddr_t tcp_server_addr, peer_addr;
-cy_socket_t server_handle, client_handle;
-
-/* Size of the peer socket address. */
-uint32_t peer_addr_len;
+cy_socket_sockaddr_t tcp_server_addr;
+cy_socket_t server_handle;
 
 /* Flags to track the LED state. */
 bool led_state = CYBSP_LED_STATE_OFF;
 
-/* Flag variable to check if TCP client is connected. */
-bool client_connected;
+/* Connection table holding the state of every connected TCP client. */
+tcp_client_slot_t client_table[TCP_SERVER_MAX_CLIENTS];
+
+/* Number of occupied slots in the connection table. */
+uint32_t num_clients_connected;
+
+/* Mutex protecting the connection table. Only the TCP server task claims
+ * and releases slots; the socket callbacks look up slots and record pending
+ * events from a different thread.
+ */
+cy_mutex_t client_table_mutex;
+
+/* Number of connection requests not yet accepted by the TCP server task. */
+uint32_t connect_pending;
+
+/* One-shot timer ending the debounce period of the user button. */
+cy_timer_t debounce_timer;
+
+#if(USE_FRAMED_PROTOCOL)
+/* Sequence number of the next LED command frame. */
+uint16_t tx_sequence;
+#endif /* USE_FRAMED_PROTOCOL */
 
 cyhal_gpio_callback_data_t cb_data =
 {
@@ -185,8 +304,8 @@ cyhal_gpio_callback_data_t cb_data =
 .callback_arg = NULL
 };
 
-/* Queue handler */
-extern cy_queue_t led_command_q;
+/* Event group of the TCP server task. */
+extern cy_event_t server_event;
 
 
 /*******************************************************************************
@@ -208,11 +327,16 @@ void tcp_server_task(void *arg)
 
     cy_wcm_config_t wifi_config = { .interface = WIFI_INTERFACE_TYPE };
 
-    /* Variable to store number of bytes sent over TCP socket. */
-    uint32_t bytes_sent = 0;
+    /* Events received by the task. */
+    uint32_t events;
 
-    /* Variable to receive LED ON/OFF command from the user button ISR. */
-    uint32_t led_state_cmd = LED_OFF_CMD;
+    /* Create the timer that ends the debounce period of the user button. */
+    result = cy_rtos_timer_init(&debounce_timer, CY_TIMER_TYPE_ONCE, debounce_timer_callback, 0);
+    if (result != CY_RSLT_SUCCESS)
+    {
+        printf("Debounce timer initialization failed! Error code: 0x%08"PRIx32"\n", (uint32_t)result);
+        CY_ASSERT(0);
+    }
 
     /* Initialize the user button (CYBSP_USER_BTN) and register interrupt on falling edge. */
     cyhal_gpio_init(CYBSP_USER_BTN, CYHAL_GPIO_DIR_INPUT, CYHAL_GPIO_DRIVE_PULLUP, CYBSP_BTN_OFF);
@@ -229,6 +353,14 @@ void tcp_server_task(void *arg)
     }
     printf("Wi-Fi Connection Manager initialized.\r\n");
 
+    /* Initialize the mutex protecting the connection table. */
+    result = cy_rtos_mutex_init(&client_table_mutex, false);
+    if (result != CY_RSLT_SUCCESS)
+    {
+        printf("Connection table mutex initialization failed! Error code: 0x%08"PRIx32"\n", (uint32_t)result);
+        CY_ASSERT(0);
+    }
+
     #if(USE_AP_INTERFACE)
 
         /* Start the Wi-Fi device as a Soft AP interface. */
@@ -248,6 +380,21 @@ void tcp_server_task(void *arg)
         }
     #endif /* USE_AP_INTERFACE */
 
+#if(USE_NX_ZERO_COPY)
+    /* Start the TCP server on the IP instance of the Wi-Fi interface. */
+    result = nx_tcp_server_start((NX_IP *)cy_network_get_nw_interface(NETWORK_INTERFACE_TYPE, 0),
+                                 TCP_SERVER_PORT, tcp_nx_receive_handler,
+                                 tcp_nx_connection_handler);
+    if (result != CY_RSLT_SUCCESS)
+    {
+        printf("Failed to start the NetX Duo TCP server! Error code: 0x%08"PRIx32"\n", (uint32_t)result);
+        CY_ASSERT(0);
+    }
+
+    printf("===============================================================\n");
+    printf("Listening for incoming TCP client connection on Port: %d (NetX Duo zero-copy)\n",
+            TCP_SERVER_PORT);
+#else
     /* Initialize secure socket library. */
     result = cy_socket_init();
     if (result != CY_RSLT_SUCCESS)
@@ -257,6 +404,16 @@ void tcp_server_task(void *arg)
     }
     printf("Secure Socket initialized\n");
 
+#if(TCP_BENCHMARK_MODE)
+    /* Initialize the cycle counter and the reply semaphore of the benchmark. */
+    result = tcp_bench_init();
+    if (result != CY_RSLT_SUCCESS)
+    {
+        printf("TCP benchmark initialization failed! Error code: 0x%08"PRIx32"\n", (uint32_t)result);
+        CY_ASSERT(0);
+    }
+#endif /* TCP_BENCHMARK_MODE */
+
     /* Create TCP server socket. */
     result = create_tcp_server_socket();
     if (result != CY_RSLT_SUCCESS)
@@ -279,57 +436,33 @@ void tcp_server_task(void *arg)
         printf("Listening for incoming TCP client connection on Port: %d\n",
                 tcp_server_addr.port);
     }
+#endif /* USE_NX_ZERO_COPY */
 
     while(true)
     {
-        /* Wait till user button is pressed to send LED ON/OFF command to TCP client. */
-        cy_rtos_get_queue(&led_command_q, &led_state_cmd, CY_RTOS_NEVER_TIMEOUT, false);
-
-        /* Disable the GPIO signal falling edge detection until the command is
-         * sent to the TCP client.
+        /* Wait for the next button, timer or socket event. Events raised while
+         * the previous ones are handled are collected and handled in one pass.
          */
-        cyhal_gpio_enable_event(CYBSP_USER_BTN, CYHAL_GPIO_IRQ_FALL, USER_BTN_INTR_PRIORITY, false);
+        events = TCP_SERVER_EVENT_ALL;
+        cy_rtos_event_waitbits(&server_event, &events, true, false, CY_RTOS_NEVER_TIMEOUT);
 
-        /* Wait till the debounce period of the user button. */
-        cy_rtos_delay_milliseconds(DEBOUNCE_DELAY_MS);
+#if(!USE_NX_ZERO_COPY)
+        if(events & TCP_SERVER_EVENT_SOCKET)
+        {
+            tcp_server_process_socket_events();
+        }
+#endif /* !USE_NX_ZERO_COPY */
 
-        if(!cyhal_gpio_read(CYBSP_USER_BTN))
+        if(events & TCP_SERVER_EVENT_BUTTON)
         {
-            /* Send LED ON/OFF command to TCP client if there is an active
-             * TCP client connection.
-             */
-            if(client_connected)
-            {
-                /* Send the command to TCP client. */
-                result = cy_socket_send(client_handle, &led_state_cmd, TCP_LED_CMD_LEN,
-                               CY_SOCKET_FLAGS_NONE, &bytes_sent);
-                if(result == CY_RSLT_SUCCESS )
-                {
-                    if(led_state_cmd == LED_ON_CMD)
-                    {
-                        printf("LED ON command sent to TCP client\n");
-                    }
-                    else
-                    {
-                        printf("LED OFF command sent to TCP client\n");
-                    }
-                }
-                else
-                {
-                    printf("Failed to send command to client. Error code: 0x%08"PRIx32"\n", (uint32_t)result);
-                    if(result == CY_RSLT_MODULE_SECURE_SOCKETS_CLOSED)
-                    {
-                        /* Disconnect the socket. */
-                        cy_socket_disconnect(client_handle, 0);
-                        /* Delete the socket. */
-                        cy_socket_delete(client_handle);
-                    }
-                }
-            }
+            tcp_server_button_handler();
         }
 
-        /* Enable the GPIO signal falling edge detection. */
-        cyhal_gpio_enable_event(CYBSP_USER_BTN, CYHAL_GPIO_IRQ_FALL, USER_BTN_INTR_PRIORITY, true);
+        if(events & TCP_SERVER_EVENT_DEBOUNCE)
+        {
+            /* Enable the GPIO signal falling edge detection. */
+            cyhal_gpio_enable_event(CYBSP_USER_BTN, CYHAL_GPIO_IRQ_FALL, USER_BTN_INTR_PRIORITY, true);
+        }
     }
  }
 
@@ -465,6 +598,7 @@ static cy_rslt_t softap_start(void)
 }
 #endif /* USE_AP_INTERFACE */
 
+#if(!USE_NX_ZERO_COPY)
 /*******************************************************************************
  * Function Name: create_tcp_server_socket
  *******************************************************************************
@@ -516,7 +650,11 @@ static cy_rslt_t create_tcp_server_socket(void)
     }
 
     /* Register the callback function to handle messages received from a TCP client. */
+#if(TCP_BENCHMARK_MODE)
+    tcp_receive_option.callback = tcp_bench_recv_handler;
+#else
     tcp_receive_option.callback = tcp_receive_msg_handler;
+#endif /* TCP_BENCHMARK_MODE */
     tcp_receive_option.arg = NULL;
 
     result = cy_socket_setsockopt(server_handle, CY_SOCKET_SOL_SOCKET,
@@ -555,7 +693,8 @@ static cy_rslt_t create_tcp_server_socket(void)
  * Function Name: tcp_connection_handler
  *******************************************************************************
  * Summary:
- *  Callback function to handle incoming TCP client connection.
+ *  Callback function to handle incoming TCP client connection. Records the
+ *  request for the TCP server task, which accepts the connection.
  *
  * Parameters:
  * cy_socket_t socket_handle: Connection handle for the TCP server socket
@@ -566,6 +705,193 @@ static cy_rslt_t create_tcp_server_socket(void)
  *
  *******************************************************************************/
 static cy_rslt_t tcp_connection_handler(cy_socket_t socket_handle, void *arg)
+{
+    cy_rtos_mutex_get(&client_table_mutex, CY_RTOS_NEVER_TIMEOUT);
+    connect_pending++;
+    cy_rtos_mutex_set(&client_table_mutex);
+
+    cy_rtos_event_setbits(&server_event, TCP_SERVER_EVENT_SOCKET);
+
+    return CY_RSLT_SUCCESS;
+}
+
+ /*******************************************************************************
+ * Function Name: tcp_receive_msg_handler
+ *******************************************************************************
+ * Summary:
+ *  Callback function to handle incoming TCP client messages. Records the
+ *  message for the TCP server task, which receives it.
+ *
+ * Parameters:
+ * cy_socket_t socket_handle: Connection handle for the TCP client socket
+ *  void *args : Parameter passed on to the function (unused)
+ *
+ * Return:
+ *  cy_result result: Result of the operation
+ *
+ *******************************************************************************/
+static cy_rslt_t tcp_receive_msg_handler(cy_socket_t socket_handle, void *arg)
+{
+    tcp_client_slot_t *slot;
+
+    cy_rtos_mutex_get(&client_table_mutex, CY_RTOS_NEVER_TIMEOUT);
+    slot = tcp_client_slot_find(socket_handle);
+    if(slot != NULL)
+    {
+        slot->rx_pending++;
+    }
+    cy_rtos_mutex_set(&client_table_mutex);
+
+    if(slot == NULL)
+    {
+        return CY_RSLT_MODULE_SECURE_SOCKETS_BADARG;
+    }
+
+    cy_rtos_event_setbits(&server_event, TCP_SERVER_EVENT_SOCKET);
+
+    return CY_RSLT_SUCCESS;
+}
+
+ /*******************************************************************************
+ * Function Name: tcp_disconnection_handler
+ *******************************************************************************
+ * Summary:
+ *  Callback function to handle TCP client disconnection event. Records the
+ *  event for the TCP server task, which closes the connection.
+ *
+ * Parameters:
+ * cy_socket_t socket_handle: Connection handle for the TCP client socket
+ *  void *args : Parameter passed on to the function (unused)
+ *
+ * Return:
+ *  cy_result result: Result of the operation
+ *
+ *******************************************************************************/
+static cy_rslt_t tcp_disconnection_handler(cy_socket_t socket_handle, void *arg)
+{
+    tcp_client_slot_t *slot;
+
+    cy_rtos_mutex_get(&client_table_mutex, CY_RTOS_NEVER_TIMEOUT);
+    slot = tcp_client_slot_find(socket_handle);
+    if(slot != NULL)
+    {
+        slot->disconnect_pending = true;
+    }
+    cy_rtos_mutex_set(&client_table_mutex);
+
+    /* A socket that is not in the table was released by the task, which
+     * has closed it or is closing it.
+     */
+    if(slot != NULL)
+    {
+        cy_rtos_event_setbits(&server_event, TCP_SERVER_EVENT_SOCKET);
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: tcp_server_process_socket_events
+ *******************************************************************************
+ * Summary:
+ *  Handles the connection requests, messages and disconnections recorded by
+ *  the socket callbacks since the last call.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void tcp_server_process_socket_events(void)
+{
+    tcp_client_slot_t *slot;
+    uint32_t num_connects;
+    uint32_t rx_pending;
+    uint32_t num_reads;
+    bool disconnect_pending;
+
+    cy_rtos_mutex_get(&client_table_mutex, CY_RTOS_NEVER_TIMEOUT);
+    num_connects = connect_pending;
+    connect_pending = 0;
+    cy_rtos_mutex_set(&client_table_mutex);
+
+    for(; num_connects > 0; num_connects--)
+    {
+        tcp_client_accept();
+    }
+
+    for(uint32_t i = 0; i < TCP_SERVER_MAX_CLIENTS; i++)
+    {
+        slot = &client_table[i];
+        if(slot->state != TCP_CLIENT_SLOT_CONNECTED)
+        {
+            continue;
+        }
+
+        cy_rtos_mutex_get(&client_table_mutex, CY_RTOS_NEVER_TIMEOUT);
+        rx_pending = slot->rx_pending;
+        slot->rx_pending = 0;
+        disconnect_pending = slot->disconnect_pending;
+        cy_rtos_mutex_set(&client_table_mutex);
+
+        /* Receive the messages first; they were sent before the disconnection.
+         * One read can return the data of several receive callbacks, so the
+         * socket is read until it is empty rather than once per callback.
+         */
+        num_reads = 0;
+        if(rx_pending > 0)
+        {
+            while((num_reads < TCP_SERVER_MAX_RECV_PER_EVENT) &&
+                  (slot->state == TCP_CLIENT_SLOT_CONNECTED) && tcp_client_receive(slot))
+            {
+                num_reads++;
+            }
+        }
+
+        if((num_reads == TCP_SERVER_MAX_RECV_PER_EVENT) && (slot->state == TCP_CLIENT_SLOT_CONNECTED))
+        {
+            /* The client may have more data: serve the others first. */
+            cy_rtos_mutex_get(&client_table_mutex, CY_RTOS_NEVER_TIMEOUT);
+            slot->rx_pending++;
+            cy_rtos_mutex_set(&client_table_mutex);
+            cy_rtos_event_setbits(&server_event, TCP_SERVER_EVENT_SOCKET);
+        }
+        else if(disconnect_pending && (slot->state == TCP_CLIENT_SLOT_CONNECTED))
+        {
+            tcp_client_slot_release(slot);
+
+            printf("TCP Client disconnected! Connected TCP clients: %"PRIu32"/%u\n",
+                   num_clients_connected, TCP_SERVER_MAX_CLIENTS);
+            printf("===============================================================\n");
+            printf("Listening for incoming TCP client connection on Port:%d\n",
+                    tcp_server_addr.port);
+
+            /* Set the LED state to OFF when the last TCP client disconnects. */
+            if(num_clients_connected == 0)
+            {
+                led_state = CYBSP_LED_STATE_OFF;
+            }
+        }
+    }
+}
+
+ /*******************************************************************************
+ * Function Name: tcp_client_accept
+ *******************************************************************************
+ * Summary:
+ *  Accepts a pending TCP client connection and claims a slot of the
+ *  connection table for it.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void tcp_client_accept(void)
 {
     cy_rslt_t result;
     char ip_addr_str[IP_ADDR_BUFFER_SIZE];
@@ -576,6 +902,17 @@ static cy_rslt_t tcp_connection_handler(cy_socket_t socket_handle, void *arg)
         .version = NW_IP_IPV4
     };
 
+    /* Socket address and handle of the accepted TCP client. */
+    cy_socket_sockaddr_t peer_addr;
+    uint32_t peer_addr_len = sizeof(peer_addr);
+    cy_socket_t client_handle;
+#if !defined(CY_SOCKET_FLAGS_DONTWAIT)
+    uint32_t client_recv_timeout = TCP_SERVER_CLIENT_RECV_TIMEOUT_MS;
+#endif
+
+    /* Free slot of the connection table for the new TCP client. */
+    tcp_client_slot_t *slot;
+
     /* TCP keep alive parameters. */
     int keep_alive = 1;
 #if defined (COMPONENT_LWIP)
@@ -585,95 +922,156 @@ static cy_rslt_t tcp_connection_handler(cy_socket_t socket_handle, void *arg)
 #endif
 
     /* Accept new incoming connection from a TCP client.*/
-    result = cy_socket_accept(socket_handle, &peer_addr, &peer_addr_len,
+    result = cy_socket_accept(server_handle, &peer_addr, &peer_addr_len,
                               &client_handle);
-    if(result == CY_RSLT_SUCCESS)
+    if(result != CY_RSLT_SUCCESS)
     {
-        printf("Incoming TCP connection accepted\n");
-        nw_ip_addr.ip.v4 = peer_addr.ip_address.ip.v4;
-        cy_nw_ntoa(&nw_ip_addr, ip_addr_str);
-        printf("IP Address : %s\n\n", ip_addr_str);
-        printf("Press the user button to send LED ON/OFF command to the TCP client\n");
+        printf("Failed to accept incoming client connection. Error code: 0x%08"PRIx32"\n", (uint32_t)result);
+        printf("===============================================================\n");
+        printf("Listening for incoming TCP client connection on Port: %d\n",
+                tcp_server_addr.port);
+        return;
+    }
 
-#if defined (COMPONENT_LWIP)
-        /* Set the TCP keep alive interval. */
-        result = cy_socket_setsockopt(client_handle, CY_SOCKET_SOL_TCP,
-                                      CY_SOCKET_SO_TCP_KEEPALIVE_INTERVAL,
-                                      &keep_alive_interval, sizeof(keep_alive_interval));
-        if(result != CY_RSLT_SUCCESS)
-        {
-            printf("Set socket option: CY_SOCKET_SO_TCP_KEEPALIVE_INTERVAL failed\n");
-            return result;
-        }
+#if !defined(CY_SOCKET_FLAGS_DONTWAIT)
+    /* Set before the client is added to the table, so that no read of the
+     * server task waits for the receive timeout of the listening socket.
+     */
+    result = cy_socket_setsockopt(client_handle, CY_SOCKET_SOL_SOCKET,
+                                  CY_SOCKET_SO_RCVTIMEO, &client_recv_timeout,
+                                  sizeof(client_recv_timeout));
+    if(result != CY_RSLT_SUCCESS)
+    {
+        printf("Set socket option: CY_SOCKET_SO_RCVTIMEO failed\n");
+        cy_socket_disconnect(client_handle, 0);
+        cy_socket_delete(client_handle);
+        return;
+    }
+#endif
 
-        /* Set the retry count for TCP keep alive packet. */
-        result = cy_socket_setsockopt(client_handle, CY_SOCKET_SOL_TCP,
-                                      CY_SOCKET_SO_TCP_KEEPALIVE_COUNT,
-                                      &keep_alive_count, sizeof(keep_alive_count));
-        if(result != CY_RSLT_SUCCESS)
-        {
-            printf("Set socket option: CY_SOCKET_SO_TCP_KEEPALIVE_COUNT failed\n");
-            return result;
-        }
+    nw_ip_addr.ip.v4 = peer_addr.ip_address.ip.v4;
+    cy_nw_ntoa(&nw_ip_addr, ip_addr_str);
 
-        /* Set the network idle time before sending the TCP keep alive packet. */
-        result = cy_socket_setsockopt(client_handle, CY_SOCKET_SOL_TCP,
-                                      CY_SOCKET_SO_TCP_KEEPALIVE_IDLE_TIME,
-                                      &keep_alive_idle_time, sizeof(keep_alive_idle_time));
-        if(result != CY_RSLT_SUCCESS)
-        {
-            printf("Set socket option: CY_SOCKET_SO_TCP_KEEPALIVE_IDLE_TIME failed\n");
-            return result;
-        }
-#endif
+    /* Claim a free slot of the connection table for the new client. */
+    cy_rtos_mutex_get(&client_table_mutex, CY_RTOS_NEVER_TIMEOUT);
+    slot = tcp_client_slot_find(CY_SOCKET_INVALID_HANDLE);
+    if(slot != NULL)
+    {
+        slot->handle = client_handle;
+        slot->peer_addr = peer_addr;
+        slot->rx_pending = 0;
+        slot->disconnect_pending = false;
+        slot->state = TCP_CLIENT_SLOT_CONNECTED;
+#if(USE_FRAMED_PROTOCOL)
+        tcp_frame_parser_init(&slot->parser);
+#endif /* USE_FRAMED_PROTOCOL */
+        num_clients_connected++;
+    }
+    cy_rtos_mutex_set(&client_table_mutex);
 
-        /* Enable TCP keep alive. */
-        result = cy_socket_setsockopt(client_handle, CY_SOCKET_SOL_SOCKET,
-                                          CY_SOCKET_SO_TCP_KEEPALIVE_ENABLE,
-                                              &keep_alive, sizeof(keep_alive));
-        if(result != CY_RSLT_SUCCESS)
-        {
-            printf("Set socket option: CY_SOCKET_SO_TCP_KEEPALIVE_ENABLE failed\n");
-            return result;
-        }
+    if(slot == NULL)
+    {
+        printf("Connection table full, rejecting TCP client %s\n", ip_addr_str);
+        cy_socket_disconnect(client_handle, 0);
+        cy_socket_delete(client_handle);
+        return;
+    }
+
+    printf("Incoming TCP connection accepted\n");
+    printf("IP Address : %s\n", ip_addr_str);
+    printf("Connected TCP clients: %"PRIu32"/%u\n\n", num_clients_connected,
+           TCP_SERVER_MAX_CLIENTS);
+    printf("Press the user button to send LED ON/OFF command to the TCP clients\n");
 
-        /* Set the client connection flag as true. */
-        client_connected = true;
+#if defined (COMPONENT_LWIP)
+    /* Set the TCP keep alive interval. */
+    result = cy_socket_setsockopt(client_handle, CY_SOCKET_SOL_TCP,
+                                  CY_SOCKET_SO_TCP_KEEPALIVE_INTERVAL,
+                                  &keep_alive_interval, sizeof(keep_alive_interval));
+    if(result != CY_RSLT_SUCCESS)
+    {
+        printf("Set socket option: CY_SOCKET_SO_TCP_KEEPALIVE_INTERVAL failed\n");
+        return;
     }
-    else
+
+    /* Set the retry count for TCP keep alive packet. */
+    result = cy_socket_setsockopt(client_handle, CY_SOCKET_SOL_TCP,
+                                  CY_SOCKET_SO_TCP_KEEPALIVE_COUNT,
+                                  &keep_alive_count, sizeof(keep_alive_count));
+    if(result != CY_RSLT_SUCCESS)
     {
-        printf("Failed to accept incoming client connection. Error code: 0x%08"PRIx32"\n", (uint32_t)result);
-        printf("===============================================================\n");
-        printf("Listening for incoming TCP client connection on Port: %d\n",
-                tcp_server_addr.port);
+        printf("Set socket option: CY_SOCKET_SO_TCP_KEEPALIVE_COUNT failed\n");
+        return;
     }
 
-    return result;
+    /* Set the network idle time before sending the TCP keep alive packet. */
+    result = cy_socket_setsockopt(client_handle, CY_SOCKET_SOL_TCP,
+                                  CY_SOCKET_SO_TCP_KEEPALIVE_IDLE_TIME,
+                                  &keep_alive_idle_time, sizeof(keep_alive_idle_time));
+    if(result != CY_RSLT_SUCCESS)
+    {
+        printf("Set socket option: CY_SOCKET_SO_TCP_KEEPALIVE_IDLE_TIME failed\n");
+        return;
+    }
+#endif
+
+    /* Enable TCP keep alive. */
+    result = cy_socket_setsockopt(client_handle, CY_SOCKET_SOL_SOCKET,
+                                      CY_SOCKET_SO_TCP_KEEPALIVE_ENABLE,
+                                          &keep_alive, sizeof(keep_alive));
+    if(result != CY_RSLT_SUCCESS)
+    {
+        printf("Set socket option: CY_SOCKET_SO_TCP_KEEPALIVE_ENABLE failed\n");
+    }
 }
 
  /*******************************************************************************
- * Function Name: tcp_receive_msg_handler
+ * Function Name: tcp_client_receive
  *******************************************************************************
  * Summary:
- *  Callback function to handle incoming TCP client messages.
+ *  Receives a message from a TCP client and updates the LED state from the
+ *  acknowledgement. An empty socket is not an error.
  *
  * Parameters:
- * cy_socket_t socket_handle: Connection handle for the TCP client socket
- *  void *args : Parameter passed on to the function (unused)
+ *  tcp_client_slot_t *slot: Connection table slot of the TCP client
  *
  * Return:
- *  cy_result result: Result of the operation
+ *  bool: true if a message was received, false if the socket is empty or
+ *  the read failed.
  *
  *******************************************************************************/
-static cy_rslt_t tcp_receive_msg_handler(cy_socket_t socket_handle, void *arg)
+static bool tcp_client_receive(tcp_client_slot_t *slot)
 {
-    char message_buffer[MAX_TCP_RECV_BUFFER_SIZE];
     cy_rslt_t result;
 
     /* Variable to store number of bytes received from TCP client. */
     uint32_t bytes_received = 0;
-    result = cy_socket_recv(socket_handle, message_buffer, MAX_TCP_RECV_BUFFER_SIZE,
-                            CY_SOCKET_FLAGS_NONE, &bytes_received);
+
+#if(USE_FRAMED_PROTOCOL)
+    uint8_t *rx_space;
+    uint32_t rx_space_len;
+    uint32_t num_frames;
+
+    /* Receive straight into the parser buffer of the client and decode every
+     * complete frame of the segment.
+     */
+    rx_space = tcp_frame_parser_space(&slot->parser, &rx_space_len);
+    result = cy_socket_recv(slot->handle, rx_space, rx_space_len,
+                            TCP_SERVER_RECV_FLAGS, &bytes_received);
+
+    if(result == CY_RSLT_SUCCESS)
+    {
+        num_frames = tcp_frame_parser_commit(&slot->parser, bytes_received,
+                                             tcp_frame_handler, NULL);
+        printf("\r\nAcknowledgement frames from TCP Client: %"PRIu32" (total: %"PRIu32", errors: %"PRIu32")\n",
+               num_frames, slot->parser.frames, slot->parser.errors);
+    }
+    else
+#else
+    char message_buffer[MAX_TCP_RECV_BUFFER_SIZE];
+
+    result = cy_socket_recv(slot->handle, message_buffer, MAX_TCP_RECV_BUFFER_SIZE - 1,
+                            TCP_SERVER_RECV_FLAGS, &bytes_received);
 
     if(result == CY_RSLT_SUCCESS)
     {
@@ -682,7 +1080,7 @@ static cy_rslt_t tcp_receive_msg_handler(cy_socket_t socket_handle, void *arg)
         printf("\r\nAcknowledgement from TCP Client: %s\n", message_buffer);
 
         /* Set the LED state based on the acknowledgement received from the TCP client. */
-        if(strcmp(message_buffer, "LED ON ACK") == 0)
+        if(strcmp(message_buffer, LED_ON_ACK) == 0)
         {
             led_state = CYBSP_LED_STATE_ON;
         }
@@ -692,93 +1090,408 @@ static cy_rslt_t tcp_receive_msg_handler(cy_socket_t socket_handle, void *arg)
         }
     }
     else
+#endif /* USE_FRAMED_PROTOCOL */
+    if((result == CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT) ||
+       (result == CY_RSLT_MODULE_SECURE_SOCKETS_WOULDBLOCK))
+    {
+        /* The socket is empty: an earlier read took the data. */
+        return false;
+    }
+    else
     {
         printf("Failed to receive acknowledgement from the TCP client. Error: 0x%08"PRIx32"\n",
               (uint32_t)result);
         if(result == CY_RSLT_MODULE_SECURE_SOCKETS_CLOSED)
         {
-            /* Disconnect the socket. */
-            cy_socket_disconnect(socket_handle, 0);
-            /* Delete the socket. */
-            cy_socket_delete(socket_handle);
+            tcp_client_slot_release(slot);
         }
+        return false;
     }
 
     printf("===============================================================\n");
-    printf("Press the user button to send LED ON/OFF command to the TCP client\n");
+    printf("Press the user button to send LED ON/OFF command to the TCP clients\n");
 
-    return result;
+    return true;
 }
 
- /*******************************************************************************
- * Function Name: tcp_disconnection_handler
+#if(USE_FRAMED_PROTOCOL)
+/*******************************************************************************
+ * Function Name: tcp_frame_handler
  *******************************************************************************
  * Summary:
- *  Callback function to handle TCP client disconnection event.
+ *  Called by the frame parser for every complete frame received from a TCP
+ *  client. Updates the LED state from the acknowledgement frames.
  *
  * Parameters:
- * cy_socket_t socket_handle: Connection handle for the TCP client socket
- *  void *args : Parameter passed on to the function (unused)
+ *  const tcp_frame_t *frame: Decoded frame
+ *  void *arg: Parameter passed on to the function (unused)
  *
  * Return:
- *  cy_result result: Result of the operation
+ *  void
  *
  *******************************************************************************/
-static cy_rslt_t tcp_disconnection_handler(cy_socket_t socket_handle, void *arg)
+static void tcp_frame_handler(const tcp_frame_t *frame, void *arg)
 {
-    cy_rslt_t result;
+    if((frame->type == TCP_FRAME_TYPE_LED_ACK) && (frame->length == TCP_FRAME_LED_PAYLOAD_LEN))
+    {
+        led_state = (frame->payload[0] == TCP_FRAME_LED_ON) ?
+                    CYBSP_LED_STATE_ON : CYBSP_LED_STATE_OFF;
+    }
+}
+#endif /* USE_FRAMED_PROTOCOL */
 
-    /* Disconnect the TCP client. */
-    result = cy_socket_disconnect(socket_handle, 0);
+/*******************************************************************************
+ * Function Name: tcp_client_slot_find
+ *******************************************************************************
+ * Summary:
+ *  Looks up the connection table slot owned by the given socket. Passing
+ *  CY_SOCKET_INVALID_HANDLE returns the first free slot. Must be called with
+ *  client_table_mutex held.
+ *
+ * Parameters:
+ *  cy_socket_t socket_handle: Socket handle to look up
+ *
+ * Return:
+ *  tcp_client_slot_t *: Matching slot, or NULL if there is none
+ *
+ *******************************************************************************/
+static tcp_client_slot_t *tcp_client_slot_find(cy_socket_t socket_handle)
+{
+    for(uint32_t i = 0; i < TCP_SERVER_MAX_CLIENTS; i++)
+    {
+        if(socket_handle == CY_SOCKET_INVALID_HANDLE)
+        {
+            if(client_table[i].state == TCP_CLIENT_SLOT_FREE)
+            {
+                return &client_table[i];
+            }
+        }
+        else if((client_table[i].state == TCP_CLIENT_SLOT_CONNECTED) &&
+                (client_table[i].handle == socket_handle))
+        {
+            return &client_table[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+ * Function Name: tcp_client_slot_release
+ *******************************************************************************
+ * Summary:
+ *  Marks a connection table slot free and closes the socket it owned. Must be
+ *  called from the TCP server task without client_table_mutex held.
+ *
+ * Parameters:
+ *  tcp_client_slot_t *slot: Slot to release (NULL is ignored)
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void tcp_client_slot_release(tcp_client_slot_t *slot)
+{
+    cy_socket_t socket_handle;
+
+    if((slot == NULL) || (slot->state == TCP_CLIENT_SLOT_FREE))
+    {
+        return;
+    }
+
+    /* Take the slot out of the table before closing the socket, so that the
+     * callbacks no longer find it.
+     */
+    cy_rtos_mutex_get(&client_table_mutex, CY_RTOS_NEVER_TIMEOUT);
+    socket_handle = slot->handle;
+    slot->handle = CY_SOCKET_INVALID_HANDLE;
+    slot->state = TCP_CLIENT_SLOT_FREE;
+    num_clients_connected--;
+    cy_rtos_mutex_set(&client_table_mutex);
+
+    /* Disconnect the socket. */
+    cy_socket_disconnect(socket_handle, 0);
     /* Delete the socket. */
     cy_socket_delete(socket_handle);
+}
+#endif /* !USE_NX_ZERO_COPY */
 
-    /* Set the client connection flag as false. */
-    client_connected = false;
-    printf("TCP Client disconnected! Please reconnect the TCP Client\n");
-    printf("===============================================================\n");
-    printf("Listening for incoming TCP client connection on Port:%d\n",
-            tcp_server_addr.port);
+/*******************************************************************************
+ * Function Name: tcp_broadcast_led_cmd
+ *******************************************************************************
+ * Summary:
+ *  Sends the LED ON/OFF command to every connected TCP client in a single pass
+ *  over the connection table. Clients whose socket turns out to be closed are
+ *  released.
+ *
+ * Parameters:
+ *  uint8_t led_state_cmd: LED ON/OFF command to send
+ *
+ * Return:
+ *  uint32_t: Number of TCP clients the command was sent to
+ *
+ *******************************************************************************/
+static uint32_t tcp_broadcast_led_cmd(uint8_t led_state_cmd)
+{
+#if(USE_NX_ZERO_COPY)
+    /* Every client gets the command in a packet of the application pool. */
+    return nx_tcp_server_broadcast(&led_state_cmd, TCP_LED_CMD_LEN);
+#else
+    cy_rslt_t result;
+
+    /* Variable to store number of bytes sent over TCP socket. */
+    uint32_t bytes_sent = 0;
+    uint32_t num_clients_sent = 0;
 
-    /* Set the LED state to OFF when the TCP client disconnects. */
-    led_state = CYBSP_LED_STATE_OFF;
+    /* Data sent to every client. */
+    const void *tx_data = &led_state_cmd;
+    uint32_t tx_len = TCP_LED_CMD_LEN;
 
-    return result;
+#if(USE_FRAMED_PROTOCOL)
+    uint8_t led_payload = (led_state_cmd == LED_ON_CMD) ? TCP_FRAME_LED_ON : TCP_FRAME_LED_OFF;
+    uint8_t tx_frame[TCP_FRAME_HEADER_LEN + TCP_FRAME_LED_PAYLOAD_LEN];
+
+    /* Encode the command frame once; the same frame goes to every client. */
+    tx_len = tcp_frame_encode(tx_frame, sizeof(tx_frame), TCP_FRAME_TYPE_LED_CMD,
+                              tx_sequence, &led_payload, TCP_FRAME_LED_PAYLOAD_LEN);
+    tx_sequence++;
+    tx_data = tx_frame;
+#endif /* USE_FRAMED_PROTOCOL */
+
+    /* Only the TCP server task changes the table, so it is read without
+     * client_table_mutex and the callbacks are never blocked by a send.
+     */
+    for(uint32_t i = 0; i < TCP_SERVER_MAX_CLIENTS; i++)
+    {
+        if(client_table[i].state != TCP_CLIENT_SLOT_CONNECTED)
+        {
+            continue;
+        }
+
+        /* Send the command to TCP client. */
+        result = cy_socket_send(client_table[i].handle, tx_data, tx_len,
+                                CY_SOCKET_FLAGS_NONE, &bytes_sent);
+        if(result == CY_RSLT_SUCCESS)
+        {
+            num_clients_sent++;
+        }
+        else
+        {
+            printf("Failed to send command to client %"PRIu32". Error code: 0x%08"PRIx32"\n",
+                   i, (uint32_t)result);
+            if(result == CY_RSLT_MODULE_SECURE_SOCKETS_CLOSED)
+            {
+                tcp_client_slot_release(&client_table[i]);
+            }
+        }
+    }
+
+    return num_clients_sent;
+#endif /* USE_NX_ZERO_COPY */
 }
 
+#if(USE_NX_ZERO_COPY)
 /*******************************************************************************
- * Function Name: isr_button_press
+ * Function Name: tcp_nx_receive_handler
  *******************************************************************************
+ * Summary:
+ *  Called by the NetX Duo TCP server for every packet received from a TCP
+ *  client. The acknowledgement is read in place from the packet; it always
+ *  fits in the first packet of the chain.
+ *
+ * Parameters:
+ *  uint32_t client: Index of the TCP client
+ *  NX_PACKET *packet: Received packet chain
  *
+ * Return:
+ *  bool: false, the acknowledgement needs no reply
+ *
+ *******************************************************************************/
+static bool tcp_nx_receive_handler(uint32_t client, NX_PACKET *packet)
+{
+    const char *ack = (const char *)packet->nx_packet_prepend_ptr;
+    uint32_t ack_len = (uint32_t)(packet->nx_packet_append_ptr - packet->nx_packet_prepend_ptr);
+
+    printf("\r\nAcknowledgement from TCP Client %"PRIu32": %.*s\n", client, (int)ack_len, ack);
+
+    /* Set the LED state based on the acknowledgement received from the TCP client. */
+    if((ack_len == (sizeof(LED_ON_ACK) - 1)) && (memcmp(ack, LED_ON_ACK, ack_len) == 0))
+    {
+        led_state = CYBSP_LED_STATE_ON;
+    }
+    else
+    {
+        led_state = CYBSP_LED_STATE_OFF;
+    }
+
+    printf("===============================================================\n");
+    printf("Press the user button to send LED ON/OFF command to the TCP clients\n");
+
+    return false;
+}
+
+/*******************************************************************************
+ * Function Name: tcp_nx_connection_handler
+ *******************************************************************************
  * Summary:
- *  GPIO interrupt service routine. This function detects button presses and
- *  sets the command to be sent to TCP client.
+ *  Called by the NetX Duo TCP server after a TCP client connected or
+ *  disconnected.
  *
  * Parameters:
- *  void *callback_arg : pointer to the variable passed to the ISR
- *  cyhal_gpio_event_t event : GPIO event type
+ *  uint32_t client: Index of the TCP client
+ *  bool connected: true on connect, false on disconnect
+ *  ULONG peer_ip: IPv4 address of the TCP client in host byte order
+ *  uint32_t num_clients: Number of connected TCP clients
  *
  * Return:
- *  None
+ *  void
  *
  *******************************************************************************/
-static void isr_button_press( void *callback_arg, cyhal_gpio_event_t event)
+static void tcp_nx_connection_handler(uint32_t client, bool connected,
+                                      ULONG peer_ip, uint32_t num_clients)
+{
+    if(connected)
+    {
+        printf("Incoming TCP connection accepted\n");
+        printf("IP Address : %u.%u.%u.%u\n", (unsigned int)((peer_ip >> 24) & 0xFF),
+               (unsigned int)((peer_ip >> 16) & 0xFF), (unsigned int)((peer_ip >> 8) & 0xFF),
+               (unsigned int)(peer_ip & 0xFF));
+        printf("Connected TCP clients: %"PRIu32"/%u\n\n", num_clients, NX_TCP_SERVER_MAX_CLIENTS);
+        printf("Press the user button to send LED ON/OFF command to the TCP clients\n");
+        return;
+    }
+
+    printf("TCP Client %"PRIu32" disconnected! Connected TCP clients: %"PRIu32"/%u\n",
+           client, num_clients, NX_TCP_SERVER_MAX_CLIENTS);
+    nx_tcp_server_print_pool_stats();
+    printf("===============================================================\n");
+    printf("Listening for incoming TCP client connection on Port:%d\n", TCP_SERVER_PORT);
+
+    /* Set the LED state to OFF when the last TCP client disconnects. */
+    if(num_clients == 0)
+    {
+        led_state = CYBSP_LED_STATE_OFF;
+    }
+}
+#endif /* USE_NX_ZERO_COPY */
+
+/*******************************************************************************
+ * Function Name: tcp_server_button_handler
+ *******************************************************************************
+ * Summary:
+ *  Handles a user button press. The command is sent right away and the
+ *  debounce timer is started; the button interrupt stays disabled until the
+ *  timer expires so that the bounces of the same press are ignored.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void tcp_server_button_handler(void)
 {
-    /* Variable to hold the LED ON/OFF command to be sent to the TCP client. */
-    uint32_t led_state_cmd;
+    /* LED ON/OFF command to be sent to the TCP clients. */
+    uint8_t led_state_cmd;
+
+#if(TCP_BENCHMARK_MODE)
+    /* Socket of the TCP client the benchmark runs against. */
+    cy_socket_t bench_handle = CY_SOCKET_INVALID_HANDLE;
+#else
+    /* Number of TCP clients the command was delivered to. */
+    uint32_t num_clients_sent = 0;
+#endif /* TCP_BENCHMARK_MODE */
+
+    /* Disable the GPIO signal falling edge detection until the end of the
+     * debounce period.
+     */
+    cyhal_gpio_enable_event(CYBSP_USER_BTN, CYHAL_GPIO_IRQ_FALL, USER_BTN_INTR_PRIORITY, false);
+    cy_rtos_timer_start(&debounce_timer, DEBOUNCE_DELAY_MS);
+
+    /* A falling edge with the button already released is a bounce. */
+    if(cyhal_gpio_read(CYBSP_USER_BTN))
+    {
+        return;
+    }
 
     /* Set the command to be sent to TCP client. */
-    if(led_state == CYBSP_LED_STATE_ON)
+    led_state_cmd = (led_state == CYBSP_LED_STATE_ON) ? LED_OFF_CMD : LED_ON_CMD;
+
+#if(TCP_BENCHMARK_MODE)
+    (void)led_state_cmd;
+
+    /* Run the benchmark against the first connected TCP client. */
+    for(uint32_t i = 0; i < TCP_SERVER_MAX_CLIENTS; i++)
     {
-        led_state_cmd = LED_OFF_CMD;
+        if(client_table[i].state == TCP_CLIENT_SLOT_CONNECTED)
+        {
+            bench_handle = client_table[i].handle;
+            break;
+        }
+    }
+
+    if(bench_handle != CY_SOCKET_INVALID_HANDLE)
+    {
+        tcp_bench_run(bench_handle);
     }
     else
     {
-        led_state_cmd = LED_ON_CMD;
+        printf("Connect tcp_bench.py before starting the benchmark\n");
     }
+#else
+    /* Send LED ON/OFF command to every connected TCP client. */
+    num_clients_sent = tcp_broadcast_led_cmd(led_state_cmd);
+    if(num_clients_sent > 0)
+    {
+        printf("LED %s command sent to %"PRIu32" TCP client(s)\n",
+               (led_state_cmd == LED_ON_CMD) ? "ON" : "OFF", num_clients_sent);
+    }
+#if(USE_NX_ZERO_COPY)
+    nx_tcp_server_print_pool_stats();
+#endif /* USE_NX_ZERO_COPY */
+#endif /* TCP_BENCHMARK_MODE */
+}
+
+/*******************************************************************************
+ * Function Name: debounce_timer_callback
+ *******************************************************************************
+ * Summary:
+ *  Called from the timer service at the end of the debounce period of the
+ *  user button.
+ *
+ * Parameters:
+ *  cy_timer_callback_arg_t arg: Parameter passed on to the function (unused)
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void debounce_timer_callback(cy_timer_callback_arg_t arg)
+{
+    cy_rtos_event_setbits(&server_event, TCP_SERVER_EVENT_DEBOUNCE);
+}
 
-    /* Send command to TCP client. */
-    cy_rtos_put_queue(&led_command_q, &led_state_cmd, 0, true);
+/*******************************************************************************
+ * Function Name: isr_button_press
+ *******************************************************************************
+ *
+ * Summary:
+ *  GPIO interrupt service routine. This function detects button presses and
+ *  signals them to the TCP server task.
+ *
+ * Parameters:
+ *  void *callback_arg : pointer to the variable passed to the ISR
+ *  cyhal_gpio_event_t event : GPIO event type
+ *
+ * Return:
+ *  None
+ *
+ *******************************************************************************/
+static void isr_button_press( void *callback_arg, cyhal_gpio_event_t event)
+{
+    /* Wake up the TCP server task. */
+    cy_rtos_event_setbits(&server_event, TCP_SERVER_EVENT_BUTTON);
 }
 
 
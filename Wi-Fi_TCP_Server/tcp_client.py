@@ -39,8 +39,10 @@
 #!/usr/bin/env python
 import socket
 import optparse
+import threading
 import time
 import sys
+import tcp_frame
 
 BUFFER_SIZE = 1024
 
@@ -50,29 +52,143 @@ DEFAULT_PORT = 50007             # Port of the TCP server
 
 DEFAULT_KEEP_ALIVE = 1           # TCP Keep Alive: 1 - Enable, 0 - Disable
 
+# Load test details
+DEFAULT_NUM_CLIENTS = 1          # Number of concurrent TCP clients
+DEFAULT_NUM_EVENTS  = 20         # Button events to collect in load test mode
+
+def connect_to_server(ip, port):
+    s = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    s.setsockopt(socket.SOL_SOCKET, socket.SO_KEEPALIVE, DEFAULT_KEEP_ALIVE)
+    s.setsockopt(socket.IPPROTO_TCP, socket.TCP_KEEPIDLE, 10)
+    s.setsockopt(socket.IPPROTO_TCP, socket.TCP_KEEPINTVL, 1)
+    s.setsockopt(socket.IPPROTO_TCP, socket.TCP_KEEPCNT, 2)
+    s.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+    s.connect((ip, port))
+    return s
+
+def send_ack(s, data):
+    if data == b'0':
+        s.send('LED OFF ACK'.encode('utf-8'))
+    if data == b'1':
+        s.send('LED ON ACK'.encode('utf-8'))
+
+def send_frame_acks(s, frames):
+    # Acknowledge every command frame of the segment in a single send.
+    acks = b''.join(tcp_frame.encode(tcp_frame.FRAME_TYPE_LED_ACK, seq, payload)
+                    for (frame_type, seq, payload) in frames
+                    if frame_type == tcp_frame.FRAME_TYPE_LED_CMD)
+    if acks:
+        s.send(acks)
+
+def receive_commands(s, parser):
+    # Returns the LED commands ('0'/'1') of one received segment, or None when
+    # the connection is closed.
+    data = s.recv(BUFFER_SIZE)
+    if not data:
+        return None
+    if parser is None:
+        send_ack(s, data[-1:])
+        return [data.decode('utf-8')]
+    frames = parser.feed(data)
+    send_frame_acks(s, frames)
+    return ['1' if payload == bytes([tcp_frame.FRAME_LED_ON]) else '0'
+            for (frame_type, seq, payload) in frames
+            if frame_type == tcp_frame.FRAME_TYPE_LED_CMD]
+
+def percentile(samples, pct):
+    ordered = sorted(samples)
+    index = int(round((pct / 100.0) * (len(ordered) - 1)))
+    return ordered[index]
+
+def run_interactive(ip, port, framed):
+    s = connect_to_server(ip, port)
+    parser = tcp_frame.FrameParser() if framed else None
+    print("Connected to TCP Server (IP Address: ", ip, "Port: ", port, " )")
+
+    while 1:
+        print("================================================================================")
+        commands = receive_commands(s, parser)
+        if commands is None:
+            break
+        print("Command from Server:")
+        for command in commands:
+            if command == '0':
+                print("LED OFF")
+            if command == '1':
+                print("LED ON")
+        print("Acknowledgement sent to server")
+
+def run_load_test(ip, port, num_clients, num_events, framed):
+    # Arrival time of each command, indexed by [event][client].
+    arrivals = [[None] * num_clients for _ in range(num_events)]
+    lock = threading.Lock()
+    done = threading.Event()
+
+    def client_worker(index, s):
+        parser = tcp_frame.FrameParser() if framed else None
+        event = 0
+        while event < num_events:
+            commands = receive_commands(s, parser)
+            stamp = time.perf_counter()
+            if commands is None:
+                break
+            if commands:
+                with lock:
+                    arrivals[event][index] = stamp
+                event += 1
+        s.close()
+
+    sockets = []
+    for index in range(num_clients):
+        sockets.append(connect_to_server(ip, port))
+    print("Connected", num_clients, "clients to TCP Server (IP Address: ", ip, "Port: ", port, " )")
+    print("Press the user button", num_events, "times to collect broadcast latencies")
+
+    threads = [threading.Thread(target=client_worker, args=(i, s), daemon=True)
+               for i, s in enumerate(sockets)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+
+    # Broadcast latency of a client is the delay between the first client and
+    # that client receiving the same command.
+    latencies_ms = []
+    missed = 0
+    for event in arrivals:
+        received = [stamp for stamp in event if stamp is not None]
+        missed += len(event) - len(received)
+        if received:
+            first = min(received)
+            latencies_ms.extend([(stamp - first) * 1000.0 for stamp in received])
+
+    print("================================================================================")
+    print("Broadcast latency over", num_events, "events x", num_clients, "clients")
+    if latencies_ms:
+        for pct in (50, 90, 99, 100):
+            print("  p%-3d : %8.3f ms" % (pct, percentile(latencies_ms, pct)))
+    print("  Missed commands:", missed)
+
+parser = optparse.OptionParser()
+parser.add_option("-i", "--ip", dest="ip", default=DEFAULT_IP,
+                  help="IP address of the TCP server")
+parser.add_option("-p", "--port", dest="port", type="int", default=DEFAULT_PORT,
+                  help="Port of the TCP server")
+parser.add_option("-n", "--clients", dest="clients", type="int", default=DEFAULT_NUM_CLIENTS,
+                  help="Number of concurrent clients; more than 1 runs the load test")
+parser.add_option("-f", "--framed", dest="framed", action="store_true", default=False,
+                  help="Use the length-prefixed binary framing (USE_FRAMED_PROTOCOL)")
+parser.add_option("-e", "--events", dest="events", type="int", default=DEFAULT_NUM_EVENTS,
+                  help="Number of button events to collect in load test mode")
+(options, args) = parser.parse_args()
+
 print("================================================================================")
 print("TCP Client")
 print("================================================================================")
-s = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
-s.setsockopt(socket.SOL_SOCKET, socket.SO_KEEPALIVE, DEFAULT_KEEP_ALIVE)
-s.setsockopt(socket.IPPROTO_TCP, socket.TCP_KEEPIDLE, 10)
-s.setsockopt(socket.IPPROTO_TCP, socket.TCP_KEEPINTVL, 1)
-s.setsockopt(socket.IPPROTO_TCP, socket.TCP_KEEPCNT, 2)
-s.connect((DEFAULT_IP, DEFAULT_PORT))
-print("Connected to TCP Server (IP Address: ", DEFAULT_IP, "Port: ", DEFAULT_PORT, " )")
-    
-while 1:
-    print("================================================================================")        
-    data = s.recv(BUFFER_SIZE);
-    print("Command from Server:")
-    if data.decode('utf-8') == '0':
-        print("LED OFF")
-        message = 'LED OFF ACK'
-        s.send(message.encode('utf-8'))
-    if data.decode('utf-8') == '1':
-        print("LED ON")
-        message = 'LED ON ACK'
-        s.send(message.encode('utf-8'))
-    print("Acknowledgement sent to server")        
+
+if options.clients > 1:
+    run_load_test(options.ip, options.port, options.clients, options.events, options.framed)
+else:
+    run_interactive(options.ip, options.port, options.framed)
 
 # [] END OF FILE
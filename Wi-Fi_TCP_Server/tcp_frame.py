@@ -0,0 +1,117 @@
+#******************************************************************************
+# File Name:   tcp_frame.py
+#
+# Description: Host codec for the length-prefixed binary framing used by the
+#              TCP LED protocol in framed mode (see source/tcp_frame.h). Run
+#              the file directly to benchmark the codec on the host.
+#
+#******************************************************************************
+# Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+# an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+#
+# This software, including source code, documentation and related
+# materials ("Software") is owned by Cypress Semiconductor Corporation
+# or one of its affiliates ("Cypress") and is protected by and subject to
+# worldwide patent protection (United States and foreign),
+# United States copyright laws and international treaty provisions.
+# Therefore, you may use this Software only as provided in the license
+# agreement accompanying the software package from which you
+# obtained this Software ("EULA").
+# If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+# non-transferable license to copy, modify, and compile the Software
+# source code solely for use in connection with Cypress's
+# integrated circuit products.  Any reproduction, modification, translation,
+# compilation, or representation of this Software except as specified
+# above is prohibited without the express written permission of Cypress.
+#
+# Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+# EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+# reserves the right to make changes to the Software without notice. Cypress
+# does not assume any liability arising out of the application or use of the
+# Software or any product or circuit described in the Software. Cypress does
+# not authorize its products for use in any products where a malfunction or
+# failure of the Cypress product may reasonably be expected to result in
+# significant property damage, injury or death ("High Risk Product"). By
+# including Cypress's product in a High Risk Product, the manufacturer
+# of such system or application assumes all risk of such use and in doing
+# so agrees to indemnify Cypress against all liability.
+#******************************************************************************
+
+#!/usr/bin/env python
+import struct
+import time
+
+# Frame layout: magic (1), type (1), sequence (2), length (2), payload.
+FRAME_MAGIC         = 0xA5
+FRAME_HEADER        = struct.Struct('>BBHH')
+FRAME_HEADER_LEN    = FRAME_HEADER.size
+FRAME_MAX_PAYLOAD   = 256
+
+FRAME_TYPE_LED_CMD  = 0x01
+FRAME_TYPE_LED_ACK  = 0x02
+
+FRAME_TYPE_BENCH_PING = 0x10
+FRAME_TYPE_BENCH_PONG = 0x11
+FRAME_TYPE_BENCH_DATA = 0x12
+FRAME_TYPE_BENCH_DONE = 0x13
+
+FRAME_LED_OFF       = 0x00
+FRAME_LED_ON        = 0x01
+
+def encode(frame_type, sequence, payload=b'', max_payload=FRAME_MAX_PAYLOAD):
+    if len(payload) > max_payload:
+        raise ValueError("payload too long")
+    return FRAME_HEADER.pack(FRAME_MAGIC, frame_type, sequence & 0xFFFF, len(payload)) + payload
+
+class FrameParser:
+    """Stream parser; feed() returns the list of (type, sequence, payload) of
+    every complete frame. A partial frame is kept for the next call."""
+
+    def __init__(self, max_payload=FRAME_MAX_PAYLOAD):
+        self.max_payload = max_payload
+        self.buffer = bytearray()
+        self.frames = 0
+        self.errors = 0
+
+    def feed(self, data):
+        self.buffer += data
+        frames = []
+        offset = 0
+        while len(self.buffer) - offset >= FRAME_HEADER_LEN:
+            magic, frame_type, sequence, length = FRAME_HEADER.unpack_from(self.buffer, offset)
+            if magic != FRAME_MAGIC or length > self.max_payload:
+                self.errors += 1
+                offset += 1
+                continue
+            end = offset + FRAME_HEADER_LEN + length
+            if end > len(self.buffer):
+                break
+            frames.append((frame_type, sequence, bytes(self.buffer[offset + FRAME_HEADER_LEN:end])))
+            offset = end
+        del self.buffer[:offset]
+        self.frames += len(frames)
+        return frames
+
+def benchmark(num_frames=200000, segment_size=1460):
+    start = time.perf_counter()
+    stream = b''.join(encode(FRAME_TYPE_LED_CMD, seq, bytes([seq & 1])) for seq in range(num_frames))
+    encode_time = time.perf_counter() - start
+
+    parser = FrameParser()
+    decoded = 0
+    start = time.perf_counter()
+    for offset in range(0, len(stream), segment_size):
+        decoded += len(parser.feed(stream[offset:offset + segment_size]))
+    decode_time = time.perf_counter() - start
+
+    if decoded != num_frames or parser.errors:
+        raise SystemExit("codec mismatch: %d/%d frames, %d errors" % (decoded, num_frames, parser.errors))
+    print("Encoded %d frames in %.3f s (%.0f frames/s)" % (num_frames, encode_time, num_frames / encode_time))
+    print("Decoded %d frames in %.3f s (%.0f frames/s) from %d-byte segments"
+          % (decoded, decode_time, decoded / decode_time, segment_size))
+
+if __name__ == '__main__':
+    benchmark()
+
+# [] END OF FILE
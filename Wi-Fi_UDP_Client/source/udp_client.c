@@ -57,6 +57,12 @@
 /* UDP client task header file. */
 #include "udp_client.h"
 
+/* UDP reliability layer header file. */
+#include "udp_reliable.h"
+
+/* UDP telemetry header file. */
+#include "udp_telemetry.h"
+
 /*******************************************************************************
 * Macros
 ********************************************************************************/
@@ -73,9 +79,21 @@
 /* Initial message sent to UDP Server to confirm client availability. */
 #define START_COMM_MSG                         "A"
 
+/* START_COMM_MSG is repeated when no command was received for this long, so
+ * that the server keeps the client in its registry when it ages out silent
+ * clients.
+ */
+#define UDP_CLIENT_REGISTER_INTERVAL_MS   (60000u)
+
 /* Buffer size to store the incoming messages from server, in bytes. */
 #define MAX_UDP_RECV_BUFFER_SIZE          (20)
 
+/* To receive the LED ON/OFF commands over the reliability layer (sequence
+ * numbers, cumulative acknowledgements and retransmission, see udp_reliable.h),
+ * set this macro as '1'. The server must enable reliable mode as well.
+ */
+#define USE_RELIABLE_UDP                  (0)
+
 /* RTOS related macros for UDP client task. */
 #define RTOS_TASK_TICKS_TO_WAIT           (1000)
 
@@ -85,6 +103,10 @@
 static cy_rslt_t create_udp_client_socket(void);
 static cy_rslt_t udp_client_recv_handler(cy_socket_t socket_handle, void *arg);
 static cy_rslt_t connect_to_wifi_ap(void);
+static const char *get_ack_msg(uint32_t led_state_cmd);
+#if(USE_RELIABLE_UDP)
+static void udp_client_deliver_cmd(uint16_t sequence, const uint8_t *payload, uint8_t length, void *arg);
+#endif
 void print_heap_usage(char* msg);
 
 /*******************************************************************************
@@ -97,6 +119,16 @@ cy_socket_sockaddr_t peer_addr;
 /* UDP Client task handle. */
 extern TaskHandle_t client_task_handle;
 
+#if(USE_RELIABLE_UDP)
+/* Receiving end of the reliable command stream. Only used by the receive
+ * callback; the task reads the counters for printing.
+ */
+udp_reliable_receiver_t led_cmd_receiver;
+
+/* Last command delivered by the reliability layer. */
+uint32_t last_led_cmd = LED_OFF_CMD;
+#endif
+
 /*******************************************************************************
  * Function Name: udp_client_task
  *******************************************************************************
@@ -121,6 +153,11 @@ void udp_client_task(void *arg)
     /* Variable to receive LED ON/OFF from udp_client_recv_handler. */
     uint32_t led_state_ack = LED_OFF_CMD;
 
+#if(!USE_RELIABLE_UDP)
+    /* Acknowledgement message for the command received. */
+    const char *ack_msg;
+#endif
+
     /* IP address and UDP port number of the UDP server */
     cy_socket_sockaddr_t udp_server_addr = {
         .ip_address.ip.v4 = UDP_SERVER_IP_ADDRESS,
@@ -151,6 +188,14 @@ void udp_client_task(void *arg)
         CY_ASSERT(0);
     }
 
+#if(USE_UDP_TELEMETRY)
+    result = udp_telemetry_start(&udp_server_addr);
+    if (result != CY_RSLT_SUCCESS)
+    {
+        printf("UDP telemetry start failed! Error: %"PRIu32"\n", result);
+    }
+#endif
+
     /* First send data to Server and wait to receive command */
     result = cy_socket_sendto(client_handle, START_COMM_MSG, strlen(START_COMM_MSG), CY_SOCKET_FLAGS_NONE,
                                 &udp_server_addr, sizeof(cy_socket_sockaddr_t), &bytes_sent);
@@ -166,7 +211,18 @@ void udp_client_task(void *arg)
     while(true)
     {
         /* Wait till ON/OFF command is received from UDP Server . */
-        xTaskNotifyWait(0, 0, &led_state_ack, portMAX_DELAY);
+        if(xTaskNotifyWait(0, 0, &led_state_ack, pdMS_TO_TICKS(UDP_CLIENT_REGISTER_INTERVAL_MS)) != pdTRUE)
+        {
+            /* Every acknowledgement refreshes the registration; repeat it
+             * when there was none for UDP_CLIENT_REGISTER_INTERVAL_MS. */
+            result = cy_socket_sendto(client_handle, START_COMM_MSG, strlen(START_COMM_MSG), CY_SOCKET_FLAGS_NONE,
+                                        &udp_server_addr, sizeof(cy_socket_sockaddr_t), &bytes_sent);
+            if(result != CY_RSLT_SUCCESS)
+            {
+                printf("Failed to refresh the registration with the server. Error : %"PRIu32"\n", result);
+            }
+            continue;
+        }
 
         printf("============================================================\n");
 
@@ -177,13 +233,6 @@ void udp_client_task(void *arg)
             printf("Command received from server to turn on LED\n");
             cyhal_gpio_write(CYBSP_USER_LED, CYBSP_LED_STATE_ON);
             printf("LED turned ON\n");
-
-            result = cy_socket_sendto(client_handle, ACK_LED_ON, strlen(ACK_LED_ON), CY_SOCKET_FLAGS_NONE,
-                                        &udp_server_addr, sizeof(cy_socket_sockaddr_t), &bytes_sent);
-            if(result != CY_RSLT_SUCCESS)
-            {
-                printf("Failed to send Acknowledgment to server. Error: %"PRIu32"\n", result);
-            }
         }
         else if(led_state_ack == LED_OFF_CMD)
         {
@@ -191,24 +240,34 @@ void udp_client_task(void *arg)
             printf("Command received from server to turn off LED\n");
             cyhal_gpio_write(CYBSP_USER_LED, CYBSP_LED_STATE_OFF);
             printf("LED turned OFF\n");
-
-            result = cy_socket_sendto(client_handle, ACK_LED_OFF, strlen(ACK_LED_OFF), CY_SOCKET_FLAGS_NONE,
-                                        &udp_server_addr, sizeof(cy_socket_sockaddr_t), &bytes_sent);
-            if(result != CY_RSLT_SUCCESS)
-            {
-                printf("Failed to send acknowledgment to server. Error: %"PRIu32"\n", result);
-            }
         }
         else
         {
             printf("Invalid command received.\n");
-            result = cy_socket_sendto(client_handle, INVALID_CMD_MSG, strlen(INVALID_CMD_MSG), CY_SOCKET_FLAGS_NONE,
-                                        &udp_server_addr, sizeof(cy_socket_sockaddr_t), &bytes_sent);
-            if(result != CY_RSLT_SUCCESS)
-            {
-                printf("Failed to send acknowledgment to server. Error: %"PRIu32"\n", result);
-            }
         }
+
+#if(USE_UDP_TELEMETRY)
+        if((led_state_ack == LED_ON_CMD) || (led_state_ack == LED_OFF_CMD))
+        {
+            udp_telemetry_record(UDP_TELEMETRY_CHANNEL_LED, (led_state_ack == LED_ON_CMD) ? 1 : 0);
+        }
+#endif
+
+#if(USE_RELIABLE_UDP)
+        /* The receive callback acknowledged the command already. */
+        printf("Reliable UDP: delivered %"PRIu32", duplicates %"PRIu32", out of order %"PRIu32
+               ", lost %"PRIu32", resyncs %"PRIu32"\n", led_cmd_receiver.stats.delivered,
+               led_cmd_receiver.stats.duplicates, led_cmd_receiver.stats.out_of_order,
+               led_cmd_receiver.stats.lost, led_cmd_receiver.stats.resyncs);
+#else
+        ack_msg = get_ack_msg(led_state_ack);
+        result = cy_socket_sendto(client_handle, ack_msg, strlen(ack_msg), CY_SOCKET_FLAGS_NONE,
+                                    &udp_server_addr, sizeof(cy_socket_sockaddr_t), &bytes_sent);
+        if(result != CY_RSLT_SUCCESS)
+        {
+            printf("Failed to send acknowledgment to server. Error: %"PRIu32"\n", result);
+        }
+#endif /* USE_RELIABLE_UDP */
         
         print_heap_usage("After controlling the LED and ACKing the server");
     }
@@ -308,6 +367,110 @@ cy_rslt_t create_udp_client_socket(void)
     return result;
 }
 
+/*******************************************************************************
+ * Function Name: get_ack_msg
+ *******************************************************************************
+ * Summary:
+ *  Returns the acknowledgement message for a command received from the server.
+ *
+ * Parameters:
+ *  uint32_t led_state_cmd: Command received from the server
+ *
+ * Return:
+ *  const char *: Acknowledgement message
+ *
+ *******************************************************************************/
+static const char *get_ack_msg(uint32_t led_state_cmd)
+{
+    if(led_state_cmd == LED_ON_CMD)
+    {
+        return ACK_LED_ON;
+    }
+    else if(led_state_cmd == LED_OFF_CMD)
+    {
+        return ACK_LED_OFF;
+    }
+
+    return INVALID_CMD_MSG;
+}
+
+#if(USE_RELIABLE_UDP)
+/*******************************************************************************
+ * Function Name: udp_client_deliver_cmd
+ *******************************************************************************
+ * Summary:
+ *  Called by the reliability layer for every command delivered in sequence
+ *  order. Records the command; the LED follows the last one.
+ *
+ * Parameters:
+ *  uint16_t sequence: Sequence number of the command (unused)
+ *  const uint8_t *payload: Command
+ *  uint8_t length: Length of the command
+ *  void *arg: Parameter passed on to the function (unused)
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void udp_client_deliver_cmd(uint16_t sequence, const uint8_t *payload, uint8_t length, void *arg)
+{
+    last_led_cmd = (length > 0) ? payload[0] : INVALID_CMD;
+}
+
+/*******************************************************************************
+ * Function Name: udp_client_recv_handler
+ *******************************************************************************
+ * Summary:
+ *  Callback function to handle incoming UDP server messages in reliable mode.
+ *  Every command packet, including retransmissions the client already has, is
+ *  acknowledged at once so that the server stops retransmitting it. The task
+ *  is notified only when new commands were delivered.
+ *
+ * Parameters:
+ *  cy_socket_t socket_handle: Connection handle for the UDP client socket
+ *  void *args : Parameter passed on to the function (unused)
+ *
+ * Return:
+ *  cy_result result: Result of the operation
+ *
+ *******************************************************************************/
+cy_rslt_t udp_client_recv_handler(cy_socket_t socket_handle, void *arg)
+{
+    cy_rslt_t result;
+    /* Variable to store the number of bytes received and sent. */
+    uint32_t bytes_received = 0;
+    uint32_t bytes_sent = 0;
+    /* Buffers to store the received command and the acknowledgement. */
+    uint8_t rx_buffer[UDP_RELIABLE_MAX_PACKET_LEN];
+    uint8_t ack_packet[UDP_RELIABLE_MAX_PACKET_LEN];
+    uint32_t ack_len;
+    const char *ack_msg;
+    /* Address of the UDP server that sent the command. */
+    cy_socket_sockaddr_t server_addr;
+    udp_reliable_packet_t packet;
+
+    /* Receive incoming message from UDP server. */
+    result = cy_socket_recvfrom(client_handle, rx_buffer, sizeof(rx_buffer),
+                                    CY_SOCKET_FLAGS_RECVFROM_NONE, &server_addr, NULL, &bytes_received);
+    if((result != CY_RSLT_SUCCESS) || !udp_reliable_decode(rx_buffer, bytes_received, &packet))
+    {
+        return result;
+    }
+
+    if(udp_reliable_receiver_on_data(&led_cmd_receiver, &packet, udp_client_deliver_cmd, NULL) > 0)
+    {
+        /* Send notification to the task to turn the LED on/off. */
+        xTaskNotify(client_task_handle, last_led_cmd, eSetValueWithOverwrite);
+    }
+
+    ack_msg = get_ack_msg(last_led_cmd);
+    ack_len = udp_reliable_receiver_encode_ack(&led_cmd_receiver, (const uint8_t *)ack_msg,
+                                               (uint8_t)strlen(ack_msg), ack_packet, sizeof(ack_packet));
+
+    return cy_socket_sendto(client_handle, ack_packet, ack_len, CY_SOCKET_FLAGS_NONE,
+                            &server_addr, sizeof(cy_socket_sockaddr_t), &bytes_sent);
+}
+#else
 /*******************************************************************************
  * Function Name: udp_client_recv_handler
  *******************************************************************************
@@ -339,5 +502,6 @@ cy_rslt_t udp_client_recv_handler(cy_socket_t socket_handle, void *arg)
 
     return result;
 }
+#endif /* USE_RELIABLE_UDP */
 
 /* [] END OF FILE */
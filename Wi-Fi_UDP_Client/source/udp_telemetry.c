@@ -0,0 +1,514 @@
+/******************************************************************************
+* File Name:   udp_telemetry.c
+*
+* Description: This file contains the batched UDP telemetry channel of the UDP
+*              client. Samples recorded by the application and the Wi-Fi signal
+*              strength sampled by the telemetry task are coalesced into
+*              MTU-sized datagrams, which are sent when full or when the oldest
+*              sample reaches the flush deadline.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Header file includes. */
+#include "cyhal.h"
+#include "cybsp.h"
+#include "cy_retarget_io.h"
+#include <inttypes.h>
+
+/* FreeRTOS header file. */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+
+/* Cypress secure socket header file. */
+#include "cy_secure_sockets.h"
+
+/* Wi-Fi connection manager header files. */
+#include "cy_wcm.h"
+
+/* UDP telemetry header file. */
+#include "udp_telemetry.h"
+
+#if(USE_UDP_TELEMETRY)
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* RTOS related macros for the telemetry task. */
+#define UDP_TELEMETRY_TASK_STACK_SIZE             (2 * 1024)
+#define UDP_TELEMETRY_TASK_PRIORITY               (1)
+
+/* Current time in milliseconds. */
+#define UDP_TELEMETRY_NOW_MS()                    ((uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS))
+
+/* True when the time 'deadline_ms' has been reached at 'now_ms'. */
+#define UDP_TELEMETRY_REACHED(now_ms, deadline_ms) ((int32_t)((now_ms) - (deadline_ms)) >= 0)
+
+/* Bytes of IPv4 and UDP header added to every datagram. */
+#define UDP_TELEMETRY_IP_UDP_HEADER_LEN           (28u)
+
+/*******************************************************************************
+* Data structure and enumeration
+********************************************************************************/
+/* Sample queued by udp_telemetry_record(). */
+typedef struct
+{
+    uint32_t time_ms;
+    int32_t value;
+    uint8_t channel;
+} udp_telemetry_sample_t;
+
+/* Telemetry counters. Datagrams are counted by the reason they were sent. */
+typedef struct
+{
+    uint32_t samples;
+    uint32_t bytes_sent;
+    uint32_t flushed_full;
+    uint32_t flushed_deadline;
+    uint32_t send_errors;
+    uint32_t dropped;
+} udp_telemetry_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static void udp_telemetry_task(void *arg);
+static void udp_telemetry_append(const udp_telemetry_sample_t *sample);
+static void udp_telemetry_flush(void);
+static void udp_telemetry_sample_rssi(uint32_t now_ms);
+static void udp_telemetry_report(uint32_t now_ms);
+static void udp_telemetry_put_u16(uint8_t *buffer, uint16_t value);
+static void udp_telemetry_put_u32(uint8_t *buffer, uint32_t value);
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* Socket used only for telemetry, so that the batches never delay the LED
+ * commands and acknowledgements.
+ */
+static cy_socket_t telemetry_handle;
+static cy_socket_sockaddr_t telemetry_server_addr;
+
+/* Samples recorded by other tasks. */
+static QueueHandle_t telemetry_queue;
+
+/* The datagram being filled. It is the only transmit buffer; it is sent in
+ * place and reused for the next batch.
+ */
+static uint8_t telemetry_tx_buffer[UDP_TELEMETRY_MAX_DATAGRAM_LEN];
+static uint32_t telemetry_tx_len;
+static uint32_t telemetry_base_ms;
+static uint16_t telemetry_sequence;
+
+/* Counters, and their values at the previous report. */
+static udp_telemetry_stats_t telemetry_stats;
+static udp_telemetry_stats_t telemetry_reported;
+static uint32_t telemetry_reported_ms;
+
+/*******************************************************************************
+ * Function Name: udp_telemetry_start
+ *******************************************************************************
+ * Summary:
+ *  Creates the telemetry socket, the sample queue and the telemetry task.
+ *  Called once, after the Secure Sockets library is initialized.
+ *
+ * Parameters:
+ *  const cy_socket_sockaddr_t *server_addr: Address of the UDP server host;
+ *  the telemetry is sent to UDP_TELEMETRY_PORT on it.
+ *
+ * Return:
+ *  cy_rslt_t: CY_RSLT_SUCCESS on success, an error code otherwise
+ *
+ *******************************************************************************/
+cy_rslt_t udp_telemetry_start(const cy_socket_sockaddr_t *server_addr)
+{
+    cy_rslt_t result;
+
+    telemetry_server_addr = *server_addr;
+    telemetry_server_addr.port = UDP_TELEMETRY_PORT;
+
+    result = cy_socket_create(CY_SOCKET_DOMAIN_AF_INET, CY_SOCKET_TYPE_DGRAM, CY_SOCKET_IPPROTO_UDP,
+                              &telemetry_handle);
+    if(result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+
+    telemetry_queue = xQueueCreate(UDP_TELEMETRY_QUEUE_LEN, sizeof(udp_telemetry_sample_t));
+    if(telemetry_queue == NULL)
+    {
+        cy_socket_delete(telemetry_handle);
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    if(xTaskCreate(udp_telemetry_task, "Telemetry task", UDP_TELEMETRY_TASK_STACK_SIZE, NULL,
+                   UDP_TELEMETRY_TASK_PRIORITY, NULL) != pdPASS)
+    {
+        vQueueDelete(telemetry_queue);
+        telemetry_queue = NULL;
+        cy_socket_delete(telemetry_handle);
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    printf("Telemetry: sending to port %d in datagrams of up to %u bytes, flushed every %u ms\n",
+           UDP_TELEMETRY_PORT, UDP_TELEMETRY_MAX_DATAGRAM_LEN, UDP_TELEMETRY_FLUSH_INTERVAL_MS);
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: udp_telemetry_record
+ *******************************************************************************
+ * Summary:
+ *  Queues a sample for the telemetry task. Never blocks; the sample is counted
+ *  as dropped when the queue is full.
+ *
+ * Parameters:
+ *  uint8_t channel: Telemetry channel of the sample
+ *  int32_t value: Value of the sample
+ *
+ * Return:
+ *  bool: true if the sample was queued
+ *
+ *******************************************************************************/
+bool udp_telemetry_record(uint8_t channel, int32_t value)
+{
+    udp_telemetry_sample_t sample = {
+        .time_ms = UDP_TELEMETRY_NOW_MS(),
+        .value = value,
+        .channel = channel
+    };
+
+    if((telemetry_queue == NULL) || (xQueueSend(telemetry_queue, &sample, 0) != pdPASS))
+    {
+        telemetry_stats.dropped++;
+        return false;
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: udp_telemetry_task
+ *******************************************************************************
+ * Summary:
+ *  Collects the queued samples and samples the signal strength into the
+ *  current batch, sends the batch when its flush deadline is reached and
+ *  prints the statistics periodically.
+ *
+ * Parameters:
+ *  void *arg: Task parameter defined during task creation (unused)
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void udp_telemetry_task(void *arg)
+{
+    udp_telemetry_sample_t sample;
+    uint32_t now_ms = UDP_TELEMETRY_NOW_MS();
+    uint32_t next_sample_ms = now_ms;
+    uint32_t next_report_ms = now_ms + UDP_TELEMETRY_REPORT_INTERVAL_MS;
+    uint32_t deadline_ms;
+    uint32_t wait_ms;
+
+    telemetry_reported_ms = now_ms;
+
+    while(true)
+    {
+        /* Sleep until a sample is queued or the next timed event is due. */
+        deadline_ms = next_sample_ms;
+        if((telemetry_tx_len > 0u) &&
+           ((int32_t)(telemetry_base_ms + UDP_TELEMETRY_FLUSH_INTERVAL_MS - deadline_ms) < 0))
+        {
+            deadline_ms = telemetry_base_ms + UDP_TELEMETRY_FLUSH_INTERVAL_MS;
+        }
+        if((int32_t)(next_report_ms - deadline_ms) < 0)
+        {
+            deadline_ms = next_report_ms;
+        }
+
+        now_ms = UDP_TELEMETRY_NOW_MS();
+        wait_ms = UDP_TELEMETRY_REACHED(now_ms, deadline_ms) ? 0u : (deadline_ms - now_ms);
+
+        if(xQueueReceive(telemetry_queue, &sample, pdMS_TO_TICKS(wait_ms)) == pdPASS)
+        {
+            udp_telemetry_append(&sample);
+        }
+
+        now_ms = UDP_TELEMETRY_NOW_MS();
+
+        if(UDP_TELEMETRY_REACHED(now_ms, next_sample_ms))
+        {
+            udp_telemetry_sample_rssi(now_ms);
+            next_sample_ms += UDP_TELEMETRY_SAMPLE_INTERVAL_MS;
+            if(UDP_TELEMETRY_REACHED(now_ms, next_sample_ms))
+            {
+                /* Do not catch up on samples missed while the task was
+                 * starved.
+                 */
+                next_sample_ms = now_ms + UDP_TELEMETRY_SAMPLE_INTERVAL_MS;
+            }
+        }
+
+        if((telemetry_tx_len > 0u) &&
+           UDP_TELEMETRY_REACHED(now_ms, telemetry_base_ms + UDP_TELEMETRY_FLUSH_INTERVAL_MS))
+        {
+            telemetry_stats.flushed_deadline++;
+            udp_telemetry_flush();
+        }
+
+        if(UDP_TELEMETRY_REACHED(now_ms, next_report_ms))
+        {
+            udp_telemetry_report(now_ms);
+            next_report_ms = now_ms + UDP_TELEMETRY_REPORT_INTERVAL_MS;
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: udp_telemetry_append
+ *******************************************************************************
+ * Summary:
+ *  Adds a sample to the current batch. The batch is sent first if the sample
+ *  does not fit in it anymore, or if the sample time cannot be expressed as
+ *  an offset from the batch base time.
+ *
+ * Parameters:
+ *  const udp_telemetry_sample_t *sample: Sample to add
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void udp_telemetry_append(const udp_telemetry_sample_t *sample)
+{
+    int32_t offset_ms;
+    uint8_t *entry;
+
+    if(telemetry_tx_len > 0u)
+    {
+        offset_ms = (int32_t)(sample->time_ms - telemetry_base_ms);
+
+        if((telemetry_tx_len + UDP_TELEMETRY_SAMPLE_LEN) > UDP_TELEMETRY_MAX_DATAGRAM_LEN)
+        {
+            telemetry_stats.flushed_full++;
+            udp_telemetry_flush();
+        }
+        else if(offset_ms > (int32_t)UINT16_MAX)
+        {
+            telemetry_stats.flushed_deadline++;
+            udp_telemetry_flush();
+        }
+    }
+
+    if(telemetry_tx_len == 0u)
+    {
+        /* Start a new batch. The header is completed when it is sent. */
+        telemetry_base_ms = sample->time_ms;
+        telemetry_tx_len = UDP_TELEMETRY_HEADER_LEN;
+    }
+
+    /* A sample queued just before the batch was started is stamped with the
+     * batch base time.
+     */
+    offset_ms = (int32_t)(sample->time_ms - telemetry_base_ms);
+    if(offset_ms < 0)
+    {
+        offset_ms = 0;
+    }
+
+    entry = &telemetry_tx_buffer[telemetry_tx_len];
+    udp_telemetry_put_u16(&entry[0], (uint16_t)offset_ms);
+    entry[2] = sample->channel;
+    udp_telemetry_put_u32(&entry[3], (uint32_t)sample->value);
+
+    telemetry_tx_len += UDP_TELEMETRY_SAMPLE_LEN;
+    telemetry_stats.samples++;
+}
+
+/*******************************************************************************
+ * Function Name: udp_telemetry_flush
+ *******************************************************************************
+ * Summary:
+ *  Completes the header of the current batch, sends it and empties the buffer.
+ *  Send errors are only counted; the batch is not retried.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void udp_telemetry_flush(void)
+{
+    uint32_t bytes_sent = 0;
+
+    telemetry_tx_buffer[0] = UDP_TELEMETRY_MAGIC;
+    telemetry_tx_buffer[1] = UDP_TELEMETRY_VERSION;
+    udp_telemetry_put_u16(&telemetry_tx_buffer[2], telemetry_sequence);
+    udp_telemetry_put_u32(&telemetry_tx_buffer[4], telemetry_base_ms);
+
+    if(cy_socket_sendto(telemetry_handle, telemetry_tx_buffer, telemetry_tx_len, CY_SOCKET_FLAGS_NONE,
+                        &telemetry_server_addr, sizeof(cy_socket_sockaddr_t), &bytes_sent) == CY_RSLT_SUCCESS)
+    {
+        telemetry_stats.bytes_sent += bytes_sent;
+    }
+    else
+    {
+        telemetry_stats.send_errors++;
+    }
+
+    telemetry_sequence++;
+    telemetry_tx_len = 0;
+}
+
+/*******************************************************************************
+ * Function Name: udp_telemetry_sample_rssi
+ *******************************************************************************
+ * Summary:
+ *  Adds the signal strength of the associated AP to the current batch.
+ *
+ * Parameters:
+ *  uint32_t now_ms: Current time in milliseconds
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void udp_telemetry_sample_rssi(uint32_t now_ms)
+{
+    cy_wcm_associated_ap_info_t ap_info;
+    udp_telemetry_sample_t sample;
+
+    if(cy_wcm_get_associated_ap_info(&ap_info) != CY_RSLT_SUCCESS)
+    {
+        return;
+    }
+
+    sample.time_ms = now_ms;
+    sample.value = ap_info.signal_strength;
+    sample.channel = UDP_TELEMETRY_CHANNEL_RSSI;
+    udp_telemetry_append(&sample);
+}
+
+/*******************************************************************************
+ * Function Name: udp_telemetry_report
+ *******************************************************************************
+ * Summary:
+ *  Prints the datagram rate and the bytes sent per sample since the previous
+ *  report. Bytes per sample include the IPv4 and UDP headers, i.e. what one
+ *  sample costs on air compared to sending it in its own datagram.
+ *
+ * Parameters:
+ *  uint32_t now_ms: Current time in milliseconds
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void udp_telemetry_report(uint32_t now_ms)
+{
+    uint32_t elapsed_ms = now_ms - telemetry_reported_ms;
+    uint32_t samples = telemetry_stats.samples - telemetry_reported.samples;
+    uint32_t full = telemetry_stats.flushed_full - telemetry_reported.flushed_full;
+    uint32_t deadline = telemetry_stats.flushed_deadline - telemetry_reported.flushed_deadline;
+    uint32_t datagrams = full + deadline;
+    uint32_t wire_bytes = (telemetry_stats.bytes_sent - telemetry_reported.bytes_sent) +
+                          (datagrams * UDP_TELEMETRY_IP_UDP_HEADER_LEN);
+    uint32_t datagrams_x100 = (elapsed_ms > 0u) ? (uint32_t)(((uint64_t)datagrams * 100000u) / elapsed_ms) : 0u;
+    uint32_t bytes_x100 = (samples > 0u) ? (uint32_t)(((uint64_t)wire_bytes * 100u) / samples) : 0u;
+
+    printf("Telemetry: %"PRIu32" samples in %"PRIu32" datagrams (%"PRIu32" full, %"PRIu32" deadline), "
+           "%"PRIu32".%02"PRIu32" datagrams/s, %"PRIu32".%02"PRIu32" bytes/sample, "
+           "%"PRIu32" dropped, %"PRIu32" send errors\n",
+           samples, datagrams, full, deadline,
+           datagrams_x100 / 100u, datagrams_x100 % 100u, bytes_x100 / 100u, bytes_x100 % 100u,
+           telemetry_stats.dropped - telemetry_reported.dropped,
+           telemetry_stats.send_errors - telemetry_reported.send_errors);
+
+    telemetry_reported = telemetry_stats;
+    telemetry_reported_ms = now_ms;
+}
+
+/*******************************************************************************
+ * Function Name: udp_telemetry_put_u16
+ *******************************************************************************
+ * Summary:
+ *  Stores a 16-bit value in network byte order.
+ *
+ * Parameters:
+ *  uint8_t *buffer: Destination
+ *  uint16_t value: Value to store
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void udp_telemetry_put_u16(uint8_t *buffer, uint16_t value)
+{
+    buffer[0] = (uint8_t)(value >> 8);
+    buffer[1] = (uint8_t)value;
+}
+
+/*******************************************************************************
+ * Function Name: udp_telemetry_put_u32
+ *******************************************************************************
+ * Summary:
+ *  Stores a 32-bit value in network byte order.
+ *
+ * Parameters:
+ *  uint8_t *buffer: Destination
+ *  uint32_t value: Value to store
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void udp_telemetry_put_u32(uint8_t *buffer, uint32_t value)
+{
+    buffer[0] = (uint8_t)(value >> 24);
+    buffer[1] = (uint8_t)(value >> 16);
+    buffer[2] = (uint8_t)(value >> 8);
+    buffer[3] = (uint8_t)value;
+}
+
+#endif /* USE_UDP_TELEMETRY */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,129 @@
+/******************************************************************************
+* File Name:   udp_telemetry.h
+*
+* Description: This file contains declarations of the batched UDP telemetry
+*              channel of the UDP client.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef UDP_TELEMETRY_H_
+#define UDP_TELEMETRY_H_
+
+/* Standard C header files */
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Cypress secure socket header file. */
+#include "cy_secure_sockets.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* To send telemetry samples to the UDP server, set this macro as '1', for
+ * example by adding USE_UDP_TELEMETRY=1 to DEFINES in the Makefile. The
+ * computer must run udp_telemetry.py.
+ */
+#ifndef USE_UDP_TELEMETRY
+#define USE_UDP_TELEMETRY                         (0)
+#endif
+
+/* Port of the telemetry receiver on the UDP server host. */
+#define UDP_TELEMETRY_PORT                        (57347)
+
+/* Samples are coalesced into datagrams of at most this size, the UDP payload
+ * of a 1500-byte Ethernet MTU without IP options. Smaller values trade airtime
+ * for latency.
+ */
+#ifndef UDP_TELEMETRY_MAX_DATAGRAM_LEN
+#define UDP_TELEMETRY_MAX_DATAGRAM_LEN            (1472u)
+#endif
+
+/* A partly filled datagram is sent at the latest this long after its first
+ * sample was added. Must be below 65536, the range of the sample time offset.
+ */
+#ifndef UDP_TELEMETRY_FLUSH_INTERVAL_MS
+#define UDP_TELEMETRY_FLUSH_INTERVAL_MS           (1000u)
+#endif
+
+/* Interval at which the telemetry task samples the Wi-Fi signal strength. */
+#ifndef UDP_TELEMETRY_SAMPLE_INTERVAL_MS
+#define UDP_TELEMETRY_SAMPLE_INTERVAL_MS          (100u)
+#endif
+
+/* Interval at which the telemetry statistics are printed. */
+#define UDP_TELEMETRY_REPORT_INTERVAL_MS          (10000u)
+
+/* Number of samples other tasks can queue for the telemetry task. */
+#define UDP_TELEMETRY_QUEUE_LEN                   (32u)
+
+/* Datagram layout (multi-byte fields in network byte order):
+ *
+ *  +-------+---------+----------+-----------+------------------+
+ *  | magic | version | sequence | base time | samples          |
+ *  | 1     | 1       | 2        | 4         | n * 7            |
+ *  +-------+---------+----------+-----------+------------------+
+ *
+ * Sample layout: time offset from the base time in milliseconds (2),
+ * channel (1), value (4, signed).
+ */
+#define UDP_TELEMETRY_MAGIC                       (0xA7u)
+#define UDP_TELEMETRY_VERSION                     (0x01u)
+#define UDP_TELEMETRY_HEADER_LEN                  (8u)
+#define UDP_TELEMETRY_SAMPLE_LEN                  (7u)
+
+/* Telemetry channels. */
+#define UDP_TELEMETRY_CHANNEL_RSSI                (0x01u)
+#define UDP_TELEMETRY_CHANNEL_LED                 (0x02u)
+
+#if (UDP_TELEMETRY_FLUSH_INTERVAL_MS > 65535u)
+#error "UDP_TELEMETRY_FLUSH_INTERVAL_MS must be below 65536"
+#endif
+
+#if (UDP_TELEMETRY_MAX_DATAGRAM_LEN < (UDP_TELEMETRY_HEADER_LEN + UDP_TELEMETRY_SAMPLE_LEN))
+#error "UDP_TELEMETRY_MAX_DATAGRAM_LEN must hold at least one sample"
+#endif
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t udp_telemetry_start(const cy_socket_sockaddr_t *server_addr);
+bool udp_telemetry_record(uint8_t channel, int32_t value);
+
+#endif /* UDP_TELEMETRY_H_ */
+
+
+/* [] END OF FILE */
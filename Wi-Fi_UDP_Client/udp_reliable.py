@@ -0,0 +1,321 @@
+#******************************************************************************
+# File Name:   udp_reliable.py
+#
+# Description: Host implementation of the reliability layer used by the UDP
+#              LED protocol in reliable mode (see source/udp_reliable.h). Run
+#              the file directly to pass a command stream through both ends
+#              over loopback with injected loss, duplication and reordering.
+#
+#******************************************************************************
+# Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+# an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+#
+# This software, including source code, documentation and related
+# materials ("Software") is owned by Cypress Semiconductor Corporation
+# or one of its affiliates ("Cypress") and is protected by and subject to
+# worldwide patent protection (United States and foreign),
+# United States copyright laws and international treaty provisions.
+# Therefore, you may use this Software only as provided in the license
+# agreement accompanying the software package from which you
+# obtained this Software ("EULA").
+# If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+# non-transferable license to copy, modify, and compile the Software
+# source code solely for use in connection with Cypress's
+# integrated circuit products.  Any reproduction, modification, translation,
+# compilation, or representation of this Software except as specified
+# above is prohibited without the express written permission of Cypress.
+#
+# Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+# EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+# reserves the right to make changes to the Software without notice. Cypress
+# does not assume any liability arising out of the application or use of the
+# Software or any product or circuit described in the Software. Cypress does
+# not authorize its products for use in any products where a malfunction or
+# failure of the Cypress product may reasonably be expected to result in
+# significant property damage, injury or death ("High Risk Product"). By
+# including Cypress's product in a High Risk Product, the manufacturer
+# of such system or application assumes all risk of such use and in doing
+# so agrees to indemnify Cypress against all liability.
+#******************************************************************************
+
+#!/usr/bin/env python
+import heapq
+import optparse
+import random
+import select
+import socket
+import struct
+import time
+
+# Packet layout: magic (1), type (1), session (2), sequence (2), base (2),
+# length (1), payload.
+MAGIC           = 0xA6
+HEADER          = struct.Struct('>BBHHHB')
+HEADER_LEN      = HEADER.size
+MAX_PAYLOAD     = 20
+
+TYPE_DATA       = 0x01
+TYPE_ACK        = 0x02
+
+WINDOW_SIZE     = 8
+
+RTO_INITIAL     = 0.250
+RTO_MIN         = 0.020
+RTO_MAX         = 4.000
+MAX_RETRIES     = 8
+
+def encode(packet_type, session, sequence, base, payload=b''):
+    if len(payload) > MAX_PAYLOAD:
+        raise ValueError("payload too long")
+    return HEADER.pack(MAGIC, packet_type, session & 0xFFFF, sequence & 0xFFFF, base & 0xFFFF, len(payload)) + payload
+
+def decode(data):
+    """Returns (type, session, sequence, base, payload), or None if the
+    datagram is not a packet of the reliability layer."""
+    if len(data) < HEADER_LEN:
+        return None
+    magic, packet_type, session, sequence, base, length = HEADER.unpack_from(data)
+    if magic != MAGIC or length > MAX_PAYLOAD or HEADER_LEN + length > len(data):
+        return None
+    return packet_type, session, sequence, base, bytes(data[HEADER_LEN:HEADER_LEN + length])
+
+def _distance(a, b):
+    """Signed distance from sequence number b to a."""
+    return ((a - b + 0x8000) & 0xFFFF) - 0x8000
+
+class Sender:
+    """Sending end: sliding window, cumulative acknowledgements and adaptive
+    retransmission timeout (RFC 6298, Karn's algorithm)."""
+
+    def __init__(self, session=None, window=WINDOW_SIZE):
+        self.session = random.getrandbits(16) if session is None else session
+        self.window = window
+        self.slots = {}             # sequence -> [payload, sent, retries]
+        self.base = 0
+        self.next = 0
+        self.srtt = None
+        self.rttvar = 0.0
+        self.rto = RTO_INITIAL
+        self.stats = dict(sent=0, acked=0, retransmits=0, duplicate_acks=0, window_full=0, expired=0)
+
+    def in_flight(self):
+        return (self.next - self.base) & 0xFFFF
+
+    def send(self, payload, now):
+        """Returns the DATA packet to send, or None if the window is full."""
+        if self.in_flight() >= self.window:
+            self.stats['window_full'] += 1
+            return None
+        packet = encode(TYPE_DATA, self.session, self.next, self.base, payload)
+        self.slots[self.next] = [payload, now, 0]
+        self.next = (self.next + 1) & 0xFFFF
+        self.stats['sent'] += 1
+        return packet
+
+    def _reset_rto(self):
+        self.rto = min(max(self.srtt + 4 * self.rttvar, RTO_MIN), RTO_MAX)
+
+    def _sample(self, rtt):
+        if self.srtt is None:
+            self.srtt, self.rttvar = rtt, rtt / 2
+        else:
+            self.rttvar += (abs(rtt - self.srtt) - self.rttvar) / 4
+            self.srtt += (rtt - self.srtt) / 8
+        self._reset_rto()
+
+    def on_ack(self, packet, now):
+        """Takes a decoded ACK packet; returns the number of packets acked."""
+        packet_type, session, cumulative, echo, _ = packet
+        if packet_type != TYPE_ACK or session != self.session:
+            return 0
+        sampled = False
+        slot = self.slots.get(echo)
+        if slot is not None and slot[2] == 0:
+            self._sample(now - slot[1])
+            sampled = True
+        advance = (cumulative - self.base) & 0xFFFF
+        if advance == 0 or advance > self.in_flight():
+            if self.in_flight():
+                self.stats['duplicate_acks'] += 1
+            return 0
+        acked = 0
+        while self.base != cumulative:
+            if self.slots.pop(self.base, None) is not None:
+                acked += 1
+            self.base = (self.base + 1) & 0xFFFF
+        if not sampled and self.srtt is not None:
+            self._reset_rto()
+        self.stats['acked'] += acked
+        return acked
+
+    def poll(self, now):
+        """Returns the list of packets to retransmit."""
+        for sequence, slot in list(self.slots.items()):
+            if slot[2] >= MAX_RETRIES and now - slot[1] >= self.rto:
+                del self.slots[sequence]
+                self.stats['expired'] += 1
+        while self.base != self.next and self.base not in self.slots:
+            self.base = (self.base + 1) & 0xFFFF
+        packets = []
+        sequence = self.base
+        while sequence != self.next:
+            slot = self.slots.get(sequence)
+            if slot is not None and now - slot[1] >= self.rto:
+                if sequence == self.base:
+                    self.rto = min(self.rto * 2, RTO_MAX)
+                slot[1] = now
+                slot[2] += 1
+                self.stats['retransmits'] += 1
+                packets.append(encode(TYPE_DATA, self.session, sequence, self.base, slot[0]))
+            sequence = (sequence + 1) & 0xFFFF
+        return packets
+
+    def next_timeout(self, now):
+        """Seconds until poll() has work, or None if nothing is in flight."""
+        if not self.slots:
+            return None
+        return max(0.0, min(slot[1] for slot in self.slots.values()) + self.rto - now)
+
+class Receiver:
+    """Receiving end: delivers payloads in order, buffers out-of-order packets
+    within the window and acknowledges cumulatively."""
+
+    def __init__(self, window=WINDOW_SIZE):
+        self.window = window
+        self.session = None
+        self.expected = 0
+        self.last = 0
+        self.buffered = {}
+        self.stats = dict(delivered=0, duplicates=0, out_of_order=0, lost=0, resyncs=0)
+
+    def on_data(self, packet):
+        """Takes a decoded DATA packet; returns the list of payloads delivered."""
+        packet_type, session, sequence, base, payload = packet
+        if packet_type != TYPE_DATA:
+            return []
+        self.last = sequence
+        if session != self.session:
+            if self.session is not None:
+                self.stats['resyncs'] += 1
+            self.session, self.expected, self.buffered = session, base, {}
+        # Skip the packets the sender gave up on, still delivering the ones
+        # that were buffered.
+        delivered = []
+        skipped = _distance(base, self.expected)
+        while skipped > 0:
+            if not self.buffered:
+                self.stats['lost'] += skipped
+                self.expected = base
+                break
+            if self.expected in self.buffered:
+                delivered.append(self.buffered.pop(self.expected))
+            else:
+                self.stats['lost'] += 1
+            self.expected = (self.expected + 1) & 0xFFFF
+            skipped -= 1
+        # Packets buffered right after the skipped ones are now in sequence.
+        while self.expected in self.buffered:
+            delivered.append(self.buffered.pop(self.expected))
+            self.expected = (self.expected + 1) & 0xFFFF
+        distance = _distance(sequence, self.expected)
+        if distance < 0 or sequence in self.buffered:
+            self.stats['duplicates'] += 1
+        elif distance >= self.window:
+            pass
+        elif distance > 0:
+            self.buffered[sequence] = payload
+            self.stats['out_of_order'] += 1
+        else:
+            delivered.append(payload)
+            self.expected = (self.expected + 1) & 0xFFFF
+            while self.expected in self.buffered:
+                delivered.append(self.buffered.pop(self.expected))
+                self.expected = (self.expected + 1) & 0xFFFF
+        self.stats['delivered'] += len(delivered)
+        return delivered
+
+    def ack(self, payload=b''):
+        return encode(TYPE_ACK, self.session or 0, self.expected, self.last, payload)
+
+class LossyLink:
+    """Sends datagrams after a random delay, dropping and duplicating some."""
+
+    def __init__(self, loss, duplicate, delay):
+        self.loss, self.duplicate, self.delay = loss, duplicate, delay
+        self.queue = []
+        self.count = 0
+
+    def sendto(self, sock, data, addr):
+        if random.random() < self.loss:
+            return
+        copies = 2 if random.random() < self.duplicate else 1
+        for _ in range(copies):
+            self.count += 1
+            heapq.heappush(self.queue, (time.monotonic() + random.uniform(0, self.delay), self.count, sock, data, addr))
+
+    def flush(self):
+        now = time.monotonic()
+        while self.queue and self.queue[0][0] <= now:
+            _, _, sock, data, addr = heapq.heappop(self.queue)
+            sock.sendto(data, addr)
+
+    def next_timeout(self):
+        return max(0.0, self.queue[0][0] - time.monotonic()) if self.queue else None
+
+def loopback(count, loss, duplicate, delay):
+    """Sends 'count' commands from a Sender to a Receiver over two loopback
+    sockets through a lossy link in both directions and checks that every
+    command is delivered once and in order."""
+    tx = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    rx = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    tx.bind(('127.0.0.1', 0))
+    rx.bind(('127.0.0.1', 0))
+    link = LossyLink(loss, duplicate, delay)
+    sender, receiver = Sender(), Receiver()
+    delivered = []
+    queued = 0
+    start = time.monotonic()
+
+    while queued < count or sender.in_flight() or link.queue:
+        while queued < count:
+            packet = sender.send(struct.pack('>H', queued), time.monotonic())
+            if packet is None:
+                sender.stats['window_full'] -= 1
+                break
+            link.sendto(tx, packet, rx.getsockname())
+            queued += 1
+        for packet in sender.poll(time.monotonic()):
+            link.sendto(tx, packet, rx.getsockname())
+        link.flush()
+
+        timeouts = [t for t in (sender.next_timeout(time.monotonic()), link.next_timeout()) if t is not None]
+        readable, _, _ = select.select([tx, rx], [], [], min(timeouts) if timeouts else 1.0)
+        for sock in readable:
+            packet = decode(sock.recv(64))
+            if packet is None:
+                continue
+            if sock is rx:
+                delivered += [struct.unpack('>H', p)[0] for p in receiver.on_data(packet)]
+                link.sendto(rx, receiver.ack(), tx.getsockname())
+            else:
+                sender.on_ack(packet, time.monotonic())
+
+    elapsed = time.monotonic() - start
+    print("Sender:   %s, SRTT %.1f ms, RTO %.1f ms" % (sender.stats, (sender.srtt or 0) * 1000, sender.rto * 1000))
+    print("Receiver: %s" % receiver.stats)
+    print("Delivered %d/%d commands in %.2f s" % (len(delivered), count, elapsed))
+    if delivered != sorted(set(delivered)) or len(delivered) + sender.stats['expired'] < count:
+        raise SystemExit("FAILED: commands lost, duplicated or reordered")
+    print("PASSED")
+
+if __name__ == '__main__':
+    parser = optparse.OptionParser()
+    parser.add_option("-n", "--count", dest="count", type="int", default=2000, help="Number of commands to send [default: %default].")
+    parser.add_option("--loss", dest="loss", type="float", default=0.2, help="Probability of dropping a datagram [default: %default].")
+    parser.add_option("--duplicate", dest="duplicate", type="float", default=0.05, help="Probability of duplicating a datagram [default: %default].")
+    parser.add_option("--delay", dest="delay", type="float", default=0.02, help="Maximum random delay in seconds, which reorders datagrams [default: %default].")
+    (options, args) = parser.parse_args()
+    loopback(options.count, options.loss, options.duplicate, options.delay)
+
+# [] END OF FILE
@@ -44,6 +44,9 @@ import socket
 import optparse
 import time
 import sys
+import random
+
+import udp_reliable
 
 DEFAULT_IP   = socket.gethostbyname(socket.gethostname())   # IP address of the UDP server
 DEFAULT_PORT = 57345             # Port of the UDP server
@@ -51,17 +54,45 @@ DEFAULT_PORT = 57345             # Port of the UDP server
 LED_ON = '1'
 LED_OFF = '0'
 
-def enter_command(sock, addr):
+def enter_command(sock, addr, sender=None, drop=0.0):
     print("============================================================")
     cmd = int(input('Enter 0 to turn off or 1 to turn on the LED on Client\nInput Command: '))
     if cmd == 1:
-        sock.sendto(bytes(LED_ON, "utf-8"), addr)
+        message = bytes(LED_ON, "utf-8")
     elif cmd == 0:
-        sock.sendto(bytes(LED_OFF, "utf-8"), addr)
+        message = bytes(LED_OFF, "utf-8")
+    else:
+        message = bytes(str(cmd), "utf-8")
+    if sender is None:
+        sock.sendto(message, addr)
     else:
-        sock.sendto(bytes(str(cmd), "utf-8"), addr)
+        reliable_send(sock, addr, sender, message, drop)
 
-def echo_server(host, port):
+def reliable_send(sock, addr, sender, message, drop):
+    # Send the command over the reliability layer and retransmit it until the
+    # client acknowledges it.
+    packets = [sender.send(message, time.monotonic())]
+    while sender.in_flight():
+        for packet in packets:
+            if random.random() < drop:
+                print("Dropped packet (simulated loss)")
+            else:
+                sock.sendto(packet, addr)
+        timeout = sender.next_timeout(time.monotonic())
+        sock.settimeout(max(timeout or 0, 0.001))
+        try:
+            data, _ = sock.recvfrom(4096)
+        except socket.timeout:
+            packets = sender.poll(time.monotonic())
+            continue
+        packets = []
+        ack = udp_reliable.decode(data)
+        if ack is not None and sender.on_ack(ack, time.monotonic()) > 0:
+            print("{} received".format(ack[4].decode('utf-8')))
+    sock.settimeout(None)
+    print("Sender: {}, SRTT {:.1f} ms, RTO {:.1f} ms".format(sender.stats, (sender.srtt or 0) * 1000, sender.rto * 1000))
+
+def echo_server(host, port, reliable, drop):
     print("============================================================")
     print("UDP Server")
     print("============================================================")
@@ -72,10 +103,23 @@ def echo_server(host, port):
     print('UDP Server on IP Address: {} port {}'.format(host, port))
     print('waiting to receive message from UDP Client')
     
+    while reliable:
+        data, addr = sock.recvfrom(4096)
+        if data == bytes('A', "utf-8"):
+            print('Ready to send command to client')
+            sender = udp_reliable.Sender()
+            while True:
+                enter_command(sock, addr, sender, drop)
+
+    client = None
     while True:
         data, addr = sock.recvfrom(4096)
+        if data == bytes('A', "utf-8") and addr == client:
+            # The client repeats the registration while it receives no command.
+            continue
         if data == bytes('A', "utf-8"):
             print('Ready to send command to client')
+            client = addr
             enter_command(sock, addr)
         elif data == bytes('LED ON ACK', "utf-8"):
             print("LED ON Acknowledgement received")
@@ -92,7 +136,9 @@ if __name__ == '__main__':
     parser = optparse.OptionParser()
     parser.add_option("-p", "--port", dest="port", type="int", default=DEFAULT_PORT, help="Port to listen on [default: %default].")
     parser.add_option("--hostname", dest="hostname", default=DEFAULT_IP, help="Hostname to listen on.")
+    parser.add_option("-r", "--reliable", dest="reliable", action="store_true", default=False, help="Use the reliability layer (client built with USE_RELIABLE_UDP).")
+    parser.add_option("--drop", dest="drop", type="float", default=0.0, help="Probability of dropping a command in reliable mode, to exercise retransmission [default: %default].")
 
     (options, args) = parser.parse_args()
 
-    echo_server(options.hostname, options.port)
+    echo_server(options.hostname, options.port, options.reliable, options.drop)
@@ -0,0 +1,121 @@
+#******************************************************************************
+# File Name:   udp_telemetry.py
+#
+# Description: Receiver for the batched telemetry of the UDP client. It decodes
+# the datagrams sent by udp_telemetry.c and prints the datagram rate, the bytes
+# per sample and the latest value of every channel.
+#
+#
+#******************************************************************************
+# Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+# an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+#
+# This software, including source code, documentation and related
+# materials ("Software") is owned by Cypress Semiconductor Corporation
+# or one of its affiliates ("Cypress") and is protected by and subject to
+# worldwide patent protection (United States and foreign),
+# United States copyright laws and international treaty provisions.
+# Therefore, you may use this Software only as provided in the license
+# agreement accompanying the software package from which you
+# obtained this Software ("EULA").
+# If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+# non-transferable license to copy, modify, and compile the Software
+# source code solely for use in connection with Cypress's
+# integrated circuit products.  Any reproduction, modification, translation,
+# compilation, or representation of this Software except as specified
+# above is prohibited without the express written permission of Cypress.
+#
+# Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+# EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+# reserves the right to make changes to the Software without notice. Cypress
+# does not assume any liability arising out of the application or use of the
+# Software or any product or circuit described in the Software. Cypress does
+# not authorize its products for use in any products where a malfunction or
+# failure of the Cypress product may reasonably be expected to result in
+# significant property damage, injury or death ("High Risk Product"). By
+# including Cypress's product in a High Risk Product, the manufacturer
+# of such system or application assumes all risk of such use and in doing
+# so agrees to indemnify Cypress against all liability.
+#******************************************************************************
+
+#!/usr/bin/python
+
+import socket
+import optparse
+import struct
+import time
+
+DEFAULT_IP   = socket.gethostbyname(socket.gethostname())   # IP address of the UDP server host
+DEFAULT_PORT = 57347             # UDP_TELEMETRY_PORT
+
+TELEMETRY_MAGIC = 0xA7
+TELEMETRY_VERSION = 0x01
+HEADER = struct.Struct('!BBHI')  # magic, version, sequence, base time (ms)
+SAMPLE = struct.Struct('!HBi')   # time offset (ms), channel, value
+IP_UDP_HEADER_LEN = 28
+
+CHANNEL_NAMES = {0x01: 'RSSI (dBm)', 0x02: 'LED'}
+
+def decode(datagram):
+    """Returns (sequence, [(time_ms, channel, value), ...]) or None if the datagram is malformed."""
+    if len(datagram) < HEADER.size or (len(datagram) - HEADER.size) % SAMPLE.size != 0:
+        return None
+    magic, version, sequence, base_ms = HEADER.unpack_from(datagram)
+    if magic != TELEMETRY_MAGIC or version != TELEMETRY_VERSION:
+        return None
+    samples = []
+    for offset in range(HEADER.size, len(datagram), SAMPLE.size):
+        offset_ms, channel, value = SAMPLE.unpack_from(datagram, offset)
+        samples.append(((base_ms + offset_ms) & 0xFFFFFFFF, channel, value))
+    return sequence, samples
+
+def telemetry_server(host, port, interval):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind((host, port))
+    sock.settimeout(interval)
+    print("Telemetry receiver listening on %s:%d" % (host, port))
+
+    expected = None
+    latest = {}
+    datagrams = samples = wire_bytes = lost = malformed = 0
+    started = time.time()
+    while True:
+        try:
+            data, addr = sock.recvfrom(2048)
+            batch = decode(data)
+            if batch is None:
+                malformed += 1
+            else:
+                sequence, batch_samples = batch
+                if expected is not None and sequence != expected:
+                    lost += (sequence - expected) & 0xFFFF
+                expected = (sequence + 1) & 0xFFFF
+                datagrams += 1
+                samples += len(batch_samples)
+                wire_bytes += len(data) + IP_UDP_HEADER_LEN
+                for time_ms, channel, value in batch_samples:
+                    latest[channel] = (time_ms, value)
+        except socket.timeout:
+            pass
+
+        elapsed = time.time() - started
+        if elapsed >= interval:
+            print("============================================================")
+            print("%d samples in %d datagrams: %.2f datagrams/s, %.2f samples/s, %.2f bytes/sample"
+                  % (samples, datagrams, datagrams / elapsed, samples / elapsed,
+                     (wire_bytes / samples) if samples else 0.0))
+            print("Lost datagrams: %d, malformed datagrams: %d" % (lost, malformed))
+            for channel in sorted(latest):
+                time_ms, value = latest[channel]
+                print("  %-12s %d (at %d ms)" % (CHANNEL_NAMES.get(channel, 'channel %d' % channel), value, time_ms))
+            datagrams = samples = wire_bytes = lost = malformed = 0
+            started = time.time()
+
+if __name__ == '__main__':
+    parser = optparse.OptionParser()
+    parser.add_option("-p", "--port", dest="port", type="int", default=DEFAULT_PORT, help="Port to listen on [default: %default].")
+    parser.add_option("--hostname", dest="hostname", default=DEFAULT_IP, help="Hostname to listen on.")
+    parser.add_option("-i", "--interval", dest="interval", type="float", default=10.0, help="Report interval in seconds [default: %default].")
+    (options, args) = parser.parse_args()
+    telemetry_server(options.hostname, options.port, options.interval)
@@ -0,0 +1,470 @@
+/******************************************************************************
+* File Name: main.c
+*
+* Description: This is the host test of the reliability layer of the UDP LED
+* protocol (../source/udp_reliable.c). It passes a command stream from a
+* sender to a receiver over a simulated link that drops, duplicates and delays
+* datagrams in both directions, as udp_reliable.py does over loopback, and
+* checks that every command is delivered once and in order.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Standard C header files */
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* Reliability layer header file */
+#include "udp_reliable.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Scenario of the test, as set in the Makefile. The defaults are those of
+ * udp_reliable.py: 2000 commands, 20% loss, 5% duplicates and a random delay
+ * of up to 20 ms, which reorders the datagrams.
+ */
+#ifndef TEST_COUNT
+#define TEST_COUNT                               (2000u)
+#endif
+
+#ifndef TEST_LOSS_PERCENT
+#define TEST_LOSS_PERCENT                        (20u)
+#endif
+
+#ifndef TEST_DUPLICATE_PERCENT
+#define TEST_DUPLICATE_PERCENT                   (5u)
+#endif
+
+#ifndef TEST_DELAY_MS
+#define TEST_DELAY_MS                            (20u)
+#endif
+
+#ifndef TEST_SEED
+#define TEST_SEED                                (0x12345678u)
+#endif
+
+/* Datagrams the simulated link holds at once. */
+#define LINK_QUEUE_LEN                           (256u)
+
+/* Length of a command: its number, in network byte order. */
+#define COMMAND_LEN                              (4u)
+
+/*******************************************************************************
+* Data structure and enumeration
+*******************************************************************************/
+/* Ends of the simulated link. */
+typedef enum
+{
+    END_SENDER,
+    END_RECEIVER
+} link_end_t;
+
+/* Datagram on the simulated link. */
+typedef struct
+{
+    uint32_t deliver_ms;
+    uint32_t order;
+    link_end_t destination;
+    uint32_t length;
+    uint8_t data[UDP_RELIABLE_MAX_PACKET_LEN];
+} datagram_t;
+
+/* Simulated link that drops, duplicates and delays datagrams. */
+typedef struct
+{
+    datagram_t queue[LINK_QUEUE_LEN];
+    uint32_t length;
+    uint32_t order;
+    uint32_t dropped;
+    uint32_t duplicated;
+} link_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static udp_reliable_sender_t sender;
+static udp_reliable_receiver_t receiver;
+static link_t link;
+
+/* Number of the next command expected, and of the commands delivered. */
+static uint32_t next_command;
+static uint32_t num_delivered;
+
+static uint32_t random_state = TEST_SEED;
+static uint32_t failures;
+
+/*******************************************************************************
+ * Function Name: next_random
+ *******************************************************************************
+ * Summary:
+ *  Returns the next number of a xorshift generator, so that every run with
+ *  the same seed performs the same operations.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  uint32_t: Pseudo-random number
+ *
+ *******************************************************************************/
+static uint32_t next_random(void)
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+/*******************************************************************************
+ * Function Name: now_ns
+ *******************************************************************************
+ * Summary:
+ *  Returns a monotonic time stamp.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  double: Time in nanoseconds
+ *
+ *******************************************************************************/
+static double now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((double)ts.tv_sec * 1e9) + (double)ts.tv_nsec;
+}
+
+/*******************************************************************************
+ * Function Name: check
+ *******************************************************************************
+ * Summary:
+ *  Counts and reports a failed check.
+ *
+ * Parameters:
+ *  int condition: Result of the check
+ *  const char *what: Description of the check
+ *  uint32_t n: Command or operation number
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void check(int condition, const char *what, uint32_t n)
+{
+    if (!condition)
+    {
+        if (failures < 10u)
+        {
+            printf("FAILED: %s (%u)\n", what, (unsigned)n);
+        }
+        failures++;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: link_send
+ *******************************************************************************
+ * Summary:
+ *  Puts a datagram on the simulated link. The datagram is dropped with
+ *  TEST_LOSS_PERCENT probability, sent twice with TEST_DUPLICATE_PERCENT
+ *  probability, and every copy arrives after a random delay of up to
+ *  TEST_DELAY_MS.
+ *
+ * Parameters:
+ *  link_end_t destination: End the datagram is sent to
+ *  const uint8_t *data: Datagram
+ *  uint32_t length: Length of the datagram
+ *  uint32_t now_ms: Current time
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void link_send(link_end_t destination, const uint8_t *data, uint32_t length,
+                      uint32_t now_ms)
+{
+    uint32_t copies = 1u;
+    datagram_t *datagram;
+
+    if ((next_random() % 100u) < TEST_LOSS_PERCENT)
+    {
+        link.dropped++;
+        return;
+    }
+
+    if ((next_random() % 100u) < TEST_DUPLICATE_PERCENT)
+    {
+        link.duplicated++;
+        copies = 2u;
+    }
+
+    while (copies-- > 0u)
+    {
+        if (link.length == LINK_QUEUE_LEN)
+        {
+            check(0, "link queue overflow", link.order);
+            return;
+        }
+
+        datagram = &link.queue[link.length++];
+        datagram->deliver_ms = now_ms + (next_random() % (TEST_DELAY_MS + 1u));
+        datagram->order = link.order++;
+        datagram->destination = destination;
+        datagram->length = length;
+        memcpy(datagram->data, data, length);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: link_next
+ *******************************************************************************
+ * Summary:
+ *  Returns the datagram that arrives first; datagrams with the same arrival
+ *  time arrive in the order they were sent.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  uint32_t: Index of the datagram in the link queue, LINK_QUEUE_LEN if the
+ *            link is empty
+ *
+ *******************************************************************************/
+static uint32_t link_next(void)
+{
+    uint32_t next = LINK_QUEUE_LEN;
+    uint32_t i;
+
+    for (i = 0; i < link.length; i++)
+    {
+        if ((next == LINK_QUEUE_LEN) ||
+            (link.queue[i].deliver_ms < link.queue[next].deliver_ms) ||
+            ((link.queue[i].deliver_ms == link.queue[next].deliver_ms) &&
+             (link.queue[i].order < link.queue[next].order)))
+        {
+            next = i;
+        }
+    }
+
+    return next;
+}
+
+/*******************************************************************************
+ * Function Name: deliver_command
+ *******************************************************************************
+ * Summary:
+ *  Deliver function of the receiver. Checks that the commands arrive in order
+ *  and at most once; commands the sender gave up on may be skipped.
+ *
+ * Parameters:
+ *  uint16_t sequence: Sequence number of the payload
+ *  const uint8_t *payload: Command
+ *  uint8_t length: Length of the command
+ *  void *arg: Unused
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void deliver_command(uint16_t sequence, const uint8_t *payload, uint8_t length,
+                            void *arg)
+{
+    uint32_t command;
+
+    (void)arg;
+
+    check(COMMAND_LEN == length, "command length", sequence);
+    command = ((uint32_t)payload[0] << 24) | ((uint32_t)payload[1] << 16) |
+              ((uint32_t)payload[2] << 8) | (uint32_t)payload[3];
+
+    check(command >= next_command, "command delivered twice or out of order", command);
+    check((uint16_t)command == sequence, "sequence number of the command", command);
+
+    next_command = command + 1u;
+    num_delivered++;
+}
+
+/*******************************************************************************
+ * Function Name: receive_datagram
+ *******************************************************************************
+ * Summary:
+ *  Hands a datagram that left the link to its end: the receiver accepts DATA
+ *  packets and answers each with an ACK, the sender accepts the ACKs.
+ *
+ * Parameters:
+ *  const datagram_t *datagram: Datagram
+ *  uint32_t now_ms: Current time
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void receive_datagram(const datagram_t *datagram, uint32_t now_ms)
+{
+    udp_reliable_packet_t packet;
+    uint8_t ack[UDP_RELIABLE_MAX_PACKET_LEN];
+    uint32_t ack_len;
+
+    if (!udp_reliable_decode(datagram->data, datagram->length, &packet))
+    {
+        check(0, "decode a datagram", datagram->order);
+        return;
+    }
+
+    if (END_RECEIVER == datagram->destination)
+    {
+        (void)udp_reliable_receiver_on_data(&receiver, &packet, deliver_command, NULL);
+        ack_len = udp_reliable_receiver_encode_ack(&receiver, NULL, 0, ack, sizeof(ack));
+        link_send(END_SENDER, ack, ack_len, now_ms);
+    }
+    else
+    {
+        (void)udp_reliable_sender_on_ack(&sender, &packet, now_ms);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: main
+ *******************************************************************************
+ * Summary:
+ *  Sends TEST_COUNT commands through the simulated link, with simulated time,
+ *  and checks that every command is delivered once and in order.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  int: Number of failed checks.
+ *
+ *******************************************************************************/
+int main(void)
+{
+    uint8_t packet[UDP_RELIABLE_MAX_PACKET_LEN];
+    uint8_t command[COMMAND_LEN];
+    uint32_t packet_len;
+    uint32_t queued = 0;
+    uint32_t now_ms = 0;
+    uint32_t wait_ms;
+    uint32_t next;
+    double start;
+
+    printf("Reliable UDP: %u commands, %u%% loss, %u%% duplicates, delay up to %u ms, window %u\n",
+           (unsigned)TEST_COUNT, (unsigned)TEST_LOSS_PERCENT, (unsigned)TEST_DUPLICATE_PERCENT,
+           (unsigned)TEST_DELAY_MS, (unsigned)UDP_RELIABLE_WINDOW_SIZE);
+
+    udp_reliable_sender_init(&sender, (uint16_t)next_random());
+    udp_reliable_receiver_init(&receiver);
+
+    start = now_ns();
+    while ((queued < TEST_COUNT) || (udp_reliable_sender_in_flight(&sender) > 0u) || (link.length > 0u))
+    {
+        /* Fill the send window. */
+        while (queued < TEST_COUNT)
+        {
+            command[0] = (uint8_t)(queued >> 24);
+            command[1] = (uint8_t)(queued >> 16);
+            command[2] = (uint8_t)(queued >> 8);
+            command[3] = (uint8_t)queued;
+
+            packet_len = udp_reliable_sender_send(&sender, command, COMMAND_LEN, now_ms,
+                                                  packet, sizeof(packet));
+            if (0u == packet_len)
+            {
+                break;
+            }
+            link_send(END_RECEIVER, packet, packet_len, now_ms);
+            queued++;
+        }
+
+        /* Retransmit the packets whose timeout expired. */
+        while (0u != (packet_len = udp_reliable_sender_poll(&sender, now_ms, packet, sizeof(packet))))
+        {
+            link_send(END_RECEIVER, packet, packet_len, now_ms);
+        }
+
+        /* Deliver the datagrams that arrived. */
+        while ((LINK_QUEUE_LEN != (next = link_next())) && (link.queue[next].deliver_ms <= now_ms))
+        {
+            datagram_t datagram = link.queue[next];
+
+            link.queue[next] = link.queue[--link.length];
+            receive_datagram(&datagram, now_ms);
+        }
+
+        /* Advance the time to the next retransmission or arrival. */
+        wait_ms = udp_reliable_sender_next_timeout(&sender, now_ms);
+        next = link_next();
+        if ((LINK_QUEUE_LEN != next) && ((link.queue[next].deliver_ms - now_ms) < wait_ms))
+        {
+            wait_ms = link.queue[next].deliver_ms - now_ms;
+        }
+        if (UDP_RELIABLE_NO_TIMEOUT != wait_ms)
+        {
+            now_ms += (wait_ms > 0u) ? wait_ms : 1u;
+        }
+    }
+
+    printf("Sender:   sent %u, acked %u, retransmits %u, duplicate acks %u, window full %u, expired %u, "
+           "SRTT %u ms, RTO %u ms\n",
+           (unsigned)sender.stats.sent, (unsigned)sender.stats.acked,
+           (unsigned)sender.stats.retransmits, (unsigned)sender.stats.duplicate_acks,
+           (unsigned)sender.stats.window_full, (unsigned)sender.stats.expired,
+           (unsigned)(sender.srtt_x8 / 8u), (unsigned)sender.rto_ms);
+    printf("Receiver: delivered %u, duplicates %u, out of order %u, lost %u, resyncs %u\n",
+           (unsigned)receiver.stats.delivered, (unsigned)receiver.stats.duplicates,
+           (unsigned)receiver.stats.out_of_order, (unsigned)receiver.stats.lost,
+           (unsigned)receiver.stats.resyncs);
+    printf("Link:     %u datagrams dropped, %u duplicated\n",
+           (unsigned)link.dropped, (unsigned)link.duplicated);
+    printf("Delivered %u/%u commands in %.2f s of link time (%.1f ms on the host)\n",
+           (unsigned)num_delivered, (unsigned)TEST_COUNT, (double)now_ms / 1e3,
+           (now_ns() - start) / 1e6);
+
+    check((num_delivered + sender.stats.expired) >= TEST_COUNT, "commands lost", num_delivered);
+    check(num_delivered == receiver.stats.delivered, "delivered count", num_delivered);
+
+    printf("%s: %u failed checks\n", (0u == failures) ? "PASSED" : "FAILED", (unsigned)failures);
+
+    return (int)failures;
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,200 @@
+/******************************************************************************
+* File Name:   rx_ring.c
+*
+* Description: This file contains the lock-free single-producer single-consumer
+*              ring that hands received messages from a socket callback to a
+*              worker task.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* CMSIS header file, for the data memory barrier. */
+#include "cmsis_compiler.h"
+
+/* Receive ring header file. */
+#include "rx_ring.h"
+
+/*******************************************************************************
+ * Function Name: rx_ring_init
+ *******************************************************************************
+ * Summary:
+ *  Initializes an empty ring over caller-provided slot storage.
+ *
+ * Parameters:
+ *  rx_ring_t *ring: Ring to initialize
+ *  void *slots: Storage of num_slots slots of slot_size bytes each
+ *  uint32_t slot_size: Size of one slot in bytes
+ *  uint32_t num_slots: Number of slots, a power of two
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void rx_ring_init(rx_ring_t *ring, void *slots, uint32_t slot_size, uint32_t num_slots)
+{
+    ring->slots = (uint8_t *)slots;
+    ring->slot_size = slot_size;
+    ring->num_slots = num_slots;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->dropped = 0;
+    ring->peak = 0;
+}
+
+/*******************************************************************************
+ * Function Name: rx_ring_reserve
+ *******************************************************************************
+ * Summary:
+ *  Returns the next free slot for the producer to fill. The slot becomes
+ *  visible to the consumer only after rx_ring_commit(). Counts a drop when the
+ *  ring is full.
+ *
+ * Parameters:
+ *  rx_ring_t *ring: Ring
+ *
+ * Return:
+ *  void *: Free slot, or NULL if the ring is full
+ *
+ *******************************************************************************/
+void *rx_ring_reserve(rx_ring_t *ring)
+{
+    uint32_t head = ring->head;
+
+    if((head - ring->tail) >= ring->num_slots)
+    {
+        ring->dropped++;
+        return NULL;
+    }
+
+    return &ring->slots[(head % ring->num_slots) * ring->slot_size];
+}
+
+/*******************************************************************************
+ * Function Name: rx_ring_commit
+ *******************************************************************************
+ * Summary:
+ *  Publishes the slot returned by the last rx_ring_reserve() to the consumer.
+ *
+ * Parameters:
+ *  rx_ring_t *ring: Ring
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void rx_ring_commit(rx_ring_t *ring)
+{
+    uint32_t count;
+
+    /* The slot contents must be visible before the new head. */
+    __DMB();
+    ring->head = ring->head + 1u;
+
+    count = ring->head - ring->tail;
+    if(count > ring->peak)
+    {
+        ring->peak = count;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: rx_ring_peek
+ *******************************************************************************
+ * Summary:
+ *  Returns the oldest committed slot for the consumer to process.
+ *
+ * Parameters:
+ *  rx_ring_t *ring: Ring
+ *
+ * Return:
+ *  void *: Oldest slot, or NULL if the ring is empty
+ *
+ *******************************************************************************/
+void *rx_ring_peek(rx_ring_t *ring)
+{
+    uint32_t tail = ring->tail;
+
+    if(ring->head == tail)
+    {
+        return NULL;
+    }
+
+    /* Read the slot contents only after the head that published them. */
+    __DMB();
+
+    return &ring->slots[(tail % ring->num_slots) * ring->slot_size];
+}
+
+/*******************************************************************************
+ * Function Name: rx_ring_release
+ *******************************************************************************
+ * Summary:
+ *  Returns the slot returned by the last rx_ring_peek() to the producer.
+ *
+ * Parameters:
+ *  rx_ring_t *ring: Ring
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void rx_ring_release(rx_ring_t *ring)
+{
+    /* The slot must be processed before the producer may overwrite it. */
+    __DMB();
+    ring->tail = ring->tail + 1u;
+}
+
+/*******************************************************************************
+ * Function Name: rx_ring_count
+ *******************************************************************************
+ * Summary:
+ *  Returns the number of committed slots not yet released.
+ *
+ * Parameters:
+ *  const rx_ring_t *ring: Ring
+ *
+ * Return:
+ *  uint32_t: Number of slots in use
+ *
+ *******************************************************************************/
+uint32_t rx_ring_count(const rx_ring_t *ring)
+{
+    return ring->head - ring->tail;
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,85 @@
+/******************************************************************************
+* File Name:   rx_ring.h
+*
+* Description: This file contains declarations of the lock-free single-producer
+*              single-consumer ring that hands received messages from a socket
+*              callback to a worker task.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef RX_RING_H_
+#define RX_RING_H_
+
+/* Standard C header files */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+* Data structure and enumeration
+********************************************************************************/
+/* Ring of fixed-size slots. The socket callback (producer) fills a slot in
+ * place between rx_ring_reserve() and rx_ring_commit(); the worker task
+ * (consumer) processes it in place between rx_ring_peek() and rx_ring_release().
+ * Only the producer writes 'head', 'dropped' and 'peak', and only the consumer
+ * writes 'tail', so no lock is needed as long as there is one of each.
+ */
+typedef struct
+{
+    uint8_t *slots;
+    uint32_t slot_size;
+    uint32_t num_slots;
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    volatile uint32_t dropped;
+    volatile uint32_t peak;
+} rx_ring_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void rx_ring_init(rx_ring_t *ring, void *slots, uint32_t slot_size, uint32_t num_slots);
+void *rx_ring_reserve(rx_ring_t *ring);
+void rx_ring_commit(rx_ring_t *ring);
+void *rx_ring_peek(rx_ring_t *ring);
+void rx_ring_release(rx_ring_t *ring);
+uint32_t rx_ring_count(const rx_ring_t *ring);
+
+#endif /* RX_RING_H_ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,720 @@
+/******************************************************************************
+* File Name:   udp_reliable.c
+*
+* Description: This file contains the packet codec, the sending window with
+*              adaptive retransmission timeout and the reordering receiver of
+*              the reliability layer used by the UDP LED protocol in reliable
+*              mode. The file has no platform dependencies and builds on the
+*              host as well; time is passed in by the caller in milliseconds.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/* Standard C header file */
+#include <string.h>
+
+/* UDP reliability layer header file. */
+#include "udp_reliable.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define UDP_RELIABLE_SLOT(sequence)   ((uint32_t)(sequence) & (UDP_RELIABLE_WINDOW_SIZE - 1u))
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+static void udp_reliable_update_rto(udp_reliable_sender_t *sender, uint32_t rtt_ms);
+static void udp_reliable_reset_rto(udp_reliable_sender_t *sender);
+static uint32_t udp_reliable_receiver_deliver_buffered(udp_reliable_receiver_t *receiver,
+                                                       udp_reliable_deliver_t deliver,
+                                                       void *arg);
+
+/*******************************************************************************
+ * Function Name: udp_reliable_encode
+ *******************************************************************************
+ * Summary:
+ *  Writes one packet (header followed by payload) into the given buffer.
+ *
+ * Parameters:
+ *  uint8_t *buffer: Destination buffer
+ *  uint32_t buffer_len: Size of the destination buffer
+ *  uint8_t type: Packet type
+ *  uint16_t session: Session of the sender
+ *  uint16_t sequence: Sequence number (DATA) or next expected sequence (ACK)
+ *  uint16_t base_sequence: Oldest sequence number in the send window (DATA)
+ *                          or the sequence number acknowledged (ACK)
+ *  const uint8_t *payload: Payload (may be NULL if payload_len is 0)
+ *  uint8_t payload_len: Length of the payload
+ *
+ * Return:
+ *  uint32_t: Number of bytes written, 0 if the packet does not fit
+ *
+ *******************************************************************************/
+uint32_t udp_reliable_encode(uint8_t *buffer, uint32_t buffer_len, uint8_t type,
+                             uint16_t session, uint16_t sequence,
+                             uint16_t base_sequence, const uint8_t *payload,
+                             uint8_t payload_len)
+{
+    uint32_t packet_len = UDP_RELIABLE_HEADER_LEN + payload_len;
+
+    if((payload_len > UDP_RELIABLE_MAX_PAYLOAD_LEN) || (packet_len > buffer_len))
+    {
+        return 0;
+    }
+
+    buffer[0] = UDP_RELIABLE_MAGIC;
+    buffer[1] = type;
+    buffer[2] = (uint8_t)(session >> 8);
+    buffer[3] = (uint8_t)(session);
+    buffer[4] = (uint8_t)(sequence >> 8);
+    buffer[5] = (uint8_t)(sequence);
+    buffer[6] = (uint8_t)(base_sequence >> 8);
+    buffer[7] = (uint8_t)(base_sequence);
+    buffer[8] = payload_len;
+
+    if(payload_len > 0)
+    {
+        memcpy(&buffer[UDP_RELIABLE_HEADER_LEN], payload, payload_len);
+    }
+
+    return packet_len;
+}
+
+/*******************************************************************************
+ * Function Name: udp_reliable_decode
+ *******************************************************************************
+ * Summary:
+ *  Decodes a received datagram. Datagrams of the plain text protocol do not
+ *  start with the magic byte and are rejected, so both protocols can share a
+ *  socket.
+ *
+ * Parameters:
+ *  const uint8_t *buffer: Received datagram
+ *  uint32_t buffer_len: Length of the datagram
+ *  udp_reliable_packet_t *packet: Receives the decoded packet
+ *
+ * Return:
+ *  bool: true if the datagram is a well-formed packet
+ *
+ *******************************************************************************/
+bool udp_reliable_decode(const uint8_t *buffer, uint32_t buffer_len,
+                         udp_reliable_packet_t *packet)
+{
+    if((buffer_len < UDP_RELIABLE_HEADER_LEN) || (buffer[0] != UDP_RELIABLE_MAGIC))
+    {
+        return false;
+    }
+
+    packet->type = buffer[1];
+    packet->session = (uint16_t)(((uint16_t)buffer[2] << 8) | buffer[3]);
+    packet->sequence = (uint16_t)(((uint16_t)buffer[4] << 8) | buffer[5]);
+    packet->base_sequence = (uint16_t)(((uint16_t)buffer[6] << 8) | buffer[7]);
+    packet->length = buffer[8];
+    packet->payload = &buffer[UDP_RELIABLE_HEADER_LEN];
+
+    return (packet->length <= UDP_RELIABLE_MAX_PAYLOAD_LEN) &&
+           ((UDP_RELIABLE_HEADER_LEN + packet->length) <= buffer_len);
+}
+
+/*******************************************************************************
+ * Function Name: udp_reliable_sender_init
+ *******************************************************************************
+ * Summary:
+ *  Empties the send window and restarts the round-trip estimation. The session
+ *  should differ from the one used before the reset, e.g. be random, so that
+ *  the receiver notices the restart.
+ *
+ * Parameters:
+ *  udp_reliable_sender_t *sender: Sender to reset
+ *  uint16_t session: Session of the new run
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void udp_reliable_sender_init(udp_reliable_sender_t *sender, uint16_t session)
+{
+    memset(sender, 0, sizeof(*sender));
+    sender->session = session;
+    sender->rto_ms = UDP_RELIABLE_RTO_INITIAL_MS;
+}
+
+/*******************************************************************************
+ * Function Name: udp_reliable_sender_in_flight
+ *******************************************************************************
+ * Summary:
+ *  Returns the number of sequence numbers sent but not yet acknowledged.
+ *
+ * Parameters:
+ *  const udp_reliable_sender_t *sender: Sender
+ *
+ * Return:
+ *  uint32_t: Number of packets in flight
+ *
+ *******************************************************************************/
+uint32_t udp_reliable_sender_in_flight(const udp_reliable_sender_t *sender)
+{
+    return (uint16_t)(sender->next_sequence - sender->base_sequence);
+}
+
+/*******************************************************************************
+ * Function Name: udp_reliable_sender_send
+ *******************************************************************************
+ * Summary:
+ *  Assigns the next sequence number to a payload, keeps a copy in the send
+ *  window for retransmission and encodes the DATA packet to send.
+ *
+ * Parameters:
+ *  udp_reliable_sender_t *sender: Sender
+ *  const uint8_t *payload: Payload to send
+ *  uint8_t payload_len: Length of the payload
+ *  uint32_t now_ms: Current time
+ *  uint8_t *buffer: Receives the packet
+ *  uint32_t buffer_len: Size of the buffer
+ *
+ * Return:
+ *  uint32_t: Length of the packet, 0 if the window is full or the payload is
+ *            too long
+ *
+ *******************************************************************************/
+uint32_t udp_reliable_sender_send(udp_reliable_sender_t *sender, const uint8_t *payload,
+                                  uint8_t payload_len, uint32_t now_ms,
+                                  uint8_t *buffer, uint32_t buffer_len)
+{
+    udp_reliable_tx_slot_t *slot;
+    uint32_t packet_len;
+
+    if(udp_reliable_sender_in_flight(sender) >= UDP_RELIABLE_WINDOW_SIZE)
+    {
+        sender->stats.window_full++;
+        return 0;
+    }
+
+    packet_len = udp_reliable_encode(buffer, buffer_len, UDP_RELIABLE_TYPE_DATA,
+                                     sender->session, sender->next_sequence,
+                                     sender->base_sequence, payload, payload_len);
+    if(packet_len == 0)
+    {
+        return 0;
+    }
+
+    slot = &sender->window[UDP_RELIABLE_SLOT(sender->next_sequence)];
+    slot->sequence = sender->next_sequence;
+    slot->length = payload_len;
+    slot->retries = 0;
+    slot->sent_ms = now_ms;
+    slot->in_use = true;
+    memcpy(slot->payload, payload, payload_len);
+
+    sender->next_sequence++;
+    sender->stats.sent++;
+
+    return packet_len;
+}
+
+/*******************************************************************************
+ * Function Name: udp_reliable_update_rto
+ *******************************************************************************
+ * Summary:
+ *  Folds a round-trip sample into the smoothed round-trip time and its mean
+ *  deviation and derives the retransmission timeout from them (RFC 6298, with
+ *  the usual fixed-point scaling of 8 and 4).
+ *
+ * Parameters:
+ *  udp_reliable_sender_t *sender: Sender
+ *  uint32_t rtt_ms: Round-trip sample
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void udp_reliable_update_rto(udp_reliable_sender_t *sender, uint32_t rtt_ms)
+{
+    int32_t delta;
+
+    if(!sender->rtt_measured)
+    {
+        /* First sample: SRTT = R, RTTVAR = R/2. */
+        sender->srtt_x8 = rtt_ms << 3;
+        sender->rttvar_x4 = rtt_ms << 1;
+        sender->rtt_measured = true;
+    }
+    else
+    {
+        /* SRTT += (R - SRTT)/8, RTTVAR += (|R - SRTT| - RTTVAR)/4. */
+        delta = (int32_t)rtt_ms - (int32_t)(sender->srtt_x8 >> 3);
+        sender->srtt_x8 = (uint32_t)((int32_t)sender->srtt_x8 + delta);
+        if(delta < 0)
+        {
+            delta = -delta;
+        }
+        sender->rttvar_x4 = (uint32_t)((int32_t)sender->rttvar_x4 + delta -
+                                       (int32_t)(sender->rttvar_x4 >> 2));
+    }
+
+    udp_reliable_reset_rto(sender);
+}
+
+/*******************************************************************************
+ * Function Name: udp_reliable_reset_rto
+ *******************************************************************************
+ * Summary:
+ *  Sets the retransmission timeout to SRTT + 4 * RTTVAR within the configured
+ *  bounds, which also undoes any backoff.
+ *
+ * Parameters:
+ *  udp_reliable_sender_t *sender: Sender
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void udp_reliable_reset_rto(udp_reliable_sender_t *sender)
+{
+    uint32_t rto_ms = (sender->srtt_x8 >> 3) + sender->rttvar_x4;
+
+    if(rto_ms < UDP_RELIABLE_RTO_MIN_MS)
+    {
+        rto_ms = UDP_RELIABLE_RTO_MIN_MS;
+    }
+    else if(rto_ms > UDP_RELIABLE_RTO_MAX_MS)
+    {
+        rto_ms = UDP_RELIABLE_RTO_MAX_MS;
+    }
+
+    sender->rto_ms = rto_ms;
+}
+
+/*******************************************************************************
+ * Function Name: udp_reliable_sender_on_ack
+ *******************************************************************************
+ * Summary:
+ *  Releases every packet covered by a cumulative acknowledgement. Round-trip
+ *  samples are taken from the packet echoed by the acknowledgement, only if it
+ *  was never retransmitted (Karn's algorithm). Acknowledgements of another session or for sequence numbers
+ *  that were not sent are ignored.
+ *
+ * Parameters:
+ *  udp_reliable_sender_t *sender: Sender
+ *  const udp_reliable_packet_t *packet: Decoded ACK packet
+ *  uint32_t now_ms: Current time
+ *
+ * Return:
+ *  uint32_t: Number of packets newly acknowledged
+ *
+ *******************************************************************************/
+uint32_t udp_reliable_sender_on_ack(udp_reliable_sender_t *sender,
+                                    const udp_reliable_packet_t *packet,
+                                    uint32_t now_ms)
+{
+    udp_reliable_tx_slot_t *slot;
+    uint32_t num_acked = 0;
+    uint32_t in_flight = udp_reliable_sender_in_flight(sender);
+    uint32_t advance = (uint16_t)(packet->sequence - sender->base_sequence);
+    bool rtt_sampled = false;
+
+    if((packet->type != UDP_RELIABLE_TYPE_ACK) || (packet->session != sender->session))
+    {
+        return 0;
+    }
+
+    /* Sample the round trip of the packet that triggered the acknowledgement,
+     * unless it was retransmitted and the sample would be ambiguous.
+     */
+    if((uint16_t)(packet->base_sequence - sender->base_sequence) < in_flight)
+    {
+        slot = &sender->window[UDP_RELIABLE_SLOT(packet->base_sequence)];
+        if(slot->in_use && (slot->retries == 0))
+        {
+            udp_reliable_update_rto(sender, now_ms - slot->sent_ms);
+            rtt_sampled = true;
+        }
+    }
+
+    if((advance == 0) || (advance > in_flight))
+    {
+        /* Nothing new is acknowledged. */
+        if(in_flight > 0)
+        {
+            sender->stats.duplicate_acks++;
+        }
+        return 0;
+    }
+
+    while(sender->base_sequence != packet->sequence)
+    {
+        slot = &sender->window[UDP_RELIABLE_SLOT(sender->base_sequence)];
+
+        if(slot->in_use)
+        {
+            slot->in_use = false;
+            num_acked++;
+        }
+
+        sender->base_sequence++;
+    }
+
+    if(!rtt_sampled && sender->rtt_measured)
+    {
+        /* Undo the backoff once the peer is responsive again. */
+        udp_reliable_reset_rto(sender);
+    }
+
+    sender->stats.acked += num_acked;
+
+    return num_acked;
+}
+
+/*******************************************************************************
+ * Function Name: udp_reliable_sender_poll
+ *******************************************************************************
+ * Summary:
+ *  Encodes the retransmission of the oldest packet whose timeout has expired.
+ *  Call repeatedly until it returns 0. The timeout is doubled for every
+ *  retransmission of the oldest packet, and a packet whose last of
+ *  UDP_RELIABLE_MAX_RETRIES retransmissions timed out is dropped from the
+ *  window.
+ *
+ * Parameters:
+ *  udp_reliable_sender_t *sender: Sender
+ *  uint32_t now_ms: Current time
+ *  uint8_t *buffer: Receives the packet
+ *  uint32_t buffer_len: Size of the buffer
+ *
+ * Return:
+ *  uint32_t: Length of the packet to retransmit, 0 if none is due
+ *
+ *******************************************************************************/
+uint32_t udp_reliable_sender_poll(udp_reliable_sender_t *sender, uint32_t now_ms,
+                                  uint8_t *buffer, uint32_t buffer_len)
+{
+    udp_reliable_tx_slot_t *slot;
+    uint16_t sequence;
+
+    /* Drop the packets that ran out of retries and slide the window past them,
+     * so that the base sent with the next packet lets the receiver skip them.
+     */
+    for(sequence = sender->base_sequence; sequence != sender->next_sequence; sequence++)
+    {
+        slot = &sender->window[UDP_RELIABLE_SLOT(sequence)];
+
+        if(slot->in_use && (slot->retries >= UDP_RELIABLE_MAX_RETRIES) &&
+           ((now_ms - slot->sent_ms) >= sender->rto_ms))
+        {
+            slot->in_use = false;
+            sender->stats.expired++;
+        }
+    }
+
+    while((sender->base_sequence != sender->next_sequence) &&
+          !sender->window[UDP_RELIABLE_SLOT(sender->base_sequence)].in_use)
+    {
+        sender->base_sequence++;
+    }
+
+    for(sequence = sender->base_sequence; sequence != sender->next_sequence; sequence++)
+    {
+        slot = &sender->window[UDP_RELIABLE_SLOT(sequence)];
+
+        if(!slot->in_use || ((now_ms - slot->sent_ms) < sender->rto_ms))
+        {
+            continue;
+        }
+
+        if(sequence == sender->base_sequence)
+        {
+            sender->rto_ms = (sender->rto_ms * 2u > UDP_RELIABLE_RTO_MAX_MS) ?
+                             UDP_RELIABLE_RTO_MAX_MS : sender->rto_ms * 2u;
+        }
+
+        slot->retries++;
+        slot->sent_ms = now_ms;
+        sender->stats.retransmits++;
+
+        return udp_reliable_encode(buffer, buffer_len, UDP_RELIABLE_TYPE_DATA,
+                                   sender->session, slot->sequence,
+                                   sender->base_sequence, slot->payload, slot->length);
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: udp_reliable_sender_next_timeout
+ *******************************************************************************
+ * Summary:
+ *  Returns the time until the next retransmission is due, to be used as the
+ *  wait timeout of the sending task.
+ *
+ * Parameters:
+ *  const udp_reliable_sender_t *sender: Sender
+ *  uint32_t now_ms: Current time
+ *
+ * Return:
+ *  uint32_t: Milliseconds until udp_reliable_sender_poll() has work, or
+ *            UDP_RELIABLE_NO_TIMEOUT if nothing is in flight
+ *
+ *******************************************************************************/
+uint32_t udp_reliable_sender_next_timeout(const udp_reliable_sender_t *sender,
+                                          uint32_t now_ms)
+{
+    const udp_reliable_tx_slot_t *slot;
+    uint32_t timeout_ms = UDP_RELIABLE_NO_TIMEOUT;
+    uint32_t elapsed_ms;
+    uint16_t sequence;
+
+    for(sequence = sender->base_sequence; sequence != sender->next_sequence; sequence++)
+    {
+        slot = &sender->window[UDP_RELIABLE_SLOT(sequence)];
+
+        if(!slot->in_use)
+        {
+            continue;
+        }
+
+        elapsed_ms = now_ms - slot->sent_ms;
+        if(elapsed_ms >= sender->rto_ms)
+        {
+            return 0;
+        }
+
+        if((sender->rto_ms - elapsed_ms) < timeout_ms)
+        {
+            timeout_ms = sender->rto_ms - elapsed_ms;
+        }
+    }
+
+    return timeout_ms;
+}
+
+/*******************************************************************************
+ * Function Name: udp_reliable_receiver_init
+ *******************************************************************************
+ * Summary:
+ *  Resets a receiver. The first DATA packet received sets the expected
+ *  sequence number to the base of the sender.
+ *
+ * Parameters:
+ *  udp_reliable_receiver_t *receiver: Receiver to reset
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void udp_reliable_receiver_init(udp_reliable_receiver_t *receiver)
+{
+    memset(receiver, 0, sizeof(*receiver));
+}
+
+/*******************************************************************************
+ * Function Name: udp_reliable_receiver_on_data
+ *******************************************************************************
+ * Summary:
+ *  Accepts a DATA packet. The receiver synchronizes to the base carried by the
+ *  packet on the first packet and whenever the session changes, and skips the
+ *  packets the sender gave up on, counting them as lost. Packets in sequence are delivered at
+ *  once, together with any buffered packets they unblock; packets ahead of the
+ *  expected sequence number are buffered and packets already delivered are
+ *  counted as duplicates. The caller answers every DATA packet with udp_reliable_receiver_encode_ack().
+ *
+ * Parameters:
+ *  udp_reliable_receiver_t *receiver: Receiver
+ *  const udp_reliable_packet_t *packet: Decoded DATA packet
+ *  udp_reliable_deliver_t deliver: Function called for each delivered payload
+ *  void *arg: Argument passed on to the deliver function
+ *
+ * Return:
+ *  uint32_t: Number of payloads delivered
+ *
+ *******************************************************************************/
+uint32_t udp_reliable_receiver_on_data(udp_reliable_receiver_t *receiver,
+                                       const udp_reliable_packet_t *packet,
+                                       udp_reliable_deliver_t deliver, void *arg)
+{
+    uint32_t num_delivered = 0;
+    uint32_t slot;
+    int16_t distance;
+
+    if(packet->type != UDP_RELIABLE_TYPE_DATA)
+    {
+        return 0;
+    }
+
+    receiver->last_sequence = packet->sequence;
+
+    if(!receiver->synchronized || (packet->session != receiver->session))
+    {
+        /* First packet, or the sender restarted. */
+        if(receiver->synchronized)
+        {
+            receiver->stats.resyncs++;
+        }
+        receiver->session = packet->session;
+        receiver->expected_sequence = packet->base_sequence;
+        receiver->buffered_mask = 0;
+        receiver->synchronized = true;
+    }
+
+    /* Skip the packets the sender gave up on, still delivering the ones that
+     * were buffered. The base of a late packet is behind and changes nothing.
+     */
+    for(distance = (int16_t)(packet->base_sequence - receiver->expected_sequence);
+        distance > 0; distance--)
+    {
+        if(receiver->buffered_mask == 0)
+        {
+            receiver->stats.lost += (uint32_t)distance;
+            receiver->expected_sequence = packet->base_sequence;
+            break;
+        }
+
+        slot = UDP_RELIABLE_SLOT(receiver->expected_sequence);
+        if((receiver->buffered_mask & (1uL << slot)) != 0)
+        {
+            receiver->buffered_mask &= ~(1uL << slot);
+            deliver(receiver->expected_sequence, receiver->payload[slot],
+                    receiver->length[slot], arg);
+            num_delivered++;
+        }
+        else
+        {
+            receiver->stats.lost++;
+        }
+        receiver->expected_sequence++;
+    }
+
+    /* Packets buffered right after the skipped ones are now in sequence. */
+    num_delivered += udp_reliable_receiver_deliver_buffered(receiver, deliver, arg);
+
+    distance = (int16_t)(packet->sequence - receiver->expected_sequence);
+
+    if((distance < 0) ||
+       ((distance > 0) && ((receiver->buffered_mask & (1uL << UDP_RELIABLE_SLOT(packet->sequence))) != 0)))
+    {
+        receiver->stats.duplicates++;
+    }
+    else if(distance >= (int16_t)UDP_RELIABLE_WINDOW_SIZE)
+    {
+        /* Not sent by a well-behaved sender. */
+    }
+    else if(distance > 0)
+    {
+        slot = UDP_RELIABLE_SLOT(packet->sequence);
+        memcpy(receiver->payload[slot], packet->payload, packet->length);
+        receiver->length[slot] = packet->length;
+        receiver->buffered_mask |= (1uL << slot);
+        receiver->stats.out_of_order++;
+    }
+    else
+    {
+        deliver(packet->sequence, packet->payload, packet->length, arg);
+        receiver->expected_sequence++;
+        num_delivered++;
+
+        num_delivered += udp_reliable_receiver_deliver_buffered(receiver, deliver, arg);
+    }
+
+    receiver->stats.delivered += num_delivered;
+
+    return num_delivered;
+}
+
+/*******************************************************************************
+ * Function Name: udp_reliable_receiver_deliver_buffered
+ *******************************************************************************
+ * Summary:
+ *  Delivers the buffered packets that follow the expected sequence number
+ *  without a gap.
+ *
+ * Parameters:
+ *  udp_reliable_receiver_t *receiver: Receiver
+ *  udp_reliable_deliver_t deliver: Function called for each delivered payload
+ *  void *arg: Argument passed on to the deliver function
+ *
+ * Return:
+ *  uint32_t: Number of payloads delivered
+ *
+ *******************************************************************************/
+static uint32_t udp_reliable_receiver_deliver_buffered(udp_reliable_receiver_t *receiver,
+                                                       udp_reliable_deliver_t deliver,
+                                                       void *arg)
+{
+    uint32_t num_delivered = 0;
+    uint32_t slot = UDP_RELIABLE_SLOT(receiver->expected_sequence);
+
+    while((receiver->buffered_mask & (1uL << slot)) != 0)
+    {
+        receiver->buffered_mask &= ~(1uL << slot);
+        deliver(receiver->expected_sequence, receiver->payload[slot],
+                receiver->length[slot], arg);
+        receiver->expected_sequence++;
+        num_delivered++;
+        slot = UDP_RELIABLE_SLOT(receiver->expected_sequence);
+    }
+
+    return num_delivered;
+}
+
+/*******************************************************************************
+ * Function Name: udp_reliable_receiver_encode_ack
+ *******************************************************************************
+ * Summary:
+ *  Encodes the cumulative acknowledgement of everything delivered so far,
+ *  echoing the sequence number of the last DATA packet received.
+ *
+ * Parameters:
+ *  const udp_reliable_receiver_t *receiver: Receiver
+ *  const uint8_t *payload: Application payload of the ACK (may be NULL)
+ *  uint8_t payload_len: Length of the payload
+ *  uint8_t *buffer: Receives the packet
+ *  uint32_t buffer_len: Size of the buffer
+ *
+ * Return:
+ *  uint32_t: Length of the packet, 0 if it does not fit
+ *
+ *******************************************************************************/
+uint32_t udp_reliable_receiver_encode_ack(const udp_reliable_receiver_t *receiver,
+                                          const uint8_t *payload, uint8_t payload_len,
+                                          uint8_t *buffer, uint32_t buffer_len)
+{
+    return udp_reliable_encode(buffer, buffer_len, UDP_RELIABLE_TYPE_ACK,
+                               receiver->session, receiver->expected_sequence,
+                               receiver->last_sequence, payload, payload_len);
+}
+
+
+/* [] END OF FILE */
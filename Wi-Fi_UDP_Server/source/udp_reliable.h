@@ -0,0 +1,221 @@
+/******************************************************************************
+* File Name:   udp_reliable.h
+*
+* Description: This file contains declarations of the lightweight reliability
+*              layer (sequence numbers, cumulative acknowledgements, sliding
+*              window and adaptive retransmission timeout) used by the UDP LED
+*              protocol in reliable mode.
+*
+* Related Document: See README.md
+*
+*
+*******************************************************************************
+* Copyright 2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef UDP_RELIABLE_H_
+#define UDP_RELIABLE_H_
+
+/* Standard C header files */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Packet layout (multi-byte fields in network byte order):
+ *
+ *  +-------+------+---------+----------+------+--------+-----------------+
+ *  | magic | type | session | sequence | base | length | payload         |
+ *  | 1     | 1    | 2       | 2        | 2    | 1      | 'length' bytes  |
+ *  +-------+------+---------+----------+------+--------+-----------------+
+ *
+ * The session identifies one run of the sender; the receiver resynchronizes
+ * when it changes. DATA packets carry the sequence number of the payload and
+ * the oldest sequence number the sender still retransmits, which lets the
+ * receiver synchronize on any packet and skip packets the sender gave up on.
+ * ACK packets echo the session and carry the next sequence number the receiver
+ * expects, i.e. every sequence number before it was received, and optionally
+ * an application payload. Their base field echoes the sequence number of the
+ * DATA packet that triggered the ACK, for round-trip sampling.
+ */
+#define UDP_RELIABLE_MAGIC                        (0xA6u)
+#define UDP_RELIABLE_HEADER_LEN                   (9u)
+#define UDP_RELIABLE_MAX_PAYLOAD_LEN              (20u)
+#define UDP_RELIABLE_MAX_PACKET_LEN               (UDP_RELIABLE_HEADER_LEN + \
+                                                   UDP_RELIABLE_MAX_PAYLOAD_LEN)
+
+/* Packet types. */
+#define UDP_RELIABLE_TYPE_DATA                    (0x01u)
+#define UDP_RELIABLE_TYPE_ACK                     (0x02u)
+
+/* Number of unacknowledged packets a sender may have in flight, and the number
+ * of out-of-order packets a receiver buffers. Must be a power of two and at
+ * most 32.
+ */
+#ifndef UDP_RELIABLE_WINDOW_SIZE
+#define UDP_RELIABLE_WINDOW_SIZE                  (8u)
+#endif
+
+/* Retransmission timeout before the first round-trip sample, and the bounds of
+ * the adaptive timeout.
+ */
+#define UDP_RELIABLE_RTO_INITIAL_MS               (250u)
+#define UDP_RELIABLE_RTO_MIN_MS                   (20u)
+#define UDP_RELIABLE_RTO_MAX_MS                   (4000u)
+
+/* A packet is dropped from the window after this many retransmissions. */
+#define UDP_RELIABLE_MAX_RETRIES                  (8u)
+
+/* Returned by udp_reliable_sender_next_timeout() when nothing is in flight. */
+#define UDP_RELIABLE_NO_TIMEOUT                   (UINT32_MAX)
+
+#if ((UDP_RELIABLE_WINDOW_SIZE & (UDP_RELIABLE_WINDOW_SIZE - 1u)) != 0u) || \
+    (UDP_RELIABLE_WINDOW_SIZE > 32u)
+#error "UDP_RELIABLE_WINDOW_SIZE must be a power of two and at most 32"
+#endif
+
+/*******************************************************************************
+* Data structure and enumeration
+********************************************************************************/
+/* Decoded packet. The payload points into the receive buffer. */
+typedef struct
+{
+    uint8_t type;
+    uint16_t session;
+    uint16_t sequence;
+    uint16_t base_sequence;
+    uint8_t length;
+    const uint8_t *payload;
+} udp_reliable_packet_t;
+
+/* Packet kept in the send window until it is acknowledged. */
+typedef struct
+{
+    uint32_t sent_ms;
+    uint16_t sequence;
+    uint8_t length;
+    uint8_t retries;
+    bool in_use;
+    uint8_t payload[UDP_RELIABLE_MAX_PAYLOAD_LEN];
+} udp_reliable_tx_slot_t;
+
+/* Sender counters. Retransmissions count the packets presumed lost. */
+typedef struct
+{
+    uint32_t sent;
+    uint32_t acked;
+    uint32_t retransmits;
+    uint32_t duplicate_acks;
+    uint32_t window_full;
+    uint32_t expired;
+} udp_reliable_tx_stats_t;
+
+/* Sending end of a reliable stream. */
+typedef struct
+{
+    udp_reliable_tx_slot_t window[UDP_RELIABLE_WINDOW_SIZE];
+    uint16_t session;
+    uint16_t base_sequence;
+    uint16_t next_sequence;
+    uint32_t srtt_x8;
+    uint32_t rttvar_x4;
+    uint32_t rto_ms;
+    bool rtt_measured;
+    udp_reliable_tx_stats_t stats;
+} udp_reliable_sender_t;
+
+/* Receiver counters. Lost counts the sequence numbers the sender gave up on,
+ * resyncs the restarts of the sender.
+ */
+typedef struct
+{
+    uint32_t delivered;
+    uint32_t duplicates;
+    uint32_t out_of_order;
+    uint32_t lost;
+    uint32_t resyncs;
+} udp_reliable_rx_stats_t;
+
+/* Function called for every payload delivered in sequence order. */
+typedef void (*udp_reliable_deliver_t)(uint16_t sequence, const uint8_t *payload,
+                                       uint8_t length, void *arg);
+
+/* Receiving end of a reliable stream. */
+typedef struct
+{
+    uint8_t payload[UDP_RELIABLE_WINDOW_SIZE][UDP_RELIABLE_MAX_PAYLOAD_LEN];
+    uint8_t length[UDP_RELIABLE_WINDOW_SIZE];
+    uint32_t buffered_mask;
+    uint16_t session;
+    uint16_t expected_sequence;
+    uint16_t last_sequence;
+    bool synchronized;
+    udp_reliable_rx_stats_t stats;
+} udp_reliable_receiver_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+uint32_t udp_reliable_encode(uint8_t *buffer, uint32_t buffer_len, uint8_t type,
+                             uint16_t session, uint16_t sequence,
+                             uint16_t base_sequence, const uint8_t *payload,
+                             uint8_t payload_len);
+bool udp_reliable_decode(const uint8_t *buffer, uint32_t buffer_len,
+                         udp_reliable_packet_t *packet);
+
+void udp_reliable_sender_init(udp_reliable_sender_t *sender, uint16_t session);
+uint32_t udp_reliable_sender_send(udp_reliable_sender_t *sender, const uint8_t *payload,
+                                  uint8_t payload_len, uint32_t now_ms,
+                                  uint8_t *buffer, uint32_t buffer_len);
+uint32_t udp_reliable_sender_on_ack(udp_reliable_sender_t *sender,
+                                    const udp_reliable_packet_t *packet,
+                                    uint32_t now_ms);
+uint32_t udp_reliable_sender_poll(udp_reliable_sender_t *sender, uint32_t now_ms,
+                                  uint8_t *buffer, uint32_t buffer_len);
+uint32_t udp_reliable_sender_next_timeout(const udp_reliable_sender_t *sender,
+                                          uint32_t now_ms);
+uint32_t udp_reliable_sender_in_flight(const udp_reliable_sender_t *sender);
+
+void udp_reliable_receiver_init(udp_reliable_receiver_t *receiver);
+uint32_t udp_reliable_receiver_on_data(udp_reliable_receiver_t *receiver,
+                                       const udp_reliable_packet_t *packet,
+                                       udp_reliable_deliver_t deliver, void *arg);
+uint32_t udp_reliable_receiver_encode_ack(const udp_reliable_receiver_t *receiver,
+                                          const uint8_t *payload, uint8_t payload_len,
+                                          uint8_t *buffer, uint32_t buffer_len);
+
+#endif /* UDP_RELIABLE_H_ */
+
+
+/* [] END OF FILE */
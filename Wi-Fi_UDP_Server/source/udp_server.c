@@ -46,6 +46,7 @@
 /* FreeRTOS header file */
 #include <FreeRTOS.h>
 #include <task.h>
+#include <semphr.h>
 
 /* Cypress secure socket header file */
 #include "cy_secure_sockets.h"
@@ -57,6 +58,12 @@
 /* UDP server task header file. */
 #include "udp_server.h"
 
+/* UDP reliability layer header file. */
+#include "udp_reliable.h"
+
+/* Receive ring header file. */
+#include "rx_ring.h"
+
 /*******************************************************************************
 * Macros
 ********************************************************************************/
@@ -79,7 +86,81 @@
 #define USER_BTN_INTR_PRIORITY                    (5)
 
 /* Buffer size to store the incoming messages from server, in bytes. */
-#define MAX_UDP_RECV_BUFFER_SIZE                  (20)
+#define MAX_UDP_RECV_BUFFER_SIZE                  (UDP_RELIABLE_MAX_PACKET_LEN + 1u)
+
+/* Maximum number of UDP clients in the peer registry. */
+#define UDP_SERVER_MAX_PEERS                      (16u)
+
+/* A UDP client is dropped from the registry when nothing was received from it
+ * for this long. Clients refresh their entry with every acknowledgement and by
+ * repeating START_COMM_MSG; the Wi-Fi UDP Client code example and udp_client.py
+ * repeat it every 60 seconds, so a client is dropped after missing three
+ * registrations. Set this macro as '0' to disable aging.
+ */
+#define UDP_PEER_AGING_TIMEOUT_MS                 (180000u)
+
+/* To send every LED ON/OFF command once to an IPv4 multicast group instead of
+ * once to every registered client, set this macro as '1'. The clients must join
+ * UDP_MULTICAST_GROUP and listen on UDP_MULTICAST_PORT; a directed broadcast
+ * address of the subnet can be used as the group as well. The Wi-Fi UDP Client
+ * code example does not join the group, so this mode works only with
+ * udp_client.py started with --multicast.
+ */
+#define USE_MULTICAST_FANOUT                      (0)
+
+#define MAKE_IP_PARAMETERS(a, b, c, d)            ((((uint32_t) d) << 24) | \
+                                                  (((uint32_t) c) << 16) | \
+                                                  (((uint32_t) b) << 8) |\
+                                                  ((uint32_t) a))
+
+#define UDP_MULTICAST_GROUP                       MAKE_IP_PARAMETERS(239, 1, 2, 3)
+#define UDP_MULTICAST_PORT                        (57346)
+
+/* To send the LED ON/OFF commands over the reliability layer (sequence numbers,
+ * cumulative acknowledgements and retransmission, see udp_reliable.h), set this
+ * macro as '1'. The clients must enable USE_RELIABLE_UDP as well.
+ */
+#define USE_RELIABLE_UDP                          (0)
+
+#if(USE_RELIABLE_UDP && USE_MULTICAST_FANOUT)
+#error "USE_RELIABLE_UDP needs a send window per client and cannot be combined with USE_MULTICAST_FANOUT"
+#endif
+
+/* Current time in milliseconds for the reliability layer. */
+#define UDP_RELIABLE_NOW_MS()                     ((uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS))
+
+/* Number of received messages the receive callback can hand to the UDP receive
+ * task before it drops them. Must be a power of two.
+ */
+#define UDP_RX_RING_LEN                           (8u)
+
+/* RTOS related macros for the UDP receive task. */
+#define UDP_RX_TASK_STACK_SIZE                    (4 * 1024)
+#define UDP_RX_TASK_PRIORITY                      (1)
+
+/*******************************************************************************
+* Data structure and enumeration
+********************************************************************************/
+/* Entry of the UDP client registry. */
+typedef struct
+{
+    cy_socket_sockaddr_t addr;
+    TickType_t last_seen;
+    bool in_use;
+#if(USE_RELIABLE_UDP)
+    udp_reliable_sender_t sender;
+#endif
+} udp_peer_t;
+
+/* Message received by the receive callback, processed by the UDP receive
+ * task.
+ */
+typedef struct
+{
+    cy_socket_sockaddr_t peer_addr;
+    uint32_t length;
+    char data[MAX_UDP_RECV_BUFFER_SIZE];
+} udp_rx_msg_t;
 
 /*******************************************************************************
 * Function Prototypes
@@ -87,19 +168,51 @@
 static cy_rslt_t connect_to_wifi_ap(void);
 static cy_rslt_t create_udp_server_socket(void);
 static cy_rslt_t udp_server_recv_handler(cy_socket_t socket_handle, void *arg);
+static void udp_rx_task(void *arg);
+static void udp_server_process_msg(udp_rx_msg_t *msg);
 static void isr_button_press( void *callback_arg, cyhal_gpio_event_t event);
+static udp_peer_t *udp_peer_find(const cy_socket_sockaddr_t *addr);
+static udp_peer_t *udp_peer_register(const cy_socket_sockaddr_t *addr);
+static void udp_peer_expire(TickType_t now);
+static uint32_t udp_send_led_cmd(uint8_t led_state_cmd);
+#if(USE_RELIABLE_UDP)
+static TickType_t udp_reliable_retransmit(void);
+static void udp_reliable_on_ack(const cy_socket_sockaddr_t *addr, const udp_reliable_packet_t *packet);
+static void udp_reliable_print_stats(void);
+#endif
 void print_heap_usage(char *msg);
 
 /*******************************************************************************
 * Global Variables
 ********************************************************************************/
 /* Secure socket variables. */
-cy_socket_sockaddr_t udp_server_addr, peer_addr;
+cy_socket_sockaddr_t udp_server_addr;
 cy_socket_t server_handle;
 
-/* Flag variable to track client connection status,
- * set to True when START_COMM_MSG is received from client. */
-bool client_connected = false;
+/* Registry of the UDP clients that sent START_COMM_MSG, keyed by IP address
+ * and port.
+ */
+udp_peer_t peer_table[UDP_SERVER_MAX_PEERS];
+uint32_t num_peers;
+
+/* Mutex protecting the registry. The UDP receive task and the UDP server task
+ * access it from different threads.
+ */
+SemaphoreHandle_t peer_table_mutex;
+
+/* Messages received by the receive callback. The callback is the only
+ * producer and the UDP receive task the only consumer, so that the callback
+ * never blocks the network stack.
+ */
+udp_rx_msg_t udp_rx_msgs[UDP_RX_RING_LEN];
+rx_ring_t udp_rx_ring;
+TaskHandle_t udp_rx_task_handle;
+
+/* Receives the messages dropped by the callback when the ring is full. */
+char udp_rx_discard[MAX_UDP_RECV_BUFFER_SIZE];
+
+/* Number of dropped messages when the receive task last reported them. */
+uint32_t udp_rx_reported_drops;
 
 /* Flags to tack the LED state and command. */
 bool led_state = CYBSP_LED_STATE_OFF;
@@ -130,12 +243,24 @@ void udp_server_task(void *arg)
 {
     cy_rslt_t result;
 
-    /* Variable to store number of bytes sent over UDP socket. */
-    uint32_t bytes_sent = 0;
+    /* Number of UDP clients the command was sent to. */
+    uint32_t num_peers_sent = 0;
 
     /* Variable to receive LED ON/OFF command from the user button ISR. */
     uint32_t led_state_cmd = LED_OFF_CMD;
 
+    /* Time to wait for the next command, shortened to the next retransmission
+     * in reliable mode.
+     */
+    TickType_t wait_ticks = portMAX_DELAY;
+
+    peer_table_mutex = xSemaphoreCreateMutex();
+    if(peer_table_mutex == NULL)
+    {
+        printf("Failed to create the peer registry mutex!\n");
+        CY_ASSERT(0);
+    }
+
     /* Initialize the user button (CYBSP_USER_BTN) and register interrupt on falling edge. */
     cyhal_gpio_init(CYBSP_USER_BTN, CYHAL_GPIO_DIR_INPUT, CYHAL_GPIO_DRIVE_PULLUP, CYBSP_BTN_OFF);
     cyhal_gpio_register_callback(CYBSP_USER_BTN, &cb_data);
@@ -157,6 +282,15 @@ void udp_server_task(void *arg)
     }
     printf("Secure Sockets initialized\n");
 
+    /* Start the receive task before the socket can deliver messages. */
+    rx_ring_init(&udp_rx_ring, udp_rx_msgs, sizeof(udp_rx_msg_t), UDP_RX_RING_LEN);
+    if(xTaskCreate(udp_rx_task, "UDP rx task", UDP_RX_TASK_STACK_SIZE, NULL,
+                   UDP_RX_TASK_PRIORITY, &udp_rx_task_handle) != pdPASS)
+    {
+        printf("Failed to create the UDP receive task!\n");
+        CY_ASSERT(0);
+    }
+
     /* Create UDP Server*/
     result = create_udp_server_socket();
     if (result != CY_RSLT_SUCCESS)
@@ -169,29 +303,33 @@ void udp_server_task(void *arg)
     while(true)
     {
         /* Wait until a notification is received from the user button ISR. */
-        xTaskNotifyWait(0, 0, &led_state_cmd, portMAX_DELAY);
+        if(xTaskNotifyWait(0, 0, &led_state_cmd, wait_ticks) != pdTRUE)
+        {
+#if(USE_RELIABLE_UDP)
+            wait_ticks = udp_reliable_retransmit();
+#endif
+            continue;
+        }
 
-        /* Send LED ON/OFF command to UDP client. */
-        if(client_connected)
+        /* Send LED ON/OFF command to the registered UDP clients. */
+        num_peers_sent = udp_send_led_cmd((uint8_t)led_state_cmd);
+#if(USE_RELIABLE_UDP)
+        wait_ticks = udp_reliable_retransmit();
+#endif
+        if(num_peers_sent > 0)
         {
-            result = cy_socket_sendto(server_handle, &led_state_cmd, UDP_LED_CMD_LEN, CY_SOCKET_FLAGS_NONE,
-                                      &peer_addr, sizeof(cy_socket_sockaddr_t), &bytes_sent);
-            if(result == CY_RSLT_SUCCESS )
+            if(led_state_cmd == LED_ON_CMD)
             {
-                if(led_state_cmd == LED_ON_CMD)
-                {
-                    printf("LED ON command sent to UDP client\n");
-                }
-                else
-                {
-                    printf("LED OFF command sent to UDP client\n");
-                }
+                printf("LED ON command sent to %"PRIu32" UDP client(s)\n", num_peers_sent);
             }
             else
             {
-                printf("Failed to send command to client. Error: %"PRIu32"\n", result);
+                printf("LED OFF command sent to %"PRIu32" UDP client(s)\n", num_peers_sent);
             }
-            
+
+#if(USE_RELIABLE_UDP)
+            udp_reliable_print_stats();
+#endif
             print_heap_usage("After sending LED ON/OFF command to client");
         }
       }
@@ -316,7 +454,10 @@ cy_rslt_t create_udp_server_socket(void)
  * Function Name: udp_server_recv_handler
  *******************************************************************************
  * Summary:
- *  Callback function to handle incoming  message from UDP client
+ *  Callback function to handle incoming  message from UDP client. Runs in the
+ *  network stack thread: it only receives the message into the receive ring
+ *  and wakes the UDP receive task, which processes it. When the ring is full,
+ *  the message is received into a scratch buffer and dropped.
  *
  *******************************************************************************/
 cy_rslt_t udp_server_recv_handler(cy_socket_t socket_handle, void *arg)
@@ -326,58 +467,543 @@ cy_rslt_t udp_server_recv_handler(cy_socket_t socket_handle, void *arg)
     /* Variable to store the number of bytes received. */
     uint32_t bytes_received = 0;
 
-    /* Buffer to store data received from Client. */
-    char message_buffer[MAX_UDP_RECV_BUFFER_SIZE] = {0};
+    /* Address of the UDP client that sent the message. */
+    cy_socket_sockaddr_t peer_addr;
+
+    udp_rx_msg_t *msg = rx_ring_reserve(&udp_rx_ring);
+
+    if(msg == NULL)
+    {
+        return cy_socket_recvfrom(server_handle, udp_rx_discard, MAX_UDP_RECV_BUFFER_SIZE - 1,
+                                  CY_SOCKET_FLAGS_NONE, &peer_addr, NULL, &bytes_received);
+    }
 
     /* Receive incoming message from UDP server. */
-    result = cy_socket_recvfrom(server_handle, message_buffer, MAX_UDP_RECV_BUFFER_SIZE,
-                                CY_SOCKET_FLAGS_NONE, &peer_addr, NULL,
+    result = cy_socket_recvfrom(server_handle, msg->data, MAX_UDP_RECV_BUFFER_SIZE - 1,
+                                CY_SOCKET_FLAGS_NONE, &msg->peer_addr, NULL,
                                 &bytes_received);
+    if(result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+
+    msg->data[bytes_received] = '\0';
+    msg->length = bytes_received;
+    rx_ring_commit(&udp_rx_ring);
+
+    xTaskNotifyGive(udp_rx_task_handle);
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: udp_rx_task
+ *******************************************************************************
+ * Summary:
+ *  Task that processes the messages queued by the receive callback, and
+ *  reports the messages dropped because the receive ring was full.
+ *
+ * Parameters:
+ *  void *arg: Task parameter defined during task creation (unused)
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void udp_rx_task(void *arg)
+{
+    udp_rx_msg_t *msg;
+    uint32_t dropped;
+
+    while(true)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        while((msg = rx_ring_peek(&udp_rx_ring)) != NULL)
+        {
+            udp_server_process_msg(msg);
+            rx_ring_release(&udp_rx_ring);
+        }
+
+        dropped = udp_rx_ring.dropped;
+        if(dropped != udp_rx_reported_drops)
+        {
+            printf("Receive ring full: %"PRIu32" message(s) dropped (total: %"PRIu32", peak: %"PRIu32"/%u)\n",
+                   dropped - udp_rx_reported_drops, dropped, udp_rx_ring.peak, UDP_RX_RING_LEN);
+            udp_rx_reported_drops = dropped;
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: udp_server_process_msg
+ *******************************************************************************
+ * Summary:
+ *  Handles a message received from a UDP client: registers the client or
+ *  processes its acknowledgement.
+ *
+ * Parameters:
+ *  udp_rx_msg_t *msg: Message and address of the UDP client
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void udp_server_process_msg(udp_rx_msg_t *msg)
+{
+    /* Message received from the client, NUL terminated. */
+    char *message_buffer = msg->data;
+
+    /* Address of the UDP client that sent the message. */
+    const cy_socket_sockaddr_t peer_addr = msg->peer_addr;
+
+    /* Registry entry of the UDP client. */
+    udp_peer_t *peer;
+    bool registered;
+    uint32_t registered_peers;
 
-    message_buffer[bytes_received] = '\0';
+#if(USE_RELIABLE_UDP)
+    /* Decoded acknowledgement of the reliability layer. */
+    udp_reliable_packet_t packet;
 
-    if(result == CY_RSLT_SUCCESS)
+    if(udp_reliable_decode((const uint8_t *)message_buffer, msg->length, &packet))
     {
-        if(START_COMM_MSG == message_buffer[0])
+        udp_reliable_on_ack(&peer_addr, &packet);
+        return;
+    }
+#endif
+
+    if(START_COMM_MSG == message_buffer[0])
+    {
+        /* Register the client, or refresh its entry. The registration is not
+         * echoed: clients take any message from the server as a command.
+         */
+        xSemaphoreTake(peer_table_mutex, portMAX_DELAY);
+        peer = udp_peer_register(&peer_addr);
+        registered = (peer != NULL);
+        registered_peers = num_peers;
+        xSemaphoreGive(peer_table_mutex);
+
+        if(!registered)
         {
-            client_connected = true;
-            printf("UDP Client available on IP Address: %d.%d.%d.%d \n", (uint8)peer_addr.ip_address.ip.v4,
+            printf("Peer registry full, ignoring UDP client %d.%d.%d.%d:%d\n", (uint8)peer_addr.ip_address.ip.v4,
                     (uint8)(peer_addr.ip_address.ip.v4 >> 8), (uint8)(peer_addr.ip_address.ip.v4 >> 16),
-                    (uint8)(peer_addr.ip_address.ip.v4 >> 24));
+                    (uint8)(peer_addr.ip_address.ip.v4 >> 24), peer_addr.port);
+            return;
+        }
+
+        printf("UDP Client available on IP Address: %d.%d.%d.%d Port: %d (%"PRIu32"/%u registered)\n",
+                (uint8)peer_addr.ip_address.ip.v4, (uint8)(peer_addr.ip_address.ip.v4 >> 8),
+                (uint8)(peer_addr.ip_address.ip.v4 >> 16), (uint8)(peer_addr.ip_address.ip.v4 >> 24),
+                peer_addr.port, registered_peers, UDP_SERVER_MAX_PEERS);
+    }
+    else
+    {
+        /* Any message from a registered client keeps its entry alive. */
+        xSemaphoreTake(peer_table_mutex, portMAX_DELAY);
+        peer = udp_peer_find(&peer_addr);
+        if(peer != NULL)
+        {
+            peer->last_seen = xTaskGetTickCount();
+        }
+        xSemaphoreGive(peer_table_mutex);
+
+        printf("\nAcknowledgement from UDP Client:\n");
+
+        /* Print the message received from UDP client. */
+        printf("%s",message_buffer);
+
+        /* Set the LED state based on the acknowledgment received from the UDP client. */
+        if(strcmp(message_buffer, LED_ON_ACK_MSG) == 0)
+        {
+            led_state = CYBSP_LED_STATE_ON;
         }
         else
         {
-            printf("\nAcknowledgement from UDP Client:\n");
+            led_state = CYBSP_LED_STATE_OFF;
+        }
+        printf("\n");
+    }
 
-            /* Print the message received from UDP client. */
-            printf("%s",message_buffer);
+    print_heap_usage("After receiving ACK from client");
 
-            /* Set the LED state based on the acknowledgment received from the UDP client. */
-            if(strcmp(message_buffer, LED_ON_ACK_MSG) == 0)
-            {
-                led_state = CYBSP_LED_STATE_ON;
-            }
-            else
+    printf("===============================================================\n");
+    printf("Press the user button to send LED ON/OFF command to the UDP client\n");
+}
+
+/*******************************************************************************
+ * Function Name: udp_peer_find
+ *******************************************************************************
+ * Summary:
+ *  Looks up the registry entry of a UDP client. Must be called with
+ *  peer_table_mutex held.
+ *
+ * Parameters:
+ *  const cy_socket_sockaddr_t *addr: IP address and port of the UDP client
+ *
+ * Return:
+ *  udp_peer_t *: Registry entry, or NULL if the client is not registered
+ *
+ *******************************************************************************/
+static udp_peer_t *udp_peer_find(const cy_socket_sockaddr_t *addr)
+{
+    for(uint32_t i = 0; i < UDP_SERVER_MAX_PEERS; i++)
+    {
+        if(peer_table[i].in_use &&
+           (peer_table[i].addr.ip_address.ip.v4 == addr->ip_address.ip.v4) &&
+           (peer_table[i].addr.port == addr->port))
+        {
+            return &peer_table[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+ * Function Name: udp_peer_register
+ *******************************************************************************
+ * Summary:
+ *  Adds a UDP client to the registry or refreshes its entry. Expired entries
+ *  are dropped first so that their slots can be reused. Must be called with
+ *  peer_table_mutex held.
+ *
+ * Parameters:
+ *  const cy_socket_sockaddr_t *addr: IP address and port of the UDP client
+ *
+ * Return:
+ *  udp_peer_t *: Registry entry, or NULL if the registry is full
+ *
+ *******************************************************************************/
+static udp_peer_t *udp_peer_register(const cy_socket_sockaddr_t *addr)
+{
+    TickType_t now = xTaskGetTickCount();
+    udp_peer_t *peer = udp_peer_find(addr);
+
+    if(peer == NULL)
+    {
+        udp_peer_expire(now);
+
+        for(uint32_t i = 0; i < UDP_SERVER_MAX_PEERS; i++)
+        {
+            if(!peer_table[i].in_use)
             {
-                led_state = CYBSP_LED_STATE_OFF;
+                peer = &peer_table[i];
+                peer->addr = *addr;
+                peer->in_use = true;
+#if(USE_RELIABLE_UDP)
+                /* The registration time serves as the session of the stream. */
+                udp_reliable_sender_init(&peer->sender, (uint16_t)now);
+#endif
+                num_peers++;
+                break;
             }
-            printf("\n");
         }
+    }
+
+    if(peer != NULL)
+    {
+        peer->last_seen = now;
+    }
+
+    return peer;
+}
+
+/*******************************************************************************
+ * Function Name: udp_peer_expire
+ *******************************************************************************
+ * Summary:
+ *  Drops the UDP clients that were not heard from for UDP_PEER_AGING_TIMEOUT_MS.
+ *  Must be called with peer_table_mutex held.
+ *
+ * Parameters:
+ *  TickType_t now: Current tick count
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void udp_peer_expire(TickType_t now)
+{
+#if(UDP_PEER_AGING_TIMEOUT_MS > 0)
+    for(uint32_t i = 0; i < UDP_SERVER_MAX_PEERS; i++)
+    {
+        if(peer_table[i].in_use &&
+           ((TickType_t)(now - peer_table[i].last_seen) > pdMS_TO_TICKS(UDP_PEER_AGING_TIMEOUT_MS)))
+        {
+            peer_table[i].in_use = false;
+            num_peers--;
+            printf("UDP Client %d.%d.%d.%d:%d timed out\n", (uint8)peer_table[i].addr.ip_address.ip.v4,
+                    (uint8)(peer_table[i].addr.ip_address.ip.v4 >> 8),
+                    (uint8)(peer_table[i].addr.ip_address.ip.v4 >> 16),
+                    (uint8)(peer_table[i].addr.ip_address.ip.v4 >> 24), peer_table[i].addr.port);
+        }
+    }
+#else
+    (void)now;
+#endif /* UDP_PEER_AGING_TIMEOUT_MS > 0 */
+}
+
+/*******************************************************************************
+ * Function Name: udp_send_led_cmd
+ *******************************************************************************
+ * Summary:
+ *  Sends the LED ON/OFF command to the registered UDP clients, either once to
+ *  the multicast group or once to every client. In reliable mode every client
+ *  gets the command with the next sequence number of its stream.
+ *
+ * Parameters:
+ *  uint8_t led_state_cmd: LED ON/OFF command to send
+ *
+ * Return:
+ *  uint32_t: Number of registered UDP clients the command was sent to
+ *
+ *******************************************************************************/
+static uint32_t udp_send_led_cmd(uint8_t led_state_cmd)
+{
+    cy_rslt_t result;
+
+    /* Variable to store number of bytes sent over UDP socket. */
+    uint32_t bytes_sent = 0;
+    uint32_t num_peers_sent = 0;
+
+#if(USE_MULTICAST_FANOUT)
+    cy_socket_sockaddr_t group_addr =
+    {
+        .ip_address.version = CY_SOCKET_IP_VER_V4,
+        .ip_address.ip.v4 = UDP_MULTICAST_GROUP,
+        .port = UDP_MULTICAST_PORT
+    };
+#elif(USE_RELIABLE_UDP)
+    uint8_t packet[UDP_RELIABLE_MAX_PACKET_LEN];
+    uint32_t packet_len;
+#endif /* USE_MULTICAST_FANOUT */
+
+    xSemaphoreTake(peer_table_mutex, portMAX_DELAY);
+
+    udp_peer_expire(xTaskGetTickCount());
+
+#if(USE_MULTICAST_FANOUT)
+    /* One datagram reaches every client that joined the group. */
+    if(num_peers > 0)
+    {
+        result = cy_socket_sendto(server_handle, &led_state_cmd, UDP_LED_CMD_LEN, CY_SOCKET_FLAGS_NONE,
+                                  &group_addr, sizeof(cy_socket_sockaddr_t), &bytes_sent);
+        if(result == CY_RSLT_SUCCESS)
+        {
+            num_peers_sent = num_peers;
+        }
+        else
+        {
+            printf("Failed to send command to the multicast group. Error: %"PRIu32"\n", result);
+        }
+    }
+#elif(USE_RELIABLE_UDP)
+    for(uint32_t i = 0; i < UDP_SERVER_MAX_PEERS; i++)
+    {
+        if(!peer_table[i].in_use)
+        {
+            continue;
+        }
+
+        /* The command stays in the send window of the client until it is
+         * acknowledged.
+         */
+        packet_len = udp_reliable_sender_send(&peer_table[i].sender, &led_state_cmd, UDP_LED_CMD_LEN,
+                                              UDP_RELIABLE_NOW_MS(), packet, sizeof(packet));
+        if(packet_len == 0)
+        {
+            printf("Send window of client %d.%d.%d.%d:%d is full, command dropped\n",
+                    (uint8)peer_table[i].addr.ip_address.ip.v4, (uint8)(peer_table[i].addr.ip_address.ip.v4 >> 8),
+                    (uint8)(peer_table[i].addr.ip_address.ip.v4 >> 16),
+                    (uint8)(peer_table[i].addr.ip_address.ip.v4 >> 24), peer_table[i].addr.port);
+            continue;
+        }
+
+        result = cy_socket_sendto(server_handle, packet, packet_len, CY_SOCKET_FLAGS_NONE,
+                                  &peer_table[i].addr, sizeof(cy_socket_sockaddr_t), &bytes_sent);
+        if(result == CY_RSLT_SUCCESS)
+        {
+            num_peers_sent++;
+        }
+        else
+        {
+            printf("Failed to send command to client. Error: %"PRIu32"\n", result);
+        }
+    }
+#else
+    for(uint32_t i = 0; i < UDP_SERVER_MAX_PEERS; i++)
+    {
+        if(!peer_table[i].in_use)
+        {
+            continue;
+        }
+
+        result = cy_socket_sendto(server_handle, &led_state_cmd, UDP_LED_CMD_LEN, CY_SOCKET_FLAGS_NONE,
+                                  &peer_table[i].addr, sizeof(cy_socket_sockaddr_t), &bytes_sent);
+        if(result == CY_RSLT_SUCCESS)
+        {
+            num_peers_sent++;
+        }
+        else
+        {
+            printf("Failed to send command to client. Error: %"PRIu32"\n", result);
+        }
+    }
+#endif /* USE_MULTICAST_FANOUT */
+
+    xSemaphoreGive(peer_table_mutex);
+
+    return num_peers_sent;
+}
+
+#if(USE_RELIABLE_UDP)
+/*******************************************************************************
+ * Function Name: udp_reliable_retransmit
+ *******************************************************************************
+ * Summary:
+ *  Retransmits the commands whose retransmission timeout expired, for every
+ *  registered UDP client, and returns the time until the next one is due.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  TickType_t: Ticks until the next retransmission, portMAX_DELAY if no
+ *              command is waiting for an acknowledgement
+ *
+ *******************************************************************************/
+static TickType_t udp_reliable_retransmit(void)
+{
+    uint8_t packet[UDP_RELIABLE_MAX_PACKET_LEN];
+    uint32_t packet_len;
+    uint32_t bytes_sent = 0;
+    uint32_t timeout_ms = UDP_RELIABLE_NO_TIMEOUT;
+    uint32_t peer_timeout_ms;
+    uint32_t now_ms = UDP_RELIABLE_NOW_MS();
+
+    xSemaphoreTake(peer_table_mutex, portMAX_DELAY);
+
+    for(uint32_t i = 0; i < UDP_SERVER_MAX_PEERS; i++)
+    {
+        if(!peer_table[i].in_use)
+        {
+            continue;
+        }
+
+        while((packet_len = udp_reliable_sender_poll(&peer_table[i].sender, now_ms,
+                                                     packet, sizeof(packet))) > 0)
+        {
+            cy_socket_sendto(server_handle, packet, packet_len, CY_SOCKET_FLAGS_NONE,
+                             &peer_table[i].addr, sizeof(cy_socket_sockaddr_t), &bytes_sent);
+        }
+
+        peer_timeout_ms = udp_reliable_sender_next_timeout(&peer_table[i].sender, now_ms);
+        if(peer_timeout_ms < timeout_ms)
+        {
+            timeout_ms = peer_timeout_ms;
+        }
+    }
+
+    xSemaphoreGive(peer_table_mutex);
+
+    return (timeout_ms == UDP_RELIABLE_NO_TIMEOUT) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+}
+
+/*******************************************************************************
+ * Function Name: udp_reliable_on_ack
+ *******************************************************************************
+ * Summary:
+ *  Releases the commands acknowledged by a UDP client and updates the LED
+ *  state from the acknowledgement message carried by the packet.
+ *
+ * Parameters:
+ *  const cy_socket_sockaddr_t *addr: IP address and port of the UDP client
+ *  const udp_reliable_packet_t *packet: Decoded acknowledgement
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void udp_reliable_on_ack(const cy_socket_sockaddr_t *addr, const udp_reliable_packet_t *packet)
+{
+    udp_peer_t *peer;
+    uint32_t num_acked = 0;
+
+    xSemaphoreTake(peer_table_mutex, portMAX_DELAY);
+    peer = udp_peer_find(addr);
+    if(peer != NULL)
+    {
+        peer->last_seen = xTaskGetTickCount();
+        num_acked = udp_reliable_sender_on_ack(&peer->sender, packet, UDP_RELIABLE_NOW_MS());
+    }
+    xSemaphoreGive(peer_table_mutex);
+
+    /* Retransmitted commands are acknowledged again; report each one once. */
+    if(num_acked == 0)
+    {
+        return;
+    }
 
+    printf("\nAcknowledgement from UDP Client:\n");
+    printf("%.*s\n", packet->length, (const char *)packet->payload);
+
+    if((packet->length == strlen(LED_ON_ACK_MSG)) &&
+       (memcmp(packet->payload, LED_ON_ACK_MSG, packet->length) == 0))
+    {
+        led_state = CYBSP_LED_STATE_ON;
     }
     else
     {
-        printf("Failed to receive message from client. Error: %"PRIu32"\n", result);
-        return result;
+        led_state = CYBSP_LED_STATE_OFF;
     }
-    
-    print_heap_usage("After receiving ACK from client");
 
     printf("===============================================================\n");
     printf("Press the user button to send LED ON/OFF command to the UDP client\n");
+}
 
-    return result;
+/*******************************************************************************
+ * Function Name: udp_reliable_print_stats
+ *******************************************************************************
+ * Summary:
+ *  Prints the counters and the retransmission timeout of the reliable stream
+ *  of every registered UDP client.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void udp_reliable_print_stats(void)
+{
+    const udp_reliable_sender_t *sender;
+
+    xSemaphoreTake(peer_table_mutex, portMAX_DELAY);
+
+    for(uint32_t i = 0; i < UDP_SERVER_MAX_PEERS; i++)
+    {
+        if(!peer_table[i].in_use)
+        {
+            continue;
+        }
+
+        sender = &peer_table[i].sender;
+        printf("Client %d.%d.%d.%d:%d: sent %"PRIu32", acked %"PRIu32", in flight %"PRIu32", "
+               "retransmits %"PRIu32", duplicate acks %"PRIu32", window full %"PRIu32", "
+               "expired %"PRIu32", SRTT %"PRIu32" ms, RTO %"PRIu32" ms\n",
+                (uint8)peer_table[i].addr.ip_address.ip.v4, (uint8)(peer_table[i].addr.ip_address.ip.v4 >> 8),
+                (uint8)(peer_table[i].addr.ip_address.ip.v4 >> 16),
+                (uint8)(peer_table[i].addr.ip_address.ip.v4 >> 24), peer_table[i].addr.port,
+                sender->stats.sent, sender->stats.acked, udp_reliable_sender_in_flight(sender),
+                sender->stats.retransmits, sender->stats.duplicate_acks, sender->stats.window_full,
+                sender->stats.expired, sender->srtt_x8 >> 3, sender->rto_ms);
+    }
+
+    xSemaphoreGive(peer_table_mutex);
 }
+#endif /* USE_RELIABLE_UDP */
 
 /*******************************************************************************
  * Function Name: isr_button_press
@@ -38,9 +38,13 @@
 
 #!/usr/bin/env python
 import socket
+import struct
 import optparse
 import time
 import sys
+import random
+
+import udp_reliable
 
 
 BUFFER_SIZE = 1024
@@ -49,20 +53,70 @@ BUFFER_SIZE = 1024
 DEFAULT_IP   = '192.168.43.154'   # IP address of the UDP server
 DEFAULT_PORT = 57345             # Port of the UDP server
 
+# Multicast group and port used by the server when USE_MULTICAST_FANOUT is 1
+DEFAULT_MULTICAST_PORT = 57346
+
+# The registration is repeated at this interval so that the server does not
+# age the client out after UDP_PEER_AGING_TIMEOUT_MS.
+REGISTER_INTERVAL_S = 60
+
 START_MSG="A"
 
-def udp_client( server_ip, server_port):
+ACK_MSG = {'0': 'LED OFF ACK', '1': 'LED ON ACK'}
+
+def open_socket(multicast_group, multicast_port):
+	s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+	if multicast_group:
+		# Listen on the multicast port and join the group the server sends to.
+		s.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+		s.bind(('', multicast_port))
+		mreq = struct.pack("4s4s", socket.inet_aton(multicast_group), socket.inet_aton('0.0.0.0'))
+		s.setsockopt(socket.IPPROTO_IP, socket.IP_ADD_MEMBERSHIP, mreq)
+		print("Joined multicast group", multicast_group, " Port:", multicast_port)
+	return s
+
+def reliable_recv(s, receiver, data, addr, drop, last_command):
+	# Commands of the reliability layer: every packet is acknowledged, the
+	# commands are handled once and in order.
+	packet = udp_reliable.decode(data)
+	if packet is None:
+		return last_command
+	if random.random() < drop:
+		print("Dropped packet %d (simulated loss)" % packet[2])
+		return last_command
+	for command in receiver.on_data(packet):
+		command = command.decode('utf-8')
+		print("================================================================================")
+		print("Command from Server:")
+		print("LED ON" if command == '1' else "LED OFF")
+		last_command = command
+	s.sendto(receiver.ack(ACK_MSG.get(last_command, 'LED OFF ACK').encode('utf-8')), addr)
+	print("Acknowledgement sent to server", receiver.stats)
+	return last_command
+
+def udp_client( server_ip, server_port, multicast_group, multicast_port, reliable, drop):
 	print("================================================================================")
 	print("UDP Client")
 	print("================================================================================")
 	print("Sending data to UDP Server with IP Address:",server_ip, " Port:",server_port)
     
-	s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+	s = open_socket(multicast_group, multicast_port)
+	s.settimeout(REGISTER_INTERVAL_S)
 	s.sendto(bytes(START_MSG, "utf-8"), (server_ip, server_port))
+	receiver = udp_reliable.Receiver()
+	last_command = '0'
 	
 	while True:
+		try:
+			data, addr = s.recvfrom(BUFFER_SIZE);
+		except socket.timeout:
+			# Refresh the registration with the server.
+			s.sendto(bytes(START_MSG, "utf-8"), (server_ip, server_port))
+			continue
+		if reliable:
+			last_command = reliable_recv(s, receiver, data, addr, drop, last_command)
+			continue
 		print("================================================================================")        
-		data = s.recv(BUFFER_SIZE);
 		print("Command from Server:")
 		if data.decode('utf-8') == '0':
 			print("LED OFF")
@@ -78,6 +132,10 @@ if __name__ == '__main__':
     parser = optparse.OptionParser()
     parser.add_option("-p", "--port", dest="port", type="int", default=DEFAULT_PORT, help="Port to listen on [default: %default].")
     parser.add_option("--hostname", dest="hostname", default=DEFAULT_IP, help="Hostname or IP address of the server to connect to.")
+    parser.add_option("-m", "--multicast", dest="multicast", default=None, help="Multicast group to join when the server uses multicast fan-out (e.g. 239.1.2.3).")
+    parser.add_option("--mport", dest="mport", type="int", default=DEFAULT_MULTICAST_PORT, help="Port of the multicast group [default: %default].")
+    parser.add_option("-r", "--reliable", dest="reliable", action="store_true", default=False, help="Use the reliability layer (server built with USE_RELIABLE_UDP).")
+    parser.add_option("--drop", dest="drop", type="float", default=0.0, help="Probability of dropping a received command in reliable mode, to exercise retransmission [default: %default].")
     (options, args) = parser.parse_args()
     #start udp client
-    udp_client(options.hostname, options.port)
+    udp_client(options.hostname, options.port, options.multicast, options.mport, options.reliable, options.drop)